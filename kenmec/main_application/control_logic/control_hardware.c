@@ -19,6 +19,10 @@
  * - 提供統一的硬體抽象層接口
  * - 支援從硬體讀取或從 RAM 緩存讀取
  * - 使用 DK Modbus 協議與 HID 設備通訊
+ * - 存取硬體的函數耗時計入 control_logic_latency(讀取 RAM 緩存的不計)
+ * - AI/AO 通道模式以快取為準,模式相同時不重送設定,只在重新連線或定期稽核時讀回
+ * - RTD 電阻轉溫度使用 control_logic_rtd 的 Callendar-Van Dusen 查表,整塊板一次轉換
+ * - 每個 HID 埠一把交易鎖,從 HID 寫入持有到對應的讀取完成,同一埠的回應不會被別的執行緒收走
  *
  * 硬體設備類型:
  * - IO 板(0xA2): GPIO、AD74416H(AI/AO)
@@ -40,94 +44,213 @@
 #include "dexatek/main_application/managers/modbus_manager/modbus_manager.h"
 
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/control_logic_update.h"
+#include "kenmec/main_application/control_logic/control_logic_latency.h"
+#include "kenmec/main_application/control_logic/control_logic_rtd.h"
 
 /*---------------------------------------------------------------------------
                             Defined Constants
  ---------------------------------------------------------------------------*/
 /* 日誌標籤 */
  static const char* tag = "cl_hardware";
- 
- /*---------------------------------------------------------------------------
-                             Function Prototypes
-  ---------------------------------------------------------------------------*/
+
+/* RS485 橋接器所在的 HID 板 PID */
+#define RS485_HID_PID (0xA3)
+
+/*---------------------------------------------------------------------------
+                            Type Definitions
+ ---------------------------------------------------------------------------*/
 /**
- * @brief PT100 電阻轉換為溫度
- * @param resistance_mohm 電阻值(毫歐姆)
- * @return float 溫度值(攝氏度)
+ * @brief RS485 埠狀態
+ *
+ * 記錄每個 HID 埠上 RS485 橋接器最後一次成功套用的鮑率,
+ * 相同鮑率時不再重送 CModbusUartBaudrate 封包。
+ * 由該埠的交易鎖保護,鎖從鮑率設定持有到該筆 RS485 請求收到回應為止;
+ * 每個埠一把鎖,慢的板子不會擋住其他埠。
+ */
+typedef struct {
+    uint32_t baudrate;      /* 最後一次成功套用的鮑率, 0 表示未知 */
+    uint16_t pid;           /* 套用時該埠的 PID, 用於偵測 HID 重新連線 */
+} rs485_port_state_t;
+
+/**
+ * @brief AD74416H 通道模式快取
+ *
+ * 模式只會經由 control_hardware_AI_AO_mode_set() 改變,成功設定後即更新快取;
+ * 快取的模式與要求相同時不再送出 CModbusAD74416hSetMode。
+ * 讀取時只在快取無效、PID 變化(重新連線)或超過稽核間隔時才向硬體讀回。
+ * 鎖在 HID 往返期間持有,每個埠一把鎖;需要交易鎖時先取本鎖再取交易鎖。
  */
-static float _pt100_resistance_to_temp_float(uint32_t resistance_mohm);
+typedef struct {
+    pthread_mutex_t lock;   /* 埠的互斥鎖 */
+    uint16_t pid;           /* 快取填入時該埠的 PID, 用於偵測 HID 重新連線 */
+    uint8_t valid;          /* 各通道快取是否有效(bit = 通道) */
+    uint16_t mode[4];       /* 各通道模式 */
+    uint64_t read_ms;       /* 最後一次從硬體讀回的時間 */
+} ai_mode_port_state_t;
+
+/*---------------------------------------------------------------------------
+                                Variables
+ ---------------------------------------------------------------------------*/
+/* HID 埠交易鎖 */
+static pthread_mutex_t _hid_transaction_locks[HID_DEVICES_MAX] = {
+    [0 ... HID_DEVICES_MAX - 1] = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* RS485 埠狀態表(由交易鎖保護) */
+static rs485_port_state_t _rs485_port_state[HID_DEVICES_MAX];
+
+/* 實際送出的鮑率設定次數 */
+static uint32_t _rs485_baudrate_set_count = 0;
+
+/* 因鮑率相同而略過的設定次數 */
+static uint32_t _rs485_baudrate_skip_count = 0;
+
+/* AI/AO 模式快取表 */
+static ai_mode_port_state_t _ai_mode_port_state[HID_DEVICES_MAX] = {
+    [0 ... HID_DEVICES_MAX - 1] = { .lock = PTHREAD_MUTEX_INITIALIZER },
+};
+
+/* 從硬體讀回模式的次數 */
+static uint32_t _ai_mode_read_count = 0;
 
+/* 由快取回應的模式讀取次數 */
+static uint32_t _ai_mode_hit_count = 0;
+
+/* 實際送出的模式設定次數 */
+static uint32_t _ai_mode_set_count = 0;
+
+/* 因模式相同而略過的設定次數 */
+static uint32_t _ai_mode_skip_count = 0;
+ 
  /*---------------------------------------------------------------------------
                                  Implementation
   ---------------------------------------------------------------------------*/
 
 /**
- * @brief PT100 電阻轉換為溫度(簡化版)
+ * @brief 取得 HID 埠交易鎖
  *
- * 功能說明:
- * 使用簡化公式將 PT100 電阻值轉換為溫度值。
+ * 板子的回應依埠排隊,不帶請求編號;同一埠上另一個執行緒(例如與 RTD 輪詢共用埠的
+ * RS485 更新)若在寫入與讀取之間插入自己的請求,就會收到對方的回應。
+ * 鎖從 HID 寫入持有到對應的讀取完成,不可重入。
+ *
+ * @param hid_port HID 埠號, 超出範圍時不上鎖
+ */
+static void _hid_transaction_lock(uint8_t hid_port)
+{
+    if (hid_port < HID_DEVICES_MAX) {
+        pthread_mutex_lock(&_hid_transaction_locks[hid_port]);
+    }
+}
+
+static void _hid_transaction_unlock(uint8_t hid_port)
+{
+    if (hid_port < HID_DEVICES_MAX) {
+        pthread_mutex_unlock(&_hid_transaction_locks[hid_port]);
+    }
+}
+
+/**
+ * @brief 取得 RS485 埠鎖
  *
- * @param resistance_mohm 電阻值(毫歐姆 mΩ)
+ * 即該埠的交易鎖,從鮑率設定一直持有到該筆 RS485 請求收到回應為止,
+ * 其他執行緒無法在兩者之間改掉橋接器的鮑率;快取只在鎖內可信。
  *
- * @return float 溫度值(攝氏度)
+ * @param hid_port HID 埠號
  *
- * 轉換公式:
- * - PT100 基準電阻: R0 = 100Ω = 100000 mΩ
- * - 溫度係數: 0.00385 Ω/Ω/°C
- * - temp = (R - R0) * 10 / 385 / 10
+ * @return rs485_port_state_t* 已上鎖的埠狀態, 埠號超出範圍時為 NULL
  */
-static float _pt100_resistance_to_temp_float(uint32_t resistance_mohm)
+static rs485_port_state_t *_rs485_port_lock(uint8_t hid_port)
 {
-    /* PT100: R0 = 100Ω = 100000 mΩ */
-    int delta = resistance_mohm - 100000;
-    if (delta < 0) delta = 0;
+    if (hid_port >= HID_DEVICES_MAX) {
+        return NULL;
+    }
 
-    /* 溫度計算(放大10倍) */
-    int temp_x10 = (delta * 10) / 385;
+    _hid_transaction_lock(hid_port);
 
-    return temp_x10 / 10.0f;
+    return &_rs485_port_state[hid_port];
+}
+
+static void _rs485_port_unlock(uint8_t hid_port)
+{
+    _hid_transaction_unlock(hid_port);
 }
 
 /**
- * @brief 電阻轉換為溫度(通用版)
+ * @brief 套用 RS485 鮑率(帶快取)
  *
  * 功能說明:
- * 使用標準公式將 RTD 電阻值轉換為溫度值,支援 PT100/PT1000 等不同基準電阻。
+ * 僅在鮑率與該埠最後一次成功套用的值不同,或該埠 PID 變化(重新連線)時,
+ * 才送出 CModbusUartBaudrate 封包,減少每次 RS485 存取的 HID 往返次數。
+ * 呼叫端須持有 _rs485_port_lock() 取得的埠鎖。
  *
- * @param resistance_mohm 電阻值(毫歐姆 mΩ)
- * @param base_resistance 基準電阻(歐姆 Ω)
- *                        - 100: PT100
- *                        - 1000: PT1000
+ * @param state 已上鎖的埠狀態, NULL 表示埠號超出範圍(不使用快取)
+ * @param hid_port HID 埠號
+ * @param baudrate 鮑率
  *
- * @return float 溫度值(攝氏度)
- *
- * 轉換公式:
- * - T = (R - R0) / (A * R0)
- * - A = 0.00385 (溫度係數)
+ * @return int 執行結果
+ *         - SUCCESS: 已套用或無需重送
+ *         - 其他值: 設定失敗(快取會被清除)
  */
-static float _resistance_to_temperature(uint32_t resistance_mohm, uint16_t base_resistance)
+static int _rs485_baudrate_apply_locked(rs485_port_state_t *state, uint8_t hid_port, uint32_t baudrate)
+{
+    int ret = SUCCESS;
+
+    if (state == NULL) {
+        __atomic_add_fetch(&_rs485_baudrate_set_count, 1, __ATOMIC_RELAXED);
+        return CModbusUartBaudrate(RS485_HID_PID, hid_port, baudrate);
+    }
+
+    uint16_t pid = 0;
+    hid_manager_port_pid_get(hid_port, &pid);
+
+    if (state->baudrate == baudrate && state->pid == pid) {
+        __atomic_add_fetch(&_rs485_baudrate_skip_count, 1, __ATOMIC_RELAXED);
+    } else {
+        ret = CModbusUartBaudrate(RS485_HID_PID, hid_port, baudrate);
+        __atomic_add_fetch(&_rs485_baudrate_set_count, 1, __ATOMIC_RELAXED);
+        if (ret == SUCCESS) {
+            state->baudrate = baudrate;
+            state->pid = pid;
+        } else {
+            state->baudrate = 0;
+            error(tag, "port %d set baudrate %u failed, ret = %d", hid_port, baudrate, ret);
+        }
+    }
+
+    return ret;
+}
+
+/* 傳輸失敗後橋接器狀態未知, 下次存取重新設定鮑率(呼叫端持有埠鎖) */
+static void _rs485_baudrate_invalidate_locked(rs485_port_state_t *state)
+{
+    if (state) {
+        state->baudrate = 0;
+    }
+}
+
+void control_hardware_rs485_baudrate_invalidate(uint8_t hid_port)
 {
-    /* 基準電阻轉換為毫歐姆 */
-    float R0_mohm = base_resistance * 1000.0f;
-    /* 溫度係數 */
-    float A = 0.00385f;
-    float temp = 0.0f;
-
-    /* T = (R - R0) / (A * R0) */
-    temp = ((float)resistance_mohm - R0_mohm) / (A * R0_mohm);
-
-    /* 電阻為0時溫度設為0 */
-    if (resistance_mohm == 0) {
-        temp = 0.0f;
+    if (hid_port >= HID_DEVICES_MAX) {
+        return;
     }
 
-    return temp;
+    _hid_transaction_lock(hid_port);
+    _rs485_port_state[hid_port].baudrate = 0;
+    _hid_transaction_unlock(hid_port);
+}
+
+void control_hardware_rs485_baudrate_stats_get(uint32_t *set_count, uint32_t *skip_count)
+{
+    if (set_count) *set_count = __atomic_load_n(&_rs485_baudrate_set_count, __ATOMIC_RELAXED);
+    if (skip_count) *skip_count = __atomic_load_n(&_rs485_baudrate_skip_count, __ATOMIC_RELAXED);
 }
 
 int control_hardware_rs485_pressure_get(uint8_t hid_port, uint16_t baudrate, uint8_t slave_id, uint8_t function_code, 
     uint16_t address, float *pressure, uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
@@ -136,7 +259,8 @@ int control_hardware_rs485_pressure_get(uint8_t hid_port, uint16_t baudrate, uin
     uint8_t packet[64];
     uint8_t recvbuf[64];
 
-    CModbusUartBaudrate(hid_pid, hid_port, baudrate);
+    rs485_port_state_t *state = _rs485_port_lock(hid_port);
+    _rs485_baudrate_apply_locked(state, hid_port, baudrate);
 
     CModbusReadPacketEx(packet, slave_id, function_code, address, 1);
 
@@ -153,9 +277,14 @@ int control_hardware_rs485_pressure_get(uint8_t hid_port, uint16_t baudrate, uin
         *pressure = ((content[0] * 256 + content[1]) / 100.0f);
         ret = SUCCESS;
     } else {
+        _rs485_baudrate_invalidate_locked(state);
         ret = FAIL;
     }
 
+    _rs485_port_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_RS485_READ, start_ns);
+
     return ret;
 }
 
@@ -163,6 +292,7 @@ int control_hardware_rs485_multiple_read(uint8_t hid_port, uint32_t baudrate, ui
         uint16_t address, uint16_t quantity, uint16_t *values, uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
@@ -175,6 +305,9 @@ int control_hardware_rs485_multiple_read(uint8_t hid_port, uint32_t baudrate, ui
     uint16_t current_address = address;
     uint16_t values_index = 0;
 
+    rs485_port_state_t *state = _rs485_port_lock(hid_port);
+    _rs485_baudrate_apply_locked(state, hid_port, baudrate);
+
     while (remaining > 0) {
         uint16_t current_quantity = (remaining > max_quantity_per_packet) ? max_quantity_per_packet : remaining;
         
@@ -183,8 +316,6 @@ int control_hardware_rs485_multiple_read(uint8_t hid_port, uint32_t baudrate, ui
 
         // debug(tag, "current_address = %d, current_quantity = %d", current_address, current_quantity);
 
-        CModbusUartBaudrate(hid_pid, hid_port, baudrate);
-
         CModbusReadPacketEx(packet, slave_id, function_code, current_address, current_quantity);
 
         hid_manager_write(hid_pid, hid_port, packet, 64, timeout_ms);
@@ -214,6 +345,7 @@ int control_hardware_rs485_multiple_read(uint8_t hid_port, uint32_t baudrate, ui
                 }
             }
         } else {
+            _rs485_baudrate_invalidate_locked(state);
             ret = FAIL;
             break;
         }
@@ -223,6 +355,10 @@ int control_hardware_rs485_multiple_read(uint8_t hid_port, uint32_t baudrate, ui
         values_index += current_quantity;
     }
 
+    _rs485_port_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_RS485_READ, start_ns);
+
     return ret;
 }
 
@@ -230,6 +366,7 @@ int control_hardware_rs485_single_read(uint8_t hid_port, uint16_t baudrate, uint
     uint16_t address, uint16_t *val, uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
@@ -238,7 +375,8 @@ int control_hardware_rs485_single_read(uint8_t hid_port, uint16_t baudrate, uint
     uint8_t packet[64];
     uint8_t recvbuf[64];
 
-    CModbusUartBaudrate(hid_pid, hid_port, baudrate);
+    rs485_port_state_t *state = _rs485_port_lock(hid_port);
+    _rs485_baudrate_apply_locked(state, hid_port, baudrate);
 
     CModbusReadPacketEx(packet, slave_id, function_code, address, 1);
 
@@ -254,22 +392,29 @@ int control_hardware_rs485_single_read(uint8_t hid_port, uint16_t baudrate, uint
         *val = (content[0] * 256 + content[1]);
         ret = SUCCESS;
     } else {
+        _rs485_baudrate_invalidate_locked(state);
         ret = FAIL;
     }
 
+    _rs485_port_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_RS485_READ, start_ns);
+
     return ret;
 }
 
 int control_hardware_rs485_single_write(uint8_t hid_port, uint16_t baudrate, uint8_t slave_id, uint16_t address, uint16_t val)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
     uint8_t packet[64];
     uint8_t recvbuf[64];
 
-    CModbusUartBaudrate(hid_pid, hid_port, baudrate);
+    rs485_port_state_t *state = _rs485_port_lock(hid_port);
+    _rs485_baudrate_apply_locked(state, hid_port, baudrate);
 
     CModbusWritePacket(packet, slave_id, address, val);
 
@@ -280,15 +425,21 @@ int control_hardware_rs485_single_write(uint8_t hid_port, uint16_t baudrate, uin
 
     int ret_read = hid_manager_read(hid_pid, hid_port, recvbuf, 64, 1000);
     if (ret_read < 0) {
+        _rs485_baudrate_invalidate_locked(state);
         ret = FAIL;
     }
 
+    _rs485_port_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_RS485_WRITE, start_ns);
+
     return ret;
 }
 
 int control_hardware_analog_input_current_get(uint8_t hid_port, uint8_t channel, int32_t *uA, uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
     uint16_t address = 0;
@@ -315,15 +466,20 @@ int control_hardware_analog_input_current_get(uint8_t hid_port, uint8_t channel,
             break;
     }
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD74416hGetInput(hid_pid, hid_port, address, 1, uA, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] ch %d, AI_value = %d (uA), ret = %d", hid_port, channel, *uA, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AI_GET, start_ns);
+
     return ret;
 }
 
 int control_hardware_analog_input_current_all_get(uint8_t hid_port, int32_t uA[4], uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
     uint16_t address = DK_MODBUS_AD74416H_GET_CURRENT_INPUT_CH_A;
@@ -333,8 +489,43 @@ int control_hardware_analog_input_current_all_get(uint8_t hid_port, int32_t uA[4
     uA[2] = 0;
     uA[3] = 0;
     
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD74416hGetInput(hid_pid, hid_port, address, 4, uA, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AI_GET, start_ns);
+
+    return ret;
+}
+
+/**
+ * @brief 從硬體讀回四個通道的模式並填入快取
+ *
+ * 呼叫前須持有該埠的快取鎖
+ */
+static int _ai_mode_read_locked(uint8_t hid_port, ai_mode_port_state_t *state, uint16_t pid, uint16_t timeout_ms)
+{
+    uint64_t start_ns = control_logic_latency_start();
+    uint16_t mode[4] = {0};
+    int ret;
+
+    _hid_transaction_lock(hid_port);
+    ret = CModbusAD74416hGetMode(HID_IO_BOARD_PID, hid_port, DK_MODBUS_AD74416H_SET_MODE_CH_A, 4, mode, timeout_ms);
+    _hid_transaction_unlock(hid_port);
+    // debug(tag, "port %d, mode[0] = %d, mode[1] = %d, mode[2] = %d, mode[3] = %d", hid_port, mode[0], mode[1], mode[2], mode[3]);
+    __atomic_add_fetch(&_ai_mode_read_count, 1, __ATOMIC_RELAXED);
+
+    if (ret == SUCCESS) {
+        memcpy(state->mode, mode, sizeof(state->mode));
+        state->valid = 0x0F;
+        state->pid = pid;
+        state->read_ms = time_get_current_ms();
+    } else {
+        state->valid = 0;
+    }
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AI_GET, start_ns);
+
     return ret;
 }
 
@@ -342,20 +533,96 @@ int control_hardware_analog_mode_all_get(uint8_t hid_port, uint16_t mode[4], uin
 {
     int ret = SUCCESS;
 
-    uint16_t hid_pid = 0xA2;
-    uint16_t address = DK_MODBUS_AD74416H_SET_MODE_CH_A;
-    
     mode[0] = 0;
     mode[1] = 0;
     mode[2] = 0;
     mode[3] = 0;
-    
-    ret = CModbusAD74416hGetMode(hid_pid, hid_port, address, 4, mode, timeout_ms);
-    // debug(tag, "port %d, mode[0] = %d, mode[1] = %d, mode[2] = %d, mode[3] = %d", hid_port, mode[0], mode[1], mode[2], mode[3]);
-    
+
+    if (hid_port >= HID_DEVICES_MAX) {
+        return FAIL;
+    }
+
+    uint16_t pid = 0;
+    hid_manager_port_pid_get(hid_port, &pid);
+
+    ai_mode_port_state_t *state = &_ai_mode_port_state[hid_port];
+
+    pthread_mutex_lock(&state->lock);
+    ret = _ai_mode_read_locked(hid_port, state, pid, timeout_ms);
+    if (ret == SUCCESS) {
+        memcpy(mode, state->mode, sizeof(state->mode));
+    }
+    pthread_mutex_unlock(&state->lock);
+
     return ret;
 }
 
+int control_hardware_analog_mode_all_get_cached(uint8_t hid_port, uint16_t mode[4], uint32_t max_age_ms, uint16_t timeout_ms)
+{
+    int ret = SUCCESS;
+
+    mode[0] = 0;
+    mode[1] = 0;
+    mode[2] = 0;
+    mode[3] = 0;
+
+    if (hid_port >= HID_DEVICES_MAX) {
+        return FAIL;
+    }
+
+    uint16_t pid = 0;
+    hid_manager_port_pid_get(hid_port, &pid);
+
+    ai_mode_port_state_t *state = &_ai_mode_port_state[hid_port];
+
+    pthread_mutex_lock(&state->lock);
+
+    if (state->valid == 0x0F && state->pid == pid && time_get_current_ms() - state->read_ms < max_age_ms) {
+        __atomic_add_fetch(&_ai_mode_hit_count, 1, __ATOMIC_RELAXED);
+    } else {
+        if (state->valid == 0x0F && state->pid == pid) {
+            /* 稽核: 與快取不同表示模式被繞過本模組改變(例如板子重置) */
+            uint16_t cached[4];
+            memcpy(cached, state->mode, sizeof(cached));
+            ret = _ai_mode_read_locked(hid_port, state, pid, timeout_ms);
+            if (ret == SUCCESS && memcmp(cached, state->mode, sizeof(cached)) != 0) {
+                warn(tag, "port %d AI/AO mode changed behind the cache: %d %d %d %d -> %d %d %d %d", hid_port,
+                     cached[0], cached[1], cached[2], cached[3],
+                     state->mode[0], state->mode[1], state->mode[2], state->mode[3]);
+            }
+        } else {
+            ret = _ai_mode_read_locked(hid_port, state, pid, timeout_ms);
+        }
+    }
+
+    if (ret == SUCCESS) {
+        memcpy(mode, state->mode, sizeof(state->mode));
+    }
+
+    pthread_mutex_unlock(&state->lock);
+
+    return ret;
+}
+
+void control_hardware_analog_mode_invalidate(uint8_t hid_port)
+{
+    if (hid_port >= HID_DEVICES_MAX) {
+        return;
+    }
+
+    pthread_mutex_lock(&_ai_mode_port_state[hid_port].lock);
+    _ai_mode_port_state[hid_port].valid = 0;
+    pthread_mutex_unlock(&_ai_mode_port_state[hid_port].lock);
+}
+
+void control_hardware_analog_mode_stats_get(uint32_t *read_count, uint32_t *hit_count, uint32_t *set_count, uint32_t *skip_count)
+{
+    if (read_count) *read_count = __atomic_load_n(&_ai_mode_read_count, __ATOMIC_RELAXED);
+    if (hit_count) *hit_count = __atomic_load_n(&_ai_mode_hit_count, __ATOMIC_RELAXED);
+    if (set_count) *set_count = __atomic_load_n(&_ai_mode_set_count, __ATOMIC_RELAXED);
+    if (skip_count) *skip_count = __atomic_load_n(&_ai_mode_skip_count, __ATOMIC_RELAXED);
+}
+
 int control_hardware_analog_input_current_get_from_ram(uint8_t hid_port, uint8_t channel, int32_t *mA)
 {
     int ret = SUCCESS;
@@ -389,8 +656,7 @@ int control_hardware_analog_input_current_get_from_ram(uint8_t hid_port, uint8_t
         modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
         if (mapping != NULL) {
             AppConvertUint32_16 conv;
-            conv.words.u16_byte[0] = mapping->tab_registers[address];
-            conv.words.u16_byte[1] = mapping->tab_registers[address+1];
+            control_logic_load_from_modbus_table(address, MODBUS_TYPE_UINT32, &conv);
             *mA = conv.val;
         } else {
             ret = FAIL;
@@ -405,6 +671,7 @@ int control_hardware_analog_input_current_get_from_ram(uint8_t hid_port, uint8_t
 int control_hardware_analog_input_voltage_get(uint8_t hid_port, uint8_t channel, int32_t *mV, uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
     uint16_t address = 0;
@@ -431,15 +698,20 @@ int control_hardware_analog_input_voltage_get(uint8_t hid_port, uint8_t channel,
             break;
     }
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD74416hGetInput(hid_pid, hid_port, address, 1, mV, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] ch %d, AI_value = %d (mA), ret = %d", hid_port, channel, *mA, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AI_GET, start_ns);
+
     return ret;
 }
 
 int control_hardware_analog_input_voltage_all_get(uint8_t hid_port, int32_t mV[4], uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
     uint16_t address = DK_MODBUS_AD74416H_GET_VOLTAGE_INPUT_CH_A;
@@ -449,7 +721,11 @@ int control_hardware_analog_input_voltage_all_get(uint8_t hid_port, int32_t mV[4
     mV[2] = 0;
     mV[3] = 0;
     
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD74416hGetInput(hid_pid, hid_port, address, 4, mV, timeout_ms);
+    _hid_transaction_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AI_GET, start_ns);
 
     return ret;
 }
@@ -487,8 +763,7 @@ int control_hardware_analog_input_voltage_get_from_ram(uint8_t hid_port, uint8_t
         modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
         if (mapping != NULL) {
             AppConvertUint32_16 conv;
-            conv.words.u16_byte[0] = mapping->tab_registers[address];
-            conv.words.u16_byte[1] = mapping->tab_registers[address+1];
+            control_logic_load_from_modbus_table(address, MODBUS_TYPE_UINT32, &conv);
             *mV = conv.val;
         } else {
             ret = FAIL;
@@ -503,6 +778,7 @@ int control_hardware_analog_input_voltage_get_from_ram(uint8_t hid_port, uint8_t
 int control_hardware_analog_output_current_set(uint8_t hid_port, uint8_t channel, uint32_t val, uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
     uint16_t address = 0;
@@ -527,8 +803,16 @@ int control_hardware_analog_output_current_set(uint8_t hid_port, uint8_t channel
             break;
     }
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD74416hCurrentOutput(hid_pid, hid_port, address, val, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] ch %d, AI_value = %d (mA), ret = %d", hid_port, channel, *mA, ret);
+    if (ret != SUCCESS) {
+        /* 板子可能已重置,下一次設定模式時重送 */
+        control_hardware_analog_mode_invalidate(hid_port);
+    }
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AO_SET, start_ns);
 
     return ret;
 }
@@ -537,6 +821,7 @@ int control_hardware_analog_output_current_set(uint8_t hid_port, uint8_t channel
 int control_hardware_analog_output_voltage_set(uint8_t hid_port, uint8_t channel, uint32_t val, uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
     uint16_t address = 0;
@@ -561,7 +846,15 @@ int control_hardware_analog_output_voltage_set(uint8_t hid_port, uint8_t channel
             break;
     }
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD74416hVoltageOutput(hid_pid, hid_port, address, val, timeout_ms);
+    _hid_transaction_unlock(hid_port);
+    if (ret != SUCCESS) {
+        /* 板子可能已重置,下一次設定模式時重送 */
+        control_hardware_analog_mode_invalidate(hid_port);
+    }
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AO_SET, start_ns);
 
     return ret;
 }
@@ -569,6 +862,7 @@ int control_hardware_analog_output_voltage_set(uint8_t hid_port, uint8_t channel
 int control_hardware_digital_input_get(uint8_t hid_port, uint8_t channel, uint16_t *value)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
 
@@ -577,24 +871,33 @@ int control_hardware_digital_input_get(uint8_t hid_port, uint8_t channel, uint16
     // channel to digital input address
     uint16_t digital_input_address = DK_MODBUS_GPIO_INPUT_0 + channel;
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusGPIOStatus(hid_pid, hid_port, digital_input_address, 1, value);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] DI[%d] = %d, ret = %d", hid_port, channel, *value, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_DIO_GET, start_ns);
+
     return ret;
 }
 
 int control_hardware_digital_input_all_get(uint8_t hid_port, uint16_t value[8])
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
 
     // channel to digital input address
     uint16_t digital_input_address = DK_MODBUS_GPIO_INPUT_0;
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusGPIOStatus(hid_pid, hid_port, digital_input_address, 8, value);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] DI[%d] = %d, ret = %d", hid_port, channel, *value, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_DIO_GET, start_ns);
+
     return ret;
 }
 
@@ -613,14 +916,7 @@ int control_hardware_digital_input_all_get_from_ram(uint8_t hid_port, uint16_t v
 
     uint16_t address =  HID_BASE_ADDRESS + (hid_port * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_GPIO_INPUT_0;
 
-    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
-    if (mapping != NULL) {
-        for (int i = 0; i < 8; i++) {
-            value[i] = mapping->tab_registers[address + i];
-        }
-    } else {
-        ret = FAIL;
-    }
+    ret = control_logic_load_from_modbus_table_range(address, 8, value);
 
     return ret;
 }
@@ -636,14 +932,7 @@ int control_hardware_analog_mode_all_get_from_ram(uint8_t hid_port, uint16_t val
 
     uint16_t address =  HID_BASE_ADDRESS + (hid_port * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_AD74416H_CH_A_SET_MODE;
 
-    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
-    if (mapping != NULL) {
-        for (int i = 0; i < 4; i++) {
-            value[i] = mapping->tab_registers[address + i];
-        }
-    } else {
-        ret = FAIL;
-    }
+    ret = control_logic_load_from_modbus_table_range(address, 4, value);
 
     return ret;
 }
@@ -651,15 +940,20 @@ int control_hardware_analog_mode_all_get_from_ram(uint8_t hid_port, uint16_t val
 int control_hardware_digital_output_all_get(uint8_t hid_port, uint16_t value[8])
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
     
     // channel to digital output address
     uint16_t address = DK_MODBUS_GPIO_OUTPUT_0;
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusGPIOStatus(hid_pid, hid_port, address, 8, value);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] DO[%d] = %d, ret = %d", hid_port, channel, value, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_DIO_GET, start_ns);
+
     return ret;
 }
 
@@ -678,14 +972,7 @@ int control_hardware_digital_output_all_get_from_ram(uint8_t hid_port, uint16_t
 
     uint16_t address =  HID_BASE_ADDRESS + (hid_port * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_GPIO_OUTPUT_0;
 
-    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
-    if (mapping != NULL) {
-        for (int i = 0; i < 8; i++) {
-            value[i] = mapping->tab_registers[address + i];
-        }
-    } else {
-        ret = FAIL;
-    }
+    ret = control_logic_load_from_modbus_table_range(address, 8, value);
 
     return ret;
 }
@@ -693,33 +980,44 @@ int control_hardware_digital_output_all_get_from_ram(uint8_t hid_port, uint16_t
 int control_hardware_digital_output_set(uint8_t hid_port, uint8_t channel, uint16_t value, uint16_t timeout_ms)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
 
     // channel to digital output address
     uint16_t digital_output_address = DK_MODBUS_GPIO_OUTPUT_0 + channel;
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusGPIOOutput(hid_pid, hid_port, digital_output_address, value, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] DO[%d] = %d, ret = %d", hid_port, channel, value, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_DO_SET, start_ns);
+
     return ret;
 }
 
 int control_hardware_digital_output_all_set(uint8_t hid_port, uint16_t val)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA2;
         
+    _hid_transaction_lock(hid_port);
     ret = CModbusGPIOOutputAll(hid_pid, hid_port, val, val, val, val, val, val, val, val);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] gpio_output = %d, ret = %d", hid_port, out, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_DO_SET, start_ns);
+
     return ret;
 }
 
 int control_hardware_temperature_get(uint8_t hid_port, uint8_t channel, uint16_t timeout_ms, float *temp_float) 
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
     uint32_t read_value = 0;
@@ -730,20 +1028,24 @@ int control_hardware_temperature_get(uint8_t hid_port, uint8_t channel, uint16_t
     *temp_float = 0.0f;
     
     // get resistance
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD7124GetResistance(hid_pid, hid_port, rtd_address, 1, &read_value, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     if (ret == SUCCESS) {
-        // resistance to temperature
-        uint32_t resistance_mohm = read_value*10; // 0.01 ohm to mohm
-        *temp_float = _pt100_resistance_to_temp_float(resistance_mohm);
+        // resistance (0.01 ohm) to temperature, PT100
+        *temp_float = control_logic_rtd_temperature(read_value, 100);
         // debug(tag, "[port %d] RTD_%d_temp = %.2f, ret = %d", hid_port, 0, *temp_float, ret);
     }
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_RTD_GET, start_ns);
+
     return ret;
 }
 
 int control_hardware_temperature_all_get(uint8_t hid_port, uint16_t timeout_ms, int32_t temperature[8]) 
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
     uint32_t read_value[8] = {0};
@@ -751,52 +1053,52 @@ int control_hardware_temperature_all_get(uint8_t hid_port, uint16_t timeout_ms,
     // channel to rtd address
     uint16_t rtd_address = DK_MODBUS_AD7124_GET_RESISTANCE_CH_0;
 
-    float temp_float = 0.0f;
-    
     // get resistance
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD7124GetResistance(hid_pid, hid_port, rtd_address, 8, read_value, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     if (ret == SUCCESS) {
+        int16_t update_address[8];
+        uint8_t temperature_sensor_type[8];
+
+        control_logic_config_read_lock();
         int config_count = 0;
         temperature_config_t *temperature_configs = control_logic_temperature_configs_get(&config_count);
-        // for each channel
+        // get temperature sensor type and update address of each channel
         for (int i = 0; i < 8; i++) {
-            int16_t update_address = -1;
-            uint8_t temperature_sensor_type = 0;
-    
-            // get temperature sensor type
+            update_address[i] = -1;
+            temperature_sensor_type[i] = CONTROL_LOGIC_RTD_PT100;
+
             for (int j = 0; j < config_count; j++) {
                 if (temperature_configs != NULL) {
                     if (temperature_configs[j].port == hid_port && temperature_configs[j].channel == i) {
-                        update_address = temperature_configs[j].update_address;
-                        temperature_sensor_type = temperature_configs[j].sensor_type;
+                        update_address[i] = temperature_configs[j].update_address;
+                        temperature_sensor_type[i] = temperature_configs[j].sensor_type;
                         break;
                     }
                 }
             }
-            // 0.01 ohm to mohm
-            uint32_t resistance_mohm = read_value[i]*10; // 0.01 ohm to mohm
-            switch (temperature_sensor_type) {
-                default:
-                case 0: // PT100
-                    temp_float = _resistance_to_temperature(resistance_mohm, 100);
-                    // 12.3 to 123 for HMI
-                    temperature[i] = (int32_t)lroundf(temp_float * 10);
-                    break;
-                case 1: // PT1000
-                    temp_float = _resistance_to_temperature(resistance_mohm, 1000);
-                    // 12.3 to 123 for HMI
-                    temperature[i] = (int32_t)lroundf(temp_float * 10);
-                    break;
-            }
+        }
+
+        // all channels at once, 0.01 ohm to 0.1 C (12.3 to 123 for HMI)
+        control_logic_rtd_temperature_batch(read_value, temperature_sensor_type, 8, temperature);
 
-            // update to modbus table
-            if (update_address >= 0) {
-                control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_INT32, &temperature[i]);
+        // update to modbus table, all configured channels in one publication
+        control_logic_modbus_write_t batch[8];
+        uint16_t batch_count = 0;
+        for (int i = 0; i < 8; i++) {
+            if (update_address[i] >= 0) {
+                batch[batch_count++] = (control_logic_modbus_write_t){ .address = (uint16_t)update_address[i], .type = MODBUS_TYPE_INT32, .value.i32 = temperature[i] };
             }
-            // debug(tag, "[port %d] RTD_%d_temp = %.2f, ret = %d", hid_port, i, temp_float[i], ret);
         }
+        if (batch_count > 0) {
+            control_logic_update_to_modbus_table_batch(batch, batch_count);
+        }
+        control_logic_config_read_unlock();
     }
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_RTD_GET, start_ns);
+
     return ret;
 }
 
@@ -815,8 +1117,7 @@ int control_hardware_temperature_get_from_ram(uint8_t hid_port, uint8_t channel,
     // get resistan
     if (mapping != NULL) {
         AppConvertUint32_16 conv;
-        conv.words.u16_byte[0] = mapping->tab_registers[address];
-        conv.words.u16_byte[1] = mapping->tab_registers[address+1];
+        control_logic_load_from_modbus_table(address, MODBUS_TYPE_UINT32, &conv);
         *temp = conv.val;
     } else {
         ret = FAIL;
@@ -845,8 +1146,7 @@ int control_hardware_temperature_all_get_from_ram(uint8_t hid_port, int32_t temp
     if (mapping != NULL) {
         for (int i = 0; i < 8; i++) {
             AppConvertUint32_16 conv;
-            conv.words.u16_byte[0] = mapping->tab_registers[address + i*2];
-            conv.words.u16_byte[1] = mapping->tab_registers[address + i*2 + 1];
+            control_logic_load_from_modbus_table(address + i*2, MODBUS_TYPE_UINT32, &conv);
             temperature[i] = conv.val;
         }
     } else {
@@ -859,6 +1159,7 @@ int control_hardware_temperature_all_get_from_ram(uint8_t hid_port, int32_t temp
 int control_hardware_resistor_all_get(uint8_t hid_port, uint16_t timeout_ms, uint32_t resistor[8]) 
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
@@ -866,7 +1167,11 @@ int control_hardware_resistor_all_get(uint8_t hid_port, uint16_t timeout_ms, uin
     uint16_t rtd_address = DK_MODBUS_AD7124_GET_RESISTANCE_CH_0;
 
     // get resistance
+    _hid_transaction_lock(hid_port);
     ret = CModbusAD7124GetResistance(hid_pid, hid_port, rtd_address, 8, resistor, timeout_ms);
+    _hid_transaction_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_RTD_GET, start_ns);
 
     return ret;
 }
@@ -874,6 +1179,7 @@ int control_hardware_resistor_all_get(uint8_t hid_port, uint16_t timeout_ms, uin
 int control_hardware_pwm_rpm_get(uint8_t hid_port, uint8_t channel, uint16_t timeout_ms, float *rpm)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
     uint32_t pwm_period = 0;
@@ -883,7 +1189,9 @@ int control_hardware_pwm_rpm_get(uint8_t hid_port, uint8_t channel, uint16_t tim
 
     *rpm = 0.0f;
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusCapPWMFrequency(hid_pid, hid_port, pwm_address, 1, &pwm_period, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     if (ret == SUCCESS) {
         // debug(tag, "[port %d] pwm_%d_period = %d, ret = %d", hid_port, 0, pwm_period, ret);
         
@@ -899,6 +1207,8 @@ int control_hardware_pwm_rpm_get(uint8_t hid_port, uint8_t channel, uint16_t tim
         // debug(tag, "[port %d] pwm_%d_rpm = %f", hid_port, 0, rpm);
     }
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_PWM_GET, start_ns);
+
     return ret;
 }
 
@@ -918,8 +1228,7 @@ int control_hardware_pwm_rpm_get_from_ram(uint8_t hid_port, uint8_t channel, flo
         uint16_t target_address = HID_BASE_ADDRESS + (hid_port * HID_RTD_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_CAPTURE_PWM_0_FREQ + (channel*2);
 
         AppConvertUint32_16 conv;
-        conv.words.u16_byte[0] = mapping->tab_registers[target_address];
-        conv.words.u16_byte[1] = mapping->tab_registers[target_address+1];
+        control_logic_load_from_modbus_table(target_address, MODBUS_TYPE_UINT32, &conv);
         pwm_period = conv.val;
 
         // us to s
@@ -942,12 +1251,17 @@ int control_hardware_pwm_rpm_get_from_ram(uint8_t hid_port, uint8_t channel, flo
 int control_hardware_pwm_period_all_get(uint8_t hid_port, uint32_t period[8])
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
     uint16_t address = DK_MODBUS_CAP_PWM_PULSE_WIDTH_0;
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusCapPWMPulseWidth(hid_pid, hid_port, address, 8, period);
+    _hid_transaction_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_PWM_GET, start_ns);
 
     return ret;
 }
@@ -955,13 +1269,18 @@ int control_hardware_pwm_period_all_get(uint8_t hid_port, uint32_t period[8])
 int control_hardware_pwm_freq_all_get(uint8_t hid_port, uint16_t timeout_ms, uint32_t freq[8])
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
     // channel to pwm address
     uint16_t pwm_address = DK_MODBUS_CAP_PWM_FREQ_0;
 
+    _hid_transaction_lock(hid_port);
     ret = CModbusCapPWMFrequency(hid_pid, hid_port, pwm_address, 8, freq, timeout_ms);
+    _hid_transaction_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_PWM_GET, start_ns);
 
     return ret;
 }
@@ -985,8 +1304,7 @@ int control_hardware_pwm_freq_all_get_from_ram(uint8_t hid_port, uint32_t freq[8
     if (mapping != NULL) {
         for (int i = 0; i < 8; i++) {
             AppConvertUint32_16 conv;
-            conv.words.u16_byte[0] = mapping->tab_registers[address + i*2];
-            conv.words.u16_byte[1] = mapping->tab_registers[address + i*2 + 1];
+            control_logic_load_from_modbus_table(address + i*2, MODBUS_TYPE_UINT32, &conv);
             freq[i] = conv.val;
         }
     } else {
@@ -1000,6 +1318,7 @@ int control_hardware_pwm_freq_all_get_from_ram(uint8_t hid_port, uint32_t freq[8
 int control_hardware_pwm_duty_set(uint8_t hid_port, uint8_t channel, uint16_t duty)
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
@@ -1013,15 +1332,20 @@ int control_hardware_pwm_duty_set(uint8_t hid_port, uint8_t channel, uint16_t du
     }
 
     // set duty
+    _hid_transaction_lock(hid_port);
     ret = CModbusPWMOutputSetDuty(hid_pid, hid_port, duty_address, duty);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] pwm%d_duty = %d, ret = %d", hid_port, channel, duty, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_PWM_SET, start_ns);
+
     return ret;
 }
 
 int control_hardware_pwm_duty_all_get(uint8_t hid_port, uint16_t timeout_ms, uint16_t duty[8])
 {
     int ret = SUCCESS;
+    uint64_t start_ns = control_logic_latency_start();
 
     uint16_t hid_pid = 0xA3;
 
@@ -1029,9 +1353,13 @@ int control_hardware_pwm_duty_all_get(uint8_t hid_port, uint16_t timeout_ms, uin
     uint16_t address = DK_MODBUS_CAP_PWM_DUTY_0;
 
     // get duty
+    _hid_transaction_lock(hid_port);
     ret = CModbusPWMOutputGetDuty(hid_pid, hid_port, address, 8, duty, timeout_ms);
+    _hid_transaction_unlock(hid_port);
     // debug(tag, "[port %d] pwm%d_duty = %d, ret = %d", hid_port, channel, duty, ret);
 
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_PWM_GET, start_ns);
+
     return ret;
 }
 
@@ -1050,14 +1378,7 @@ int control_hardware_pwm_duty_all_get_from_ram(uint8_t hid_port, uint16_t duty[8
 
     uint16_t address =  HID_BASE_ADDRESS + (hid_port * HID_RTD_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_CAPTURE_PWM_0_DUTY;
 
-    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
-    if (mapping != NULL) {
-        for (int i = 0; i < 8; i++) {
-            duty[i] = mapping->tab_registers[address + i];
-        }
-    } else {
-        ret = FAIL;
-    }
+    ret = control_logic_load_from_modbus_table_range(address, 8, duty);
 
     return ret;
 }
@@ -1081,8 +1402,7 @@ int control_hardware_pwm_period_all_get_from_ram(uint8_t hid_port, uint32_t peri
     if (mapping != NULL) {
         for (int i = 0; i < 8; i++) {
             AppConvertUint32_16 conv;
-            conv.words.u16_byte[0] = mapping->tab_registers[address + i*2];
-            conv.words.u16_byte[1] = mapping->tab_registers[address + i*2 + 1];
+            control_logic_load_from_modbus_table(address + i*2, MODBUS_TYPE_UINT32, &conv);
             period[i] = conv.val;
         }
     } else {
@@ -1095,7 +1415,14 @@ int control_hardware_pwm_period_all_get_from_ram(uint8_t hid_port, uint32_t peri
 
 int control_hardware_pwm_freq_set(uint8_t hid_port, uint32_t frequency)
 {
-    int ret = CModbusPWMOutputSetFrequency(HID_RTD_BOARD_PID, hid_port, frequency);
+    uint64_t start_ns = control_logic_latency_start();
+    int ret;
+
+    _hid_transaction_lock(hid_port);
+    ret = CModbusPWMOutputSetFrequency(HID_RTD_BOARD_PID, hid_port, frequency);
+    _hid_transaction_unlock(hid_port);
+
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_PWM_SET, start_ns);
 
     return ret;
 }
@@ -1114,16 +1441,57 @@ int control_hardware_AI_AO_mode_set(uint8_t hid_port, uint8_t channel, AI_AO_MOD
         case AI_AO_MODE_VOLTAGE_IN:
         case AI_AO_MODE_CURRENT_IN_LOOP:
         case AI_AO_MODE_CURRENT_IN_EXTERNAL:
-            ret = CModbusAD74416hSetMode(hid_pid, hid_port, address, mode, timeout_ms);
-            // debug(tag, "[port %d] ch %d, AI_AO_mode = %d, ret = %d", hid_port, channel, mode, ret);
             break;
 
         default:
             error(tag, "invalid AI_AO_MODE: %d", mode);
-            ret = FAIL;
-            break;
+            return FAIL;
     }
 
+    if (hid_port >= HID_DEVICES_MAX || channel >= 4) {
+        __atomic_add_fetch(&_ai_mode_set_count, 1, __ATOMIC_RELAXED);
+        uint64_t start_ns = control_logic_latency_start();
+        _hid_transaction_lock(hid_port);
+        ret = CModbusAD74416hSetMode(hid_pid, hid_port, address, mode, timeout_ms);
+        _hid_transaction_unlock(hid_port);
+        control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AO_SET, start_ns);
+        return ret;
+    }
+
+    uint16_t pid = 0;
+    hid_manager_port_pid_get(hid_port, &pid);
+
+    ai_mode_port_state_t *state = &_ai_mode_port_state[hid_port];
+
+    pthread_mutex_lock(&state->lock);
+
+    if ((state->valid & (1u << channel)) && state->pid == pid && state->mode[channel] == (uint16_t)mode) {
+        __atomic_add_fetch(&_ai_mode_skip_count, 1, __ATOMIC_RELAXED);
+    } else {
+        uint64_t start_ns = control_logic_latency_start();
+        _hid_transaction_lock(hid_port);
+        ret = CModbusAD74416hSetMode(hid_pid, hid_port, address, mode, timeout_ms);
+        _hid_transaction_unlock(hid_port);
+        // debug(tag, "[port %d] ch %d, AI_AO_mode = %d, ret = %d", hid_port, channel, mode, ret);
+        control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_AO_SET, start_ns);
+        __atomic_add_fetch(&_ai_mode_set_count, 1, __ATOMIC_RELAXED);
+
+        if (ret == SUCCESS) {
+            if (state->pid != pid) {
+                /* 重新連線: 其他通道的快取不再可信 */
+                state->valid = 0;
+                state->pid = pid;
+            }
+            state->mode[channel] = (uint16_t)mode;
+            state->valid |= (uint8_t)(1u << channel);
+        } else {
+            state->valid &= (uint8_t)~(1u << channel);
+            error(tag, "port %d ch %d set AI/AO mode %d failed, ret = %d", hid_port, channel, mode, ret);
+        }
+    }
+
+    pthread_mutex_unlock(&state->lock);
+
     return ret;
 }
 
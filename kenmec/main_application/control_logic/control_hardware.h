@@ -105,6 +105,7 @@ int control_hardware_analog_mode_all_get_from_ram(uint8_t hid_port, uint16_t val
  * @brief 設定類比通道的工作模式
  *
  * 配置類比通道的工作模式（電壓/電流，輸入/輸出）。
+ * 快取中該通道已是相同模式時不送出設定，直接返回成功。
  *
  * @param hid_port HID 埠號
  * @param channel 通道號（0-3）
@@ -153,6 +154,40 @@ int control_hardware_analog_input_current_all_get(uint8_t hid_port, int32_t uA[4
  */
 int control_hardware_analog_mode_all_get(uint8_t hid_port, uint16_t mode[4], uint16_t timeout_ms);
 
+/**
+ * @brief 讀取所有類比通道的工作模式(帶快取)
+ *
+ * 快取在 control_hardware_AI_AO_mode_set() 成功時更新;只在快取無效、
+ * HID 裝置重新連線(PID 變化)或距上次讀回超過 max_age_ms 時才向硬體讀取。
+ *
+ * @param hid_port HID 埠號
+ * @param mode 指向 4 元素陣列的指標，存儲各通道的模式
+ * @param max_age_ms 稽核間隔,快取超過此時間即從硬體讀回比對
+ * @param timeout_ms 通訊超時時間（毫秒）
+ * @return 成功返回 0，失敗返回負值錯誤碼
+ */
+int control_hardware_analog_mode_all_get_cached(uint8_t hid_port, uint16_t mode[4], uint32_t max_age_ms, uint16_t timeout_ms);
+
+/**
+ * @brief 清除類比通道模式快取
+ *
+ * 使下一次模式讀取從硬體讀回,下一次模式設定一定送出。類比輸出寫入失敗時
+ * 會自動呼叫,在 HID 裝置拔除或重置 USB hub 後也應呼叫。
+ *
+ * @param hid_port HID 埠號
+ */
+void control_hardware_analog_mode_invalidate(uint8_t hid_port);
+
+/**
+ * @brief 讀取類比通道模式快取統計
+ *
+ * @param read_count 輸出參數，實際送出 CModbusAD74416hGetMode 的次數（可為 NULL）
+ * @param hit_count 輸出參數，由快取回應的讀取次數（可為 NULL）
+ * @param set_count 輸出參數，實際送出 CModbusAD74416hSetMode 的次數（可為 NULL）
+ * @param skip_count 輸出參數，因模式未變而略過的設定次數（可為 NULL）
+ */
+void control_hardware_analog_mode_stats_get(uint32_t *read_count, uint32_t *hit_count, uint32_t *set_count, uint32_t *skip_count);
+
 /**
  * @brief 從 RAM 讀取單一類比電流輸入通道
  *
@@ -300,6 +335,24 @@ int control_hardware_rs485_multiple_read(uint8_t hid_port, uint32_t baudrate, ui
  */
 int control_hardware_rs485_single_write(uint8_t hid_port, uint16_t baudrate, uint8_t slave_id, uint16_t address, uint16_t val);
 
+/**
+ * @brief 清除 RS485 鮑率快取
+ *
+ * 使下一次 RS485 存取重新送出鮑率設定。HID 讀寫失敗時會自動呼叫,
+ * 在 HID 裝置重新連線或重置 USB hub 後也應呼叫。
+ *
+ * @param hid_port HID 埠號
+ */
+void control_hardware_rs485_baudrate_invalidate(uint8_t hid_port);
+
+/**
+ * @brief 讀取 RS485 鮑率設定統計
+ *
+ * @param set_count 輸出參數，實際送出 CModbusUartBaudrate 的次數（可為 NULL）
+ * @param skip_count 輸出參數，因鮑率未變而略過的次數（可為 NULL）
+ */
+void control_hardware_rs485_baudrate_stats_get(uint32_t *set_count, uint32_t *skip_count);
+
 /* ========== 數位輸出 (DO) 函數 ========== */
 
 /**
@@ -154,6 +154,7 @@ int control_logic_output_value_convert(uint8_t port, uint32_t address, uint16_t
         case MODBUS_ADDRESS_AD74416H_CH_C_VOLTAGE_OUTPUT_V:
         case MODBUS_ADDRESS_AD74416H_CH_D_VOLTAGE_OUTPUT_V: {
             /* 電壓輸出配置 */
+            control_logic_config_read_lock();
             int config_count = 0;
             analog_config_t *analog_output_voltage_config = control_logic_analog_output_voltage_configs_get(&config_count);
             if (analog_output_voltage_config != NULL && config_count > 0) {
@@ -174,6 +175,7 @@ int control_logic_output_value_convert(uint8_t port, uint32_t address, uint16_t
                     }
                 }
             }
+            control_logic_config_read_unlock();
             break;
         }
 
@@ -182,6 +184,7 @@ int control_logic_output_value_convert(uint8_t port, uint32_t address, uint16_t
         case MODBUS_ADDRESS_AD74416H_CH_C_CURRENT_OUTPUT:
         case MODBUS_ADDRESS_AD74416H_CH_D_CURRENT_OUTPUT: {
             /* 電流輸出配置 */
+            control_logic_config_read_lock();
             int config_count = 0;
             analog_config_t *analog_output_current_config = control_logic_analog_output_current_configs_get(&config_count);
             if (analog_output_current_config != NULL && config_count > 0) {
@@ -203,6 +206,7 @@ int control_logic_output_value_convert(uint8_t port, uint32_t address, uint16_t
                     }
                 }
             }
+            control_logic_config_read_unlock();
             break;
         }
 
@@ -375,25 +379,16 @@ int control_logic_write_register(uint32_t address, uint16_t value, uint16_t time
     BOOL modbus_address_mapping_found = FALSE;
 
     // find modbus address mapping
-    int config_count = 0;
-    modbus_device_config_t *config = control_logic_modbus_device_configs_get(&config_count);
-    if (config != NULL && config_count > 0) {
-        for (int i = 0; i < config_count; i++) {
-            // debug(tag, "idx %d addr %d code %d upaddr %d", i, config[i].reg_address, config[i].function_code, 
-            //                                                   config[i].update_address);
-            if (config[i].update_address == target_address && 
-                config[i].function_code == MODBUS_FUNC_WRITE_SINGLE_REGISTER) {
-                modbus_address_mapping_found = TRUE;
-                ret = control_hardware_rs485_single_write(config[i].port, config[i].baudrate, 
-                                                          config[i].slave_id, config[i].reg_address, 
-                                                          value);
-                if (ret == SUCCESS) {
-                    ret = control_logic_update_to_modbus_table(target_address, MODBUS_TYPE_UINT16, &value);
-                }
-                debug(tag, "write to modbus success: address %d, value %d, ret %d", address, value, ret);
-                break;
-            }
+    modbus_device_config_t config;
+    if (control_logic_modbus_device_write_config_find(target_address, &config) == SUCCESS) {
+        modbus_address_mapping_found = TRUE;
+        ret = control_hardware_rs485_single_write(config.port, config.baudrate, 
+                                                  config.slave_id, config.reg_address, 
+                                                  value);
+        if (ret == SUCCESS) {
+            ret = control_logic_update_to_modbus_table(target_address, MODBUS_TYPE_UINT16, &value);
         }
+        debug(tag, "write to modbus success: address %d, value %d, ret %d", address, value, ret);
     }
     
     if (modbus_address_mapping_found) {
@@ -484,8 +479,10 @@ int control_logic_write_by_json(const char *jsonPayload, uint16_t timeout_ms,
     if (cJSON_IsArray(registers_array)) {
         // to string
         char *registers_array_str = cJSON_PrintUnformatted(registers_array);
-        // load register from json
-        if (control_logic_register_load_from_json(registers_array_str, register_list, list_size) == SUCCESS) {
+        // validate the whole register map before applying or saving any of it
+        if (registers_array_str != NULL &&
+            control_logic_register_validate_json(registers_array_str, register_list, list_size) == SUCCESS &&
+            control_logic_register_load_from_json(registers_array_str, register_list, list_size) == SUCCESS) {
             // save to file
             control_logic_register_save_to_file(file_path, registers_array_str);
         }
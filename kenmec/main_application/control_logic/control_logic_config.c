@@ -39,42 +39,117 @@
 /* 日誌標籤 */
 static const char* tag = "control_logic_config";
 
+/* 讀者登記槽位上限(同時讀取配置的執行緒數) */
+#define CONFIG_READER_MAX (64)
+
+/* 暫存器名稱索引快取上限(不同的暫存器列表數量) */
+#define CONFIG_REGISTER_INDEX_MAX (32)
+
+/*---------------------------------------------------------------------------
+                            Type Definitions
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief 配置快照
+ *
+ * 每次載入配置都建立新的快照並以原子指標交換發佈,發佈後內容不再修改。
+ * 被取代的快照記錄當時的 epoch,等所有在此之前進入讀取區段的讀者離開後才釋放。
+ */
+typedef struct config_snapshot {
+    uint32_t version;                       /* 發佈版本號 */
+    int count;                              /* 配置數量 */
+    void *items;                            /* 配置陣列(緊接在快照結構之後) */
+    void *index;                            /* 附屬索引(可為 NULL,隨快照一起釋放) */
+    uint64_t retire_epoch;                  /* 被取代時的 epoch */
+    struct config_snapshot *next_retired;   /* 待回收串列 */
+} config_snapshot_t;
+
+/**
+ * @brief 讀者登記槽位
+ */
+typedef struct {
+    uint32_t in_use;                        /* 已被執行緒佔用 */
+    uint64_t epoch;                         /* 進入讀取區段時的 epoch,0 表示不在區段內 */
+} config_reader_slot_t;
+
 /*---------------------------------------------------------------------------
 								Variables
  ---------------------------------------------------------------------------*/
 
-/* 系統配置指標 */
-static system_config_t *_system_configs = NULL;
+/* 讀者登記表 */
+static config_reader_slot_t _config_readers[CONFIG_READER_MAX];
+/* 登記表已滿時的讀者數量(存在時暫停回收) */
+static uint32_t _config_overflow_readers = 0;
+/* 全域 epoch,每次取代快照遞增 */
+static uint64_t _config_epoch = 1;
+/* 配置版本號,每次發佈快照遞增 */
+static uint32_t _config_version = 0;
+/* 待回收快照串列(受 _config_writer_mutex 保護) */
+static config_snapshot_t *_config_retired = NULL;
+/* 序列化配置發佈與回收 */
+static pthread_mutex_t _config_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* 執行緒結束時釋放讀者槽位 */
+static pthread_key_t _config_reader_key;
+static pthread_once_t _config_reader_key_once = PTHREAD_ONCE_INIT;
+/* 本執行緒的讀者槽位與巢狀深度 */
+static __thread config_reader_slot_t *_config_reader_self = NULL;
+static __thread uint32_t _config_reader_depth = 0;
+
+
+/* 系統配置快照 */
+static config_snapshot_t *_system_snapshot = NULL;
+
+/* Modbus 設備配置快照(附帶寫入位址索引) */
+static config_snapshot_t *_modbus_device_snapshot = NULL;
+
+/* Modbus 寫入位址索引槽位 */
+typedef struct {
+    int32_t update_address;         /* 空槽為 -1 */
+    int32_t config_index;           /* 對應 configs 中的索引 */
+} modbus_device_write_slot_t;
+
+/* Modbus 寫入位址索引(update_address -> 單一暫存器寫入設備配置,開放定址雜湊表) */
+typedef struct {
+    const modbus_device_config_t *configs;
+    uint32_t shift;                 /* 32 - log2(槽位數) */
+    uint32_t mask;                  /* 槽位數 - 1 */
+    modbus_device_write_slot_t slots[];
+} modbus_device_write_index_t;
 
-/* Modbus 設備配置數量 */
-static int _modbus_device_config_count = 0;
-/* Modbus 設備配置陣列指標 */
-static modbus_device_config_t *_modbus_device_config = NULL;
 
-/* 溫度傳感器配置數量 */
-static int _temperature_configs_count = 0;
-/* 溫度傳感器配置陣列指標 */
-static temperature_config_t *_temperature_configs = NULL;
+/* 溫度傳感器配置快照 */
+static config_snapshot_t *_temperature_snapshot = NULL;
 
-/* 模擬量電流輸入配置數量 */
-static int _analog_input_current_configs_count = 0;
-/* 模擬量電流輸入配置陣列指標 */
-static analog_config_t *_analog_input_current_configs = NULL;
+/* 模擬量電流輸入配置快照 */
+static config_snapshot_t *_analog_input_current_snapshot = NULL;
 
-/* 模擬量電壓輸入配置數量 */
-static int _analog_input_voltage_configs_count = 0;
-/* 模擬量電壓輸入配置陣列指標 */
-static analog_config_t *_analog_input_voltage_configs = NULL;
+/* 模擬量電壓輸入配置快照 */
+static config_snapshot_t *_analog_input_voltage_snapshot = NULL;
 
-/* 模擬量電壓輸出配置數量 */
-static int _analog_output_voltage_configs_count = 0;
-/* 模擬量電壓輸出配置陣列指標 */
-static analog_config_t *_analog_output_voltage_configs = NULL;
+/* 模擬量電壓輸出配置快照 */
+static config_snapshot_t *_analog_output_voltage_snapshot = NULL;
 
-/* 模擬量電流輸出配置數量 */
-static int _analog_output_current_configs_count = 0;
-/* 模擬量電流輸出配置陣列指標 */
-static analog_config_t *_analog_output_current_configs = NULL;
+/* 模擬量電流輸出配置快照 */
+static config_snapshot_t *_analog_output_current_snapshot = NULL;
+
+/**
+ * @brief 暫存器名稱索引
+ *
+ * 由暫存器列表建立一次(名稱 -> 列表索引,開放定址雜湊表),之後載入 JSON 時
+ * 每筆只需一次雜湊查找。names 保存建立時的名稱指標,列表名稱變更時重建。
+ */
+typedef struct {
+    const control_logic_register_t *register_list;
+    uint32_t list_size;
+    const char **names;             /* 建立時的名稱指標(list_size 筆) */
+    uint32_t shift;                 /* 32 - log2(槽位數) */
+    uint32_t mask;                  /* 槽位數 - 1 */
+    int32_t slots[];                /* 列表索引,空槽為 -1 */
+} register_name_index_t;
+
+/* 暫存器名稱索引快取(受 _register_index_mutex 保護) */
+static register_name_index_t *_register_indexes[CONFIG_REGISTER_INDEX_MAX];
+static pthread_mutex_t _register_index_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /*---------------------------------------------------------------------------
                              Function Prototypes
@@ -118,78 +193,262 @@ static int _analog_output_current_configs_load_from_string(const char *json_stri
                                  Implementation
  ---------------------------------------------------------------------------*/
 
-static int _system_configs_clean(void)
+static void _config_reader_slot_release(void *arg)
+{
+    config_reader_slot_t *slot = (config_reader_slot_t *)arg;
+
+    __atomic_store_n(&slot->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void _config_reader_key_create(void)
+{
+    pthread_key_create(&_config_reader_key, _config_reader_slot_release);
+}
+
+/**
+ * @brief 取得本執行緒的讀者槽位,第一次使用時登記
+ *
+ * @return 槽位指標,登記表已滿時返回 NULL
+ */
+static config_reader_slot_t* _config_reader_slot_get(void)
+{
+    if (_config_reader_self != NULL) {
+        return _config_reader_self;
+    }
+
+    pthread_once(&_config_reader_key_once, _config_reader_key_create);
+
+    for (int i = 0; i < CONFIG_READER_MAX; i++) {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&_config_readers[i].in_use, &expected, 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            _config_reader_self = &_config_readers[i];
+            pthread_setspecific(_config_reader_key, _config_reader_self);
+            return _config_reader_self;
+        }
+    }
+
+    return NULL;
+}
+
+void control_logic_config_read_lock(void)
+{
+    if (_config_reader_depth++ > 0) {
+        return;
+    }
+
+    config_reader_slot_t *slot = _config_reader_slot_get();
+    if (slot != NULL) {
+        /* 先公告 epoch 再讀取快照指標(皆為 seq_cst,與發佈端的交換/掃描構成全序) */
+        __atomic_store_n(&slot->epoch, __atomic_load_n(&_config_epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    } else {
+        __atomic_fetch_add(&_config_overflow_readers, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void control_logic_config_read_unlock(void)
+{
+    if (_config_reader_depth == 0 || --_config_reader_depth > 0) {
+        return;
+    }
+
+    if (_config_reader_self != NULL) {
+        __atomic_store_n(&_config_reader_self->epoch, 0, __ATOMIC_RELEASE);
+    } else {
+        __atomic_fetch_sub(&_config_overflow_readers, 1, __ATOMIC_RELEASE);
+    }
+}
+
+uint32_t control_logic_config_version_get(void)
+{
+    return __atomic_load_n(&_config_version, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief 配置快照(含 count 筆 item_size 大小的配置)
+ */
+static config_snapshot_t* _config_snapshot_alloc(int count, size_t item_size)
+{
+    config_snapshot_t *snapshot = platform_slow_calloc(1, (int)(sizeof(config_snapshot_t) + (size_t)count * item_size));
+    if (snapshot == NULL) {
+        return NULL;
+    }
+
+    snapshot->count = count;
+    snapshot->items = (void *)(snapshot + 1);
+
+    return snapshot;
+}
+
+static void _config_snapshot_free(config_snapshot_t *snapshot)
+{
+    if (snapshot->index != NULL) {
+        platform_slow_free(snapshot->index);
+    }
+    platform_slow_free(snapshot);
+}
+
+/**
+ * @brief 回收已無讀者的快照(需持有 _config_writer_mutex)
+ */
+static void _config_snapshot_reclaim(void)
+{
+    if (__atomic_load_n(&_config_overflow_readers, __ATOMIC_SEQ_CST) > 0) {
+        return;
+    }
+
+    /* 找出仍在讀取區段中的最舊 epoch */
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < CONFIG_READER_MAX; i++) {
+        uint64_t epoch = __atomic_load_n(&_config_readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    config_snapshot_t **link = &_config_retired;
+    while (*link != NULL) {
+        config_snapshot_t *snapshot = *link;
+        if (snapshot->retire_epoch <= oldest) {
+            *link = snapshot->next_retired;
+            _config_snapshot_free(snapshot);
+        } else {
+            link = &snapshot->next_retired;
+        }
+    }
+}
+
+/**
+ * @brief 發佈新快照(可為 NULL 表示清空),舊快照延後到讀者離開後回收
+ */
+static void _config_snapshot_publish(config_snapshot_t **current, config_snapshot_t *snapshot)
 {
-    if (_system_configs != NULL) {
-        platform_slow_free(_system_configs);
-        _system_configs = NULL;
+    pthread_mutex_lock(&_config_writer_mutex);
+
+    if (snapshot != NULL) {
+        snapshot->version = __atomic_add_fetch(&_config_version, 1, __ATOMIC_ACQ_REL);
+    }
+
+    config_snapshot_t *old = __atomic_exchange_n(current, snapshot, __ATOMIC_SEQ_CST);
+    if (old != NULL) {
+        old->retire_epoch = __atomic_add_fetch(&_config_epoch, 1, __ATOMIC_SEQ_CST);
+        old->next_retired = _config_retired;
+        _config_retired = old;
     }
 
+    _config_snapshot_reclaim();
+
+    pthread_mutex_unlock(&_config_writer_mutex);
+}
+
+/**
+ * @brief 讀取目前快照(需在讀取區段內使用)
+ */
+static config_snapshot_t* _config_snapshot_current(config_snapshot_t **current)
+{
+    return __atomic_load_n(current, __ATOMIC_SEQ_CST);
+}
+
+static int _system_configs_clean(void)
+{
+    _config_snapshot_publish(&_system_snapshot, NULL);
+
     return SUCCESS;
 }
 
-static int _modbus_device_configs_clean(void)
+/**
+ * @brief 計算寫入位址索引的起始槽位(Fibonacci hashing)
+ */
+static uint32_t _modbus_device_write_index_hash(const modbus_device_write_index_t *index, uint32_t address)
 {
-    if (_modbus_device_config != NULL) {
-        platform_slow_free(_modbus_device_config);
-        _modbus_device_config = NULL;
-        _modbus_device_config_count = 0;
+    return (uint32_t)(address * 2654435761u) >> index->shift;
+}
+
+/**
+ * @brief 為設備配置陣列建立寫入位址索引
+ *
+ * 僅收錄 function_code 為 MODBUS_FUNC_WRITE_SINGLE_REGISTER 的配置,
+ * 同一 update_address 以陣列中第一筆為準(與原本線性搜尋行為一致)。
+ * 槽位數為配置數兩倍以上的 2 的冪,線性探測。
+ */
+static modbus_device_write_index_t* _modbus_device_write_index_build(const modbus_device_config_t *configs, int count)
+{
+    uint32_t bits = 4;
+    while ((1u << bits) < (uint32_t)count * 2u) {
+        bits++;
+    }
+    uint32_t slot_num = 1u << bits;
+
+    modbus_device_write_index_t *index = platform_slow_calloc(1, (int)(sizeof(modbus_device_write_index_t) +
+                                                                       slot_num * sizeof(modbus_device_write_slot_t)));
+    if (index == NULL) {
+        return NULL;
     }
 
+    index->configs = configs;
+    index->shift = 32 - bits;
+    index->mask = slot_num - 1;
+    for (uint32_t i = 0; i < slot_num; i++) {
+        index->slots[i].update_address = -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (configs[i].function_code != MODBUS_FUNC_WRITE_SINGLE_REGISTER || configs[i].update_address < 0) {
+            continue;
+        }
+        uint32_t slot = _modbus_device_write_index_hash(index, (uint32_t)configs[i].update_address);
+        while (index->slots[slot].update_address != -1 &&
+               index->slots[slot].update_address != configs[i].update_address) {
+            slot = (slot + 1) & index->mask;
+        }
+        if (index->slots[slot].update_address == -1) {
+            index->slots[slot].update_address = configs[i].update_address;
+            index->slots[slot].config_index = i;
+        }
+    }
+
+    return index;
+}
+
+static int _modbus_device_configs_clean(void)
+{
+    _config_snapshot_publish(&_modbus_device_snapshot, NULL);
+
     return SUCCESS;
 }
 
 static int _temperature_configs_clean(void)
 {
-    if (_temperature_configs != NULL) {
-        platform_slow_free(_temperature_configs);
-        _temperature_configs = NULL;
-        _temperature_configs_count = 0;
-    }
+    _config_snapshot_publish(&_temperature_snapshot, NULL);
 
     return SUCCESS;
 }
 
 static int _analog_input_current_configs_clean(void)
 {
-    if (_analog_input_current_configs != NULL) {
-        platform_slow_free(_analog_input_current_configs);
-        _analog_input_current_configs = NULL;
-        _analog_input_current_configs_count = 0;
-    }
+    _config_snapshot_publish(&_analog_input_current_snapshot, NULL);
 
     return SUCCESS;
 }
 
 static int _analog_input_voltage_configs_clean(void)
 {
-    if (_analog_input_voltage_configs != NULL) {
-        platform_slow_free(_analog_input_voltage_configs);
-        _analog_input_voltage_configs = NULL;
-        _analog_input_voltage_configs_count = 0;
-    }
+    _config_snapshot_publish(&_analog_input_voltage_snapshot, NULL);
 
     return SUCCESS;
 }
 
 static int _analog_output_voltage_configs_clean(void)
 {
-    if (_analog_output_voltage_configs != NULL) {
-        platform_slow_free(_analog_output_voltage_configs);
-        _analog_output_voltage_configs = NULL;
-        _analog_output_voltage_configs_count = 0;
-    }
+    _config_snapshot_publish(&_analog_output_voltage_snapshot, NULL);
 
     return SUCCESS;
 }
 
 static int _analog_output_current_configs_clean(void)
 {
-    if (_analog_output_current_configs != NULL) {
-        platform_slow_free(_analog_output_current_configs);
-        _analog_output_current_configs = NULL;
-        _analog_output_current_configs_count = 0;
-    }
+    _config_snapshot_publish(&_analog_output_current_snapshot, NULL);
 
     return SUCCESS;
 }
@@ -325,12 +584,13 @@ static int _modbus_device_configs_load_from_string(const char *json_string)
     }
 
     // allocate memory
-    modbus_device_config_t *arr = (modbus_device_config_t*)platform_slow_calloc((size_t)total, sizeof(modbus_device_config_t));
-    if (!arr) {
+    config_snapshot_t *snapshot = _config_snapshot_alloc(total, sizeof(modbus_device_config_t));
+    if (!snapshot) {
         cJSON_Delete(root);
         error(tag, "Out of memory allocating device configs");
         return FAIL;
     }
+    modbus_device_config_t *arr = (modbus_device_config_t*)snapshot->items;
 
     // foreach devices
     int idx = 0;
@@ -400,13 +660,18 @@ static int _modbus_device_configs_load_from_string(const char *json_string)
     // free json root
     cJSON_Delete(root);
 
-    // clean config
-    _modbus_device_configs_clean();
-    
-    // set config
-    _modbus_device_config = arr;
-    _modbus_device_config_count = idx;
-    debug(tag, "Loaded %d Modbus device configs from string", _modbus_device_config_count);
+    // build write address index for the new array
+    snapshot->index = _modbus_device_write_index_build(arr, idx);
+    if (!snapshot->index) {
+        _config_snapshot_free(snapshot);
+        error(tag, "Out of memory allocating device config index");
+        return FAIL;
+    }
+
+    // publish config together with its index (the replaced one is freed once no reader uses it)
+    snapshot->count = idx;
+    _config_snapshot_publish(&_modbus_device_snapshot, snapshot);
+    debug(tag, "Loaded %d Modbus device configs from string", idx);
 
     return SUCCESS;
 }
@@ -467,11 +732,44 @@ int control_logic_modbus_device_configs_set(const char *json_string)
 
 modbus_device_config_t* control_logic_modbus_device_configs_get(int *config_count)
 {
+    config_snapshot_t *snapshot = _config_snapshot_current(&_modbus_device_snapshot);
+
     if (config_count) {
-        *config_count = _modbus_device_config_count;
+        *config_count = snapshot ? snapshot->count : 0;
     }
 
-    return _modbus_device_config;
+    return snapshot ? (modbus_device_config_t*)snapshot->items : NULL;
+}
+
+int control_logic_modbus_device_write_config_find(uint32_t update_address, modbus_device_config_t *config)
+{
+    int ret = FAIL;
+
+    if (update_address > INT32_MAX) {
+        return FAIL;
+    }
+
+    control_logic_config_read_lock();
+
+    config_snapshot_t *snapshot = _config_snapshot_current(&_modbus_device_snapshot);
+    const modbus_device_write_index_t *index = snapshot ? (const modbus_device_write_index_t *)snapshot->index : NULL;
+    if (index != NULL) {
+        uint32_t slot = _modbus_device_write_index_hash(index, update_address);
+        while (index->slots[slot].update_address != -1) {
+            if (index->slots[slot].update_address == (int32_t)update_address) {
+                if (config) {
+                    *config = index->configs[index->slots[slot].config_index];
+                }
+                ret = SUCCESS;
+                break;
+            }
+            slot = (slot + 1) & index->mask;
+        }
+    }
+
+    control_logic_config_read_unlock();
+
+    return ret;
 }
 
 /**
@@ -512,11 +810,13 @@ int control_logic_config_init(void)
 
 temperature_config_t* control_logic_temperature_configs_get(int *config_count)
 {
+    config_snapshot_t *snapshot = _config_snapshot_current(&_temperature_snapshot);
+
     if (config_count) {
-        *config_count = _temperature_configs_count;
+        *config_count = snapshot ? snapshot->count : 0;
     }
 
-    return _temperature_configs;
+    return snapshot ? (temperature_config_t*)snapshot->items : NULL;
 }
 
 static int _temperature_configs_init(void)
@@ -576,12 +876,13 @@ static int _temperature_configs_load_from_string(const char *json_string)
     }
 
     // allocate memory
-    temperature_config_t *arr = (temperature_config_t*)platform_slow_calloc((size_t)total, sizeof(temperature_config_t));
-    if (!arr) {
+    config_snapshot_t *snapshot = _config_snapshot_alloc(total, sizeof(temperature_config_t));
+    if (!snapshot) {
         cJSON_Delete(root);
         error(tag, "Out of memory allocating temperature configs");
         return FAIL;
     }
+    temperature_config_t *arr = (temperature_config_t*)snapshot->items;
 
     // foreach devices
     int idx = 0;
@@ -621,13 +922,11 @@ static int _temperature_configs_load_from_string(const char *json_string)
     cJSON_Delete(root);
 
     // clean config
-    _temperature_configs_clean();
-    
-    // set config
-    _temperature_configs = arr;
-    _temperature_configs_count = idx;
+    // publish config (the replaced one is freed once no reader uses it)
+    snapshot->count = idx;
+    _config_snapshot_publish(&_temperature_snapshot, snapshot);
 
-    debug(tag, "Loaded %d temperature configs from string", _temperature_configs_count);
+    debug(tag, "Loaded %d temperature configs from string", idx);
 
     return SUCCESS;
 }
@@ -652,11 +951,13 @@ int control_logic_temperature_configs_set(const char *json_string)
 
 analog_config_t* control_logic_analog_input_current_configs_get(int *config_count)
 {
+    config_snapshot_t *snapshot = _config_snapshot_current(&_analog_input_current_snapshot);
+
     if (config_count) {
-        *config_count = _analog_input_current_configs_count;
+        *config_count = snapshot ? snapshot->count : 0;
     }
 
-    return _analog_input_current_configs;
+    return snapshot ? (analog_config_t*)snapshot->items : NULL;
 }
 
 static int _analog_input_current_configs_init(void)
@@ -729,12 +1030,13 @@ static int _analog_input_current_configs_load_from_string(const char *json_strin
     }
 
     // allocate memory
-    analog_config_t *arr = (analog_config_t*)platform_slow_calloc((size_t)total, sizeof(analog_config_t));
-    if (!arr) {
+    config_snapshot_t *snapshot = _config_snapshot_alloc(total, sizeof(analog_config_t));
+    if (!snapshot) {
         cJSON_Delete(root);
         error(tag, "Out of memory allocating analog current input configs");
         return FAIL;
     }
+    analog_config_t *arr = (analog_config_t*)snapshot->items;
 
     // foreach devices
     int idx = 0;
@@ -774,13 +1076,11 @@ static int _analog_input_current_configs_load_from_string(const char *json_strin
     cJSON_Delete(root);
 
     // clean config
-    _analog_input_current_configs_clean();
-    
-    // set config
-    _analog_input_current_configs = arr;
-    _analog_input_current_configs_count = idx;
+    // publish config (the replaced one is freed once no reader uses it)
+    snapshot->count = idx;
+    _config_snapshot_publish(&_analog_input_current_snapshot, snapshot);
 
-    debug(tag, "Loaded %d analog current input configs from string", _analog_input_current_configs_count);
+    debug(tag, "Loaded %d analog current input configs from string", idx);
 
     return SUCCESS;
 }
@@ -805,11 +1105,13 @@ int control_logic_analog_input_current_configs_set(const char *json_string)
 
 analog_config_t* control_logic_analog_input_voltage_configs_get(int *config_count)
 {
+    config_snapshot_t *snapshot = _config_snapshot_current(&_analog_input_voltage_snapshot);
+
     if (config_count) {
-        *config_count = _analog_input_voltage_configs_count;
+        *config_count = snapshot ? snapshot->count : 0;
     }
 
-    return _analog_input_voltage_configs;
+    return snapshot ? (analog_config_t*)snapshot->items : NULL;
 }
 
 static int _analog_input_voltage_configs_init(void)
@@ -869,12 +1171,13 @@ static int _analog_input_voltage_configs_load_from_string(const char *json_strin
     }
 
     // allocate memory
-    analog_config_t *arr = (analog_config_t*)platform_slow_calloc((size_t)total, sizeof(analog_config_t));
-    if (!arr) {
+    config_snapshot_t *snapshot = _config_snapshot_alloc(total, sizeof(analog_config_t));
+    if (!snapshot) {
         cJSON_Delete(root);
         error(tag, "Out of memory allocating analog current input configs");
         return FAIL;
     }
+    analog_config_t *arr = (analog_config_t*)snapshot->items;
 
     // foreach devices
     int idx = 0;
@@ -912,13 +1215,11 @@ static int _analog_input_voltage_configs_load_from_string(const char *json_strin
     cJSON_Delete(root);
 
     // clean config
-    _analog_input_voltage_configs_clean();
-    
-    // set config
-    _analog_input_voltage_configs = arr;
-    _analog_input_voltage_configs_count = idx;
+    // publish config (the replaced one is freed once no reader uses it)
+    snapshot->count = idx;
+    _config_snapshot_publish(&_analog_input_voltage_snapshot, snapshot);
 
-    debug(tag, "Loaded %d analog voltage input configs from string", _analog_input_voltage_configs_count);
+    debug(tag, "Loaded %d analog voltage input configs from string", idx);
 
     return SUCCESS;
 }
@@ -943,11 +1244,13 @@ int control_logic_analog_input_voltage_configs_set(const char *json_string)
 
 analog_config_t* control_logic_analog_output_voltage_configs_get(int *config_count)
 {
+    config_snapshot_t *snapshot = _config_snapshot_current(&_analog_output_voltage_snapshot);
+
     if (config_count) {
-        *config_count = _analog_output_voltage_configs_count;
+        *config_count = snapshot ? snapshot->count : 0;
     }
 
-    return _analog_output_voltage_configs;
+    return snapshot ? (analog_config_t*)snapshot->items : NULL;
 }
 
 static int _analog_output_voltage_configs_init(void)
@@ -1007,12 +1310,13 @@ static int _analog_output_voltage_configs_load_from_string(const char *json_stri
     }
 
     // allocate memory
-    analog_config_t *arr = (analog_config_t*)platform_slow_calloc((size_t)total, sizeof(analog_config_t));
-    if (!arr) {
+    config_snapshot_t *snapshot = _config_snapshot_alloc(total, sizeof(analog_config_t));
+    if (!snapshot) {
         cJSON_Delete(root);
         error(tag, "Out of memory allocating analog current input configs");
         return FAIL;
     }
+    analog_config_t *arr = (analog_config_t*)snapshot->items;
 
     // foreach devices
     int idx = 0;
@@ -1048,13 +1352,11 @@ static int _analog_output_voltage_configs_load_from_string(const char *json_stri
     cJSON_Delete(root);
 
     // clean config
-    _analog_output_voltage_configs_clean();
-    
-    // set config
-    _analog_output_voltage_configs = arr;
-    _analog_output_voltage_configs_count = idx;
+    // publish config (the replaced one is freed once no reader uses it)
+    snapshot->count = idx;
+    _config_snapshot_publish(&_analog_output_voltage_snapshot, snapshot);
 
-    debug(tag, "Loaded %d analog output voltage configs from string", _analog_output_voltage_configs_count);
+    debug(tag, "Loaded %d analog output voltage configs from string", idx);
 
     return SUCCESS;
 }
@@ -1079,11 +1381,13 @@ int control_logic_analog_output_voltage_configs_set(const char *json_string)
 
 analog_config_t* control_logic_analog_output_current_configs_get(int *config_count)
 {
+    config_snapshot_t *snapshot = _config_snapshot_current(&_analog_output_current_snapshot);
+
     if (config_count) {
-        *config_count = _analog_output_current_configs_count;
+        *config_count = snapshot ? snapshot->count : 0;
     }
 
-    return _analog_output_current_configs;
+    return snapshot ? (analog_config_t*)snapshot->items : NULL;
 }
 
 static int _analog_output_current_configs_init(void)
@@ -1143,12 +1447,13 @@ static int _analog_output_current_configs_load_from_string(const char *json_stri
     }
 
     // allocate memory
-    analog_config_t *arr = (analog_config_t*)platform_slow_calloc((size_t)total, sizeof(analog_config_t));
-    if (!arr) {
+    config_snapshot_t *snapshot = _config_snapshot_alloc(total, sizeof(analog_config_t));
+    if (!snapshot) {
         cJSON_Delete(root);
         error(tag, "Out of memory allocating analog current input configs");
         return FAIL;
     }
+    analog_config_t *arr = (analog_config_t*)snapshot->items;
 
     // foreach devices
     int idx = 0;
@@ -1184,13 +1489,11 @@ static int _analog_output_current_configs_load_from_string(const char *json_stri
     cJSON_Delete(root);
 
     // clean config
-    _analog_output_current_configs_clean();
-    
-    // set config
-    _analog_output_current_configs = arr;
-    _analog_output_current_configs_count = idx;
+    // publish config (the replaced one is freed once no reader uses it)
+    snapshot->count = idx;
+    _config_snapshot_publish(&_analog_output_current_snapshot, snapshot);
 
-    debug(tag, "Loaded %d analog output current configs from string", _analog_output_current_configs_count);
+    debug(tag, "Loaded %d analog output current configs from string", idx);
 
     return SUCCESS;
 }
@@ -1240,13 +1543,14 @@ static int _system_configs_load_from_string(const char *json_string)
     }
     
     // allocate memory
-    system_config_t *arr = (system_config_t*)platform_slow_calloc((size_t)1, sizeof(system_config_t));
-    if (!arr) {
+    config_snapshot_t *snapshot = _config_snapshot_alloc(1, sizeof(system_config_t));
+    if (!snapshot) {
         cJSON_Delete(root);
         _system_configs_clean();
         error(tag, "Out of memory allocating system configs");
         return FAIL;
     }
+    system_config_t *arr = (system_config_t*)snapshot->items;
 
     // Parse the "SystemConfigs" object from the root
     cJSON *jsonObject = root->child;
@@ -1265,21 +1569,23 @@ static int _system_configs_load_from_string(const char *json_string)
     // free json root
     cJSON_Delete(root);
 
-    // clean config
-    _system_configs_clean();
-
-    // set config
-    _system_configs = arr;
+    // publish config (the replaced one is freed once no reader uses it)
+    _config_snapshot_publish(&_system_snapshot, snapshot);
 
     return SUCCESS;
 }
 
 static int _system_configs_dump(void)
 {
-    if (_system_configs != NULL) {
-        debug(tag, "machine_type: %s", _system_configs->machine_type);
+    control_logic_config_read_lock();
+
+    system_config_t *system_config = control_logic_system_configs_get();
+    if (system_config != NULL) {
+        debug(tag, "machine_type: %s", system_config->machine_type);
     }
 
+    control_logic_config_read_unlock();
+
     return SUCCESS;
 }
 
@@ -1341,7 +1647,9 @@ int control_logic_system_configs_set(const char *json_string)
 
 system_config_t* control_logic_system_configs_get(void)
 {
-    return _system_configs;
+    config_snapshot_t *snapshot = _config_snapshot_current(&_system_snapshot);
+
+    return snapshot ? (system_config_t*)snapshot->items : NULL;
 }
 
 /**
@@ -1364,17 +1672,22 @@ control_logic_machine_type_t control_logic_config_get_machine_type(void)
 {
     control_logic_machine_type_t machine_type = CONTROL_LOGIC_MACHINE_TYPE_DEFAULT;
 
-    if (_system_configs != NULL) {
+    control_logic_config_read_lock();
+
+    system_config_t *system_config = control_logic_system_configs_get();
+    if (system_config != NULL) {
         /* 檢查是否為 LS80 機型 */
-        if (strncmp(_system_configs->machine_type, "LS80", sizeof(_system_configs->machine_type)) == 0) {
+        if (strncmp(system_config->machine_type, "LS80", sizeof(system_config->machine_type)) == 0) {
             machine_type = CONTROL_LOGIC_MACHINE_TYPE_LS80;
         }
         /* 檢查是否為 LX1400 機型 */
-        else if (strncmp(_system_configs->machine_type, "LX1400", sizeof(_system_configs->machine_type)) == 0) {
+        else if (strncmp(system_config->machine_type, "LX1400", sizeof(system_config->machine_type)) == 0) {
             machine_type = CONTROL_LOGIC_MACHINE_TYPE_LX1400;
         }
     }
 
+    control_logic_config_read_unlock();
+
     return machine_type;
 }
 
@@ -1413,11 +1726,225 @@ int control_logic_register_load_from_file(const char *file_path, control_logic_r
     return ret;
 }
 
-int control_logic_register_load_from_json(const char *jsonPayload, control_logic_register_t *register_list, 
-                                          uint32_t list_size) 
+/**
+ * @brief 暫存器名稱雜湊(FNV-1a)
+ */
+static uint32_t _register_name_hash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief 為暫存器列表建立名稱索引
+ *
+ * 同名暫存器以列表中第一筆為準(與原本線性搜尋行為一致)。
+ * 槽位數為列表大小兩倍以上的 2 的冪,線性探測。
+ */
+static register_name_index_t* _register_name_index_build(const control_logic_register_t *register_list,
+                                                         uint32_t list_size)
+{
+    uint32_t bits = 4;
+    while ((1u << bits) < list_size * 2u) {
+        bits++;
+    }
+    uint32_t slot_num = 1u << bits;
+
+    register_name_index_t *index = platform_slow_calloc(1, (int)(sizeof(register_name_index_t) +
+                                                                 slot_num * sizeof(int32_t)));
+    if (index == NULL) {
+        return NULL;
+    }
+    index->names = platform_slow_calloc(list_size > 0 ? list_size : 1, sizeof(const char *));
+    if (index->names == NULL) {
+        platform_slow_free(index);
+        return NULL;
+    }
+
+    index->register_list = register_list;
+    index->list_size = list_size;
+    index->shift = 32 - bits;
+    index->mask = slot_num - 1;
+    for (uint32_t i = 0; i < slot_num; i++) {
+        index->slots[i] = -1;
+    }
+
+    for (uint32_t i = 0; i < list_size; i++) {
+        const char *name = register_list[i].name;
+        index->names[i] = name;
+        if (name == NULL) {
+            continue;
+        }
+        uint32_t slot = (_register_name_hash(name) * 2654435761u) >> index->shift;
+        while (index->slots[slot] != -1 && strcmp(register_list[index->slots[slot]].name, name) != 0) {
+            slot = (slot + 1) & index->mask;
+        }
+        if (index->slots[slot] == -1) {
+            index->slots[slot] = (int32_t)i;
+        }
+    }
+
+    return index;
+}
+
+static void _register_name_index_free(register_name_index_t *index)
+{
+    if (index != NULL) {
+        platform_slow_free(index->names);
+        platform_slow_free(index);
+    }
+}
+
+/**
+ * @brief 查找名稱對應的暫存器列表索引
+ *
+ * @return 列表索引,找不到返回 -1
+ */
+static int32_t _register_name_index_find(const register_name_index_t *index, const char *name)
+{
+    uint32_t slot = (_register_name_hash(name) * 2654435761u) >> index->shift;
+
+    while (index->slots[slot] != -1) {
+        if (strcmp(index->register_list[index->slots[slot]].name, name) == 0) {
+            return index->slots[slot];
+        }
+        slot = (slot + 1) & index->mask;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 取得暫存器列表的名稱索引(需持有 _register_index_mutex)
+ *
+ * 每個列表只建立一次;列表中的名稱指標與建立時不同則重建。
+ * 快取已滿時返回臨時索引,*temporary 設為 true,由呼叫端釋放。
+ */
+static register_name_index_t* _register_name_index_get(const control_logic_register_t *register_list,
+                                                       uint32_t list_size, bool *temporary)
+{
+    int free_slot = -1;
+
+    *temporary = false;
+
+    for (int i = 0; i < CONFIG_REGISTER_INDEX_MAX; i++) {
+        register_name_index_t *index = _register_indexes[i];
+        if (index == NULL) {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+            continue;
+        }
+        if (index->register_list != register_list) {
+            continue;
+        }
+        if (index->list_size == list_size) {
+            uint32_t n = 0;
+            while (n < list_size && index->names[n] == register_list[n].name) {
+                n++;
+            }
+            if (n == list_size) {
+                return index;
+            }
+        }
+        // list changed since the index was built
+        _register_name_index_free(index);
+        _register_indexes[i] = NULL;
+        free_slot = i;
+        break;
+    }
+
+    register_name_index_t *index = _register_name_index_build(register_list, list_size);
+    if (index == NULL) {
+        return NULL;
+    }
+    if (free_slot < 0) {
+        *temporary = true;
+    } else {
+        _register_indexes[free_slot] = index;
+    }
+
+    return index;
+}
+
+/**
+ * @brief 一次走訪 JSON 暫存器陣列
+ *
+ * validate_only 時只檢查不寫入,並回報每筆錯誤(含重複名稱);
+ * 否則與原本行為相同,略過無效項目並設定其餘暫存器位址。
+ *
+ * @return 錯誤筆數
+ */
+static int _register_json_walk(const cJSON *registers_array, control_logic_register_t *register_list,
+                               uint32_t list_size, const register_name_index_t *index, bool validate_only)
+{
+    int errors = 0;
+    int position = 0;
+    uint8_t *seen = NULL;
+
+    if (validate_only) {
+        seen = platform_slow_calloc(list_size > 0 ? list_size : 1, sizeof(uint8_t));
+        if (seen == NULL) {
+            error(tag, "Failed to allocate register validation map");
+            return 1;
+        }
+    }
+
+    const cJSON *jsonItem = NULL;
+    cJSON_ArrayForEach(jsonItem, registers_array) {
+        int32_t found = -1;
+        const cJSON *jsonName = cJSON_GetObjectItemCaseSensitive(jsonItem, "name");
+        const cJSON *jsonAddress = cJSON_GetObjectItemCaseSensitive(jsonItem, "address");
+
+        if (cJSON_IsObject(jsonItem) && cJSON_IsString(jsonName)) {
+            found = _register_name_index_find(index, jsonName->valuestring);
+        }
+
+        if (validate_only) {
+            if (!cJSON_IsObject(jsonItem) || !cJSON_IsString(jsonName)) {
+                error(tag, "register[%d]: not an object with a string name", position);
+                errors++;
+            } else if (found < 0) {
+                error(tag, "register[%d]: unknown name %s", position, jsonName->valuestring);
+                errors++;
+            } else if (seen[found]) {
+                error(tag, "register[%d]: duplicate name %s", position, jsonName->valuestring);
+                errors++;
+            } else if (!cJSON_IsNumber(jsonAddress) || jsonAddress->valuedouble < 0 ||
+                       jsonAddress->valuedouble != (double)jsonAddress->valueint) {
+                error(tag, "register[%d]: %s has an invalid address", position, jsonName->valuestring);
+                errors++;
+            }
+            if (found >= 0) {
+                seen[found] = 1;
+            }
+        } else if (found >= 0 && cJSON_IsNumber(jsonAddress) && register_list[found].address_ptr != NULL) {
+            // set the new address
+            *(register_list[found].address_ptr) = (int32_t)jsonAddress->valueint;
+        }
+
+        position++;
+    }
+
+    platform_slow_free(seen);
+
+    return errors;
+}
+
+/**
+ * @brief 解析 JSON 暫存器陣列並以名稱索引走訪一次
+ */
+static int _register_json_process(const char *jsonPayload, control_logic_register_t *register_list,
+                                  uint32_t list_size, bool validate_only)
 {
     int ret = SUCCESS;
-    
+
     // validate json payload
     cJSON *registers_array = cJSON_Parse(jsonPayload);
     if (registers_array == NULL) {
@@ -1425,44 +1952,45 @@ int control_logic_register_load_from_json(const char *jsonPayload, control_logic
         return FAIL;
     }
 
-    // check each register in registers_array
-    int registers_array_size = cJSON_GetArraySize(registers_array);
-    if (registers_array_size <= 0) {
+    // check registers_array is not empty
+    if (registers_array->child == NULL || (validate_only && !cJSON_IsArray(registers_array))) {
         error(tag, "Invalid registers array size");
         cJSON_Delete(registers_array);
         return FAIL;
     }
 
-    // foreach register in registers_array
-    for (int i = 0; i < registers_array_size; i++) {
-        // get json item
-        cJSON *jsonItem = cJSON_GetArrayItem(registers_array, i);
-        if (cJSON_IsObject(jsonItem)) {
-            // get name object
-            cJSON *jsonName = cJSON_GetObjectItemCaseSensitive(jsonItem, "name");
-            if (cJSON_IsString(jsonName)) {
-                // check name matches in register_list
-                for (uint32_t i = 0; i < list_size; i++) {
-                    // check name matches current jsonName
-                    if (register_list[i].name != NULL && 
-                        strcmp(jsonName->valuestring, register_list[i].name) == 0) {
-                        // get the address value
-                        cJSON *jsonAddress = cJSON_GetObjectItemCaseSensitive(jsonItem, "address");
-                        if (cJSON_IsNumber(jsonAddress)) {
-                            // set the new address
-                            if (register_list[i].address_ptr != NULL) {
-                                *(register_list[i].address_ptr) = (int32_t)jsonAddress->valueint;
-                            }
-                        }
-                        break; // found, no need to check further
-                    }
-                }
-            }
+    pthread_mutex_lock(&_register_index_mutex);
+
+    bool temporary = false;
+    register_name_index_t *index = _register_name_index_get(register_list, list_size, &temporary);
+    if (index == NULL) {
+        error(tag, "Failed to build register name index");
+        ret = FAIL;
+    } else {
+        if (_register_json_walk(registers_array, register_list, list_size, index, validate_only) > 0) {
+            ret = FAIL;
+        }
+        if (temporary) {
+            _register_name_index_free(index);
         }
     }
 
+    pthread_mutex_unlock(&_register_index_mutex);
+
     // free json root
     cJSON_Delete(registers_array);
 
     return ret;
 }
+
+int control_logic_register_load_from_json(const char *jsonPayload, control_logic_register_t *register_list, 
+                                          uint32_t list_size) 
+{
+    return _register_json_process(jsonPayload, register_list, list_size, false);
+}
+
+int control_logic_register_validate_json(const char *jsonPayload, control_logic_register_t *register_list,
+                                         uint32_t list_size)
+{
+    return _register_json_process(jsonPayload, register_list, list_size, true);
+}
@@ -127,6 +127,47 @@ int control_logic_register_load_from_json(const char *jsonPayload, control_logic
 int control_logic_register_load_from_file(const char *file_path, control_logic_register_t *register_list,
                                           uint32_t list_size);
 
+/**
+ * @brief 驗證 JSON 暫存器配置
+ *
+ * 一次走訪整份配置且不修改暫存器列表；每筆必須是物件，name 對應到列表中的暫存器、
+ * 不重複，address 為非負整數。所有錯誤都會記錄到日誌。
+ *
+ * @param jsonPayload JSON 格式的配置字串(暫存器陣列)
+ * @param register_list 暫存器列表指標
+ * @param list_size 暫存器列表大小
+ * @return 全部有效返回 0，否則返回 FAIL
+ */
+int control_logic_register_validate_json(const char *jsonPayload, control_logic_register_t *register_list,
+                                         uint32_t list_size);
+
+/* ========== 配置快照讀取區段 ========== */
+
+/**
+ * @brief 進入配置讀取區段
+ *
+ * 各 *_configs_get() 返回的指標指向不可修改的配置快照；配置被重新設定時，
+ * 舊快照會延後到所有在此之前進入讀取區段的執行緒離開後才釋放。
+ * 取得指標到使用完畢之間必須位於讀取區段內，區段可巢狀、不會阻塞寫入端。
+ */
+void control_logic_config_read_lock(void);
+
+/**
+ * @brief 離開配置讀取區段
+ *
+ * 離開後不可再使用區段內取得的配置指標。
+ */
+void control_logic_config_read_unlock(void);
+
+/**
+ * @brief 獲取配置版本號
+ *
+ * 任一配置重新發佈時遞增，可用於判斷快取的配置衍生資料是否需要重建。
+ *
+ * @return 目前配置版本號
+ */
+uint32_t control_logic_config_version_get(void);
+
 /* ========== 系統配置函數 ========== */
 
 /**
@@ -179,6 +220,18 @@ int control_logic_modbus_device_configs_set(const char *json_string);
  */
 modbus_device_config_t* control_logic_modbus_device_configs_get(int *config_count);
 
+/**
+ * @brief 依 update_address 查找單一暫存器寫入的 Modbus 設備配置
+ *
+ * 透過配置載入時建立的雜湊索引查找，取代逐筆掃描設備配置陣列。
+ * 僅匹配 function_code 為 MODBUS_FUNC_WRITE_SINGLE_REGISTER 的配置。
+ *
+ * @param update_address 本地 Modbus 映射位址
+ * @param config 輸出參數，找到時複製對應的設備配置（可為 NULL）
+ * @return 找到返回 SUCCESS，否則返回 FAIL
+ */
+int control_logic_modbus_device_write_config_find(uint32_t update_address, modbus_device_config_t *config);
+
 /* ========== 溫度感測器配置函數 ========== */
 
 /**
@@ -0,0 +1,402 @@
+/**
+ * @file control_logic_history.c
+ * @brief 感測器歷史數據實現
+ *
+ * 本文件實現感測器數值的環形歷史緩衝區,供趨勢圖查詢,不必由外部高頻輪詢。
+ *
+ * 主要功能:
+ * 1. 每個通道固定大小的環形緩衝區,記憶體在通道建立時一次配置
+ * 2. 每 CONTROL_LOGIC_HISTORY_BLOCK_SIZE 筆樣本記錄一份區塊摘要(min/max/sum)
+ * 3. 降採樣查詢:二分搜尋起點,整個落在同一區間的區塊直接使用摘要
+ *
+ * 並行模型:
+ * - 每個通道只有一個寫入端,寫入樣本後以 release 發布樣本總數 head
+ * - 環形緩衝區比可查詢的 depth 多一個區塊,寫入端正在寫的位置不會落在可查詢範圍內
+ * - 查詢端以 acquire 讀取 head,只讀取 head 之前的 depth 筆樣本,
+ *   讀完後再讀一次 head,確認讀過的最舊樣本在期間內沒有被覆寫,否則重試
+ * - 查詢端可能讀到正被覆寫的舊樣本(結果會在重試時丟棄),樣本與區塊摘要
+ *   一律以 relaxed 原子操作讀寫
+ * - 通道建立時才加鎖,查詢與寫入都不加鎖
+ *
+ * @note 樣本序號為 32 位元,以 10 Hz 寫入約 13 年才會回繞
+ */
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "dexatek/main_application/managers/modbus_manager/modbus_manager.h"
+
+#include "kenmec/main_application/control_logic/control_logic_history.h"
+
+/*---------------------------------------------------------------------------
+                            Defined Constants
+ ---------------------------------------------------------------------------*/
+/* 日誌標籤 */
+static const char* tag = "control_logic_history";
+
+/* 通道數量上限(通道索引以 uint8_t 記錄) */
+#define HISTORY_CHANNELS_LIMIT (255)
+
+/* 查詢期間最舊樣本被覆寫時的重試次數 */
+#define HISTORY_QUERY_RETRY_MAX (4)
+
+/*---------------------------------------------------------------------------
+                            Type Definitions
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief 區塊摘要
+ */
+typedef struct {
+    float min;
+    float max;
+    double sum;
+    uint64_t last_ts;       /* 區塊最後一筆樣本的時間 */
+} history_block_t;
+
+/**
+ * @brief 歷史通道
+ *
+ * 第 n 筆樣本存放在 n % slots,第 b 個區塊的摘要存放在 b % block_num
+ */
+typedef struct {
+    uint16_t address;
+    uint64_t *ts;               /* 樣本時間 */
+    float *value;               /* 樣本數值 */
+    history_block_t *blocks;    /* 已完成區塊的摘要 */
+    uint32_t head;              /* 已寫入的樣本總數,寫入端 release 發布 */
+
+    /* 以下只由寫入端存取 */
+    history_block_t acc;        /* 目前區塊的累計 */
+    uint64_t last_ts;
+} history_channel_t;
+
+/*---------------------------------------------------------------------------
+                                Variables
+ ---------------------------------------------------------------------------*/
+static pthread_mutex_t _history_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* 每個通道可查詢的樣本數,0 表示未初始化 */
+static uint32_t _history_depth = 0;
+
+/* 每個通道的緩衝區樣本數(depth 加一個區塊) */
+static uint32_t _history_slots = 0;
+
+/* 每個通道的區塊摘要數 */
+static uint32_t _history_block_num = 0;
+
+static int _history_channels_max = 0;
+
+static history_channel_t *_history_channels = NULL;
+
+/* 已建立的通道數,建立完成後 release 發布 */
+static int _history_channel_count = 0;
+
+/* Modbus 位址對應的通道索引 + 1,0 表示沒有通道 */
+static uint8_t _history_channel_index[MODBUS_RO_REGISTERS];
+
+/*---------------------------------------------------------------------------
+                                 Implementation
+ ---------------------------------------------------------------------------*/
+int control_logic_history_init(uint32_t depth, int channels_max)
+{
+    if (depth == 0 || channels_max <= 0 || channels_max > HISTORY_CHANNELS_LIMIT) {
+        return FAIL;
+    }
+
+    control_logic_history_deinit();
+
+    _history_channels = calloc((size_t)channels_max, sizeof(history_channel_t));
+    if (_history_channels == NULL) {
+        return FAIL;
+    }
+
+    _history_depth = (depth + CONTROL_LOGIC_HISTORY_BLOCK_SIZE - 1) / CONTROL_LOGIC_HISTORY_BLOCK_SIZE *
+                     CONTROL_LOGIC_HISTORY_BLOCK_SIZE;
+    _history_slots = _history_depth + CONTROL_LOGIC_HISTORY_BLOCK_SIZE;
+    _history_block_num = _history_slots / CONTROL_LOGIC_HISTORY_BLOCK_SIZE;
+    _history_channels_max = channels_max;
+
+    info(tag, "history depth %u samples, up to %d channels", _history_depth, channels_max);
+
+    return SUCCESS;
+}
+
+void control_logic_history_deinit(void)
+{
+    pthread_mutex_lock(&_history_mutex);
+
+    for (int i = 0; i < _history_channel_count; i++) {
+        free(_history_channels[i].ts);
+        free(_history_channels[i].value);
+        free(_history_channels[i].blocks);
+    }
+    free(_history_channels);
+    _history_channels = NULL;
+    _history_channel_count = 0;
+    _history_channels_max = 0;
+    _history_depth = 0;
+    _history_slots = 0;
+    _history_block_num = 0;
+    memset(_history_channel_index, 0, sizeof(_history_channel_index));
+
+    pthread_mutex_unlock(&_history_mutex);
+}
+
+/**
+ * @brief 寫入區塊摘要(各欄位以 relaxed 原子操作寫入)
+ */
+static inline void _history_block_store(history_block_t *dst, const history_block_t *src)
+{
+    __atomic_store(&dst->min, &src->min, __ATOMIC_RELAXED);
+    __atomic_store(&dst->max, &src->max, __ATOMIC_RELAXED);
+    __atomic_store(&dst->sum, &src->sum, __ATOMIC_RELAXED);
+    __atomic_store_n(&dst->last_ts, src->last_ts, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 讀取區塊摘要(各欄位以 relaxed 原子操作讀取)
+ */
+static inline void _history_block_load(const history_block_t *src, history_block_t *dst)
+{
+    __atomic_load(&src->min, &dst->min, __ATOMIC_RELAXED);
+    __atomic_load(&src->max, &dst->max, __ATOMIC_RELAXED);
+    __atomic_load(&src->sum, &dst->sum, __ATOMIC_RELAXED);
+    dst->last_ts = __atomic_load_n(&src->last_ts, __ATOMIC_RELAXED);
+}
+
+static history_channel_t *_history_channel_find(uint16_t address)
+{
+    if (address >= MODBUS_RO_REGISTERS) {
+        return NULL;
+    }
+
+    uint8_t index = __atomic_load_n(&_history_channel_index[address], __ATOMIC_ACQUIRE);
+
+    return index ? &_history_channels[index - 1] : NULL;
+}
+
+/**
+ * @brief 建立通道並配置緩衝區
+ *
+ * 不同通道的寫入端可能同時建立通道,以互斥鎖保護
+ */
+static history_channel_t *_history_channel_create(uint16_t address)
+{
+    history_channel_t *ch = NULL;
+
+    pthread_mutex_lock(&_history_mutex);
+
+    uint8_t index = _history_channel_index[address];
+    if (index) {
+        ch = &_history_channels[index - 1];
+    } else if (_history_channel_count < _history_channels_max) {
+        history_channel_t *slot = &_history_channels[_history_channel_count];
+        slot->address = address;
+        slot->ts = calloc(_history_slots, sizeof(uint64_t));
+        slot->value = calloc(_history_slots, sizeof(float));
+        slot->blocks = calloc(_history_block_num, sizeof(history_block_t));
+        if (slot->ts && slot->value && slot->blocks) {
+            ch = slot;
+            _history_channel_count++;
+            __atomic_store_n(&_history_channel_index[address], (uint8_t)_history_channel_count, __ATOMIC_RELEASE);
+        } else {
+            free(slot->ts);
+            free(slot->value);
+            free(slot->blocks);
+            memset(slot, 0, sizeof(*slot));
+            error(tag, "no memory for history of address %u", address);
+        }
+    } else {
+        warn(tag, "history channels full, address %u not recorded", address);
+    }
+
+    pthread_mutex_unlock(&_history_mutex);
+
+    return ch;
+}
+
+int control_logic_history_record(uint16_t address, uint64_t ts_ms, float value)
+{
+    if (_history_depth == 0 || address >= MODBUS_RO_REGISTERS) {
+        return FAIL;
+    }
+
+    history_channel_t *ch = _history_channel_find(address);
+    if (ch == NULL) {
+        ch = _history_channel_create(address);
+        if (ch == NULL) {
+            return FAIL;
+        }
+    }
+
+    /* 單一寫入端,head 不需要原子讀取 */
+    uint32_t head = ch->head;
+    if (head > 0 && ts_ms < ch->last_ts) {
+        ts_ms = ch->last_ts;
+    }
+
+    uint32_t pos = head % _history_slots;
+    __atomic_store_n(&ch->ts[pos], ts_ms, __ATOMIC_RELAXED);
+    __atomic_store(&ch->value[pos], &value, __ATOMIC_RELAXED);
+
+    /* 累計目前區塊,寫滿時存入摘要 */
+    uint32_t offset = head % CONTROL_LOGIC_HISTORY_BLOCK_SIZE;
+    if (offset == 0) {
+        ch->acc.min = value;
+        ch->acc.max = value;
+        ch->acc.sum = value;
+    } else {
+        if (value < ch->acc.min) ch->acc.min = value;
+        if (value > ch->acc.max) ch->acc.max = value;
+        ch->acc.sum += value;
+    }
+    ch->acc.last_ts = ts_ms;
+    if (offset == CONTROL_LOGIC_HISTORY_BLOCK_SIZE - 1) {
+        _history_block_store(&ch->blocks[(head / CONTROL_LOGIC_HISTORY_BLOCK_SIZE) % _history_block_num], &ch->acc);
+    }
+    ch->last_ts = ts_ms;
+
+    __atomic_store_n(&ch->head, head + 1, __ATOMIC_RELEASE);
+
+    return SUCCESS;
+}
+
+int control_logic_history_channels_get(uint16_t *addresses, int max)
+{
+    int count = __atomic_load_n(&_history_channel_count, __ATOMIC_ACQUIRE);
+
+    if (addresses == NULL || max <= 0) {
+        return count;
+    }
+    if (count > max) {
+        count = max;
+    }
+    for (int i = 0; i < count; i++) {
+        addresses[i] = _history_channels[i].address;
+    }
+
+    return count;
+}
+
+static void _history_point_merge(control_logic_history_point_t *point, float min, float max, uint32_t count)
+{
+    if (point->count == 0) {
+        point->min = min;
+        point->max = max;
+    } else {
+        if (min < point->min) point->min = min;
+        if (max > point->max) point->max = max;
+    }
+    point->count += count;
+}
+
+/**
+ * @brief 掃描樣本 [begin, end) 並累計到各區間
+ *
+ * 區間依時間順序走訪,同一時間只累計一個區間的總和
+ */
+static void _history_scan(const history_channel_t *ch, uint32_t begin, uint32_t end, uint64_t from_ms, uint32_t step_ms,
+                          control_logic_history_point_t *points, int point_num)
+{
+    const uint32_t slots = _history_slots;
+    const uint64_t to_ms = from_ms + (uint64_t)step_ms * (uint64_t)point_num;
+
+    for (int i = 0; i < point_num; i++) {
+        memset(&points[i], 0, sizeof(points[i]));
+        points[i].ts_ms = from_ms + (uint64_t)step_ms * (uint64_t)i;
+    }
+
+    /* 二分搜尋第一筆時間 >= from_ms 的樣本 */
+    uint32_t lo = begin;
+    uint32_t hi = end;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (__atomic_load_n(&ch->ts[mid % slots], __ATOMIC_RELAXED) < from_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    control_logic_history_point_t *point = NULL;
+    uint64_t point_end = 0;
+    double sum = 0.0;
+    uint32_t pos = lo % slots;
+
+    for (uint32_t i = lo; i < end; ) {
+        uint64_t ts = __atomic_load_n(&ch->ts[pos], __ATOMIC_RELAXED);
+        if (ts >= to_ms) {
+            break;
+        }
+        if (ts >= point_end) {
+            if (point) {
+                point->avg = (float)(sum / point->count);
+            }
+            uint64_t k = (ts - from_ms) / step_ms;
+            point = &points[k];
+            point_end = point->ts_ms + step_ms;
+            sum = 0.0;
+        }
+
+        /* 整個區塊都在目前區間內:直接使用摘要 */
+        if (i % CONTROL_LOGIC_HISTORY_BLOCK_SIZE == 0 && end - i >= CONTROL_LOGIC_HISTORY_BLOCK_SIZE) {
+            history_block_t block;
+            _history_block_load(&ch->blocks[(i / CONTROL_LOGIC_HISTORY_BLOCK_SIZE) % _history_block_num], &block);
+            if (block.last_ts < point_end) {
+                _history_point_merge(point, block.min, block.max, CONTROL_LOGIC_HISTORY_BLOCK_SIZE);
+                sum += block.sum;
+                i += CONTROL_LOGIC_HISTORY_BLOCK_SIZE;
+                pos += CONTROL_LOGIC_HISTORY_BLOCK_SIZE;
+                if (pos >= slots) {
+                    pos -= slots;
+                }
+                continue;
+            }
+        }
+
+        float value;
+        __atomic_load(&ch->value[pos], &value, __ATOMIC_RELAXED);
+        _history_point_merge(point, value, value, 1);
+        sum += value;
+        i++;
+        if (++pos == slots) {
+            pos = 0;
+        }
+    }
+
+    if (point) {
+        point->avg = (float)(sum / point->count);
+    }
+}
+
+int control_logic_history_query(uint16_t address, uint64_t from_ms, uint32_t step_ms,
+                                control_logic_history_point_t *points, int point_num)
+{
+    if (points == NULL || point_num <= 0 || step_ms == 0) {
+        return FAIL;
+    }
+
+    const history_channel_t *ch = _history_channel_find(address);
+    if (ch == NULL) {
+        return FAIL;
+    }
+
+    for (int retry = 0; retry < HISTORY_QUERY_RETRY_MAX; retry++) {
+        uint32_t head = __atomic_load_n(&ch->head, __ATOMIC_ACQUIRE);
+        uint32_t begin = head > _history_depth ? head - _history_depth : 0;
+
+        _history_scan(ch, begin, head, from_ms, step_ms, points, point_num);
+
+        /*
+         * 讀過的最舊樣本仍未被覆寫,結果有效。寫入端可能正在寫第 now_head 筆,
+         * 它覆寫的是第 now_head - slots 筆,所以 begin 必須比它新
+         */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t now_head = __atomic_load_n(&ch->head, __ATOMIC_RELAXED);
+        if (now_head - begin < _history_slots) {
+            return SUCCESS;
+        }
+    }
+
+    warn(tag, "history query of address %u kept racing the writer", address);
+    return FAIL;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file control_logic_history.h
+ * @brief 感測器歷史數據介面頭文件
+ *
+ * 本文件定義感測器數值的環形歷史緩衝區介面。
+ * 主要功能包括：
+ * - 每個通道(以 Modbus 表位址識別)一個固定大小的環形緩衝區
+ * - 每個通道只有一個寫入端(AIO/RTD 更新執行緒),寫入與查詢都不加鎖
+ * - 任意時間區間的 min/max/avg 降採樣查詢
+ */
+
+#ifndef CONTROL_LOGIC_HISTORY_H
+#define CONTROL_LOGIC_HISTORY_H
+
+#include <stdint.h>
+
+/* 每個區塊的樣本數,查詢時整個區塊落在同一區間就直接使用區塊摘要 */
+#define CONTROL_LOGIC_HISTORY_BLOCK_SIZE (64)
+
+/**
+ * @brief 降採樣查詢結果的一個區間
+ */
+typedef struct {
+    uint64_t ts_ms;     /* 區間起點(time_get_current_ms() 時間) */
+    float min;          /* 區間內最小值,count 為 0 時無效 */
+    float max;          /* 區間內最大值,count 為 0 時無效 */
+    float avg;          /* 區間內平均值,count 為 0 時無效 */
+    uint32_t count;     /* 區間內樣本數 */
+} control_logic_history_point_t;
+
+/**
+ * @brief 初始化歷史模組
+ *
+ * 只設定容量,各通道的緩衝區在第一次寫入時才配置。
+ * 未初始化時 control_logic_history_record() 不做任何事。
+ *
+ * @param depth 每個通道保留的樣本數,向上取整為區塊大小的倍數
+ * @param channels_max 通道數量上限(最多 255)
+ * @return 成功返回 0，失敗返回負值錯誤碼
+ */
+int control_logic_history_init(uint32_t depth, int channels_max);
+
+/**
+ * @brief 釋放所有通道
+ *
+ * 呼叫前必須停止所有寫入端與查詢。
+ */
+void control_logic_history_deinit(void);
+
+/**
+ * @brief 寫入一筆樣本
+ *
+ * 同一位址只能由同一個執行緒寫入。時間戳早於上一筆時以上一筆為準。
+ *
+ * @param address Modbus 表位址,第一次寫入時建立通道
+ * @param ts_ms 取樣時間(time_get_current_ms())
+ * @param value 數值
+ * @return 成功返回 0,通道已滿或未初始化返回 FAIL
+ */
+int control_logic_history_record(uint16_t address, uint64_t ts_ms, float value);
+
+/**
+ * @brief 列出有歷史數據的通道
+ *
+ * @param addresses 輸出通道位址,依建立順序
+ * @param max 陣列容量
+ * @return 通道數量
+ */
+int control_logic_history_channels_get(uint16_t *addresses, int max);
+
+/**
+ * @brief 降採樣查詢
+ *
+ * 將 [from_ms, from_ms + points * step_ms) 切成 points 個長度為 step_ms 的區間,
+ * 計算每個區間內樣本的最小、最大與平均值。已被覆寫的樣本不列入。
+ *
+ * @param address 通道位址
+ * @param from_ms 起點時間
+ * @param step_ms 區間長度
+ * @param points 輸出區間陣列
+ * @param point_num 區間數量
+ * @return 成功返回 0,通道不存在或參數錯誤返回 FAIL
+ */
+int control_logic_history_query(uint16_t address, uint64_t from_ms, uint32_t step_ms,
+                                control_logic_history_point_t *points, int point_num);
+
+#endif /* CONTROL_LOGIC_HISTORY_H */
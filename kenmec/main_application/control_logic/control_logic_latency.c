@@ -0,0 +1,308 @@
+/**
+ * @file control_logic_latency.c
+ * @brief 延遲統計實現
+ *
+ * 本文件實現對數分桶的延遲直方圖,用來判斷控制週期變慢的原因
+ * (HID 讀取逾時、RS485 從站延遲或 Redfish 請求競爭)。
+ *
+ * 分桶方式:
+ * - 小於 16 ns 的值各佔一桶
+ * - 之後每個 2 的次方區間再切成 16 桶,相對誤差不超過 1/16
+ * - 超過 2^40 ns(約 18 分鐘)的值計入最後一桶
+ *
+ * 並行模型:
+ * - 每個執行緒第一次記錄時取得自己的分片,執行緒結束後分片留給下一個新執行緒沿用
+ * - 分片只有一個寫入端,計數、總和與最大值以 relaxed 讀取加儲存更新,不需原子加法或 CAS
+ * - 清除只遞增清除世代,各寫入端下次記錄時清空自己的分片
+ * - 查詢時合併世代相符的分片
+ */
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "kenmec/main_application/control_logic/control_logic_latency.h"
+
+/*---------------------------------------------------------------------------
+                            Defined Constants
+ ---------------------------------------------------------------------------*/
+/* 每個 2 的次方區間的分桶位元數 */
+#define LATENCY_SUB_BITS (4)
+#define LATENCY_SUB_COUNT (1 << LATENCY_SUB_BITS)
+
+/* 可區分的最大值位元數 */
+#define LATENCY_MAX_BITS (40)
+
+#define LATENCY_BUCKET_NUM ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) * LATENCY_SUB_COUNT)
+
+/*---------------------------------------------------------------------------
+                            Type Definitions
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief 分片(每個執行緒一個,只由擁有的執行緒寫入)
+ */
+typedef struct latency_shard {
+    uint32_t counts[CONTROL_LOGIC_LATENCY_METRIC_NUM][LATENCY_BUCKET_NUM];
+    uint64_t sum_ns[CONTROL_LOGIC_LATENCY_METRIC_NUM];
+    uint64_t max_ns[CONTROL_LOGIC_LATENCY_METRIC_NUM];
+    uint32_t epoch;                         /* 分片內容所屬的清除世代 */
+    struct latency_shard *next;             /* 所有分片串列 */
+    struct latency_shard *next_free;        /* 閒置分片串列(受 _latency_mutex 保護) */
+} latency_shard_t;
+
+/*---------------------------------------------------------------------------
+                                Variables
+ ---------------------------------------------------------------------------*/
+/* 序列化分片的建立與回收 */
+static pthread_mutex_t _latency_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* 所有分片,只增不減,新分片以 release 發布 */
+static latency_shard_t *_latency_shards = NULL;
+
+/* 執行緒結束後留下的分片 */
+static latency_shard_t *_latency_shards_free = NULL;
+
+/* 已配置的分片數 */
+static int _latency_shard_count = 0;
+
+/* 清除世代,control_logic_latency_reset() 遞增 */
+static uint32_t _latency_epoch = 0;
+
+/* 執行緒結束時交還分片 */
+static pthread_key_t _latency_shard_key;
+static pthread_once_t _latency_shard_key_once = PTHREAD_ONCE_INIT;
+
+/* 本執行緒的分片 */
+static __thread latency_shard_t *_latency_shard_self = NULL;
+
+static const char *_latency_names[CONTROL_LOGIC_LATENCY_METRIC_NUM] = {
+    [CONTROL_LOGIC_LATENCY_HW_RS485_READ]       = "hw_rs485_read",
+    [CONTROL_LOGIC_LATENCY_HW_RS485_WRITE]      = "hw_rs485_write",
+    [CONTROL_LOGIC_LATENCY_HW_AI_GET]           = "hw_ai_get",
+    [CONTROL_LOGIC_LATENCY_HW_AO_SET]           = "hw_ao_set",
+    [CONTROL_LOGIC_LATENCY_HW_DIO_GET]          = "hw_dio_get",
+    [CONTROL_LOGIC_LATENCY_HW_DO_SET]           = "hw_do_set",
+    [CONTROL_LOGIC_LATENCY_HW_RTD_GET]          = "hw_rtd_get",
+    [CONTROL_LOGIC_LATENCY_HW_PWM_GET]          = "hw_pwm_get",
+    [CONTROL_LOGIC_LATENCY_HW_PWM_SET]          = "hw_pwm_set",
+    [CONTROL_LOGIC_LATENCY_LOGIC_1 + 0]         = "logic_1",
+    [CONTROL_LOGIC_LATENCY_LOGIC_1 + 1]         = "logic_2",
+    [CONTROL_LOGIC_LATENCY_LOGIC_1 + 2]         = "logic_3",
+    [CONTROL_LOGIC_LATENCY_LOGIC_1 + 3]         = "logic_4",
+    [CONTROL_LOGIC_LATENCY_LOGIC_1 + 4]         = "logic_5",
+    [CONTROL_LOGIC_LATENCY_LOGIC_1 + 5]         = "logic_6",
+    [CONTROL_LOGIC_LATENCY_LOGIC_1 + 6]         = "logic_7",
+    [CONTROL_LOGIC_LATENCY_LOGIC_1 + 7]         = "logic_8",
+    [CONTROL_LOGIC_LATENCY_MODBUS_DEVICES]      = "modbus_devices_update",
+    [CONTROL_LOGIC_LATENCY_REDFISH_REQUEST]     = "redfish_request",
+};
+
+/*---------------------------------------------------------------------------
+                                 Implementation
+ ---------------------------------------------------------------------------*/
+static inline uint32_t _latency_bucket(uint64_t ns)
+{
+    if (ns < LATENCY_SUB_COUNT) {
+        return (uint32_t)ns;
+    }
+    if (ns >> LATENCY_MAX_BITS) {
+        return LATENCY_BUCKET_NUM - 1;
+    }
+
+    uint32_t msb = 63 - (uint32_t)__builtin_clzll(ns);
+    uint32_t shift = msb - LATENCY_SUB_BITS;
+
+    return (shift + 1) * LATENCY_SUB_COUNT + (uint32_t)((ns >> shift) & (LATENCY_SUB_COUNT - 1));
+}
+
+/**
+ * @brief 分桶內的最大值
+ */
+static uint64_t _latency_bucket_upper(uint32_t bucket)
+{
+    uint32_t group = bucket / LATENCY_SUB_COUNT;
+    uint64_t sub = bucket % LATENCY_SUB_COUNT;
+
+    if (group == 0) {
+        return sub;
+    }
+
+    uint32_t shift = group - 1;
+
+    return ((LATENCY_SUB_COUNT + sub + 1) << shift) - 1;
+}
+
+static void _latency_shard_release(void *arg)
+{
+    latency_shard_t *shard = (latency_shard_t *)arg;
+
+    pthread_mutex_lock(&_latency_mutex);
+    shard->next_free = _latency_shards_free;
+    _latency_shards_free = shard;
+    pthread_mutex_unlock(&_latency_mutex);
+}
+
+static void _latency_shard_key_create(void)
+{
+    pthread_key_create(&_latency_shard_key, _latency_shard_release);
+}
+
+/**
+ * @brief 取得本執行緒的分片,第一次使用時沿用閒置分片或配置新分片
+ *
+ * @return 分片指標,記憶體不足時返回 NULL
+ */
+static latency_shard_t *_latency_shard_get(void)
+{
+    latency_shard_t *shard = _latency_shard_self;
+
+    if (shard != NULL) {
+        return shard;
+    }
+
+    pthread_once(&_latency_shard_key_once, _latency_shard_key_create);
+
+    pthread_mutex_lock(&_latency_mutex);
+    shard = _latency_shards_free;
+    if (shard != NULL) {
+        _latency_shards_free = shard->next_free;
+    } else {
+        shard = calloc(1, sizeof(latency_shard_t));
+        if (shard != NULL) {
+            shard->epoch = __atomic_load_n(&_latency_epoch, __ATOMIC_RELAXED);
+            shard->next = _latency_shards;
+            __atomic_store_n(&_latency_shards, shard, __ATOMIC_RELEASE);
+            _latency_shard_count++;
+        }
+    }
+    pthread_mutex_unlock(&_latency_mutex);
+
+    if (shard != NULL) {
+        _latency_shard_self = shard;
+        pthread_setspecific(_latency_shard_key, shard);
+    }
+
+    return shard;
+}
+
+/**
+ * @brief 清空本執行緒的分片並標記為目前的清除世代
+ */
+static void _latency_shard_clear(latency_shard_t *shard, uint32_t epoch)
+{
+    for (int m = 0; m < CONTROL_LOGIC_LATENCY_METRIC_NUM; m++) {
+        for (int b = 0; b < LATENCY_BUCKET_NUM; b++) {
+            __atomic_store_n(&shard->counts[m][b], 0, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&shard->sum_ns[m], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&shard->max_ns[m], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&shard->epoch, epoch, __ATOMIC_RELEASE);
+}
+
+uint64_t control_logic_latency_start(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void control_logic_latency_add(control_logic_latency_metric_t metric, uint64_t elapsed_ns)
+{
+    if ((unsigned)metric >= CONTROL_LOGIC_LATENCY_METRIC_NUM) {
+        return;
+    }
+
+    latency_shard_t *shard = _latency_shard_get();
+    if (shard == NULL) {
+        return;
+    }
+
+    uint32_t epoch = __atomic_load_n(&_latency_epoch, __ATOMIC_ACQUIRE);
+    if (shard->epoch != epoch) {
+        _latency_shard_clear(shard, epoch);
+    }
+
+    /* 只有本執行緒寫入,查詢端以 relaxed 讀取 */
+    uint32_t *count = &shard->counts[metric][_latency_bucket(elapsed_ns)];
+    __atomic_store_n(count, __atomic_load_n(count, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->sum_ns[metric], shard->sum_ns[metric] + elapsed_ns, __ATOMIC_RELAXED);
+    if (elapsed_ns > shard->max_ns[metric]) {
+        __atomic_store_n(&shard->max_ns[metric], elapsed_ns, __ATOMIC_RELAXED);
+    }
+}
+
+void control_logic_latency_record(control_logic_latency_metric_t metric, uint64_t start_ns)
+{
+    uint64_t now_ns = control_logic_latency_start();
+
+    control_logic_latency_add(metric, now_ns > start_ns ? now_ns - start_ns : 0);
+}
+
+int control_logic_latency_summary_get(control_logic_latency_metric_t metric, control_logic_latency_summary_t *summary)
+{
+    if ((unsigned)metric >= CONTROL_LOGIC_LATENCY_METRIC_NUM || summary == NULL) {
+        return FAIL;
+    }
+
+    uint64_t counts[LATENCY_BUCKET_NUM];
+
+    memset(counts, 0, sizeof(counts));
+    memset(summary, 0, sizeof(*summary));
+
+    uint32_t epoch = __atomic_load_n(&_latency_epoch, __ATOMIC_ACQUIRE);
+
+    for (const latency_shard_t *shard = __atomic_load_n(&_latency_shards, __ATOMIC_ACQUIRE); shard != NULL;
+         shard = shard->next) {
+        /* 清除後尚未再寫入的分片 */
+        if (__atomic_load_n(&shard->epoch, __ATOMIC_ACQUIRE) != epoch) {
+            continue;
+        }
+        for (int b = 0; b < LATENCY_BUCKET_NUM; b++) {
+            uint32_t count = __atomic_load_n(&shard->counts[metric][b], __ATOMIC_RELAXED);
+            counts[b] += count;
+            summary->count += count;
+        }
+        summary->sum_ns += __atomic_load_n(&shard->sum_ns[metric], __ATOMIC_RELAXED);
+        uint64_t max = __atomic_load_n(&shard->max_ns[metric], __ATOMIC_RELAXED);
+        if (max > summary->max_ns) {
+            summary->max_ns = max;
+        }
+    }
+
+    if (summary->count == 0) {
+        return SUCCESS;
+    }
+
+    /* 第 ceil(p * count) 筆所在的分桶 */
+    const uint32_t permille[3] = { 500, 900, 990 };
+    uint64_t *outputs[3] = { &summary->p50_ns, &summary->p90_ns, &summary->p99_ns };
+    uint64_t seen = 0;
+    int q = 0;
+
+    for (int b = 0; b < LATENCY_BUCKET_NUM && q < 3; b++) {
+        seen += counts[b];
+        while (q < 3 && seen * 1000 >= summary->count * permille[q]) {
+            uint64_t upper = _latency_bucket_upper((uint32_t)b);
+            *outputs[q] = upper < summary->max_ns ? upper : summary->max_ns;
+            q++;
+        }
+    }
+
+    return SUCCESS;
+}
+
+const char *control_logic_latency_name(control_logic_latency_metric_t metric)
+{
+    if ((unsigned)metric >= CONTROL_LOGIC_LATENCY_METRIC_NUM) {
+        return NULL;
+    }
+
+    return _latency_names[metric];
+}
+
+void control_logic_latency_reset(void)
+{
+    /* 各分片由擁有的執行緒在下次記錄時清空,查詢忽略舊世代的分片 */
+    __atomic_add_fetch(&_latency_epoch, 1, __ATOMIC_RELEASE);
+}
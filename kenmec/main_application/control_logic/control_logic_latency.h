@@ -0,0 +1,103 @@
+/**
+ * @file control_logic_latency.h
+ * @brief 延遲統計介面頭文件
+ *
+ * 本文件定義對數分桶(HDR 風格)的延遲直方圖介面。
+ * 主要功能包括：
+ * - 硬體存取(HID/RS485)、控制邏輯、Modbus 設備更新與 Redfish 請求的耗時統計
+ * - 每個執行緒寫入自己的分片(約 47 KB),不需原子加法,也不加鎖
+ * - 查詢時合併分片,計算 p50/p90/p99/max
+ */
+
+#ifndef CONTROL_LOGIC_LATENCY_H
+#define CONTROL_LOGIC_LATENCY_H
+
+#include <stdint.h>
+
+/* 控制邏輯統計項數量(CONTROL_LOGIC_ARRAY 的前幾個) */
+#define CONTROL_LOGIC_LATENCY_LOGIC_MAX (8)
+
+/**
+ * @brief 統計項
+ */
+typedef enum {
+    CONTROL_LOGIC_LATENCY_HW_RS485_READ = 0,    /* RS485 讀取(含鮑率設定) */
+    CONTROL_LOGIC_LATENCY_HW_RS485_WRITE,       /* RS485 寫入 */
+    CONTROL_LOGIC_LATENCY_HW_AI_GET,            /* 類比輸入與模式讀取 */
+    CONTROL_LOGIC_LATENCY_HW_AO_SET,            /* 類比輸出與 AI/AO 模式設定 */
+    CONTROL_LOGIC_LATENCY_HW_DIO_GET,           /* 數位輸入/輸出讀取 */
+    CONTROL_LOGIC_LATENCY_HW_DO_SET,            /* 數位輸出設定 */
+    CONTROL_LOGIC_LATENCY_HW_RTD_GET,           /* RTD 電阻/溫度讀取 */
+    CONTROL_LOGIC_LATENCY_HW_PWM_GET,           /* PWM 頻率/週期/佔空比讀取 */
+    CONTROL_LOGIC_LATENCY_HW_PWM_SET,           /* PWM 佔空比/頻率設定 */
+    CONTROL_LOGIC_LATENCY_LOGIC_1,              /* CONTROL_LOGIC_ARRAY[0] 單次執行 */
+    CONTROL_LOGIC_LATENCY_MODBUS_DEVICES = CONTROL_LOGIC_LATENCY_LOGIC_1 + CONTROL_LOGIC_LATENCY_LOGIC_MAX,
+                                                /* 外部 Modbus 設備一輪更新 */
+    CONTROL_LOGIC_LATENCY_REDFISH_REQUEST,      /* Redfish 請求處理 */
+    CONTROL_LOGIC_LATENCY_METRIC_NUM
+} control_logic_latency_metric_t;
+
+/**
+ * @brief 統計摘要,時間單位為奈秒
+ *
+ * 百分位數為所在分桶的上限(相對誤差不超過 1/16),不會大於 max
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+} control_logic_latency_summary_t;
+
+/**
+ * @brief 取得計時起點
+ *
+ * @return 單調時鐘(奈秒)
+ */
+uint64_t control_logic_latency_start(void);
+
+/**
+ * @brief 記錄從 start_ns 到現在的耗時
+ *
+ * @param metric 統計項
+ * @param start_ns control_logic_latency_start() 的返回值
+ */
+void control_logic_latency_record(control_logic_latency_metric_t metric, uint64_t start_ns);
+
+/**
+ * @brief 記錄一筆已量好的耗時
+ *
+ * @param metric 統計項
+ * @param elapsed_ns 耗時(奈秒)
+ */
+void control_logic_latency_add(control_logic_latency_metric_t metric, uint64_t elapsed_ns);
+
+/**
+ * @brief 合併所有分片並計算摘要
+ *
+ * 與寫入並行時,摘要可能少算正在寫入的幾筆
+ *
+ * @param metric 統計項
+ * @param summary 輸出摘要
+ * @return 成功返回 0,參數錯誤返回 FAIL
+ */
+int control_logic_latency_summary_get(control_logic_latency_metric_t metric, control_logic_latency_summary_t *summary);
+
+/**
+ * @brief 統計項名稱(小寫加底線,可直接作為 Prometheus 標籤值)
+ *
+ * @param metric 統計項
+ * @return 名稱,無效統計項返回 NULL
+ */
+const char *control_logic_latency_name(control_logic_latency_metric_t metric);
+
+/**
+ * @brief 清除所有統計
+ *
+ * 與寫入並行時,正在寫入的幾筆可能不計入
+ */
+void control_logic_latency_reset(void);
+
+#endif /* CONTROL_LOGIC_LATENCY_H */
@@ -2,11 +2,17 @@
 
 #include "dexatek/main_application/include/utilities/os_utilities.h"
 
+#include "kenmec/main_application/kenmec_config.h"
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/control_logic_latency.h"
 
 #include "ls80/control_logic_ls80.h"
 #include "lx1400/control_logic_lx1400.h"
 
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
 /**
  * @file control_logic_manager.c
  * @brief 控制邏輯管理器實現
@@ -20,10 +26,15 @@
  * 4. 控制邏輯啟動、停止和清理
  *
  * 實現原理:
- * - 使用 CONTROL_LOGIC_ARRAY 存儲多個控制邏輯模組
- * - 每個控制邏輯模組在獨立執行緒中運行
- * - 根據 CONTROL_LOGIC_PROCESS_INTERVAL_MS 定期執行控制邏輯
- * - 支援動態切換不同機器類型的控制函數
+ * - 使用 CONTROL_LOGIC_ARRAY 存儲多個控制邏輯模組,各自宣告 period_ms/deadline_ms
+ * - 工作執行緒每個控制邏輯一個,閒置者之一輪流擔任排程者(leader/followers),
+ *   以 timerfd + epoll 等待最近的到期時間,到期後派送,並自行執行第一個派送的控制邏輯;
+ *   不另設排程執行緒,執行緒數與原本每個控制邏輯一個執行緒相同
+ * - 暫存器更新執行緒透過 eventfd 通知新感測資料,即將到期的控制邏輯提前執行
+ * - 上一輪尚未完成時略過本輪(overrun),並記錄 jitter 與執行時間統計
+ * - 每次執行時間另計入 control_logic_latency 直方圖
+ * - stop 會回收所有執行緒,可在運行中切換不同機器類型的控制函數
+ * - init/start/stop/reinit/cleanup 全程持有 _manager_mutex,Redfish PATCH 與管理器自身的呼叫不會交錯
  *
  * @note 控制邏輯模組包括:溫度控制、壓力控制、流量控制、泵控制、閥門控制等
  */
@@ -34,31 +45,75 @@
 /* 日誌標籤 */
 static const char* tag = "cl_mgr";
 
+/* 工作佇列長度(不小於控制邏輯數量) */
+#define CONTROL_LOGIC_QUEUE_SIZE 16
+
+/* 宣告控制邏輯陣列項目,週期與期限單位為毫秒 */
+#define CONTROL_LOGIC_ENTRY(_func, _init, _period_ms, _deadline_ms) \
+    { .func = (_func), .init = (_init), .period_ms = (_period_ms), .deadline_ms = (_deadline_ms) }
+
 /*---------------------------------------------------------------------------
                                 Variables
  ---------------------------------------------------------------------------*/
+/* 管理器生命週期鎖,init/start/stop/reinit/cleanup 全程持有;持有時可再取 _scheduler_mutex,反之不可 */
+static pthread_mutex_t _manager_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static bool _control_logic_manager_initialized = false;
+/* 由 start/stop 寫入,其他執行緒經 control_logic_manager_is_running() 讀取 */
 static bool _control_logic_manager_running = false;
 
+/*
+ * 週期依各控制邏輯自身的節奏:
+ * - 溫度與雙 DC 泵(LX1400)以呼叫次數計算泵浦輪換,維持 1 秒
+ * - 壓力與流量的 PID 以 CLOCK_MONOTONIC 計算 dt,跟隨 AI 電流的輪詢週期
+ * - 泵浦控制以 5Hz 斜率限制轉速(CONTROL_CYCLE_MS)
+ * - 補水泵與閥門的延遲以 1 秒週期設計
+ * 期限為單次執行允許的時間,超過計入 deadline_miss_count
+ */
 ControlLogic CONTROL_LOGIC_ARRAY[] = {
-    {control_logic_ls80_1_temperature_control, NULL, 0, control_logic_ls80_1_temperature_control_init},
-    {control_logic_ls80_2_pressure_control, NULL, 0, control_logic_ls80_2_pressure_control_init},
-    {control_logic_ls80_3_flow_control, NULL, 0, control_logic_ls80_3_flow_control_init},
-    {control_logic_ls80_4_pump_control, NULL, 0, control_logic_ls80_4_pump_control_init},
-    {control_logic_ls80_5_waterpump_control, NULL, 0, control_logic_ls80_5_waterpump_control_init},
-    {control_logic_ls80_6_valve_control, NULL, 0, control_logic_ls80_6_valve_control_init}, 
-    {control_logic_ls80_7_2dc_pump_control, NULL, 0, control_logic_ls80_7_2dc_pump_control_init}
+    CONTROL_LOGIC_ENTRY(control_logic_ls80_1_temperature_control, control_logic_ls80_1_temperature_control_init, 1000, 800),
+    CONTROL_LOGIC_ENTRY(control_logic_ls80_2_pressure_control, control_logic_ls80_2_pressure_control_init,
+                        CONFIG_CONTROL_LOGIC_POLL_AI_CURRENT_MS, 400),
+    CONTROL_LOGIC_ENTRY(control_logic_ls80_3_flow_control, control_logic_ls80_3_flow_control_init,
+                        CONFIG_CONTROL_LOGIC_POLL_AI_CURRENT_MS, 400),
+    CONTROL_LOGIC_ENTRY(control_logic_ls80_4_pump_control, control_logic_ls80_4_pump_control_init, 200, 200),
+    CONTROL_LOGIC_ENTRY(control_logic_ls80_5_waterpump_control, control_logic_ls80_5_waterpump_control_init, 1000, 800),
+    CONTROL_LOGIC_ENTRY(control_logic_ls80_6_valve_control, control_logic_ls80_6_valve_control_init, 1000, 800),
+    CONTROL_LOGIC_ENTRY(control_logic_ls80_7_2dc_pump_control, control_logic_ls80_7_2dc_pump_control_init, 1000, 800)
 };
 
+#define CONTROL_LOGIC_NUM (sizeof(CONTROL_LOGIC_ARRAY) / sizeof(CONTROL_LOGIC_ARRAY[0]))
+
+/* 工作執行緒數量:每個控制邏輯一個,HID 寫入最長阻塞 2000 ms,卡住的控制邏輯不會佔走其他控制邏輯的執行緒 */
+#define CONTROL_LOGIC_WORKER_NUM ((int)CONTROL_LOGIC_NUM)
+
+/* 排程狀態,佇列、排程者與 in_flight/stats 由 _scheduler_mutex 保護 */
+static pthread_mutex_t _scheduler_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _worker_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t _worker_thread_handle[CONTROL_LOGIC_WORKER_NUM];
+static bool _scheduler_abort = false;
+
+/* 是否已有工作執行緒在 epoll 上擔任排程者 */
+static bool _scheduler_leader_active = false;
+
+static int _timer_fd = -1;
+static int _event_fd = -1;
+static int _epoll_fd = -1;
+
+/* 感測資料更新旗標 */
+static int _sensor_data_pending = 0;
+
+/* 工作佇列(控制邏輯索引) */
+static int _job_queue[CONTROL_LOGIC_QUEUE_SIZE];
+static int _job_queue_head = 0;
+static int _job_queue_count = 0;
+
 /*---------------------------------------------------------------------------
                             Function Prototypes
  ---------------------------------------------------------------------------*/
-/**
- * @brief 控制邏輯管理器執行緒函數
- * @param arg 執行緒參數(控制邏輯陣列索引)
- * @return NULL
- */
-static void* _control_logic_manager_thread_func(void* arg);
+static void* _control_logic_worker_thread_func(void* arg);
+static int _control_logic_manager_start_locked(void);
+static int _control_logic_manager_stop_locked(void);
 
 /*---------------------------------------------------------------------------
                                 Implementation
@@ -133,57 +188,274 @@ int control_logic_manager_set_function_pointer(int machine_type)
     return ret;
 }
 
+static uint64_t _monotonic_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 /**
- * @brief 控制邏輯管理器執行緒函數
+ * @brief 設定 timerfd 於最近的到期時間觸發
  *
- * 功能說明:
- * 每個控制邏輯模組在獨立執行緒中運行,定期執行控制邏輯。
- *
- * @param arg 執行緒參數,為控制邏輯陣列的索引值
- * @return NULL
+ * @note 呼叫端須持有 _scheduler_mutex
+ */
+static void _control_logic_timer_arm(void)
+{
+    uint64_t next_due_ns = 0;
+
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        if (CONTROL_LOGIC_ARRAY[i].func == NULL) {
+            continue;
+        }
+        if (next_due_ns == 0 || CONTROL_LOGIC_ARRAY[i].next_due_ns < next_due_ns) {
+            next_due_ns = CONTROL_LOGIC_ARRAY[i].next_due_ns;
+        }
+    }
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (next_due_ns != 0) {
+        its.it_value.tv_sec = next_due_ns / 1000000000ULL;
+        its.it_value.tv_nsec = next_due_ns % 1000000000ULL;
+    }
+
+    timerfd_settime(_timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/**
+ * @brief 派送到期的控制邏輯到工作佇列
  *
  * 實現邏輯:
- * 1. 獲取當前時間戳
- * 2. 首次執行時初始化時間戳
- * 3. 檢查是否達到執行間隔時間(CONTROL_LOGIC_PROCESS_INTERVAL_MS)
- * 4. 如果達到間隔時間,執行對應的控制邏輯函數
- * 5. 更新最後執行時間戳
- * 6. 如果未達到間隔時間,延遲剩餘時間後繼續
- *
- * @note 執行緒會持續運行,不會退出
+ * 1. 已到期,或有新感測資料且距到期不到 CONTROL_LOGIC_EARLY_WAKE_MS 者派送
+ * 2. 上一輪尚未完成時略過本輪並記錄 overrun
+ * 3. 下次到期時間以週期遞增,落後時從現在重新起算,避免補跑
+ *
+ * @note 呼叫端須持有 _scheduler_mutex
  */
-static void* _control_logic_manager_thread_func(void* arg)
+static void _control_logic_dispatch(uint64_t now_ns, bool sensor_data_ready)
 {
-    /* 獲取控制邏輯陣列索引 */
-    int index = (int)arg;
+    const uint64_t early_ns = (uint64_t)CONTROL_LOGIC_EARLY_WAKE_MS * 1000000ULL;
+
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        ControlLogic *logic = &CONTROL_LOGIC_ARRAY[i];
 
-    while (1) {
-        /* 獲取當前時間戳 */
-        uint32_t current_timestamp_ms = time32_get_current_ms();
+        if (logic->func == NULL) {
+            continue;
+        }
 
-        /* 首次執行時初始化時間戳 */
-        if(CONTROL_LOGIC_ARRAY[index].latest_timestamp_ms == 0  ) {
-            CONTROL_LOGIC_ARRAY[index].latest_timestamp_ms = current_timestamp_ms;
+        bool due = (now_ns >= logic->next_due_ns);
+        bool early = (!due && sensor_data_ready && now_ns + early_ns >= logic->next_due_ns);
+        if (!due && !early) {
             continue;
         }
 
-        /* 檢查是否達到執行間隔,如果達到則執行控制邏輯 */
-        if(current_timestamp_ms - CONTROL_LOGIC_ARRAY[index].latest_timestamp_ms >= CONTROL_LOGIC_PROCESS_INTERVAL_MS) {
-            if (CONTROL_LOGIC_ARRAY[index].func != NULL) {
-                /* 執行控制邏輯函數 */
-                CONTROL_LOGIC_ARRAY[index].func(&CONTROL_LOGIC_ARRAY[index]);
+        if (logic->in_flight) {
+            if (!due) {
+                continue;
+            }
+            logic->stats.overrun_count++;
+        } else {
+            if (_job_queue_count >= CONTROL_LOGIC_QUEUE_SIZE) {
+                continue;
             }
-            /* 更新最後執行時間戳 */
-            CONTROL_LOGIC_ARRAY[index].latest_timestamp_ms = current_timestamp_ms;
+
+            uint64_t jitter_ns = due ? (now_ns - logic->next_due_ns) : (logic->next_due_ns - now_ns);
+            uint32_t jitter_us = (uint32_t)(jitter_ns / 1000);
+
+            logic->stats.jitter_last_us = jitter_us;
+            logic->stats.jitter_sum_us += jitter_us;
+            if (jitter_us > logic->stats.jitter_max_us) {
+                logic->stats.jitter_max_us = jitter_us;
+            }
+            if (early) {
+                logic->stats.early_wake_count++;
+            }
+
+            logic->in_flight = true;
+            _job_queue[(_job_queue_head + _job_queue_count) % CONTROL_LOGIC_QUEUE_SIZE] = (int)i;
+            _job_queue_count++;
         }
-        else {
-            /* 延遲剩餘時間 */
-            time_delay_ms(CONTROL_LOGIC_PROCESS_INTERVAL_MS - (current_timestamp_ms - CONTROL_LOGIC_ARRAY[index].latest_timestamp_ms));
+
+        uint64_t period_ns = (uint64_t)logic->period_ms * 1000000ULL;
+        logic->next_due_ns += period_ns;
+        if (logic->next_due_ns <= now_ns) {
+            logic->next_due_ns = now_ns + period_ns;
         }
     }
+}
+
+/**
+ * @brief 擔任排程者:等待到期或感測資料更新後派送
+ *
+ * 功能說明:
+ * 以 epoll 同時等待 timerfd(到期)與 eventfd(感測資料更新/停止),
+ * 醒來後交回排程者角色並派送到期的控制邏輯。
+ *
+ * @note 呼叫端須持有 _scheduler_mutex 且 _scheduler_leader_active 已設為 true,
+ *       等待期間釋放鎖,返回時仍持有鎖
+ */
+static void _control_logic_scheduler_lead(void)
+{
+    struct epoll_event events[2];
+
+    _control_logic_timer_arm();
+    pthread_mutex_unlock(&_scheduler_mutex);
+
+    int n = epoll_wait(_epoll_fd, events, 2, -1);
+    if (n < 0 && errno != EINTR) {
+        error(tag, "epoll_wait failed: %s", strerror(errno));
+        time_delay_ms(100);
+    }
+
+    for (int e = 0; e < n; e++) {
+        uint64_t value = 0;
+        // drain the fd so epoll does not fire again
+        if (read(events[e].data.fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+            error(tag, "read fd %d failed: %s", events[e].data.fd, strerror(errno));
+        }
+    }
+
+    bool sensor_data_ready = __atomic_exchange_n(&_sensor_data_pending, 0, __ATOMIC_ACQ_REL) != 0;
+
+    pthread_mutex_lock(&_scheduler_mutex);
+    _scheduler_leader_active = false;
+    if (!_scheduler_abort) {
+        _control_logic_dispatch(_monotonic_time_ns(), sensor_data_ready);
+    }
+}
+
+/**
+ * @brief 控制邏輯工作執行緒函數
+ *
+ * 功能說明:
+ * 從工作佇列取出控制邏輯並執行,完成後更新時間戳與執行統計。
+ * 佇列為空且沒有排程者時,由本執行緒擔任排程者;
+ * 取走工作時若沒有排程者,喚醒另一個閒置執行緒接手。
+ *
+ * @param arg 未使用
+ * @return NULL
+ */
+static void* _control_logic_worker_thread_func(void* arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&_scheduler_mutex);
+    while (!_scheduler_abort) {
+        if (_job_queue_count == 0) {
+            if (_scheduler_leader_active) {
+                pthread_cond_wait(&_worker_cond, &_scheduler_mutex);
+            } else {
+                _scheduler_leader_active = true;
+                _control_logic_scheduler_lead();
+            }
+            continue;
+        }
+
+        int index = _job_queue[_job_queue_head];
+        _job_queue_head = (_job_queue_head + 1) % CONTROL_LOGIC_QUEUE_SIZE;
+        _job_queue_count--;
+        ControlLogic *logic = &CONTROL_LOGIC_ARRAY[index];
+        /* 依序喚醒:下一個閒置執行緒取下一個工作,沒有工作時接手排程 */
+        if (_job_queue_count > 0 || !_scheduler_leader_active) {
+            pthread_cond_signal(&_worker_cond);
+        }
+        pthread_mutex_unlock(&_scheduler_mutex);
+
+        /* 執行控制邏輯函數 */
+        uint32_t start_timestamp_ms = time32_get_current_ms();
+        uint64_t start_ns = _monotonic_time_ns();
+        if (logic->func != NULL) {
+            logic->func(logic);
+        }
+        uint64_t exec_ns = _monotonic_time_ns() - start_ns;
+        uint32_t exec_us = (uint32_t)(exec_ns / 1000);
+        if (index < CONTROL_LOGIC_LATENCY_LOGIC_MAX) {
+            control_logic_latency_add(CONTROL_LOGIC_LATENCY_LOGIC_1 + index, exec_ns);
+        }
+
+        pthread_mutex_lock(&_scheduler_mutex);
+        /* 更新最後執行時間戳 */
+        logic->latest_timestamp_ms = start_timestamp_ms;
+        logic->in_flight = false;
+        logic->stats.run_count++;
+        logic->stats.exec_last_us = exec_us;
+        if (exec_us > logic->stats.exec_max_us) {
+            logic->stats.exec_max_us = exec_us;
+        }
+        if (exec_us > logic->deadline_ms * 1000) {
+            logic->stats.deadline_miss_count++;
+            warn(tag, "control logic %d missed deadline: %u us", index + 1, exec_us);
+        }
+    }
+    pthread_mutex_unlock(&_scheduler_mutex);
+
     return NULL;
 }
 
+static void _control_logic_scheduler_fds_close(void)
+{
+    if (_epoll_fd >= 0) {
+        close(_epoll_fd);
+        _epoll_fd = -1;
+    }
+    if (_timer_fd >= 0) {
+        close(_timer_fd);
+        _timer_fd = -1;
+    }
+    if (_event_fd >= 0) {
+        close(_event_fd);
+        _event_fd = -1;
+    }
+}
+
+static int _control_logic_scheduler_fds_open(void)
+{
+    _timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (_timer_fd < 0 || _event_fd < 0 || _epoll_fd < 0) {
+        error(tag, "Failed to create scheduler fds: %s", strerror(errno));
+        _control_logic_scheduler_fds_close();
+        return FAIL;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = _timer_fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _timer_fd, &ev) != 0) {
+        error(tag, "Failed to add timerfd: %s", strerror(errno));
+        _control_logic_scheduler_fds_close();
+        return FAIL;
+    }
+    ev.data.fd = _event_fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &ev) != 0) {
+        error(tag, "Failed to add eventfd: %s", strerror(errno));
+        _control_logic_scheduler_fds_close();
+        return FAIL;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief 喚醒擔任排程者的工作執行緒
+ *
+ * @note 呼叫端須持有 _scheduler_mutex,避免與 stop 關閉 eventfd 競爭
+ */
+static void _control_logic_scheduler_wakeup(void)
+{
+    uint64_t one = 1;
+
+    if (_event_fd >= 0 && write(_event_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        error(tag, "eventfd write failed: %s", strerror(errno));
+    }
+}
+
 /**
  * @brief 重新初始化控制邏輯管理器
  *
@@ -195,14 +467,24 @@ static void* _control_logic_manager_thread_func(void* arg)
  *         - 其他值: 初始化失敗
  *
  * 實現邏輯:
- * 1. 根據當前機器類型設置函數指標
- * 2. 初始化硬體設備
- * 3. 執行所有控制邏輯模組的初始化函數
+ * 1. 若正在運行,先停止並回收排程與工作執行緒
+ * 2. 根據當前機器類型設置函數指標
+ * 3. 初始化硬體設備
+ * 4. 執行所有控制邏輯模組的初始化函數
+ * 5. 若原本在運行,重新啟動
  */
 int control_logic_manager_reinit(void)
 {
     int ret = SUCCESS;
 
+    pthread_mutex_lock(&_manager_mutex);
+
+    /* 停止執行中的控制邏輯,避免切換函數指標時仍在執行舊機型邏輯 */
+    bool was_running = __atomic_load_n(&_control_logic_manager_running, __ATOMIC_ACQUIRE);
+    if (was_running) {
+        _control_logic_manager_stop_locked();
+    }
+
     /* 根據機器類型設置函數指標 */
     control_logic_manager_set_function_pointer(control_logic_config_get_machine_type());
 
@@ -210,16 +492,21 @@ int control_logic_manager_reinit(void)
     ret = control_hardware_init(control_logic_config_get_machine_type());
     if (ret != SUCCESS) {
         error(tag, "Failed to initialize control logic hardware");
-        return ret;
+    } else {
+        /* 初始化所有控制邏輯模組 */
+        for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+            if (CONTROL_LOGIC_ARRAY[i].init != NULL) {
+                CONTROL_LOGIC_ARRAY[i].init();
+            }
+        }
     }
 
-    /* 初始化所有控制邏輯模組 */
-    for (size_t i = 0; i < sizeof(CONTROL_LOGIC_ARRAY) / sizeof(CONTROL_LOGIC_ARRAY[0]); i++) {
-        if (CONTROL_LOGIC_ARRAY[i].init != NULL) {
-            CONTROL_LOGIC_ARRAY[i].init();
-        }
+    if (was_running) {
+        _control_logic_manager_start_locked();
     }
 
+    pthread_mutex_unlock(&_manager_mutex);
+
     return ret;
 }
 
@@ -238,16 +525,17 @@ int control_logic_manager_reinit(void)
  * 2. 初始化硬體設備
  * 3. 根據機器類型設置函數指標
  * 4. 執行所有控制邏輯模組的初始化函數
- * 5. 為每個控制邏輯模組創建獨立執行緒
- * 6. 設置初始化完成標誌
+ * 5. 設置初始化完成標誌
+ *
+ * @note 排程與工作執行緒由 control_logic_manager_start() 建立
  */
 int control_logic_manager_init(void)
 {
-
-    debug(tag, "VVVV00111888mmm***********************444222");
+    pthread_mutex_lock(&_manager_mutex);
 
     /* 檢查是否已經初始化 */
     if (_control_logic_manager_initialized) {
+        pthread_mutex_unlock(&_manager_mutex);
         debug(tag, "Control logic already initialized");
         return 0;
     }
@@ -263,7 +551,7 @@ int control_logic_manager_init(void)
     control_logic_manager_set_function_pointer(control_logic_config_get_machine_type());
 
     /* 初始化所有控制邏輯模組 */
-    for (size_t i = 0; i < sizeof(CONTROL_LOGIC_ARRAY) / sizeof(CONTROL_LOGIC_ARRAY[0]); i++) {
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
         if (CONTROL_LOGIC_ARRAY[i].init != NULL) {
             CONTROL_LOGIC_ARRAY[i].init();
         }
@@ -272,13 +560,7 @@ int control_logic_manager_init(void)
     /* 設置初始化完成標誌 */
     _control_logic_manager_initialized = true;
 
-    /* 為每個控制邏輯模組創建執行緒 */
-    for (size_t i = 0; i < sizeof(CONTROL_LOGIC_ARRAY) / sizeof(CONTROL_LOGIC_ARRAY[0]); i++) {
-        if (pthread_create(&CONTROL_LOGIC_ARRAY[i].thread_handle, NULL, _control_logic_manager_thread_func, (void*)i) != 0) {
-            error(tag, "Failed to create control logic thread");
-            return -1;
-        }
-    }
+    pthread_mutex_unlock(&_manager_mutex);
 
     debug(tag, "Control logic initialized successfully");
     return 0;
@@ -288,16 +570,19 @@ int control_logic_manager_init(void)
  * @brief 啟動控制邏輯管理器
  *
  * 功能說明:
- * 啟動控制邏輯管理器,使其開始執行控制邏輯。
+ * 啟動控制邏輯管理器,建立工作執行緒(閒置者輪流擔任排程者)。
+ * 第一次執行時間為啟動後一個週期。
  *
  * @return int 執行結果
  *         - 0: 啟動成功
- *         - -1: 啟動失敗(未初始化)
+ *         - -1: 啟動失敗(未初始化或執行緒建立失敗)
  *
- * @note 需要先調用 control_logic_manager_init() 進行初始化
+ * @note 需要先調用 control_logic_manager_init() 進行初始化;呼叫前須持有 _manager_mutex
  */
-int control_logic_manager_start(void)
+static int _control_logic_manager_start_locked(void)
 {
+    int ret = SUCCESS;
+
     /* 檢查是否已初始化 */
     if (!_control_logic_manager_initialized) {
         error(tag, "Control logic not initialized");
@@ -305,44 +590,126 @@ int control_logic_manager_start(void)
     }
 
     /* 檢查是否已在運行中 */
-    if (_control_logic_manager_running) {
+    if (__atomic_load_n(&_control_logic_manager_running, __ATOMIC_ACQUIRE)) {
         debug(tag, "Control logic already running");
         return 0;
     }
 
     debug(tag, "Starting control logic...");
 
+    pthread_mutex_lock(&_scheduler_mutex);
+    ret = _control_logic_scheduler_fds_open();
+    pthread_mutex_unlock(&_scheduler_mutex);
+    if (ret != SUCCESS) {
+        return -1;
+    }
+
+    /* 重置排程狀態 */
+    uint64_t now_ns = _monotonic_time_ns();
+    uint32_t now_ms = time32_get_current_ms();
+    _scheduler_abort = false;
+    _scheduler_leader_active = false;
+    _job_queue_head = 0;
+    _job_queue_count = 0;
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        CONTROL_LOGIC_ARRAY[i].in_flight = false;
+        CONTROL_LOGIC_ARRAY[i].latest_timestamp_ms = now_ms;
+        CONTROL_LOGIC_ARRAY[i].next_due_ns = now_ns + (uint64_t)CONTROL_LOGIC_ARRAY[i].period_ms * 1000000ULL;
+    }
+
+    /* 建立工作執行緒 */
+    int worker_num = 0;
+    for (; worker_num < CONTROL_LOGIC_WORKER_NUM; worker_num++) {
+        if (pthread_create(&_worker_thread_handle[worker_num], NULL, _control_logic_worker_thread_func, NULL) != 0) {
+            break;
+        }
+    }
+
+    if (worker_num != CONTROL_LOGIC_WORKER_NUM) {
+        error(tag, "Failed to create control logic thread");
+
+        pthread_mutex_lock(&_scheduler_mutex);
+        _scheduler_abort = true;
+        pthread_cond_broadcast(&_worker_cond);
+        _control_logic_scheduler_wakeup();
+        pthread_mutex_unlock(&_scheduler_mutex);
+        for (int i = 0; i < worker_num; i++) {
+            pthread_join(_worker_thread_handle[i], NULL);
+        }
+
+        pthread_mutex_lock(&_scheduler_mutex);
+        _control_logic_scheduler_fds_close();
+        pthread_mutex_unlock(&_scheduler_mutex);
+        return -1;
+    }
+
     /* 設置運行狀態標誌 */
-    _control_logic_manager_running = true;
+    __atomic_store_n(&_control_logic_manager_running, true, __ATOMIC_RELEASE);
     debug(tag, "Control logic started successfully");
     return 0;
 }
 
+int control_logic_manager_start(void)
+{
+    pthread_mutex_lock(&_manager_mutex);
+    int ret = _control_logic_manager_start_locked();
+    pthread_mutex_unlock(&_manager_mutex);
+
+    return ret;
+}
+
 /**
  * @brief 停止控制邏輯管理器
  *
  * 功能說明:
- * 停止控制邏輯管理器的執行。
+ * 停止控制邏輯管理器的執行,等待執行中的控制邏輯完成後回收所有執行緒。
+ * 返回後不會再有控制邏輯被呼叫,可安全切換函數指標。
  *
  * @return int 執行結果
  *         - 0: 停止成功或已停止
+ *
+ * @note 呼叫前須持有 _manager_mutex
  */
-int control_logic_manager_stop(void)
+static int _control_logic_manager_stop_locked(void)
 {
     /* 檢查是否在運行中 */
-    if (!_control_logic_manager_running) {
+    if (!__atomic_load_n(&_control_logic_manager_running, __ATOMIC_ACQUIRE)) {
         debug(tag, "Control logic not running");
         return 0;
     }
 
     debug(tag, "Stopping control logic...");
 
+    /* 通知工作執行緒結束,eventfd 喚醒擔任排程者的執行緒 */
+    pthread_mutex_lock(&_scheduler_mutex);
+    _scheduler_abort = true;
+    pthread_cond_broadcast(&_worker_cond);
+    _control_logic_scheduler_wakeup();
+    pthread_mutex_unlock(&_scheduler_mutex);
+
+    for (int i = 0; i < CONTROL_LOGIC_WORKER_NUM; i++) {
+        pthread_join(_worker_thread_handle[i], NULL);
+    }
+
+    pthread_mutex_lock(&_scheduler_mutex);
+    _control_logic_scheduler_fds_close();
+    pthread_mutex_unlock(&_scheduler_mutex);
+
     /* 清除運行狀態標誌 */
-    _control_logic_manager_running = false;
+    __atomic_store_n(&_control_logic_manager_running, false, __ATOMIC_RELEASE);
     debug(tag, "Control logic stopped successfully");
     return 0;
 }
 
+int control_logic_manager_stop(void)
+{
+    pthread_mutex_lock(&_manager_mutex);
+    int ret = _control_logic_manager_stop_locked();
+    pthread_mutex_unlock(&_manager_mutex);
+
+    return ret;
+}
+
 /**
  * @brief 清理控制邏輯管理器
  *
@@ -355,9 +722,11 @@ int control_logic_manager_stop(void)
  */
 void control_logic_manager_cleanup(void)
 {
+    pthread_mutex_lock(&_manager_mutex);
+
     /* 如果正在運行,先停止 */
-    if (_control_logic_manager_running) {
-        control_logic_manager_stop();
+    if (__atomic_load_n(&_control_logic_manager_running, __ATOMIC_ACQUIRE)) {
+        _control_logic_manager_stop_locked();
     }
 
     debug(tag, "Cleaning up control logic...");
@@ -365,6 +734,8 @@ void control_logic_manager_cleanup(void)
     /* 清除初始化狀態標誌 */
     _control_logic_manager_initialized = false;
 
+    pthread_mutex_unlock(&_manager_mutex);
+
     debug(tag, "Control logic cleanup completed");
 }
 
@@ -377,7 +748,7 @@ void control_logic_manager_cleanup(void)
  */
 bool control_logic_manager_is_running(void)
 {
-    return _control_logic_manager_running;
+    return __atomic_load_n(&_control_logic_manager_running, __ATOMIC_ACQUIRE);
 }
 
 /**
@@ -386,5 +757,42 @@ bool control_logic_manager_is_running(void)
  * @return int 控制邏輯模組數量
  */
 int control_logic_manager_number_of_control_logics(void) {
-    return sizeof(CONTROL_LOGIC_ARRAY) / sizeof(CONTROL_LOGIC_ARRAY[0]);
+    return CONTROL_LOGIC_NUM;
+}
+
+/**
+ * @brief 通知控制邏輯有新的感測資料
+ *
+ * 只設定旗標並喚醒擔任排程者的工作執行緒,不會阻塞呼叫端
+ */
+void control_logic_manager_sensor_data_notify(void)
+{
+    __atomic_store_n(&_sensor_data_pending, 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&_scheduler_mutex);
+    _control_logic_scheduler_wakeup();
+    pthread_mutex_unlock(&_scheduler_mutex);
+}
+
+/**
+ * @brief 取得控制邏輯執行統計
+ *
+ * @param index 控制邏輯陣列索引
+ * @param stats 統計輸出
+ *
+ * @return int 執行結果
+ *         - SUCCESS: 取得成功
+ *         - FAIL: 索引或參數錯誤
+ */
+int control_logic_manager_stats_get(int index, control_logic_stats_t *stats)
+{
+    if (index < 0 || index >= (int)CONTROL_LOGIC_NUM || stats == NULL) {
+        return FAIL;
+    }
+
+    pthread_mutex_lock(&_scheduler_mutex);
+    *stats = CONTROL_LOGIC_ARRAY[index].stats;
+    pthread_mutex_unlock(&_scheduler_mutex);
+
+    return SUCCESS;
 }
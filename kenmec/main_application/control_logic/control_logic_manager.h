@@ -27,6 +27,9 @@
 /* 控制邏輯處理週期，單位：毫秒 */
 #define CONTROL_LOGIC_PROCESS_INTERVAL_MS 1000  // 每1000毫秒（1秒）執行一次控制邏輯
 
+/* 感測資料更新時，允許提前執行的時間窗，單位：毫秒 */
+#define CONTROL_LOGIC_EARLY_WAKE_MS 200
+
 /*---------------------------------------------------------------------------
                             Type Definitions
  ---------------------------------------------------------------------------*/
@@ -36,16 +39,37 @@
  */
 typedef struct control_logic_t ControlLogic;
 
+/**
+ * @brief 控制邏輯執行統計
+ *
+ * jitter 為實際派送時間與預定時間的差距（提前或延遲皆計入）
+ */
+typedef struct {
+    uint32_t run_count;                /* 執行次數 */
+    uint32_t early_wake_count;         /* 因感測資料更新而提前執行的次數 */
+    uint32_t overrun_count;            /* 到期時上一輪尚未完成而略過的次數 */
+    uint32_t deadline_miss_count;      /* 執行時間超過 deadline 的次數 */
+    uint32_t jitter_last_us;           /* 最近一次 jitter（微秒） */
+    uint32_t jitter_max_us;            /* 最大 jitter（微秒） */
+    uint64_t jitter_sum_us;            /* jitter 累計（微秒），除以 run_count 為平均 */
+    uint32_t exec_last_us;             /* 最近一次執行時間（微秒） */
+    uint32_t exec_max_us;              /* 最大執行時間（微秒） */
+} control_logic_stats_t;
+
 /**
  * @brief 控制邏輯結構
  *
- * 定義單一控制邏輯的完整資訊，包括執行函數、執行緒控制和時間戳記
+ * 定義單一控制邏輯的完整資訊，包括執行函數、排程參數和執行統計
  */
 struct control_logic_t {
     int (*func)(ControlLogic* ptr);    /* 控制邏輯執行函數指標 */
-    pthread_t thread_handle;           /* POSIX 執行緒控制代碼 */
     uint32_t latest_timestamp_ms;      /* 最近一次執行的時間戳記（毫秒） */
     int (*init)(void);                 /* 控制邏輯初始化函數指標 */
+    uint32_t period_ms;                /* 執行週期（毫秒） */
+    uint32_t deadline_ms;              /* 單次執行期限（毫秒） */
+    uint64_t next_due_ns;              /* 下次預定執行時間（CLOCK_MONOTONIC） */
+    bool in_flight;                    /* 是否正在工作執行緒中執行 */
+    control_logic_stats_t stats;       /* 執行統計 */
 };
 
 /*---------------------------------------------------------------------------
@@ -65,8 +89,8 @@ int control_logic_manager_init(void);
 /**
  * @brief 啟動控制邏輯處理
  *
- * 啟動控制邏輯的執行緒，開始週期性執行控制邏輯。
- * 呼叫此函數後，控制邏輯將按照 CONTROL_LOGIC_PROCESS_INTERVAL_MS 定義的週期執行。
+ * 建立工作執行緒（閒置者輪流擔任排程者），開始週期性執行控制邏輯。
+ * 呼叫此函數後，控制邏輯將按照各自的 period_ms 週期執行。
  *
  * @return 成功返回 0，失敗返回負值錯誤碼
  */
@@ -75,7 +99,7 @@ int control_logic_manager_start(void);
 /**
  * @brief 停止控制邏輯處理
  *
- * 停止所有控制邏輯的執行，終止執行緒。
+ * 停止所有控制邏輯的執行，等待執行中的控制邏輯完成並回收執行緒。
  * 呼叫此函數後，控制邏輯將停止執行，但不會釋放資源。
  *
  * @return 成功返回 0，失敗返回負值錯誤碼
@@ -137,4 +161,21 @@ int control_logic_manager_set_function_pointer(int machine_type);
  */
 int control_logic_manager_reinit(void);
 
+/**
+ * @brief 通知控制邏輯有新的感測資料
+ *
+ * 由暫存器更新執行緒在完成一輪更新後呼叫，
+ * 距離下次執行不到 CONTROL_LOGIC_EARLY_WAKE_MS 的控制邏輯會提前執行。
+ */
+void control_logic_manager_sensor_data_notify(void);
+
+/**
+ * @brief 取得控制邏輯執行統計
+ *
+ * @param index 控制邏輯陣列索引
+ * @param stats 統計輸出
+ * @return 成功返回 0，失敗返回負值錯誤碼
+ */
+int control_logic_manager_stats_get(int index, control_logic_stats_t *stats);
+
 #endif /* CONTROL_LOGIC_MANAGER_H */ 
\ No newline at end of file
@@ -0,0 +1,405 @@
+/**
+ * @file control_logic_persist.c
+ * @brief Modbus 表延遲持久化實現
+ *
+ * 本文件實現 Modbus/HMI 寫入的持久化,取代每次寫入都完整存檔的做法。
+ *
+ * 主要功能:
+ * 1. 寫入記錄先放入記憶體佇列,呼叫端不等待檔案 I/O
+ * 2. 持久化執行緒去抖動後批次追加到日誌,每批只做一次 fsync
+ * 3. 日誌記錄數達上限或超過壓縮週期時,存一次完整快照並清空日誌
+ * 4. 啟動時重播日誌,遇到 CRC 錯誤或不完整記錄即截斷
+ *
+ * 日誌格式:
+ * - 固定長度記錄 journal_record_t,含 magic 與 CRC32
+ * - 日誌只會追加,壓縮成功後才會截斷為 0
+ *
+ * @note 佇列依最高寫入速率與去抖動時間配置;仍然滿時不丟棄資料,
+ *       改為標記下一輪直接壓縮(完整快照涵蓋所有寫入)
+ */
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "dexatek/main_application/managers/modbus_manager/modbus_manager.h"
+
+#include "kenmec/main_application/kenmec_config.h"
+#include "kenmec/main_application/control_logic/control_logic_update.h"
+#include "kenmec/main_application/control_logic/control_logic_persist.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/*---------------------------------------------------------------------------
+                            Defined Constants
+ ---------------------------------------------------------------------------*/
+/* 日誌標籤 */
+static const char* tag = "control_logic_persist";
+
+/* 日誌記錄標記 */
+#define JOURNAL_RECORD_MAGIC (0x4A52)
+
+/* 待寫佇列長度:最高寫入速率下,一次去抖動加上一次寫入日誌(以不超過去抖動時間計)期間累積的記錄數 */
+#define PERSIST_QUEUE_SIZE ((CONFIG_MODBUS_TABLE_JOURNAL_MAX_RATE * CONFIG_MODBUS_TABLE_JOURNAL_DEBOUNCE_MS * 2) / 1000)
+
+#if PERSIST_QUEUE_SIZE < 256
+#undef PERSIST_QUEUE_SIZE
+#define PERSIST_QUEUE_SIZE (256)
+#endif
+
+/* 持久化執行緒最長等待時間(毫秒) */
+#define PERSIST_THREAD_WAIT_MS (1000)
+
+/*---------------------------------------------------------------------------
+                            Type Definitions
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief 日誌記錄
+ *
+ * crc 涵蓋 crc 欄位之前的所有位元組
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;         /* JOURNAL_RECORD_MAGIC */
+    uint16_t address;       /* Modbus 表格位址 */
+    uint8_t type;           /* 資料類型 */
+    uint8_t reserved[3];
+    uint32_t value;         /* 寫入的值 */
+    uint32_t crc;           /* CRC32 */
+} journal_record_t;
+
+/*---------------------------------------------------------------------------
+                                Variables
+ ---------------------------------------------------------------------------*/
+static pthread_mutex_t _persist_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* 以 CLOCK_MONOTONIC 計時,於 control_logic_persist_init() 初始化 */
+static pthread_cond_t _persist_cond;
+static pthread_t _persist_thread_handle;
+
+static BOOL _persist_running = FALSE;
+
+/* 待寫佇列(雙緩衝:持久化執行緒寫入一個時,呼叫端填入另一個) */
+static journal_record_t _persist_buffers[2][PERSIST_QUEUE_SIZE];
+static journal_record_t *_persist_queue = _persist_buffers[0];
+static uint32_t _persist_queue_count = 0;
+
+/* 佇列滿時標記,下一輪直接存完整快照 */
+static BOOL _persist_overflow = FALSE;
+
+/* 日誌檔案 */
+static int _journal_fd = -1;
+static uint32_t _journal_records = 0;
+static uint64_t _latest_compact_ms = 0;
+
+/* 統計(持久化執行緒更新,以原子操作讀寫) */
+static uint32_t _journal_fsync_count = 0;
+static uint32_t _journal_compact_count = 0;
+static uint32_t _persist_overflow_count = 0;
+
+/*---------------------------------------------------------------------------
+                            Function Prototypes
+ ---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------
+                                Implementation
+ ---------------------------------------------------------------------------*/
+static uint32_t _crc32(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
+
+static uint32_t _journal_record_crc(const journal_record_t *record)
+{
+    return _crc32((const uint8_t *)record, offsetof(journal_record_t, crc));
+}
+
+/**
+ * @brief 重播日誌到 Modbus 表
+ *
+ * 實現邏輯:
+ * 1. 依序讀取固定長度記錄
+ * 2. 遇到不完整記錄、magic 或 CRC 錯誤即停止(視為寫入中斷的尾端)
+ * 3. 有效記錄依資料類型寫回 Modbus 表,與寫入回呼相同
+ * 4. 將檔案截斷到最後一筆有效記錄之後
+ *
+ * @return int 有效記錄數
+ */
+static int _journal_replay(int fd)
+{
+    journal_record_t record;
+    off_t valid_offset = 0;
+    int count = 0;
+
+    if (lseek(fd, 0, SEEK_SET) < 0) {
+        return 0;
+    }
+
+    while (read(fd, &record, sizeof(record)) == (ssize_t)sizeof(record)) {
+        if (record.magic != JOURNAL_RECORD_MAGIC || record.crc != _journal_record_crc(&record)) {
+            warn(tag, "journal record %d corrupted, truncate", count);
+            break;
+        }
+
+        if (control_logic_update_value_to_modbus_table(record.address, record.type, record.value) != SUCCESS) {
+            warn(tag, "journal record %d (address %u, type %u) not applied", count, record.address, record.type);
+        }
+
+        valid_offset += sizeof(record);
+        count++;
+    }
+
+    // drop the torn tail so new records are appended after the last valid one
+    if (ftruncate(fd, valid_offset) != 0) {
+        error(tag, "journal truncate failed: %s", strerror(errno));
+    }
+    lseek(fd, 0, SEEK_END);
+
+    return count;
+}
+
+static int _journal_append(const journal_record_t *records, uint32_t count)
+{
+    int ret = SUCCESS;
+
+    size_t len = count * sizeof(journal_record_t);
+    ssize_t written = write(_journal_fd, records, len);
+
+    if (written != (ssize_t)len) {
+        error(tag, "journal write failed: %zd/%zu", written, len);
+        ret = FAIL;
+    } else if (fdatasync(_journal_fd) != 0) {
+        error(tag, "journal fdatasync failed: %s", strerror(errno));
+        ret = FAIL;
+    } else {
+        __atomic_fetch_add(&_journal_fsync_count, 1, __ATOMIC_RELAXED);
+        _journal_records += count;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 將 Modbus 表存成完整快照並清空日誌
+ *
+ * 快照存檔失敗時保留日誌,下一輪再試
+ */
+static int _journal_compact(void)
+{
+    int ret = modbus_manager_data_mapping_save();
+
+    if (ret == SUCCESS) {
+        if (ftruncate(_journal_fd, 0) != 0 || fdatasync(_journal_fd) != 0) {
+            error(tag, "journal reset failed: %s", strerror(errno));
+            ret = FAIL;
+        } else {
+            debug(tag, "journal compacted, %u records", _journal_records);
+            _journal_records = 0;
+            __atomic_fetch_add(&_journal_compact_count, 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        error(tag, "modbus_manager_data_mapping_save failed, ret = %d", ret);
+    }
+
+    _latest_compact_ms = time_get_current_ms();
+
+    return ret;
+}
+
+static BOOL _journal_compact_needed(void)
+{
+    if (_journal_records >= CONFIG_MODBUS_TABLE_JOURNAL_COMPACT_RECORDS) {
+        return TRUE;
+    }
+
+    if (_journal_records > 0 &&
+        time_get_current_ms() - _latest_compact_ms >= CONFIG_MODBUS_TABLE_JOURNAL_COMPACT_INTERVAL_MS) {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief 取出待寫佇列並寫入日誌
+ */
+static void _persist_flush(void)
+{
+    journal_record_t *batch = NULL;
+    uint32_t count = 0;
+    BOOL overflow = FALSE;
+
+    // swap buffers, only this thread flushes so the other one is free
+    pthread_mutex_lock(&_persist_mutex);
+    batch = _persist_queue;
+    count = _persist_queue_count;
+    _persist_queue = (batch == _persist_buffers[0]) ? _persist_buffers[1] : _persist_buffers[0];
+    _persist_queue_count = 0;
+    overflow = _persist_overflow;
+    _persist_overflow = FALSE;
+    pthread_mutex_unlock(&_persist_mutex);
+
+    if (overflow) {
+        // the snapshot already holds every queued value
+        if (_journal_compact() != SUCCESS) {
+            pthread_mutex_lock(&_persist_mutex);
+            _persist_overflow = TRUE;
+            pthread_mutex_unlock(&_persist_mutex);
+        }
+        return;
+    }
+
+    if (count > 0 && _journal_append(batch, count) != SUCCESS) {
+        // journal is unusable, fall back to a full snapshot
+        _journal_compact();
+        return;
+    }
+
+    if (_journal_compact_needed()) {
+        _journal_compact();
+    }
+}
+
+static void* _persist_thread(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        pthread_mutex_lock(&_persist_mutex);
+        if (_persist_running && _persist_queue_count == 0 && !_persist_overflow) {
+            // monotonic deadline, a wall-clock step must not stretch or skip the wait
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            ts.tv_sec += PERSIST_THREAD_WAIT_MS / 1000;
+            pthread_cond_timedwait(&_persist_cond, &_persist_mutex, &ts);
+        }
+        BOOL running = _persist_running;
+        BOOL pending = (_persist_queue_count > 0 || _persist_overflow);
+        pthread_mutex_unlock(&_persist_mutex);
+
+        if (!running) {
+            break;
+        }
+
+        if (pending) {
+            // debounce: let a burst of writes land in the same batch
+            time_delay_ms(CONFIG_MODBUS_TABLE_JOURNAL_DEBOUNCE_MS);
+        }
+
+        _persist_flush();
+    }
+
+    return NULL;
+}
+
+int control_logic_persist_record(uint16_t address, uint8_t type, uint32_t value)
+{
+    int ret = SUCCESS;
+
+    journal_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.magic = JOURNAL_RECORD_MAGIC;
+    record.address = address;
+    record.type = type;
+    record.value = value;
+    record.crc = _journal_record_crc(&record);
+
+    pthread_mutex_lock(&_persist_mutex);
+    if (!_persist_running) {
+        ret = FAIL;
+    } else {
+        if (_persist_queue_count < PERSIST_QUEUE_SIZE) {
+            _persist_queue[_persist_queue_count++] = record;
+        } else {
+            _persist_overflow = TRUE;
+            __atomic_fetch_add(&_persist_overflow_count, 1, __ATOMIC_RELAXED);
+        }
+        pthread_cond_signal(&_persist_cond);
+    }
+    pthread_mutex_unlock(&_persist_mutex);
+
+    if (ret != SUCCESS) {
+        // persistence not started, keep the old synchronous behaviour
+        ret = modbus_manager_data_mapping_save();
+    }
+
+    return ret;
+}
+
+void control_logic_persist_stats_get(uint32_t *fsync_count, uint32_t *compact_count, uint32_t *overflow_count)
+{
+    if (fsync_count != NULL) {
+        *fsync_count = __atomic_load_n(&_journal_fsync_count, __ATOMIC_RELAXED);
+    }
+    if (compact_count != NULL) {
+        *compact_count = __atomic_load_n(&_journal_compact_count, __ATOMIC_RELAXED);
+    }
+    if (overflow_count != NULL) {
+        *overflow_count = __atomic_load_n(&_persist_overflow_count, __ATOMIC_RELAXED);
+    }
+}
+
+int control_logic_persist_init(void)
+{
+    int ret = SUCCESS;
+
+    _journal_fd = open(CONFIG_MODBUS_TABLE_JOURNAL_PATH, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (_journal_fd < 0) {
+        error(tag, "open %s failed: %s", CONFIG_MODBUS_TABLE_JOURNAL_PATH, strerror(errno));
+        return FAIL;
+    }
+
+    _journal_records = _journal_replay(_journal_fd);
+    _latest_compact_ms = time_get_current_ms();
+    info(tag, "journal replayed, %u records", _journal_records);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_persist_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    _persist_running = TRUE;
+    if (pthread_create(&_persist_thread_handle, NULL, _persist_thread, NULL) != 0) {
+        error(tag, "Failed to create persist thread");
+        _persist_running = FALSE;
+        pthread_cond_destroy(&_persist_cond);
+        close(_journal_fd);
+        _journal_fd = -1;
+        ret = FAIL;
+    }
+
+    return ret;
+}
+
+int control_logic_persist_deinit(void)
+{
+    int ret = SUCCESS;
+
+    pthread_mutex_lock(&_persist_mutex);
+    BOOL running = _persist_running;
+    _persist_running = FALSE;
+    if (running) {
+        pthread_cond_signal(&_persist_cond);
+    }
+    pthread_mutex_unlock(&_persist_mutex);
+
+    if (running) {
+        pthread_join(_persist_thread_handle, NULL);
+        pthread_cond_destroy(&_persist_cond);
+
+        // leave a clean snapshot and an empty journal behind
+        ret = _journal_compact();
+
+        close(_journal_fd);
+        _journal_fd = -1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file control_logic_persist.h
+ * @brief Modbus 表持久化介面頭文件
+ *
+ * 本文件定義 Modbus 表寫入的延遲持久化介面。
+ * 主要功能包括：
+ * - 啟動時重播日誌(journal)還原最後寫入
+ * - 將寫入記錄追加到帶 CRC 的日誌
+ * - 定期將日誌壓縮回完整快照
+ */
+
+#ifndef CONTROL_LOGIC_PERSIST_H
+#define CONTROL_LOGIC_PERSIST_H
+
+#include <stdint.h>
+
+/**
+ * @brief 初始化持久化模組
+ *
+ * 重播日誌中的有效記錄到 Modbus 表,並建立持久化執行緒。
+ * 必須在 modbus_manager_init() 載入快照之後呼叫。
+ *
+ * @return 成功返回 0，失敗返回負值錯誤碼
+ */
+int control_logic_persist_init(void);
+
+/**
+ * @brief 結束持久化模組
+ *
+ * 停止持久化執行緒,並將尚未寫入的記錄壓縮到快照中。
+ *
+ * @return 成功返回 0，失敗返回負值錯誤碼
+ */
+int control_logic_persist_deinit(void);
+
+/**
+ * @brief 記錄一筆 Modbus 表寫入
+ *
+ * 只將記錄放入待寫佇列後立即返回,實際寫入由持久化執行緒批次完成。
+ *
+ * @param address Modbus 表格位址
+ * @param type 資料類型
+ * @param value 寫入的值
+ * @return 成功返回 0，失敗返回負值錯誤碼
+ */
+int control_logic_persist_record(uint16_t address, uint8_t type, uint32_t value);
+
+/**
+ * @brief 取得持久化統計
+ *
+ * @param fsync_count 日誌 fsync 次數
+ * @param compact_count 快照壓縮次數
+ * @param overflow_count 佇列已滿、改由完整快照涵蓋的記錄數
+ */
+void control_logic_persist_stats_get(uint32_t *fsync_count, uint32_t *compact_count, uint32_t *overflow_count);
+
+#endif /* CONTROL_LOGIC_PERSIST_H */
@@ -0,0 +1,439 @@
+/**
+ * @file control_logic_poll_plan.c
+ * @brief 週邊輪詢排程實現
+ *
+ * 本文件實現依訊號類別與數值變化率調整的輪詢排程。
+ *
+ * 排程方式:
+ * - 每個排程槽(HID 埠 / RS485)的每個類別一個工作,週期從類別基本週期開始
+ * - 每次完成時以數值變化率調整週期,範圍為基本週期的 1/4 到 4 倍
+ * - 所有啟用工作每秒的 HID 交易數 sum(cost * 1000 / period) 超過預算時,
+ *   所有週期等比例拉長到剛好符合預算,相對快慢不變
+ * - 週期只約束計畫的交易數;剛縮短週期的工作仍在舊相位上,可能與其他工作擠在一起,
+ *   因此派發時再以權杖桶(每秒補充預算個權杖,餘額上限 0)把關:
+ *   餘額為負時不派發,派發時扣除預估交易數,完成時以實際交易數修正
+ * - 預算用完而被拒絕的槽依最早到期時間輪流取得權杖,先呼叫的槽不會獨佔匯流排
+ * - 同一槽內同時到期的工作依週期由短到長執行(rate-monotonic 優先順序)
+ *
+ * 並行模型:
+ * - 各埠輪詢執行緒與 RS485 執行緒共用一把鎖,每次呼叫只做少量計算
+ */
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "kenmec/main_application/kenmec_config.h"
+#include "kenmec/main_application/control_logic/control_logic_poll_plan.h"
+
+/*---------------------------------------------------------------------------
+                            Defined Constants
+ ---------------------------------------------------------------------------*/
+/* 週期調整範圍(相對基本週期) */
+#define POLL_PLAN_SPEEDUP_MAX (4)
+#define POLL_PLAN_SLOWDOWN_MAX (4)
+
+/* 交易數移動平均的權重(新值佔 1/4) */
+#define POLL_PLAN_COST_WEIGHT (0.25f)
+
+/*---------------------------------------------------------------------------
+                            Type Definitions
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief 類別參數
+ */
+typedef struct {
+    const char *name;
+    uint32_t base_ms;       /* 基本週期 */
+    float threshold;        /* 變化率門檻(類別單位/秒),0 表示不依變化率調整 */
+} poll_plan_class_t;
+
+/**
+ * @brief 輪詢工作
+ */
+typedef struct {
+    control_logic_poll_task_status_t status;
+    uint8_t busy;                               /* 已由 next 回傳,等待 done */
+    float charged;                              /* 派發時從權杖桶扣除的權杖 */
+    uint8_t value_count;                        /* 上次數值數量,0 表示沒有 */
+    float values[CONTROL_LOGIC_POLL_VALUES_MAX];
+} poll_plan_task_t;
+
+/*---------------------------------------------------------------------------
+                                Variables
+ ---------------------------------------------------------------------------*/
+static const poll_plan_class_t _poll_plan_classes[CONTROL_LOGIC_POLL_CLASS_NUM] = {
+    [CONTROL_LOGIC_POLL_DI]         = { "di",           CONFIG_CONTROL_LOGIC_POLL_DI_MS,            0.5f },     /* 狀態切換/秒 */
+    [CONTROL_LOGIC_POLL_DO]         = { "do",           CONFIG_CONTROL_LOGIC_POLL_DO_MS,            0.5f },     /* 狀態切換/秒 */
+    [CONTROL_LOGIC_POLL_AI_VOLTAGE] = { "ai_voltage",   CONFIG_CONTROL_LOGIC_POLL_AI_VOLTAGE_MS,    100.0f },   /* mV/秒 */
+    [CONTROL_LOGIC_POLL_AI_CURRENT] = { "ai_current",   CONFIG_CONTROL_LOGIC_POLL_AI_CURRENT_MS,    200.0f },   /* uA/秒 */
+    [CONTROL_LOGIC_POLL_PT100]      = { "pt100",        CONFIG_CONTROL_LOGIC_POLL_PT100_MS,         5.0f },     /* 0.1°C/秒 */
+    [CONTROL_LOGIC_POLL_PWM_FREQ]   = { "pwm_freq",     CONFIG_CONTROL_LOGIC_POLL_PWM_FREQ_MS,      5.0f },     /* Hz/秒 */
+    [CONTROL_LOGIC_POLL_RS485]      = { "rs485",        CONFIG_CONTROL_LOGIC_POLL_RS485_MS,         0.0f },
+};
+
+static pthread_mutex_t _poll_plan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static poll_plan_task_t _poll_plan_tasks[CONTROL_LOGIC_POLL_SLOT_NUM][CONTROL_LOGIC_POLL_CLASS_NUM];
+
+static uint32_t _poll_plan_budget = CONFIG_CONTROL_LOGIC_POLL_BUS_BUDGET;
+
+/* 套用預算後的每秒交易數 */
+static float _poll_plan_demand = 0.0f;
+
+/* 權杖桶餘額(1/1000 交易,整數交易數的補充與扣除沒有誤差,不大於 0)與最後補充時間 */
+static float _poll_plan_tokens = 0.0f;
+static uint64_t _poll_plan_tokens_ms = 0;
+
+/* 因預算用完被拒絕的排程槽的等待序號(依拒絕先後遞增),0 表示沒有等待 */
+static uint64_t _poll_plan_waiting[CONTROL_LOGIC_POLL_SLOT_NUM];
+static uint64_t _poll_plan_waiting_seq = 0;
+
+/*---------------------------------------------------------------------------
+                                 Implementation
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief 依預算重新計算所有工作的實際週期
+ *
+ * 呼叫前須持有排程鎖
+ */
+static void _poll_plan_rebalance(void)
+{
+    float demand = 0.0f;
+
+    for (int s = 0; s < CONTROL_LOGIC_POLL_SLOT_NUM; s++) {
+        for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+            const control_logic_poll_task_status_t *status = &_poll_plan_tasks[s][c].status;
+            if (status->enabled) {
+                demand += status->cost * 1000.0f / (float)status->period_ms;
+            }
+        }
+    }
+
+    float scale = (demand > (float)_poll_plan_budget) ? demand / (float)_poll_plan_budget : 1.0f;
+
+    for (int s = 0; s < CONTROL_LOGIC_POLL_SLOT_NUM; s++) {
+        for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+            control_logic_poll_task_status_t *status = &_poll_plan_tasks[s][c].status;
+            if (!status->enabled) {
+                continue;
+            }
+            status->effective_ms = (uint32_t)ceilf((float)status->period_ms * scale);
+            /* 週期變短時提前下一次 */
+            if (status->polls > 0 && status->next_ms > status->last_ms + status->effective_ms) {
+                status->next_ms = status->last_ms + status->effective_ms;
+            }
+        }
+    }
+
+    _poll_plan_demand = demand / scale;
+}
+
+/**
+ * @brief 依經過時間補充權杖
+ *
+ * 呼叫前須持有排程鎖
+ */
+static void _poll_plan_tokens_refill(uint64_t now_ms)
+{
+    if (now_ms > _poll_plan_tokens_ms) {
+        _poll_plan_tokens += (float)(now_ms - _poll_plan_tokens_ms) * (float)_poll_plan_budget;
+        if (_poll_plan_tokens > 0.0f) {
+            _poll_plan_tokens = 0.0f;
+        }
+        _poll_plan_tokens_ms = now_ms;
+    }
+}
+
+/**
+ * @brief 排程槽最早到期、尚未派發的工作的到期時間
+ *
+ * 呼叫前須持有排程鎖
+ *
+ * @return 到期時間,沒有到期工作返回 UINT64_MAX
+ */
+static uint64_t _poll_plan_slot_due_ms(int slot, uint64_t now_ms)
+{
+    uint64_t due_ms = UINT64_MAX;
+
+    for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+        const poll_plan_task_t *task = &_poll_plan_tasks[slot][c];
+        if (task->status.enabled && !task->busy && task->status.next_ms <= now_ms && task->status.next_ms < due_ms) {
+            due_ms = task->status.next_ms;
+        }
+    }
+
+    return due_ms;
+}
+
+/**
+ * @brief 是否有其他等待中的排程槽應先取得權杖
+ *
+ * 到期早的優先,同時到期時先被拒絕的優先
+ *
+ * 呼叫前須持有排程鎖
+ */
+static BOOL _poll_plan_slot_behind(int slot, uint64_t due_ms, uint64_t now_ms)
+{
+    uint64_t seq = _poll_plan_waiting[slot] ? _poll_plan_waiting[slot] : UINT64_MAX;
+
+    for (int s = 0; s < CONTROL_LOGIC_POLL_SLOT_NUM; s++) {
+        if (s == slot || !_poll_plan_waiting[s]) {
+            continue;
+        }
+        uint64_t other_ms = _poll_plan_slot_due_ms(s, now_ms);
+        if (other_ms < due_ms || (other_ms == due_ms && _poll_plan_waiting[s] < seq)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief 依變化率調整週期
+ *
+ * @return 週期是否改變
+ */
+static BOOL _poll_plan_adapt(poll_plan_task_t *task, const poll_plan_class_t *cls, uint64_t now_ms,
+                             const float *values, int count)
+{
+    control_logic_poll_task_status_t *status = &task->status;
+    uint32_t period_ms = status->period_ms;
+
+    if (cls->threshold > 0.0f && task->value_count == count && now_ms > status->last_ms) {
+        float delta = 0.0f;
+        for (int i = 0; i < count; i++) {
+            float d = fabsf(values[i] - task->values[i]);
+            if (d > delta) {
+                delta = d;
+            }
+        }
+        status->rate = delta * 1000.0f / (float)(now_ms - status->last_ms);
+
+        uint32_t min_ms = cls->base_ms / POLL_PLAN_SPEEDUP_MAX;
+        uint32_t max_ms = cls->base_ms * POLL_PLAN_SLOWDOWN_MAX;
+
+        if (status->rate > cls->threshold) {
+            period_ms = (period_ms / 2 > min_ms) ? period_ms / 2 : min_ms;
+        } else if (status->rate < cls->threshold / 4) {
+            period_ms = (period_ms + period_ms / 4 < max_ms) ? period_ms + period_ms / 4 : max_ms;
+        }
+    }
+
+    memcpy(task->values, values, sizeof(float) * count);
+    task->value_count = (uint8_t)count;
+
+    if (period_ms != status->period_ms) {
+        status->period_ms = period_ms;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+int control_logic_poll_plan_reset(uint32_t budget)
+{
+    if (budget == 0) {
+        return FAIL;
+    }
+
+    pthread_mutex_lock(&_poll_plan_lock);
+    memset(_poll_plan_tasks, 0, sizeof(_poll_plan_tasks));
+    _poll_plan_budget = budget;
+    _poll_plan_demand = 0.0f;
+    _poll_plan_tokens = 0.0f;
+    _poll_plan_tokens_ms = 0;
+    memset(_poll_plan_waiting, 0, sizeof(_poll_plan_waiting));
+    _poll_plan_waiting_seq = 0;
+    pthread_mutex_unlock(&_poll_plan_lock);
+
+    return SUCCESS;
+}
+
+int control_logic_poll_plan_slot_set(int slot, uint32_t class_mask, uint64_t now_ms)
+{
+    if (slot < 0 || slot >= CONTROL_LOGIC_POLL_SLOT_NUM) {
+        return FAIL;
+    }
+
+    pthread_mutex_lock(&_poll_plan_lock);
+
+    for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+        poll_plan_task_t *task = &_poll_plan_tasks[slot][c];
+        BOOL enable = (class_mask & (1u << c)) ? TRUE : FALSE;
+
+        if (enable && !task->status.enabled) {
+            memset(task, 0, sizeof(*task));
+            task->status.enabled = 1;
+            task->status.base_ms = _poll_plan_classes[c].base_ms;
+            task->status.period_ms = _poll_plan_classes[c].base_ms;
+            task->status.effective_ms = _poll_plan_classes[c].base_ms;
+            task->status.cost = 1.0f;
+            task->status.next_ms = now_ms;
+        } else if (!enable) {
+            task->status.enabled = 0;
+        }
+    }
+    _poll_plan_waiting[slot] = 0;
+
+    _poll_plan_rebalance();
+
+    pthread_mutex_unlock(&_poll_plan_lock);
+
+    return SUCCESS;
+}
+
+int control_logic_poll_plan_next(int slot, uint64_t now_ms, control_logic_poll_class_t *poll_class)
+{
+    int ret = FAIL;
+
+    if (slot < 0 || slot >= CONTROL_LOGIC_POLL_SLOT_NUM || poll_class == NULL) {
+        return FAIL;
+    }
+
+    pthread_mutex_lock(&_poll_plan_lock);
+
+    /* 預算已用完,或讓更早到期的等待槽先取得權杖 */
+    uint64_t due_ms = _poll_plan_slot_due_ms(slot, now_ms);
+    _poll_plan_tokens_refill(now_ms);
+    if (due_ms == UINT64_MAX || _poll_plan_tokens < 0.0f || _poll_plan_slot_behind(slot, due_ms, now_ms)) {
+        if (due_ms == UINT64_MAX) {
+            _poll_plan_waiting[slot] = 0;
+        } else if (!_poll_plan_waiting[slot]) {
+            _poll_plan_waiting[slot] = ++_poll_plan_waiting_seq;
+        }
+        pthread_mutex_unlock(&_poll_plan_lock);
+        return FAIL;
+    }
+
+    uint32_t best_ms = UINT32_MAX;
+    for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+        poll_plan_task_t *task = &_poll_plan_tasks[slot][c];
+        if (task->status.enabled && !task->busy && task->status.next_ms <= now_ms &&
+            task->status.effective_ms < best_ms) {
+            best_ms = task->status.effective_ms;
+            *poll_class = (control_logic_poll_class_t)c;
+            ret = SUCCESS;
+        }
+    }
+
+    if (ret == SUCCESS) {
+        poll_plan_task_t *task = &_poll_plan_tasks[slot][*poll_class];
+        task->busy = 1;
+        task->charged = task->status.cost * 1000.0f;
+        _poll_plan_tokens -= task->charged;
+        _poll_plan_waiting[slot] = 0;
+    }
+
+    pthread_mutex_unlock(&_poll_plan_lock);
+
+    return ret;
+}
+
+void control_logic_poll_plan_done(int slot, control_logic_poll_class_t poll_class, uint64_t now_ms,
+                                  const float *values, int count, float cost)
+{
+    if (slot < 0 || slot >= CONTROL_LOGIC_POLL_SLOT_NUM || (unsigned)poll_class >= CONTROL_LOGIC_POLL_CLASS_NUM) {
+        return;
+    }
+
+    if (count > CONTROL_LOGIC_POLL_VALUES_MAX) {
+        count = CONTROL_LOGIC_POLL_VALUES_MAX;
+    }
+
+    pthread_mutex_lock(&_poll_plan_lock);
+
+    poll_plan_task_t *task = &_poll_plan_tasks[slot][poll_class];
+    control_logic_poll_task_status_t *status = &task->status;
+    BOOL changed = FALSE;
+
+    if (task->busy) {
+        _poll_plan_tokens -= cost * 1000.0f - task->charged;
+        task->busy = 0;
+    }
+
+    if (status->enabled) {
+        float old_cost = status->cost;
+        status->cost += (cost - status->cost) * POLL_PLAN_COST_WEIGHT;
+        if (fabsf(status->cost - old_cost) > 0.05f * old_cost) {
+            changed = TRUE;
+        }
+
+        if (values != NULL && count > 0) {
+            changed |= _poll_plan_adapt(task, &_poll_plan_classes[poll_class], now_ms, values, count);
+        }
+
+        /* 保持節拍;落後超過一個週期時從現在重新起算 */
+        status->next_ms += status->effective_ms;
+        if (status->next_ms < now_ms) {
+            status->next_ms = now_ms + status->effective_ms;
+        }
+        status->last_ms = now_ms;
+        status->polls++;
+
+        if (changed) {
+            _poll_plan_rebalance();
+        }
+    }
+
+    pthread_mutex_unlock(&_poll_plan_lock);
+}
+
+uint64_t control_logic_poll_plan_wakeup_ms(int slot)
+{
+    uint64_t wakeup_ms = UINT64_MAX;
+
+    if (slot < 0 || slot >= CONTROL_LOGIC_POLL_SLOT_NUM) {
+        return wakeup_ms;
+    }
+
+    pthread_mutex_lock(&_poll_plan_lock);
+    for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+        const control_logic_poll_task_status_t *status = &_poll_plan_tasks[slot][c].status;
+        if (status->enabled && status->next_ms < wakeup_ms) {
+            wakeup_ms = status->next_ms;
+        }
+    }
+    /* 權杖桶餘額為負時,等到補回 0 才可派發 */
+    if (wakeup_ms != UINT64_MAX && _poll_plan_tokens < 0.0f) {
+        uint64_t ready_ms = _poll_plan_tokens_ms + (uint64_t)ceilf(-_poll_plan_tokens / (float)_poll_plan_budget);
+        if (ready_ms > wakeup_ms) {
+            wakeup_ms = ready_ms;
+        }
+    }
+    pthread_mutex_unlock(&_poll_plan_lock);
+
+    return wakeup_ms;
+}
+
+int control_logic_poll_plan_status_get(int slot, control_logic_poll_class_t poll_class,
+                                       control_logic_poll_task_status_t *status)
+{
+    if (slot < 0 || slot >= CONTROL_LOGIC_POLL_SLOT_NUM || (unsigned)poll_class >= CONTROL_LOGIC_POLL_CLASS_NUM ||
+        status == NULL) {
+        return FAIL;
+    }
+
+    pthread_mutex_lock(&_poll_plan_lock);
+    *status = _poll_plan_tasks[slot][poll_class].status;
+    pthread_mutex_unlock(&_poll_plan_lock);
+
+    return SUCCESS;
+}
+
+float control_logic_poll_plan_demand(void)
+{
+    pthread_mutex_lock(&_poll_plan_lock);
+    float demand = _poll_plan_demand;
+    pthread_mutex_unlock(&_poll_plan_lock);
+
+    return demand;
+}
+
+const char *control_logic_poll_plan_class_name(control_logic_poll_class_t poll_class)
+{
+    if ((unsigned)poll_class >= CONTROL_LOGIC_POLL_CLASS_NUM) {
+        return NULL;
+    }
+
+    return _poll_plan_classes[poll_class].name;
+}
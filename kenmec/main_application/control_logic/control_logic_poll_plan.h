@@ -0,0 +1,149 @@
+/**
+ * @file control_logic_poll_plan.h
+ * @brief 週邊輪詢排程介面頭文件
+ *
+ * 本文件定義依訊號類別調整輪詢週期的排程器介面。
+ * 主要功能包括：
+ * - 每個 HID 埠(與 RS485 更新執行緒)的每個訊號類別一個輪詢工作,各有基本週期
+ * - 數值變化率超過門檻時縮短週期,穩定時逐步放長
+ * - 所有工作的 HID 交易量超過每秒預算時等比例拉長週期
+ * - 派發時以權杖桶確保實際交易量不超過預算
+ * - 同時到期的工作依週期由短到長執行(rate-monotonic)
+ *
+ * 排程器只計算時間,不做任何 HID 存取;時間由呼叫端傳入,可直接以模擬時間測試。
+ */
+
+#ifndef CONTROL_LOGIC_POLL_PLAN_H
+#define CONTROL_LOGIC_POLL_PLAN_H
+
+#include <stdint.h>
+
+#include "dexatek/main_application/managers/hid_manager/hid_manager.h"
+
+/* 排程槽數量: 每個 HID 埠一個,另加 RS485 更新執行緒一個 */
+#define CONTROL_LOGIC_POLL_SLOT_NUM (HID_DEVICES_MAX + 1)
+
+/* RS485 更新執行緒使用的排程槽 */
+#define CONTROL_LOGIC_POLL_RS485_SLOT (HID_DEVICES_MAX)
+
+/* 每次回報的數值數量上限 */
+#define CONTROL_LOGIC_POLL_VALUES_MAX (8)
+
+/**
+ * @brief 訊號類別
+ */
+typedef enum {
+    CONTROL_LOGIC_POLL_DI = 0,          /* 數位輸入 */
+    CONTROL_LOGIC_POLL_DO,              /* 數位輸出回讀 */
+    CONTROL_LOGIC_POLL_AI_VOLTAGE,      /* 類比電壓輸入(含模式快取) */
+    CONTROL_LOGIC_POLL_AI_CURRENT,      /* 類比電流輸入(壓力、流量) */
+    CONTROL_LOGIC_POLL_PT100,           /* RTD 溫度 */
+    CONTROL_LOGIC_POLL_PWM_FREQ,        /* PWM 頻率(轉速) */
+    CONTROL_LOGIC_POLL_RS485,           /* 外部 Modbus 設備 */
+    CONTROL_LOGIC_POLL_CLASS_NUM
+} control_logic_poll_class_t;
+
+/**
+ * @brief 輪詢工作狀態
+ */
+typedef struct {
+    uint8_t enabled;        /* 是否啟用 */
+    uint32_t base_ms;       /* 基本週期 */
+    uint32_t period_ms;     /* 依變化率調整後的週期 */
+    uint32_t effective_ms;  /* 套用匯流排預算後實際使用的週期 */
+    uint32_t polls;         /* 完成次數 */
+    float cost;             /* 每次輪詢的 HID 交易數(移動平均) */
+    float rate;             /* 最後一次量到的變化率(類別單位/秒) */
+    uint64_t last_ms;       /* 最後一次完成時間 */
+    uint64_t next_ms;       /* 下一次到期時間 */
+} control_logic_poll_task_status_t;
+
+/**
+ * @brief 清除所有工作並設定匯流排預算
+ *
+ * 未呼叫時預算為 CONFIG_CONTROL_LOGIC_POLL_BUS_BUDGET。
+ *
+ * @param budget 每秒 HID 交易數上限
+ * @return 成功返回 0,預算為 0 返回 FAIL
+ */
+int control_logic_poll_plan_reset(uint32_t budget);
+
+/**
+ * @brief 設定排程槽啟用的訊號類別
+ *
+ * 新啟用的類別從基本週期開始並立即到期;停用的類別不再計入預算。
+ *
+ * @param slot 排程槽(HID 埠或 CONTROL_LOGIC_POLL_RS485_SLOT)
+ * @param class_mask 啟用的類別(bit = control_logic_poll_class_t)
+ * @param now_ms 目前時間
+ * @return 成功返回 0,參數錯誤返回 FAIL
+ */
+int control_logic_poll_plan_slot_set(int slot, uint32_t class_mask, uint64_t now_ms);
+
+/**
+ * @brief 取得下一個到期的工作
+ *
+ * 同時到期時先回傳週期較短的類別。回傳的工作在 done 之前不會再被回傳。
+ * 所有排程槽共用的匯流排預算已用完時,即使有到期工作也返回 FAIL;
+ * 預算補回後,被拒絕的排程槽依到期先後取得派發。
+ *
+ * @param slot 排程槽
+ * @param now_ms 目前時間
+ * @param poll_class 輸出到期的類別
+ * @return 有到期工作返回 0,沒有返回 FAIL
+ */
+int control_logic_poll_plan_next(int slot, uint64_t now_ms, control_logic_poll_class_t *poll_class);
+
+/**
+ * @brief 回報一次輪詢結果並排定下一次
+ *
+ * 以本次與上次數值的最大變化率調整週期:超過類別門檻時減半(不低於基本週期的 1/4),
+ * 低於門檻的 1/4 時增加 1/4(不高於基本週期的 4 倍)。
+ *
+ * @param slot 排程槽
+ * @param poll_class 類別
+ * @param now_ms 完成時間
+ * @param values 本次讀到的數值,NULL 表示讀取失敗或不調整週期
+ * @param count 數值數量(最多 CONTROL_LOGIC_POLL_VALUES_MAX)
+ * @param cost 本次用掉的 HID 交易數
+ */
+void control_logic_poll_plan_done(int slot, control_logic_poll_class_t poll_class, uint64_t now_ms,
+                                  const float *values, int count, float cost);
+
+/**
+ * @brief 排程槽最早的到期時間
+ *
+ * 匯流排預算已用完時為預算補回、可以派發的時間。
+ *
+ * @param slot 排程槽
+ * @return 到期時間,沒有啟用的工作返回 UINT64_MAX
+ */
+uint64_t control_logic_poll_plan_wakeup_ms(int slot);
+
+/**
+ * @brief 取得工作狀態
+ *
+ * @param slot 排程槽
+ * @param poll_class 類別
+ * @param status 輸出工作狀態
+ * @return 成功返回 0,參數錯誤返回 FAIL
+ */
+int control_logic_poll_plan_status_get(int slot, control_logic_poll_class_t poll_class,
+                                       control_logic_poll_task_status_t *status);
+
+/**
+ * @brief 目前排程每秒需要的 HID 交易數(已套用預算)
+ *
+ * @return 每秒交易數
+ */
+float control_logic_poll_plan_demand(void);
+
+/**
+ * @brief 類別名稱
+ *
+ * @param poll_class 類別
+ * @return 名稱,無效類別返回 NULL
+ */
+const char *control_logic_poll_plan_class_name(control_logic_poll_class_t poll_class);
+
+#endif /* CONTROL_LOGIC_POLL_PLAN_H */
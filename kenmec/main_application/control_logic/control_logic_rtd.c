@@ -0,0 +1,170 @@
+/**
+ * @file control_logic_rtd.c
+ * @brief RTD 電阻溫度轉換實現
+ *
+ * 本文件實現 PT100/PT1000 電阻轉溫度的查表轉換。
+ *
+ * 轉換方式:
+ * - 第一次使用時以 Callendar-Van Dusen 方程式(IEC 60751 係數)在 R/R0 上等距取點建表
+ * - 轉換時只做一次乘法找段、一次乘加內插,不需開根號或迭代
+ * - 分段線性誤差上限為 h^2/8 * max|T''|,256 段約 0.0012 °C,128 段約 0.005 °C,
+ *   因此段數少於 128 時編譯失敗
+ * - 表在 R/R0 上單調遞增,轉換結果隨電阻單調遞增
+ */
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include <math.h>
+
+#include "kenmec/main_application/kenmec_config.h"
+#include "kenmec/main_application/control_logic/control_logic_rtd.h"
+
+/*---------------------------------------------------------------------------
+                            Defined Constants
+ ---------------------------------------------------------------------------*/
+#if CONFIG_CONTROL_LOGIC_RTD_TABLE_SEGMENTS < 128
+#error "CONFIG_CONTROL_LOGIC_RTD_TABLE_SEGMENTS below 128 does not keep the 0.01 C error bound"
+#endif
+
+#define RTD_TABLE_SEGMENTS (CONFIG_CONTROL_LOGIC_RTD_TABLE_SEGMENTS)
+
+/* IEC 60751 Callendar-Van Dusen 係數 */
+#define RTD_CVD_A (3.9083e-3)
+#define RTD_CVD_B (-5.775e-7)
+#define RTD_CVD_C (-4.183e-12)
+
+/*---------------------------------------------------------------------------
+                            Type Definitions
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief 表段:段起點溫度與每單位索引的溫度增量
+ */
+typedef struct {
+    float temp;
+    float slope;
+} rtd_segment_t;
+
+/*---------------------------------------------------------------------------
+                                Variables
+ ---------------------------------------------------------------------------*/
+static pthread_once_t _rtd_table_once = PTHREAD_ONCE_INIT;
+
+static rtd_segment_t _rtd_table[RTD_TABLE_SEGMENTS];
+
+/* 表起點的 R/R0 與每段寬度的倒數 */
+static float _rtd_ratio_min = 0.0f;
+static float _rtd_index_scale = 0.0f;
+
+/*---------------------------------------------------------------------------
+                                 Implementation
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief 溫度轉電阻比(Callendar-Van Dusen)
+ */
+static double _rtd_cvd_ratio(double temp)
+{
+    double ratio = 1.0 + RTD_CVD_A * temp + RTD_CVD_B * temp * temp;
+
+    if (temp < 0.0) {
+        ratio += RTD_CVD_C * (temp - 100.0) * temp * temp * temp;
+    }
+
+    return ratio;
+}
+
+double control_logic_rtd_cvd_temperature(double ratio)
+{
+    /* T >= 0: R/R0 = 1 + A*T + B*T^2 */
+    if (ratio >= 1.0) {
+        return (-RTD_CVD_A + sqrt(RTD_CVD_A * RTD_CVD_A - 4.0 * RTD_CVD_B * (1.0 - ratio))) / (2.0 * RTD_CVD_B);
+    }
+
+    /* T < 0: 加上 C*(T-100)*T^3 項,從線性近似開始以牛頓法求解 */
+    double temp = (ratio - 1.0) / RTD_CVD_A;
+    for (int i = 0; i < 20; i++) {
+        double error = _rtd_cvd_ratio(temp) - ratio;
+        double slope = RTD_CVD_A + 2.0 * RTD_CVD_B * temp + RTD_CVD_C * (4.0 * temp * temp * temp - 300.0 * temp * temp);
+        double step = error / slope;
+        temp -= step;
+        if (fabs(step) < 1e-9) {
+            break;
+        }
+    }
+
+    return temp;
+}
+
+/**
+ * @brief 建立查表
+ */
+static void _rtd_table_build(void)
+{
+    double ratio_min = _rtd_cvd_ratio(CONTROL_LOGIC_RTD_TEMP_MIN);
+    double ratio_max = _rtd_cvd_ratio(CONTROL_LOGIC_RTD_TEMP_MAX);
+    double width = (ratio_max - ratio_min) / RTD_TABLE_SEGMENTS;
+    double temp = CONTROL_LOGIC_RTD_TEMP_MIN;
+
+    for (int i = 0; i < RTD_TABLE_SEGMENTS; i++) {
+        double next = control_logic_rtd_cvd_temperature(ratio_min + (i + 1) * width);
+        _rtd_table[i].temp = (float)temp;
+        _rtd_table[i].slope = (float)(next - temp);
+        temp = next;
+    }
+
+    _rtd_ratio_min = (float)ratio_min;
+    _rtd_index_scale = (float)(1.0 / width);
+}
+
+/**
+ * @brief 電阻比轉溫度(查表,範圍外以端點線段外插)
+ */
+static inline float _rtd_table_lookup(float ratio)
+{
+    float position = (ratio - _rtd_ratio_min) * _rtd_index_scale;
+    int index = (int)position;
+
+    if (position < 0.0f) {
+        index = 0;
+    } else if (index >= RTD_TABLE_SEGMENTS) {
+        index = RTD_TABLE_SEGMENTS - 1;
+    }
+
+    return _rtd_table[index].temp + (position - (float)index) * _rtd_table[index].slope;
+}
+
+float control_logic_rtd_temperature(uint32_t resistance, uint16_t base_resistance)
+{
+    if (resistance == 0 || base_resistance == 0) {
+        return 0.0f;
+    }
+
+    pthread_once(&_rtd_table_once, _rtd_table_build);
+
+    /* 0.01 Ω 轉 R/R0 */
+    return _rtd_table_lookup((float)resistance / (base_resistance * 100.0f));
+}
+
+void control_logic_rtd_temperature_batch(const uint32_t *resistance, const uint8_t *sensor_type, int count,
+                                         int32_t *temperature)
+{
+    /* 0.01 Ω 轉 R/R0 的倍率 */
+    const float pt100_scale = 1.0f / (100 * 100.0f);
+    const float pt1000_scale = 1.0f / (1000 * 100.0f);
+
+    pthread_once(&_rtd_table_once, _rtd_table_build);
+
+    for (int i = 0; i < count; i++) {
+        if (resistance[i] == 0) {
+            temperature[i] = 0;
+            continue;
+        }
+
+        float scale = pt100_scale;
+        if (sensor_type != NULL && sensor_type[i] == CONTROL_LOGIC_RTD_PT1000) {
+            scale = pt1000_scale;
+        }
+
+        /* 12.3 °C 轉 123 供 HMI 使用 */
+        temperature[i] = (int32_t)lroundf(_rtd_table_lookup((float)resistance[i] * scale) * 10.0f);
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * @file control_logic_rtd.h
+ * @brief RTD 電阻溫度轉換介面頭文件
+ *
+ * 本文件定義 PT100/PT1000 電阻轉溫度的查表介面。
+ * 主要功能包括:
+ * - 以 IEC 60751 Callendar-Van Dusen 方程式預先建立 -200..850 °C 的分段線性表
+ * - 表以 R/R0 為索引,PT100 與 PT1000 共用同一張表
+ * - 表範圍內誤差低於 0.01 °C(表段數由 CONFIG_CONTROL_LOGIC_RTD_TABLE_SEGMENTS 設定)
+ * - 一次轉換整塊 RTD 板所有通道的批次介面
+ */
+
+#ifndef CONTROL_LOGIC_RTD_H
+#define CONTROL_LOGIC_RTD_H
+
+#include <stdint.h>
+
+/* 查表範圍(°C),範圍外以端點線段外插 */
+#define CONTROL_LOGIC_RTD_TEMP_MIN (-200.0)
+#define CONTROL_LOGIC_RTD_TEMP_MAX (850.0)
+
+/**
+ * @brief 感測器類型(與 temperature_config_t.sensor_type 相同)
+ */
+typedef enum {
+    CONTROL_LOGIC_RTD_PT100 = 0,
+    CONTROL_LOGIC_RTD_PT1000 = 1,
+} control_logic_rtd_type_t;
+
+/**
+ * @brief 電阻轉溫度(查表)
+ *
+ * @param resistance 電阻值(0.01 Ω,即 AD7124 回傳的原始值)
+ * @param base_resistance 基準電阻 R0(Ω),100 為 PT100,1000 為 PT1000
+ * @return 溫度(°C),電阻為 0 時返回 0
+ */
+float control_logic_rtd_temperature(uint32_t resistance, uint16_t base_resistance);
+
+/**
+ * @brief 批次轉換一塊 RTD 板的所有通道
+ *
+ * @param resistance 各通道電阻值(0.01 Ω)
+ * @param sensor_type 各通道感測器類型(control_logic_rtd_type_t),NULL 表示全部為 PT100;未知類型視為 PT100
+ * @param count 通道數
+ * @param temperature 輸出各通道溫度(0.1 °C,例如 123 表示 12.3 °C),電阻為 0 時為 0
+ */
+void control_logic_rtd_temperature_batch(const uint32_t *resistance, const uint8_t *sensor_type, int count,
+                                         int32_t *temperature);
+
+/**
+ * @brief 以 Callendar-Van Dusen 方程式直接求解(不查表)
+ *
+ * 正溫度範圍解二次式,負溫度範圍以牛頓法求解四次式;用於建表與驗證。
+ *
+ * @param ratio 電阻比 R/R0
+ * @return 溫度(°C)
+ */
+double control_logic_rtd_cvd_temperature(double ratio);
+
+#endif /* CONTROL_LOGIC_RTD_H */
@@ -13,14 +13,21 @@
  *
  * 實現原理:
  * - 使用多個執行緒定期更新不同類型的硬體數據
- * - IO 板更新執行緒: 更新數位 I/O 和模擬 I/O
- * - RTD 板更新執行緒: 更新溫度和 PWM 數據
+ * - 每個 HID 埠一個輪詢執行緒,依插上的板子更新:
+ *   IO 板更新數位 I/O 和模擬 I/O,RTD 板更新溫度和 PWM 數據;
+ *   一個埠的板子變慢或逾時不影響其他埠的更新頻率
+ * - 各類別的輪詢週期由 control_logic_poll_plan 依變化率與 HID 匯流排預算決定
+ * - 每個埠完成一輪即遞增該埠的世代(control_logic_update_port_status_get)
+ * - 外部 Modbus 設備更新執行緒: 依配置讀取 RS485 設備
  * - RTC 更新執行緒: 更新系統時間
- * - 數據更新後存儲到 Modbus 寄存器表中
+ * - 數據更新後存儲到 Modbus 寄存器表中,同一塊板子一次讀到的各通道整批發布
+ * - 類比輸入與溫度原始值同時寫入歷史緩衝區(control_logic_history)
  * - 支援數據類型轉換(電流轉流量、電流轉壓力等)
  *
  * 更新週期:
- * - IO/RTD 板: CONFIG_APPLICATION_CONTROL_LOGIC_UPDATE_DELAY_MS
+ * - IO/RTD 板: 各類別 CONFIG_CONTROL_LOGIC_POLL_*_MS 起算,自動調整;
+ *   以 control_logic_update_port_period_set() 設定的埠改為固定週期
+ * - 外部 Modbus 設備: CONFIG_CONTROL_LOGIC_POLL_RS485_MS 起算,只受匯流排預算影響
  * - RTC: RTC_UPDATE_INTERVAL_MS (1000ms)
  *
  * @note 本文件是控制邏輯系統的數據採集層
@@ -33,8 +40,13 @@
 
 #include "kenmec/main_application/kenmec_config.h"
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/control_logic_persist.h"
+#include "kenmec/main_application/control_logic/control_logic_history.h"
+#include "kenmec/main_application/control_logic/control_logic_latency.h"
+#include "kenmec/main_application/control_logic/control_logic_poll_plan.h"
 
 #include <modbus.h>
+#include <sched.h>
 
 /*---------------------------------------------------------------------------
                             Defined Constants
@@ -48,14 +60,65 @@ static const char* tag = "control_logic_update";
 /* 控制邏輯更新調試開關 */
 #define CONTROL_LOGIC_UPDATE_DEBUG_ENABLE 0
 
+/* RS485 合併讀取: 單一 HID 封包可容納的最大暫存器數量 */
+#define RS485_BLOCK_READ_MAX_REGISTERS (28)
+
+/* RS485 合併讀取: 相鄰設備位址之間允許一併讀取的最大空隙(暫存器數量) */
+#define RS485_BLOCK_READ_MAX_GAP (4)
+
+/* Modbus 表 seqlock 分頁大小(暫存器數量) */
+#define MODBUS_TABLE_SEQLOCK_PAGE_SIZE (64)
+
+/* Modbus 表 seqlock 分頁數量 */
+#define MODBUS_TABLE_SEQLOCK_PAGE_NUM ((MODBUS_RO_REGISTERS + MODBUS_TABLE_SEQLOCK_PAGE_SIZE - 1) / MODBUS_TABLE_SEQLOCK_PAGE_SIZE)
+
+/* 一段連續暫存器(最多 CONTROL_LOGIC_MODBUS_RANGE_MAX 個)最多跨越的分頁數量 */
+#define MODBUS_TABLE_RANGE_PAGES_MAX ((CONTROL_LOGIC_MODBUS_RANGE_MAX + MODBUS_TABLE_SEQLOCK_PAGE_SIZE - 2) / MODBUS_TABLE_SEQLOCK_PAGE_SIZE + 1)
+
+/*---------------------------------------------------------------------------
+                            Type Definitions
+ ---------------------------------------------------------------------------*/
+/**
+ * @brief RS485 合併讀取項目
+ *
+ * 記錄一筆可讀取的 Modbus 設備配置及其所需的暫存器數量,用於排序與分組
+ */
+typedef struct {
+    const modbus_device_config_t *cfg;  /* 設備配置 */
+    int index;                          /* 設備配置索引(日誌用) */
+    uint8_t register_num;               /* 需讀取的暫存器數量 */
+} rs485_read_item_t;
+
+/**
+ * @brief HID 埠輪詢器
+ *
+ * 每個埠獨立的輪詢狀態,統計欄位以 relaxed 原子讀寫,
+ * generation 在一輪的數據寫入 Modbus 表之後以 release 遞增
+ */
+typedef struct {
+    uint16_t port;          /* HID 埠 */
+    uint16_t pid;           /* 最後一輪看到的板子 PID,0 表示沒有板子 */
+    uint32_t period_ms;     /* 固定輪詢週期;自適應排程時為偵測插拔的最長間隔 */
+    uint32_t generation;    /* 完成的輪數 */
+    uint32_t failures;      /* 有讀取失敗的輪數 */
+    uint32_t cycle_ms;      /* 最後一輪耗時 */
+    uint64_t update_ms;     /* 最後一輪完成時間 */
+    uint8_t fixed;          /* 已設定固定週期,不使用自適應排程 */
+    uint16_t plan_pid;      /* 排程器中該埠工作對應的 PID */
+    pthread_t thread;       /* 輪詢執行緒 */
+} port_poller_t;
+
 /*---------------------------------------------------------------------------
 								Variables
  ---------------------------------------------------------------------------*/
-/* IO 板更新執行緒句柄 */
-static pthread_t _update_io_thread_handle = NULL;
+/* 各 HID 埠的輪詢器 */
+static port_poller_t _port_pollers[HID_DEVICES_MAX];
+
+/* 外部 Modbus 設備(RS485)更新執行緒句柄 */
+static pthread_t _update_rs485_thread_handle = NULL;
 
-/* RTD 板更新執行緒句柄 */
-static pthread_t _update_rtd_thread_handle = NULL;
+/* 外部 Modbus 設備的 RS485 讀取次數(只由 RS485 更新執行緒遞增) */
+static uint32_t _modbus_devices_read_count = 0;
 
 // static pthread_t _update_rtc_thread_handle = NULL;
 
@@ -65,11 +128,25 @@ BOOL _bUpdate_rtc_enable = TRUE;
 /* 最後一次 RTC 更新時間戳 */
 static uint64_t _latest_update_rtc_ts = 0;
 
+/* Modbus 表各分頁的序號(奇數表示寫入中) */
+static uint32_t _modbus_table_seq[MODBUS_TABLE_SEQLOCK_PAGE_NUM];
+
+/* Modbus 表變更世代: 每次有暫存器數值改變即遞增 */
+static uint32_t _modbus_table_generation = 0;
+
+/* 各暫存器最後一次數值改變時的世代 */
+static uint32_t _modbus_table_register_gen[MODBUS_RO_REGISTERS];
+
+/* 各分頁內最新的變更世代,查詢變更時跳過沒有變更的分頁 */
+static uint32_t _modbus_table_page_gen[MODBUS_TABLE_SEQLOCK_PAGE_NUM];
+
 /*---------------------------------------------------------------------------
                              Function Prototypes
  ---------------------------------------------------------------------------*/
 int control_logic_modbus_manager_callback(uint16_t address, uint8_t type, uint32_t value);
 int control_logic_1_config_update(uint16_t address, uint8_t type, uint32_t value);
+static void _modbus_server_registers_read(const modbus_mapping_t *mb_mapping, int address, int nb, uint16_t *dest);
+static void _modbus_server_registers_write(modbus_mapping_t *mb_mapping, int address, int nb, const uint16_t *src);
 
 /*---------------------------------------------------------------------------
                                  Implementation
@@ -89,10 +166,12 @@ static int _peripheral_DI_update(uint16_t port)
         case 3:
             ret = control_hardware_digital_input_all_get(port, status);
             if (ret == SUCCESS) {
+                control_logic_modbus_write_t batch[8];
                 target_base_address = HID_BASE_ADDRESS + (port * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_GPIO_INPUT_0;
                 for (int i = 0; i < 8; i++) {
-                    control_logic_update_to_modbus_table(target_base_address + i, MODBUS_TYPE_UINT16, &status[i]);
+                    batch[i] = (control_logic_modbus_write_t){ .address = target_base_address + i, .type = MODBUS_TYPE_UINT16, .value.u16 = status[i] };
                 }
+                control_logic_update_to_modbus_table_batch(batch, 8);
             }
             break;
         default:
@@ -117,10 +196,12 @@ static int _peripheral_DO_update(uint16_t port)
         case 3:
             ret = control_hardware_digital_output_all_get(port, status);
             if (ret == SUCCESS) {
+                control_logic_modbus_write_t batch[8];
                 target_base_address = HID_BASE_ADDRESS + (port * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_GPIO_OUTPUT_0;
                 for (int i = 0; i < 8; i++) {
-                    control_logic_update_to_modbus_table(target_base_address + i, MODBUS_TYPE_UINT16, &status[i]);
+                    batch[i] = (control_logic_modbus_write_t){ .address = target_base_address + i, .type = MODBUS_TYPE_UINT16, .value.u16 = status[i] };
                 }
+                control_logic_update_to_modbus_table_batch(batch, 8);
             }
             break;
         default:
@@ -145,26 +226,36 @@ static int _peripheral_AI_voltage_update(uint16_t port)
         case 3:
             ret = control_hardware_analog_input_voltage_all_get(port, mV, 2000);
             if (ret == SUCCESS) {
+                uint64_t now_ms = time_get_current_ms();
 
                 // analog voltage input covert by sensor type
+                control_logic_config_read_lock();
                 int config_count = 0;
                 analog_config_t *ai_configs = control_logic_analog_input_voltage_configs_get(&config_count);
+                control_logic_modbus_write_t batch[CONTROL_LOGIC_MODBUS_BATCH_MAX];
+                uint16_t batch_count = 0;
 
                 for (int i = 0; i < 4; i++) {   
-                    control_logic_update_to_modbus_table(target_base_address + (i * 2), MODBUS_TYPE_UINT32, &mV[i]);
+                    batch[batch_count++] = (control_logic_modbus_write_t){ .address = target_base_address + (i * 2), .type = MODBUS_TYPE_UINT32, .value.i32 = mV[i] };
+                    control_logic_history_record(target_base_address + (i * 2), now_ms, (float)mV[i]);
 
                     // analog voltage input covert by sensor type
                     for (int j = 0; j < config_count; j++) {
                         if (ai_configs != NULL && ai_configs[j].port == port && ai_configs[j].channel == i) {
                             int32_t value = 0;
+                            if (batch_count >= CONTROL_LOGIC_MODBUS_BATCH_MAX - 4) {
+                                // more sensor configs than expected: publish what we have
+                                control_logic_update_to_modbus_table_batch(batch, batch_count);
+                                batch_count = 0;
+                            }
                             switch (ai_configs[j].sensor_type) {
                                 case 0: // TODO: support sensor type 0
                                     value = mV[i];
-                                    control_logic_update_to_modbus_table(ai_configs[j].update_address, MODBUS_TYPE_UINT16, &value);
+                                    batch[batch_count++] = (control_logic_modbus_write_t){ .address = ai_configs[j].update_address, .type = MODBUS_TYPE_UINT16, .value.u16 = (uint16_t)value };
                                     break;
                                 case 1: // TODO: support sensor type 1
                                     value = mV[i];
-                                    control_logic_update_to_modbus_table(ai_configs[j].update_address, MODBUS_TYPE_UINT16, &value);
+                                    batch[batch_count++] = (control_logic_modbus_write_t){ .address = ai_configs[j].update_address, .type = MODBUS_TYPE_UINT16, .value.u16 = (uint16_t)value };
                                     break;
                                 default:
                                     error(tag, "Not supported sensor type %d", ai_configs[j].sensor_type);
@@ -173,6 +264,8 @@ static int _peripheral_AI_voltage_update(uint16_t port)
                         }
                     }
                 }
+                control_logic_update_to_modbus_table_batch(batch, batch_count);
+                control_logic_config_read_unlock();
             } else {
                 error(tag, "control_hardware_analog_input_voltage_all_get[%d] failed", port);
             }
@@ -292,29 +385,39 @@ static int _peripheral_AI_current_update(uint16_t port)
         case 3:
             ret = control_hardware_analog_input_current_all_get(port, uA, 2000);
             if (ret == SUCCESS) {
+                uint64_t now_ms = time_get_current_ms();
                 // analog current input covert by sensor type
+                control_logic_config_read_lock();
                 int config_count = 0;
                 analog_config_t *ai_configs = control_logic_analog_input_current_configs_get(&config_count);
+                control_logic_modbus_write_t batch[CONTROL_LOGIC_MODBUS_BATCH_MAX];
+                uint16_t batch_count = 0;
 
                 // for each port
                 for (int i = 0; i < 4; i++) {
                     // update to modbus table
-                    control_logic_update_to_modbus_table(target_base_address + (i * 2), MODBUS_TYPE_UINT32, &uA[i]);
+                    batch[batch_count++] = (control_logic_modbus_write_t){ .address = target_base_address + (i * 2), .type = MODBUS_TYPE_UINT32, .value.i32 = uA[i] };
+                    control_logic_history_record(target_base_address + (i * 2), now_ms, (float)uA[i]);
                     
                     // analog current input covert by sensor type
                     for (int j = 0; j < config_count; j++) {
                         if (ai_configs != NULL && ai_configs[j].port == port && ai_configs[j].channel == i) {
                             int32_t value = 0;
+                            if (batch_count >= CONTROL_LOGIC_MODBUS_BATCH_MAX - 4) {
+                                // more sensor configs than expected: publish what we have
+                                control_logic_update_to_modbus_table_batch(batch, batch_count);
+                                batch_count = 0;
+                            }
                             switch (ai_configs[j].sensor_type) {
                                 case 0: // water flow sensor
                                     _current_to_water_flow(uA[i], &value);
                                     // debug(tag, "port %d, ch %d, flow = %d", port, i, value);
-                                    control_logic_update_to_modbus_table(ai_configs[j].update_address, MODBUS_TYPE_UINT16, &value);
+                                    batch[batch_count++] = (control_logic_modbus_write_t){ .address = ai_configs[j].update_address, .type = MODBUS_TYPE_UINT16, .value.u16 = (uint16_t)value };
                                     break;
                                 case 1: // pressure sensor
                                     _current_to_pressure(uA[i], &value);
                                     // debug(tag, "port %d, ch %d, pressure = %d", port, i, value);
-                                    control_logic_update_to_modbus_table(ai_configs[j].update_address, MODBUS_TYPE_UINT16, &value);
+                                    batch[batch_count++] = (control_logic_modbus_write_t){ .address = ai_configs[j].update_address, .type = MODBUS_TYPE_UINT16, .value.u16 = (uint16_t)value };
                                     break;
                                 default:
                                     error(tag, "Not supported sensor type %d", ai_configs[j].sensor_type);
@@ -323,6 +426,8 @@ static int _peripheral_AI_current_update(uint16_t port)
                         }
                     }
                 }
+                control_logic_update_to_modbus_table_batch(batch, batch_count);
+                control_logic_config_read_unlock();
             } else {
                 error(tag, "control_hardware_analog_input_current_all_get[%d] failed", port);
             }
@@ -347,13 +452,15 @@ static int _peripheral_AI_mode_update(uint16_t port)
         case 1:
         case 2:
         case 3:
-            ret = control_hardware_analog_mode_all_get(port, mode, 2000);
+            ret = control_hardware_analog_mode_all_get_cached(port, mode, CONFIG_CONTROL_LOGIC_AI_MODE_AUDIT_MS, 2000);
             if (ret == SUCCESS) {
+                control_logic_modbus_write_t batch[4];
                 for (int i = 0; i < 4; i++) {
-                    control_logic_update_to_modbus_table(target_base_address + i, MODBUS_TYPE_UINT16, &mode[i]);
+                    batch[i] = (control_logic_modbus_write_t){ .address = target_base_address + i, .type = MODBUS_TYPE_UINT16, .value.u16 = mode[i] };
                 }
+                control_logic_update_to_modbus_table_batch(batch, 4);
             } else {
-                error(tag, "control_hardware_analog_input_current_all_get[%d] failed", port);
+                error(tag, "control_hardware_analog_mode_all_get_cached[%d] failed", port);
             }
             break;
         default:
@@ -424,11 +531,13 @@ static int _peripheral_pwm_duty_update(uint16_t port)
         case 3:
             ret = control_hardware_pwm_duty_all_get(port, 2000, duty);
             if (ret == SUCCESS) {
+                control_logic_modbus_write_t batch[8];
                 for (int i = 0; i < 8; i++) {
                     target_address = HID_BASE_ADDRESS + (port * HID_RTD_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_CAPTURE_PWM_0_DUTY + i;
-                    control_logic_update_to_modbus_table(target_address, MODBUS_TYPE_UINT16, &duty[i]);
+                    batch[i] = (control_logic_modbus_write_t){ .address = target_address, .type = MODBUS_TYPE_UINT16, .value.u16 = duty[i] };
                     // debug(tag, "port[%d] pwm%d_duty = %d", port, i, duty[i]);
                 }
+                control_logic_update_to_modbus_table_batch(batch, 8);
             } else {
                 error(tag, "port[%d] control_hardware_pwm_duty_all_get failed", port);
             }
@@ -455,11 +564,13 @@ static int _peripheral_pwm_freq_update(uint16_t port)
         case 3:
             ret = control_hardware_pwm_freq_all_get(port, 2000, freq);
             if (ret == SUCCESS) {
+                control_logic_modbus_write_t batch[8];
                 for (int i = 0; i < 8; i++) {
                     target_address = HID_BASE_ADDRESS + (port * HID_RTD_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_CAPTURE_PWM_0_FREQ + (i*2);
-                    control_logic_update_to_modbus_table(target_address, MODBUS_TYPE_UINT32, &freq[i]);
+                    batch[i] = (control_logic_modbus_write_t){ .address = target_address, .type = MODBUS_TYPE_UINT32, .value.u32 = freq[i] };
                     // debug(tag, "port[%d] pwm%d_freq = %d", port, i, freq[i]);
                 }
+                control_logic_update_to_modbus_table_batch(batch, 8);
             } else {
                 error(tag, "port[%d] control_hardware_pwm_freq_all_get failed", port);
             }
@@ -486,11 +597,13 @@ static int _peripheral_pwm_period_update(uint16_t port)
         case 3:
             ret = control_hardware_pwm_period_all_get(port, period);
             if (ret == SUCCESS) {
+                control_logic_modbus_write_t batch[8];
                 for (int i = 0; i < 8; i++) {
                     target_address = HID_BASE_ADDRESS + (port * HID_RTD_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_CAPTURE_PWM_0_PERIOD + (i*2);
-                    control_logic_update_to_modbus_table(target_address, MODBUS_TYPE_UINT32, &period[i]);
+                    batch[i] = (control_logic_modbus_write_t){ .address = target_address, .type = MODBUS_TYPE_UINT32, .value.u32 = period[i] };
                     // debug(tag, "port[%d] pwm%d_period = %d", port, i, period[i]);
                 }
+                control_logic_update_to_modbus_table_batch(batch, 8);
             } else {
                 error(tag, "port[%d] control_hardware_pwm_period_all_get failed", port);
             }
@@ -517,11 +630,15 @@ static int _peripheral_temperature_update(uint16_t port)
         case 3:
             ret = control_hardware_temperature_all_get(port, 2000, temp);
             if (ret == SUCCESS) {
+                uint64_t now_ms = time_get_current_ms();
+                control_logic_modbus_write_t batch[8];
                 for (int i = 0; i < 8; i++) {
                     target_address = HID_BASE_ADDRESS + (port * HID_RTD_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_AD7124_CH_0_RESISTOR + (i*2);
-                    control_logic_update_to_modbus_table(target_address, MODBUS_TYPE_INT32, &temp[i]);
+                    batch[i] = (control_logic_modbus_write_t){ .address = target_address, .type = MODBUS_TYPE_INT32, .value.i32 = temp[i] };
+                    control_logic_history_record(target_address, now_ms, (float)temp[i]);
                     // debug(tag, "port[%d] temp %d = %d", port, i, temp);
                 }
+                control_logic_update_to_modbus_table_batch(batch, 8);
             } else {
                 error(tag, "port[%d] control_hardware_temperature_all_get failed", port);
             }
@@ -533,531 +650,1380 @@ static int _peripheral_temperature_update(uint16_t port)
     return ret;
 }
 
-static int _control_logic_io_boards_status_update(void)
+/**
+ * @brief 更新 IO 板數據
+ *
+ * @param port HID 埠
+ *
+ * @return int 執行結果,任一項讀取失敗返回 FAIL
+ */
+static int _port_io_board_update(uint16_t port)
 {
     int ret = SUCCESS;
-    
-    // for each HID devices (IO, RTD)
-    for (int port = 0; port < HID_DEVICES_MAX; port++) {
-        uint16_t pid = 0;
-
-        // get pid
-        hid_manager_port_pid_get(port, &pid);
-
-        // update peripheral data
-        switch (pid) {
-            case HID_IO_BOARD_PID:
-                // debug(tag, "port[%d] pid = 0x%x", port, pid);
-                _peripheral_DI_update(port);
-                _peripheral_DO_update(port);
-                _peripheral_AI_mode_update(port);
-                _peripheral_AI_voltage_update(port);
-                _peripheral_AI_current_update(port);
-                // _peripheral_usb_info_update(pid, port);
-                break;
 
-            default:
-                break;
-        }
-    }
+    if (_peripheral_DI_update(port) != SUCCESS) ret = FAIL;
+    if (_peripheral_DO_update(port) != SUCCESS) ret = FAIL;
+    if (_peripheral_AI_mode_update(port) != SUCCESS) ret = FAIL;
+    if (_peripheral_AI_voltage_update(port) != SUCCESS) ret = FAIL;
+    if (_peripheral_AI_current_update(port) != SUCCESS) ret = FAIL;
+    // _peripheral_usb_info_update(HID_IO_BOARD_PID, port);
 
     return ret;
 }
 
-static int _control_logic_rtd_boards_status_update(void)
+/**
+ * @brief 更新 RTD 板數據
+ *
+ * @param port HID 埠
+ *
+ * @return int 執行結果,任一項讀取失敗返回 FAIL
+ */
+static int _port_rtd_board_update(uint16_t port)
 {
     int ret = SUCCESS;
-    
-    // for each HID devices (IO, RTD)
-    for (int port = 0; port < HID_DEVICES_MAX; port++) {
-        uint16_t pid = 0;
-
-        // get pid
-        hid_manager_port_pid_get(port, &pid);
-
-        // update peripheral data
-        switch (pid) {
-            case HID_RTD_BOARD_PID:
-                // debug(tag, "port[%d] pid = 0x%x", i, pid);
-                // _peripheral_pwm_duty_update(port);
-                _peripheral_pwm_freq_update(port);
-                // _peripheral_pwm_period_update(port);
-                _peripheral_temperature_update(port);
-                // _peripheral_usb_info_update(pid, port);
-                break;
 
-            default:
-                break;
-        }
-    }
+    // _peripheral_pwm_duty_update(port);
+    if (_peripheral_pwm_freq_update(port) != SUCCESS) ret = FAIL;
+    // _peripheral_pwm_period_update(port);
+    if (_peripheral_temperature_update(port) != SUCCESS) ret = FAIL;
+    // _peripheral_usb_info_update(HID_RTD_BOARD_PID, port);
 
     return ret;
 }
 
-static int _control_logic_modbus_devices_update(void)
+/**
+ * @brief 取得資料類型所需的暫存器數量
+ *
+ * @param data_type Modbus 資料類型
+ *
+ * @return uint8_t 暫存器數量,不支援的類型返回 0
+ */
+static uint8_t _modbus_device_register_num(uint8_t data_type)
 {
-    int ret = SUCCESS;
-
-    int modbus_device_config_count = 0;
-    modbus_device_config_t *modbus_device_config = control_logic_modbus_device_configs_get(&modbus_device_config_count);
-
-    if (modbus_device_config == NULL) {
-        // error(tag, "modbus device config is not initialized");
-        return FAIL;
+    switch (data_type) {
+        case MODBUS_TYPE_INT16:
+        case MODBUS_TYPE_UINT16:
+        case MODBUS_TYPE_UINT16_LOWBYTE:
+        case MODBUS_TYPE_UINT16_HIGHBYTE:
+            return 1;
+        case MODBUS_TYPE_INT32:
+        case MODBUS_TYPE_UINT32:
+        case MODBUS_TYPE_FLOAT32:
+            return 2;
+        case MODBUS_TYPE_UINT64:
+            return 4;
+        default:
+            return 0;
     }
+}
 
-    // update modbus devices
-    for (int i = 0; i < modbus_device_config_count; i++) {
-        const modbus_device_config_t *cfg = &modbus_device_config[i];
-        
-        // debug(tag, "[%d] port:%d, slave:%u, addr:%u, name:%s", i, cfg->port, cfg->slave_id, cfg->reg_address, cfg->reg_name);
+/**
+ * @brief 將 RS485 讀回的暫存器值依設備配置轉換後更新到 Modbus 表
+ *
+ * @param i    設備配置索引(日誌用)
+ * @param cfg  設備配置
+ * @param regs 該設備起始位址對應的暫存器資料
+ *
+ * @return int 執行結果
+ *         - SUCCESS: 更新成功
+ *         - FAIL: 不支援的資料類型
+ */
+static int _modbus_device_value_update(int i, const modbus_device_config_t *cfg, const uint16_t *regs)
+{
+    int ret = SUCCESS;
 
-        // check USB port is connected and pid is RTD board
-        uint16_t pid = 0;
-        hid_manager_port_pid_get(cfg->port, &pid);
-        if (pid != HID_RTD_BOARD_PID) {
-            warn(tag, "cfg[%d] port:%d pid:0x%x != 0x%x, skip query", i, cfg->port, pid, HID_RTD_BOARD_PID);
-            continue;
-        }
+    uint16_t update_address = cfg->update_address;
 
-        uint8_t query_register_num = 0;
-        uint16_t query16_buffer[128] = {0};
+    // help_hexdump(regs, _modbus_device_register_num(cfg->data_type), "regs");
 
-        // check function code
-        switch (cfg->function_code) {
-            case MODBUS_FUNC_READ_COILS:
-            case MODBUS_FUNC_READ_DISCRETE_INPUTS:
-            case MODBUS_FUNC_READ_HOLDING_REGISTERS:
-            case MODBUS_FUNC_READ_INPUT_REGISTERS:
-                break;
+    switch (cfg->data_type) {
 
-            case MODBUS_FUNC_WRITE_SINGLE_REGISTER:
-            case MODBUS_FUNC_WRITE_MULTIPLE_REGISTERS:
-                // error(tag, "skip write function code: %d", cfg->function_code);
-                continue;
+        case MODBUS_TYPE_INT16: {
+            int16_t val = 0;
+            memcpy((uint8_t*)&val, (uint8_t*)regs, 2);
 
-            default:
-                error(tag, "Unsupported function code: %d", cfg->function_code);
-                continue;
-        }
+            // scale
+            if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
+                val = (int16_t)(val * cfg->fScale);
+                // debug(tag, "[%d] val: %d, scale: %f", i, val, cfg->fScale);
+            }
 
-        // get query register num
-        switch (cfg->data_type) {
-            case MODBUS_TYPE_INT16:
-            case MODBUS_TYPE_UINT16:
-            case MODBUS_TYPE_UINT16_LOWBYTE:
-            case MODBUS_TYPE_UINT16_HIGHBYTE:
-                query_register_num = 1;
-                break;
-            case MODBUS_TYPE_INT32:
-            case MODBUS_TYPE_UINT32:
-            case MODBUS_TYPE_FLOAT32:
-                query_register_num = 2;
-                break;
-            case MODBUS_TYPE_UINT64:
-                query_register_num = 4;
-                break;
-            default:
-                error(tag, "Unsupported data type: %d", cfg->data_type);
-                ret = FAIL;
-                break;
+            // debug(tag, "[%d] update_address: %u, val: %d", i, update_address, val);
+            control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_INT16, &val);
+            break;
         }
 
-        // read data from modbus
-        ret = control_hardware_rs485_multiple_read(cfg->port, cfg->baudrate, cfg->slave_id, cfg->function_code, cfg->reg_address, 
-                                                   query_register_num, query16_buffer, 2000);
-
-        // debug(tag, "[%d] port:%d, slave:%u, addr:%u, name:%s, ret:%d", i, cfg->port, cfg->slave_id, cfg->reg_address, cfg->name, ret);
-
-        // update data to modbus manager
-        if (ret == SUCCESS) {
-            uint16_t update_address = cfg->update_address;
-
-            // help_hexdump(query16_buffer, query_register_num, "query16_buffer");
-            
-            switch (cfg->data_type) {
-
-                case MODBUS_TYPE_INT16: {
-                    int16_t val = 0;
-                    memcpy((uint8_t*)&val, (uint8_t*)query16_buffer, 2);
-
-                    // scale
-                    if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
-                        val = (int16_t)(val * cfg->fScale);
-                        // debug(tag, "[%d] val: %d, scale: %f", i, val, cfg->fScale);
-                    }
-
-                    // debug(tag, "[%d] update_address: %u, val: %d", i, update_address, val);
-                    control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_INT16, &val);
-                    break;
-                }
-
-                case MODBUS_TYPE_UINT16: {
-                    uint16_t val = 0;
-                    memcpy((uint8_t*)&val, (uint8_t*)query16_buffer, 2);
-
-                    // scale
-                    if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
-                        val = (uint16_t)(val * cfg->fScale);
-                        // debug(tag, "[%d] val: %u, scale: %f", i, val, cfg->fScale);
-                    }
-
-                    // debug(tag, "[%d] update_address: %u, val: %u", i, update_address, val);
-                    control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT16, &val);
-                    break;
-                }
+        case MODBUS_TYPE_UINT16: {
+            uint16_t val = 0;
+            memcpy((uint8_t*)&val, (uint8_t*)regs, 2);
 
-                case MODBUS_TYPE_UINT16_LOWBYTE: {
-                    uint16_t val = 0;
-                    memcpy((uint8_t*)&val, (uint8_t*)query16_buffer, 2);
-                    val = val & 0xFF;
+            // scale
+            if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
+                val = (uint16_t)(val * cfg->fScale);
+                // debug(tag, "[%d] val: %u, scale: %f", i, val, cfg->fScale);
+            }
 
-                    // scale
-                    if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
-                        val = (uint16_t)(val * cfg->fScale);
-                        // debug(tag, "[%d] val: %u, scale: %f", i, val, cfg->fScale);
-                    }
+            // debug(tag, "[%d] update_address: %u, val: %u", i, update_address, val);
+            control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT16, &val);
+            break;
+        }
 
-                    // debug(tag, "[%d] update_address: %u, val: %u", i, update_address, val);
-                    control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT16, &val);
-                    break;
-                }
+        case MODBUS_TYPE_UINT16_LOWBYTE: {
+            uint16_t val = 0;
+            memcpy((uint8_t*)&val, (uint8_t*)regs, 2);
+            val = val & 0xFF;
 
-                case MODBUS_TYPE_UINT16_HIGHBYTE: {
-                    uint16_t val = 0;
-                    memcpy((uint8_t*)&val, (uint8_t*)query16_buffer, 2);
-                    val = val >> 8;
+            // scale
+            if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
+                val = (uint16_t)(val * cfg->fScale);
+                // debug(tag, "[%d] val: %u, scale: %f", i, val, cfg->fScale);
+            }
 
-                    // scale
-                    if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
-                        val = (uint16_t)(val * cfg->fScale);
-                        // debug(tag, "[%d] val: %u, scale: %f", i, val, cfg->fScale);
-                    }
+            // debug(tag, "[%d] update_address: %u, val: %u", i, update_address, val);
+            control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT16, &val);
+            break;
+        }
 
-                    // debug(tag, "[%d] update_address: %u, val: %u", i, update_address, val);
-                    control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT16, &val);
-                    break;
-                }
+        case MODBUS_TYPE_UINT16_HIGHBYTE: {
+            uint16_t val = 0;
+            memcpy((uint8_t*)&val, (uint8_t*)regs, 2);
+            val = val >> 8;
 
-                case MODBUS_TYPE_INT32: {
-                    int32_t val = 0;
-                    memcpy((uint8_t*)&val, (uint8_t*)query16_buffer, 4);
+            // scale
+            if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
+                val = (uint16_t)(val * cfg->fScale);
+                // debug(tag, "[%d] val: %u, scale: %f", i, val, cfg->fScale);
+            }
 
-                    // scale
-                    if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
-                        val = (int32_t)(val * cfg->fScale);
-                        debug(tag, "[%d] val: %d, scale: %f", i, val, cfg->fScale);
-                    }
+            // debug(tag, "[%d] update_address: %u, val: %u", i, update_address, val);
+            control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT16, &val);
+            break;
+        }
 
-                    // debug(tag, "[%d] update_address: %u, val: %d", i, update_address, val);
-                    control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_INT32, &val);
-                    break;
-                }
+        case MODBUS_TYPE_INT32: {
+            int32_t val = 0;
+            memcpy((uint8_t*)&val, (uint8_t*)regs, 4);
 
-                case MODBUS_TYPE_UINT32: {
-                    uint32_t val = 0;
-                    memcpy((uint8_t*)&val, (uint8_t*)query16_buffer, 4);
+            // scale
+            if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
+                val = (int32_t)(val * cfg->fScale);
+                debug(tag, "[%d] val: %d, scale: %f", i, val, cfg->fScale);
+            }
 
-                    // scale
-                    if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
-                        val = (uint32_t)(val * cfg->fScale);
-                        debug(tag, "[%d] val: %u, scale: %f", i, val, cfg->fScale);
-                    }
+            // debug(tag, "[%d] update_address: %u, val: %d", i, update_address, val);
+            control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_INT32, &val);
+            break;
+        }
 
-                    // debug(tag, "[%d] update_address: %u, val: %u", i, update_address, val);
-                    control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT32, &val);
-                    break;
-                }
+        case MODBUS_TYPE_UINT32: {
+            uint32_t val = 0;
+            memcpy((uint8_t*)&val, (uint8_t*)regs, 4);
 
-                case MODBUS_TYPE_FLOAT32: {
-                    float val_f = 0;
-                    memcpy((uint8_t*)&val_f, (uint8_t*)query16_buffer, 4);
+            // scale
+            if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
+                val = (uint32_t)(val * cfg->fScale);
+                debug(tag, "[%d] val: %u, scale: %f", i, val, cfg->fScale);
+            }
 
-                    // scale
-                    if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
-                        val_f = (float)(val_f * cfg->fScale);
-                        debug(tag, "[%d] val: %f, scale: %f", i, val_f, cfg->fScale);
-                    }
+            // debug(tag, "[%d] update_address: %u, val: %u", i, update_address, val);
+            control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT32, &val);
+            break;
+        }
 
-                    // debug(tag, "[%d] update_address: %u, val: %f", i, update_address, val_f);
-                    control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_FLOAT32, &val_f);      
-                    break;
-                }
+        case MODBUS_TYPE_FLOAT32: {
+            float val_f = 0;
+            memcpy((uint8_t*)&val_f, (uint8_t*)regs, 4);
 
-                case MODBUS_TYPE_UINT64: {
-                    uint64_t val = 0;
-                    memcpy((uint8_t*)&val, (uint8_t*)query16_buffer, 8);
+            // scale
+            if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
+                val_f = (float)(val_f * cfg->fScale);
+                debug(tag, "[%d] val: %f, scale: %f", i, val_f, cfg->fScale);
+            }
 
-                    // scale
-                    if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
-                        val = (uint64_t)(val * cfg->fScale);
-                        // debug(tag, "[%d] val: %llu, scale: %f", i, val, cfg->fScale);
-                    }
+            // debug(tag, "[%d] update_address: %u, val: %f", i, update_address, val_f);
+            control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_FLOAT32, &val_f);      
+            break;
+        }
 
-                    // debug(tag, "[%d] update_address: %u, val: %llu", i, update_address, val);
-                    control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT64, &val);
-                    break;
-                }
+        case MODBUS_TYPE_UINT64: {
+            uint64_t val = 0;
+            memcpy((uint8_t*)&val, (uint8_t*)regs, 8);
 
-                default:
-                    error(tag, "Unsupported destination type for device %d", i);
-                    ret = FAIL;
-                    break;
+            // scale
+            if (cfg->fScale != 0.0 && cfg->fScale != 1.0) {
+                val = (uint64_t)(val * cfg->fScale);
+                // debug(tag, "[%d] val: %llu, scale: %f", i, val, cfg->fScale);
             }
-        } else {
-            error(tag, "RS485 read failed: dev %d, slave %u, addr %u", i, cfg->slave_id, (uint16_t)(cfg->reg_address));
-            ret = FAIL;
+
+            // debug(tag, "[%d] update_address: %u, val: %llu", i, update_address, val);
+            control_logic_update_to_modbus_table(update_address, MODBUS_TYPE_UINT64, &val);
+            break;
         }
 
-        // time_delay_ms(50);
+        default:
+            error(tag, "Unsupported destination type for device %d", i);
+            ret = FAIL;
+            break;
     }
 
     return ret;
 }
 
-static void* _aio_boards_status_update_thread(void* arg)
+/**
+ * @brief RS485 合併讀取項目排序比較函數
+ *
+ * 依 (port, baudrate, slave_id, function_code, reg_address) 排序,
+ * 使同一從站同一功能碼的設備位址相鄰,便於合併成區塊讀取。
+ */
+static int _rs485_read_item_compare(const void *a, const void *b)
 {
-    (void)arg;
+    const modbus_device_config_t *ca = ((const rs485_read_item_t*)a)->cfg;
+    const modbus_device_config_t *cb = ((const rs485_read_item_t*)b)->cfg;
 
-    while (1) {
-        time_delay_ms(CONFIG_APPLICATION_CONTROL_LOGIC_UPDATE_DELAY_MS);
-#if defined(CONTROL_LOGIC_UPDATE_DEBUG_ENABLE) && CONTROL_LOGIC_UPDATE_DEBUG_ENABLE == 1
-        uint64_t start_time = time_get_current_ms();
-        debug(tag, "aio_update_thread +");
-#endif
-        _control_logic_io_boards_status_update();
-#if defined(CONTROL_LOGIC_UPDATE_DEBUG_ENABLE) && CONTROL_LOGIC_UPDATE_DEBUG_ENABLE == 1
-        uint64_t end_time = time_get_current_ms();
-        debug(tag, "aio_update_thread - : %lld ms", end_time - start_time);
-#endif
-    }
+    if (ca->port != cb->port) return (ca->port < cb->port) ? -1 : 1;
+    if (ca->baudrate != cb->baudrate) return (ca->baudrate < cb->baudrate) ? -1 : 1;
+    if (ca->slave_id != cb->slave_id) return (ca->slave_id < cb->slave_id) ? -1 : 1;
+    if (ca->function_code != cb->function_code) return (ca->function_code < cb->function_code) ? -1 : 1;
+    if (ca->reg_address != cb->reg_address) return (ca->reg_address < cb->reg_address) ? -1 : 1;
 
-    return NULL;
+    return 0;
 }
 
-static void* _rtd_boards_status_update_thread(void* arg)
+/**
+ * @brief 判斷讀取項目能否併入目前的區塊
+ *
+ * 條件:
+ * 1. 相同 port、baudrate、slave_id、function_code
+ * 2. 功能碼為讀取暫存器(03/04),線圈類為位元打包回應,不合併
+ * 3. 與區塊結尾的空隙不超過 RS485_BLOCK_READ_MAX_GAP
+ * 4. 合併後總長度不超過 RS485_BLOCK_READ_MAX_REGISTERS
+ */
+static BOOL _rs485_read_item_mergeable(const rs485_read_item_t *head, uint32_t block_end, const rs485_read_item_t *item)
 {
-    (void)arg;
+    const modbus_device_config_t *h = head->cfg;
+    const modbus_device_config_t *c = item->cfg;
 
-    while (1) {
-        time_delay_ms(CONFIG_APPLICATION_CONTROL_LOGIC_UPDATE_DELAY_MS);
-#if defined(CONTROL_LOGIC_UPDATE_DEBUG_ENABLE) && CONTROL_LOGIC_UPDATE_DEBUG_ENABLE == 1
-        uint64_t start_time = time_get_current_ms();
-        debug(tag, "rtd_update_thread +");
-#endif
-        _control_logic_rtd_boards_status_update();
-        _control_logic_modbus_devices_update();
-#if defined(CONTROL_LOGIC_UPDATE_DEBUG_ENABLE) && CONTROL_LOGIC_UPDATE_DEBUG_ENABLE == 1
-        uint64_t end_time = time_get_current_ms();
-        debug(tag, "rtd_update_thread - : %lld ms", end_time - start_time);
-#endif
+    if (h->port != c->port || h->baudrate != c->baudrate ||
+        h->slave_id != c->slave_id || h->function_code != c->function_code) {
+        return FALSE;
     }
 
-    return NULL;
+    if (h->function_code != MODBUS_FUNC_READ_HOLDING_REGISTERS &&
+        h->function_code != MODBUS_FUNC_READ_INPUT_REGISTERS) {
+        return FALSE;
+    }
+
+    if ((uint32_t)c->reg_address > block_end + RS485_BLOCK_READ_MAX_GAP) {
+        return FALSE;
+    }
+
+    uint32_t item_end = (uint32_t)c->reg_address + item->register_num;
+    uint32_t new_end = (item_end > block_end) ? item_end : block_end;
+    if (new_end - h->reg_address > RS485_BLOCK_READ_MAX_REGISTERS) {
+        return FALSE;
+    }
+
+    return TRUE;
 }
 
-static void _control_logic_rtc_update(void)
+/**
+ * @brief 以單一 RS485 讀取更新一個區塊內的所有設備
+ *
+ * @param items         區塊內的讀取項目(已依位址排序)
+ * @param item_count    區塊內的項目數量
+ * @param quantity      區塊讀取的暫存器數量(從第一個項目位址起算)
+ * @param has_gap       區塊內是否包含未被任何設備使用的空隙暫存器
+ *
+ * @return int 執行結果
+ *
+ * @note 含空隙的區塊若讀取失敗(例如從站不支援空隙位址),會退回逐一讀取
+ */
+static int _modbus_devices_block_update(const rs485_read_item_t *items, int item_count, uint16_t quantity, BOOL has_gap)
 {
-    // get current time
-    time_t now = time(NULL);
-    
-    // get localtime
-    struct tm *tm_info = localtime(&now);
-
-    if (tm_info != NULL) {
-        // debug(tag, "update rtc: %d-%d-%d %d:%d:%d", tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday, tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
+    int ret = SUCCESS;
 
-        uint16_t year = (uint16_t)(tm_info->tm_year + 1900);
-        uint16_t month = (uint16_t)(tm_info->tm_mon + 1);
-        uint16_t day = (uint16_t)tm_info->tm_mday;
-        uint16_t hour = (uint16_t)tm_info->tm_hour;
-        uint16_t min = (uint16_t)tm_info->tm_min;
-        uint16_t sec = (uint16_t)tm_info->tm_sec;
+    const modbus_device_config_t *head = items[0].cfg;
+    uint16_t start_address = head->reg_address;
 
-        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_YEAR, MODBUS_TYPE_UINT16, &year);
-        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_MONTH, MODBUS_TYPE_UINT16, &month);
-        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_DAY, MODBUS_TYPE_UINT16, &day);
-        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_HOUR, MODBUS_TYPE_UINT16, &hour);
-        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_MIN, MODBUS_TYPE_UINT16, &min);
-        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_SEC, MODBUS_TYPE_UINT16, &sec);
-    } else {
-        error(tag, "Failed to get localtime for RTC update");
+    // check USB port is connected and pid is RTD board
+    uint16_t pid = 0;
+    hid_manager_port_pid_get(head->port, &pid);
+    if (pid != HID_RTD_BOARD_PID) {
+        warn(tag, "cfg[%d] port:%d pid:0x%x != 0x%x, skip query %d device(s)", items[0].index, head->port, pid, HID_RTD_BOARD_PID, item_count);
+        return SUCCESS;
     }
-}
 
+    uint16_t regs[RS485_BLOCK_READ_MAX_REGISTERS] = {0};
 
-static void* _rtc_status_update_thread(void* arg)
-{
-    (void)arg;
+    _modbus_devices_read_count++;
 
-    while (1) {
-        uint64_t curr_ts = time_get_current_ms();
-        
-        // check ts is after RTC_UPDATE_INTERVAL_MS
-        if (time_after(curr_ts - _latest_update_rtc_ts, RTC_UPDATE_INTERVAL_MS)) {
-            _latest_update_rtc_ts = curr_ts;
-            if (_bUpdate_rtc_enable == TRUE) {
-                _control_logic_rtc_update();
-            }
-        }
+    // read the whole block at once
+    ret = control_hardware_rs485_multiple_read(head->port, head->baudrate, head->slave_id, head->function_code, start_address,
+                                               quantity, regs, 2000);
 
-        time_delay_ms(RTC_UPDATE_INTERVAL_MS);
+    // debug(tag, "port:%d, slave:%u, addr:%u, quantity:%u, devices:%d, ret:%d", head->port, head->slave_id, start_address, quantity, item_count, ret);
+
+    if (ret == SUCCESS) {
+        // scatter to each device
+        for (int k = 0; k < item_count; k++) {
+            const modbus_device_config_t *cfg = items[k].cfg;
+            ret |= _modbus_device_value_update(items[k].index, cfg, &regs[cfg->reg_address - start_address]);
+        }
+    } else if (has_gap == TRUE && item_count > 1) {
+        warn(tag, "RS485 block read failed: slave %u, addr %u, quantity %u, fallback to single reads", head->slave_id, start_address, quantity);
+        ret = SUCCESS;
+        for (int k = 0; k < item_count; k++) {
+            ret |= _modbus_devices_block_update(&items[k], 1, items[k].register_num, FALSE);
+        }
+    } else {
+        error(tag, "RS485 read failed: dev %d, slave %u, addr %u, quantity %u", items[0].index, head->slave_id, start_address, quantity);
+        ret = FAIL;
     }
 
-    return NULL;
+    return ret;
 }
 
 /**
- * @brief 初始化控制邏輯更新模組
+ * @brief 更新所有 RS485 Modbus 設備數據
  *
  * 功能說明:
- * 初始化控制邏輯數據更新功能,創建數據更新執行緒。
+ * 將設備配置依 (port, baudrate, slave_id, function_code) 分組,並把相鄰或
+ * 接近的暫存器位址合併成單次讀取(上限 RS485_BLOCK_READ_MAX_REGISTERS),
+ * 讀取後再依各設備的 reg_address 分發到對應的 update_address。
  *
  * @return int 執行結果
- *         - SUCCESS: 初始化成功
- *         - FAIL: 初始化失敗
+ *         - SUCCESS: 全部更新成功
+ *         - FAIL: 配置未初始化或部分讀取失敗
  *
- * 實現邏輯:
- * 1. 設置 Modbus 管理器的更新回調函數
- * 2. 創建 IO 板狀態更新執行緒
- * 3. 創建 RTD 板狀態更新執行緒
- * 4. (可選)創建 RTC 時間更新執行緒
+ * @note 每個區塊只需一次 HID 寫/讀往返,設備數量多時可大幅減少總輪詢時間
  */
-int control_logic_update_init(void)
+static int _control_logic_modbus_devices_update(void)
 {
     int ret = SUCCESS;
 
-    /* 設置 Modbus 更新回調函數 */
-    modbus_manager_update_callback_setup(control_logic_modbus_manager_callback);
+    // the config snapshot stays valid until the unlock below, even if it is replaced meanwhile
+    control_logic_config_read_lock();
 
-    /* 創建 IO 板更新執行緒 */
-    if (pthread_create(&_update_io_thread_handle, NULL, _aio_boards_status_update_thread, NULL) != 0) {
-        error(tag, "Failed to create control logic update thread");
-        ret = FAIL;
-    }
+    int modbus_device_config_count = 0;
+    modbus_device_config_t *modbus_device_config = control_logic_modbus_device_configs_get(&modbus_device_config_count);
 
-    /* 創建 RTD 板更新執行緒 */
-    if (pthread_create(&_update_rtd_thread_handle, NULL, _rtd_boards_status_update_thread, NULL) != 0) {
-        error(tag, "Failed to create control logic rtd update thread");
+    if (modbus_device_config == NULL) {
+        // error(tag, "modbus device config is not initialized");
+        control_logic_config_read_unlock();
+        return FAIL;
+    }
+
+    if (modbus_device_config_count <= 0) {
+        control_logic_config_read_unlock();
+        return SUCCESS;
+    }
+
+    rs485_read_item_t *items = (rs485_read_item_t*)malloc((size_t)modbus_device_config_count * sizeof(rs485_read_item_t));
+    if (items == NULL) {
+        error(tag, "Out of memory allocating rs485 read items");
+        control_logic_config_read_unlock();
+        return FAIL;
+    }
+
+    // collect readable devices
+    int item_count = 0;
+    for (int i = 0; i < modbus_device_config_count; i++) {
+        const modbus_device_config_t *cfg = &modbus_device_config[i];
+
+        // debug(tag, "[%d] port:%d, slave:%u, addr:%u, name:%s", i, cfg->port, cfg->slave_id, cfg->reg_address, cfg->name);
+
+        // check function code
+        switch (cfg->function_code) {
+            case MODBUS_FUNC_READ_COILS:
+            case MODBUS_FUNC_READ_DISCRETE_INPUTS:
+            case MODBUS_FUNC_READ_HOLDING_REGISTERS:
+            case MODBUS_FUNC_READ_INPUT_REGISTERS:
+                break;
+
+            case MODBUS_FUNC_WRITE_SINGLE_REGISTER:
+            case MODBUS_FUNC_WRITE_MULTIPLE_REGISTERS:
+                // error(tag, "skip write function code: %d", cfg->function_code);
+                continue;
+
+            default:
+                error(tag, "Unsupported function code: %d", cfg->function_code);
+                continue;
+        }
+
+        // get query register num
+        uint8_t register_num = _modbus_device_register_num(cfg->data_type);
+        if (register_num == 0) {
+            error(tag, "Unsupported data type: %d", cfg->data_type);
+            ret = FAIL;
+            continue;
+        }
+
+        items[item_count].cfg = cfg;
+        items[item_count].index = i;
+        items[item_count].register_num = register_num;
+        item_count++;
+    }
+
+    // group by slave and sort by register address
+    qsort(items, (size_t)item_count, sizeof(rs485_read_item_t), _rs485_read_item_compare);
+
+    // merge adjacent ranges into blocks and read each block once
+    int head = 0;
+    while (head < item_count) {
+        uint32_t block_end = (uint32_t)items[head].cfg->reg_address + items[head].register_num;
+        uint32_t covered = items[head].register_num;
+        int tail = head + 1;
+
+        while (tail < item_count && _rs485_read_item_mergeable(&items[head], block_end, &items[tail])) {
+            uint32_t item_start = items[tail].cfg->reg_address;
+            uint32_t item_end = item_start + items[tail].register_num;
+            if (item_end > block_end) {
+                covered += item_end - ((item_start > block_end) ? item_start : block_end);
+                block_end = item_end;
+            }
+            tail++;
+        }
+
+        uint16_t quantity = (uint16_t)(block_end - items[head].cfg->reg_address);
+        if (_modbus_devices_block_update(&items[head], tail - head, quantity, (covered < quantity) ? TRUE : FALSE) != SUCCESS) {
+            ret = FAIL;
+        }
+
+        // time_delay_ms(50);
+
+        head = tail;
+    }
+
+    free(items);
+
+    control_logic_config_read_unlock();
+
+    return ret;
+}
+
+/**
+ * @brief 發布埠輪詢結果
+ *
+ * 更新統計並遞增埠世代
+ *
+ * @param poller 埠輪詢器
+ * @param pid 板子 PID
+ * @param start_ms 本輪開始時間
+ * @param ret 本輪讀取結果
+ */
+static void _port_poller_publish(port_poller_t *poller, uint16_t pid, uint64_t start_ms, int ret)
+{
+    uint64_t end_ms = time_get_current_ms();
+
+    __atomic_store_n(&poller->pid, pid, __ATOMIC_RELAXED);
+    __atomic_store_n(&poller->update_ms, end_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&poller->cycle_ms, (uint32_t)(end_ms - start_ms), __ATOMIC_RELAXED);
+    if (ret != SUCCESS) {
+        __atomic_add_fetch(&poller->failures, 1, __ATOMIC_RELAXED);
+    }
+
+    /* 本輪寫入 Modbus 表的數據在世代遞增之前完成 */
+    __atomic_add_fetch(&poller->generation, 1, __ATOMIC_RELEASE);
+
+    control_logic_manager_sensor_data_notify();
+}
+
+/**
+ * @brief 埠輪詢一輪(固定週期)
+ *
+ * 依插在埠上的板子類型讀取所有數據,完成後發布
+ *
+ * @param poller 埠輪詢器
+ */
+static void _port_poller_cycle(port_poller_t *poller)
+{
+    uint16_t pid = 0;
+    int ret = SUCCESS;
+    uint64_t start_ms = time_get_current_ms();
+
+    hid_manager_port_pid_get(poller->port, &pid);
+
+    switch (pid) {
+        case HID_IO_BOARD_PID:
+            ret = _port_io_board_update(poller->port);
+            break;
+
+        case HID_RTD_BOARD_PID:
+            ret = _port_rtd_board_update(poller->port);
+            break;
+
+        default:
+            /* 沒有插板子,不發布;重新插上時模式快取從硬體讀回 */
+            control_hardware_analog_mode_invalidate(poller->port);
+            __atomic_store_n(&poller->pid, pid, __ATOMIC_RELAXED);
+            return;
+    }
+
+    _port_poller_publish(poller, pid, start_ms, ret);
+}
+
+/**
+ * @brief 板子類型對應的輪詢類別
+ */
+static uint32_t _port_poll_classes(uint16_t pid)
+{
+    switch (pid) {
+        case HID_IO_BOARD_PID:
+            return (1u << CONTROL_LOGIC_POLL_DI) | (1u << CONTROL_LOGIC_POLL_DO) |
+                   (1u << CONTROL_LOGIC_POLL_AI_VOLTAGE) | (1u << CONTROL_LOGIC_POLL_AI_CURRENT);
+        case HID_RTD_BOARD_PID:
+            return (1u << CONTROL_LOGIC_POLL_PT100) | (1u << CONTROL_LOGIC_POLL_PWM_FREQ);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 讀取一個類別並取回寫入 Modbus 表的數值
+ *
+ * @param port HID 埠
+ * @param poll_class 類別
+ * @param values 輸出數值,供排程器計算變化率
+ * @param count 輸出數值數量,讀取失敗時為 0
+ *
+ * @return int 執行結果
+ */
+static int _port_class_poll(uint16_t port, control_logic_poll_class_t poll_class, float values[CONTROL_LOGIC_POLL_VALUES_MAX], int *count)
+{
+    int ret = SUCCESS;
+    uint16_t words[8] = {0};
+    int32_t raw[8] = {0};
+    uint32_t freq[8] = {0};
+
+    *count = 0;
+
+    switch (poll_class) {
+        case CONTROL_LOGIC_POLL_DI:
+            ret = _peripheral_DI_update(port);
+            if (ret == SUCCESS && control_hardware_digital_input_all_get_from_ram(port, words) == SUCCESS) {
+                for (int i = 0; i < 8; i++) values[i] = (float)words[i];
+                *count = 8;
+            }
+            break;
+
+        case CONTROL_LOGIC_POLL_DO:
+            ret = _peripheral_DO_update(port);
+            if (ret == SUCCESS && control_hardware_digital_output_all_get_from_ram(port, words) == SUCCESS) {
+                for (int i = 0; i < 8; i++) values[i] = (float)words[i];
+                *count = 8;
+            }
+            break;
+
+        case CONTROL_LOGIC_POLL_AI_VOLTAGE:
+            /* 模式通常由快取回應,不佔 HID 交易 */
+            _peripheral_AI_mode_update(port);
+            ret = _peripheral_AI_voltage_update(port);
+            if (ret == SUCCESS) {
+                for (int i = 0; i < 4; i++) {
+                    control_hardware_analog_input_voltage_get_from_ram(port, (uint8_t)i, &raw[i]);
+                    values[i] = (float)raw[i];
+                }
+                *count = 4;
+            }
+            break;
+
+        case CONTROL_LOGIC_POLL_AI_CURRENT:
+            ret = _peripheral_AI_current_update(port);
+            if (ret == SUCCESS) {
+                for (int i = 0; i < 4; i++) {
+                    control_hardware_analog_input_current_get_from_ram(port, (uint8_t)i, &raw[i]);
+                    values[i] = (float)raw[i];
+                }
+                *count = 4;
+            }
+            break;
+
+        case CONTROL_LOGIC_POLL_PT100:
+            ret = _peripheral_temperature_update(port);
+            if (ret == SUCCESS && control_hardware_temperature_all_get_from_ram(port, raw) == SUCCESS) {
+                for (int i = 0; i < 8; i++) values[i] = (float)raw[i];
+                *count = 8;
+            }
+            break;
+
+        case CONTROL_LOGIC_POLL_PWM_FREQ:
+            ret = _peripheral_pwm_freq_update(port);
+            if (ret == SUCCESS && control_hardware_pwm_freq_all_get_from_ram(port, freq) == SUCCESS) {
+                for (int i = 0; i < 8; i++) values[i] = (float)freq[i];
+                *count = 8;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 埠輪詢一輪(自適應排程)
+ *
+ * 執行排程器中所有到期的類別,有執行任何類別就發布一次
+ *
+ * @param poller 埠輪詢器
+ */
+static void _port_poller_plan_cycle(port_poller_t *poller)
+{
+    uint16_t pid = 0;
+    int ret = SUCCESS;
+    int polled = 0;
+    uint64_t start_ms = time_get_current_ms();
+    control_logic_poll_class_t poll_class;
+
+    hid_manager_port_pid_get(poller->port, &pid);
+
+    /* 板子插拔或更換時重設該埠的工作 */
+    if (pid != poller->plan_pid) {
+        control_logic_poll_plan_slot_set(poller->port, _port_poll_classes(pid), start_ms);
+        poller->plan_pid = pid;
+    }
+
+    if (_port_poll_classes(pid) == 0) {
+        /* 沒有插板子,不發布;重新插上時模式快取從硬體讀回 */
+        control_hardware_analog_mode_invalidate(poller->port);
+        __atomic_store_n(&poller->pid, pid, __ATOMIC_RELAXED);
+        return;
+    }
+
+    while (control_logic_poll_plan_next(poller->port, time_get_current_ms(), &poll_class) == SUCCESS) {
+        float values[CONTROL_LOGIC_POLL_VALUES_MAX];
+        int count = 0;
+
+        if (_port_class_poll(poller->port, poll_class, values, &count) != SUCCESS) {
+            ret = FAIL;
+        }
+        control_logic_poll_plan_done(poller->port, poll_class, time_get_current_ms(), count ? values : NULL, count, 1.0f);
+        polled++;
+    }
+
+    if (polled > 0) {
+        _port_poller_publish(poller, pid, start_ms, ret);
+    }
+}
+
+/**
+ * @brief 埠輪詢執行緒
+ *
+ * 每個 HID 埠一個執行緒,慢的板子(例如逾時 2000ms)只拖慢自己的埠。
+ * 預設依排程器(control_logic_poll_plan)逐類別輪詢,每次最多睡 period_ms 以偵測插拔;
+ * 以 control_logic_update_port_period_set() 設定週期後改為固定週期讀取全部數據,
+ * 一輪超過週期時立即開始下一輪。
+ *
+ * @param arg 埠輪詢器
+ */
+static void* _port_poller_thread(void* arg)
+{
+    port_poller_t *poller = (port_poller_t *)arg;
+
+    while (1) {
+        uint64_t start_ms = time_get_current_ms();
+        BOOL fixed = __atomic_load_n(&poller->fixed, __ATOMIC_RELAXED) ? TRUE : FALSE;
+#if defined(CONTROL_LOGIC_UPDATE_DEBUG_ENABLE) && CONTROL_LOGIC_UPDATE_DEBUG_ENABLE == 1
+        debug(tag, "port[%d] poller +", poller->port);
+#endif
+        if (fixed == TRUE) {
+            _port_poller_cycle(poller);
+        } else {
+            _port_poller_plan_cycle(poller);
+        }
+#if defined(CONTROL_LOGIC_UPDATE_DEBUG_ENABLE) && CONTROL_LOGIC_UPDATE_DEBUG_ENABLE == 1
+        debug(tag, "port[%d] poller - : %lld ms", poller->port, time_get_current_ms() - start_ms);
+#endif
+        uint32_t period_ms = __atomic_load_n(&poller->period_ms, __ATOMIC_RELAXED);
+        uint64_t now_ms = time_get_current_ms();
+        uint64_t wakeup_ms = start_ms + period_ms;
+
+        if (fixed == FALSE) {
+            uint64_t plan_ms = control_logic_poll_plan_wakeup_ms(poller->port);
+            wakeup_ms = (plan_ms < now_ms + period_ms) ? plan_ms : now_ms + period_ms;
+        }
+
+        if (wakeup_ms > now_ms) {
+            time_delay_ms((uint32_t)(wakeup_ms - now_ms));
+        } else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 啟動所有埠的輪詢執行緒
+ *
+ * @return int 執行結果
+ *         - SUCCESS: 全部啟動
+ *         - FAIL: 至少一個埠啟動失敗
+ */
+static int _port_pollers_start(void)
+{
+    int ret = SUCCESS;
+
+    for (int port = 0; port < HID_DEVICES_MAX; port++) {
+        port_poller_t *poller = &_port_pollers[port];
+
+        poller->port = (uint16_t)port;
+        if (__atomic_load_n(&poller->period_ms, __ATOMIC_RELAXED) == 0) {
+            __atomic_store_n(&poller->period_ms, CONFIG_CONTROL_LOGIC_PORT_POLL_PERIOD_MS, __ATOMIC_RELAXED);
+        }
+
+        if (pthread_create(&poller->thread, NULL, _port_poller_thread, poller) != 0) {
+            error(tag, "Failed to create port[%d] poller thread", port);
+            ret = FAIL;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 外部 Modbus 設備更新執行緒
+ *
+ * 週期由排程器的 RS485 工作決定,每輪的 HID 交易數(合併讀取的區塊數)計入匯流排預算
+ */
+static void* _modbus_devices_update_thread(void* arg)
+{
+    (void)arg;
+
+    control_logic_poll_class_t poll_class;
+
+    control_logic_poll_plan_slot_set(CONTROL_LOGIC_POLL_RS485_SLOT, 1u << CONTROL_LOGIC_POLL_RS485, time_get_current_ms());
+
+    while (1) {
+        uint64_t now_ms = time_get_current_ms();
+        uint64_t wakeup_ms = control_logic_poll_plan_wakeup_ms(CONTROL_LOGIC_POLL_RS485_SLOT);
+
+        if (wakeup_ms > now_ms) {
+            uint64_t delay_ms = wakeup_ms - now_ms;
+            time_delay_ms((uint32_t)((delay_ms < CONFIG_APPLICATION_CONTROL_LOGIC_UPDATE_DELAY_MS) ? delay_ms : CONFIG_APPLICATION_CONTROL_LOGIC_UPDATE_DELAY_MS));
+            continue;
+        }
+
+        if (control_logic_poll_plan_next(CONTROL_LOGIC_POLL_RS485_SLOT, now_ms, &poll_class) != SUCCESS) {
+            sched_yield();
+            continue;
+        }
+#if defined(CONTROL_LOGIC_UPDATE_DEBUG_ENABLE) && CONTROL_LOGIC_UPDATE_DEBUG_ENABLE == 1
+        uint64_t start_time = time_get_current_ms();
+        debug(tag, "modbus_devices_update_thread +");
+#endif
+        uint32_t reads_before = _modbus_devices_read_count;
+        uint64_t devices_start_ns = control_logic_latency_start();
+        _control_logic_modbus_devices_update();
+        control_logic_latency_record(CONTROL_LOGIC_LATENCY_MODBUS_DEVICES, devices_start_ns);
+        control_logic_poll_plan_done(CONTROL_LOGIC_POLL_RS485_SLOT, poll_class, time_get_current_ms(), NULL, 0,
+                                     (float)(_modbus_devices_read_count - reads_before));
+        control_logic_manager_sensor_data_notify();
+#if defined(CONTROL_LOGIC_UPDATE_DEBUG_ENABLE) && CONTROL_LOGIC_UPDATE_DEBUG_ENABLE == 1
+        uint64_t end_time = time_get_current_ms();
+        debug(tag, "modbus_devices_update_thread - : %lld ms", end_time - start_time);
+#endif
+    }
+
+    return NULL;
+}
+
+static void _control_logic_rtc_update(void)
+{
+    // get current time
+    time_t now = time(NULL);
+    
+    // get localtime
+    struct tm *tm_info = localtime(&now);
+
+    if (tm_info != NULL) {
+        // debug(tag, "update rtc: %d-%d-%d %d:%d:%d", tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday, tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec);
+
+        uint16_t year = (uint16_t)(tm_info->tm_year + 1900);
+        uint16_t month = (uint16_t)(tm_info->tm_mon + 1);
+        uint16_t day = (uint16_t)tm_info->tm_mday;
+        uint16_t hour = (uint16_t)tm_info->tm_hour;
+        uint16_t min = (uint16_t)tm_info->tm_min;
+        uint16_t sec = (uint16_t)tm_info->tm_sec;
+
+        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_YEAR, MODBUS_TYPE_UINT16, &year);
+        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_MONTH, MODBUS_TYPE_UINT16, &month);
+        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_DAY, MODBUS_TYPE_UINT16, &day);
+        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_HOUR, MODBUS_TYPE_UINT16, &hour);
+        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_MIN, MODBUS_TYPE_UINT16, &min);
+        control_logic_update_to_modbus_table(MODBUS_ADDRESS_RTC_SEC, MODBUS_TYPE_UINT16, &sec);
+    } else {
+        error(tag, "Failed to get localtime for RTC update");
+    }
+}
+
+
+static void* _rtc_status_update_thread(void* arg)
+{
+    (void)arg;
+
+    while (1) {
+        uint64_t curr_ts = time_get_current_ms();
+        
+        // check ts is after RTC_UPDATE_INTERVAL_MS
+        if (time_after(curr_ts - _latest_update_rtc_ts, RTC_UPDATE_INTERVAL_MS)) {
+            _latest_update_rtc_ts = curr_ts;
+            if (_bUpdate_rtc_enable == TRUE) {
+                _control_logic_rtc_update();
+            }
+        }
+
+        time_delay_ms(RTC_UPDATE_INTERVAL_MS);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 初始化控制邏輯更新模組
+ *
+ * 功能說明:
+ * 初始化控制邏輯數據更新功能,創建數據更新執行緒。
+ *
+ * @return int 執行結果
+ *         - SUCCESS: 初始化成功
+ *         - FAIL: 初始化失敗
+ *
+ * 實現邏輯:
+ * 1. 重播持久化日誌並啟動持久化執行緒
+ * 2. 初始化感測器歷史緩衝區
+ * 3. 設置 Modbus 管理器的更新回調函數
+ * 4. 每個 HID 埠創建一個輪詢執行緒(IO/RTD 板)
+ * 5. 創建外部 Modbus 設備更新執行緒
+ * 6. (可選)創建 RTC 時間更新執行緒
+ */
+int control_logic_update_init(void)
+{
+    int ret = SUCCESS;
+
+    /* 重播持久化日誌並啟動持久化執行緒 */
+    if (control_logic_persist_init() != SUCCESS) {
+        warn(tag, "persist init failed, fall back to synchronous save");
+    }
+
+    /* 感測器歷史緩衝區,通道在更新執行緒第一次寫入時建立 */
+    if (control_logic_history_init(CONFIG_CONTROL_LOGIC_HISTORY_DEPTH, CONFIG_CONTROL_LOGIC_HISTORY_CHANNELS_MAX) != SUCCESS) {
+        warn(tag, "history init failed, sensor history disabled");
+    }
+
+    /* 設置 Modbus 更新回調函數 */
+    modbus_manager_update_callback_setup(control_logic_modbus_manager_callback);
+
+    /* Modbus 伺服器讀寫保持暫存器時改走 seqlock,遠端讀到的 32/64 位元數值不會只更新一半 */
+    modbus_set_registers_access(_modbus_server_registers_read, _modbus_server_registers_write);
+
+    /* 每個 HID 埠一個輪詢執行緒(IO 板與 RTD 板) */
+    if (_port_pollers_start() != SUCCESS) {
+        ret = FAIL;
+    }
+
+    /* 創建外部 Modbus 設備(RS485)更新執行緒 */
+    if (pthread_create(&_update_rs485_thread_handle, NULL, _modbus_devices_update_thread, NULL) != 0) {
+        error(tag, "Failed to create control logic modbus devices update thread");
+        ret = FAIL;
+    }
+
+    /* 創建 RTC 時間更新執行緒 (目前停用) */
+    // if (pthread_create(&_update_rtc_thread_handle, NULL, _rtc_status_update_thread, NULL) != 0) {
+    //     error(tag, "Failed to create control logic rtc update thread");
+    //     ret = FAIL;
+    // }
+
+    return ret;
+}
+
+int control_logic_update_port_period_set(uint16_t port, uint32_t period_ms)
+{
+    if (port >= HID_DEVICES_MAX || period_ms == 0) {
+        return FAIL;
+    }
+
+    __atomic_store_n(&_port_pollers[port].period_ms, period_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&_port_pollers[port].fixed, 1, __ATOMIC_RELAXED);
+
+    /* 固定週期的埠不再計入排程器的匯流排預算 */
+    control_logic_poll_plan_slot_set(port, 0, time_get_current_ms());
+
+    return SUCCESS;
+}
+
+int control_logic_update_port_status_get(uint16_t port, control_logic_port_status_t *status)
+{
+    if (port >= HID_DEVICES_MAX || status == NULL) {
+        return FAIL;
+    }
+
+    const port_poller_t *poller = &_port_pollers[port];
+
+    status->generation = __atomic_load_n(&poller->generation, __ATOMIC_ACQUIRE);
+    status->pid = __atomic_load_n(&poller->pid, __ATOMIC_RELAXED);
+    status->period_ms = __atomic_load_n(&poller->period_ms, __ATOMIC_RELAXED);
+    status->failures = __atomic_load_n(&poller->failures, __ATOMIC_RELAXED);
+    status->cycle_ms = __atomic_load_n(&poller->cycle_ms, __ATOMIC_RELAXED);
+    status->update_ms = __atomic_load_n(&poller->update_ms, __ATOMIC_RELAXED);
+
+    return SUCCESS;
+}
+
+static int _control_logic_rtc_set(void)
+{
+    int ret = SUCCESS;
+    
+    // Convert RTC year, month, day, hour, min, sec to epoch time and set system date
+    uint16_t rtc_year = 0, rtc_month = 0, rtc_day = 0, rtc_hour = 0, rtc_min = 0, rtc_sec = 0;
+
+    // Read all RTC registers from modbus table
+    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_YEAR, MODBUS_TYPE_UINT16, &rtc_year);
+    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_MONTH, MODBUS_TYPE_UINT16, &rtc_month);
+    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_DAY, MODBUS_TYPE_UINT16, &rtc_day);
+    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_HOUR, MODBUS_TYPE_UINT16, &rtc_hour);
+    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_MIN, MODBUS_TYPE_UINT16, &rtc_min);
+    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_SEC, MODBUS_TYPE_UINT16, &rtc_sec);
+
+    struct tm rtc_tm;
+    memset(&rtc_tm, 0, sizeof(struct tm));
+    rtc_tm.tm_year = rtc_year - 1900; // tm_year is years since 1900
+    rtc_tm.tm_mon = rtc_month - 1;    // tm_mon is 0-based
+    rtc_tm.tm_mday = rtc_day;
+    rtc_tm.tm_hour = rtc_hour;
+    rtc_tm.tm_min = rtc_min;
+    rtc_tm.tm_sec = rtc_sec;
+
+    time_t epoch_time = mktime(&rtc_tm);
+
+    debug(tag, "epoch_time = %ld", epoch_time);
+
+    if (epoch_time != (time_t)-1) {
+        char cmd[128];
+        snprintf(cmd, sizeof(cmd), "date -s @%ld", (long)epoch_time);
+        ret = system(cmd);
+        ret = system("hwclock -w");
+        info(tag, "Set system date to epoch %ld (%d/%d/%d %d:%d:%d), ret = %d", (long)epoch_time, rtc_year, rtc_month, rtc_day, rtc_hour, rtc_min, rtc_sec, ret);
+    } else {
+        error(tag, "Failed to convert RTC to epoch time: Y:%d M:%d D:%d H:%d M:%d S:%d", rtc_year, rtc_month, rtc_day, rtc_hour, rtc_min, rtc_sec);
         ret = FAIL;
     }
 
-    /* 創建 RTC 時間更新執行緒 (目前停用) */
-    // if (pthread_create(&_update_rtc_thread_handle, NULL, _rtc_status_update_thread, NULL) != 0) {
-    //     error(tag, "Failed to create control logic rtc update thread");
-    //     ret = FAIL;
-    // }
+    return ret;
+}
+
+int control_logic_modbus_manager_callback(uint16_t address, uint8_t type, uint32_t value)
+{
+    int ret = FAIL;
+
+    BOOL bNeedSaveToFile = FALSE;
+
+    // debug(tag, "control_logic_modbus_manager_callback: address %d, type %d, value %d", address, type, value);
+
+    switch (address) {
+        case MODBUS_ADDRESS_RTC_YEAR:
+        case MODBUS_ADDRESS_RTC_MONTH:
+        case MODBUS_ADDRESS_RTC_DAY:
+        case MODBUS_ADDRESS_RTC_HOUR:
+        case MODBUS_ADDRESS_RTC_MIN:
+        case MODBUS_ADDRESS_RTC_SEC:
+            // disable rtc update
+            _bUpdate_rtc_enable = FALSE;
+            // update modbus table first
+            control_logic_update_value_to_modbus_table(address, type, value);
+            ret = _control_logic_rtc_set();
+            // enable rtc update
+            _bUpdate_rtc_enable = TRUE;
+            bNeedSaveToFile = TRUE;
+            break;
+
+        default: {
+            // Check if address is defined in device configs
+            BOOL address_mapping_found = FALSE;
+            modbus_device_config_t modbus_device_config;
+            if (control_logic_modbus_device_write_config_find(address, &modbus_device_config) == SUCCESS) {
+                address_mapping_found = TRUE;
+                ret = control_hardware_rs485_single_write(modbus_device_config.port, 
+                                                          modbus_device_config.baudrate, 
+                                                          modbus_device_config.slave_id, 
+                                                          modbus_device_config.reg_address, 
+                                                          value);
+                // debug(tag, "write to modbus success: address %d, value %d, ret %d", address, value, ret);
+            }
+            if (address_mapping_found) {
+                info(tag, "address %d, type %d, value %d, bridge to 485 device, ret = %d", address, type, value, ret);
+                bNeedSaveToFile = FALSE;
+            } else {
+                info(tag, "address %d, type %d, value %d, direct update to modbus table", address, type, value);
+                control_logic_update_value_to_modbus_table(address, type, value);
+                ret = SUCCESS;
+                bNeedSaveToFile = TRUE;
+            }
+            break;
+        }
+    }
+
+    if (bNeedSaveToFile == TRUE) {
+        ret = control_logic_persist_record(address, type, value);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 取得暫存器位址所屬的 seqlock 分頁
+ */
+static uint32_t _modbus_table_page(uint32_t address)
+{
+    return (address / MODBUS_TABLE_SEQLOCK_PAGE_SIZE) % MODBUS_TABLE_SEQLOCK_PAGE_NUM;
+}
+
+static void _modbus_table_page_write_lock(uint32_t page)
+{
+    uint32_t *seq = &_modbus_table_seq[page];
+
+    while (1) {
+        uint32_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+        if ((s & 1) == 0 &&
+            __atomic_compare_exchange_n(seq, &s, s + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+        // another writer is on this page
+        sched_yield();
+    }
+
+    // make the odd sequence visible before any data store
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void _modbus_table_page_write_unlock(uint32_t page)
+{
+    __atomic_fetch_add(&_modbus_table_seq[page], 1, __ATOMIC_RELEASE);
+}
+
+static uint32_t _modbus_table_page_read_begin(uint32_t page)
+{
+    uint32_t s = 0;
+
+    while ((s = __atomic_load_n(&_modbus_table_seq[page], __ATOMIC_ACQUIRE)) & 1) {
+        // writer in progress, let it finish
+        sched_yield();
+    }
+
+    return s;
+}
+
+static bool _modbus_table_page_read_retry(uint32_t page, uint32_t s)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    return __atomic_load_n(&_modbus_table_seq[page], __ATOMIC_RELAXED) != s;
+}
+
+/**
+ * @brief 記錄一段暫存器在指定世代改變
+ *
+ * 功能說明:
+ * 將變更世代寫入各暫存器與所屬分頁。呼叫端需持有範圍內所有分頁的
+ * 寫入鎖,查詢端等待分頁序號為偶數後即可看到不大於當時世代的所有變更。
+ */
+static void _modbus_table_mark_generation(uint16_t address, uint16_t count, uint32_t gen)
+{
+    for (uint32_t a = address; a < (uint32_t)address + count && a < MODBUS_RO_REGISTERS; a++) {
+        __atomic_store_n(&_modbus_table_register_gen[a], gen, __ATOMIC_RELAXED);
+
+        uint32_t page = _modbus_table_page(a);
+        if (__atomic_load_n(&_modbus_table_page_gen[page], __ATOMIC_RELAXED) < gen) {
+            __atomic_store_n(&_modbus_table_page_gen[page], gen, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief 以新的變更世代記錄一段暫存器的數值已改變
+ */
+static void _modbus_table_mark_changed(uint16_t address, uint16_t count)
+{
+    uint32_t gen = __atomic_add_fetch(&_modbus_table_generation, 1, __ATOMIC_RELAXED);
+
+    _modbus_table_mark_generation(address, count, gen);
+}
+
+/**
+ * @brief 將多個 16 位元字寫入 Modbus 表
+ *
+ * 功能說明:
+ * 數值與表中相同時不寫入,不產生變更世代;有改變時以所屬分頁的 seqlock
+ * 保護寫入並記錄變更世代,讀取端不會看到只更新一半的多字(32/64 位元)值。
+ *
+ * @note 寫入端之間以分頁序號互斥,不會等待讀取端
+ */
+static void _modbus_table_words_store(uint16_t *tab, uint16_t address, const uint16_t *words, uint8_t count)
+{
+    bool changed = false;
+    for (uint8_t i = 0; i < count && !changed; i++) {
+        changed = (__atomic_load_n(&tab[address + i], __ATOMIC_RELAXED) != words[i]);
+    }
+    if (!changed) {
+        return;
+    }
+
+    uint32_t first = _modbus_table_page(address);
+    uint32_t last = _modbus_table_page((uint32_t)address + count - 1);
+
+    // lock pages in ascending order to avoid deadlock with a neighbour writer
+    uint32_t lo = (first < last) ? first : last;
+    uint32_t hi = (first < last) ? last : first;
+
+    _modbus_table_page_write_lock(lo);
+    if (hi != lo) {
+        _modbus_table_page_write_lock(hi);
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        __atomic_store_n(&tab[address + i], words[i], __ATOMIC_RELAXED);
+    }
+    _modbus_table_mark_changed(address, count);
+
+    if (hi != lo) {
+        _modbus_table_page_write_unlock(hi);
+    }
+    _modbus_table_page_write_unlock(lo);
+}
+
+/**
+ * @brief 從 Modbus 表讀出多個 16 位元字
+ *
+ * 功能說明:
+ * 多字讀取採 seqlock 讀取端協定: 讀取前後比對分頁序號,若期間有寫入
+ * 則重新讀取,不持有任何鎖。
+ */
+static void _modbus_table_words_load(const uint16_t *tab, uint16_t address, uint16_t *words, uint8_t count)
+{
+    if (count == 1) {
+        words[0] = __atomic_load_n(&tab[address], __ATOMIC_RELAXED);
+        return;
+    }
+
+    uint32_t first = _modbus_table_page(address);
+    uint32_t last = _modbus_table_page((uint32_t)address + count - 1);
+
+    while (1) {
+        uint32_t s_first = _modbus_table_page_read_begin(first);
+        uint32_t s_last = (last != first) ? _modbus_table_page_read_begin(last) : s_first;
+
+        for (uint8_t i = 0; i < count; i++) {
+            words[i] = __atomic_load_n(&tab[address + i], __ATOMIC_RELAXED);
+        }
+
+        if (_modbus_table_page_read_retry(first, s_first)) {
+            continue;
+        }
+        if (last != first && _modbus_table_page_read_retry(last, s_last)) {
+            continue;
+        }
+        break;
+    }
+}
+
+/**
+ * @brief 將一段連續暫存器寫入 Modbus 表
+ *
+ * 功能說明:
+ * 範圍內的分頁依遞增順序全部上鎖後才寫入,讀取端不會看到只寫入一部分的範圍。
+ * 數值改變的暫存器記錄變更世代。
+ *
+ * @note count 不可超過 CONTROL_LOGIC_MODBUS_RANGE_MAX
+ */
+static void _modbus_table_range_store(uint16_t *tab, uint16_t address, const uint16_t *words, uint16_t count)
+{
+    uint32_t first = _modbus_table_page(address);
+    uint32_t last = _modbus_table_page((uint32_t)address + count - 1);
+
+    for (uint32_t page = first; page <= last; page++) {
+        _modbus_table_page_write_lock(page);
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (__atomic_load_n(&tab[address + i], __ATOMIC_RELAXED) != words[i]) {
+            __atomic_store_n(&tab[address + i], words[i], __ATOMIC_RELAXED);
+            _modbus_table_mark_changed(address + i, 1);
+        }
+    }
+
+    for (uint32_t page = last + 1; page-- > first; ) {
+        _modbus_table_page_write_unlock(page);
+    }
+}
+
+/**
+ * @brief 從 Modbus 表讀出一段連續暫存器
+ *
+ * 功能說明:
+ * 記錄範圍內各分頁的序號後複製整段,任一分頁期間有寫入則重新複製,
+ * 跨越多個暫存器的數值不會只讀到一半。
+ *
+ * @note count 不可超過 CONTROL_LOGIC_MODBUS_RANGE_MAX
+ */
+static void _modbus_table_range_load(const uint16_t *tab, uint16_t address, uint16_t *words, uint16_t count)
+{
+    uint32_t first = _modbus_table_page(address);
+    uint32_t last = _modbus_table_page((uint32_t)address + count - 1);
+    uint32_t seq[MODBUS_TABLE_RANGE_PAGES_MAX];
+    bool retry = true;
+
+    while (retry) {
+        for (uint32_t page = first; page <= last; page++) {
+            seq[page - first] = _modbus_table_page_read_begin(page);
+        }
+
+        for (uint16_t i = 0; i < count; i++) {
+            words[i] = __atomic_load_n(&tab[address + i], __ATOMIC_RELAXED);
+        }
 
-    return ret;
+        retry = false;
+        for (uint32_t page = first; page <= last && !retry; page++) {
+            retry = _modbus_table_page_read_retry(page, seq[page - first]);
+        }
+    }
 }
 
-static int _control_logic_rtc_set(void)
+/**
+ * @brief Modbus 伺服器讀取保持暫存器
+ *
+ * 由 libmodbus 的 modbus_reply() 在組回應前呼叫,以 seqlock 讀取端複製暫存器,
+ * TCP/RTU 主站讀到的 32/64 位元數值不會是寫到一半的值。
+ *
+ * @param mb_mapping 伺服器使用的映射表
+ * @param address 相對於 start_registers 的位址
+ * @param nb 暫存器數量
+ * @param dest 輸出暫存器數值
+ */
+static void _modbus_server_registers_read(const modbus_mapping_t *mb_mapping, int address, int nb, uint16_t *dest)
 {
-    int ret = SUCCESS;
-    
-    // Convert RTC year, month, day, hour, min, sec to epoch time and set system date
-    uint16_t rtc_year = 0, rtc_month = 0, rtc_day = 0, rtc_hour = 0, rtc_min = 0, rtc_sec = 0;
+    // only the control logic table is guarded by the seqlock
+    if (mb_mapping != modbus_manager_data_mapping_get() || mb_mapping->start_registers != 0) {
+        memcpy(dest, &mb_mapping->tab_registers[address], (size_t)nb * sizeof(uint16_t));
+        return;
+    }
 
-    // Read all RTC registers from modbus table
-    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_YEAR, MODBUS_TYPE_UINT16, &rtc_year);
-    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_MONTH, MODBUS_TYPE_UINT16, &rtc_month);
-    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_DAY, MODBUS_TYPE_UINT16, &rtc_day);
-    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_HOUR, MODBUS_TYPE_UINT16, &rtc_hour);
-    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_MIN, MODBUS_TYPE_UINT16, &rtc_min);
-    control_logic_load_from_modbus_table(MODBUS_ADDRESS_RTC_SEC, MODBUS_TYPE_UINT16, &rtc_sec);
+    while (nb > 0) {
+        uint16_t count = (nb > CONTROL_LOGIC_MODBUS_RANGE_MAX) ? CONTROL_LOGIC_MODBUS_RANGE_MAX : (uint16_t)nb;
 
-    struct tm rtc_tm;
-    memset(&rtc_tm, 0, sizeof(struct tm));
-    rtc_tm.tm_year = rtc_year - 1900; // tm_year is years since 1900
-    rtc_tm.tm_mon = rtc_month - 1;    // tm_mon is 0-based
-    rtc_tm.tm_mday = rtc_day;
-    rtc_tm.tm_hour = rtc_hour;
-    rtc_tm.tm_min = rtc_min;
-    rtc_tm.tm_sec = rtc_sec;
+        _modbus_table_range_load(mb_mapping->tab_registers, (uint16_t)address, dest, count);
 
-    time_t epoch_time = mktime(&rtc_tm);
+        address += count;
+        dest += count;
+        nb -= count;
+    }
+}
 
-    debug(tag, "epoch_time = %ld", epoch_time);
+/**
+ * @brief Modbus 伺服器寫入保持暫存器
+ *
+ * 由 libmodbus 的 modbus_reply() 在處理寫入請求時呼叫,以 seqlock 寫入端寫入,
+ * 主站一次寫入的多個暫存器對本地讀取端是同時生效的。
+ *
+ * @param mb_mapping 伺服器使用的映射表
+ * @param address 相對於 start_registers 的位址
+ * @param nb 暫存器數量
+ * @param src 要寫入的暫存器數值
+ */
+static void _modbus_server_registers_write(modbus_mapping_t *mb_mapping, int address, int nb, const uint16_t *src)
+{
+    if (mb_mapping != modbus_manager_data_mapping_get() || mb_mapping->start_registers != 0) {
+        memcpy(&mb_mapping->tab_registers[address], src, (size_t)nb * sizeof(uint16_t));
+        return;
+    }
 
-    if (epoch_time != (time_t)-1) {
-        char cmd[128];
-        snprintf(cmd, sizeof(cmd), "date -s @%ld", (long)epoch_time);
-        ret = system(cmd);
-        ret = system("hwclock -w");
-        info(tag, "Set system date to epoch %ld (%d/%d/%d %d:%d:%d), ret = %d", (long)epoch_time, rtc_year, rtc_month, rtc_day, rtc_hour, rtc_min, rtc_sec, ret);
-    } else {
-        error(tag, "Failed to convert RTC to epoch time: Y:%d M:%d D:%d H:%d M:%d S:%d", rtc_year, rtc_month, rtc_day, rtc_hour, rtc_min, rtc_sec);
-        ret = FAIL;
+    while (nb > 0) {
+        uint16_t count = (nb > CONTROL_LOGIC_MODBUS_RANGE_MAX) ? CONTROL_LOGIC_MODBUS_RANGE_MAX : (uint16_t)nb;
+
+        _modbus_table_range_store(mb_mapping->tab_registers, (uint16_t)address, src, count);
+
+        address += count;
+        src += count;
+        nb -= count;
     }
+}
 
-    return ret;
+/**
+ * @brief 取得資料類型在 Modbus 表中佔用的暫存器數量
+ *
+ * @return uint8_t 暫存器數量,不支援的類型返回 0
+ */
+static uint8_t _modbus_table_type_words(uint8_t type)
+{
+    switch (type) {
+        case MODBUS_TYPE_INT16:
+        case MODBUS_TYPE_UINT16:
+            return 1;
+        case MODBUS_TYPE_INT32:
+        case MODBUS_TYPE_UINT32:
+        case MODBUS_TYPE_FLOAT32:
+            return 2;
+        case MODBUS_TYPE_UINT64:
+            return 4;
+        default:
+            return 0;
+    }
 }
 
-int control_logic_modbus_manager_callback(uint16_t address, uint8_t type, uint32_t value)
+/**
+ * @brief 將一個數值依資料類型拆成 Modbus 表的 16 位元字(低位字在前)
+ *
+ * @note type 需已由 _modbus_table_type_words() 檢查
+ */
+static void _modbus_table_words_encode(uint8_t type, const void *value, uint16_t words[4])
 {
-    int ret = FAIL;
+    switch (type) {
+        case MODBUS_TYPE_INT16:
+            words[0] = (uint16_t)*(const int16_t*)value;
+            break;
 
-    BOOL bNeedSaveToFile = FALSE;
+        case MODBUS_TYPE_UINT16:
+            words[0] = *(const uint16_t*)value;
+            break;
 
-    // debug(tag, "control_logic_modbus_manager_callback: address %d, type %d, value %d", address, type, value);
+        case MODBUS_TYPE_INT32: {
+            int32_t val = *(const int32_t*)value;
+            words[0] = (uint16_t)(val & 0xFFFF);
+            words[1] = (uint16_t)((val >> 16) & 0xFFFF);
+            break;
+        }
 
-    switch (address) {
-        case MODBUS_ADDRESS_RTC_YEAR:
-        case MODBUS_ADDRESS_RTC_MONTH:
-        case MODBUS_ADDRESS_RTC_DAY:
-        case MODBUS_ADDRESS_RTC_HOUR:
-        case MODBUS_ADDRESS_RTC_MIN:
-        case MODBUS_ADDRESS_RTC_SEC:
-            // disable rtc update
-            _bUpdate_rtc_enable = FALSE;
-            // update modbus table first
-            control_logic_update_to_modbus_table(address, type, &value);
-            ret = _control_logic_rtc_set();
-            // enable rtc update
-            _bUpdate_rtc_enable = TRUE;
-            bNeedSaveToFile = TRUE;
+        case MODBUS_TYPE_UINT32: {
+            uint32_t val = *(const uint32_t*)value;
+            words[0] = (uint16_t)(val & 0xFFFF);
+            words[1] = (uint16_t)((val >> 16) & 0xFFFF);
+            break;
+        }
+
+        case MODBUS_TYPE_FLOAT32: {
+            union {
+                float f;
+                uint32_t u32;
+            } float_converter;
+            float_converter.f = *(const float*)value;
+            words[0] = (uint16_t)(float_converter.u32 & 0xFFFF);
+            words[1] = (uint16_t)((float_converter.u32 >> 16) & 0xFFFF);
             break;
+        }
 
-        default: {
-            // Check if address is defined in device configs
-            BOOL address_mapping_found = FALSE;
-            int modbus_device_config_count = 0;
-            modbus_device_config_t *modbus_device_config = control_logic_modbus_device_configs_get(&modbus_device_config_count);
-            if (modbus_device_config != NULL) {
-                for (int i = 0; i < modbus_device_config_count; i++) {
-                    // debug(tag, "idx[%d], reg_address %d, function_code %d", i, _device_configs[i].reg_address, _device_configs[i].function_code);
-                    if (modbus_device_config[i].update_address == address && 
-                        modbus_device_config[i].function_code == MODBUS_FUNC_WRITE_SINGLE_REGISTER) {
-                        address_mapping_found = TRUE;
-                        ret = control_hardware_rs485_single_write(modbus_device_config[i].port, 
-                                                                modbus_device_config[i].baudrate, 
-                                                                modbus_device_config[i].slave_id, 
-                                                                modbus_device_config[i].reg_address, 
-                                                                value);                        
-                        // debug(tag, "write to modbus success: address %d, value %d, ret %d", address, value, ret);
-                        break;
-                    }
-                }
-            }
-            if (address_mapping_found) {
-                info(tag, "address %d, type %d, value %d, bridge to 485 device, ret = %d", address, type, value, ret);
-                bNeedSaveToFile = FALSE;
-            } else {
-                info(tag, "address %d, type %d, value %d, direct update to modbus table", address, type, value);
-                control_logic_update_to_modbus_table(address, type, &value);
-                ret = SUCCESS;
-                bNeedSaveToFile = TRUE;
-            }
+        case MODBUS_TYPE_UINT64: {
+            // 低位字在前,與 32 位元型別相同
+            uint64_t val = *(const uint64_t*)value;
+            words[0] = (uint16_t)(val & 0xFFFF);
+            words[1] = (uint16_t)((val >> 16) & 0xFFFF);
+            words[2] = (uint16_t)((val >> 32) & 0xFFFF);
+            words[3] = (uint16_t)((val >> 48) & 0xFFFF);
             break;
         }
-    }
 
-    if (bNeedSaveToFile == TRUE) {
-        ret = modbus_manager_data_mapping_save();
-        debug(tag, "modbus_manager_data_mapping_save, ret = %d", ret);
+        default:
+            break;
     }
-
-    return ret;
 }
 
 int control_logic_update_to_modbus_table(uint16_t address, uint8_t type, void *value)
@@ -1068,70 +2034,167 @@ int control_logic_update_to_modbus_table(uint16_t address, uint8_t type, void *v
     modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
     // debug(tag, "address: %d, type: %d, value: %d", address, type, *(uint16_t*)value);
 
+    uint8_t count = _modbus_table_type_words(type);
+
     if (mapping == NULL) {
         error(tag, "modbus_mapping_t is NULL");
         ret = FAIL;
     } else if (value == NULL) {
         error(tag, "value pointer is NULL");
         ret = FAIL;
-    } else if (address < mapping->start_registers || address >= mapping->start_registers + mapping->nb_registers) {
+    } else if (count == 0) {
+        error(tag, "invalid type: %d", type);
+        ret = FAIL;
+    } else if (address < mapping->start_registers || address + count > mapping->start_registers + mapping->nb_registers) {
         error(tag, "address %d is out of range", address);
         ret = FAIL;
     } else {
-        switch (type) {
-            case MODBUS_TYPE_INT16:
-                mapping->tab_registers[address] = *(int16_t*)value;
-                break;
+        uint16_t words[4] = {0};
 
-            case MODBUS_TYPE_UINT16:
-                mapping->tab_registers[address] = *(uint16_t*)value;
-                break;
+        _modbus_table_words_encode(type, value, words);
 
-            case MODBUS_TYPE_INT32: {
-                int32_t val = *(int32_t*)value;
-                mapping->tab_registers[address] = (uint16_t)(val & 0xFFFF);
-                mapping->tab_registers[address+1] = (uint16_t)((val >> 16) & 0xFFFF);
-                break;
-            }
+        _modbus_table_words_store(mapping->tab_registers, address, words, count);
+    }
 
-            case MODBUS_TYPE_UINT32: {
-                uint32_t val = *(uint32_t*)value;
-                mapping->tab_registers[address] = (uint16_t)(val & 0xFFFF);
-                mapping->tab_registers[address+1] = (uint16_t)((val >> 16) & 0xFFFF);
-                break;
-            }
+    return ret;
+}
 
-            case MODBUS_TYPE_FLOAT32: {
-                union {
-                    float f;
-                    uint32_t u32;
-                } float_converter;
-                float_converter.f = *(float*)value;
-                mapping->tab_registers[address] = (uint16_t)(float_converter.u32 & 0xFFFF);
-                mapping->tab_registers[address+1] = (uint16_t)((float_converter.u32 >> 16) & 0xFFFF);
-                break;
-            }
+int control_logic_update_value_to_modbus_table(uint16_t address, uint8_t type, uint32_t value)
+{
+    int ret = FAIL;
 
-            case MODBUS_TYPE_UINT64: {
-                // TODO: check if this is correct
-                uint64_t val = *(uint64_t*)value;
-                mapping->tab_registers[address] = (uint16_t)(val & 0xFFFF);
-                mapping->tab_registers[address+1] = (uint16_t)((val >> 16) & 0xFFFF);
-                mapping->tab_registers[address+2] = (uint16_t)((val >> 32) & 0xFFFF);
-                mapping->tab_registers[address+3] = (uint16_t)((val >> 48) & 0xFFFF);
-                break;
-            }
+    switch (type) {
+        case MODBUS_TYPE_INT16:
+        case MODBUS_TYPE_UINT16:
+        case MODBUS_TYPE_UINT16_LOWBYTE:
+        case MODBUS_TYPE_UINT16_HIGHBYTE: {
+            uint16_t val = (uint16_t)value;
+            ret = control_logic_update_to_modbus_table(address, MODBUS_TYPE_UINT16, &val);
+            break;
+        }
 
-            default:
-                error(tag, "invalid type: %d", type);
-                ret = FAIL;
-                break;
+        case MODBUS_TYPE_INT32:
+        case MODBUS_TYPE_UINT32:
+        case MODBUS_TYPE_FLOAT32:
+            // same two words whatever the interpretation
+            ret = control_logic_update_to_modbus_table(address, MODBUS_TYPE_UINT32, &value);
+            break;
+
+        case MODBUS_TYPE_UINT64: {
+            uint64_t val = value;
+            ret = control_logic_update_to_modbus_table(address, MODBUS_TYPE_UINT64, &val);
+            break;
         }
+
+        default:
+            error(tag, "invalid type: %d", type);
+            break;
     }
 
     return ret;
 }
 
+/**
+ * @brief 將分頁加入遞增排序且不重複的分頁清單
+ */
+static void _modbus_table_pages_add(uint32_t *pages, int *page_count, uint32_t page)
+{
+    int i = *page_count;
+
+    for (int k = 0; k < *page_count; k++) {
+        if (pages[k] == page) {
+            return;
+        }
+    }
+    while (i > 0 && pages[i - 1] > page) {
+        pages[i] = pages[i - 1];
+        i--;
+    }
+    pages[i] = page;
+    (*page_count)++;
+}
+
+/**
+ * @brief 批次更新資料到 Modbus 表格
+ *
+ * 實現邏輯:
+ * 1. 檢查並編碼所有資料,任一筆錯誤則整批不寫入
+ * 2. 所有數值都與表中相同時直接返回,不產生變更世代
+ * 3. 依遞增順序鎖住涉及的所有分頁(與其他寫入端相同順序,不會死鎖)
+ * 4. 寫入有改變的數值,全部記錄同一個變更世代後依遞減順序解鎖
+ */
+int control_logic_update_to_modbus_table_batch(const control_logic_modbus_write_t *writes, uint16_t count)
+{
+    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
+    uint16_t words[CONTROL_LOGIC_MODBUS_BATCH_MAX][4];
+    uint8_t word_count[CONTROL_LOGIC_MODBUS_BATCH_MAX];
+    uint32_t pages[CONTROL_LOGIC_MODBUS_BATCH_MAX * 2];
+    int page_count = 0;
+    bool changed = false;
+
+    if (mapping == NULL) {
+        error(tag, "modbus_mapping_t is NULL");
+        return FAIL;
+    }
+    if (writes == NULL || count == 0 || count > CONTROL_LOGIC_MODBUS_BATCH_MAX) {
+        error(tag, "invalid batch, count = %u", count);
+        return FAIL;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t address = writes[i].address;
+
+        word_count[i] = _modbus_table_type_words(writes[i].type);
+        if (word_count[i] == 0) {
+            error(tag, "invalid type: %d", writes[i].type);
+            return FAIL;
+        }
+        if (address < mapping->start_registers || address + word_count[i] > mapping->start_registers + mapping->nb_registers) {
+            error(tag, "address %d is out of range", address);
+            return FAIL;
+        }
+
+        _modbus_table_words_encode(writes[i].type, &writes[i].value, words[i]);
+        for (uint8_t w = 0; w < word_count[i] && !changed; w++) {
+            changed = (__atomic_load_n(&mapping->tab_registers[address + w], __ATOMIC_RELAXED) != words[i][w]);
+        }
+    }
+
+    if (!changed) {
+        return SUCCESS;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        _modbus_table_pages_add(pages, &page_count, _modbus_table_page(writes[i].address));
+        _modbus_table_pages_add(pages, &page_count, _modbus_table_page((uint32_t)writes[i].address + word_count[i] - 1));
+    }
+    for (int k = 0; k < page_count; k++) {
+        _modbus_table_page_write_lock(pages[k]);
+    }
+
+    uint32_t gen = __atomic_add_fetch(&_modbus_table_generation, 1, __ATOMIC_RELAXED);
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t *tab = &mapping->tab_registers[writes[i].address];
+        bool value_changed = false;
+
+        for (uint8_t w = 0; w < word_count[i]; w++) {
+            if (__atomic_load_n(&tab[w], __ATOMIC_RELAXED) != words[i][w]) {
+                __atomic_store_n(&tab[w], words[i][w], __ATOMIC_RELAXED);
+                value_changed = true;
+            }
+        }
+        if (value_changed) {
+            _modbus_table_mark_generation(writes[i].address, word_count[i], gen);
+        }
+    }
+
+    for (int k = page_count; k-- > 0; ) {
+        _modbus_table_page_write_unlock(pages[k]);
+    }
+
+    return SUCCESS;
+}
+
 int control_logic_load_from_modbus_table(uint16_t address, uint8_t type, void *data)
 {
     int ret = SUCCESS;
@@ -1141,59 +2204,156 @@ int control_logic_load_from_modbus_table(uint16_t address, uint8_t type, void *d
 
     // debug(tag, "control_logic_update_to_modbus_manager: %d, type: %d", address, type);
 
+    uint8_t count = _modbus_table_type_words(type);
+
     if (mapping == NULL) {
         error(tag, "modbus_mapping_t is NULL");
         ret = FAIL;
     } else if (data == NULL) {
         error(tag, "data pointer is NULL");
         ret = FAIL;
-    } else if (address < mapping->start_registers || address >= mapping->start_registers + mapping->nb_registers) {
+    } else if (count == 0) {
+        error(tag, "invalid type: %d", type);
+        ret = FAIL;
+    } else if (address < mapping->start_registers || address + count > mapping->start_registers + mapping->nb_registers) {
         error(tag, "address %d is out of range", address);
         ret = FAIL;
     } else {
+        uint16_t words[4] = {0};
+
+        _modbus_table_words_load(mapping->tab_registers, address, words, count);
+
         switch (type) {
             case MODBUS_TYPE_INT16:
-                *(int16_t*)data = mapping->tab_registers[address];
+                *(int16_t*)data = (int16_t)words[0];
                 break;
 
             case MODBUS_TYPE_UINT16:
-                *(uint16_t*)data = mapping->tab_registers[address];
+                *(uint16_t*)data = words[0];
                 break;
 
             case MODBUS_TYPE_INT32:
-            case MODBUS_TYPE_UINT32: {
-                AppConvertUint32_16 conv;
-                conv.words.u16_byte[0] = mapping->tab_registers[address];
-                conv.words.u16_byte[1] = mapping->tab_registers[address+1];
-                memcpy((uint8_t*)data, (uint8_t*)&conv, 4);
-                break;
-            }
-
+            case MODBUS_TYPE_UINT32:
             case MODBUS_TYPE_FLOAT32: {
                 AppConvertUint32_16 conv;
-                conv.words.u16_byte[0] = mapping->tab_registers[address];
-                conv.words.u16_byte[1] = mapping->tab_registers[address+1];
+                conv.words.u16_byte[0] = words[0];
+                conv.words.u16_byte[1] = words[1];
                 memcpy((uint8_t*)data, (uint8_t*)&conv, 4);
                 break;
             }
 
             case MODBUS_TYPE_UINT64: {
-                // TODO: check if this is correct
+                // 低位字在前,與寫入端 _modbus_table_words_encode() 相同
                 AppConvert64_16 conv;
-                conv.words.u16_byte[0] = mapping->tab_registers[address];
-                conv.words.u16_byte[1] = mapping->tab_registers[address+1];
-                conv.words.u16_byte[2] = mapping->tab_registers[address+2];
-                conv.words.u16_byte[3] = mapping->tab_registers[address+3];
+                conv.words.u16_byte[0] = words[0];
+                conv.words.u16_byte[1] = words[1];
+                conv.words.u16_byte[2] = words[2];
+                conv.words.u16_byte[3] = words[3];
                 memcpy((uint8_t*)data, (uint8_t*)&conv, 8);
                 break;
             }
 
             default:
-                error(tag, "invalid type: %d", type);
-                ret = FAIL;
                 break;
         }
     }
 
     return ret;
 }
+
+/**
+ * @brief 從 Modbus 表格讀取一段連續暫存器
+ *
+ * 實現邏輯:
+ * 以 _modbus_table_range_load() 複製,範圍內任一分頁在複製期間有寫入則重新複製。
+ */
+int control_logic_load_from_modbus_table_range(uint16_t address, uint16_t count, uint16_t *words)
+{
+    int ret = SUCCESS;
+
+    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
+
+    if (mapping == NULL) {
+        error(tag, "modbus_mapping_t is NULL");
+        ret = FAIL;
+    } else if (words == NULL || count == 0 || count > CONTROL_LOGIC_MODBUS_RANGE_MAX) {
+        error(tag, "invalid range, count = %u", count);
+        ret = FAIL;
+    } else if (address < mapping->start_registers || address + count > mapping->start_registers + mapping->nb_registers) {
+        error(tag, "address %d is out of range", address);
+        ret = FAIL;
+    } else {
+        _modbus_table_range_load(mapping->tab_registers, address, words, count);
+    }
+
+    return ret;
+}
+
+uint32_t control_logic_modbus_table_generation(void)
+{
+    return __atomic_load_n(&_modbus_table_generation, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief 列出指定世代之後數值改變的暫存器
+ *
+ * 實現邏輯:
+ * 1. 先取得目前世代,只回報世代介於 (since, 目前世代] 的暫存器
+ * 2. since 為 0(新訂閱者)或大於目前世代(重新啟動或世代繞回)時回報整張表,
+ *    包含從未改變的暫存器
+ * 3. 各分頁以 seqlock 讀取端掃描,分頁世代不大於 since 時直接跳過
+ * 4. 掃描期間分頁有寫入則重新掃描該分頁
+ *
+ * 寫入端在分頁寫入鎖內取得世代,等待分頁序號為偶數後,不大於目前世代的
+ * 變更必定可見;之後才發生的變更留待下次以新的世代查詢。
+ */
+int control_logic_modbus_table_changes(uint32_t since, uint32_t *generation, uint16_t *addresses, uint16_t *words, int max)
+{
+    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
+
+    if (mapping == NULL || generation == NULL || addresses == NULL || words == NULL || max <= 0) {
+        return FAIL;
+    }
+
+    uint32_t now = __atomic_load_n(&_modbus_table_generation, __ATOMIC_ACQUIRE);
+    bool full = (since == 0 || since > now);
+    uint32_t end = (uint32_t)mapping->start_registers + (uint32_t)mapping->nb_registers;
+    if (end > MODBUS_RO_REGISTERS) {
+        end = MODBUS_RO_REGISTERS;
+    }
+
+    int count = 0;
+    for (uint32_t base = mapping->start_registers; base < end && count < max; ) {
+        uint32_t page = _modbus_table_page(base);
+        uint32_t page_end = (base / MODBUS_TABLE_SEQLOCK_PAGE_SIZE + 1) * MODBUS_TABLE_SEQLOCK_PAGE_SIZE;
+        if (page_end > end) {
+            page_end = end;
+        }
+
+        if (full || now != since) {
+            int page_start_count = count;
+            uint32_t s = 0;
+            do {
+                count = page_start_count;
+                s = _modbus_table_page_read_begin(page);
+                if (!full && __atomic_load_n(&_modbus_table_page_gen[page], __ATOMIC_RELAXED) <= since) {
+                    break;
+                }
+                for (uint32_t a = base; a < page_end && count < max; a++) {
+                    uint32_t gen = __atomic_load_n(&_modbus_table_register_gen[a], __ATOMIC_RELAXED);
+                    if (full || (gen > since && gen <= now)) {
+                        addresses[count] = (uint16_t)a;
+                        words[count] = __atomic_load_n(&mapping->tab_registers[a], __ATOMIC_RELAXED);
+                        count++;
+                    }
+                }
+            } while (_modbus_table_page_read_retry(page, s));
+        }
+
+        base = page_end;
+    }
+
+    *generation = now;
+
+    return count;
+}
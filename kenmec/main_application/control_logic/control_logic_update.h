@@ -5,7 +5,7 @@
  * 本文件定義控制邏輯與 Modbus 表格之間的資料同步介面。
  * 主要功能包括：
  * - 初始化更新機制
- * - 將資料更新到 Modbus 表格
+ * - 將資料更新到 Modbus 表格(單筆或整批同時生效)
  * - 從 Modbus 表格載入資料
  */
 
@@ -14,6 +14,44 @@
 
 // #include "dexatek/main_application/managers/modbus_manager/modbus_manager.h"
 
+#include <stdint.h>
+
+/* 單次連續讀取的最大暫存器數量（與 Modbus 單次讀取上限相同） */
+#define CONTROL_LOGIC_MODBUS_RANGE_MAX 125
+
+/* 單次批次寫入的最大筆數 */
+#define CONTROL_LOGIC_MODBUS_BATCH_MAX 32
+
+/**
+ * @brief 批次寫入的一筆資料
+ *
+ * 依 type 使用 value 中對應的欄位(MODBUS_TYPE_INT16 用 i16,UINT16 用 u16,依此類推)
+ */
+typedef struct {
+    uint16_t address;       /* Modbus 表格位址 */
+    uint8_t type;           /* 資料類型(MODBUS_TYPE_*) */
+    union {
+        int16_t i16;
+        uint16_t u16;
+        int32_t i32;
+        uint32_t u32;
+        float f32;
+        uint64_t u64;
+    } value;
+} control_logic_modbus_write_t;
+
+/**
+ * @brief HID 埠輪詢狀態
+ */
+typedef struct {
+    uint32_t generation;    /* 完成的輪數,每輪數據寫入 Modbus 表後遞增 */
+    uint16_t pid;           /* 最後一輪看到的板子 PID,0 表示沒有板子 */
+    uint32_t period_ms;     /* 固定輪詢週期;自適應排程時為偵測插拔的最長間隔 */
+    uint32_t failures;      /* 有讀取失敗的輪數 */
+    uint32_t cycle_ms;      /* 最後一輪耗時 */
+    uint64_t update_ms;     /* 最後一輪完成時間(time_get_current_ms()) */
+} control_logic_port_status_t;
+
 /**
  * @brief 初始化控制邏輯更新模組
  *
@@ -24,6 +62,29 @@
  */
 int control_logic_update_init(void);
 
+/**
+ * @brief 設定 HID 埠的輪詢週期
+ *
+ * 每個埠由自己的執行緒輪詢,週期互不影響;新週期從下一輪開始生效。
+ * 設定後該埠每週期讀取板子的全部數據,不再使用自適應排程(control_logic_poll_plan)。
+ *
+ * @param port HID 埠
+ * @param period_ms 輪詢週期(毫秒),不可為 0
+ * @return 成功返回 0,參數錯誤返回 FAIL
+ */
+int control_logic_update_port_period_set(uint16_t port, uint32_t period_ms);
+
+/**
+ * @brief 取得 HID 埠的輪詢狀態
+ *
+ * 讀到的 generation 改變後,該輪寫入 Modbus 表的數據都已可見。
+ *
+ * @param port HID 埠
+ * @param status 輸出輪詢狀態
+ * @return 成功返回 0,參數錯誤返回 FAIL
+ */
+int control_logic_update_port_status_get(uint16_t port, control_logic_port_status_t *status);
+
 /**
  * @brief 更新資料到 Modbus 表格
  *
@@ -37,6 +98,36 @@ int control_logic_update_init(void);
  */
 int control_logic_update_to_modbus_table(uint16_t address, uint8_t type, void *value);
 
+/**
+ * @brief 以 32 位元數值更新資料到 Modbus 表格
+ *
+ * 供 modbus_manager 寫入回呼與持久化日誌重播使用,數值依資料類型取用:
+ * - INT16/UINT16 取低 16 位元
+ * - UINT16_LOWBYTE/UINT16_HIGHBYTE 在表中以一個 UINT16 字保存,同樣取低 16 位元
+ * - INT32/UINT32/FLOAT32 為 32 位元原始值
+ * - UINT64 為零擴展後的 64 位元值
+ *
+ * @param address Modbus 表格位址
+ * @param type 資料類型
+ * @param value 32 位元數值
+ * @return 成功返回 0，失敗返回負值錯誤碼
+ */
+int control_logic_update_value_to_modbus_table(uint16_t address, uint8_t type, uint32_t value);
+
+/**
+ * @brief 批次更新資料到 Modbus 表格
+ *
+ * 整批寫入在同一次發布中生效: 涉及的分頁全部上鎖後才寫入,數值有改變的暫存器
+ * 共用一個變更世代。以 control_logic_load_from_modbus_table_range() 讀取的一段
+ * 暫存器只會看到整批寫入之前或之後的數值,不會看到只更新一部分的板子。
+ * 任一筆參數錯誤時整批都不寫入。
+ *
+ * @param writes 要寫入的資料
+ * @param count 筆數(1 .. CONTROL_LOGIC_MODBUS_BATCH_MAX)
+ * @return 成功返回 0,失敗返回負值錯誤碼
+ */
+int control_logic_update_to_modbus_table_batch(const control_logic_modbus_write_t *writes, uint16_t count);
+
 /**
  * @brief 從 Modbus 表格載入資料
  *
@@ -50,4 +141,44 @@ int control_logic_update_to_modbus_table(uint16_t address, uint8_t type, void *v
  */
 int control_logic_load_from_modbus_table(uint16_t address, uint8_t type, void *data);
 
+/**
+ * @brief 從 Modbus 表格讀取一段連續暫存器
+ *
+ * 以 seqlock 讀取端複製整段暫存器，範圍內跨越多個暫存器的數值（32/64 位元）
+ * 不會只讀到一半。Modbus 伺服器回應讀取請求時亦走相同路徑。
+ *
+ * @param address 起始位址
+ * @param count 暫存器數量（1 .. CONTROL_LOGIC_MODBUS_RANGE_MAX）
+ * @param words 輸出暫存器數值
+ * @return 成功返回 0，失敗返回負值錯誤碼
+ */
+int control_logic_load_from_modbus_table_range(uint16_t address, uint16_t count, uint16_t *words);
+
+/**
+ * @brief 取得 Modbus 表目前的變更世代
+ *
+ * 每次有暫存器數值改變(本地更新或 Modbus 主站寫入)世代即遞增,
+ * 數值不變的寫入不改變世代。
+ *
+ * @return 目前世代,從未有變更時為 0
+ */
+uint32_t control_logic_modbus_table_generation(void);
+
+/**
+ * @brief 列出指定世代之後數值改變的暫存器
+ *
+ * 回傳的數值為查詢當下的表中數值;同一暫存器多次改變只列出一次。
+ * 將 *generation 作為下次查詢的 since,即可取得期間的所有變更。
+ * since 為 0 或大於目前世代(程式重新啟動或世代繞回後的舊世代)時列出整張表,
+ * 讓新訂閱者與重新連線者從完整的表開始。
+ *
+ * @param since 上次查詢得到的世代,0 表示新訂閱者
+ * @param generation 輸出本次查詢涵蓋到的世代
+ * @param addresses 輸出暫存器位址
+ * @param words 輸出暫存器數值
+ * @param max 輸出陣列容量,超過時只列出前 max 個
+ * @return 改變的暫存器數量,失敗返回負值錯誤碼
+ */
+int control_logic_modbus_table_changes(uint32_t since, uint32_t *generation, uint16_t *addresses, uint16_t *words, int max);
+
 #endif /* CONTROL_LOGIC_UPDATE_H */ 
\ No newline at end of file
@@ -57,6 +57,7 @@
 #include "cJSON.h"
 
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/pid_controller.h"
 
 #define CONFIG_REGISTER_FILE_PATH "/usrdata/register_configs_ls80_1.json"
 #define CONFIG_REGISTER_LIST_SIZE 19  // 增加 2 個溫度限制寄存器 (46001, 46002)
@@ -85,17 +86,6 @@ typedef struct {
     time_t timestamp;
 } sensor_data_t;
 
-typedef struct {
-    float kp;
-    float ki;
-    float kd;
-    float integral;
-    float previous_error;
-    time_t previous_time;
-    float output_min;
-    float output_max;
-} pid_controller_t;
-
 typedef struct {
     float valve_opening;       // 比例閥開度 0-100%
 } control_output_t;
@@ -104,11 +94,9 @@ static pid_controller_t temperature_pid = {
     .kp = 15.0f,
     .ki = 0.8f,
     .kd = 2.5f,
-    .integral = 0.0f,
-    .previous_error = 0.0f,
-    .previous_time = 0,
     .output_min = 0.0f,
-    .output_max = 100.0f
+    .output_max = 100.0f,
+    .derivative_tau = PID_CONTROLLER_DERIVATIVE_TAU_DEFAULT
 };
 
 // 追蹤 enable 狀態，用於檢測從啟用變為停用
@@ -622,43 +610,15 @@ static void emergency_shutdown(void) {
  * PID控制器計算
  */
 
- static float calculate_pid_output(pid_controller_t *pid, float setpoint, float current_value) {
-    time_t current_time = time(NULL);
-    float delta_time = (current_time > pid->previous_time) ? (current_time - pid->previous_time) : 1.0f;
-    
+static float calculate_pid_output(pid_controller_t *pid, float setpoint, float current_value) {
     // 計算控制誤差
     float error = current_value - setpoint;
-   
-    // 比例項
-    float proportional = pid->kp * error;
-    
-    // 積分項 - 防止積分飽和
-    pid->integral += error * delta_time;
-    if (pid->integral > pid->output_max / pid->ki) {
-        pid->integral = pid->output_max / pid->ki;
-    } else if (pid->integral < pid->output_min / pid->ki) {
-        pid->integral = pid->output_min / pid->ki;
-    }
-    float integral_term = pid->ki * pid->integral;
-    
-    // 微分項
-    float derivative = (delta_time > 0) ? (error - pid->previous_error) / delta_time : 0.0f;
-    float derivative_term = pid->kd * derivative;
-    
-    // PID輸出計算
-    float output = proportional + integral_term + derivative_term;
-    
-    // 輸出限制
-    if (output > pid->output_max) output = pid->output_max;
-    if (output < pid->output_min) output = pid->output_min;
-    
-    // 更新狀態
-    pid->previous_error = error;
-    pid->previous_time = current_time;
-    
+
+    float output = pid_controller_update(pid, error);
+
     debug(debug_tag, "PID計算 - 誤差: %.2f, P: %.2f, I: %.2f, D: %.2f, 輸出: %.2f", 
-          error, proportional, integral_term, derivative_term, output);
-    
+          error, pid->p_term, pid->i_term, pid->d_term, output);
+
     return output;
 }
 
@@ -667,9 +627,7 @@ static void emergency_shutdown(void) {
  */
 /*
 static void reset_pid_controller(pid_controller_t *pid) {
-    pid->integral = 0.0f;
-    pid->previous_error = 0.0f;
-    pid->previous_time = time(NULL);
+    pid_controller_reset(pid);
     debug(debug_tag, "PID控制器已重置");
 }
 */
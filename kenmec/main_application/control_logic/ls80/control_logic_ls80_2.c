@@ -105,6 +105,7 @@
 
 #include "dexatek/main_application/include/application_common.h"
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/pid_controller.h"
 
 /*---------------------------------------------------------------------------
                             Defined Constants
@@ -164,18 +165,6 @@ typedef struct {
     time_t timestamp;
 } pressure_sensor_data_t;
 
-// PID 控制器結構
-typedef struct {
-    float kp;                       // 比例增益
-    float ki;                       // 積分增益
-    float kd;                       // 微分增益
-    float integral;                 // 積分項累積
-    float previous_error;           // 前一次誤差
-    time_t previous_time;           // 前一次計算時間
-    float output_min;               // 輸出最小值
-    float output_max;               // 輸出最大值
-} pressure_pid_controller_t;
-
 // 泵浦控制輸出結構
 typedef struct {
     int active_pumps[2];      // 泵浦啟用狀態
@@ -183,15 +172,13 @@ typedef struct {
 } pump_control_output_t;
 
 // PID 控制器初始化（全局變數）
-static pressure_pid_controller_t pressure_pid = {
+static pid_controller_t pressure_pid = {
     .kp = 2.5f,               // 比例增益（優化：從 2.0 → 2.5，參照 ls80_3）
-    .ki = 0.4f,               // 積分增益（優化：從 0.5 → 0.4，增大積分限幅上限到 250）
+    .ki = 0.0f,               // 積分增益（目前停用，僅 P + D；先前調校值 0.4）
     .kd = 0.8f,               // 微分增益（優化：從 0.1 → 0.8，增強阻尼）
-    .integral = 0.0f,
-    .previous_error = 0.0f,
-    .previous_time = 0,
     .output_min = 0.0f,
-    .output_max = 100.0f
+    .output_max = 100.0f,
+    .derivative_tau = PID_CONTROLLER_DERIVATIVE_TAU_DEFAULT
 };
 
 // 追蹤控制邏輯啟用狀態，用於偵測 1→0 轉換
@@ -209,8 +196,8 @@ static uint16_t saved_pump2_manual_mode = 0xFFFF;
                         Function Declarations
  ---------------------------------------------------------------------------*/
 static int read_pressure_sensor_data(pressure_sensor_data_t *data);
-static float calculate_pressure_pid_output(pressure_pid_controller_t *pid, float setpoint, float current_value);
-static void reset_pressure_pid_controller(pressure_pid_controller_t *pid);
+static float calculate_pressure_pid_output(pid_controller_t *pid, float setpoint, float current_value);
+static void reset_pressure_pid_controller(pid_controller_t *pid);
 static int execute_manual_pressure_control(float target_pressure_diff);
 static int execute_automatic_pressure_control(const pressure_sensor_data_t *data);
 static void calculate_pump_control(float pid_output, pump_control_output_t *output);
@@ -605,43 +592,14 @@ static int read_pressure_sensor_data(pressure_sensor_data_t *data) {
 /**
  * PID 控制器計算（參照 ls80_3.c）
  */
-static float calculate_pressure_pid_output(pressure_pid_controller_t *pid, float setpoint, float current_value) {
-    time_t current_time = time(NULL);
-    float delta_time = (current_time > pid->previous_time) ? (current_time - pid->previous_time) : 1.0f;
-
+static float calculate_pressure_pid_output(pid_controller_t *pid, float setpoint, float current_value) {
     // 計算控制誤差
     float error = setpoint - current_value;
 
-    // 比例項
-    float proportional = pid->kp * error;
-
-    // 積分項 - 防止積分飽和（簡化邏輯，參照 ls80_3）
-    pid->integral += error * delta_time;
-    if (pid->integral > pid->output_max / pid->ki) {
-        pid->integral = pid->output_max / pid->ki;
-    } else if (pid->integral < pid->output_min / pid->ki) {
-        pid->integral = pid->output_min / pid->ki;
-    }
-    float integral_term = pid->ki * pid->integral;
-
-    // 微分項
-    float derivative = (delta_time > 0) ? (error - pid->previous_error) / delta_time : 0.0f;
-    float derivative_term = pid->kd * derivative;
-
-    // PID輸出計算
-    //float output = proportional + integral_term + derivative_term;
-    float output = proportional + derivative_term;
-
-    // 輸出限制
-    if (output > pid->output_max) output = pid->output_max;
-    if (output < pid->output_min) output = pid->output_min;
-
-    // 更新狀態
-    pid->previous_error = error;
-    pid->previous_time = current_time;
+    float output = pid_controller_update(pid, error);
 
     debug(debug_tag, "壓差PID25 - 誤差: %.2f, P: %.2f, I: %.2f, D: %.2f, 輸出: %.2f%%",
-          error, proportional, integral_term, derivative_term, output);
+          error, pid->p_term, pid->i_term, pid->d_term, output);
 
     return output;
 }
@@ -649,10 +607,8 @@ static float calculate_pressure_pid_output(pressure_pid_controller_t *pid, float
 /**
  * 重置 PID 控制器
  */
-static void reset_pressure_pid_controller(pressure_pid_controller_t *pid) {
-    pid->integral = 0.0f;
-    pid->previous_error = 0.0f;
-    pid->previous_time = time(NULL);
+static void reset_pressure_pid_controller(pid_controller_t *pid) {
+    pid_controller_reset(pid);
     debug(debug_tag, "壓差PID控制器已重置");
 }
 
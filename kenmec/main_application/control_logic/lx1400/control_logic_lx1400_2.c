@@ -52,6 +52,7 @@
 #include "dexatek/main_application/include/application_common.h"
 
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/pid_controller.h"
 
 /*---------------------------------------------------------------------------
                             Defined Constants
@@ -146,17 +147,6 @@ typedef struct {
     time_t timestamp;
 } pressure_sensor_data_t;
 
-typedef struct {
-    float kp;                       // 比例增益
-    float ki;                       // 積分增益
-    float kd;                       // 微分增益
-    float integral;                 // 積分項累積
-    float previous_error;           // 前一次誤差
-    time_t previous_time;           // 前一次計算時間
-    float output_min;               // 輸出最小值
-    float output_max;               // 輸出最大值
-} pressure_pid_controller_t;
-
 typedef struct {
     int pump1_running;              // Pump1運行狀態
     int pump2_running;              // Pump2運行狀態
@@ -176,15 +166,15 @@ typedef struct {
 } pressure_safety_result_t;
 
 // 全域變數
-static pressure_pid_controller_t pressure_pid = {
+static pid_controller_t pressure_pid = {
     .kp = 2.0f,                    // 比例增益 (根據規格)
     .ki = 0.5f,                    // 積分增益
     .kd = 0.1f,                    // 微分增益
-    .integral = 0.0f,
-    .previous_error = 0.0f,
-    .previous_time = 0,
     .output_min = 0.0f,
-    .output_max = 100.0f
+    .output_max = 100.0f,
+    .integral_min = -50.0f,        // 積分累積限制 (根據規格)
+    .integral_max = 50.0f,
+    .derivative_tau = PID_CONTROLLER_DERIVATIVE_TAU_DEFAULT
 };
 
 /*---------------------------------------------------------------------------
@@ -200,8 +190,8 @@ static int check_control_mode(void);
 static int check_manual_mode(void);
 static int execute_manual_pressure_control(float target_pressure_diff);
 static int execute_automatic_pressure_control(const pressure_sensor_data_t *data);
-static float calculate_pressure_pid_output(pressure_pid_controller_t *pid, float setpoint, float current_value);
-static void reset_pressure_pid_controller(pressure_pid_controller_t *pid);
+static float calculate_pressure_pid_output(pid_controller_t *pid, float setpoint, float current_value);
+static void reset_pressure_pid_controller(pid_controller_t *pid);
 static int calculate_pump_coordination_strategy(float pid_output, pump_coordination_strategy_t *strategy);
 static int execute_pump_coordination_control(const pump_coordination_strategy_t *strategy);
 static int adjust_proportional_valve(float pid_output, float current_valve_position);
@@ -619,53 +609,23 @@ static int execute_automatic_pressure_control(const pressure_sensor_data_t *data
 /**
  * 壓差PID控制器計算
  */
-static float calculate_pressure_pid_output(pressure_pid_controller_t *pid, float setpoint, float current_value) {
-    time_t current_time = time(NULL);
-    float delta_time = (current_time > pid->previous_time) ? (current_time - pid->previous_time) : 1.0f;
-    
+static float calculate_pressure_pid_output(pid_controller_t *pid, float setpoint, float current_value) {
     // 計算控制誤差
     float error = setpoint - current_value;
-    
-    // 比例項
-    float proportional = pid->kp * error;
-    
-    // 積分項 - 防積分飽和 (根據規格實現)
-    pid->integral += error * delta_time;
-    if (pid->integral > 50.0f) {
-        pid->integral = 50.0f;
-    } else if (pid->integral < -50.0f) {
-        pid->integral = -50.0f;
-    }
-    float integral_term = pid->ki * pid->integral;
-    
-    // 微分項
-    float derivative = (delta_time > 0) ? (error - pid->previous_error) / delta_time : 0.0f;
-    float derivative_term = pid->kd * derivative;
-    
-    // PID輸出計算
-    float output = proportional + integral_term + derivative_term;
-    
-    // 輸出限制
-    if (output > pid->output_max) output = pid->output_max;
-    if (output < pid->output_min) output = pid->output_min;
-    
-    // 更新狀態
-    pid->previous_error = error;
-    pid->previous_time = current_time;
-    
+
+    float output = pid_controller_update(pid, error);
+
     debug(debug_tag, "壓差PID - 誤差: %.3f, P: %.2f, I: %.2f, D: %.2f, 輸出: %.1f%%",
-          error, proportional, integral_term, derivative_term, output);
-    
+          error, pid->p_term, pid->i_term, pid->d_term, output);
+
     return output;
 }
 
 /**
  * 重置壓差PID控制器
  */
-static void reset_pressure_pid_controller(pressure_pid_controller_t *pid) {
-    pid->integral = 0.0f;
-    pid->previous_error = 0.0f;
-    pid->previous_time = time(NULL);
+static void reset_pressure_pid_controller(pid_controller_t *pid) {
+    pid_controller_reset(pid);
     debug(debug_tag, "壓差PID控制器已重置");
 }
 
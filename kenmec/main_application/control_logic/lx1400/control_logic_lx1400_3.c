@@ -43,6 +43,7 @@
 #include "dexatek/main_application/include/application_common.h"
 
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/pid_controller.h"
 
 /*---------------------------------------------------------------------------
                             Defined Constants
@@ -118,17 +119,6 @@ typedef struct {
     time_t timestamp;
 } flow_sensor_data_t;
 
-typedef struct {
-    float kp;                    // 比例增益
-    float ki;                    // 積分增益
-    float kd;                    // 微分增益
-    float integral;              // 積分項累積
-    float previous_error;        // 前一次誤差
-    time_t previous_time;        // 前一次計算時間
-    float output_min;            // 輸出最小值
-    float output_max;            // 輸出最大值
-} flow_pid_controller_t;
-
 typedef struct {
     flow_tracking_mode_t tracking_mode;  // 追蹤模式
     float target_flow_rate;              // 目標流量設定 (Fset)
@@ -144,15 +134,13 @@ typedef struct {
 } flow_control_output_t;
 
 // 全域變數
-static flow_pid_controller_t flow_pid = {
+static pid_controller_t flow_pid = {
     .kp = 2.5f,                  // 流量控制比例增益
     .ki = 0.4f,                  // 流量控制積分增益
     .kd = 0.8f,                  // 流量控制微分增益
-    .integral = 0.0f,
-    .previous_error = 0.0f,
-    .previous_time = 0,
     .output_min = 0.0f,
-    .output_max = 100.0f
+    .output_max = 100.0f,
+    .derivative_tau = PID_CONTROLLER_DERIVATIVE_TAU_DEFAULT
 };
 
 static flow_control_config_t flow_config = {
@@ -171,9 +159,9 @@ static int read_flow_sensor_data(flow_sensor_data_t *data);
 static flow_safety_status_t perform_flow_safety_checks(const flow_sensor_data_t *data, float target_flow);
 static void emergency_flow_shutdown(void);
 static float calculate_flow_tracking_target(const flow_sensor_data_t *data);
-static float calculate_flow_pid_output(flow_pid_controller_t *pid, float setpoint, float current_value);
-static void reset_flow_pid_controller(flow_pid_controller_t *pid);
-static void adaptive_flow_pid_tuning(flow_pid_controller_t *pid, float error, float error_percentage);
+static float calculate_flow_pid_output(pid_controller_t *pid, float setpoint, float current_value);
+static void reset_flow_pid_controller(pid_controller_t *pid);
+static void adaptive_flow_pid_tuning(pid_controller_t *pid, float error, float error_percentage);
 static int execute_manual_flow_control_mode(float target_flow);
 static int execute_automatic_flow_control_mode(const flow_sensor_data_t *data);
 static void calculate_basic_pump_control(float pid_output, flow_control_output_t *output);
@@ -564,60 +552,30 @@ static void emergency_flow_shutdown(void) {
 /**
  * 流量PID控制器計算
  */
-static float calculate_flow_pid_output(flow_pid_controller_t *pid, float setpoint, float current_value) {
-    time_t current_time = time(NULL);
-    float delta_time = (current_time > pid->previous_time) ? (current_time - pid->previous_time) : 1.0f;
-    
+static float calculate_flow_pid_output(pid_controller_t *pid, float setpoint, float current_value) {
     // 計算控制誤差
     float error = setpoint - current_value;
-    
-    // 比例項
-    float proportional = pid->kp * error;
-    
-    // 積分項 - 防止積分飽和
-    pid->integral += error * delta_time;
-    if (pid->integral > pid->output_max / pid->ki) {
-        pid->integral = pid->output_max / pid->ki;
-    } else if (pid->integral < pid->output_min / pid->ki) {
-        pid->integral = pid->output_min / pid->ki;
-    }
-    float integral_term = pid->ki * pid->integral;
-    
-    // 微分項
-    float derivative = (delta_time > 0) ? (error - pid->previous_error) / delta_time : 0.0f;
-    float derivative_term = pid->kd * derivative;
-    
-    // PID輸出計算
-    float output = proportional + integral_term + derivative_term;
-    
-    // 輸出限制
-    if (output > pid->output_max) output = pid->output_max;
-    if (output < pid->output_min) output = pid->output_min;
-    
-    // 更新狀態
-    pid->previous_error = error;
-    pid->previous_time = current_time;
-    
+
+    float output = pid_controller_update(pid, error);
+
     debug(debug_tag, "流量PID - 誤差: %.2f, P: %.2f, I: %.2f, D: %.2f, 輸出: %.2f", 
-          error, proportional, integral_term, derivative_term, output);
-    
+          error, pid->p_term, pid->i_term, pid->d_term, output);
+
     return output;
 }
 
 /**
  * 重置流量PID控制器
  */
-static void reset_flow_pid_controller(flow_pid_controller_t *pid) {
-    pid->integral = 0.0f;
-    pid->previous_error = 0.0f;
-    pid->previous_time = time(NULL);
+static void reset_flow_pid_controller(pid_controller_t *pid) {
+    pid_controller_reset(pid);
     debug(debug_tag, "流量PID控制器已重置");
 }
 
 /**
  * 自適應流量PID參數調整
  */
-static void adaptive_flow_pid_tuning(flow_pid_controller_t *pid, float error, float error_percentage) {
+static void adaptive_flow_pid_tuning(pid_controller_t *pid, float error, float error_percentage) {
     float abs_error = fabs(error);
     
     if (error_percentage > 15.0f) {
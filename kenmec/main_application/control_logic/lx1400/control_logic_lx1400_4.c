@@ -39,6 +39,7 @@
 #include "dexatek/main_application/include/application_common.h"
 
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/pid_controller.h"
 
 // LX1400T 泵浦控制程式
 
@@ -158,17 +159,6 @@ typedef enum {
     CONTROL_MODE_PRESSURE          // 壓差控制模式
 } control_mode_t;
 
-// PID控制器
-typedef struct {
-    float kp, ki, kd;              // PID參數
-    float setpoint;                // 設定值
-    float integral;                // 積分項
-    float last_error;              // 上次誤差
-    float output;                  // 輸出
-    float output_min, output_max;  // 輸出限制
-    bool enabled;                  // 是否啟用
-} pid_controller_t;
-
 // 單台泵浦狀態
 typedef struct {
     uint8_t pump_id;               // 泵浦編號 (1-3)
@@ -240,8 +230,6 @@ static bool manual_mode_enable = false;
  ---------------------------------------------------------------------------*/
 // PID控制函數
 static void pid_init(pid_controller_t* pid, float kp, float ki, float kd);
-static float pid_calculate(pid_controller_t* pid, float process_value, float dt);
-// static void pid_reset(pid_controller_t* pid);
 
 // 系統數據讀取
 static bool read_system_data(simple_pump_controller_t* controller);
@@ -253,8 +241,8 @@ static void set_pump_run_command(uint8_t pump_id, bool run);
 
 // 控制邏輯函數
 static void execute_manual_control(simple_pump_controller_t* controller);
-static void execute_flow_control(simple_pump_controller_t* controller, float dt);
-static void execute_pressure_control(simple_pump_controller_t* controller, float dt);
+static void execute_flow_control(simple_pump_controller_t* controller);
+static void execute_pressure_control(simple_pump_controller_t* controller);
 
 // Modbus通信函數 (透過 control_hardware 實現)
 static uint16_t read_holding_register(uint32_t address);
@@ -270,59 +258,11 @@ static bool write_holding_register(uint32_t address, uint16_t value);
 
 // 初始化PID控制器
 static void pid_init(pid_controller_t* pid, float kp, float ki, float kd) {
-    pid->kp = kp;
-    pid->ki = ki;
-    pid->kd = kd;
-    pid->setpoint = 0.0f;
-    pid->integral = 0.0f;
-    pid->last_error = 0.0f;
-    pid->output = 0.0f;
-    pid->output_min = PID_OUTPUT_MIN;
-    pid->output_max = PID_OUTPUT_MAX;
-    pid->enabled = false;
+    pid_controller_init(pid, kp, ki, kd, PID_OUTPUT_MIN, PID_OUTPUT_MAX);
+    pid->integral_min = -PID_INTEGRAL_MAX;
+    pid->integral_max = PID_INTEGRAL_MAX;
 }
 
-// PID計算
-static float pid_calculate(pid_controller_t* pid, float process_value, float dt) {
-    if (!pid->enabled || dt <= 0.0f) {
-        return 0.0f;
-    }
-    
-    float error = pid->setpoint - process_value;
-    
-    // 比例項
-    float proportional = pid->kp * error;
-    
-    // 積分項
-    pid->integral += error * dt;
-    
-    // 積分限幅防止飽和
-    if (pid->integral > PID_INTEGRAL_MAX) pid->integral = PID_INTEGRAL_MAX;
-    if (pid->integral < -PID_INTEGRAL_MAX) pid->integral = -PID_INTEGRAL_MAX;
-    
-    float integral = pid->ki * pid->integral;
-    
-    // 微分項
-    float derivative = pid->kd * (error - pid->last_error) / dt;
-    pid->last_error = error;
-    
-    // PID輸出
-    pid->output = proportional + integral + derivative;
-    
-    // 輸出限幅
-    if (pid->output > pid->output_max) pid->output = pid->output_max;
-    if (pid->output < pid->output_min) pid->output = pid->output_min;
-    
-    return pid->output;
-}
-
-// 重置PID控制器
-// static void pid_reset(pid_controller_t* pid) {
-//     pid->integral = 0.0f;
-//     pid->last_error = 0.0f;
-//     pid->output = 0.0f;
-// }
-
 // ========================================================================================
 // Modbus通信實現 (透過 control_hardware 模組)
 // ========================================================================================
@@ -538,12 +478,11 @@ static void execute_manual_control(simple_pump_controller_t* controller) {
 }
 
 // 流量控制模式
-static void execute_flow_control(simple_pump_controller_t* controller, float dt) {
+static void execute_flow_control(simple_pump_controller_t* controller) {
     if (!controller->flow_pid.enabled) return;
     
     // 計算PID輸出
-    float pid_output = pid_calculate(&controller->flow_pid, 
-                                    controller->system.flow_current, dt);
+    float pid_output = pid_controller_calculate(&controller->flow_pid, controller->system.flow_current);
     
     // 確定主泵
     uint8_t lead_pump = controller->lead_pump;
@@ -602,12 +541,11 @@ static void execute_flow_control(simple_pump_controller_t* controller, float dt)
 }
 
 // 壓差控制模式
-static void execute_pressure_control(simple_pump_controller_t* controller, float dt) {
+static void execute_pressure_control(simple_pump_controller_t* controller) {
     if (!controller->pressure_pid.enabled) return;
     
     // 計算PID輸出
-    float pid_output = pid_calculate(&controller->pressure_pid,
-                                    controller->system.pressure_diff, dt);
+    float pid_output = pid_controller_calculate(&controller->pressure_pid, controller->system.pressure_diff);
     
     // 確定主泵
     uint8_t lead_pump = controller->lead_pump;
@@ -962,7 +900,7 @@ int control_logic_lx1400_4_pump_control(ControlLogic *ptr)
                 _controller.flow_pid.setpoint = (float)flow_sp_raw / 10.0f;
                 _controller.flow_pid.enabled = true;
             }
-            execute_flow_control(&_controller, dt);
+            execute_flow_control(&_controller);
         } else if (_controller.control_mode == CONTROL_MODE_PRESSURE) {
             // 讀取壓差設定值
             uint16_t pressure_sp_raw = read_holding_register(REG_PRESSURE_SETPOINT);
@@ -971,7 +909,7 @@ int control_logic_lx1400_4_pump_control(ControlLogic *ptr)
                 _controller.pressure_pid.setpoint = (float)pressure_sp_raw / 100.0f;
                 _controller.pressure_pid.enabled = true;
             }
-            execute_pressure_control(&_controller, dt);
+            execute_pressure_control(&_controller);
         }
     }
     
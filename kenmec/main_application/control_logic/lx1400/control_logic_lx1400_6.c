@@ -48,6 +48,7 @@
 #include "dexatek/main_application/include/application_common.h"
 
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/pid_controller.h"
 // proportional_valve_control.c
 
 // 比例閥控制邏輯程式
@@ -104,18 +105,6 @@ static uint32_t REG_P17_PRESSURE = 42098;    // P17二次側出水壓力 (bar)
 // 資料結構定義
 // ========================================================================================
 
-// PID控制器
-typedef struct {
-    float kp, ki, kd;              // PID參數
-    float setpoint;                // 設定值
-    float integral;                // 積分項
-    float last_error;              // 上次誤差
-    float output;                  // 輸出值
-    float output_min, output_max;  // 輸出限制
-    uint32_t last_time_ms;         // 上次計算時間
-    bool enabled;                  // 是否啟用
-} pid_controller_t;
-
 // 閥門控制配置
 typedef struct {
     bool manual_mode;              // 手動模式 (REG_VALVE_MANUAL)
@@ -158,8 +147,6 @@ typedef struct {
 
 // PID控制函數
 static void pid_init(pid_controller_t* pid, float kp, float ki, float kd);
-static float pid_calculate(pid_controller_t* pid, float process_value, uint32_t current_time_ms);
-// static void pid_reset(pid_controller_t* pid);
 
 // 系統資料讀寫
 static bool read_valve_config(valve_config_t* config);
@@ -175,7 +162,7 @@ static float emergency_flow_protection(float current_opening, float actual_flow,
 
 // 控制邏輯函數
 static void execute_manual_control(valve_controller_t* controller);
-static void execute_flow_control(valve_controller_t* controller, uint32_t current_time_ms);
+static void execute_flow_control(valve_controller_t* controller);
 
 // Modbus通信函數
 static uint16_t read_holding_register(uint32_t address);
@@ -193,69 +180,11 @@ static valve_controller_t _valve_controller;
 
 // 初始化PID控制器
 static void pid_init(pid_controller_t* pid, float kp, float ki, float kd) {
-    pid->kp = kp;
-    pid->ki = ki;
-    pid->kd = kd;
-    pid->setpoint = 0.0f;
-    pid->integral = 0.0f;
-    pid->last_error = 0.0f;
-    pid->output = 0.0f;
-    pid->output_min = PID_OUTPUT_MIN;
-    pid->output_max = PID_OUTPUT_MAX;
-    pid->last_time_ms = 0;
-    pid->enabled = false;
-}
-
-// PID計算
-static float pid_calculate(pid_controller_t* pid, float process_value, uint32_t current_time_ms) {
-    if (!pid->enabled) return 0.0f;
-    
-    if (pid->last_time_ms == 0) {
-        pid->last_time_ms = current_time_ms;
-        return 0.0f;
-    }
-    
-    float dt = (current_time_ms - pid->last_time_ms) / 1000.0f; // 轉換為秒
-    if (dt <= 0.0f) return pid->output;
-    
-    float error = pid->setpoint - process_value;
-    
-    // 比例項
-    float proportional = pid->kp * error;
-    
-    // 積分項
-    pid->integral += error * dt;
-    
-    // 積分限幅防止飽和
-    if (pid->integral > PID_INTEGRAL_MAX) pid->integral = PID_INTEGRAL_MAX;
-    if (pid->integral < -PID_INTEGRAL_MAX) pid->integral = -PID_INTEGRAL_MAX;
-    
-    float integral = pid->ki * pid->integral;
-    
-    // 微分項
-    float derivative = pid->kd * (error - pid->last_error) / dt;
-    pid->last_error = error;
-    
-    // PID輸出
-    pid->output = proportional + integral + derivative;
-    
-    // 輸出限幅
-    if (pid->output > pid->output_max) pid->output = pid->output_max;
-    if (pid->output < pid->output_min) pid->output = pid->output_min;
-    
-    pid->last_time_ms = current_time_ms;
-    
-    return pid->output;
+    pid_controller_init(pid, kp, ki, kd, PID_OUTPUT_MIN, PID_OUTPUT_MAX);
+    pid->integral_min = -PID_INTEGRAL_MAX;
+    pid->integral_max = PID_INTEGRAL_MAX;
 }
 
-// 重置PID控制器
-// static void pid_reset(pid_controller_t* pid) {
-//     pid->integral = 0.0f;
-//     pid->last_error = 0.0f;
-//     pid->output = 0.0f;
-//     pid->last_time_ms = 0;
-// }
-
 // ========================================================================================
 // Modbus通信實現
 // ========================================================================================
@@ -471,7 +400,7 @@ static void execute_manual_control(valve_controller_t* controller) {
 }
 
 // 自動流量控制模式
-static void execute_flow_control(valve_controller_t* controller, uint32_t current_time_ms) {
+static void execute_flow_control(valve_controller_t* controller) {
     valve_config_t* config = &controller->config;
     valve_status_t* status = &controller->status;
     pid_controller_t* flow_pid = &controller->flow_pid;
@@ -495,7 +424,7 @@ static void execute_flow_control(valve_controller_t* controller, uint32_t curren
     }
     
     // PID控制計算
-    float pid_output = pid_calculate(flow_pid, status->actual_flow, current_time_ms);
+    float pid_output = pid_controller_calculate(flow_pid, status->actual_flow);
     
     // 計算新的閥門開度
     float new_opening = status->current_opening + pid_output;
@@ -660,7 +589,7 @@ int control_logic_lx1400_6_valve_control(ControlLogic *ptr) {
         execute_manual_control(&_valve_controller);
     } else {
         // 自動流量控制模式
-        execute_flow_control(&_valve_controller, current_time_ms);
+        execute_flow_control(&_valve_controller);
     }
     
     // 更新統計
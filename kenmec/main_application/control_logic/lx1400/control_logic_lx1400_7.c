@@ -65,6 +65,7 @@
 #include "dexatek/main_application/include/application_common.h"
 
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/pid_controller.h"
 
 // 2dc_pump_control_7_1.c
 
@@ -118,17 +119,6 @@ typedef struct {
     time_t timestamp;
 } system_sensor_data_t;
 
-typedef struct {
-    float kp;                      // 比例增益
-    float ki;                      // 積分增益
-    float kd;                      // 微分增益
-    float integral;                // 積分累計
-    float previous_error;          // 前次誤差
-    time_t previous_time;          // 前次時間
-    float output_min;              // 輸出最小值
-    float output_max;              // 輸出最大值
-} pid_controller_t;
-
 typedef struct {
     bool active_pumps[2];          // 泵浦啟用狀態
     float pump_speeds[2];          // 泵浦速度 0-100%
@@ -144,22 +134,18 @@ static pid_controller_t flow_pid = {
     .kp = 1.2f,
     .ki = 0.15f,
     .kd = 0.06f,
-    .integral = 0.0f,
-    .previous_error = 0.0f,
-    .previous_time = 0,
     .output_min = 0.0f,
-    .output_max = 100.0f
+    .output_max = 100.0f,
+    .derivative_tau = PID_CONTROLLER_DERIVATIVE_TAU_DEFAULT
 };
 
 static pid_controller_t pressure_pid = {
     .kp = 1.8f,
     .ki = 0.25f,
     .kd = 0.1f,
-    .integral = 0.0f,
-    .previous_error = 0.0f,
-    .previous_time = 0,
     .output_min = 0.0f,
-    .output_max = 100.0f
+    .output_max = 100.0f,
+    .derivative_tau = PID_CONTROLLER_DERIVATIVE_TAU_DEFAULT
 };
 
 // 系統狀態變數
@@ -823,48 +809,19 @@ static int execute_automatic_control_mode(const system_sensor_data_t *data) {
  ---------------------------------------------------------------------------*/
 
 static float calculate_pid_output(pid_controller_t *pid, float setpoint, float current_value) {
-    time_t current_time = time(NULL);
-    float delta_time = (current_time > pid->previous_time) ? 
-        (current_time - pid->previous_time) : 1.0f;
-    
+    // 計算控制誤差
     float error = setpoint - current_value;
-    
-    // 比例項
-    float proportional = pid->kp * error;
-    
-    // 積分項 - 防止積分飽和
-    pid->integral += error * delta_time;
-    if (pid->integral > pid->output_max / pid->ki) {
-        pid->integral = pid->output_max / pid->ki;
-    } else if (pid->integral < pid->output_min / pid->ki) {
-        pid->integral = pid->output_min / pid->ki;
-    }
-    float integral_term = pid->ki * pid->integral;
-    
-    // 微分項
-    float derivative = (delta_time > 0) ? (error - pid->previous_error) / delta_time : 0.0f;
-    float derivative_term = pid->kd * derivative;
-    
-    // PID輸出計算
-    float output = proportional + integral_term + derivative_term;
-    
-    // 輸出限制
-    output = clamp_float(output, pid->output_min, pid->output_max);
-    
-    // 更新狀態
-    pid->previous_error = error;
-    pid->previous_time = current_time;
-    
+
+    float output = pid_controller_update(pid, error);
+
     debug(debug_tag, "PID計算 - 誤差: %.2f, P: %.2f, I: %.2f, D: %.2f, 輸出: %.2f", 
-          error, proportional, integral_term, derivative_term, output);
-    
+          error, pid->p_term, pid->i_term, pid->d_term, output);
+
     return output;
 }
 
 static void reset_pid_controller(pid_controller_t *pid) {
-    pid->integral = 0.0f;
-    pid->previous_error = 0.0f;
-    pid->previous_time = time(NULL);
+    pid_controller_reset(pid);
     debug(debug_tag, "PID控制器已重置");
 }
 
@@ -0,0 +1,142 @@
+/**
+ * @file pid_controller.c
+ * @brief 共用 PID 控制器實現
+ *
+ * 實現原理:
+ * - dt 由 CLOCK_MONOTONIC 取得,RTC 以 date -s 校時不會造成 dt 跳動
+ * - 微分項使用一階低通濾波: D += dt / (tau + dt) * (D_raw - D),
+ *   濾波係數隨 dt 調整,控制週期改變時截止頻率不變
+ * - 積分累積先限幅,輸出飽和且誤差會使飽和加劇時不累積(條件積分)
+ *
+ * @note 本模組不含鎖,每個控制器只應由單一控制邏輯執行緒使用
+ */
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "kenmec/main_application/control_logic/pid_controller.h"
+
+#include <time.h>
+
+/*---------------------------------------------------------------------------
+                                Implementation
+ ---------------------------------------------------------------------------*/
+static uint64_t _monotonic_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static float _clamp(float value, float min, float max)
+{
+    if (value > max) return max;
+    if (value < min) return min;
+    return value;
+}
+
+static float _integral_clamp(const pid_controller_t *pid, float integral)
+{
+    if (pid->integral_min != 0.0f || pid->integral_max != 0.0f) {
+        return _clamp(integral, pid->integral_min, pid->integral_max);
+    }
+
+    // no explicit limit: keep ki * integral inside the output range
+    if (pid->ki > 0.0f) {
+        return _clamp(integral, pid->output_min / pid->ki, pid->output_max / pid->ki);
+    } else if (pid->ki < 0.0f) {
+        return _clamp(integral, pid->output_max / pid->ki, pid->output_min / pid->ki);
+    }
+
+    return integral;
+}
+
+void pid_controller_init(pid_controller_t *pid, float kp, float ki, float kd, float output_min, float output_max)
+{
+    memset(pid, 0, sizeof(pid_controller_t));
+
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->output_min = output_min;
+    pid->output_max = output_max;
+    pid->derivative_tau = PID_CONTROLLER_DERIVATIVE_TAU_DEFAULT;
+}
+
+void pid_controller_reset(pid_controller_t *pid)
+{
+    pid->integral = 0.0f;
+    pid->previous_error = 0.0f;
+    pid->derivative = 0.0f;
+    pid->output = 0.0f;
+    pid->p_term = 0.0f;
+    pid->i_term = 0.0f;
+    pid->d_term = 0.0f;
+    pid->previous_time_ns = 0;
+}
+
+float pid_controller_update_dt(pid_controller_t *pid, float error, float dt)
+{
+    float integral = pid->integral;
+
+    if (dt > PID_CONTROLLER_DT_MAX) {
+        dt = PID_CONTROLLER_DT_MAX;
+    }
+
+    if (dt > 0.0f) {
+        float derivative_raw = (error - pid->previous_error) / dt;
+
+        if (pid->derivative_tau > 0.0f) {
+            pid->derivative += (dt / (pid->derivative_tau + dt)) * (derivative_raw - pid->derivative);
+        } else {
+            pid->derivative = derivative_raw;
+        }
+
+        integral = _integral_clamp(pid, integral + error * dt);
+    }
+
+    float p_term = pid->kp * error;
+    float i_term = pid->ki * integral;
+    float d_term = (dt > 0.0f) ? pid->kd * pid->derivative : 0.0f;
+    float output = p_term + i_term + d_term;
+
+    // anti-windup: do not integrate further into saturation
+    if ((output > pid->output_max && error * pid->ki > 0.0f) ||
+        (output < pid->output_min && error * pid->ki < 0.0f)) {
+        integral = pid->integral;
+        i_term = pid->ki * integral;
+        output = p_term + i_term + d_term;
+    }
+
+    pid->integral = integral;
+    pid->previous_error = error;
+    pid->p_term = p_term;
+    pid->i_term = i_term;
+    pid->d_term = d_term;
+    pid->output = _clamp(output, pid->output_min, pid->output_max);
+
+    return pid->output;
+}
+
+float pid_controller_update(pid_controller_t *pid, float error)
+{
+    uint64_t now_ns = _monotonic_time_ns();
+    float dt = 0.0f;
+
+    if (pid->previous_time_ns != 0) {
+        dt = (float)(now_ns - pid->previous_time_ns) / 1000000000.0f;
+    }
+    pid->previous_time_ns = now_ns;
+
+    return pid_controller_update_dt(pid, error, dt);
+}
+
+float pid_controller_calculate(pid_controller_t *pid, float process_value)
+{
+    if (!pid->enabled) {
+        return 0.0f;
+    }
+
+    return pid_controller_update(pid, pid->setpoint - process_value);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file pid_controller.h
+ * @brief 共用 PID 控制器介面頭文件
+ *
+ * 提供 LS80/LX1400 各控制邏輯共用的 PID 控制器。
+ * 主要功能包括：
+ * - 以 CLOCK_MONOTONIC 計算 dt,解析度為奈秒,不受 RTC 校時影響
+ * - 微分項一階低通濾波
+ * - 積分限幅與條件積分(anti-windup)
+ */
+
+#ifndef PID_CONTROLLER_H
+#define PID_CONTROLLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* 預設微分濾波時間常數(秒) */
+#define PID_CONTROLLER_DERIVATIVE_TAU_DEFAULT   (0.5f)
+
+/* 單次計算允許的最大 dt(秒),避免停用一段時間後積分暴衝 */
+#define PID_CONTROLLER_DT_MAX                   (5.0f)
+
+/**
+ * @brief PID 控制器
+ *
+ * 可用指定初始化器宣告,未指定的狀態欄位為 0 即為初始狀態。
+ * integral_min/integral_max 皆為 0 時,積分項(ki * integral)限制在輸出範圍內。
+ */
+typedef struct {
+    float kp, ki, kd;               // PID參數
+    float setpoint;                 // 設定值(pid_controller_calculate 使用)
+    float output_min, output_max;   // 輸出限制
+    float integral_min;             // 積分累積下限
+    float integral_max;             // 積分累積上限
+    float derivative_tau;           // 微分濾波時間常數(秒), 0 表示不濾波
+    bool enabled;                   // 是否啟用(pid_controller_calculate 使用)
+
+    float integral;                 // 積分累積
+    float previous_error;           // 上次誤差
+    float derivative;               // 濾波後的微分
+    float output;                   // 上次輸出
+    float p_term, i_term, d_term;   // 上次各項輸出(除錯用)
+    uint64_t previous_time_ns;      // 上次計算時間(CLOCK_MONOTONIC), 0 表示尚未計算
+} pid_controller_t;
+
+/**
+ * @brief 初始化 PID 控制器
+ *
+ * 清除所有狀態,設定參數與輸出範圍,微分濾波使用預設時間常數。
+ */
+void pid_controller_init(pid_controller_t *pid, float kp, float ki, float kd, float output_min, float output_max);
+
+/**
+ * @brief 重置 PID 控制器狀態
+ *
+ * 清除積分、微分與時間基準,保留參數與限制。
+ */
+void pid_controller_reset(pid_controller_t *pid);
+
+/**
+ * @brief 以誤差更新 PID 控制器
+ *
+ * dt 由 CLOCK_MONOTONIC 計算;第一次呼叫只輸出比例項。
+ *
+ * @param pid PID 控制器
+ * @param error 控制誤差(符號由呼叫端決定)
+ * @return float 限幅後的輸出
+ */
+float pid_controller_update(pid_controller_t *pid, float error);
+
+/**
+ * @brief 以誤差及指定 dt 更新 PID 控制器
+ *
+ * @param pid PID 控制器
+ * @param error 控制誤差
+ * @param dt 與上次計算的間隔(秒), <= 0 時只輸出比例項
+ * @return float 限幅後的輸出
+ */
+float pid_controller_update_dt(pid_controller_t *pid, float error, float dt);
+
+/**
+ * @brief 以設定值與量測值計算 PID 輸出
+ *
+ * 誤差為 setpoint - process_value;未啟用時返回 0。
+ *
+ * @return float 限幅後的輸出
+ */
+float pid_controller_calculate(pid_controller_t *pid, float process_value);
+
+#endif /* PID_CONTROLLER_H */
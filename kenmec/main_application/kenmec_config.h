@@ -24,6 +24,44 @@ extern "C" {
 
 #define CONFIG_APPLICATION_CONTROL_LOGIC_UPDATE_DELAY_MS 1000
 
+/* HID port pollers: longest sleep between planned polls, i.e. how fast a plugged board is noticed */
+#ifndef CONFIG_CONTROL_LOGIC_PORT_POLL_PERIOD_MS
+#define CONFIG_CONTROL_LOGIC_PORT_POLL_PERIOD_MS CONFIG_APPLICATION_CONTROL_LOGIC_UPDATE_DELAY_MS
+#endif
+
+/* AD74416H channel modes are cached; re-read from the board at this interval to catch resets */
+#ifndef CONFIG_CONTROL_LOGIC_AI_MODE_AUDIT_MS
+#define CONFIG_CONTROL_LOGIC_AI_MODE_AUDIT_MS 60000
+#endif
+
+/* Adaptive poll planner: base period per signal class, sped up to 1/4 or slowed down to 4x by rate of change */
+#ifndef CONFIG_CONTROL_LOGIC_POLL_DI_MS
+#define CONFIG_CONTROL_LOGIC_POLL_DI_MS                 500
+#endif
+#ifndef CONFIG_CONTROL_LOGIC_POLL_DO_MS
+#define CONFIG_CONTROL_LOGIC_POLL_DO_MS                 1000
+#endif
+#ifndef CONFIG_CONTROL_LOGIC_POLL_AI_VOLTAGE_MS
+#define CONFIG_CONTROL_LOGIC_POLL_AI_VOLTAGE_MS         1000
+#endif
+#ifndef CONFIG_CONTROL_LOGIC_POLL_AI_CURRENT_MS
+#define CONFIG_CONTROL_LOGIC_POLL_AI_CURRENT_MS         500
+#endif
+#ifndef CONFIG_CONTROL_LOGIC_POLL_PT100_MS
+#define CONFIG_CONTROL_LOGIC_POLL_PT100_MS              2000
+#endif
+#ifndef CONFIG_CONTROL_LOGIC_POLL_PWM_FREQ_MS
+#define CONFIG_CONTROL_LOGIC_POLL_PWM_FREQ_MS           1000
+#endif
+#ifndef CONFIG_CONTROL_LOGIC_POLL_RS485_MS
+#define CONFIG_CONTROL_LOGIC_POLL_RS485_MS              CONFIG_APPLICATION_CONTROL_LOGIC_UPDATE_DELAY_MS
+#endif
+
+/* HID transactions per second the poll planner may spend across all boards */
+#ifndef CONFIG_CONTROL_LOGIC_POLL_BUS_BUDGET
+#define CONFIG_CONTROL_LOGIC_POLL_BUS_BUDGET            40
+#endif
+
 #define CONFIG_MODBUS_DEVICE_CONFIG_PATH "/usrdata/modbus_devices_config"
 
 #define CONFIG_TEMPERATURE_CONFIGE_PATH "/usrdata/temperature_configs"
@@ -38,6 +76,37 @@ extern "C" {
 
 #define CONFIG_SYSTEM_CONFIGS_PATH "/usrdata/system_configs"
 
+#ifndef CONFIG_MODBUS_TABLE_JOURNAL_PATH
+#define CONFIG_MODBUS_TABLE_JOURNAL_PATH                "/usrdata/modbus_table_journal"
+#endif
+#ifndef CONFIG_MODBUS_TABLE_JOURNAL_DEBOUNCE_MS
+#define CONFIG_MODBUS_TABLE_JOURNAL_DEBOUNCE_MS         200
+#endif
+/* Highest sustained write rate (records/s) the journal queue is sized for */
+#ifndef CONFIG_MODBUS_TABLE_JOURNAL_MAX_RATE
+#define CONFIG_MODBUS_TABLE_JOURNAL_MAX_RATE            10000
+#endif
+#ifndef CONFIG_MODBUS_TABLE_JOURNAL_COMPACT_RECORDS
+#define CONFIG_MODBUS_TABLE_JOURNAL_COMPACT_RECORDS     1024
+#endif
+#ifndef CONFIG_MODBUS_TABLE_JOURNAL_COMPACT_INTERVAL_MS
+#define CONFIG_MODBUS_TABLE_JOURNAL_COMPACT_INTERVAL_MS (10 * 60 * 1000)
+#endif
+
+/* Sensor history: samples kept per channel (24 h at the 1 s update period, about 1 MB per
+ * channel, allocated when a channel is first written) and channel count */
+#ifndef CONFIG_CONTROL_LOGIC_HISTORY_DEPTH
+#define CONFIG_CONTROL_LOGIC_HISTORY_DEPTH              (24 * 60 * 60)
+#endif
+#ifndef CONFIG_CONTROL_LOGIC_HISTORY_CHANNELS_MAX
+#define CONFIG_CONTROL_LOGIC_HISTORY_CHANNELS_MAX       64
+#endif
+
+/* RTD conversion: piecewise-linear segments over -200..850 C (256: max error about 0.0012 C, at least 128) */
+#ifndef CONFIG_CONTROL_LOGIC_RTD_TABLE_SEGMENTS
+#define CONFIG_CONTROL_LOGIC_RTD_TABLE_SEGMENTS         256
+#endif
+
 #ifndef CONFIG_REDFISH_ACCOUNT_DB_PATH
 #define CONFIG_REDFISH_ACCOUNT_DB_PATH "/usrdata/redfish_accounts.db"
 #endif
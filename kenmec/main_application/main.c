@@ -9,6 +9,7 @@
 
 #include "kenmec/main_application/kenmec_config.h"
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/control_logic_persist.h"
 
 #include "kenmec/main_application/redfish/include/redfish_init.h"
 
@@ -127,6 +128,9 @@ int application_stop(void)
     debug(tag, "Application stopped");
 
 
+    control_logic_manager_stop();
+    control_logic_persist_deinit();
+
     hid_manager_deinit();
     modbus_manager_deinit();
 
@@ -14,14 +14,40 @@
 #define MAX_HEADER_NAME_LEN 64
 #define MAX_HEADER_VALUE_LEN 256
 
+// HTTP Connection Handling
+#ifndef HTTP_WORKER_NUM
+#define HTTP_WORKER_NUM 4                   // Worker threads running request handlers
+#endif
+#ifndef HTTP_MAX_CONNECTIONS
+#define HTTP_MAX_CONNECTIONS 128            // Open client connections (HTTP + HTTPS); more are closed on accept
+#endif
+#define HTTP_KEEPALIVE_TIMEOUT_MS 15000     // Idle time before a kept-alive connection is closed
+#define HTTP_KEEPALIVE_MAX_REQUESTS 1000    // Requests served on one connection before closing
+#define HTTP_WRITE_TIMEOUT_MS 5000          // Max wait for a slow client to drain a response
+#define HTTP_CONN_ARENA_INITIAL_SIZE 4096   // First arena block of a connection; doubles as it grows
+#ifndef HTTP_CONN_ARENA_LIMIT
+#define HTTP_CONN_ARENA_LIMIT (BUFFER_SIZE * 4)  // Arena bytes per connection (request buffer + header index)
+#endif
+
+// Server-Sent Events (EventService/SSE)
+#ifndef REDFISH_SSE_MIN_INTERVAL_MS
+#define REDFISH_SSE_MIN_INTERVAL_MS 1000    // Shortest time between two events
+#endif
+#define REDFISH_SSE_MAX_SUBSCRIBERS 64
+#define REDFISH_SSE_BACKLOG_MAX (64 * 1024) // Unsent bytes at which a slow subscriber is dropped
+#define REDFISH_SSE_KEEPALIVE_MS 15000      // Comment line sent on a quiet stream to detect dead peers
+#define REDFISH_SSE_REGISTERS_MAX 20000     // Registers of the control logic table (MODBUS_RO_REGISTERS)
+
 // Protocol Configuration
 #define SUPPORT_HTTP true
 #define SUPPORT_HTTPS true
 
 // TLS Configuration
-#define TLS_CIPHER_SUITE MBEDTLS_TLS_RSA_WITH_AES_256_CBC_SHA
 #define TLS_VERSION MBEDTLS_SSL_VERSION_TLS1_2
 #define TLS_VERIFY_MODE MBEDTLS_SSL_VERIFY_OPTIONAL
+#define TLS_SESSION_CACHE_TIMEOUT_S 3600       // Session-ID cache entry lifetime
+#define TLS_SESSION_CACHE_MAX_ENTRIES 32
+#define TLS_SESSION_TICKET_LIFETIME_S 3600     // Session ticket lifetime
 
 // Certificate Configuration
 #define DEFAULT_CERT_FILE "./redfish_certification/server/server.crt"
@@ -45,6 +71,7 @@
 #define HTTP_CREATED 201
 #define HTTP_ACCEPTED 202
 #define HTTP_NO_CONTENT 204
+#define HTTP_NOT_MODIFIED 304
 #define HTTP_TEMPORARY_REDIRECT 307
 #define HTTP_BAD_REQUEST 400
 #define HTTP_UNAUTHORIZED 401
@@ -54,6 +81,7 @@
 #define HTTP_PRECONDITION_FAILED 412
 #define HTTP_INTERNAL_SERVER_ERROR 500
 #define HTTP_NOT_IMPLEMENTED 501
+#define HTTP_SERVICE_UNAVAILABLE 503
 
 // HTTP Methods
 #define HTTP_METHOD_GET "GET"
@@ -0,0 +1,55 @@
+#ifndef REDFISH_ARENA_H
+#define REDFISH_ARENA_H
+
+#include <stddef.h>
+
+// Per-connection bump allocator.
+// Memory comes from a chain of blocks: the first one has the initial size and
+// each new block is twice the size of the previous one, until the total
+// reaches the limit. Nothing is freed individually; redfish_arena_reset()
+// makes every block available again in O(1) and keeps them for the next
+// request, redfish_arena_release() gives them back to the heap.
+
+#define REDFISH_ARENA_ALIGN 16
+
+typedef struct redfish_arena_block {
+    struct redfish_arena_block *next;
+    size_t size;
+    size_t used;
+    unsigned char data[] __attribute__((aligned(REDFISH_ARENA_ALIGN)));
+} redfish_arena_block_t;
+
+typedef struct {
+    redfish_arena_block_t *first;
+    redfish_arena_block_t *current;
+    size_t initial_size;
+    size_t limit;                   // Max bytes held in blocks
+    size_t total;                   // Bytes held in blocks
+    void *last;                     // Most recent allocation, can grow in place
+} redfish_arena_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void redfish_arena_init(redfish_arena_t *arena, size_t initial_size, size_t limit);
+
+// NULL when the allocation would take the arena over its limit.
+void *redfish_arena_alloc(redfish_arena_t *arena, size_t size);
+
+// Resize an allocation, keeping its first old_size bytes. The most recent
+// allocation grows in place while its block has room; otherwise the data is
+// copied to a new allocation and the old one stays valid until the reset.
+void *redfish_arena_grow(redfish_arena_t *arena, void *ptr, size_t old_size, size_t new_size);
+
+// Forget every allocation; blocks are kept.
+void redfish_arena_reset(redfish_arena_t *arena);
+
+// Free every block.
+void redfish_arena_release(redfish_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REDFISH_ARENA_H
@@ -0,0 +1,58 @@
+#ifndef REDFISH_EVENT_STREAM_H
+#define REDFISH_EVENT_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Server-Sent Events stream of the control logic register table.
+// A publisher thread wakes up every interval, asks the control logic for the
+// registers whose value changed since the previous tick and sends one event
+// to every subscriber:
+//
+//   id: <generation>
+//   event: RegisterUpdate
+//   data: {"Generation":<generation>,"Registers":[[<address>,<value>],...]}
+//
+// A new subscriber first receives the whole table, or the changes since its
+// Last-Event-ID; a Last-Event-ID ahead of the table (from before a restart)
+// also gets the whole table. The event of a tick is formatted once and
+// shared by all subscribers that are up to date. Subscribers that are still
+// sitting on more than REDFISH_SSE_BACKLOG_MAX unsent bytes at a tick are
+// dropped.
+
+#define REDFISH_SSE_PATH "/redfish/v1/EventService/SSE"
+#define REDFISH_SSE_CONTENT_TYPE "text/event-stream"
+
+// Transport of a subscriber, provided by the HTTP server
+typedef struct {
+    // Non-blocking write: bytes taken (> 0), 0 if the transport cannot take
+    // more right now, < 0 if the connection is gone.
+    int (*write)(void *ctx, const void *data, size_t len);
+    // The subscriber was dropped; the owner closes the transport.
+    void (*close)(void *ctx);
+} redfish_event_stream_ops_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Start the publisher; interval_ms is raised to REDFISH_SSE_MIN_INTERVAL_MS.
+int redfish_event_stream_start(uint32_t interval_ms);
+
+// Stop the publisher and drop every subscriber.
+void redfish_event_stream_stop(void);
+
+// Hand a connection over to the stream. head (the HTTP response head) is
+// sent before the first event. since is the Last-Event-ID of a reconnecting
+// client, 0 for a full snapshot. On success the stream owns ctx until it
+// calls ops->close(); on failure the caller keeps it.
+int redfish_event_stream_subscribe(const redfish_event_stream_ops_t *ops, void *ctx, uint32_t since,
+                                   const char *head, size_t head_len);
+
+int redfish_event_stream_subscriber_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REDFISH_EVENT_STREAM_H
@@ -0,0 +1,32 @@
+#ifndef REDFISH_HTTP_SERVER_H
+#define REDFISH_HTTP_SERVER_H
+
+#include "config.h"
+#include "tls_server.h"
+
+// Event-driven HTTP/HTTPS front end for the Redfish service.
+// One thread owns an epoll set with the listeners and every client socket;
+// ready connections are handed to a pool of worker threads which parse
+// requests incrementally, run the Redfish handlers and write the responses.
+// Connections are kept alive (HTTP/1.1) and pipelined requests are served
+// in order from the per-connection buffer.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Run the event loop on the given listening sockets until
+// redfish_http_server_stop() is called. Either fd may be -1.
+// tls_ctx is required when https_fd >= 0.
+int redfish_http_server_run(int http_fd, int https_fd, tls_server_context_t *tls_ctx, int worker_num);
+
+// Ask the event loop and the worker threads to exit and wait until the
+// worker threads have been joined and every connection closed. Must not be
+// called from a request handler.
+void redfish_http_server_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REDFISH_HTTP_SERVER_H
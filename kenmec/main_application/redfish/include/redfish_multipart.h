@@ -0,0 +1,75 @@
+#ifndef REDFISH_MULTIPART_H
+#define REDFISH_MULTIPART_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <mbedtls/sha256.h>
+
+// Streaming multipart/form-data parser for firmware uploads.
+// The body is fed in chunks of any size as it is received; the content of the
+// file part (name="UpdateFile" or name="file") is written to an fd while its
+// SHA-256 is computed. Delimiters are located with a Boyer-Moore-Horspool
+// search and a partial match at the end of a chunk is carried over to the
+// next one, so memory use does not depend on the image size.
+
+#define MULTIPART_BOUNDARY_MAX_LEN 70       // RFC 2046 limit
+#define MULTIPART_HEADER_MAX_LEN 1024       // Headers of a single part
+#define MULTIPART_SHA256_HEX_LEN 65
+
+typedef enum {
+    MULTIPART_STATE_BODY = 0,       // Preamble or part content, searching for a delimiter
+    MULTIPART_STATE_BOUNDARY_TAIL,  // After a delimiter: CRLF (next part) or "--" (close)
+    MULTIPART_STATE_HEADERS,        // Part headers up to the blank line
+    MULTIPART_STATE_DONE,           // Close delimiter seen, the epilogue is ignored
+    MULTIPART_STATE_ERROR,
+} multipart_state_t;
+
+typedef struct {
+    multipart_state_t state;
+
+    // Delimiter "\n--<boundary>"; the '\r' in front of it is stripped from content
+    unsigned char delim[MULTIPART_BOUNDARY_MAX_LEN + 3];
+    size_t delim_len;
+    uint8_t skip[256];              // BMH bad-character shifts
+
+    // Bytes from earlier chunks that may still be the start of a delimiter
+    unsigned char lookbehind[MULTIPART_BOUNDARY_MAX_LEN + 4];
+    size_t lookbehind_len;
+
+    char header[MULTIPART_HEADER_MAX_LEN];
+    size_t header_len;
+    char tail;                      // Pending first byte of the delimiter tail
+
+    bool part_selected;             // Current part is the file part
+    bool file_found;                // File part was completed
+
+    int out_fd;
+    long bytes;
+    mbedtls_sha256_context sha;
+} multipart_parser_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Copy the boundary parameter of a multipart Content-Type (quotes removed).
+int multipart_boundary_from_content_type(const char *content_type, char *boundary, size_t boundary_size);
+
+// Prepare a parser that writes the file part to out_fd.
+int multipart_parser_init(multipart_parser_t *parser, const char *boundary, int out_fd);
+
+// Feed the next chunk of the body. Returns SUCCESS or ERROR_GENERAL once the
+// body is known to be malformed or the output could not be written.
+int multipart_parser_feed(multipart_parser_t *parser, const void *data, size_t len);
+
+// Check that a file part was found and report its size and SHA-256 (hex).
+int multipart_parser_finish(multipart_parser_t *parser, long *bytes, char *sha256_hex);
+
+void multipart_parser_free(multipart_parser_t *parser);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REDFISH_MULTIPART_H
@@ -61,6 +61,10 @@ int handle_cdu_oem_control_logics(const char *cdu_id, http_response_t *response)
 int handle_cdu_oem_control_logics_member(const char *cdu_id, const char *member_id, http_response_t *response);
 int handle_cdu_oem_control_logics_action_read(const char *cdu_id, const char *member_id, const http_request_t *request, http_response_t *response);
 int handle_cdu_oem_control_logics_action_write(const char *cdu_id, const char *member_id, const http_request_t *request, http_response_t *response);
+int handle_cdu_oem_history(const char *cdu_id, http_response_t *response);
+int handle_cdu_oem_history_member(const char *cdu_id, const char *member_id, const http_request_t *request, http_response_t *response);
+int handle_cdu_oem_latency(const char *cdu_id, http_response_t *response);
+int handle_metrics_prometheus(http_response_t *response);
 
 int handle_manager_reset_action(const char *manager_id, const http_request_t *request, http_response_t *response);
 
@@ -105,7 +109,10 @@ char* generate_thermalequipment_collection_json(void);
 char* generate_thermalequipment_json(const char *thermalequipment_id);
 char* open_resource_json(json_resource_type_t type);
 
+#define RESOURCE_ETAG_LEN 24
+
 char* open_json_file(const char *file_name, json_resource_type_t type);
+char* open_json_file_with_etag(const char *file_name, json_resource_type_t type, char *etag, size_t etag_size);
 bool save_json_file(const char *file_name, const char *json_info);
 
 #endif // REDFISH_RESOURCES_H
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef REDFISH_ROUTER_H
+#define REDFISH_ROUTER_H
+
+#include <stddef.h>
+
+#include "redfish_server.h"
+
+// Redfish URI routing.
+// The route table in redfish_router.c is compiled once into a trie of path
+// segments. A route segment is a literal, "{name}" (any one segment) or
+// "{name*}" (the rest of the path, last segment only). Literal segments take
+// precedence over "{name}", which takes precedence over "{name*}"; a
+// branch that does not lead to a route falls back to the next alternative.
+// Captures are slices of the request path, nothing is copied.
+
+#define REDFISH_ROUTE_MAX_SEGMENTS 32
+#define REDFISH_ROUTE_MAX_PARAMS 4
+
+// Slice of the request path; not NUL-terminated unless it ends the path
+typedef struct {
+    const char *ptr;
+    size_t len;
+} redfish_route_param_t;
+
+typedef struct {
+    redfish_resource_type_t type;
+    redfish_route_param_t id;       // Resource ID passed to the handler (empty if the route has none)
+    redfish_route_param_t params[REDFISH_ROUTE_MAX_PARAMS];  // Captures in path order
+    int param_count;
+} redfish_route_match_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Build the routing trie; called by redfish_server_init(), matching builds it on first use otherwise.
+int redfish_router_init(void);
+
+// Route a request path (leading slashes, one trailing slash and the query
+// string are ignored). Returns REDFISH_RESOURCE_UNKNOWN if nothing matches.
+redfish_resource_type_t parse_redfish_path(const char *path, redfish_route_match_t *match);
+
+// Capture as a C string: the slice itself when it ends the path, otherwise a
+// copy in buf (truncated to buf_size). NULL for an empty capture.
+const char *redfish_route_param_str(const redfish_route_param_t *param, char *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REDFISH_ROUTER_H
@@ -52,6 +52,11 @@ typedef enum {
     REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_MEMBER,
     REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_READ,
     REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_WRITE,
+    REDFISH_RESOURCE_CDU_OEM_HISTORY,
+    REDFISH_RESOURCE_CDU_OEM_HISTORY_MEMBER,
+    REDFISH_RESOURCE_CDU_OEM_LATENCY,
+    REDFISH_RESOURCE_METRICS,
+    REDFISH_RESOURCE_EVENTSERVICE_SSE,
     REDFISH_RESOURCE_UNKNOWN
 } redfish_resource_type_t;
 
@@ -76,6 +81,11 @@ typedef struct {
     int is_https;  // 1 if HTTPS, 0 if HTTP
     // For large uploads, the body can be streamed to a file
     char upload_tmp_path[256];
+    // Set when the multipart body was already unpacked into upload_tmp_path
+    // while it was received: 1 = extracted, -1 = malformed body
+    int upload_extracted;
+    long upload_bytes;
+    char upload_sha256[65];
 } http_request_t;
 
 // HTTP response structure
@@ -84,9 +94,15 @@ typedef struct {
     char content_type[64];
     char body[MAX_JSON_SIZE];
     int content_length;
+    // Heap body for documents that do not fit in body[], NULL otherwise.
+    // Read the body through redfish_response_body().
+    char *body_ext;
+    size_t body_ext_size;
     char headers[MAX_HEADERS][2][MAX_HEADER_VALUE_LEN];
     int header_count;
     label_post_action_t post_action;
+    // The connection is handed to the event stream after the head is sent
+    int event_stream;
 } http_response_t;
 
 // Function declarations
@@ -95,6 +111,16 @@ void redfish_server_cleanup(void);
 int parse_http_request(const char *raw_request, http_request_t *request, int is_https);
 int process_redfish_request(const http_request_t *request, http_response_t *response);
 void generate_http_response(const http_response_t *response, char *output, size_t output_size);
+int generate_http_response_head(const http_response_t *response, int chunked, char *output, size_t output_size);
+
+// Response body helpers
+// Bodies are written in place: into body[] when they fit, otherwise into a
+// heap buffer that redfish_response_clear_body() releases after sending.
+#define REDFISH_RESPONSE_BODY_MAX (1024 * 1024)
+const char *redfish_response_body(const http_response_t *response);
+int redfish_response_set_body(http_response_t *response, const char *data, size_t len);
+int redfish_response_set_json(http_response_t *response, cJSON *json);
+void redfish_response_clear_body(http_response_t *response);
 
 // HTTP/HTTPS server functions
 int handle_http_client_connection(int client_fd);
@@ -142,7 +168,6 @@ int handle_manager_delete(const char *manager_id, http_response_t *response);
 int handle_thermalequipment_delete(const char *thermalequipment_id, http_response_t *response);
 
 // Utility functions
-redfish_resource_type_t parse_redfish_path(const char *path, char **resource_id);
 const char* get_http_status_text(int status_code);
 void add_cors_headers(http_response_t *response);
 
@@ -4,6 +4,7 @@
 #include "../include/config.h"
 #include <mbedtls/ssl.h>
 #include <mbedtls/ssl_cache.h>
+#include <mbedtls/ssl_ticket.h>
 #include <mbedtls/ssl_ciphersuites.h>
 #include <mbedtls/x509_crt.h>
 #include <mbedtls/pk.h>
@@ -18,6 +19,12 @@ typedef struct {
     mbedtls_pk_context pkey;
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context ctr_drbg;
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_context cache;    // Session-ID resumption
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_context ticket;  // RFC 5077 session tickets
+#endif
     int server_fd;
     bool initialized;
 } tls_server_context_t;
@@ -27,6 +34,7 @@ int tls_server_init(tls_server_context_t *ctx, const char *cert_file, const char
 void tls_server_cleanup(tls_server_context_t *ctx);
 int tls_server_start(tls_server_context_t *ctx);
 int tls_server_accept_client(tls_server_context_t *ctx, int *client_fd);
+int tls_server_setup_ssl(tls_server_context_t *ctx, mbedtls_ssl_context *ssl, mbedtls_net_context *client_net_ctx);
 int tls_server_establish_ssl(tls_server_context_t *ctx, int client_fd, mbedtls_ssl_context *ssl, mbedtls_net_context *client_net_ctx);
 int tls_server_read(mbedtls_ssl_context *ssl, char *buffer, size_t buffer_size);
 int tls_server_write(mbedtls_ssl_context *ssl, const char *data, size_t data_size);
@@ -0,0 +1,417 @@
+// Redfish HTTP load generator
+//
+// Opens N keep-alive connections to a running redfish_server and sends GET
+// requests back to back on each for a fixed time, then reports requests per
+// second and p50/p99 latency. Bodies are framed by Content-Length or sent
+// chunked, as the server does for large documents. Runs 1, 16 and 64
+// concurrent clients by default. The server closes connections beyond
+// HTTP_MAX_CONNECTIONS, so larger client counts are refused here rather than
+// measured as errors, and a run with any failed request fails.
+//
+//   ./redfish_loadgen [host] [port] [path] [seconds] [clients...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+// HTTP_MAX_CONNECTIONS of the server (include/config.h), passed in by the Makefile
+#ifndef LOADGEN_MAX_CLIENTS
+#define LOADGEN_MAX_CLIENTS 128
+#endif
+#define LOADGEN_BUFFER_SIZE 65536
+#define LOADGEN_MAX_SAMPLES 1000000
+
+typedef struct {
+    const struct addrinfo *addr;
+    const char *request;
+    size_t request_len;
+    uint64_t deadline_ns;
+    uint32_t *samples_us;
+    size_t sample_count;
+    size_t sample_max;
+    uint32_t errors;
+} loadgen_client_t;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int _connect(const struct addrinfo *addr)
+{
+    int fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    int one = 1;
+
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+        close(fd);
+        return -1;
+    }
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    return fd;
+}
+
+static int _send_all(int fd, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+
+    return 0;
+}
+
+// Body of a response for callers that want it; the loadgen only needs its length
+typedef struct {
+    char *data;
+    size_t size;
+    size_t len;
+} loadgen_body_t;
+
+// Receive buffer of one response: bytes [pos, len) are read but not consumed
+typedef struct {
+    int fd;
+    char *data;
+    size_t size;
+    size_t pos;
+    size_t len;
+} loadgen_stream_t;
+
+static int _stream_fill(loadgen_stream_t *stream)
+{
+    if (stream->pos > 0) {
+        memmove(stream->data, stream->data + stream->pos, stream->len - stream->pos);
+        stream->len -= stream->pos;
+        stream->pos = 0;
+    }
+    if (stream->len + 1 >= stream->size) {
+        return -1;
+    }
+
+    ssize_t n = recv(stream->fd, stream->data + stream->len, stream->size - stream->len - 1, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    stream->len += (size_t)n;
+    stream->data[stream->len] = '\0';
+
+    return 0;
+}
+
+// Consume count body bytes, copying them to body if given
+static int _stream_body(loadgen_stream_t *stream, size_t count, loadgen_body_t *body)
+{
+    while (count > 0) {
+        if (stream->pos == stream->len && _stream_fill(stream) != 0) {
+            return -1;
+        }
+
+        size_t n = stream->len - stream->pos;
+        if (n > count) {
+            n = count;
+        }
+        if (body != NULL) {
+            if (body->len + n > body->size) {
+                return -1;
+            }
+            memcpy(body->data + body->len, stream->data + stream->pos, n);
+            body->len += n;
+        }
+        stream->pos += n;
+        count -= n;
+    }
+
+    return 0;
+}
+
+// Consume the next CRLF-terminated line; returns it NUL-terminated in the buffer
+static char *_stream_line(loadgen_stream_t *stream)
+{
+    size_t scan = stream->pos;
+
+    while (1) {
+        char *lf = memchr(stream->data + scan, '\n', stream->len - scan);
+        if (lf != NULL) {
+            char *line = stream->data + stream->pos;
+            if (lf == line || lf[-1] != '\r') {
+                return NULL;
+            }
+            lf[-1] = '\0';
+            stream->pos = (size_t)(lf + 1 - stream->data);
+            return line;
+        }
+        scan = stream->len - stream->pos;
+        if (_stream_fill(stream) != 0) {
+            return NULL;
+        }
+    }
+}
+
+// Chunk-size lines with their data, the last chunk and the trailer
+static int _chunked_body_read(loadgen_stream_t *stream, loadgen_body_t *body)
+{
+    while (1) {
+        char *line = _stream_line(stream);
+        char *end = NULL;
+
+        if (line == NULL) {
+            return -1;
+        }
+        unsigned long chunk = strtoul(line, &end, 16);
+        if (end == line || (*end != '\0' && *end != ';')) {
+            return -1;
+        }
+        if (chunk == 0) {
+            break;
+        }
+        if (_stream_body(stream, chunk, body) != 0) {
+            return -1;
+        }
+        // the data is followed by CRLF, an empty line
+        line = _stream_line(stream);
+        if (line == NULL || *line != '\0') {
+            return -1;
+        }
+    }
+
+    // trailer fields up to the empty line
+    while (1) {
+        char *line = _stream_line(stream);
+        if (line == NULL) {
+            return -1;
+        }
+        if (*line == '\0') {
+            return 0;
+        }
+    }
+}
+
+// Read one response, Content-Length or chunked; the body goes to body if given.
+// Returns 1 if the server keeps the connection open, 0 if it closes it, -1 on error
+static int _response_read(int fd, char *buffer, size_t size, loadgen_body_t *body)
+{
+    loadgen_stream_t stream = { .fd = fd, .data = buffer, .size = size };
+    char *head_end = NULL;
+
+    while (head_end == NULL) {
+        if (_stream_fill(&stream) != 0) {
+            return -1;
+        }
+        head_end = strstr(buffer, "\r\n\r\n");
+    }
+
+    long content_length = 0;
+    int chunked = 0;
+    // HTTP/1.0 closes unless the server says otherwise
+    int keep_alive = (strncmp(buffer, "HTTP/1.0", 8) != 0);
+
+    for (char *line = strstr(buffer, "\r\n"); line != NULL && line < head_end; line = strstr(line + 2, "\r\n")) {
+        const char *field = line + 2;
+
+        if (strncasecmp(field, "Content-Length:", 15) == 0) {
+            content_length = strtol(field + 15, NULL, 10);
+        } else if (strncasecmp(field, "Transfer-Encoding:", 18) == 0) {
+            const char *value = field + 18;
+            while (*value == ' ') {
+                value++;
+            }
+            chunked = (strncasecmp(value, "chunked", 7) == 0);
+        } else if (strncasecmp(field, "Connection:", 11) == 0) {
+            const char *value = field + 11;
+            while (*value == ' ') {
+                value++;
+            }
+            if (strncasecmp(value, "close", 5) == 0) {
+                keep_alive = 0;
+            } else if (strncasecmp(value, "keep-alive", 10) == 0) {
+                keep_alive = 1;
+            }
+        }
+    }
+
+    stream.pos = (size_t)(head_end - buffer) + 4;
+    if (body != NULL) {
+        body->len = 0;
+    }
+
+    if (content_length < 0) {
+        return -1;
+    }
+
+    // chunked framing overrides Content-Length (RFC 7230 3.3.3)
+    int ret = chunked ? _chunked_body_read(&stream, body) : _stream_body(&stream, (size_t)content_length, body);
+
+    return (ret == 0) ? keep_alive : -1;
+}
+
+static void *_client_thread(void *arg)
+{
+    loadgen_client_t *client = (loadgen_client_t *)arg;
+    char *buffer = malloc(LOADGEN_BUFFER_SIZE);
+    int fd = -1;
+
+    if (buffer == NULL) {
+        client->errors++;
+        return NULL;
+    }
+
+    while (_now_ns() < client->deadline_ns) {
+        if (fd < 0 && (fd = _connect(client->addr)) < 0) {
+            client->errors++;
+            usleep(1000);
+            continue;
+        }
+
+        uint64_t start = _now_ns();
+        int keep_alive = -1;
+        if (_send_all(fd, client->request, client->request_len) == 0) {
+            keep_alive = _response_read(fd, buffer, LOADGEN_BUFFER_SIZE, NULL);
+        }
+        uint64_t elapsed_us = (_now_ns() - start) / 1000;
+
+        if (keep_alive < 0) {
+            client->errors++;
+        } else if (client->sample_count < client->sample_max) {
+            client->samples_us[client->sample_count++] = (uint32_t)elapsed_us;
+        }
+        if (keep_alive <= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    free(buffer);
+
+    return NULL;
+}
+
+static int _compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static int _run(const struct addrinfo *addr, const char *request, int clients, int seconds)
+{
+    loadgen_client_t client[LOADGEN_MAX_CLIENTS];
+    pthread_t thread[LOADGEN_MAX_CLIENTS];
+    size_t per_client = LOADGEN_MAX_SAMPLES / (size_t)clients;
+    uint32_t *samples = malloc(sizeof(uint32_t) * per_client * (size_t)clients);
+    uint64_t deadline_ns = _now_ns() + (uint64_t)seconds * 1000000000ULL;
+    size_t total = 0;
+    uint32_t errors = 0;
+
+    if (samples == NULL) {
+        return -1;
+    }
+
+    for (int i = 0; i < clients; i++) {
+        memset(&client[i], 0, sizeof(client[i]));
+        client[i].addr = addr;
+        client[i].request = request;
+        client[i].request_len = strlen(request);
+        client[i].deadline_ns = deadline_ns;
+        client[i].samples_us = samples + per_client * (size_t)i;
+        client[i].sample_max = per_client;
+        pthread_create(&thread[i], NULL, _client_thread, &client[i]);
+    }
+
+    for (int i = 0; i < clients; i++) {
+        pthread_join(thread[i], NULL);
+        // pack the samples together for sorting
+        memmove(samples + total, client[i].samples_us, client[i].sample_count * sizeof(uint32_t));
+        total += client[i].sample_count;
+        errors += client[i].errors;
+    }
+
+    if (total == 0) {
+        printf("%3d clients: no successful requests, %u errors\n", clients, errors);
+        free(samples);
+        return -1;
+    }
+
+    qsort(samples, total, sizeof(uint32_t), _compare_u32);
+    printf("%3d clients: %9.0f req/s, p50 %6u us, p99 %6u us, %zu requests, %u errors\n", clients,
+           (double)total / seconds, samples[total / 2], samples[total * 99 / 100], total, errors);
+
+    free(samples);
+
+    return (errors == 0) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *host = (argc > 1) ? argv[1] : "127.0.0.1";
+    const char *port = (argc > 2) ? argv[2] : "80";
+    const char *path = (argc > 3) ? argv[3] : "/redfish/v1";
+    int seconds = (argc > 4) ? atoi(argv[4]) : 5;
+    int default_clients[] = { 1, 16, 64 };
+    struct addrinfo hints;
+    struct addrinfo *addr = NULL;
+    char request[1024];
+    int ret = 0;
+
+    if (seconds <= 0) {
+        seconds = 5;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &addr) != 0 || addr == NULL) {
+        fprintf(stderr, "Cannot resolve %s:%s\n", host, port);
+        return 1;
+    }
+
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: %s\r\nAccept: application/json\r\n\r\n", path, host);
+    printf("GET http://%s:%s%s, %d s per run\n", host, port, path, seconds);
+
+    if (argc > 5) {
+        for (int i = 5; i < argc; i++) {
+            int clients = atoi(argv[i]);
+            if (clients < 1 || clients > LOADGEN_MAX_CLIENTS) {
+                fprintf(stderr, "Client count %s out of range 1..%d\n", argv[i], LOADGEN_MAX_CLIENTS);
+                ret = 1;
+                continue;
+            }
+            ret |= (_run(addr, request, clients, seconds) != 0);
+        }
+    } else {
+        for (size_t i = 0; i < sizeof(default_clients) / sizeof(default_clients[0]); i++) {
+            ret |= (_run(addr, request, default_clients[i], seconds) != 0);
+        }
+    }
+
+    freeaddrinfo(addr);
+
+    return ret;
+}
@@ -55,4 +55,51 @@ int control_logic_modbus_device_configs_set(const char *json) {
     return 0;
 }
 
+// Config snapshot read section used around the config arrays in redfish_resources;
+// the dummy configs never change, so there is nothing to guard
+void control_logic_config_read_lock(void) {
+}
+
+void control_logic_config_read_unlock(void) {
+}
+
+// Modbus table change feed used by the event stream; the dummy table never changes
+uint32_t control_logic_modbus_table_generation(void) {
+    return 0;
+}
+
+int control_logic_modbus_table_changes(uint32_t since, uint32_t *generation, uint16_t *addresses, uint16_t *words, int max) {
+    (void)since; (void)addresses; (void)words; (void)max;
+    if (generation) *generation = 0;
+    return 0;
+}
+
+// Sensor history used by the history resources; the dummy records no channels
+int control_logic_history_channels_get(uint16_t *addresses, int max) {
+    (void)addresses; (void)max;
+    return 0;
+}
+
+int control_logic_history_query(uint16_t address, uint64_t from_ms, uint32_t step_ms, void *points, int point_num) {
+    (void)address; (void)from_ms; (void)step_ms; (void)points; (void)point_num;
+    return -1;
+}
+
+// Latency histograms used by the request timing and metrics resources; the dummy drops samples
+uint64_t control_logic_latency_start(void) {
+    return 0;
+}
 
+void control_logic_latency_record(int metric, uint64_t start_ns) {
+    (void)metric; (void)start_ns;
+}
+
+int control_logic_latency_summary_get(int metric, void *summary) {
+    (void)metric; (void)summary;
+    return -1;
+}
+
+const char *control_logic_latency_name(int metric) {
+    (void)metric;
+    return "dummy";
+}
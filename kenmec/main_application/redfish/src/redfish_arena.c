@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "redfish_arena.h"
+
+#define ARENA_ALIGN_UP(n) (((n) + REDFISH_ARENA_ALIGN - 1) & ~(size_t)(REDFISH_ARENA_ALIGN - 1))
+
+void redfish_arena_init(redfish_arena_t *arena, size_t initial_size, size_t limit)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->initial_size = ARENA_ALIGN_UP(initial_size);
+    arena->limit = limit;
+}
+
+// Append a block big enough for size: twice the last block, or more if needed.
+static redfish_arena_block_t *_arena_block_add(redfish_arena_t *arena, redfish_arena_block_t *last, size_t size)
+{
+    size_t block_size = last ? last->size * 2 : arena->initial_size;
+    while (block_size < size) {
+        block_size *= 2;
+    }
+    if (arena->total + block_size > arena->limit) {
+        // Last block may be smaller than the doubling step
+        if (arena->total + size > arena->limit) {
+            return NULL;
+        }
+        block_size = arena->limit - arena->total;
+    }
+
+    redfish_arena_block_t *block = malloc(sizeof(redfish_arena_block_t) + block_size);
+    if (!block) {
+        return NULL;
+    }
+    block->next = NULL;
+    block->size = block_size;
+    block->used = 0;
+
+    if (last) {
+        last->next = block;
+    } else {
+        arena->first = block;
+    }
+    arena->total += block_size;
+
+    return block;
+}
+
+void *redfish_arena_alloc(redfish_arena_t *arena, size_t size)
+{
+    size = ARENA_ALIGN_UP(size > 0 ? size : 1);
+
+    redfish_arena_block_t *block = arena->current;
+    redfish_arena_block_t *last = NULL;
+
+    // Blocks after current are free since the last reset
+    while (block && block->size - block->used < size) {
+        last = block;
+        block = block->next;
+        if (block) {
+            block->used = 0;
+        }
+    }
+    if (!block) {
+        if (!last) {
+            for (last = arena->first; last && last->next; last = last->next) {
+            }
+        }
+        block = _arena_block_add(arena, last, size);
+        if (!block) {
+            return NULL;
+        }
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    arena->current = block;
+    arena->last = ptr;
+
+    return ptr;
+}
+
+void *redfish_arena_grow(redfish_arena_t *arena, void *ptr, size_t old_size, size_t new_size)
+{
+    if (!ptr) {
+        return redfish_arena_alloc(arena, new_size);
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+
+    redfish_arena_block_t *block = arena->current;
+    if (ptr == arena->last && block) {
+        size_t offset = (size_t)((unsigned char *)ptr - block->data);
+        size_t aligned = ARENA_ALIGN_UP(new_size);
+        if (block->size - offset >= aligned) {
+            block->used = offset + aligned;
+            return ptr;
+        }
+    }
+
+    void *grown = redfish_arena_alloc(arena, new_size);
+    if (grown) {
+        memcpy(grown, ptr, old_size);
+    }
+
+    return grown;
+}
+
+void redfish_arena_reset(redfish_arena_t *arena)
+{
+    arena->current = arena->first;
+    if (arena->first) {
+        arena->first->used = 0;
+    }
+    arena->last = NULL;
+}
+
+void redfish_arena_release(redfish_arena_t *arena)
+{
+    redfish_arena_block_t *block = arena->first;
+    while (block) {
+        redfish_arena_block_t *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->total = 0;
+    arena->last = NULL;
+}
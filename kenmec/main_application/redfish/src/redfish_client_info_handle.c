@@ -11,6 +11,7 @@
 #include <config.h>
 #include <cJSON.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "redfish_client_info_handle.h"
 #include "redfish_resources.h"
@@ -19,7 +20,9 @@
 #include <mbedtls/base64.h>
 
 
-static sqlite3 *db = NULL;
+// Handlers open/close the database per call through this handle. Keep it
+// per thread: the HTTP server runs handlers on several workers.
+static __thread sqlite3 *db = NULL;
 // SecurityPolicy table helpers
 static int ensure_security_policy_table(sqlite3 *ldb)
 {
@@ -174,97 +177,370 @@ void generate_secure_token(char *token, size_t length)
 }
 
 
-static bool is_token_valid(const char *token) 
+/*
+ * Authentication cache
+ *
+ * Every authenticated request validates a token or a Basic credential. The
+ * lookups below share one process-wide connection with prepared statements
+ * instead of opening the database per call, and live sessions are kept in
+ * memory:
+ * - a hash table keyed by token for lookups
+ * - a min-heap ordered by expiry, so expired sessions are dropped from the
+ *   top of the heap instead of scanning the sessions table
+ * Session create/delete are written through to sqlite, which remains the
+ * source for the Sessions collection and across restarts.
+ */
+
+#define SESSION_CACHE_BUCKETS 256
+
+typedef struct session_entry {
+    int id;
+    char token[MAX_TOKEN_LENGTH];
+    char username[MAX_USERNAME_LENGTH];
+    char role[MAX_ROLE_LENGTH];
+    time_t expiry;
+    size_t heap_index;
+    struct session_entry *next;                // Hash bucket chain
+} session_entry_t;
+
+typedef enum {
+    AUTH_STMT_ACCOUNT_PASSWORD = 0,
+    AUTH_STMT_ACCOUNT_ROLE,
+    AUTH_STMT_SESSION_SELECT_ALL,
+    AUTH_STMT_SESSION_INSERT,
+    AUTH_STMT_SESSION_DELETE_BY_ID,
+    AUTH_STMT_SESSION_DELETE_BY_TOKEN,
+    AUTH_STMT_NUM,
+} auth_stmt_t;
+
+static const char *auth_stmt_sql[AUTH_STMT_NUM] = {
+    [AUTH_STMT_ACCOUNT_PASSWORD]        = "SELECT password FROM accounts WHERE username = ?;",
+    [AUTH_STMT_ACCOUNT_ROLE]            = "SELECT role FROM accounts WHERE username = ?;",
+    [AUTH_STMT_SESSION_SELECT_ALL]      = "SELECT id, token, username, role, expiry FROM sessions;",
+    [AUTH_STMT_SESSION_INSERT]          = "INSERT INTO sessions (id, token, username, role, expiry) VALUES (?, ?, ?, ?, ?);",
+    [AUTH_STMT_SESSION_DELETE_BY_ID]    = "DELETE FROM sessions WHERE id = ?;",
+    [AUTH_STMT_SESSION_DELETE_BY_TOKEN] = "DELETE FROM sessions WHERE token = ?;",
+};
+
+// Guards auth_db, its statements and the session cache
+static pthread_mutex_t auth_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sqlite3 *auth_db = NULL;
+static sqlite3_stmt *auth_stmts[AUTH_STMT_NUM];
+
+static bool session_cache_loaded = false;
+static session_entry_t *session_buckets[SESSION_CACHE_BUCKETS];
+static session_entry_t **session_heap = NULL;
+static size_t session_heap_size = 0;
+static size_t session_heap_capacity = 0;
+
+// Caller holds auth_mutex. Release the statement with auth_stmt_release().
+static sqlite3_stmt *auth_stmt_get(auth_stmt_t which)
 {
-    const char *sql = "SELECT expiry FROM sessions WHERE token = ?;";
-    sqlite3_stmt *stmt;
-    bool token_found = false;
-    bool token_valid = false;
+    if (!auth_db) {
+        if (sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &auth_db) != SQLITE_OK) {
+            fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(auth_db));
+            sqlite3_close(auth_db);
+            auth_db = NULL;
+            return NULL;
+        }
+        // Other handlers still write through their own connections
+        sqlite3_busy_timeout(auth_db, 1000);
+    }
 
-    int rc = sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &db);
-    if(rc != SQLITE_OK) {
-        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
-        return false;
+    if (!auth_stmts[which]) {
+        if (sqlite3_prepare_v2(auth_db, auth_stmt_sql[which], -1, &auth_stmts[which], NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(auth_db));
+            auth_stmts[which] = NULL;
+            return NULL;
+        }
+    }
+
+    return auth_stmts[which];
+}
+
+static void auth_stmt_release(sqlite3_stmt *stmt)
+{
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+// Look up the role of an account. Caller holds auth_mutex.
+static int auth_account_role_get(const char *username, char *out_role, size_t out_role_size)
+{
+    sqlite3_stmt *stmt = auth_stmt_get(AUTH_STMT_ACCOUNT_ROLE);
+    if (!stmt) {
+        return DB_STATUS_PREPARE_ERROR;
+    }
+
+    int ret = -1;
+    sqlite3_bind_text(stmt, 1, username, -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char *role = sqlite3_column_text(stmt, 0);
+        if (role && out_role && out_role_size > 0) {
+            strncpy(out_role, (const char *)role, out_role_size - 1);
+            out_role[out_role_size - 1] = '\0';
+        }
+        ret = SUCCESS;
+    }
+    auth_stmt_release(stmt);
+
+    return ret;
+}
+
+static uint32_t session_token_hash(const char *token)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*token) {
+        hash ^= (uint8_t)*token++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void session_heap_swap(size_t a, size_t b)
+{
+    session_entry_t *tmp = session_heap[a];
+    session_heap[a] = session_heap[b];
+    session_heap[b] = tmp;
+    session_heap[a]->heap_index = a;
+    session_heap[b]->heap_index = b;
+}
+
+static void session_heap_sift_up(size_t index)
+{
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (session_heap[parent]->expiry <= session_heap[index]->expiry) {
+            break;
+        }
+        session_heap_swap(parent, index);
+        index = parent;
+    }
+}
+
+static void session_heap_sift_down(size_t index)
+{
+    while (1) {
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        size_t smallest = index;
+
+        if (left < session_heap_size && session_heap[left]->expiry < session_heap[smallest]->expiry) {
+            smallest = left;
+        }
+        if (right < session_heap_size && session_heap[right]->expiry < session_heap[smallest]->expiry) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        session_heap_swap(index, smallest);
+        index = smallest;
+    }
+}
+
+static session_entry_t *session_cache_find(const char *token)
+{
+    session_entry_t *entry = session_buckets[session_token_hash(token) % SESSION_CACHE_BUCKETS];
+    while (entry) {
+        if (strcmp(entry->token, token) == 0) {
+            return entry;
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+static session_entry_t *session_cache_find_by_id(int session_id)
+{
+    for (size_t i = 0; i < session_heap_size; i++) {
+        if (session_heap[i]->id == session_id) {
+            return session_heap[i];
+        }
+    }
+    return NULL;
+}
+
+static int session_cache_insert(int id, const char *token, const char *username, const char *role, time_t expiry)
+{
+    if (session_heap_size == session_heap_capacity) {
+        size_t capacity = session_heap_capacity ? session_heap_capacity * 2 : 32;
+        session_entry_t **heap = realloc(session_heap, capacity * sizeof(session_entry_t *));
+        if (!heap) {
+            return ERROR_MEMORY;
+        }
+        session_heap = heap;
+        session_heap_capacity = capacity;
+    }
+
+    session_entry_t *entry = calloc(1, sizeof(session_entry_t));
+    if (!entry) {
+        return ERROR_MEMORY;
+    }
+    entry->id = id;
+    strncpy(entry->token, token, sizeof(entry->token) - 1);
+    strncpy(entry->username, username, sizeof(entry->username) - 1);
+    strncpy(entry->role, role, sizeof(entry->role) - 1);
+    entry->expiry = expiry;
+
+    uint32_t bucket = session_token_hash(entry->token) % SESSION_CACHE_BUCKETS;
+    entry->next = session_buckets[bucket];
+    session_buckets[bucket] = entry;
+
+    entry->heap_index = session_heap_size;
+    session_heap[session_heap_size++] = entry;
+    session_heap_sift_up(entry->heap_index);
+
+    return SUCCESS;
+}
+
+static void session_cache_remove(session_entry_t *entry)
+{
+    session_entry_t **link = &session_buckets[session_token_hash(entry->token) % SESSION_CACHE_BUCKETS];
+    while (*link && *link != entry) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = entry->next;
+    }
+
+    size_t index = entry->heap_index;
+    session_heap_size--;
+    if (index != session_heap_size) {
+        session_heap_swap(index, session_heap_size);
+        session_heap_sift_down(index);
+        session_heap_sift_up(index);
     }
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        printf("Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+    free(entry);
+}
+
+static int session_db_delete_by_id(int session_id)
+{
+    sqlite3_stmt *stmt = auth_stmt_get(AUTH_STMT_SESSION_DELETE_BY_ID);
+    if (!stmt) {
+        return DB_STATUS_PREPARE_ERROR;
+    }
+
+    sqlite3_bind_int(stmt, 1, session_id);
+    int rc = sqlite3_step(stmt);
+    auth_stmt_release(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to delete session by ID: %s\n", sqlite3_errmsg(auth_db));
+        return DB_STATUS_SELECT_ERROR;
+    }
+
+    return sqlite3_changes(auth_db);
+}
+
+// Drop every session whose expiry has passed. Caller holds auth_mutex.
+static int session_cache_expire(time_t now)
+{
+    int count = 0;
+
+    while (session_heap_size > 0 && session_heap[0]->expiry <= now) {
+        session_entry_t *entry = session_heap[0];
+        session_db_delete_by_id(entry->id);
+        session_cache_remove(entry);
+        count++;
+    }
+
+    return count;
+}
+
+static bool session_expiry_parse(const char *expiry_str, time_t *out_expiry)
+{
+    struct tm expiry_tm = {0};
+
+    if (!expiry_str || strptime(expiry_str, "%Y-%m-%d %H:%M:%S", &expiry_tm) == NULL) {
         return false;
     }
+    expiry_tm.tm_isdst = -1;
+    *out_expiry = mktime(&expiry_tm);
 
-    sqlite3_bind_text(stmt, 1, token, -1, SQLITE_STATIC);
+    return true;
+}
 
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        token_found = true;
-        
-        // Get the expiry time from the database
-        const unsigned char *expiry_str = sqlite3_column_text(stmt, 0);
-        if (expiry_str) {
-            // Parse the expiry time string
-            struct tm expiry_tm = {0};
-            if (strptime((const char *)expiry_str, "%Y-%m-%d %H:%M:%S", &expiry_tm) != NULL) {
-                time_t expiry_time = mktime(&expiry_tm);
-                time_t current_time = time(NULL);
-                
-                // Check if the token has expired
-                if (current_time < expiry_time) {
-                    token_valid = true;
-                    printf("Token validation: Token is valid (expires at %s)\n", expiry_str);
-                } else {
-                    printf("Token validation: Token has expired (expired at %s, current time: %ld)\n", 
-                           expiry_str, current_time);
-                }
-            } else {
-                printf("Token validation: Failed to parse expiry time: %s\n", expiry_str);
-            }
-        } else {
-            printf("Token validation: No expiry time found for token\n");
+// Populate the cache from the sessions table once. Caller holds auth_mutex.
+static int session_cache_load(void)
+{
+    if (session_cache_loaded) {
+        return SUCCESS;
+    }
+
+    sqlite3_stmt *stmt = auth_stmt_get(AUTH_STMT_SESSION_SELECT_ALL);
+    if (!stmt) {
+        return DB_STATUS_PREPARE_ERROR;
+    }
+
+    int count = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char *token = sqlite3_column_text(stmt, 1);
+        const unsigned char *username = sqlite3_column_text(stmt, 2);
+        const unsigned char *role = sqlite3_column_text(stmt, 3);
+        time_t expiry = 0;
+
+        if (!token || !username || !role) {
+            continue;
+        }
+        // Unparsable expiry was treated as invalid before: expire it now
+        session_expiry_parse((const char *)sqlite3_column_text(stmt, 4), &expiry);
+
+        if (session_cache_insert(sqlite3_column_int(stmt, 0), (const char *)token,
+                                 (const char *)username, (const char *)role, expiry) == SUCCESS) {
+            count++;
         }
-    } else {
-        printf("Token validation: Token not found in database\n");
     }
+    auth_stmt_release(stmt);
 
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    return token_found && token_valid;
+    session_cache_loaded = true;
+    printf("Session cache loaded %d sessions\n", count);
+
+    return SUCCESS;
+}
+
+static bool is_token_valid(const char *token) 
+{
+    if (!token) return false;
+
+    pthread_mutex_lock(&auth_mutex);
+    session_cache_load();
+    session_cache_expire(time(NULL));
+    bool token_valid = (session_cache_find(token) != NULL);
+    pthread_mutex_unlock(&auth_mutex);
+
+    if (!token_valid) {
+        printf("Token validation: Token not found or expired\n");
+    }
+
+    return token_valid;
 }
 // Helper to get session by token
 static int get_session_by_token(const char *token, char *out_username, size_t out_username_size, char *out_role, size_t out_role_size)
 {
     if (!token) return -1;
-    int rc = sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &db);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
-        return -1;
-    }
-    const char *sql = "SELECT username, role FROM sessions WHERE token = ?;";
-    sqlite3_stmt *stmt = NULL;
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare SELECT session: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
-        return -1;
-    }
-    sqlite3_bind_text(stmt, 1, token, -1, SQLITE_STATIC);
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        const unsigned char *u = sqlite3_column_text(stmt, 0);
-        const unsigned char *r = sqlite3_column_text(stmt, 1);
-        if (u && out_username && out_username_size > 0) {
-            strncpy(out_username, (const char *)u, out_username_size - 1);
+
+    int ret = -1;
+
+    pthread_mutex_lock(&auth_mutex);
+    session_cache_load();
+    session_cache_expire(time(NULL));
+    session_entry_t *entry = session_cache_find(token);
+    if (entry) {
+        if (out_username && out_username_size > 0) {
+            strncpy(out_username, entry->username, out_username_size - 1);
             out_username[out_username_size - 1] = '\0';
         }
-        if (r && out_role && out_role_size > 0) {
-            strncpy(out_role, (const char *)r, out_role_size - 1);
+        if (out_role && out_role_size > 0) {
+            strncpy(out_role, entry->role, out_role_size - 1);
             out_role[out_role_size - 1] = '\0';
         }
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
-        return SUCCESS;
+        ret = SUCCESS;
     }
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    return -1;
+    pthread_mutex_unlock(&auth_mutex);
+
+    return ret;
 }
 
 int get_authenticated_identity(const http_request_t *request,
@@ -312,23 +588,9 @@ int get_authenticated_identity(const http_request_t *request,
                         out_username[out_username_size - 1] = '\0';
                     }
                     // Lookup role from accounts
-                    int rc = sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &db);
-                    if (rc == SQLITE_OK) {
-                        const char *sql = "SELECT role FROM accounts WHERE username = ?;";
-                        sqlite3_stmt *stmt = NULL;
-                        if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-                            sqlite3_bind_text(stmt, 1, username, -1, SQLITE_TRANSIENT);
-                            if (sqlite3_step(stmt) == SQLITE_ROW) {
-                                const unsigned char *role = sqlite3_column_text(stmt, 0);
-                                if (role && out_role && out_role_size > 0) {
-                                    strncpy(out_role, (const char *)role, out_role_size - 1);
-                                    out_role[out_role_size - 1] = '\0';
-                                }
-                            }
-                            sqlite3_finalize(stmt);
-                        }
-                        sqlite3_close(db);
-                    }
+                    pthread_mutex_lock(&auth_mutex);
+                    auth_account_role_get(username, out_role, out_role_size);
+                    pthread_mutex_unlock(&auth_mutex);
                     return SUCCESS;
                 }
             }
@@ -341,30 +603,15 @@ int get_authenticated_identity(const http_request_t *request,
 // Function to clean up expired sessions from the database
 int cleanup_expired_sessions(void)
 {
-    const char *sql = "DELETE FROM sessions WHERE expiry < datetime('now', 'localtime');";
-    char *err_msg = NULL;
-    int rc;
-
-    rc = sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &db);
-    if(rc != SQLITE_OK) {
-        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
-        return -1;
-    }
-
-    rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to cleanup expired sessions: %s\n", err_msg);
-        sqlite3_free(err_msg);
-        sqlite3_close(db);
-        return -1;
-    }
+    pthread_mutex_lock(&auth_mutex);
+    session_cache_load();
+    int deleted_count = session_cache_expire(time(NULL));
+    pthread_mutex_unlock(&auth_mutex);
 
-    int deleted_count = sqlite3_changes(db);
     if (deleted_count > 0) {
         printf("Cleaned up %d expired sessions from database\n", deleted_count);
     }
 
-    sqlite3_close(db);
     return deleted_count;
 }
 
@@ -1383,59 +1630,43 @@ int account_get_by_id(int account_id, account_info_t* account)
 
 db_status_type_t account_check(const char *username, const char *password)
 {
-    int rc = sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &db);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
-        return DB_STATUS_OPEN_ERROR;
-    }
+    db_status_type_t status = DB_STATUS_UNKNOW;
 
-    const char *sql_select = "SELECT password FROM accounts WHERE username = ?;";
-    sqlite3_stmt *stmt;
+    pthread_mutex_lock(&auth_mutex);
 
-    rc = sqlite3_prepare_v2(db, sql_select, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare SELECT statement: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
-        return DB_STATUS_PREPARE_ERROR; 
+    sqlite3_stmt *stmt = auth_stmt_get(AUTH_STMT_ACCOUNT_PASSWORD);
+    if (!stmt) {
+        pthread_mutex_unlock(&auth_mutex);
+        return DB_STATUS_PREPARE_ERROR;
     }
 
     sqlite3_bind_text(stmt, 1, username, -1, SQLITE_TRANSIENT);
 
-    rc = sqlite3_step(stmt);
+    int rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
         const char *password_in_db = (const char *)sqlite3_column_text(stmt, 0);
 
         if (password_in_db == NULL) {
             printf("Password in DB is NULL.\n");
-            sqlite3_finalize(stmt);
-            sqlite3_close(db);
-            return DB_STATUS_PASSWORD_NULL;
-        }
-
-        if (strcmp(password_in_db, password) == 0) {
-            sqlite3_finalize(stmt);
-            sqlite3_close(db);
-            return SUCCESS;
+            status = DB_STATUS_PASSWORD_NULL;
+        } else if (strcmp(password_in_db, password) == 0) {
+            status = SUCCESS;
         } else {
             printf("Password does not match.\n");
-            sqlite3_finalize(stmt);
-            sqlite3_close(db);
-            return DB_STATUS_PASSWORD_MISMATCH; 
+            status = DB_STATUS_PASSWORD_MISMATCH;
         }
-
     } else if (rc == SQLITE_DONE) {
         printf("Username '%s' not found in database.\n", username);
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
-        return DB_STATUS_USERNAME_MISMATCH; 
+        status = DB_STATUS_USERNAME_MISMATCH;
     } else {
-        fprintf(stderr, "Failed to execute SELECT statement: %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
-        return DB_STATUS_SELECT_ERROR; 
+        fprintf(stderr, "Failed to execute SELECT statement: %s\n", sqlite3_errmsg(auth_db));
+        status = DB_STATUS_SELECT_ERROR;
     }
 
-    return DB_STATUS_UNKNOW;
+    auth_stmt_release(stmt);
+    pthread_mutex_unlock(&auth_mutex);
+
+    return status;
 }
 
 
@@ -1446,14 +1677,11 @@ int session_add(const char *username, char *token_out, int* session_id_out)
 
     char token[MAX_TOKEN_LENGTH];
 
-    // Clean up expired sessions before creating new one
-    cleanup_expired_sessions();
-    
-    rc = sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &db);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
-        return DB_STATUS_OPEN_ERROR;
-    }
+    pthread_mutex_lock(&auth_mutex);
+
+    // Expired sessions leave from the top of the heap; no table scan needed
+    session_cache_load();
+    session_cache_expire(time(NULL));
 
     // Generate token
     generate_secure_token(token, MAX_TOKEN_LENGTH);
@@ -1463,64 +1691,40 @@ int session_add(const char *username, char *token_out, int* session_id_out)
     time_t expiry_time = now + SESSION_EXPIRY_SECONDS;
 
     char expiry_str[20];
-    strftime(expiry_str, sizeof(expiry_str), "%Y-%m-%d %H:%M:%S", localtime(&expiry_time));
-
-    // Step 1: Find first available session ID starting from 1
-    const char *sql_find_gap = "SELECT id FROM sessions ORDER BY id;";
-    sqlite3_stmt *stmt_gap;
-    rc = sqlite3_prepare_v2(db, sql_find_gap, -1, &stmt_gap, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare SELECT session IDs: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
-        return DB_STATUS_PREPARE_ERROR;
-    }
+    struct tm expiry_tm;
+    strftime(expiry_str, sizeof(expiry_str), "%Y-%m-%d %H:%M:%S", localtime_r(&expiry_time, &expiry_tm));
 
+    // Step 1: Find first available session ID starting from 1. Every live
+    // session is cached, so one of 1..N+1 is free.
     int session_id = 1;
-    while ((rc = sqlite3_step(stmt_gap)) == SQLITE_ROW) {
-        int existing_id = sqlite3_column_int(stmt_gap, 0);
-        if (existing_id == session_id) {
-            session_id++; // This ID is taken, try next
-        } else {
-            // Found a gap, use this ID
-            break;
+    bool *used = calloc(session_heap_size + 2, sizeof(bool));
+    if (!used) {
+        pthread_mutex_unlock(&auth_mutex);
+        return ERROR_MEMORY;
+    }
+    for (size_t i = 0; i < session_heap_size; i++) {
+        int existing_id = session_heap[i]->id;
+        if (existing_id > 0 && (size_t)existing_id <= session_heap_size + 1) {
+            used[existing_id] = true;
         }
     }
-    sqlite3_finalize(stmt_gap);
-
-    // Step 2: Query role from accounts table
-    const char *sql_get_role =
-        "SELECT role FROM accounts WHERE username = ?;";
-    sqlite3_stmt *stmt_role;
-    rc = sqlite3_prepare_v2(db, sql_get_role, -1, &stmt_role, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare SELECT role: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
-        return DB_STATUS_PREPARE_ERROR;
+    while (used[session_id]) {
+        session_id++;
     }
+    free(used);
 
-    sqlite3_bind_text(stmt_role, 1, username, -1, SQLITE_TRANSIENT);
-
-    char role[64] = {0}; // adjust size as needed
-    rc = sqlite3_step(stmt_role);
-    if (rc == SQLITE_ROW) {
-        const unsigned char *role_text = sqlite3_column_text(stmt_role, 0);
-        strncpy(role, (const char *)role_text, sizeof(role) - 1);
-    } else {
+    // Step 2: Query role from accounts table
+    char role[MAX_ROLE_LENGTH] = {0};
+    if (auth_account_role_get(username, role, sizeof(role)) != SUCCESS) {
         fprintf(stderr, "Role not found for user: %s\n", username);
-        sqlite3_finalize(stmt_role);
-        sqlite3_close(db);
+        pthread_mutex_unlock(&auth_mutex);
         return -1;
     }
-    sqlite3_finalize(stmt_role);
 
     // Step 3: Insert session with specific ID
-    const char *sql_insert_session =
-        "INSERT INTO sessions (id, token, username, role, expiry) VALUES (?, ?, ?, ?, ?);";
-    sqlite3_stmt *stmt;
-    rc = sqlite3_prepare_v2(db, sql_insert_session, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare INSERT session: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
+    sqlite3_stmt *stmt = auth_stmt_get(AUTH_STMT_SESSION_INSERT);
+    if (!stmt) {
+        pthread_mutex_unlock(&auth_mutex);
         return DB_STATUS_PREPARE_ERROR;
     }
 
@@ -1531,18 +1735,20 @@ int session_add(const char *username, char *token_out, int* session_id_out)
     sqlite3_bind_text(stmt, 5, expiry_str, -1, SQLITE_TRANSIENT);
 
     rc = sqlite3_step(stmt);
+    auth_stmt_release(stmt);
     if (rc != SQLITE_DONE) {
-        fprintf(stderr, "Failed to insert session: %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
+        fprintf(stderr, "Failed to insert session: %s\n", sqlite3_errmsg(auth_db));
+        pthread_mutex_unlock(&auth_mutex);
         return -1;
     }
 
+    session_cache_insert(session_id, token, username, role, expiry_time);
+
+    pthread_mutex_unlock(&auth_mutex);
+
     strncpy(token_out, token, MAX_TOKEN_LENGTH);
     *session_id_out = session_id;
 
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
     printf("Session created: id=%d, username=%s, role=%s, token=%s, expiry=%s\n", 
            session_id, username, role, token, expiry_str);
 
@@ -1556,64 +1762,52 @@ int session_delete(const char *token)
         return ERROR_INVALID_PARAM;
     }
 
-    int rc = sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &db);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
-        return DB_STATUS_OPEN_ERROR;
-    }
+    pthread_mutex_lock(&auth_mutex);
 
-    const char *sql_delete = "DELETE FROM sessions WHERE token = ?;";
-    sqlite3_stmt *stmt;
-    rc = sqlite3_prepare_v2(db, sql_delete, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare DELETE session: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
+    sqlite3_stmt *stmt = auth_stmt_get(AUTH_STMT_SESSION_DELETE_BY_TOKEN);
+    if (!stmt) {
+        pthread_mutex_unlock(&auth_mutex);
         return DB_STATUS_PREPARE_ERROR;
     }
 
     sqlite3_bind_text(stmt, 1, token, -1, SQLITE_TRANSIENT);
-    rc = sqlite3_step(stmt);
+    int rc = sqlite3_step(stmt);
+    auth_stmt_release(stmt);
     if (rc != SQLITE_DONE) {
-        fprintf(stderr, "Failed to delete session: %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
+        fprintf(stderr, "Failed to delete session: %s\n", sqlite3_errmsg(auth_db));
+        pthread_mutex_unlock(&auth_mutex);
         return DB_STATUS_SELECT_ERROR;
     }
 
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    if (session_cache_loaded) {
+        session_entry_t *entry = session_cache_find(token);
+        if (entry) {
+            session_cache_remove(entry);
+        }
+    }
+
+    pthread_mutex_unlock(&auth_mutex);
     return SUCCESS;
 }
 
 int session_delete_by_id(int session_id)
 {
-    int rc = sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &db);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
-        return DB_STATUS_OPEN_ERROR;
-    }
+    pthread_mutex_lock(&auth_mutex);
 
-    const char *sql_delete = "DELETE FROM sessions WHERE id = ?;";
-    sqlite3_stmt *stmt;
-    rc = sqlite3_prepare_v2(db, sql_delete, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare DELETE session by ID: %s\n", sqlite3_errmsg(db));
-        sqlite3_close(db);
-        return DB_STATUS_PREPARE_ERROR;
+    int rows_affected = session_db_delete_by_id(session_id);
+    if (rows_affected < 0) {
+        pthread_mutex_unlock(&auth_mutex);
+        return rows_affected;
     }
 
-    sqlite3_bind_int(stmt, 1, session_id);
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        fprintf(stderr, "Failed to delete session by ID: %s\n", sqlite3_errmsg(db));
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
-        return DB_STATUS_SELECT_ERROR;
+    if (session_cache_loaded) {
+        session_entry_t *entry = session_cache_find_by_id(session_id);
+        if (entry) {
+            session_cache_remove(entry);
+        }
     }
 
-    int rows_affected = sqlite3_changes(db);
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    pthread_mutex_unlock(&auth_mutex);
     
     if (rows_affected == 0) {
         return DB_STATUS_USERNAME_MISMATCH; // Session not found
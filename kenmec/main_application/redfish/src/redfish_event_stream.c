@@ -0,0 +1,367 @@
+#include "dexatek/main_application/include/application_common.h"
+#include "kenmec/main_application/control_logic/control_logic_update.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "config.h"
+#include "redfish_event_stream.h"
+
+static const char *tag = "redfish_sse";
+
+#define SSE_WRITE_MAX 16384             // Bytes handed to the transport per write call
+#define SSE_REGISTER_TEXT_MAX 14        // "[65535,65535],"
+
+typedef struct {
+    bool used;
+    redfish_event_stream_ops_t ops;
+    void *ctx;
+    uint32_t generation;                // Changes up to here are queued or sent
+    char *pending;                      // Queued bytes, sent from the front
+    size_t pending_len;
+    size_t pending_size;
+    uint32_t last_queued_ms;
+} sse_subscriber_t;
+
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _cond;
+static pthread_t _thread;
+static bool _running = false;
+static bool _abort = false;
+static uint32_t _interval_ms = REDFISH_SSE_MIN_INTERVAL_MS;
+
+static sse_subscriber_t _subscribers[REDFISH_SSE_MAX_SUBSCRIBERS];
+static int _subscriber_count = 0;
+
+// Generation every up-to-date subscriber has reached
+static uint32_t _published = 0;
+
+// Change list and event text of a tick, reused across ticks
+static uint16_t _addresses[REDFISH_SSE_REGISTERS_MAX];
+static uint16_t _words[REDFISH_SSE_REGISTERS_MAX];
+static char *_event = NULL;
+static size_t _event_size = 0;
+
+static uint32_t _monotonic_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL);
+}
+
+static char *_append_uint(char *p, uint32_t value)
+{
+    char digits[10];
+    int n = 0;
+
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+
+    return p;
+}
+
+// Format the registers changed after since into _event, the whole table for
+// since 0 or a since ahead of the table. Returns the event length, 0 if
+// nothing changed, < 0 on error; *generation is where the change list ends.
+static int _event_format(uint32_t since, uint32_t *generation)
+{
+    int count = control_logic_modbus_table_changes(since, generation, _addresses, _words, REDFISH_SSE_REGISTERS_MAX);
+    if (count <= 0) {
+        return count;
+    }
+
+    size_t need = 96 + (size_t)count * SSE_REGISTER_TEXT_MAX;
+    if (need > _event_size) {
+        char *event = realloc(_event, need);
+        if (!event) {
+            return ERROR_MEMORY;
+        }
+        _event = event;
+        _event_size = need;
+    }
+
+    char *p = _event;
+    p += sprintf(p, "id: %u\nevent: RegisterUpdate\ndata: {\"Generation\":%u,\"Registers\":[", *generation, *generation);
+    for (int i = 0; i < count; i++) {
+        *p++ = '[';
+        p = _append_uint(p, _addresses[i]);
+        *p++ = ',';
+        p = _append_uint(p, _words[i]);
+        *p++ = ']';
+        *p++ = ',';
+    }
+    p--;    // last comma
+    p += sprintf(p, "]}\n\n");
+
+    return (int)(p - _event);
+}
+
+static int _subscriber_queue(sse_subscriber_t *sub, const char *data, size_t len)
+{
+    if (sub->pending_len + len > sub->pending_size) {
+        size_t size = sub->pending_size ? sub->pending_size : 4096;
+        while (size < sub->pending_len + len) {
+            size *= 2;
+        }
+        char *pending = realloc(sub->pending, size);
+        if (!pending) {
+            return ERROR_MEMORY;
+        }
+        sub->pending = pending;
+        sub->pending_size = size;
+    }
+
+    memcpy(sub->pending + sub->pending_len, data, len);
+    sub->pending_len += len;
+    sub->last_queued_ms = _monotonic_ms();
+
+    return SUCCESS;
+}
+
+// Hand queued bytes to the transport until it stops taking them.
+static int _subscriber_flush(sse_subscriber_t *sub)
+{
+    size_t sent = 0;
+
+    while (sent < sub->pending_len) {
+        size_t len = sub->pending_len - sent;
+        int n = sub->ops.write(sub->ctx, sub->pending + sent, len > SSE_WRITE_MAX ? SSE_WRITE_MAX : len);
+        if (n < 0) {
+            return ERROR_NETWORK;
+        }
+        if (n == 0) {
+            break;
+        }
+        sent += (size_t)n;
+    }
+
+    if (sent > 0) {
+        memmove(sub->pending, sub->pending + sent, sub->pending_len - sent);
+        sub->pending_len -= sent;
+    }
+
+    return SUCCESS;
+}
+
+// Called with _mutex held
+static void _subscriber_drop(sse_subscriber_t *sub, const char *reason)
+{
+    debug(tag, "Dropping subscriber: %s", reason);
+
+    sub->ops.close(sub->ctx);
+    free(sub->pending);
+    memset(sub, 0, sizeof(*sub));
+    _subscriber_count--;
+}
+
+// Queue an event (len > 0) or, on a quiet stream, a keepalive comment, then
+// flush. Drops the subscriber if the transport is gone. Called with _mutex held.
+static void _subscriber_send(sse_subscriber_t *sub, const char *event, int len, uint32_t now_ms)
+{
+    int ret = SUCCESS;
+
+    if (len > 0) {
+        ret = _subscriber_queue(sub, event, (size_t)len);
+    } else if (sub->pending_len == 0 && (uint32_t)(now_ms - sub->last_queued_ms) >= REDFISH_SSE_KEEPALIVE_MS) {
+        ret = _subscriber_queue(sub, ": keepalive\n\n", 13);
+    }
+    if (ret == SUCCESS) {
+        ret = _subscriber_flush(sub);
+    }
+    if (ret != SUCCESS) {
+        _subscriber_drop(sub, "write failed");
+    }
+}
+
+// One publication: the shared event goes to every up-to-date subscriber,
+// then subscribers that joined since the last tick get their own catch-up
+// event (formatted into the same buffer).
+static void _event_stream_tick(void)
+{
+    pthread_mutex_lock(&_mutex);
+
+    if (_subscriber_count == 0) {
+        pthread_mutex_unlock(&_mutex);
+        return;
+    }
+
+    uint32_t now_ms = _monotonic_ms();
+    uint32_t shared_since = _published;
+    int len = 0;
+    if (control_logic_modbus_table_generation() != shared_since) {
+        len = _event_format(shared_since, &_published);
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < REDFISH_SSE_MAX_SUBSCRIBERS; i++) {
+            sse_subscriber_t *sub = &_subscribers[i];
+            // Up-to-date subscribers have reached _published after the first pass
+            bool up_to_date = (pass == 0) ? sub->generation == shared_since : sub->generation == _published;
+            if (!sub->used || up_to_date != (pass == 0)) {
+                continue;
+            }
+
+            // Backpressure: the previous events are still not sent
+            if (sub->pending_len > REDFISH_SSE_BACKLOG_MAX) {
+                _subscriber_drop(sub, "slow subscriber");
+                continue;
+            }
+
+            if (pass == 0) {
+                sub->generation = _published;
+            } else {
+                len = _event_format(sub->generation, &sub->generation);
+            }
+            _subscriber_send(sub, _event, len, now_ms);
+        }
+    }
+
+    pthread_mutex_unlock(&_mutex);
+}
+
+static void *_event_stream_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&_mutex);
+    while (!_abort) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += _interval_ms / 1000;
+        deadline.tv_nsec += (long)(_interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (!_abort && pthread_cond_timedwait(&_cond, &_mutex, &deadline) == 0) {
+        }
+        if (_abort) {
+            break;
+        }
+
+        pthread_mutex_unlock(&_mutex);
+        _event_stream_tick();
+        pthread_mutex_lock(&_mutex);
+    }
+    pthread_mutex_unlock(&_mutex);
+
+    return NULL;
+}
+
+int redfish_event_stream_start(uint32_t interval_ms)
+{
+    if (_running) {
+        return SUCCESS;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    _interval_ms = interval_ms < REDFISH_SSE_MIN_INTERVAL_MS ? REDFISH_SSE_MIN_INTERVAL_MS : interval_ms;
+    _abort = false;
+    if (pthread_create(&_thread, NULL, _event_stream_thread, NULL) != 0) {
+        error(tag, "Failed to create event stream thread");
+        pthread_cond_destroy(&_cond);
+        return ERROR_GENERAL;
+    }
+    _running = true;
+
+    info(tag, "Event stream publishing every %u ms", _interval_ms);
+    return SUCCESS;
+}
+
+void redfish_event_stream_stop(void)
+{
+    if (!_running) {
+        return;
+    }
+
+    pthread_mutex_lock(&_mutex);
+    _abort = true;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_mutex);
+    pthread_join(_thread, NULL);
+    pthread_cond_destroy(&_cond);
+    _running = false;
+
+    pthread_mutex_lock(&_mutex);
+    for (int i = 0; i < REDFISH_SSE_MAX_SUBSCRIBERS; i++) {
+        if (_subscribers[i].used) {
+            _subscriber_drop(&_subscribers[i], "server stopping");
+        }
+    }
+    free(_event);
+    _event = NULL;
+    _event_size = 0;
+    pthread_mutex_unlock(&_mutex);
+}
+
+int redfish_event_stream_subscribe(const redfish_event_stream_ops_t *ops, void *ctx, uint32_t since,
+                                   const char *head, size_t head_len)
+{
+    if (!ops || !ops->write || !ops->close) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&_mutex);
+
+    sse_subscriber_t *sub = NULL;
+    for (int i = 0; i < REDFISH_SSE_MAX_SUBSCRIBERS && !sub; i++) {
+        if (!_subscribers[i].used) {
+            sub = &_subscribers[i];
+        }
+    }
+    if (!sub) {
+        pthread_mutex_unlock(&_mutex);
+        warn(tag, "Too many event stream subscribers");
+        return ERROR_GENERAL;
+    }
+
+    memset(sub, 0, sizeof(*sub));
+    sub->ops = *ops;
+    sub->ctx = ctx;
+    sub->generation = since;
+    // The head goes out right away; events follow at the next tick
+    int ret = SUCCESS;
+    if (head_len > 0) {
+        ret = _subscriber_queue(sub, head, head_len);
+        if (ret == SUCCESS) {
+            ret = _subscriber_flush(sub);
+        }
+    }
+    if (ret != SUCCESS) {
+        free(sub->pending);
+        memset(sub, 0, sizeof(*sub));
+        pthread_mutex_unlock(&_mutex);
+        return ret;
+    }
+    sub->used = true;
+    _subscriber_count++;
+
+    pthread_mutex_unlock(&_mutex);
+
+    debug(tag, "New subscriber from generation %u (%d subscribers)", since, _subscriber_count);
+    return SUCCESS;
+}
+
+int redfish_event_stream_subscriber_count(void)
+{
+    pthread_mutex_lock(&_mutex);
+    int count = _subscriber_count;
+    pthread_mutex_unlock(&_mutex);
+
+    return count;
+}
@@ -0,0 +1,1475 @@
+#include "dexatek/main_application/include/application_common.h"
+#include "dexatek/main_application/include/utilities/os_utilities.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "config.h"
+#include "tls_server.h"
+#include "redfish_server.h"
+#include "redfish_http_server.h"
+#include "redfish_arena.h"
+#include "redfish_multipart.h"
+#include "redfish_event_stream.h"
+
+static const char *tag = "redfish_http";
+
+#define HTTP_EPOLL_EVENTS 32
+#define HTTP_SWEEP_INTERVAL_MS 1000
+#define HTTP_UPLOAD_CHUNK_SIZE 8192
+#define HTTP_CONN_BUFFER_INITIAL 2048   // Request buffer at the start of each request
+#define HTTP_CONN_BUFFER_MAX BUFFER_SIZE
+#define HTTP_RESPONSE_HEAD_SIZE 4096
+#define HTTP_CHUNKED_THRESHOLD 4096     // Larger bodies go out chunked to HTTP/1.1 clients
+#define HTTP_CHUNK_SIZE 4096
+#define HTTP_CHUNKS_PER_WRITE 16
+
+typedef enum {
+    HTTP_CONN_KIND_CLIENT = 0,
+    HTTP_CONN_KIND_HTTP_LISTENER,
+    HTTP_CONN_KIND_HTTPS_LISTENER,
+    HTTP_CONN_KIND_WAKEUP,
+} http_conn_kind_t;
+
+typedef enum {
+    HTTP_CONN_STATE_HANDSHAKE = 0,  // TLS handshake in progress
+    HTTP_CONN_STATE_REQUEST,        // Accumulating request head/body in buffer
+    HTTP_CONN_STATE_UPLOAD,         // Streaming a firmware upload body to file
+} http_conn_state_t;
+
+// Header line of the request head, as offsets into the connection buffer
+typedef struct {
+    uint32_t name;
+    uint32_t name_len;
+    uint32_t value;
+    uint32_t value_len;
+} http_header_slice_t;
+
+typedef struct http_conn {
+    http_conn_kind_t kind;
+    int fd;
+    int is_https;
+    http_conn_state_t state;
+    bool busy;                      // Owned by a worker; guarded by _server_mutex
+    uint32_t last_active_ms;
+    int request_count;
+
+    mbedtls_ssl_context ssl;
+    mbedtls_net_context net;
+
+    // The request buffer and header index are allocated from the arena,
+    // which is reset once a request has been consumed
+    redfish_arena_t arena;
+
+    // Incremental parser state for the request at the head of the buffer
+    char *buffer;
+    size_t buffer_size;             // Grows by doubling up to HTTP_CONN_BUFFER_MAX
+    size_t buffer_len;
+    size_t scan_offset;             // Where to resume searching for "\r\n\r\n"
+    size_t header_len;              // 0 until the request head is complete
+    size_t body_len;                // Content-Length of the head request
+    bool continue_sent;             // "100 Continue" already sent for this request
+    http_header_slice_t *headers;   // Header lines of the head, valid while header_len > 0
+    int header_count;
+
+    // Firmware upload in progress
+    http_request_t *upload_request;
+    int upload_fd;
+    size_t upload_remaining;
+    multipart_parser_t *upload_parser;  // NULL: body is stored as received
+
+    // Event stream: length of a TLS write that has to be repeated
+    size_t stream_retry_len;
+
+    struct http_conn *prev;
+    struct http_conn *next;
+} http_conn_t;
+
+typedef struct {
+    pthread_t thread;
+    http_request_t request;
+    http_response_t response;
+    char output[HTTP_RESPONSE_HEAD_SIZE];          // Response head; the body is sent from the response
+    unsigned char chunk[HTTP_UPLOAD_CHUNK_SIZE];    // Upload reads, TLS chunk framing
+} http_worker_t;
+
+// Result of trying to serve the request at the head of a connection buffer
+typedef enum {
+    HTTP_SERVE_NEED_MORE = 0,       // Read more bytes and try again
+    HTTP_SERVE_DONE,                // One request served; keep the connection
+    HTTP_SERVE_CLOSE,               // Close the connection
+    HTTP_SERVE_DETACHED,            // Handed over to the event stream
+} http_serve_result_t;
+
+static pthread_mutex_t _server_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _worker_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t _stopped_cond = PTHREAD_COND_INITIALIZER;
+
+// Handlers were written for a single-threaded server: reads may run
+// concurrently, anything that modifies state runs alone.
+static pthread_rwlock_t _handler_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+static volatile bool _server_abort = false;
+// From worker start until run() has joined them and closed every connection;
+// guarded by _server_mutex, waited on by redfish_http_server_stop()
+static bool _server_running = false;
+static int _epoll_fd = -1;
+static int _wakeup_fd = -1;
+static tls_server_context_t *_tls_ctx = NULL;
+
+// Non-client epoll entries share the connection type so that
+// epoll_event.data.ptr always points at an http_conn_t.
+static http_conn_t _http_listener = { .kind = HTTP_CONN_KIND_HTTP_LISTENER, .fd = -1 };
+static http_conn_t _https_listener = { .kind = HTTP_CONN_KIND_HTTPS_LISTENER, .fd = -1 };
+static http_conn_t _wakeup = { .kind = HTTP_CONN_KIND_WAKEUP, .fd = -1 };
+
+static http_conn_t *_conn_list = NULL;
+static int _conn_count = 0;
+
+// Each connection is queued at most once (EPOLLONESHOT + busy flag), so the
+// queue can never hold more than HTTP_MAX_CONNECTIONS entries.
+static http_conn_t *_job_queue[HTTP_MAX_CONNECTIONS];
+static int _job_queue_head = 0;
+static int _job_queue_count = 0;
+
+static http_worker_t *_workers = NULL;
+static int _worker_num = 0;
+
+static uint32_t _monotonic_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL);
+}
+
+static int _socket_set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return ERROR_NETWORK;
+    }
+    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return ERROR_NETWORK;
+    }
+    return SUCCESS;
+}
+
+static void _server_wakeup(void)
+{
+    uint64_t one = 1;
+
+    if (_wakeup_fd >= 0 && write(_wakeup_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        error(tag, "eventfd write failed: %s", strerror(errno));
+    }
+}
+
+/*
+ * Connection lifecycle
+ */
+
+static http_conn_t *_http_conn_create(int fd, int is_https)
+{
+    http_conn_t *conn = calloc(1, sizeof(http_conn_t));
+    if (!conn) {
+        return NULL;
+    }
+
+    conn->kind = HTTP_CONN_KIND_CLIENT;
+    conn->fd = fd;
+    conn->is_https = is_https;
+    conn->state = is_https ? HTTP_CONN_STATE_HANDSHAKE : HTTP_CONN_STATE_REQUEST;
+    conn->upload_fd = -1;
+    conn->last_active_ms = _monotonic_ms();
+
+    redfish_arena_init(&conn->arena, HTTP_CONN_ARENA_INITIAL_SIZE, HTTP_CONN_ARENA_LIMIT);
+    conn->buffer = redfish_arena_alloc(&conn->arena, HTTP_CONN_BUFFER_INITIAL);
+    if (!conn->buffer) {
+        free(conn);
+        return NULL;
+    }
+    conn->buffer_size = HTTP_CONN_BUFFER_INITIAL;
+
+    if (is_https) {
+        mbedtls_net_init(&conn->net);
+        conn->net.fd = fd;
+        if (tls_server_setup_ssl(_tls_ctx, &conn->ssl, &conn->net) != SUCCESS) {
+            mbedtls_ssl_free(&conn->ssl);
+            redfish_arena_release(&conn->arena);
+            free(conn);
+            return NULL;
+        }
+    }
+
+    return conn;
+}
+
+static void _http_conn_destroy(http_conn_t *conn)
+{
+    if (conn->upload_fd >= 0) {
+        close(conn->upload_fd);
+    }
+    free(conn->upload_request);
+    if (conn->upload_parser) {
+        multipart_parser_free(conn->upload_parser);
+        free(conn->upload_parser);
+    }
+
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+
+    if (conn->is_https) {
+        // Only say goodbye on an established session; close_notify during a
+        // half-finished handshake just produces noise.
+        if (conn->state != HTTP_CONN_STATE_HANDSHAKE) {
+            tls_server_close_client(&conn->ssl, conn->fd);
+        } else {
+            close(conn->fd);
+            mbedtls_ssl_free(&conn->ssl);
+        }
+    } else {
+        close(conn->fd);
+    }
+
+    redfish_arena_release(&conn->arena);
+    free(conn);
+}
+
+static void _http_conn_list_remove(http_conn_t *conn)
+{
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        _conn_list = conn->next;
+    }
+    if (conn->next) {
+        conn->next->prev = conn->prev;
+    }
+    conn->prev = NULL;
+    conn->next = NULL;
+    _conn_count--;
+}
+
+// Worker gives the connection back to the event loop.
+static void _http_conn_rearm(http_conn_t *conn, uint32_t events)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.ptr = conn;
+
+    pthread_mutex_lock(&_server_mutex);
+    conn->busy = false;
+    conn->last_active_ms = _monotonic_ms();
+    // Must happen under the lock: once busy is cleared the idle sweep may
+    // close the fd.
+    int ret = epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+    if (ret != 0) {
+        _http_conn_list_remove(conn);
+    }
+    pthread_mutex_unlock(&_server_mutex);
+
+    if (ret != 0) {
+        error(tag, "epoll_ctl MOD fd %d failed: %s", conn->fd, strerror(errno));
+        _http_conn_destroy(conn);
+    }
+}
+
+// Worker closes a connection it owns.
+static void _http_conn_close(http_conn_t *conn)
+{
+    pthread_mutex_lock(&_server_mutex);
+    _http_conn_list_remove(conn);
+    pthread_mutex_unlock(&_server_mutex);
+
+    _http_conn_destroy(conn);
+}
+
+/*
+ * Socket I/O
+ */
+
+// Returns > 0 bytes read, 0 if no data is available yet, < 0 if the peer
+// closed the connection or an error occurred.
+static int _http_conn_read(http_conn_t *conn, void *buf, size_t len)
+{
+    if (conn->is_https) {
+        int n = mbedtls_ssl_read(&conn->ssl, (unsigned char *)buf, len);
+        if (n > 0) {
+            return n;
+        }
+        if (n == MBEDTLS_ERR_SSL_WANT_READ || n == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            return 0;
+        }
+        if (n != 0 && n != MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY && n != MBEDTLS_ERR_NET_CONN_RESET) {
+            debug(tag, "TLS read on fd %d failed: %s", conn->fd, tls_error_string(n));
+        }
+        return -1;
+    }
+
+    while (1) {
+        ssize_t n = recv(conn->fd, buf, len, 0);
+        if (n > 0) {
+            return (int)n;
+        }
+        if (n == 0) {
+            return -1;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        return -1;
+    }
+}
+
+static int _http_conn_wait(http_conn_t *conn, short events)
+{
+    struct pollfd pfd;
+    pfd.fd = conn->fd;
+    pfd.events = events;
+    pfd.revents = 0;
+
+    int ret;
+    do {
+        ret = poll(&pfd, 1, HTTP_WRITE_TIMEOUT_MS);
+    } while (ret < 0 && errno == EINTR);
+
+    return (ret > 0) ? SUCCESS : ERROR_NETWORK;
+}
+
+// Write the whole buffer, waiting (bounded) for the socket to drain.
+static int _http_conn_write_all(http_conn_t *conn, const char *data, size_t len)
+{
+    size_t total_sent = 0;
+
+    while (total_sent < len) {
+        if (conn->is_https) {
+            int n = mbedtls_ssl_write(&conn->ssl, (const unsigned char *)data + total_sent, len - total_sent);
+            if (n > 0) {
+                total_sent += (size_t)n;
+                continue;
+            }
+            if (n == MBEDTLS_ERR_SSL_WANT_WRITE || n == MBEDTLS_ERR_SSL_WANT_READ) {
+                if (_http_conn_wait(conn, n == MBEDTLS_ERR_SSL_WANT_WRITE ? POLLOUT : POLLIN) != SUCCESS) {
+                    return ERROR_NETWORK;
+                }
+                continue;
+            }
+            debug(tag, "TLS write on fd %d failed: %s", conn->fd, tls_error_string(n));
+            return ERROR_NETWORK;
+        }
+
+        ssize_t n = send(conn->fd, data + total_sent, len - total_sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            total_sent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (_http_conn_wait(conn, POLLOUT) != SUCCESS) {
+                return ERROR_NETWORK;
+            }
+            continue;
+        }
+        return ERROR_NETWORK;
+    }
+
+    return SUCCESS;
+}
+
+// Write an iovec array without gathering it first. Plain sockets take as
+// much as they can per sendmsg(); TLS writes the segments in turn.
+static int _http_conn_writev_all(http_conn_t *conn, struct iovec *iov, int iovcnt)
+{
+    if (conn->is_https) {
+        for (int i = 0; i < iovcnt; i++) {
+            if (_http_conn_write_all(conn, iov[i].iov_base, iov[i].iov_len) != SUCCESS) {
+                return ERROR_NETWORK;
+            }
+        }
+        return SUCCESS;
+    }
+
+    while (iovcnt > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iovcnt;
+
+        ssize_t n = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && _http_conn_wait(conn, POLLOUT) == SUCCESS) {
+                continue;
+            }
+            return ERROR_NETWORK;
+        }
+
+        // Skip what was sent, resume inside a partly sent segment
+        size_t sent = (size_t)n;
+        while (iovcnt > 0 && sent >= iov->iov_len) {
+            sent -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + sent;
+            iov->iov_len -= sent;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/*
+ * Incremental request parsing
+ */
+
+// Look up a header of the parsed head.
+static bool _http_conn_header(const http_conn_t *conn, const char *name, char *value, size_t value_size)
+{
+    size_t name_len = strlen(name);
+
+    for (int i = 0; i < conn->header_count; i++) {
+        const http_header_slice_t *header = &conn->headers[i];
+        if (header->name_len == name_len && strncasecmp(conn->buffer + header->name, name, name_len) == 0) {
+            size_t v_len = header->value_len < value_size ? header->value_len : value_size - 1;
+            memcpy(value, conn->buffer + header->value, v_len);
+            value[v_len] = '\0';
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Index the header lines of a complete head as slices of the buffer.
+static int _http_conn_index_headers(http_conn_t *conn)
+{
+    const char *head_end = conn->buffer + conn->header_len - 2;   // Up to the blank line
+    const char *line = memchr(conn->buffer, '\n', conn->header_len);
+    int count = 0;
+
+    for (const char *p = line; p && p + 1 < head_end; p = memchr(p + 1, '\n', (size_t)(head_end - p - 1))) {
+        count++;
+    }
+
+    conn->header_count = 0;
+    conn->headers = count > 0 ? redfish_arena_alloc(&conn->arena, (size_t)count * sizeof(http_header_slice_t)) : NULL;
+    if (count > 0 && !conn->headers) {
+        return ERROR_MEMORY;
+    }
+
+    while (line && line + 1 < head_end) {
+        line++;
+        const char *line_end = memchr(line, '\n', (size_t)(head_end - line));
+        if (!line_end) {
+            line_end = head_end;
+        }
+        const char *colon = memchr(line, ':', (size_t)(line_end - line));
+        if (colon) {
+            const char *v = colon + 1;
+            while (v < line_end && (*v == ' ' || *v == '\t')) {
+                v++;
+            }
+            const char *v_end = line_end;
+            while (v_end > v && (v_end[-1] == '\r' || v_end[-1] == ' ')) {
+                v_end--;
+            }
+
+            http_header_slice_t *header = &conn->headers[conn->header_count++];
+            header->name = (uint32_t)(line - conn->buffer);
+            header->name_len = (uint32_t)(colon - line);
+            header->value = (uint32_t)(v - conn->buffer);
+            header->value_len = (uint32_t)(v_end - v);
+        }
+        line = line_end < head_end ? line_end : NULL;
+    }
+
+    return SUCCESS;
+}
+
+// Make room for at least size bytes, doubling the buffer. The arena keeps the
+// old copy until the next reset.
+static int _http_conn_buffer_reserve(http_conn_t *conn, size_t size)
+{
+    if (size <= conn->buffer_size) {
+        return SUCCESS;
+    }
+    if (size > HTTP_CONN_BUFFER_MAX) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    size_t new_size = conn->buffer_size;
+    while (new_size < size) {
+        new_size *= 2;
+    }
+    if (new_size > HTTP_CONN_BUFFER_MAX) {
+        new_size = HTTP_CONN_BUFFER_MAX;
+    }
+
+    char *buffer = redfish_arena_grow(&conn->arena, conn->buffer, conn->buffer_len, new_size);
+    if (!buffer) {
+        return ERROR_MEMORY;
+    }
+    conn->buffer = buffer;
+    conn->buffer_size = new_size;
+
+    return SUCCESS;
+}
+
+// Search for the end of the request head, resuming where the last partial
+// read stopped. Fills header_len/body_len once the head is complete.
+static int _http_conn_parse_head(http_conn_t *conn)
+{
+    if (conn->header_len > 0) {
+        return SUCCESS;
+    }
+
+    size_t start = conn->scan_offset > 3 ? conn->scan_offset - 3 : 0;
+    const char *marker = NULL;
+    for (size_t i = start; i + 4 <= conn->buffer_len; i++) {
+        if (conn->buffer[i] == '\r' && memcmp(conn->buffer + i, "\r\n\r\n", 4) == 0) {
+            marker = conn->buffer + i;
+            break;
+        }
+    }
+
+    if (!marker) {
+        conn->scan_offset = conn->buffer_len;
+        return ERROR_GENERAL;
+    }
+
+    conn->header_len = (size_t)(marker - conn->buffer) + 4;
+    if (_http_conn_index_headers(conn) != SUCCESS) {
+        return ERROR_MEMORY;
+    }
+
+    char value[32];
+    conn->body_len = 0;
+    if (_http_conn_header(conn, "Content-Length", value, sizeof(value))) {
+        long content_length = strtol(value, NULL, 10);
+        conn->body_len = content_length > 0 ? (size_t)content_length : 0;
+    }
+
+    return SUCCESS;
+}
+
+// Drop the request at the head of the buffer, keeping pipelined bytes. The
+// arena starts over for the next request: its blocks are kept, so the
+// pipelined bytes are still readable while they are moved to the new buffer.
+static int _http_conn_consume(http_conn_t *conn, size_t len)
+{
+    const char *rest = conn->buffer + len;
+    size_t rest_len = len < conn->buffer_len ? conn->buffer_len - len : 0;
+    size_t size = rest_len < HTTP_CONN_BUFFER_INITIAL ? HTTP_CONN_BUFFER_INITIAL : conn->buffer_size;
+
+    redfish_arena_reset(&conn->arena);
+    conn->buffer = redfish_arena_alloc(&conn->arena, size);
+    conn->buffer_size = size;
+    conn->buffer_len = 0;
+
+    conn->scan_offset = 0;
+    conn->header_len = 0;
+    conn->body_len = 0;
+    conn->continue_sent = false;
+    conn->headers = NULL;
+    conn->header_count = 0;
+
+    if (!conn->buffer) {
+        conn->buffer_size = 0;
+        return ERROR_MEMORY;
+    }
+    memmove(conn->buffer, rest, rest_len);
+    conn->buffer_len = rest_len;
+
+    return SUCCESS;
+}
+
+static bool _http_conn_is_http10(const http_conn_t *conn)
+{
+    const char *line_end = memchr(conn->buffer, '\n', conn->header_len);
+
+    return line_end && line_end - conn->buffer >= 9 && memcmp(line_end - 9, "HTTP/1.0", 8) == 0;
+}
+
+// HTTP/1.1 is persistent unless the client says otherwise; HTTP/1.0 only
+// with an explicit keep-alive.
+static bool _http_conn_wants_keepalive(const http_conn_t *conn)
+{
+    char value[32];
+    bool has_connection = _http_conn_header(conn, "Connection", value, sizeof(value));
+
+    if (has_connection && strcasecmp(value, "close") == 0) {
+        return false;
+    }
+
+    if (_http_conn_is_http10(conn)) {
+        return has_connection && strcasecmp(value, "keep-alive") == 0;
+    }
+
+    return true;
+}
+
+/*
+ * Request handling
+ */
+
+static bool _http_method_is_read_only(const char *method)
+{
+    return strcmp(method, HTTP_METHOD_GET) == 0 ||
+           strcmp(method, HTTP_METHOD_HEAD) == 0 ||
+           strcmp(method, "OPTIONS") == 0;
+}
+
+static void _http_response_add_header(http_response_t *response, const char *name, const char *value)
+{
+    if (response->header_count >= MAX_HEADERS) {
+        return;
+    }
+    snprintf(response->headers[response->header_count][0], sizeof(response->headers[0][0]), "%s", name);
+    snprintf(response->headers[response->header_count][1], sizeof(response->headers[0][1]), "%s", value);
+    response->header_count++;
+}
+
+// Body as chunks of HTTP_CHUNK_SIZE after the head. Plain sockets send the
+// chunk data straight from the body with the framing in between; TLS copies
+// its input into records anyway, so each chunk is framed in worker->chunk.
+static int _http_send_chunked(http_conn_t *conn, http_worker_t *worker, const char *head, size_t head_len,
+                              const char *body, size_t body_len)
+{
+    static const char last_chunk[] = "0\r\n\r\n";
+    size_t offset = 0;
+
+    if (conn->is_https) {
+        if (_http_conn_write_all(conn, head, head_len) != SUCCESS) {
+            return ERROR_NETWORK;
+        }
+        while (offset < body_len) {
+            size_t n = body_len - offset < HTTP_CHUNK_SIZE ? body_len - offset : HTTP_CHUNK_SIZE;
+            char *frame = (char *)worker->chunk;
+            int frame_len = snprintf(frame, sizeof(worker->chunk), "%zx\r\n", n);
+            memcpy(frame + frame_len, body + offset, n);
+            memcpy(frame + frame_len + n, "\r\n", 2);
+            if (_http_conn_write_all(conn, frame, (size_t)frame_len + n + 2) != SUCCESS) {
+                return ERROR_NETWORK;
+            }
+            offset += n;
+        }
+        return _http_conn_write_all(conn, last_chunk, sizeof(last_chunk) - 1);
+    }
+
+    char sizes[HTTP_CHUNKS_PER_WRITE][16];
+    struct iovec iov[HTTP_CHUNKS_PER_WRITE * 3 + 2];
+    int iovcnt = 0;
+
+    iov[iovcnt].iov_base = (void *)head;
+    iov[iovcnt++].iov_len = head_len;
+
+    bool done = false;
+    while (!done) {
+        for (int i = 0; i < HTTP_CHUNKS_PER_WRITE && offset < body_len; i++) {
+            size_t n = body_len - offset < HTTP_CHUNK_SIZE ? body_len - offset : HTTP_CHUNK_SIZE;
+            int size_len = snprintf(sizes[i], sizeof(sizes[i]), "%zx\r\n", n);
+            iov[iovcnt].iov_base = sizes[i];
+            iov[iovcnt++].iov_len = (size_t)size_len;
+            iov[iovcnt].iov_base = (void *)(body + offset);
+            iov[iovcnt++].iov_len = n;
+            iov[iovcnt].iov_base = (void *)"\r\n";
+            iov[iovcnt++].iov_len = 2;
+            offset += n;
+        }
+        done = offset == body_len;
+        if (done) {
+            iov[iovcnt].iov_base = (void *)last_chunk;
+            iov[iovcnt++].iov_len = sizeof(last_chunk) - 1;
+        }
+
+        if (_http_conn_writev_all(conn, iov, iovcnt) != SUCCESS) {
+            return ERROR_NETWORK;
+        }
+        iovcnt = 0;
+    }
+
+    return SUCCESS;
+}
+
+// Send head and body; the body is never copied into the worker.
+static int _http_send_response(http_conn_t *conn, http_worker_t *worker, const http_response_t *response,
+                               bool allow_chunked)
+{
+    const char *body = redfish_response_body(response);
+    size_t body_len = response->content_length > 0 ? (size_t)response->content_length : 0;
+    bool chunked = allow_chunked && body_len > HTTP_CHUNKED_THRESHOLD;
+
+    int head_len = generate_http_response_head(response, chunked, worker->output, sizeof(worker->output));
+    if (head_len < 0) {
+        error(tag, "Response head too large");
+        return ERROR_GENERAL;
+    }
+
+    if (chunked) {
+        return _http_send_chunked(conn, worker, worker->output, (size_t)head_len, body, body_len);
+    }
+
+    struct iovec iov[2];
+    iov[0].iov_base = worker->output;
+    iov[0].iov_len = (size_t)head_len;
+    iov[1].iov_base = (void *)body;
+    iov[1].iov_len = body_len;
+
+    return _http_conn_writev_all(conn, iov, body_len > 0 ? 2 : 1);
+}
+
+static int _http_send_error(http_conn_t *conn, http_worker_t *worker, int status_code)
+{
+    http_response_t *response = &worker->response;
+
+    memset(response, 0, sizeof(http_response_t));
+    response->status_code = status_code;
+    strcpy(response->content_type, CONTENT_TYPE_JSON);
+    _http_response_add_header(response, "Connection", "close");
+
+    return _http_send_response(conn, worker, response, false);
+}
+
+/*
+ * Event stream subscribers
+ */
+
+// Non-blocking write for the event stream publisher
+static int _http_stream_write(void *ctx, const void *data, size_t len)
+{
+    http_conn_t *conn = ctx;
+
+    if (conn->is_https) {
+        // mbedTLS wants an interrupted write repeated with the same length;
+        // the stream keeps unsent bytes at the front, so len never shrinks
+        if (conn->stream_retry_len > 0) {
+            len = conn->stream_retry_len;
+        }
+        int n = mbedtls_ssl_write(&conn->ssl, (const unsigned char *)data, len);
+        if (n > 0) {
+            conn->stream_retry_len = 0;
+            return n;
+        }
+        if (n == MBEDTLS_ERR_SSL_WANT_WRITE || n == MBEDTLS_ERR_SSL_WANT_READ) {
+            conn->stream_retry_len = len;
+            return 0;
+        }
+        return -1;
+    }
+
+    while (1) {
+        ssize_t n = send(conn->fd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n >= 0) {
+            return (int)n;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        return -1;
+    }
+}
+
+static void _http_stream_close(void *ctx)
+{
+    _http_conn_destroy((http_conn_t *)ctx);
+}
+
+static const redfish_event_stream_ops_t _http_stream_ops = {
+    .write = _http_stream_write,
+    .close = _http_stream_close,
+};
+
+// Send the head of an event stream response and hand the connection to the
+// publisher. It leaves the connection list and epoll: from here on only the
+// publisher writes to it, and it closes it when the client goes away.
+static http_serve_result_t _http_stream_attach(http_conn_t *conn, http_worker_t *worker, const http_request_t *request)
+{
+    http_response_t *response = &worker->response;
+    uint32_t since = 0;
+
+    for (int i = 0; i < request->header_count; i++) {
+        if (strcasecmp(request->headers[i][0], "Last-Event-ID") == 0) {
+            since = (uint32_t)strtoul(request->headers[i][1], NULL, 10);
+            break;
+        }
+    }
+
+    int head_len = generate_http_response_head(response, 0, worker->output, sizeof(worker->output));
+    if (head_len < 0) {
+        return HTTP_SERVE_CLOSE;
+    }
+
+    pthread_mutex_lock(&_server_mutex);
+    _http_conn_list_remove(conn);
+    pthread_mutex_unlock(&_server_mutex);
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+
+    if (redfish_event_stream_subscribe(&_http_stream_ops, conn, since, worker->output, (size_t)head_len) != SUCCESS) {
+        _http_send_error(conn, worker, HTTP_SERVICE_UNAVAILABLE);
+        _http_conn_destroy(conn);
+    }
+
+    return HTTP_SERVE_DETACHED;
+}
+
+// Run the handler for a fully received request and send the response.
+static http_serve_result_t _http_dispatch(http_conn_t *conn, http_worker_t *worker, http_request_t *request,
+                                          bool keep_alive, bool allow_chunked)
+{
+    http_response_t *response = &worker->response;
+
+    debug(tag, "%s %s (fd %d, %s)", request->method, request->path, conn->fd, conn->is_https ? "HTTPS" : "HTTP");
+
+    memset(response, 0, sizeof(http_response_t));
+
+    bool read_only = _http_method_is_read_only(request->method);
+    if (read_only) {
+        pthread_rwlock_rdlock(&_handler_lock);
+    } else {
+        pthread_rwlock_wrlock(&_handler_lock);
+    }
+    int ret = process_redfish_request(request, response);
+    pthread_rwlock_unlock(&_handler_lock);
+
+    if (ret != SUCCESS) {
+        error(tag, "Failed to process Redfish request");
+        // the handler may have built a body before failing
+        redfish_response_clear_body(response);
+        return HTTP_SERVE_CLOSE;
+    }
+
+    if (response->event_stream) {
+        return _http_stream_attach(conn, worker, request);
+    }
+
+    conn->request_count++;
+    if (conn->request_count >= HTTP_KEEPALIVE_MAX_REQUESTS || _server_abort ||
+        response->post_action != LABEL_POST_ACTION_NONE) {
+        keep_alive = false;
+    }
+    _http_response_add_header(response, "Connection", keep_alive ? "keep-alive" : "close");
+
+    ret = _http_send_response(conn, worker, response, allow_chunked);
+    redfish_response_clear_body(response);
+    if (ret != SUCCESS) {
+        error(tag, "Failed to send response on fd %d", conn->fd);
+        return HTTP_SERVE_CLOSE;
+    }
+
+    return keep_alive ? HTTP_SERVE_DONE : HTTP_SERVE_CLOSE;
+}
+
+static void _http_send_continue(http_conn_t *conn)
+{
+    char value[32];
+
+    if (conn->continue_sent) {
+        return;
+    }
+    conn->continue_sent = true;
+
+    if (_http_conn_header(conn, "Expect", value, sizeof(value)) &&
+        strncasecmp(value, "100-continue", 12) == 0) {
+        const char *cont = "HTTP/1.1 100 Continue\r\n\r\n";
+        (void)_http_conn_write_all(conn, cont, strlen(cont));
+    }
+}
+
+// Parse the request head at the front of the buffer and decide what to do.
+static http_serve_result_t _http_serve_buffered(http_conn_t *conn, http_worker_t *worker)
+{
+    http_request_t *request = &worker->request;
+    int ret;
+
+    ret = _http_conn_parse_head(conn);
+    if (ret == ERROR_MEMORY) {
+        warn(tag, "Request head too large on fd %d", conn->fd);
+        _http_send_error(conn, worker, HTTP_BAD_REQUEST);
+        return HTTP_SERVE_CLOSE;
+    }
+    if (ret != SUCCESS) {
+        if (conn->buffer_len >= HTTP_CONN_BUFFER_MAX - 1) {
+            warn(tag, "Request head too large on fd %d", conn->fd);
+            _http_send_error(conn, worker, HTTP_BAD_REQUEST);
+            return HTTP_SERVE_CLOSE;
+        }
+        return HTTP_SERVE_NEED_MORE;
+    }
+
+    // parse_http_request() works on C strings: terminate the head in place
+    char saved = conn->buffer[conn->header_len];
+    conn->buffer[conn->header_len] = '\0';
+    ret = parse_http_request(conn->buffer, request, conn->is_https);
+    conn->buffer[conn->header_len] = saved;
+    if (ret != SUCCESS) {
+        error(tag, "Failed to parse HTTP request");
+        _http_send_error(conn, worker, HTTP_BAD_REQUEST);
+        return HTTP_SERVE_CLOSE;
+    }
+
+    bool keep_alive = _http_conn_wants_keepalive(conn);
+    bool allow_chunked = !_http_conn_is_http10(conn);
+
+    // Large multipart uploads bypass the buffer and go straight to file
+    if (strcmp(request->method, HTTP_METHOD_POST) == 0 && strstr(request->path, "/UpdateFirmwareMultipart") != NULL) {
+        conn->upload_request = malloc(sizeof(http_request_t));
+        if (!conn->upload_request) {
+            return HTTP_SERVE_CLOSE;
+        }
+        memcpy(conn->upload_request, request, sizeof(http_request_t));
+
+        system_firmware_file_path(conn->upload_request->upload_tmp_path);
+        conn->upload_fd = open(conn->upload_request->upload_tmp_path, O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0600);
+        if (conn->upload_fd < 0) {
+            error(tag, "Failed to create temp upload file");
+            return HTTP_SERVE_CLOSE;
+        }
+
+        // Unpack multipart bodies on the fly so only the image reaches the file
+        char content_type[MAX_HEADER_VALUE_LEN];
+        char boundary[MULTIPART_BOUNDARY_MAX_LEN + 1];
+        if (_http_conn_header(conn, "Content-Type", content_type, sizeof(content_type)) &&
+            strstr(content_type, "multipart/") &&
+            multipart_boundary_from_content_type(content_type, boundary, sizeof(boundary)) == SUCCESS) {
+            conn->upload_parser = malloc(sizeof(multipart_parser_t));
+            if (!conn->upload_parser) {
+                return HTTP_SERVE_CLOSE;
+            }
+            multipart_parser_init(conn->upload_parser, boundary, conn->upload_fd);
+        }
+
+        _http_send_continue(conn);
+
+        conn->upload_remaining = conn->body_len;
+        conn->state = HTTP_CONN_STATE_UPLOAD;
+        if (_http_conn_consume(conn, conn->header_len) != SUCCESS) {
+            return HTTP_SERVE_CLOSE;
+        }
+        return HTTP_SERVE_DONE;
+    }
+
+    if (conn->body_len >= sizeof(request->body) || conn->header_len + conn->body_len > HTTP_CONN_BUFFER_MAX - 1 ||
+        _http_conn_buffer_reserve(conn, conn->header_len + conn->body_len + 1) != SUCCESS) {
+        warn(tag, "Request body too large (%zu bytes) on fd %d", conn->body_len, conn->fd);
+        _http_send_error(conn, worker, HTTP_BAD_REQUEST);
+        return HTTP_SERVE_CLOSE;
+    }
+
+    if (conn->buffer_len < conn->header_len + conn->body_len) {
+        _http_send_continue(conn);
+        return HTTP_SERVE_NEED_MORE;
+    }
+
+    // Body may contain bytes of the next pipelined request: copy exactly
+    // Content-Length bytes instead of relying on the string copy above.
+    memcpy(request->body, conn->buffer + conn->header_len, conn->body_len);
+    request->body[conn->body_len] = '\0';
+    request->content_length = (int)conn->body_len;
+
+    if (_http_conn_consume(conn, conn->header_len + conn->body_len) != SUCCESS) {
+        return HTTP_SERVE_CLOSE;
+    }
+
+    return _http_dispatch(conn, worker, request, keep_alive, allow_chunked);
+}
+
+// Pass received upload bytes to the multipart parser, or to the file as is.
+// A malformed multipart body is not fatal here: the rest of the body is
+// drained and the handler reports the error.
+static bool _http_upload_write(http_conn_t *conn, const void *data, size_t len)
+{
+    if (conn->upload_parser) {
+        if (multipart_parser_feed(conn->upload_parser, data, len) != SUCCESS &&
+            conn->upload_request->upload_extracted == 0) {
+            warn(tag, "Malformed multipart upload on fd %d", conn->fd);
+            conn->upload_request->upload_extracted = -1;
+        }
+        return true;
+    }
+    return write(conn->upload_fd, data, len) == (ssize_t)len;
+}
+
+// Move upload bytes to the temp file. Returns DONE when the upload request
+// has been answered, NEED_MORE when waiting for data.
+static http_serve_result_t _http_serve_upload(http_conn_t *conn, http_worker_t *worker)
+{
+    if (conn->buffer_len > 0 && conn->upload_remaining > 0) {
+        size_t n = conn->buffer_len < conn->upload_remaining ? conn->buffer_len : conn->upload_remaining;
+        if (!_http_upload_write(conn, conn->buffer, n)) {
+            error(tag, "Failed to write upload bytes");
+            return HTTP_SERVE_CLOSE;
+        }
+        conn->upload_remaining -= n;
+        if (_http_conn_consume(conn, n) != SUCCESS) {
+            return HTTP_SERVE_CLOSE;
+        }
+    }
+
+    while (conn->upload_remaining > 0) {
+        size_t to_read = conn->upload_remaining > sizeof(worker->chunk) ? sizeof(worker->chunk) : conn->upload_remaining;
+        int n = _http_conn_read(conn, worker->chunk, to_read);
+        if (n == 0) {
+            return HTTP_SERVE_NEED_MORE;
+        }
+        if (n < 0) {
+            error(tag, "Failed to read remaining upload bytes");
+            return HTTP_SERVE_CLOSE;
+        }
+        if (!_http_upload_write(conn, worker->chunk, (size_t)n)) {
+            error(tag, "Failed to write upload chunk");
+            return HTTP_SERVE_CLOSE;
+        }
+        conn->upload_remaining -= (size_t)n;
+    }
+
+    fsync(conn->upload_fd);
+    close(conn->upload_fd);
+    conn->upload_fd = -1;
+
+    http_request_t *request = conn->upload_request;
+    conn->upload_request = NULL;
+
+    if (conn->upload_parser) {
+        if (request->upload_extracted == 0) {
+            if (multipart_parser_finish(conn->upload_parser, &request->upload_bytes, request->upload_sha256) == SUCCESS) {
+                request->upload_extracted = 1;
+                info(tag, "Firmware image received: %ld bytes, sha256 %s", request->upload_bytes, request->upload_sha256);
+            } else {
+                request->upload_extracted = -1;
+            }
+        }
+        multipart_parser_free(conn->upload_parser);
+        free(conn->upload_parser);
+        conn->upload_parser = NULL;
+    }
+    conn->state = HTTP_CONN_STATE_REQUEST;
+
+    // The device usually restarts after an upload: do not keep the connection
+    http_serve_result_t result = _http_dispatch(conn, worker, request, false, false);
+    free(request);
+
+    return result;
+}
+
+// Serve everything that is available on a connection owned by this worker,
+// then either hand it back to epoll or close it.
+static void _http_conn_process(http_conn_t *conn, http_worker_t *worker)
+{
+    if (conn->state == HTTP_CONN_STATE_HANDSHAKE) {
+        int ret = mbedtls_ssl_handshake(&conn->ssl);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            _http_conn_rearm(conn, ret == MBEDTLS_ERR_SSL_WANT_READ ? EPOLLIN : EPOLLOUT);
+            return;
+        }
+        if (ret != 0) {
+            debug(tag, "SSL handshake on fd %d failed: %s", conn->fd, tls_error_string(ret));
+            _http_conn_close(conn);
+            return;
+        }
+        debug(tag, "TLS established on fd %d (%s, %s)", conn->fd,
+              mbedtls_ssl_get_version(&conn->ssl), mbedtls_ssl_get_ciphersuite(&conn->ssl));
+        conn->state = HTTP_CONN_STATE_REQUEST;
+    }
+
+    while (!_server_abort) {
+        http_serve_result_t result;
+
+        if (conn->state == HTTP_CONN_STATE_UPLOAD) {
+            result = _http_serve_upload(conn, worker);
+        } else {
+            result = _http_serve_buffered(conn, worker);
+        }
+
+        if (result == HTTP_SERVE_CLOSE) {
+            label_post_action_t post_action = worker->response.post_action;
+            const char *context = conn->is_https ? "HTTPS client" : "HTTP client";
+
+            _http_conn_close(conn);
+
+            // Execute post action once the response is out and the socket closed
+            if (post_action != LABEL_POST_ACTION_NONE) {
+                printf("Executing post action %d after response sent\n", post_action);
+                redfish_server_post_action(post_action, context);
+            }
+            return;
+        }
+        if (result == HTTP_SERVE_DETACHED) {
+            return;
+        }
+        if (result == HTTP_SERVE_DONE) {
+            // Pipelined requests may already be buffered
+            continue;
+        }
+
+        // HTTP_SERVE_NEED_MORE
+        if (conn->state == HTTP_CONN_STATE_UPLOAD) {
+            _http_conn_rearm(conn, EPOLLIN);
+            return;
+        }
+
+        // Grow the buffer once it is full, up to HTTP_CONN_BUFFER_MAX
+        if (conn->buffer_len + 1 >= conn->buffer_size &&
+            _http_conn_buffer_reserve(conn, conn->buffer_size * 2) != SUCCESS) {
+            _http_conn_close(conn);
+            return;
+        }
+
+        int n = _http_conn_read(conn, conn->buffer + conn->buffer_len, conn->buffer_size - 1 - conn->buffer_len);
+        if (n < 0) {
+            _http_conn_close(conn);
+            return;
+        }
+        if (n == 0) {
+            _http_conn_rearm(conn, EPOLLIN);
+            return;
+        }
+        conn->buffer_len += (size_t)n;
+    }
+
+    _http_conn_close(conn);
+}
+
+static void *_http_worker_thread_func(void *arg)
+{
+    http_worker_t *worker = (http_worker_t *)arg;
+
+    while (1) {
+        pthread_mutex_lock(&_server_mutex);
+        while (_job_queue_count == 0 && !_server_abort) {
+            pthread_cond_wait(&_worker_cond, &_server_mutex);
+        }
+        if (_server_abort) {
+            pthread_mutex_unlock(&_server_mutex);
+            break;
+        }
+        http_conn_t *conn = _job_queue[_job_queue_head];
+        _job_queue_head = (_job_queue_head + 1) % HTTP_MAX_CONNECTIONS;
+        _job_queue_count--;
+        pthread_mutex_unlock(&_server_mutex);
+
+        memset(&worker->response, 0, sizeof(worker->response));
+        _http_conn_process(conn, worker);
+    }
+
+    return NULL;
+}
+
+/*
+ * Event loop
+ */
+
+static int _http_epoll_add(http_conn_t *conn, uint32_t events)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = conn;
+
+    return epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, conn->fd, &ev) == 0 ? SUCCESS : ERROR_NETWORK;
+}
+
+static void _http_accept(int listen_fd, int is_https)
+{
+    while (1) {
+        int client_fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                error(tag, "accept failed: %s", strerror(errno));
+            }
+            return;
+        }
+
+        pthread_mutex_lock(&_server_mutex);
+        bool full = (_conn_count >= HTTP_MAX_CONNECTIONS);
+        pthread_mutex_unlock(&_server_mutex);
+        if (full) {
+            warn(tag, "Too many connections, rejecting fd %d", client_fd);
+            close(client_fd);
+            continue;
+        }
+
+        int opt = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+        http_conn_t *conn = _http_conn_create(client_fd, is_https);
+        if (!conn) {
+            close(client_fd);
+            continue;
+        }
+
+        pthread_mutex_lock(&_server_mutex);
+        conn->next = _conn_list;
+        if (_conn_list) {
+            _conn_list->prev = conn;
+        }
+        _conn_list = conn;
+        _conn_count++;
+        int ret = _http_epoll_add(conn, EPOLLIN | EPOLLRDHUP | EPOLLONESHOT);
+        if (ret != SUCCESS) {
+            _http_conn_list_remove(conn);
+        }
+        pthread_mutex_unlock(&_server_mutex);
+
+        if (ret != SUCCESS) {
+            error(tag, "Failed to add fd %d to epoll", client_fd);
+            _http_conn_destroy(conn);
+            continue;
+        }
+
+        debug(tag, "New %s connection on fd %d", is_https ? "HTTPS" : "HTTP", client_fd);
+    }
+}
+
+// Close kept-alive connections that have been idle for too long. Busy
+// connections belong to a worker and are left alone.
+static void _http_sweep_idle(void)
+{
+    http_conn_t *expired = NULL;
+    uint32_t now_ms = _monotonic_ms();
+
+    pthread_mutex_lock(&_server_mutex);
+    http_conn_t *conn = _conn_list;
+    while (conn) {
+        http_conn_t *next = conn->next;
+        if (!conn->busy && (uint32_t)(now_ms - conn->last_active_ms) > HTTP_KEEPALIVE_TIMEOUT_MS) {
+            _http_conn_list_remove(conn);
+            conn->next = expired;
+            expired = conn;
+        }
+        conn = next;
+    }
+    pthread_mutex_unlock(&_server_mutex);
+
+    while (expired) {
+        http_conn_t *next = expired->next;
+        debug(tag, "Closing idle connection fd %d", expired->fd);
+        _http_conn_destroy(expired);
+        expired = next;
+    }
+}
+
+static void _http_dispatch_event(http_conn_t *conn)
+{
+    pthread_mutex_lock(&_server_mutex);
+    conn->busy = true;
+    _job_queue[(_job_queue_head + _job_queue_count) % HTTP_MAX_CONNECTIONS] = conn;
+    _job_queue_count++;
+    pthread_cond_signal(&_worker_cond);
+    pthread_mutex_unlock(&_server_mutex);
+}
+
+static int _http_server_open(int http_fd, int https_fd)
+{
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    _wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_epoll_fd < 0 || _wakeup_fd < 0) {
+        error(tag, "Failed to create epoll/eventfd: %s", strerror(errno));
+        return ERROR_NETWORK;
+    }
+
+    _wakeup.fd = _wakeup_fd;
+    if (_http_epoll_add(&_wakeup, EPOLLIN) != SUCCESS) {
+        return ERROR_NETWORK;
+    }
+
+    if (http_fd >= 0) {
+        _http_listener.fd = http_fd;
+        _socket_set_nonblocking(http_fd);
+        if (_http_epoll_add(&_http_listener, EPOLLIN) != SUCCESS) {
+            return ERROR_NETWORK;
+        }
+    }
+
+    if (https_fd >= 0) {
+        _https_listener.fd = https_fd;
+        _socket_set_nonblocking(https_fd);
+        if (_http_epoll_add(&_https_listener, EPOLLIN) != SUCCESS) {
+            return ERROR_NETWORK;
+        }
+    }
+
+    return SUCCESS;
+}
+
+static void _http_server_close(void)
+{
+    // Workers are gone: every remaining connection can be torn down here
+    while (_conn_list) {
+        http_conn_t *conn = _conn_list;
+        _http_conn_list_remove(conn);
+        _http_conn_destroy(conn);
+    }
+    _job_queue_head = 0;
+    _job_queue_count = 0;
+
+    pthread_mutex_lock(&_server_mutex);
+    if (_wakeup_fd >= 0) {
+        close(_wakeup_fd);
+        _wakeup_fd = -1;
+    }
+    pthread_mutex_unlock(&_server_mutex);
+    if (_epoll_fd >= 0) {
+        close(_epoll_fd);
+        _epoll_fd = -1;
+    }
+
+    _http_listener.fd = -1;
+    _https_listener.fd = -1;
+    _wakeup.fd = -1;
+}
+
+int redfish_http_server_run(int http_fd, int https_fd, tls_server_context_t *tls_ctx, int worker_num)
+{
+    int ret = SUCCESS;
+
+    if (http_fd < 0 && https_fd < 0) {
+        error(tag, "No servers available");
+        return ERROR_INVALID_PARAM;
+    }
+    if (https_fd >= 0 && tls_ctx == NULL) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (worker_num <= 0) {
+        worker_num = 1;
+    }
+
+    _tls_ctx = tls_ctx;
+    _server_abort = false;
+
+    if (_http_server_open(http_fd, https_fd) != SUCCESS) {
+        _http_server_close();
+        return ERROR_NETWORK;
+    }
+
+    _workers = calloc((size_t)worker_num, sizeof(http_worker_t));
+    if (!_workers) {
+        _http_server_close();
+        return ERROR_MEMORY;
+    }
+    for (_worker_num = 0; _worker_num < worker_num; _worker_num++) {
+        if (pthread_create(&_workers[_worker_num].thread, NULL, _http_worker_thread_func, &_workers[_worker_num]) != 0) {
+            error(tag, "Failed to create worker thread %d", _worker_num);
+            break;
+        }
+    }
+    if (_worker_num == 0) {
+        free(_workers);
+        _workers = NULL;
+        _http_server_close();
+        return ERROR_GENERAL;
+    }
+
+    pthread_mutex_lock(&_server_mutex);
+    _server_running = true;
+    pthread_mutex_unlock(&_server_mutex);
+
+    info(tag, "HTTP server running with %d workers", _worker_num);
+
+    struct epoll_event events[HTTP_EPOLL_EVENTS];
+    uint32_t last_sweep_ms = _monotonic_ms();
+
+    while (!_server_abort) {
+        int n = epoll_wait(_epoll_fd, events, HTTP_EPOLL_EVENTS, HTTP_SWEEP_INTERVAL_MS);
+        if (n < 0) {
+            if (errno != EINTR) {
+                error(tag, "epoll_wait failed: %s", strerror(errno));
+                ret = ERROR_NETWORK;
+                break;
+            }
+            continue;
+        }
+
+        for (int i = 0; i < n; i++) {
+            http_conn_t *conn = (http_conn_t *)events[i].data.ptr;
+
+            switch (conn->kind) {
+            case HTTP_CONN_KIND_HTTP_LISTENER:
+                _http_accept(conn->fd, 0);
+                break;
+            case HTTP_CONN_KIND_HTTPS_LISTENER:
+                _http_accept(conn->fd, 1);
+                break;
+            case HTTP_CONN_KIND_WAKEUP: {
+                uint64_t value = 0;
+                if (read(conn->fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+                    error(tag, "eventfd read failed: %s", strerror(errno));
+                }
+                break;
+            }
+            default:
+                _http_dispatch_event(conn);
+                break;
+            }
+        }
+
+        uint32_t now_ms = _monotonic_ms();
+        if ((uint32_t)(now_ms - last_sweep_ms) >= HTTP_SWEEP_INTERVAL_MS) {
+            last_sweep_ms = now_ms;
+            _http_sweep_idle();
+        }
+    }
+
+    pthread_mutex_lock(&_server_mutex);
+    _server_abort = true;
+    pthread_cond_broadcast(&_worker_cond);
+    pthread_mutex_unlock(&_server_mutex);
+
+    for (int i = 0; i < _worker_num; i++) {
+        pthread_join(_workers[i].thread, NULL);
+    }
+    free(_workers);
+    _workers = NULL;
+    _worker_num = 0;
+
+    _http_server_close();
+
+    pthread_mutex_lock(&_server_mutex);
+    _server_running = false;
+    pthread_cond_broadcast(&_stopped_cond);
+    pthread_mutex_unlock(&_server_mutex);
+
+    return ret;
+}
+
+void redfish_http_server_stop(void)
+{
+    pthread_mutex_lock(&_server_mutex);
+    _server_abort = true;
+    pthread_cond_broadcast(&_worker_cond);
+    _server_wakeup();
+    // The caller may tear down the thread running the event loop next:
+    // wait until it has joined the workers and released the connections
+    while (_server_running) {
+        pthread_cond_wait(&_stopped_cond, &_server_mutex);
+    }
+    pthread_mutex_unlock(&_server_mutex);
+}
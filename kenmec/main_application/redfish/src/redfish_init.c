@@ -9,12 +9,13 @@
 #include <arpa/inet.h>
 #include <signal.h>
 #include <errno.h>
-#include <sys/select.h>
 
 #include "config.h"
 #include "tls_server.h"
 #include "redfish_client_info_handle.h"
 #include "redfish_server.h"
+#include "redfish_http_server.h"
+#include "redfish_event_stream.h"
 #include "redfish_hid_bridge.h"
 #include "dexatek/main_application/include/application_common.h"
 #include "dexatek/main_application/include/utilities/net_utilities.h"
@@ -53,6 +54,21 @@ void print_usage(const char *program_name) {
     printf("  --help        Show this help message\n");
 }
 
+// mbedtls_ssl_write() may take less than the whole buffer
+static int tls_write_all(mbedtls_ssl_context *ssl, const char *data, size_t len) {
+    size_t total_written = 0;
+
+    while (total_written < len) {
+        int n = tls_server_write(ssl, data + total_written, len - total_written);
+        if (n < 0) {
+            return ERROR_NETWORK;
+        }
+        total_written += (size_t)n;
+    }
+
+    return SUCCESS;
+}
+
 // Client connection handler
 int handle_client_connection(int client_fd) {
     char request_buffer[BUFFER_SIZE];
@@ -219,18 +235,17 @@ int handle_client_connection(int client_fd) {
         return ret;
     }
 
-    // Generate HTTP response
-    generate_http_response(&response, response_buffer, sizeof(response_buffer));
-
-    debug(tag, "Sending response:\n%s\n", response_buffer);
-
-    // Send response to client
-    int bytes_written = tls_server_write(&ssl, response_buffer, strlen(response_buffer));
-    if (bytes_written < 0) {
+    // Send the head, then the body straight from the response
+    int head_len = generate_http_response_head(&response, 0, response_buffer, sizeof(response_buffer));
+    if (head_len < 0 ||
+        tls_write_all(&ssl, response_buffer, (size_t)head_len) != SUCCESS ||
+        tls_write_all(&ssl, redfish_response_body(&response), (size_t)response.content_length) != SUCCESS) {
         error(tag, "Failed to write response to client");
+        redfish_response_clear_body(&response);
         tls_server_close_client(&ssl, client_fd);
         return ERROR_NETWORK;
     }
+    redfish_response_clear_body(&response);
 
     // Close client connection and cleanup
     tls_server_close_client(&ssl, client_fd);
@@ -318,61 +333,14 @@ static TaskReturn _redfish_manager_process(void *param)
 
     db_init();
 
-    // Main server loop using select() for multiplexing
-    while (1) {
-        if (_thread_aborted) {
-            printf("Thread aborted\n");
-            break;
-        }
-
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        
-        int max_fd = -1;
-        
-        // Add HTTP server to select set
-        if (http_server_fd >= 0) {
-            FD_SET(http_server_fd, &read_fds);
-            if (http_server_fd > max_fd) max_fd = http_server_fd;
-        }
-        
-        // Add HTTPS server to select set
-        if (https_server_fd >= 0) {
-            FD_SET(https_server_fd, &read_fds);
-            if (https_server_fd > max_fd) max_fd = https_server_fd;
-        }
-        
-        if (max_fd < 0) {
-            printf("No servers available max_fd: %d\n", max_fd);
-            break;
-        }
-        
-        // Wait for activity on any server socket
-        int activity = select(max_fd + 1, &read_fds, NULL, NULL, NULL);
-        if (activity < 0) {
-            error(tag, "Select error");
-            continue;
-        }
-        
-        // Check HTTP server for new connections
-        if (http_server_fd >= 0 && FD_ISSET(http_server_fd, &read_fds)) {
-            int client_fd = accept(http_server_fd, NULL, NULL);
-            if (client_fd >= 0) {
-                debug(tag, "New HTTP connection accepted");
-                handle_http_client_connection(client_fd);
-            }
-        }
-        
-        // Check HTTPS server for new connections
-        if (https_server_fd >= 0 && FD_ISSET(https_server_fd, &read_fds)) {
-            int client_fd;
-            int ret = tls_server_accept_client(&g_tls_ctx, &client_fd);
-            if (ret == SUCCESS && client_fd >= 0) {
-                debug(tag, "New HTTPS connection accepted");
-                handle_https_client_connection(client_fd);
-            }
-        }
+    // Event loop: epoll over both listeners and all client connections,
+    // requests are handled by a worker pool. Returns on redfish_deinit().
+    redfish_event_stream_start(REDFISH_SSE_MIN_INTERVAL_MS);
+    if (redfish_http_server_run(http_server_fd, https_server_fd, &g_tls_ctx, HTTP_WORKER_NUM) != SUCCESS) {
+        error(tag, "HTTP server event loop exited with error");
     }
+    // Subscribers may hold TLS sessions: close them before the TLS context goes
+    redfish_event_stream_stop();
     
     // Cleanup
     if (http_server_fd >= 0) {
@@ -484,8 +452,10 @@ int redfish_deinit(void)
     mdns_service_stop(&_mdns_http_config);
     mdns_service_stop(&_mdns_https_config);
     
-    // Clean up thread
+    // Clean up thread: stop returns once the HTTP workers are joined,
+    // only then may the server task go
     _thread_aborted = TRUE;
+    redfish_http_server_stop();
     if (_thread_handle != NULL) {
         platform_task_cancel(_thread_handle);
         _thread_handle = NULL;
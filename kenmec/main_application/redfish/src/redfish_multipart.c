@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "redfish_multipart.h"
+
+int multipart_boundary_from_content_type(const char *content_type, char *boundary, size_t boundary_size)
+{
+    if (!content_type || !boundary || boundary_size == 0) return ERROR_INVALID_PARAM;
+
+    const char *start = strstr(content_type, "boundary=");
+    if (!start) return ERROR_GENERAL;
+    start += 9; // Skip "boundary="
+
+    const char *end;
+    if (*start == '"') {
+        start++;
+        end = strchr(start, '"');
+        if (!end) return ERROR_GENERAL;
+    } else {
+        // Token ends at space, semicolon, or end of string
+        end = start;
+        while (*end && *end != ' ' && *end != ';' && *end != '\r' && *end != '\n') {
+            end++;
+        }
+    }
+
+    size_t len = (size_t)(end - start);
+    if (len == 0 || len > MULTIPART_BOUNDARY_MAX_LEN || len >= boundary_size) return ERROR_GENERAL;
+
+    memcpy(boundary, start, len);
+    boundary[len] = '\0';
+    return SUCCESS;
+}
+
+int multipart_parser_init(multipart_parser_t *parser, const char *boundary, int out_fd)
+{
+    if (!parser || !boundary) return ERROR_INVALID_PARAM;
+
+    size_t boundary_len = strlen(boundary);
+    if (boundary_len == 0 || boundary_len > MULTIPART_BOUNDARY_MAX_LEN) return ERROR_INVALID_PARAM;
+
+    memset(parser, 0, sizeof(*parser));
+    parser->delim[0] = '\n';
+    parser->delim[1] = '-';
+    parser->delim[2] = '-';
+    memcpy(parser->delim + 3, boundary, boundary_len);
+    parser->delim_len = boundary_len + 3;
+
+    // Horspool shift table: distance from the last occurrence of a byte
+    // (excluding the final position) to the end of the delimiter
+    for (int i = 0; i < 256; i++) {
+        parser->skip[i] = (uint8_t)parser->delim_len;
+    }
+    for (size_t i = 0; i + 1 < parser->delim_len; i++) {
+        parser->skip[parser->delim[i]] = (uint8_t)(parser->delim_len - 1 - i);
+    }
+
+    // The first boundary may open the body without a preceding line break
+    parser->lookbehind[0] = '\n';
+    parser->lookbehind_len = 1;
+
+    parser->state = MULTIPART_STATE_BODY;
+    parser->out_fd = out_fd;
+
+    mbedtls_sha256_init(&parser->sha);
+    mbedtls_sha256_starts_ret(&parser->sha, 0);
+    return SUCCESS;
+}
+
+void multipart_parser_free(multipart_parser_t *parser)
+{
+    if (!parser) return;
+    mbedtls_sha256_free(&parser->sha);
+}
+
+// Content of the current part
+static void multipart_emit(multipart_parser_t *parser, const unsigned char *data, size_t len)
+{
+    if (len == 0 || !parser->part_selected || parser->state == MULTIPART_STATE_ERROR) return;
+
+    mbedtls_sha256_update_ret(&parser->sha, data, len);
+    parser->bytes += (long)len;
+
+    while (len > 0) {
+        ssize_t n = write(parser->out_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            printf("multipart: failed to write upload data: %s\n", strerror(errno));
+            parser->state = MULTIPART_STATE_ERROR;
+            return;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+// Emit bytes [from, to) of the window formed by lookbehind + data
+static void multipart_emit_window(multipart_parser_t *parser, const unsigned char *data, size_t from, size_t to)
+{
+    size_t lb = parser->lookbehind_len;
+    if (from < lb) {
+        size_t end = to < lb ? to : lb;
+        multipart_emit(parser, parser->lookbehind + from, end - from);
+        from = end;
+    }
+    if (to > from) {
+        multipart_emit(parser, data + (from - lb), to - from);
+    }
+}
+
+static bool multipart_headers_select(multipart_parser_t *parser)
+{
+    char *line = parser->header;
+    char *end = parser->header + parser->header_len;
+    *end = '\0';
+
+    while (line < end) {
+        char *nl = strchr(line, '\n');
+        if (nl) *nl = '\0';
+        if (strncasecmp(line, "Content-Disposition:", 20) == 0 &&
+            (strstr(line, "name=\"UpdateFile\"") || strstr(line, "name=\"file\""))) {
+            return true;
+        }
+        if (!nl) break;
+        line = nl + 1;
+    }
+    return false;
+}
+
+// Search part content for the delimiter. Returns the number of bytes of data consumed.
+static size_t multipart_consume_body(multipart_parser_t *parser, const unsigned char *data, size_t len)
+{
+    const size_t m = parser->delim_len;
+    const size_t lb = parser->lookbehind_len;
+    const size_t total = lb + len;
+#define WINDOW(i) ((i) < lb ? parser->lookbehind[(i)] : data[(i) - lb])
+
+    size_t s = 0;
+    while (s + m <= total) {
+        size_t j = m - 1;
+        while (WINDOW(s + j) == parser->delim[j]) {
+            if (j == 0) {
+                // Delimiter at s: content ends before it (and before its CR)
+                size_t content_end = s;
+                if (content_end > 0 && WINDOW(content_end - 1) == '\r') content_end--;
+                multipart_emit_window(parser, data, 0, content_end);
+
+                if (parser->part_selected) {
+                    parser->file_found = true;
+                    parser->part_selected = false;
+                }
+                parser->lookbehind_len = 0;
+                parser->tail = 0;
+                if (parser->state != MULTIPART_STATE_ERROR) {
+                    parser->state = MULTIPART_STATE_BOUNDARY_TAIL;
+                }
+                return s + m - lb;
+            }
+            j--;
+        }
+        s += parser->skip[WINDOW(s + m - 1)];
+    }
+
+    // No delimiter can start before s. Hold back the rest (a possible partial
+    // match) plus a trailing CR that may belong to the next delimiter.
+    size_t safe = s < total ? s : total;
+    if (safe > 0 && WINDOW(safe - 1) == '\r') safe--;
+#undef WINDOW
+
+    multipart_emit_window(parser, data, 0, safe);
+
+    size_t keep = total - safe;
+    if (safe < lb) {
+        memmove(parser->lookbehind, parser->lookbehind + safe, lb - safe);
+        memcpy(parser->lookbehind + (lb - safe), data, len);
+    } else {
+        memcpy(parser->lookbehind, data + (safe - lb), keep);
+    }
+    parser->lookbehind_len = keep;
+    return len;
+}
+
+int multipart_parser_feed(multipart_parser_t *parser, const void *data, size_t len)
+{
+    if (!parser || (!data && len > 0)) return ERROR_INVALID_PARAM;
+
+    const unsigned char *p = (const unsigned char *)data;
+    size_t pos = 0;
+
+    while (pos < len && parser->state != MULTIPART_STATE_DONE && parser->state != MULTIPART_STATE_ERROR) {
+        unsigned char c;
+
+        switch (parser->state) {
+        case MULTIPART_STATE_BODY:
+            pos += multipart_consume_body(parser, p + pos, len - pos);
+            break;
+
+        case MULTIPART_STATE_BOUNDARY_TAIL:
+            c = p[pos++];
+            if (parser->tail == '-') {
+                parser->state = (c == '-') ? MULTIPART_STATE_DONE : MULTIPART_STATE_ERROR;
+            } else if (parser->tail == '\r') {
+                parser->state = (c == '\n') ? MULTIPART_STATE_HEADERS : MULTIPART_STATE_ERROR;
+            } else if (c == ' ' || c == '\t') {
+                // Transport padding
+            } else if (c == '-' || c == '\r') {
+                parser->tail = (char)c;
+            } else if (c == '\n') {
+                parser->state = MULTIPART_STATE_HEADERS;
+            } else {
+                parser->state = MULTIPART_STATE_ERROR;
+            }
+            if (parser->state == MULTIPART_STATE_HEADERS) {
+                parser->header_len = 0;
+            }
+            break;
+
+        case MULTIPART_STATE_HEADERS:
+            c = p[pos++];
+            if (parser->header_len >= sizeof(parser->header) - 1) {
+                printf("multipart: part headers too large\n");
+                parser->state = MULTIPART_STATE_ERROR;
+                break;
+            }
+            parser->header[parser->header_len++] = (char)c;
+            if (c == '\n') {
+                // A blank line ("\r\n" or "\n" on its own) ends the headers
+                size_t n = parser->header_len;
+                bool blank = (n == 1) ||
+                             (parser->header[n - 2] == '\n') ||
+                             (parser->header[n - 2] == '\r' && (n == 2 || parser->header[n - 3] == '\n'));
+                if (blank) {
+                    parser->part_selected = !parser->file_found && multipart_headers_select(parser);
+                    parser->lookbehind_len = 0;
+                    parser->state = MULTIPART_STATE_BODY;
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return parser->state == MULTIPART_STATE_ERROR ? ERROR_GENERAL : SUCCESS;
+}
+
+int multipart_parser_finish(multipart_parser_t *parser, long *bytes, char *sha256_hex)
+{
+    if (!parser) return ERROR_INVALID_PARAM;
+    if (parser->state == MULTIPART_STATE_ERROR || !parser->file_found || parser->bytes <= 0) {
+        return ERROR_GENERAL;
+    }
+
+    unsigned char digest[32];
+    mbedtls_sha256_finish_ret(&parser->sha, digest);
+
+    if (bytes) *bytes = parser->bytes;
+    if (sha256_hex) {
+        for (int i = 0; i < 32; i++) {
+            snprintf(sha256_hex + i * 2, 3, "%02x", digest[i]);
+        }
+    }
+    return SUCCESS;
+}
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 #include <sqlite3.h>
 #include <sys/stat.h>
@@ -17,10 +18,13 @@
 #include "redfish_resources.h"
 #include "redfish_server.h"
 #include "redfish_crypto.h"
+#include "redfish_multipart.h"
 #include "default_json.h"
 #include "redfish_hid_bridge.h"
 #include "kenmec/main_application/kenmec_config.h"
 #include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/control_logic_history.h"
+#include "kenmec/main_application/control_logic/control_logic_latency.h"
 
 // static const char *tag = "redfish_resources";
 static int g_securitypolicy_applytime_onreset = 0; // set by POST to annotate next GET
@@ -33,6 +37,8 @@ typedef struct {
     int delay_seconds;
 } delayed_network_config_t;
 
+static int chassis_json_write(char *buf, size_t size, const char *chassis_id);
+
 // static int encode_base64(const uint8_t *in, size_t in_len, char *out, size_t out_size, size_t *out_len) {
 //     size_t olen = 0;
 //     int rc = mbedtls_base64_encode((unsigned char*)out, out_size, &olen, (const unsigned char*)in, in_len);
@@ -80,15 +86,8 @@ int handle_cdu_oem_ioboard_action_read(const char *cdu_id, const char *member_id
 
     redfish_board_data_append_to_json(port_idx, response_json);
     
-    char *json_string = cJSON_Print(response_json);
-    if (json_string) {
-        strncpy(response->body, json_string, sizeof(response->body) - 1);
-        response->body[sizeof(response->body) - 1] = '\0';
-        free(json_string);
-    }
+    redfish_response_set_json(response, response_json);
     cJSON_Delete(response_json);
-
-    response->content_length = strlen(response->body);
     return SUCCESS;
 }
 
@@ -176,16 +175,9 @@ int handle_cdu_oem_ioboard_action_write(const char *cdu_id, const char *member_i
     cJSON_AddNumberToObject(response_json, "Port", port_idx);
     cJSON_AddStringToObject(response_json, "Status", "Success");
     
-    char *json_string = cJSON_Print(response_json);
-    if (json_string) {
-        strncpy(response->body, json_string, sizeof(response->body) - 1);
-        response->body[sizeof(response->body) - 1] = '\0';
-        free(json_string);
-    }
+    redfish_response_set_json(response, response_json);
     cJSON_Delete(response_json);
 
-    response->content_length = strlen(response->body);
-
     return SUCCESS;
 }
 // Helper to build Role resource JSON
@@ -308,15 +300,8 @@ int handle_role_member(const char *role_id, http_response_t *response)
     
     redfish_control_logic_data_append_to_json(control_logic_idx, response_json);
 
-    char *json_string = cJSON_Print(response_json);
-    if (json_string) {
-        strncpy(response->body, json_string, sizeof(response->body) - 1);
-        response->body[sizeof(response->body) - 1] = '\0';
-        free(json_string);
-    }
+    redfish_response_set_json(response, response_json);
     cJSON_Delete(response_json);
-    
-    response->content_length = strlen(response->body);
     return SUCCESS;
 }
 
@@ -385,16 +370,9 @@ int handle_cdu_oem_control_logics_action_write(const char *cdu_id, const char *m
     cJSON_AddStringToObject(response_json, "Status", "Success");
     
     
-    char *json_string = cJSON_Print(response_json);
-    if (json_string) {
-        strncpy(response->body, json_string, sizeof(response->body) - 1);
-        response->body[sizeof(response->body) - 1] = '\0';
-        free(json_string);
-    }
+    redfish_response_set_json(response, response_json);
     cJSON_Delete(response_json);
 
-    response->content_length = strlen(response->body);
-
     return SUCCESS;
 }
 
@@ -474,12 +452,36 @@ void extract_func_middle(const char *func_name, char *out, size_t out_size) {
     out[len] = '\0';
 }
 
-void get_json(FILE* fp, json_resource_type_t type)
+// In-memory cache of the generated resource documents.
+// Every GET used to regenerate the document, rewrite
+// redfish_resource_json/<name>.json and read it back. The serialized bytes are
+// now kept here together with an ETag; the file on disk is only rewritten when
+// the generated content changes or the file was modified behind our back.
+#define RESOURCE_JSON_DIR "redfish_resource_json"
+#define RESOURCE_CACHE_MAX_ENTRIES 8
+#define RESOURCE_CACHE_LIVE_TTL_MS 1000     // eth0 reflects live address/link state
+#define RESOURCE_JSON_MAX_LEN 2048           // size of the set_default_*_json() buffers
+
+typedef struct {
+    bool used;
+    json_resource_type_t type;
+    char name[64];
+    char *json;                     // serialized document (validated JSON)
+    size_t length;
+    char etag[RESOURCE_ETAG_LEN];
+    uint64_t generated_ms;          // when json was last (re)generated
+    bool on_disk;                   // file content is known to equal json
+    struct timespec disk_mtime;     // mtime of the file when on_disk was set
+} resource_cache_entry_t;
+
+static resource_cache_entry_t resource_cache[RESOURCE_CACHE_MAX_ENTRIES];
+static pthread_mutex_t resource_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool get_json(char *info, json_resource_type_t type)
 {
-    char info[2048];
     switch(type) {
         case MANAGER_NONE:
-            return;
+            return false;
 
         case MANAGER_KENMEC:
             set_default_kenmec_json(info);
@@ -496,148 +498,276 @@ void get_json(FILE* fp, json_resource_type_t type)
         case MANAGER_COLLECTION:
             set_default_manager_json(info);
             break;
+
+        default:
+            return false;
     }
 
-    fwrite(info, 1, strlen(info), fp);
-    fflush(fp);
+    return true;
 }
 
-char* open_json_file(const char *file_name, json_resource_type_t type)
+static void resource_etag_compute(const char *data, size_t len, char *etag, size_t etag_size)
 {
-    const char *dir = "redfish_resource_json";
-    char path[512] = {0};
-    char *buffer = NULL;
-    FILE *fp = NULL;
-    struct stat st = {0};
-    
-    // Validate input parameters
-    if (!file_name) {
-        printf("Error: file_name parameter is NULL\n");
-        return NULL;
+    // FNV-1a 64-bit over the serialized document
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 0x100000001b3ULL;
     }
-    
-    // Create directory if it doesn't exist
-    if (stat(dir, &st) == -1) {
-        printf("JSON folder not found, creating directory: %s\n", dir);
-        if (mkdir(dir, 0755) != 0) {
+    snprintf(etag, etag_size, "\"%016llx\"", (unsigned long long)hash);
+}
+
+static resource_cache_entry_t *resource_cache_lookup(const char *file_name, json_resource_type_t type)
+{
+    resource_cache_entry_t *victim = NULL;
+
+    for (int i = 0; i < RESOURCE_CACHE_MAX_ENTRIES; i++) {
+        resource_cache_entry_t *entry = &resource_cache[i];
+        if (entry->used) {
+            if (entry->type == type && strcmp(entry->name, file_name) == 0) {
+                return entry;
+            }
+            if (!victim || (victim->used && entry->generated_ms < victim->generated_ms)) {
+                victim = entry;
+            }
+        } else if (!victim || victim->used) {
+            victim = entry;
+        }
+    }
+
+    // Reuse a free slot or evict the least recently generated document
+    free(victim->json);
+    memset(victim, 0, sizeof(*victim));
+    victim->used = true;
+    victim->type = type;
+    snprintf(victim->name, sizeof(victim->name), "%s", file_name);
+    return victim;
+}
+
+static void resource_cache_invalidate(const char *file_name)
+{
+    pthread_mutex_lock(&resource_cache_mutex);
+    for (int i = 0; i < RESOURCE_CACHE_MAX_ENTRIES; i++) {
+        resource_cache_entry_t *entry = &resource_cache[i];
+        if (entry->used && strcmp(entry->name, file_name) == 0) {
+            free(entry->json);
+            memset(entry, 0, sizeof(*entry));
+        }
+    }
+    pthread_mutex_unlock(&resource_cache_mutex);
+}
+
+static bool resource_json_dir_ensure(void)
+{
+    struct stat st = {0};
+
+    if (stat(RESOURCE_JSON_DIR, &st) == -1) {
+        printf("JSON folder not found, creating directory: %s\n", RESOURCE_JSON_DIR);
+        if (mkdir(RESOURCE_JSON_DIR, 0755) != 0) {
             perror("Failed to create JSON folder");
-            return NULL;
+            return false;
         }
     }
-    
-    // Construct file path
-    snprintf(path, sizeof(path), "%s/%s.json", dir, file_name);
-    
-    // Always generate a new JSON file (overwrite if exists)
-    printf("Generating JSON file: %s\n", path);
-    fp = fopen(path, "w");
+    return true;
+}
+
+// Write path atomically (temp file + rename) so readers never see a partial document
+static bool resource_json_write(const char *path, const char *data, size_t len)
+{
+    char tmp_path[520];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *fp = fopen(tmp_path, "w");
     if (!fp) {
-        perror("Failed to create/overwrite JSON file");
-        return NULL;
+        perror("Failed to create JSON file");
+        return false;
     }
-    
-    // Write JSON content based on type
-    get_json(fp, type);
-    fclose(fp);
-    printf("Generated JSON file with content: %s\n", path);
-    
-    // Open file for reading
-    fp = fopen(path, "r");
+
+    bool ok = fwrite(data, 1, len, fp) == len;
+    if (fclose(fp) != 0) {
+        ok = false;
+    }
+    if (!ok || rename(tmp_path, path) != 0) {
+        perror("Failed to write JSON file");
+        unlink(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+static bool resource_file_matches(const char *path, const char *data, size_t len)
+{
+    FILE *fp = fopen(path, "r");
     if (!fp) {
-        perror("Failed to open JSON file for reading");
-        return NULL;
+        return false;
     }
-    
-    // Get file size
-    if (fseek(fp, 0, SEEK_END) != 0) {
-        perror("Failed to seek to end of file");
-        fclose(fp);
-        return NULL;
+
+    char chunk[512];
+    size_t offset = 0;
+    bool match = true;
+    size_t n;
+    while (match && (n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        if (offset + n > len || memcmp(chunk, data + offset, n) != 0) {
+            match = false;
+        }
+        offset += n;
     }
-    
-    long filesize = ftell(fp);
-    if (filesize < 0) {
-        perror("Failed to get file size");
-        fclose(fp);
-        return NULL;
+    fclose(fp);
+
+    return match && offset == len;
+}
+
+// Bring the file on disk in line with the cached document. Only writes when
+// the content differs; an unchanged mtime lets us skip even the comparison.
+static void resource_cache_sync_disk(resource_cache_entry_t *entry)
+{
+    char path[512];
+    struct stat st;
+
+    snprintf(path, sizeof(path), "%s/%s.json", RESOURCE_JSON_DIR, entry->name);
+
+    if (stat(path, &st) == 0) {
+        if (entry->on_disk &&
+            st.st_mtim.tv_sec == entry->disk_mtime.tv_sec &&
+            st.st_mtim.tv_nsec == entry->disk_mtime.tv_nsec &&
+            (size_t)st.st_size == entry->length) {
+            return;
+        }
+        if ((size_t)st.st_size == entry->length &&
+            resource_file_matches(path, entry->json, entry->length)) {
+            entry->on_disk = true;
+            entry->disk_mtime = st.st_mtim;
+            return;
+        }
     }
-    
-    if (filesize == 0) {
-        printf("Warning: JSON file is empty: %s\n", path);
-        fclose(fp);
+
+    entry->on_disk = false;
+    if (!resource_json_dir_ensure()) {
+        return;
+    }
+
+    printf("Generating JSON file: %s\n", path);
+    if (resource_json_write(path, entry->json, entry->length) && stat(path, &st) == 0) {
+        entry->on_disk = true;
+        entry->disk_mtime = st.st_mtim;
+    }
+}
+
+char* open_json_file_with_etag(const char *file_name, json_resource_type_t type, char *etag, size_t etag_size)
+{
+    char *buffer = NULL;
+
+    // Validate input parameters
+    if (!file_name) {
+        printf("Error: file_name parameter is NULL\n");
         return NULL;
     }
-    
-    // Allocate buffer for file content
-    buffer = malloc(filesize + 1);
+
+    pthread_mutex_lock(&resource_cache_mutex);
+
+    resource_cache_entry_t *entry = resource_cache_lookup(file_name, type);
+    uint64_t now = time_get_current_ms();
+
+    // Static documents are generated once; live ones are refreshed after a short TTL
+    bool refresh = !entry->json ||
+                   (type == MANAGER_ETHERNET_INTERFACE_ETH0 &&
+                    now - entry->generated_ms >= RESOURCE_CACHE_LIVE_TTL_MS);
+
+    if (refresh) {
+        char info[RESOURCE_JSON_MAX_LEN];
+        if (!get_json(info, type)) {
+            printf("Warning: no JSON content for %s\n", file_name);
+            entry->used = entry->json != NULL;
+            pthread_mutex_unlock(&resource_cache_mutex);
+            return NULL;
+        }
+
+        size_t len = strlen(info);
+        if (!entry->json || len != entry->length || memcmp(info, entry->json, len) != 0) {
+            // Parse once per content change instead of on every request
+            cJSON *root = cJSON_Parse(info);
+            if (!root) {
+                printf("JSON parse error: %s\n", file_name);
+                entry->used = entry->json != NULL;
+                pthread_mutex_unlock(&resource_cache_mutex);
+                return NULL;
+            }
+            cJSON_Delete(root);
+
+            char *copy = malloc(len + 1);
+            if (!copy) {
+                perror("Failed to allocate memory for JSON content");
+                entry->used = entry->json != NULL;
+                pthread_mutex_unlock(&resource_cache_mutex);
+                return NULL;
+            }
+            memcpy(copy, info, len + 1);
+
+            free(entry->json);
+            entry->json = copy;
+            entry->length = len;
+            entry->on_disk = false;
+            resource_etag_compute(copy, len, entry->etag, sizeof(entry->etag));
+        }
+        entry->generated_ms = now;
+    }
+
+    resource_cache_sync_disk(entry);
+
+    buffer = malloc(entry->length + 1);
     if (!buffer) {
         perror("Failed to allocate memory for JSON content");
-        fclose(fp);
-        return NULL;
+    } else {
+        memcpy(buffer, entry->json, entry->length + 1);
+        if (etag && etag_size > 0) {
+            snprintf(etag, etag_size, "%s", entry->etag);
+        }
     }
 
-    rewind(fp);
-    
-    // Read file content
-    size_t read_size = fread(buffer, 1, filesize, fp);
-    if (read_size != (size_t)filesize) {
-        printf("Warning: Expected to read %ld bytes, but read %zu bytes\n", 
-               filesize, read_size);
-    }
-    
-    buffer[read_size] = '\0';
-    
-    fclose(fp);
-    
+    pthread_mutex_unlock(&resource_cache_mutex);
+
     return buffer;
 }
 
+char* open_json_file(const char *file_name, json_resource_type_t type)
+{
+    return open_json_file_with_etag(file_name, type, NULL, 0);
+}
+
 
 bool save_json_file(const char *file_name, const char *json_info)
 {
-    struct stat st = {0};
-    const char *dir = "redfish_resource_json";
+    if (!file_name || !json_info) {
+        return false;
+    }
 
-    if (stat(dir, &st) == -1) {
-        printf("redfish_resource_json folder not found, creating...\n");
-        if (mkdir(dir, 0755) != 0) {
-            perror("mkdir redfish_resource_json folder failed");
-            return false;
-        }
+    if (!resource_json_dir_ensure()) {
+        return false;
     }
 
     char path[512] = {0};
-    snprintf(path, sizeof(path), "%s/%s.json", dir, file_name);
-
-    if (stat(path, &st) == -1) {
-        printf("%s not found, creating empty file...\n", path);
-        FILE *fp = fopen(path, "w");
-        if (!fp) {
-            perror("create json file failed");
-            return false;
-        }
-        fclose(fp);
-    } else {
-        printf("%s already exists.\n", path);
-    }
+    snprintf(path, sizeof(path), "%s/%s.json", RESOURCE_JSON_DIR, file_name);
 
-    FILE *fp = fopen(path, "w");
-    if (!fp) {
-        perror("open json file for writing failed");
-        return false;
-    }
+    // Drop the cached copy so the next GET re-evaluates the document
+    resource_cache_invalidate(file_name);
 
-    if (fputs(json_info, fp) == EOF) {
-        perror("write to json file failed");
-        fclose(fp);
+    if (!resource_json_write(path, json_info, strlen(json_info))) {
         return false;
     }
 
-    fclose(fp);
     printf("Successfully saved JSON to %s\n", path);
     return true;
 }
 
+static void resource_add_etag_header(http_response_t *response, const char *etag)
+{
+    if (etag[0] != '\0' && response->header_count < MAX_HEADERS) {
+        strcpy(response->headers[response->header_count][0], "ETag");
+        strcpy(response->headers[response->header_count][1], etag);
+        response->header_count++;
+    }
+}
+
 int handle_service_root(http_response_t *response) {
     char *json = generate_service_root_json();
     if (!json) {
@@ -1065,20 +1195,15 @@ int handle_account_patch(const char *account_id, const http_request_t *request,
         cJSON_AddItemToObject(error, "@Message.ExtendedInfo", extended_info);
         cJSON_AddItemToObject(error_response, "error", error);
         
-        char *error_json = cJSON_Print(error_response);
-        if (error_json) {
-            strncpy(response->body, error_json, sizeof(response->body) - 1);
-            response->body[sizeof(response->body) - 1] = '\0';
-            free(error_json);
-        } else {
+        if (redfish_response_set_json(response, error_response) != SUCCESS) {
             strcpy(response->body, "{\"error\":\"The request body submitted contain only OData annotations and no operation was performed.\"}");
+            response->content_length = strlen(response->body);
         }
         
         cJSON_Delete(error_response);
         cJSON_Delete(readonly_props);
         cJSON_Delete(odata_props);
         cJSON_Delete(json);
-        response->content_length = strlen(response->body);
         return SUCCESS;
     }
     
@@ -1113,20 +1238,15 @@ int handle_account_patch(const char *account_id, const http_request_t *request,
         cJSON_AddItemToObject(error, "@Message.ExtendedInfo", extended_info);
         cJSON_AddItemToObject(error_response, "error", error);
         
-        char *error_json = cJSON_Print(error_response);
-        if (error_json) {
-            strncpy(response->body, error_json, sizeof(response->body) - 1);
-            response->body[sizeof(response->body) - 1] = '\0';
-            free(error_json);
-        } else {
+        if (redfish_response_set_json(response, error_response) != SUCCESS) {
             strcpy(response->body, "{\"error\":\"The request included read-only properties that cannot be updated.\"}");
+            response->content_length = strlen(response->body);
         }
         
         cJSON_Delete(error_response);
         cJSON_Delete(readonly_props);
         cJSON_Delete(odata_props);
         cJSON_Delete(json);
-        response->content_length = strlen(response->body);
         return SUCCESS;
     }
     
@@ -1387,13 +1507,9 @@ int handle_account_patch(const char *account_id, const http_request_t *request,
             cJSON_AddItemToObject(response_json, "@Message.ExtendedInfo", extended_info);
         }
 
-        char *response_str2 = cJSON_Print(response_json);
-        if (response_str2) {
-            strncpy(response->body, response_str2, sizeof(response->body) - 1);
-            response->body[sizeof(response->body) - 1] = '\0';
-            free(response_str2);
-        } else {
+        if (redfish_response_set_json(response, response_json) != SUCCESS) {
             strcpy(response->body, "{\"error\":\"Failed to generate response\"}");
+            response->content_length = strlen(response->body);
         }
 
         cJSON_Delete(response_json);
@@ -1401,7 +1517,6 @@ int handle_account_patch(const char *account_id, const http_request_t *request,
         cJSON_Delete(odata_props);
         cJSON_Delete(failed_props);
         cJSON_Delete(json);
-        response->content_length = strlen(response->body);
         return SUCCESS;
     }
 
@@ -1510,13 +1625,9 @@ int handle_account_patch(const char *account_id, const http_request_t *request,
         cJSON_AddItemToObject(response_json3, "@Message.ExtendedInfo", extended_info3);
     }
 
-    char *response_str3 = cJSON_Print(response_json3);
-    if (response_str3) {
-        strncpy(response->body, response_str3, sizeof(response->body) - 1);
-        response->body[sizeof(response->body) - 1] = '\0';
-        free(response_str3);
-    } else {
+    if (redfish_response_set_json(response, response_json3) != SUCCESS) {
         strcpy(response->body, "{\"error\":\"Failed to generate response\"}");
+        response->content_length = strlen(response->body);
     }
 
     cJSON_Delete(response_json3);
@@ -1524,7 +1635,6 @@ int handle_account_patch(const char *account_id, const http_request_t *request,
     cJSON_Delete(odata_props);
     cJSON_Delete(failed_props);
     cJSON_Delete(json);
-    response->content_length = strlen(response->body);
     return SUCCESS;
 }
 
@@ -1753,17 +1863,16 @@ int handle_chassis(const char *chassis_id, http_response_t *response) {
         return ERROR_INVALID_PARAM;
     }
 
-    char *json = generate_chassis_json(chassis_id);
-    if (!json) {
+    // Written straight into the response body
+    int len = chassis_json_write(response->body, sizeof(response->body), chassis_id);
+    if (len < 0 || (size_t)len >= sizeof(response->body)) {
         response->status_code = HTTP_INTERNAL_SERVER_ERROR;
         strcpy(response->body, "{\"error\":\"Failed to generate chassis data\"}");
         return ERROR_MEMORY;
     }
 
     response->status_code = HTTP_OK;
-    strcpy(response->body, json);
-    response->content_length = strlen(json);
-    free(json);
+    response->content_length = len;
 
     return SUCCESS;
 }
@@ -1807,7 +1916,8 @@ int handle_system(const char *system_id, http_response_t *response) {
 }
 
 int get_managers_ethernet_interface_eth0(const char *resource_id, http_response_t *response) {
-    char *json = open_json_file(resource_id, MANAGER_ETHERNET_INTERFACE_ETH0);
+    char etag[RESOURCE_ETAG_LEN] = {0};
+    char *json = open_json_file_with_etag(resource_id, MANAGER_ETHERNET_INTERFACE_ETH0, etag, sizeof(etag));
     if (!json) {
         response->status_code = HTTP_INTERNAL_SERVER_ERROR;
         strcpy(response->body, "{\"error\":\"Failed to generate managers collection\"}");
@@ -1815,6 +1925,7 @@ int get_managers_ethernet_interface_eth0(const char *resource_id, http_response_
     }
 
     response->status_code = HTTP_OK;
+    resource_add_etag_header(response, etag);
     strcpy(response->body, json);
     response->content_length = strlen(json);
     free(json);
@@ -1823,7 +1934,8 @@ int get_managers_ethernet_interface_eth0(const char *resource_id, http_response_
 }
 
 int get_managers_ethernet_interface(const char *resource_id, http_response_t *response) {
-    char *json = open_json_file(resource_id, MANAGER_ETHERNET_INTERFACE);
+    char etag[RESOURCE_ETAG_LEN] = {0};
+    char *json = open_json_file_with_etag(resource_id, MANAGER_ETHERNET_INTERFACE, etag, sizeof(etag));
     if (!json) {
         response->status_code = HTTP_INTERNAL_SERVER_ERROR;
         strcpy(response->body, "{\"error\":\"Failed to generate managers collection\"}");
@@ -1831,6 +1943,7 @@ int get_managers_ethernet_interface(const char *resource_id, http_response_t *re
     }
 
     response->status_code = HTTP_OK;
+    resource_add_etag_header(response, etag);
     strcpy(response->body, json);
     response->content_length = strlen(json);
     free(json);
@@ -1855,7 +1968,8 @@ int get_managers_kenmec_resource(const char *resource_id, http_response_t *respo
 }
 
 int get_managers_collection(const char *resource_id, http_response_t *response) {
-    char *json = open_json_file(resource_id, MANAGER_COLLECTION);
+    char etag[RESOURCE_ETAG_LEN] = {0};
+    char *json = open_json_file_with_etag(resource_id, MANAGER_COLLECTION, etag, sizeof(etag));
     if (!json) {
         response->status_code = HTTP_INTERNAL_SERVER_ERROR;
         strcpy(response->body, "{\"error\":\"Failed to generate managers collection\"}");
@@ -1863,6 +1977,7 @@ int get_managers_collection(const char *resource_id, http_response_t *response)
     }
 
     response->status_code = HTTP_OK;
+    resource_add_etag_header(response, etag);
     strcpy(response->body, json);
     response->content_length = strlen(json);
     free(json);
@@ -1912,10 +2027,13 @@ int handle_token_invalid(http_response_t *response)
 
 char* generate_service_root_json(void) {
     time_t now = time(NULL);
+    struct tm tm;
     char time_str[64];
     char uuid[37]; // UUID format: 36 chars + null terminator
     
-    strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    // GET handlers run on several workers at once: no shared gmtime() buffer
+    gmtime_r(&now, &tm);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%SZ", &tm);
 
     // Get UUID from redfish_get_uuid function
     if (redfish_get_uuid(uuid, sizeof(uuid)) != 0) {
@@ -1971,11 +2089,9 @@ char* generate_chassis_collection_json(void) {
     return json;
 }
 
-char* generate_chassis_json(const char *chassis_id) {
-    char *json = malloc(2048);
-    if (!json) return NULL;
-
-    snprintf(json, 2048,
+// Write the Chassis document into buf; returns its length like snprintf()
+static int chassis_json_write(char *buf, size_t size, const char *chassis_id) {
+    return snprintf(buf, size,
         "{"
         "\"@odata.type\":\"#Chassis.v1_20_0.Chassis\","
         "\"@odata.id\":\"/redfish/v1/Chassis/%s\","
@@ -2002,6 +2118,13 @@ char* generate_chassis_json(const char *chassis_id) {
         "\"Oem\":{}"
         "}",
         chassis_id, chassis_id, chassis_id, chassis_id, chassis_id, SYSTEM_ID, MANAGER_ID);
+}
+
+char* generate_chassis_json(const char *chassis_id) {
+    char *json = malloc(2048);
+    if (!json) return NULL;
+
+    chassis_json_write(json, 2048, chassis_id);
 
     return json;
 }
@@ -2064,17 +2187,8 @@ char* open_resource_json(json_resource_type_t type) {
     char catch_name[128];
     
     extract_func_middle(func_name, catch_name, sizeof(catch_name));
-    char *json = open_json_file(catch_name, type);
-
-
-    cJSON *root = cJSON_Parse(json);
-    if (!root) {
-        printf("JSON parse error\n");
-        return NULL;
-    }
-    
-    cJSON_Delete(root);
-    return json;
+    // Documents are validated by the resource cache when their content changes
+    return open_json_file(catch_name, type);
 }
 
 
@@ -2814,18 +2928,14 @@ int patch_managers_ethernet_interface_eth0(const char *resource_id, const http_r
 
     cjson_deep_merge(root, patch_obj);
 
-    char *modified = cJSON_Print(root);
-
-    strcpy(response->body, modified);
+    redfish_response_set_json(response, root);
     response->status_code = HTTP_OK;
-    response->content_length = strlen(modified);
 
-    save_json_file(resource_id, modified);
+    save_json_file(resource_id, redfish_response_body(response));
 
     free(json);
     cJSON_Delete(root);
     cJSON_Delete(patch_obj);
-    free(modified);
 
     return SUCCESS;
 }
@@ -2919,15 +3029,12 @@ char* generate_thermalequipment_collection_json(void) {
     return json;
 }
 
-char* generate_thermalequipment_json(const char *thermalequipment_id) {
-    if (!thermalequipment_id) return NULL;
-
-    char *json = malloc(2048);
-    if (!json) return NULL;
-
+// Write the ThermalEquipment subresource into buf; returns its length like
+// snprintf(), or -1 if there is no such resource.
+static int thermalequipment_json_write(char *buf, size_t size, const char *thermalequipment_id) {
     // Handle CDUs as a collection
     if (strcmp(thermalequipment_id, "CDUs") == 0) {
-        snprintf(json, 2048,
+        return snprintf(buf, size,
             "{"
             "\"@odata.type\":\"#CoolingUnitCollection.CoolingUnitCollection\","
             "\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs\","
@@ -2945,12 +3052,11 @@ char* generate_thermalequipment_json(const char *thermalequipment_id) {
         
         // Validate CDU existence - only CDU "1" exists in this demo
         if (strcmp(cdu_id, "1") != 0) {
-            // CDU doesn't exist, return NULL to indicate 404 handled by caller
-            free(json);
-            return NULL;
+            // CDU doesn't exist, 404 handled by caller
+            return -1;
         }
         
-        snprintf(json, 2048,
+        return snprintf(buf, size,
             "{"
             "\"@odata.type\":\"#CoolingUnit.v1_3_0.CoolingUnit\","
             "\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s\","
@@ -2976,6 +3082,21 @@ char* generate_thermalequipment_json(const char *thermalequipment_id) {
             cdu_id, cdu_id, cdu_id, cdu_id, cdu_id, cdu_id);
     }
 
+    return -1;
+}
+
+char* generate_thermalequipment_json(const char *thermalequipment_id) {
+    if (!thermalequipment_id) return NULL;
+
+    char *json = malloc(2048);
+    if (!json) return NULL;
+
+    int len = thermalequipment_json_write(json, 2048, thermalequipment_id);
+    if (len < 0 || len >= 2048) {
+        free(json);
+        return NULL;
+    }
+
     return json;
 }
 
@@ -3007,8 +3128,9 @@ int handle_thermalequipment(const char *thermalequipment_id, http_response_t *re
         return ERROR_INVALID_PARAM;
     }
 
-    char *json = generate_thermalequipment_json(thermalequipment_id);
-    if (!json) {
+    // Written straight into the response body
+    int len = thermalequipment_json_write(response->body, sizeof(response->body), thermalequipment_id);
+    if (len < 0 || (size_t)len >= sizeof(response->body)) {
         // Return a general Redfish-compliant 404 for any unsupported or missing ThermalEquipment subresource
         response->status_code = HTTP_NOT_FOUND;
         strcpy(response->content_type, "application/json");
@@ -3034,10 +3156,8 @@ int handle_thermalequipment(const char *thermalequipment_id, http_response_t *re
 
     response->status_code = HTTP_OK;
     strcpy(response->content_type, "application/json");
-    strcpy(response->body, json);
-    response->content_length = strlen(response->body);
-    
-    free(json);
+    response->content_length = len;
+
     return SUCCESS;
 }
 
@@ -3238,6 +3358,9 @@ int handle_cdu_oem_kenmec_config_read(const char *cdu_id, http_response_t *respo
 
     int config_count = 0;
 
+    // Keep the config snapshots alive while they are serialized
+    control_logic_config_read_lock();
+
     // "SystemConfigs"
     cJSON *system_configs = cJSON_CreateObject();
     system_config_t *system_config = control_logic_system_configs_get();
@@ -3347,18 +3470,11 @@ int handle_cdu_oem_kenmec_config_read(const char *cdu_id, http_response_t *respo
     }
     cJSON_AddItemToObject(response_json, "AnalogOutputVoltageConfigs", analog_output_voltage_config_array);
 
-    // json to string
-    char *json_string = cJSON_PrintUnformatted(response_json);
-    if (json_string) {
-        // debug(tag, "json_string length: %d", strlen(json_string));
-        // debug(tag, "response->body: %d", sizeof(response->body));
-        sprintf(response->body, "%s", json_string);
-        // debug(tag, "response->body: %d", strlen(response->body));
-        free(json_string);
-    }
+    control_logic_config_read_unlock();
+
+    // json to string; config sets with many devices outgrow body[]
+    redfish_response_set_json(response, response_json);
     cJSON_Delete(response_json);
-   
-    response->content_length = strlen(response->body);
 
     return SUCCESS;
 }
@@ -3540,16 +3656,9 @@ int handle_cdu_oem_kenmec_config_write(const char *cdu_id, http_request_t *reque
     cJSON_AddStringToObject(response_json, "@odata.id", odata_id);
     cJSON_AddStringToObject(response_json, "Status", "Success");
     
-    char *json_string = cJSON_Print(response_json);
-    if (json_string) {
-        strncpy(response->body, json_string, sizeof(response->body) - 1);
-        response->body[sizeof(response->body) - 1] = '\0';
-        free(json_string);
-    }
+    redfish_response_set_json(response, response_json);
     cJSON_Delete(response_json);
 
-    response->content_length = strlen(response->body);
-
     return SUCCESS;
 }
 
@@ -3650,13 +3759,343 @@ int handle_cdu_oem_kenmec(const char *cdu_id, http_response_t *response) {
         "\"Description\":\"Kenmec-specific extensions for CDU resource\","
         "\"IOBoards\":{\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/IOBoards\"},"
         "\"Config\":{\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/Config\"},"
-        "\"ControlLogics\":{\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/ControlLogics\"}"
+        "\"ControlLogics\":{\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/ControlLogics\"},"
+        "\"History\":{\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/History\"},"
+        "\"Latency\":{\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/Latency\"}"
         "}",
-        cdu_id, cdu_id, cdu_id, cdu_id);
+        cdu_id, cdu_id, cdu_id, cdu_id, cdu_id, cdu_id);
     response->content_length = strlen(response->body);
     return SUCCESS;
 }
 
+// Latency histograms of hardware access, control logics, Modbus device
+// polling and request handling; times are in microseconds
+int handle_cdu_oem_latency(const char *cdu_id, http_response_t *response) {
+    if (!cdu_id || !response) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (strcmp(cdu_id, "1") != 0) {
+        response->status_code = HTTP_NOT_FOUND;
+        strcpy(response->content_type, "application/json");
+        snprintf(response->body, sizeof(response->body),
+            "{\"error\":{\"code\":\"Base.1.15.0.ResourceMissingAtURI\",\"message\":\"The resource at the URI /redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/Latency was not found.\"}}",
+            cdu_id);
+        response->content_length = strlen(response->body);
+        return SUCCESS;
+    }
+
+    char *p = response->body;
+    char *end = response->body + sizeof(response->body);
+    p += snprintf(p, (size_t)(end - p),
+        "{"
+        "\"@odata.type\":\"#KenmecLatency.v1_0_0.KenmecLatency\","
+        "\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/Latency\","
+        "\"Name\":\"Kenmec Latency Histograms\","
+        "\"Metrics\":[",
+        cdu_id);
+    bool first = true;
+    for (int m = 0; m < CONTROL_LOGIC_LATENCY_METRIC_NUM && p < end; m++) {
+        control_logic_latency_summary_t summary;
+        if (control_logic_latency_summary_get((control_logic_latency_metric_t)m, &summary) != SUCCESS ||
+            summary.count == 0) {
+            continue;
+        }
+        p += snprintf(p, (size_t)(end - p),
+            "%s{\"Name\":\"%s\",\"Count\":%llu,\"MeanUs\":%.3f,\"P50Us\":%.3f,\"P90Us\":%.3f,\"P99Us\":%.3f,\"MaxUs\":%.3f}",
+            first ? "" : ",", control_logic_latency_name((control_logic_latency_metric_t)m),
+            (unsigned long long)summary.count, (double)summary.sum_ns / (double)summary.count / 1000.0,
+            summary.p50_ns / 1000.0, summary.p90_ns / 1000.0, summary.p99_ns / 1000.0, summary.max_ns / 1000.0);
+        first = false;
+    }
+    if (p < end) {
+        p += snprintf(p, (size_t)(end - p), "]}");
+    }
+    if (p >= end) {
+        return ERROR_MEMORY;
+    }
+
+    response->status_code = HTTP_OK;
+    strcpy(response->content_type, "application/json");
+    response->content_length = (int)(p - response->body);
+    return SUCCESS;
+}
+
+// The same histograms in the Prometheus text format, one summary per metric
+int handle_metrics_prometheus(http_response_t *response) {
+    if (!response) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    static const struct {
+        const char *label;
+        size_t offset;
+    } quantiles[] = {
+        { "0.5", offsetof(control_logic_latency_summary_t, p50_ns) },
+        { "0.9", offsetof(control_logic_latency_summary_t, p90_ns) },
+        { "0.99", offsetof(control_logic_latency_summary_t, p99_ns) },
+    };
+
+    char *p = response->body;
+    char *end = response->body + sizeof(response->body);
+    p += snprintf(p, (size_t)(end - p),
+        "# HELP kenmec_latency_seconds Latency of hardware access, control logics and request handling.\n"
+        "# TYPE kenmec_latency_seconds summary\n");
+    for (int m = 0; m < CONTROL_LOGIC_LATENCY_METRIC_NUM && p < end; m++) {
+        control_logic_latency_summary_t summary;
+        if (control_logic_latency_summary_get((control_logic_latency_metric_t)m, &summary) != SUCCESS) {
+            continue;
+        }
+        const char *name = control_logic_latency_name((control_logic_latency_metric_t)m);
+        for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]) && p < end; q++) {
+            uint64_t ns;
+            memcpy(&ns, (const char *)&summary + quantiles[q].offset, sizeof(ns));
+            p += snprintf(p, (size_t)(end - p), "kenmec_latency_seconds{op=\"%s\",quantile=\"%s\"} %.9f\n",
+                          name, quantiles[q].label, ns / 1e9);
+        }
+        if (p < end) {
+            p += snprintf(p, (size_t)(end - p),
+                "kenmec_latency_seconds_sum{op=\"%s\"} %.9f\n"
+                "kenmec_latency_seconds_count{op=\"%s\"} %llu\n",
+                name, summary.sum_ns / 1e9, name, (unsigned long long)summary.count);
+        }
+    }
+    if (p < end) {
+        p += snprintf(p, (size_t)(end - p),
+            "# HELP kenmec_latency_max_seconds Longest latency since start.\n"
+            "# TYPE kenmec_latency_max_seconds gauge\n");
+    }
+    for (int m = 0; m < CONTROL_LOGIC_LATENCY_METRIC_NUM && p < end; m++) {
+        control_logic_latency_summary_t summary;
+        if (control_logic_latency_summary_get((control_logic_latency_metric_t)m, &summary) != SUCCESS) {
+            continue;
+        }
+        p += snprintf(p, (size_t)(end - p), "kenmec_latency_max_seconds{op=\"%s\"} %.9f\n",
+                      control_logic_latency_name((control_logic_latency_metric_t)m), summary.max_ns / 1e9);
+    }
+    if (p >= end) {
+        return ERROR_MEMORY;
+    }
+
+    response->status_code = HTTP_OK;
+    strcpy(response->content_type, "text/plain; version=0.0.4");
+    response->content_length = (int)(p - response->body);
+    return SUCCESS;
+}
+
+// Sensor history: one member per Modbus register that has samples. A member
+// GET returns the downsampled window ending now, e.g.
+//   .../History/1000?window=86400&points=1440&format=binary
+#define HISTORY_DEFAULT_WINDOW_S 3600
+#define HISTORY_DEFAULT_POINTS 360
+#define HISTORY_POINTS_MAX 4096
+#define HISTORY_BINARY_MAGIC "KHS1"
+
+static void history_not_found(const char *cdu_id, const char *member_id, http_response_t *response) {
+    response->status_code = HTTP_NOT_FOUND;
+    strcpy(response->content_type, "application/json");
+    snprintf(response->body, sizeof(response->body),
+        "{\"error\":{\"code\":\"Base.1.15.0.ResourceMissingAtURI\",\"message\":\"The resource at the URI /redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/History%s%s was not found.\"}}",
+        cdu_id, member_id ? "/" : "", member_id ? member_id : "");
+    response->content_length = strlen(response->body);
+}
+
+// Value of an unsigned query parameter, or def when it is absent
+static unsigned long history_query_uint(const char *path, const char *name, unsigned long def) {
+    const char *p = strchr(path, '?');
+    size_t name_len = strlen(name);
+
+    while (p) {
+        p++;
+        if (strncmp(p, name, name_len) == 0 && p[name_len] == '=') {
+            char *end = NULL;
+            unsigned long value = strtoul(p + name_len + 1, &end, 10);
+            return end != p + name_len + 1 ? value : def;
+        }
+        p = strchr(p, '&');
+    }
+    return def;
+}
+
+static bool history_query_has(const char *path, const char *param) {
+    const char *p = strchr(path, '?');
+    size_t len = strlen(param);
+
+    while (p) {
+        p++;
+        if (strncmp(p, param, len) == 0 && (p[len] == '\0' || p[len] == '&')) {
+            return true;
+        }
+        p = strchr(p, '&');
+    }
+    return false;
+}
+
+static char *history_append_floats(char *p, const char *name, const control_logic_history_point_t *points, int count,
+                                   size_t field) {
+    p += sprintf(p, ",\"%s\":[", name);
+    for (int i = 0; i < count; i++) {
+        if (i > 0) *p++ = ',';
+        if (points[i].count == 0) {
+            memcpy(p, "null", 4);
+            p += 4;
+        } else {
+            float value;
+            memcpy(&value, (const char *)&points[i] + field, sizeof(value));
+            p += sprintf(p, "%.7g", value);
+        }
+    }
+    *p++ = ']';
+    return p;
+}
+
+int handle_cdu_oem_history(const char *cdu_id, http_response_t *response) {
+    if (!cdu_id || !response) {
+        return ERROR_INVALID_PARAM;
+    }
+    if (strcmp(cdu_id, "1") != 0) {
+        history_not_found(cdu_id, NULL, response);
+        return SUCCESS;
+    }
+
+    int count = control_logic_history_channels_get(NULL, 0);
+    uint16_t *addresses = malloc(sizeof(uint16_t) * (size_t)(count > 0 ? count : 1));
+    size_t buffer_size = 512 + (size_t)count * 96;
+    char *json = malloc(buffer_size);
+    if (!addresses || !json) {
+        free(addresses);
+        free(json);
+        return ERROR_MEMORY;
+    }
+    count = control_logic_history_channels_get(addresses, count);
+
+    int offset = snprintf(json, buffer_size,
+        "{"
+        "\"@odata.type\":\"#KenmecHistoryCollection.v1_0_0.KenmecHistoryCollection\","
+        "\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/History\","
+        "\"Name\":\"Kenmec Sensor History\","
+        "\"Members@odata.count\":%d,"
+        "\"Members\":[",
+        cdu_id, count);
+    for (int i = 0; i < count; i++) {
+        offset += snprintf(json + offset, buffer_size - (size_t)offset,
+            "%s{\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/History/%u\"}",
+            i == 0 ? "" : ",", cdu_id, addresses[i]);
+    }
+    offset += snprintf(json + offset, buffer_size - (size_t)offset, "]}");
+
+    response->status_code = HTTP_OK;
+    strcpy(response->content_type, "application/json");
+    int ret = redfish_response_set_body(response, json, (size_t)offset);
+
+    free(addresses);
+    free(json);
+    return ret;
+}
+
+int handle_cdu_oem_history_member(const char *cdu_id, const char *member_id, const http_request_t *request,
+                                  http_response_t *response) {
+    if (!cdu_id || !member_id || !request || !response) {
+        return ERROR_INVALID_PARAM;
+    }
+
+    char *end = NULL;
+    unsigned long address = strtoul(member_id, &end, 10);
+    if (strcmp(cdu_id, "1") != 0 || end == member_id || *end != '\0' || address > UINT16_MAX) {
+        history_not_found(cdu_id, member_id, response);
+        return SUCCESS;
+    }
+
+    unsigned long window_s = history_query_uint(request->path, "window", HISTORY_DEFAULT_WINDOW_S);
+    unsigned long point_num = history_query_uint(request->path, "points", HISTORY_DEFAULT_POINTS);
+    if (point_num == 0) point_num = 1;
+    if (point_num > HISTORY_POINTS_MAX) point_num = HISTORY_POINTS_MAX;
+    uint64_t step_ms = (uint64_t)window_s * 1000ULL / point_num;
+    if (step_ms == 0) step_ms = 1;
+    if (step_ms > UINT32_MAX) step_ms = UINT32_MAX;
+
+    uint64_t end_ms = time_get_current_ms();
+    uint64_t span_ms = step_ms * point_num;
+    uint64_t from_ms = end_ms > span_ms ? end_ms - span_ms : 0;
+
+    control_logic_history_point_t *points = malloc(sizeof(*points) * point_num);
+    if (!points) {
+        return ERROR_MEMORY;
+    }
+    if (control_logic_history_query((uint16_t)address, from_ms, (uint32_t)step_ms, points, (int)point_num) != SUCCESS) {
+        free(points);
+        history_not_found(cdu_id, member_id, response);
+        return SUCCESS;
+    }
+
+    int ret;
+    if (history_query_has(request->path, "format=binary")) {
+        // "KHS1", u16 address, u16 reserved, u32 step ms, u32 point count,
+        // u64 start ms, then per point f32 min/max/avg and u32 count (little endian)
+        size_t len = 24 + point_num * 16;
+        char *bin = malloc(len);
+        if (!bin) {
+            free(points);
+            return ERROR_MEMORY;
+        }
+        uint16_t addr16 = (uint16_t)address;
+        uint16_t reserved = 0;
+        uint32_t step32 = (uint32_t)step_ms;
+        uint32_t count32 = (uint32_t)point_num;
+        char *p = bin;
+        memcpy(p, HISTORY_BINARY_MAGIC, 4);              p += 4;
+        memcpy(p, &addr16, 2);                           p += 2;
+        memcpy(p, &reserved, 2);                         p += 2;
+        memcpy(p, &step32, 4);                           p += 4;
+        memcpy(p, &count32, 4);                          p += 4;
+        memcpy(p, &from_ms, 8);                          p += 8;
+        for (unsigned long i = 0; i < point_num; i++) {
+            memcpy(p, &points[i].min, 4);                p += 4;
+            memcpy(p, &points[i].max, 4);                p += 4;
+            memcpy(p, &points[i].avg, 4);                p += 4;
+            memcpy(p, &points[i].count, 4);              p += 4;
+        }
+
+        response->status_code = HTTP_OK;
+        strcpy(response->content_type, "application/octet-stream");
+        ret = redfish_response_set_body(response, bin, len);
+        free(bin);
+    } else {
+        // Count array plus three float arrays; an empty interval is null
+        size_t size = 512 + point_num * (11 + 3 * 16);
+        char *json = malloc(size);
+        if (!json) {
+            free(points);
+            return ERROR_MEMORY;
+        }
+        char *p = json;
+        p += sprintf(p,
+            "{"
+            "\"@odata.type\":\"#KenmecHistory.v1_0_0.KenmecHistory\","
+            "\"@odata.id\":\"/redfish/v1/ThermalEquipment/CDUs/%s/Oem/Kenmec/History/%lu\","
+            "\"Address\":%lu,"
+            "\"StartTimeMs\":%llu,"
+            "\"StepMs\":%llu,"
+            "\"Count\":[",
+            cdu_id, address, address, (unsigned long long)from_ms, (unsigned long long)step_ms);
+        for (unsigned long i = 0; i < point_num; i++) {
+            p += sprintf(p, i == 0 ? "%u" : ",%u", points[i].count);
+        }
+        *p++ = ']';
+        p = history_append_floats(p, "Min", points, (int)point_num, offsetof(control_logic_history_point_t, min));
+        p = history_append_floats(p, "Max", points, (int)point_num, offsetof(control_logic_history_point_t, max));
+        p = history_append_floats(p, "Avg", points, (int)point_num, offsetof(control_logic_history_point_t, avg));
+        *p++ = '}';
+
+        response->status_code = HTTP_OK;
+        strcpy(response->content_type, "application/json");
+        ret = redfish_response_set_body(response, json, (size_t)(p - json));
+        free(json);
+    }
+
+    free(points);
+    return ret;
+}
+
 
 int handle_cdu_oem_control_logics(const char *cdu_id, http_response_t *response) {
     if (!cdu_id || !response) {
@@ -4358,190 +4797,46 @@ int handle_update_service(http_response_t *response)
     return SUCCESS;
 }
 
-// Binary-safe memory search function
-static void* binary_search(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len) {
-    if (needle_len == 0 || haystack_len < needle_len) return NULL;
-    
-    const unsigned char *h = (const unsigned char *)haystack;
-    const unsigned char *n = (const unsigned char *)needle;
-    
-    for (size_t i = 0; i <= haystack_len - needle_len; i++) {
-        if (memcmp(h + i, n, needle_len) == 0) {
-            return (void *)(h + i);
-        }
-    }
-    return NULL;
-}
-
-// Extract boundary from Content-Type header
-static char* extract_boundary(const char *content_type) {
-    const char *boundary_start = strstr(content_type, "boundary=");
-    if (!boundary_start) return NULL;
-    
-    boundary_start += 9; // Skip "boundary="
-    
-    // Find end of boundary (space, semicolon, or end of string)
-    const char *boundary_end = boundary_start;
-    while (*boundary_end && *boundary_end != ' ' && *boundary_end != ';' && *boundary_end != '\r' && *boundary_end != '\n') {
-        boundary_end++;
-    }
-    
-    size_t len = (size_t)(boundary_end - boundary_start);
-    char *boundary = malloc(len + 1);
-    if (!boundary) return NULL;
-    
-    strncpy(boundary, boundary_start, len);
-    boundary[len] = '\0';
-    return boundary;
-}
-
-// Parse multipart data and extract file content
-static int parse_multipart_file(const char *filepath, const char *boundary, const char *output_filepath, long *extracted_bytes) {
+// Unpack the multipart body stored in filepath into output_filepath.
+// Used when the body was written to disk as received; the file is streamed
+// through the parser so memory use stays constant.
+static int parse_multipart_file(const char *filepath, const char *boundary, const char *output_filepath,
+                                long *extracted_bytes, char *sha256_hex) {
     FILE *input = fopen(filepath, "rb");
     if (!input) return -1;
-    
-    // Read the entire file into memory
-    fseek(input, 0, SEEK_END);
-    long file_size = ftell(input);
-    fseek(input, 0, SEEK_SET);
-    
-    char *file_data = malloc(file_size + 1);
-    if (!file_data) {
+
+    int out_fd = open(output_filepath, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    if (out_fd < 0) {
         fclose(input);
         return -1;
     }
-    
-    if (fread(file_data, 1, file_size, input) != (size_t)file_size) {
-        free(file_data);
+
+    multipart_parser_t *parser = malloc(sizeof(multipart_parser_t));
+    if (!parser || multipart_parser_init(parser, boundary, out_fd) != SUCCESS) {
+        free(parser);
+        close(out_fd);
         fclose(input);
         return -1;
     }
-    file_data[file_size] = '\0';  // Null terminate for string operations
-    fclose(input);
-    
-    // RFC 2046 multipart boundary format tokens
-    char boundary_token[256];           // --boundary
-    char next_boundary_crlf[258];       // \r\n--boundary
-    char end_boundary_token[258];       // --boundary--
-    snprintf(boundary_token, sizeof(boundary_token), "--%s", boundary);
-    snprintf(next_boundary_crlf, sizeof(next_boundary_crlf), "\r\n--%s", boundary);
-    snprintf(end_boundary_token, sizeof(end_boundary_token), "--%s--", boundary);
-
-    // Iterate parts; extract the one with name="UpdateFile" (or fallback to name="file")
-    char *cursor = file_data;
-    char *found_content_start = NULL;
-    long found_content_len = 0;
-
-    while (1) {
-        size_t remaining_all = file_size - (cursor - file_data);
-        char *bstart = binary_search(cursor, remaining_all, boundary_token, strlen(boundary_token));
-        if (!bstart) break;
-
-        // Advance past boundary and line break
-        char *p = bstart + strlen(boundary_token);
-        if (*p == '\r') p++;
-        if (*p == '\n') p++;
-
-        // Locate headers end
-        size_t remain = file_size - (p - file_data);
-        char *hdr_end = binary_search(p, remain, "\r\n\r\n", 4);
-        if (hdr_end) {
-            hdr_end += 4;
-        } else {
-            hdr_end = binary_search(p, remain, "\n\n", 2);
-            if (!hdr_end) break; // malformed
-            hdr_end += 2;
-        }
-
-        // Parse headers to find Content-Disposition name
-        size_t hdr_len = (size_t)(hdr_end - p);
-        const char *cd = (const char *)p;
-        const char *cd_end = (const char *)p + hdr_len;
-        int is_update_file = 0;
-        while (cd < cd_end) {
-            const char *line_end = memchr(cd, '\n', (size_t)(cd_end - cd));
-            if (!line_end) line_end = cd_end;
-            if ((size_t)(line_end - cd) >= 19 && strncasecmp(cd, "Content-Disposition:", 19) == 0) {
-                // look for name="UpdateFile" or name="file"
-                if (strstr(cd, "name=\"UpdateFile\"") || strstr(cd, "name=\"file\"")) {
-                    is_update_file = 1;
-                }
-            }
-            cd = line_end + 1;
-        }
 
-        // Content starts at hdr_end
-        char *content_start = hdr_end;
-
-        // Find next boundary (start of next part) or final boundary using full-line matches
-        size_t rem_after = file_size - (content_start - file_data);
-        char next_full[260];      // "\r\n--boundary\r\n"
-        char next_nl[260];        // "\n--boundary\r\n" (tolerate lone LF)
-        char end_full[260];       // "\r\n--boundary--"
-        char end_nl[260];         // "\n--boundary--"
-        snprintf(next_full, sizeof(next_full), "\r\n--%s\r\n", boundary);
-        snprintf(next_nl, sizeof(next_nl),   "\n--%s\r\n",  boundary);
-        snprintf(end_full, sizeof(end_full),  "\r\n--%s--",  boundary);
-        snprintf(end_nl, sizeof(end_nl),      "\n--%s--",     boundary);
-
-        char *nb1 = binary_search(content_start, rem_after, next_full, strlen(next_full));
-        char *nb2 = binary_search(content_start, rem_after, next_nl,   strlen(next_nl));
-        char *endb1 = binary_search(content_start, rem_after, end_full, strlen(end_full));
-        char *endb2 = binary_search(content_start, rem_after, end_nl,   strlen(end_nl));
-
-        // Pick earliest valid candidates
-        char *nb = NULL; if (nb1 && (!nb || nb1 < nb)) nb = nb1; if (nb2 && (!nb || nb2 < nb)) nb = nb2;
-        char *endb = NULL; if (endb1 && (!endb || endb1 < endb)) endb = endb1; if (endb2 && (!endb || endb2 < endb)) endb = endb2;
-
-        char *content_end = NULL;
-        int used_next = 0;
-        if (nb && endb) {
-            if (nb < endb) { content_end = nb; used_next = 1; } else { content_end = endb; used_next = 0; }
-        } else if (nb) {
-            content_end = nb; used_next = 1;
-        } else if (endb) {
-            content_end = endb; used_next = 0;
-        } else {
-            // No valid boundary line found; abort this part
-            break;
-        }
-
-        if (is_update_file) {
-            found_content_start = content_start;
-            found_content_len = (long)(content_end - content_start);
-            break;
-        }
-
-        // Advance cursor to search for next part
-        if (used_next) {
-            cursor = content_end + strlen(next_full);
-        } else {
-            // Final boundary reached; stop iterating
+    int ret = 0;
+    unsigned char chunk[16384];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+        if (multipart_parser_feed(parser, chunk, n) != SUCCESS) {
+            ret = -1;
             break;
         }
     }
-
-    if (!found_content_start || found_content_len <= 0) {
-        free(file_data);
-        return -1;
+    if (ret == 0 && (ferror(input) || multipart_parser_finish(parser, extracted_bytes, sha256_hex) != SUCCESS)) {
+        ret = -1;
     }
 
-    // Write extracted content to output file
-    FILE *output = fopen(output_filepath, "wb");
-    if (!output) {
-        free(file_data);
-        return -1;
-    }
-    if (fwrite(found_content_start, 1, (size_t)found_content_len, output) != (size_t)found_content_len) {
-        free(file_data);
-        fclose(output);
-        return -1;
-    }
-    *extracted_bytes = found_content_len;
-
-    free(file_data);
-    fclose(output);
-    return 0;
+    multipart_parser_free(parser);
+    free(parser);
+    if (close(out_fd) != 0) ret = -1;
+    fclose(input);
+    return ret;
 }
 
 int handle_update_service_multipart_upload(const http_request_t *request, http_response_t *response)
@@ -4566,8 +4861,8 @@ int handle_update_service_multipart_upload(const http_request_t *request, http_r
     }
 
     // Extract boundary from Content-Type
-    char *boundary = extract_boundary(content_type);
-    if (!boundary) {
+    char boundary[MULTIPART_BOUNDARY_MAX_LEN + 1];
+    if (multipart_boundary_from_content_type(content_type, boundary, sizeof(boundary)) != SUCCESS) {
         response->status_code = HTTP_BAD_REQUEST;
         strcpy(response->content_type, CONTENT_TYPE_JSON);
         strcpy(response->body, "{\"error\":{\"code\":\"Base.1.15.0.MalformedJSON\",\"message\":\"Missing boundary in multipart Content-Type\"}}\n");
@@ -4575,16 +4870,34 @@ int handle_update_service_multipart_upload(const http_request_t *request, http_r
         return SUCCESS;
     }
 
-    // Create output file path for extracted content
-    char extracted_filepath[256];
-    snprintf(extracted_filepath, sizeof(extracted_filepath), "%s.extracted", request->upload_tmp_path);
-    
-    // Parse multipart and extract file content
-    long extracted_bytes = 0;
-    int parse_result = parse_multipart_file(request->upload_tmp_path, boundary, extracted_filepath, &extracted_bytes);
-    
-    free(boundary);
-    
+    long extracted_bytes = request->upload_bytes;
+    char sha256_hex[MULTIPART_SHA256_HEX_LEN] = {0};
+    snprintf(sha256_hex, sizeof(sha256_hex), "%s", request->upload_sha256);
+
+    // The HTTP server normally unpacks the body while receiving it; otherwise
+    // the raw multipart body is on disk and is unpacked here
+    int parse_result = 0;
+    if (request->upload_extracted < 0) {
+        parse_result = -1;
+    } else if (request->upload_extracted == 0) {
+        // Create output file path for extracted content
+        char extracted_filepath[300];
+        snprintf(extracted_filepath, sizeof(extracted_filepath), "%s.extracted", request->upload_tmp_path);
+
+        parse_result = parse_multipart_file(request->upload_tmp_path, boundary, extracted_filepath,
+                                            &extracted_bytes, sha256_hex);
+        if (parse_result != 0) {
+            unlink(extracted_filepath);
+        } else if (rename(extracted_filepath, request->upload_tmp_path) != 0) {
+            // Replace original file with extracted content
+            response->status_code = HTTP_INTERNAL_SERVER_ERROR;
+            strcpy(response->content_type, CONTENT_TYPE_JSON);
+            strcpy(response->body, "{\"error\":{\"code\":\"Base.1.15.0.GeneralError\",\"message\":\"Failed to save extracted file\"}}\n");
+            response->content_length = strlen(response->body);
+            return SUCCESS;
+        }
+    }
+
     if (parse_result != 0) {
         response->status_code = HTTP_INTERNAL_SERVER_ERROR;
         strcpy(response->content_type, CONTENT_TYPE_JSON);
@@ -4592,15 +4905,6 @@ int handle_update_service_multipart_upload(const http_request_t *request, http_r
         response->content_length = strlen(response->body);
         return SUCCESS;
     }
-    
-    // Replace original file with extracted content
-    if (rename(extracted_filepath, request->upload_tmp_path) != 0) {
-        response->status_code = HTTP_INTERNAL_SERVER_ERROR;
-        strcpy(response->content_type, CONTENT_TYPE_JSON);
-        strcpy(response->body, "{\"error\":{\"code\":\"Base.1.15.0.GeneralError\",\"message\":\"Failed to save extracted file\"}}\n");
-        response->content_length = strlen(response->body);
-        return SUCCESS;
-    }
 
     // Respond with path where clean data was stored
     response->status_code = HTTP_OK;
@@ -4609,10 +4913,11 @@ int handle_update_service_multipart_upload(const http_request_t *request, http_r
         "{\n"
         "  \"Message\": \"Multipart upload accepted and file extracted\",\n"
         "  \"SavedTo\": \"%s\",\n"
-        "  \"Bytes\": %ld\n"
+        "  \"Bytes\": %ld,\n"
+        "  \"SHA256\": \"%s\"\n"
         "}\n",
         request->upload_tmp_path[0] ? request->upload_tmp_path : "",
-        extracted_bytes);
+        extracted_bytes, sha256_hex);
     response->content_length = strlen(response->body);
 
     // Trigger firmware update
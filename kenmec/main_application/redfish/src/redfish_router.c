@@ -0,0 +1,304 @@
+#include "dexatek/main_application/include/application_common.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "redfish_router.h"
+
+static const char *tag = "redfish_router";
+
+// Route table entry; id_segment is the index of the path segment passed to
+// the handler as resource ID (-1 for none). For a "{name*}" segment the ID
+// runs to the end of the path.
+typedef struct {
+    const char *pattern;
+    redfish_resource_type_t type;
+    int id_segment;
+} redfish_route_t;
+
+#define CDU_PATH "redfish/v1/ThermalEquipment/CDUs/{cdu}"
+#define MANAGER_PATH "redfish/v1/Managers/{manager}"
+
+static const redfish_route_t g_routes[] = {
+    { "redfish",                                                            REDFISH_RESOURCE_VERSION, -1 },
+    { "redfish/v1",                                                         REDFISH_RESOURCE_SERVICE_ROOT, -1 },
+    { "redfish/v1/odata",                                                   REDFISH_RESOURCE_ODATA_SERVICE, -1 },
+    { "redfish/v1/$metadata",                                               REDFISH_RESOURCE_ODATA_METADATA, -1 },
+
+    { "redfish/v1/CertificateService",                                      REDFISH_RESOURCE_CERTIFICATESERVICE, -1 },
+    { "redfish/v1/CertificateService/Actions/CertificateService.GenerateCSR",
+                                                                            REDFISH_RESOURCE_CERTIFICATESERVICE_GENERATE_CSR, -1 },
+    { "redfish/v1/CertificateService/Actions/CertificateService.ReplaceCertificate",
+                                                                            REDFISH_RESOURCE_CERTIFICATESERVICE_REPLACE_CERTIFICATE, -1 },
+    { "redfish/v1/UpdateService",                                           REDFISH_RESOURCE_UPDATESERVICE, -1 },
+    { "UpdateFirmwareMultipart",                                            REDFISH_RESOURCE_UPDATESERVICE_MULTIPART, -1 },
+
+    { "redfish/v1/Chassis",                                                 REDFISH_RESOURCE_CHASSIS_COLLECTION, -1 },
+    { "redfish/v1/Chassis/{chassis*}",                                      REDFISH_RESOURCE_CHASSIS, 3 },
+    { "redfish/v1/Systems",                                                 REDFISH_RESOURCE_SYSTEMS_COLLECTION, -1 },
+    { "redfish/v1/Systems/{system*}",                                       REDFISH_RESOURCE_SYSTEM, 3 },
+
+    // Resource documents are named after the ID, so the collection, Kenmec and
+    // interface routes pass their own last segment
+    { "redfish/v1/Managers",                                                REDFISH_RESOURCE_MANAGERS_COLLECTION, 2 },
+    { "redfish/v1/Managers/" MANAGER_ID_KENMEC,                             REDFISH_RESOURCE_MANAGERS_KENMEC, 3 },
+    { MANAGER_PATH "/EthernetInterfaces",                                   REDFISH_RESOURCE_MANAGERS_ETHERNET_INTERFACE, 4 },
+    { MANAGER_PATH "/EthernetInterfaces/eth0",                              REDFISH_RESOURCE_MANAGERS_ETHERNET_INTERFACE_ETH0, 5 },
+    { MANAGER_PATH "/NetworkProtocol",                                      REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL, 3 },
+    { MANAGER_PATH "/NetworkProtocol/HTTPS/Certificates",                   REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATES, 3 },
+    { MANAGER_PATH "/NetworkProtocol/HTTPS/Certificates/{certificate}",     REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATE, 7 },
+    { MANAGER_PATH "/SecurityPolicy",                                       REDFISH_RESOURCE_MANAGER_SECURITY_POLICY, 3 },
+    { MANAGER_PATH "/SecurityPolicy/TLS/Server/TrustedCertificates",        REDFISH_RESOURCE_MANAGER_SECURITY_POLICY_TRUSTED_CERTIFICATES, 3 },
+    { MANAGER_PATH "/SecurityPolicy/TLS/Server/TrustedCertificates/{certificate*}",
+                                                                            REDFISH_RESOURCE_MANAGER_SECURITY_POLICY_TRUSTED_CERTIFICATE, 8 },
+    { MANAGER_PATH "/Actions/Manager.Reset",                                REDFISH_RESOURCE_MANAGER_RESET_ACTION, 3 },
+
+    { "redfish/v1/AccountService",                                          REDFISH_RESOURCE_ACCOUNTSERVICE, -1 },
+    { "redfish/v1/AccountService/Accounts",                                 REDFISH_RESOURCE_ACCOUNTSERVICE_ACCOUNTS, -1 },
+    { "redfish/v1/AccountService/Accounts/{account*}",                      REDFISH_RESOURCE_ACCOUNTSERVICE_ACCOUNT, 4 },
+    { "redfish/v1/AccountService/Roles",                                    REDFISH_RESOURCE_ACCOUNTSERVICE_ROLES_COLLECTION, -1 },
+    { "redfish/v1/AccountService/Roles/{role*}",                            REDFISH_RESOURCE_ACCOUNTSERVICE_ROLE, 4 },
+
+    { "redfish/v1/EventService/SSE",                                        REDFISH_RESOURCE_EVENTSERVICE_SSE, -1 },
+
+    { "redfish/v1/SessionService",                                          REDFISH_RESOURCE_SESSIONSERVICE, -1 },
+    { "redfish/v1/SessionService/Sessions",                                 REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS, -1 },
+    { "redfish/v1/SessionService/Sessions/Members",                         REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS_MEMBERS, -1 },
+    { "redfish/v1/SessionService/Sessions/{session*}",                      REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS, 4 },
+
+    // Anything below ThermalEquipment that is not a CDU OEM route is a thermal equipment ID
+    { "redfish/v1/ThermalEquipment",                                        REDFISH_RESOURCE_THERMALEQUIPMENT_COLLECTION, -1 },
+    { "redfish/v1/ThermalEquipment/{thermalequipment*}",                    REDFISH_RESOURCE_THERMALEQUIPMENT, 3 },
+    { CDU_PATH "/Oem",                                                      REDFISH_RESOURCE_CDU_OEM, 4 },
+    { CDU_PATH "/Oem/Kenmec",                                               REDFISH_RESOURCE_CDU_OEM_KENMEC, 4 },
+    { CDU_PATH "/Oem/Kenmec/Config.Read",                                   REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_READ, 4 },
+    { CDU_PATH "/Oem/Kenmec/Config.Write",                                  REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_WRITE, 4 },
+    { CDU_PATH "/Oem/Kenmec/IOBoards",                                      REDFISH_RESOURCE_CDU_OEM_IOBOARDS, 4 },
+    { CDU_PATH "/Oem/Kenmec/IOBoards/{member*}",                            REDFISH_RESOURCE_CDU_OEM_IOBOARD_MEMBER, 4 },
+    { CDU_PATH "/Oem/Kenmec/IOBoards/{member}/Actions/Oem/KenmecIOBoard.Read",
+                                                                            REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_READ, 4 },
+    { CDU_PATH "/Oem/Kenmec/IOBoards/{member}/Actions/Oem/KenmecIOBoard.Write",
+                                                                            REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_WRITE, 4 },
+    { CDU_PATH "/Oem/Kenmec/ControlLogics",                                 REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS, 4 },
+    { CDU_PATH "/Oem/Kenmec/ControlLogics/{member*}",                       REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_MEMBER, 4 },
+    { CDU_PATH "/Oem/Kenmec/ControlLogics/{member}/Actions/Oem/ControlLogic.Read",
+                                                                            REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_READ, 4 },
+    { CDU_PATH "/Oem/Kenmec/ControlLogics/{member}/Actions/Oem/ControlLogic.Write",
+                                                                            REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_WRITE, 4 },
+    { CDU_PATH "/Oem/Kenmec/History",                                       REDFISH_RESOURCE_CDU_OEM_HISTORY, 4 },
+    { CDU_PATH "/Oem/Kenmec/History/{member}",                              REDFISH_RESOURCE_CDU_OEM_HISTORY_MEMBER, 4 },
+    { CDU_PATH "/Oem/Kenmec/Latency",                                       REDFISH_RESOURCE_CDU_OEM_LATENCY, 4 },
+
+    // Prometheus scrape target
+    { "metrics",                                                            REDFISH_RESOURCE_METRICS, -1 },
+};
+
+#define ROUTE_COUNT (sizeof(g_routes) / sizeof(g_routes[0]))
+
+// Trie node for one path segment
+typedef struct route_node {
+    const char *segment;                // Literal segment (not NUL-terminated)
+    size_t segment_len;
+    struct route_node *children;        // Literal children
+    struct route_node *next;            // Next sibling
+    struct route_node *param;           // "{name}" child
+    const redfish_route_t *route;       // Route ending at this node
+    const redfish_route_t *tail_route;  // "{name*}" route below this node
+} route_node_t;
+
+// Path split into segments
+typedef struct {
+    redfish_route_param_t segs[REDFISH_ROUTE_MAX_SEGMENTS];
+    int count;
+    const char *end;
+} route_path_t;
+
+static route_node_t g_route_root;
+static pthread_once_t g_route_once = PTHREAD_ONCE_INIT;
+static int g_route_init_result = SUCCESS;
+
+static route_node_t *route_node_child(route_node_t *node, const char *segment, size_t len, bool create)
+{
+    for (route_node_t *child = node->children; child; child = child->next) {
+        if (child->segment_len == len && child->segment[0] == segment[0] &&
+            memcmp(child->segment, segment, len) == 0) {
+            return child;
+        }
+    }
+    if (!create) return NULL;
+
+    route_node_t *child = calloc(1, sizeof(route_node_t));
+    if (!child) return NULL;
+    child->segment = segment;
+    child->segment_len = len;
+    child->next = node->children;
+    node->children = child;
+    return child;
+}
+
+static int route_insert(const redfish_route_t *route)
+{
+    route_node_t *node = &g_route_root;
+    const char *p = route->pattern;
+
+    while (*p) {
+        size_t len = strcspn(p, "/");
+        const char *next = p[len] == '/' ? p + len + 1 : p + len;
+
+        if (len >= 2 && p[0] == '{' && p[len - 1] == '}') {
+            if (p[len - 2] == '*') {
+                // "{name*}" is always the last segment
+                if (*next != '\0' || node->tail_route) {
+                    error(tag, "invalid or duplicate route %s", route->pattern);
+                    return ERROR_GENERAL;
+                }
+                node->tail_route = route;
+                return SUCCESS;
+            }
+            if (!node->param) {
+                node->param = calloc(1, sizeof(route_node_t));
+                if (!node->param) return ERROR_GENERAL;
+            }
+            node = node->param;
+        } else {
+            node = route_node_child(node, p, len, true);
+            if (!node) return ERROR_GENERAL;
+        }
+        p = next;
+    }
+
+    if (node->route) {
+        error(tag, "duplicate route %s", route->pattern);
+        return ERROR_GENERAL;
+    }
+    node->route = route;
+    return SUCCESS;
+}
+
+static void route_trie_build(void)
+{
+    for (size_t i = 0; i < ROUTE_COUNT; i++) {
+        if (route_insert(&g_routes[i]) != SUCCESS) {
+            g_route_init_result = ERROR_GENERAL;
+            return;
+        }
+    }
+    debug(tag, "%d routes compiled", (int)ROUTE_COUNT);
+}
+
+int redfish_router_init(void)
+{
+    pthread_once(&g_route_once, route_trie_build);
+    return g_route_init_result;
+}
+
+// Split the path without copying; an empty segment other than one trailing slash fails
+static bool route_path_split(const char *path, route_path_t *split)
+{
+    while (*path == '/') path++;
+
+    split->count = 0;
+    split->end = path;
+    const char *seg = path;
+    for (const char *p = path;; p++) {
+        char c = *p;
+        if (c != '/' && c != '\0' && c != '?' && c != '#') {
+            continue;
+        }
+        if (p > seg) {
+            if (split->count == REDFISH_ROUTE_MAX_SEGMENTS) return false;
+            split->segs[split->count].ptr = seg;
+            split->segs[split->count].len = (size_t)(p - seg);
+            split->count++;
+            split->end = p;
+        } else if (c == '/') {
+            return false;
+        }
+        if (c != '/') break;
+        seg = p + 1;
+    }
+    return true;
+}
+
+// Depth-first match: literal child, then "{name}", then "{name*}"
+static const redfish_route_t *route_match_node(const route_node_t *node, const route_path_t *split, int index,
+                                               redfish_route_match_t *match, int *tail_index)
+{
+    if (index == split->count) {
+        return node->route;
+    }
+
+    const redfish_route_param_t *seg = &split->segs[index];
+    const route_node_t *child = route_node_child((route_node_t *)node, seg->ptr, seg->len, false);
+    if (child) {
+        const redfish_route_t *route = route_match_node(child, split, index + 1, match, tail_index);
+        if (route) return route;
+    }
+
+    if (node->param && match->param_count < REDFISH_ROUTE_MAX_PARAMS) {
+        int param_count = match->param_count;
+        match->params[match->param_count++] = *seg;
+        const redfish_route_t *route = route_match_node(node->param, split, index + 1, match, tail_index);
+        if (route) return route;
+        match->param_count = param_count;
+    }
+
+    if (node->tail_route && match->param_count < REDFISH_ROUTE_MAX_PARAMS) {
+        match->params[match->param_count].ptr = seg->ptr;
+        match->params[match->param_count].len = (size_t)(split->end - seg->ptr);
+        match->param_count++;
+        *tail_index = index;
+        return node->tail_route;
+    }
+
+    return NULL;
+}
+
+redfish_resource_type_t parse_redfish_path(const char *path, redfish_route_match_t *match)
+{
+    if (!match) return REDFISH_RESOURCE_UNKNOWN;
+    memset(match, 0, sizeof(*match));
+    match->type = REDFISH_RESOURCE_UNKNOWN;
+    if (!path) return REDFISH_RESOURCE_UNKNOWN;
+
+    if (redfish_router_init() != SUCCESS) {
+        return REDFISH_RESOURCE_UNKNOWN;
+    }
+
+    route_path_t split;
+    if (!route_path_split(path, &split)) {
+        return REDFISH_RESOURCE_UNKNOWN;
+    }
+
+    int tail_index = -1;
+    const redfish_route_t *route = route_match_node(&g_route_root, &split, 0, match, &tail_index);
+    if (!route) {
+        match->param_count = 0;
+        return REDFISH_RESOURCE_UNKNOWN;
+    }
+
+    match->type = route->type;
+    if (route->id_segment >= 0) {
+        match->id = split.segs[route->id_segment];
+        if (route->id_segment == tail_index) {
+            match->id.len = (size_t)(split.end - match->id.ptr);
+        }
+    }
+    return route->type;
+}
+
+const char *redfish_route_param_str(const redfish_route_param_t *param, char *buf, size_t buf_size)
+{
+    if (!param || !param->ptr || param->len == 0) return NULL;
+    if (param->ptr[param->len] == '\0') return param->ptr;
+    if (!buf || buf_size == 0) return NULL;
+
+    size_t n = param->len < buf_size - 1 ? param->len : buf_size - 1;
+    memcpy(buf, param->ptr, n);
+    buf[n] = '\0';
+    return buf;
+}
@@ -10,11 +10,18 @@
 #include "redfish_resources.h"
 #include "redfish_client_info_handle.h"
 #include "redfish_server.h"
+#include "redfish_router.h"
+#include "redfish_event_stream.h"
 #include "redfish_init.h"
+#include "kenmec/main_application/control_logic/control_logic_latency.h"
 
 static const char *tag = "redfish_server";
 
 int redfish_server_init(void) {
+    if (redfish_router_init() != SUCCESS) {
+        error(tag, "Redfish route table is invalid");
+        return ERROR_GENERAL;
+    }
     debug(tag, "Redfish server initialized");
     return SUCCESS;
 }
@@ -51,9 +58,11 @@ int parse_http_request(const char *raw_request, http_request_t *request, int is_
     }
     *line_end = '\0';
 
-    char *method = strtok(line_start, " ");
-    char *path = strtok(NULL, " ");
-    char *version = strtok(NULL, " ");
+    // strtok_r: requests are parsed concurrently by the HTTP worker threads
+    char *saveptr = NULL;
+    char *method = strtok_r(line_start, " ", &saveptr);
+    char *path = strtok_r(NULL, " ", &saveptr);
+    char *version = strtok_r(NULL, " ", &saveptr);
 
     if (!method || !path || !version) {
         return ERROR_INVALID_PARAM;
@@ -317,7 +326,42 @@ static int check_configure_users_privilege(const http_request_t *request, http_r
     return FAIL;
 }
 
-int process_redfish_request(const http_request_t *request, http_response_t *response) {
+// True when the response carries an ETag listed in the request's If-None-Match
+static bool etag_matches_if_none_match(const http_request_t *request, const http_response_t *response) {
+    const char *etag = NULL;
+    for (int i = 0; i < response->header_count; i++) {
+        if (strcasecmp(response->headers[i][0], "ETag") == 0) {
+            etag = response->headers[i][1];
+            break;
+        }
+    }
+    if (!etag || etag[0] == '\0') {
+        return false;
+    }
+
+    for (int i = 0; i < request->header_count; i++) {
+        if (strcasecmp(request->headers[i][0], "If-None-Match") != 0) {
+            continue;
+        }
+
+        // Comma separated list of entity tags, weak comparison per RFC 7232
+        const char *p = request->headers[i][1];
+        size_t etag_len = strlen(etag);
+        while (*p) {
+            while (*p == ' ' || *p == '\t' || *p == ',') p++;
+            if (*p == '*') return true;
+            if (strncmp(p, "W/", 2) == 0) p += 2;
+            size_t len = strcspn(p, ", \t");
+            if (len == etag_len && strncmp(p, etag, len) == 0) {
+                return true;
+            }
+            p += len;
+        }
+    }
+    return false;
+}
+
+static int redfish_request_dispatch(const http_request_t *request, http_response_t *response) {
     if (!request || !response) {
         return ERROR_INVALID_PARAM;
     }
@@ -328,10 +372,16 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
     strcpy(response->content_type, CONTENT_TYPE_JSON);
 
     // Parse Redfish path
-    char *resource_id = NULL;
-    redfish_resource_type_t resource_type = parse_redfish_path(request->path, &resource_id);
-    
-    printf("DEBUG: resource_type = %d, resource_id = %s\n", resource_type, resource_id ? resource_id : "NULL");
+    redfish_route_match_t route;
+    redfish_resource_type_t resource_type = parse_redfish_path(request->path, &route);
+
+    // Captures that end the path are used in place; IDs in the middle of the
+    // path (CDU, manager, member) are terminated in these request-local buffers
+    char resource_id_buf[MAX_PATH_LENGTH];
+    char member_buf[MAX_PATH_LENGTH];
+    const char *resource_id = redfish_route_param_str(&route.id, resource_id_buf, sizeof(resource_id_buf));
+
+    debug(tag, "resource_type = %d, resource_id = %s", resource_type, resource_id ? resource_id : "NULL");
 
     // Enforce OData-Version: 4.0 for requests that include OData-Version
     for (int i = 0; i < request->header_count; i++) {
@@ -480,24 +530,10 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
                 handler_result = handle_manager_network_protocol_https_certificates(resource_id, response);
                 break;
             case REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATE: {
-                // Extract manager_id from the request path and use resource_id as cert_id
-                const char *prefix = "/redfish/v1/Managers/";
-                static char manager_id_buf[64];
-                manager_id_buf[0] = '\0';
-                const char *base = request->path;
-                if (strncmp(base, prefix, strlen(prefix)) == 0) {
-                    const char *p = base + strlen(prefix); // points at {id}/...
-                    const char *slash = strchr(p, '/');
-                    if (slash) {
-                        size_t n = (size_t)(slash - p);
-                        if (n >= sizeof(manager_id_buf)) n = sizeof(manager_id_buf) - 1;
-                        strncpy(manager_id_buf, p, n);
-                        manager_id_buf[n] = '\0';
-                    }
-                }
-                const char *cert_id = resource_id;
-                const char *mgr = (manager_id_buf[0] != '\0') ? manager_id_buf : MANAGER_ID_KENMEC;
-                handler_result = handle_manager_network_protocol_https_certificate_member(mgr, cert_id, response);
+                // The manager ID is the first capture, resource_id is the certificate ID
+                const char *mgr = redfish_route_param_str(&route.params[0], member_buf, sizeof(member_buf));
+                handler_result = handle_manager_network_protocol_https_certificate_member(mgr ? mgr : MANAGER_ID_KENMEC,
+                                                                                          resource_id, response);
                 break;
             }
             case REDFISH_RESOURCE_MANAGERS_COLLECTION:
@@ -534,30 +570,14 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
             }
 
             case REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_READ: {
-                const char *anchor = "/Oem/Kenmec/ControlLogics/";
-                const char *pos = strstr(request->path, anchor);
-                const char *member = NULL;
-                if (pos) {
-                    pos += strlen(anchor);
-                    const char *slash = strchr(pos, '/');
-                    if (slash) {
-                        static char member_id[16];
-                        size_t n = (size_t)(slash - pos);
-                        if (n >= sizeof(member_id)) n = sizeof(member_id) - 1;
-                        strncpy(member_id, pos, n);
-                        member_id[n] = '\0';
-                        member = member_id;
-                    }
-                }
+                const char *member = redfish_route_param_str(&route.params[1], member_buf, sizeof(member_buf));
                 return handle_cdu_oem_control_logics_action_read(resource_id, member, request, response);
             }            
 
             case REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_MEMBER: {
-                // Need to extract member ID from the path tail after anchor
-                const char *anchor = "/Oem/Kenmec/ControlLogics/";
-                const char *pos = strstr(request->path, anchor);
-                const char *member = pos ? pos + strlen(anchor) : NULL;
-                if (!member || *member == '\0') {
+                // Member ID is the path tail after the CDU ID
+                const char *member = redfish_route_param_str(&route.params[1], member_buf, sizeof(member_buf));
+                if (!member) {
                     response->status_code = HTTP_NOT_FOUND;
                     strcpy(response->content_type, "application/json");
                     snprintf(response->body, sizeof(response->body),
@@ -570,11 +590,9 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
             }            
 
             case REDFISH_RESOURCE_CDU_OEM_IOBOARD_MEMBER: {
-                // Need to extract member ID from the path tail after anchor
-                const char *anchor = "/Oem/Kenmec/IOBoards/";
-                const char *pos = strstr(request->path, anchor);
-                const char *member = pos ? pos + strlen(anchor) : NULL;
-                if (!member || *member == '\0') {
+                // Member ID is the path tail after the CDU ID
+                const char *member = redfish_route_param_str(&route.params[1], member_buf, sizeof(member_buf));
+                if (!member) {
                     response->status_code = HTTP_NOT_FOUND;
                     strcpy(response->content_type, "application/json");
                     snprintf(response->body, sizeof(response->body),
@@ -590,21 +608,7 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
 
             case REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_READ: {
                 // Extract member id from path for the Read action on GET
-                const char *anchor = "/Oem/Kenmec/IOBoards/";
-                const char *pos = strstr(request->path, anchor);
-                const char *member = NULL;
-                if (pos) {
-                    pos += strlen(anchor);
-                    const char *slash = strchr(pos, '/');
-                    if (slash) {
-                        static char member_id[16];
-                        size_t n = (size_t)(slash - pos);
-                        if (n >= sizeof(member_id)) n = sizeof(member_id) - 1;
-                        strncpy(member_id, pos, n);
-                        member_id[n] = '\0';
-                        member = member_id;
-                    }
-                }
+                const char *member = redfish_route_param_str(&route.params[1], member_buf, sizeof(member_buf));
                 handler_result = handle_cdu_oem_ioboard_action_read(resource_id, member, request, response);
                 break;
             }
@@ -612,6 +616,33 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
             case REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_READ:
                 return handle_cdu_oem_kenmec_config_read(resource_id, response);
 
+            case REDFISH_RESOURCE_CDU_OEM_HISTORY:
+                handler_result = handle_cdu_oem_history(resource_id, response);
+                break;
+
+            case REDFISH_RESOURCE_CDU_OEM_LATENCY:
+                handler_result = handle_cdu_oem_latency(resource_id, response);
+                break;
+
+            case REDFISH_RESOURCE_METRICS:
+                handler_result = handle_metrics_prometheus(response);
+                break;
+
+            case REDFISH_RESOURCE_CDU_OEM_HISTORY_MEMBER: {
+                const char *member = redfish_route_param_str(&route.params[1], member_buf, sizeof(member_buf));
+                handler_result = handle_cdu_oem_history_member(resource_id, member, request, response);
+                break;
+            }
+
+            case REDFISH_RESOURCE_EVENTSERVICE_SSE:
+                // Only the head is produced here; on GET the HTTP server hands
+                // the connection to the event stream after sending it
+                response->status_code = HTTP_OK;
+                strcpy(response->content_type, REDFISH_SSE_CONTENT_TYPE);
+                response->content_length = 0;
+                response->event_stream = (strcmp(request->method, HTTP_METHOD_GET) == 0);
+                break;
+
             case REDFISH_RESOURCE_SESSIONSERVICE:
                 handler_result = handle_session_service(response);
                 break;
@@ -705,10 +736,15 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
             return generate_https_redirect_response(request, response);
         }
         
+        // Conditional GET: nothing to send if the client's copy is current
+        if (response->status_code == HTTP_OK && etag_matches_if_none_match(request, response)) {
+            response->status_code = HTTP_NOT_MODIFIED;
+            redfish_response_clear_body(response);
+        }
+
         // For HEAD requests, clear the body but keep headers
         if (strcmp(request->method, HTTP_METHOD_HEAD) == 0) {
-            response->body[0] = '\0';
-            response->content_length = 0;
+            redfish_response_clear_body(response);
         }
         
         return handler_result;
@@ -755,21 +791,7 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
 
             case REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_WRITE: {
                 if (check_configure_components_privilege(request, response) != SUCCESS) return SUCCESS;
-                const char *anchor = "/Oem/Kenmec/IOBoards/";
-                const char *pos = strstr(request->path, anchor);
-                const char *member = NULL;
-                if (pos) {
-                    pos += strlen(anchor);
-                    const char *slash = strchr(pos, '/');
-                    if (slash) {
-                        static char member_id[16];
-                        size_t n = (size_t)(slash - pos);
-                        if (n >= sizeof(member_id)) n = sizeof(member_id) - 1;
-                        strncpy(member_id, pos, n);
-                        member_id[n] = '\0';
-                        member = member_id;
-                    }
-                }
+                const char *member = redfish_route_param_str(&route.params[1], member_buf, sizeof(member_buf));
                 handler_result = handle_cdu_oem_ioboard_action_write(resource_id, member, request, response);
                 break;
             }
@@ -796,21 +818,7 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
                 break;
 
             case REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_WRITE: {
-                const char *anchor = "/Oem/Kenmec/ControlLogics/";
-                const char *pos = strstr(request->path, anchor);
-                const char *member = NULL;
-                if (pos) {
-                    pos += strlen(anchor);
-                    const char *slash = strchr(pos, '/');
-                    if (slash) {
-                        static char member_id[16];
-                        size_t n = (size_t)(slash - pos);
-                        if (n >= sizeof(member_id)) n = sizeof(member_id) - 1;
-                        strncpy(member_id, pos, n);
-                        member_id[n] = '\0';
-                        member = member_id;
-                    }
-                }
+                const char *member = redfish_route_param_str(&route.params[1], member_buf, sizeof(member_buf));
                 return handle_cdu_oem_control_logics_action_write(resource_id, member, request, response);
             }
 
@@ -1025,8 +1033,20 @@ int process_redfish_request(const http_request_t *request, http_response_t *resp
     return SUCCESS;
 }
 
-void generate_http_response(const http_response_t *response, char *output, size_t output_size) {
-    if (!response || !output) return;
+// Every request is timed into the redfish_request latency histogram
+int process_redfish_request(const http_request_t *request, http_response_t *response) {
+    uint64_t start_ns = control_logic_latency_start();
+    int ret = redfish_request_dispatch(request, response);
+    control_logic_latency_record(CONTROL_LOGIC_LATENCY_REDFISH_REQUEST, start_ns);
+
+    return ret;
+}
+
+// Status line and headers up to the blank line. With chunked set the body
+// length is announced as Transfer-Encoding: chunked instead of Content-Length.
+// Returns the length written, or -1 if output is too small.
+int generate_http_response_head(const http_response_t *response, int chunked, char *output, size_t output_size) {
+    if (!response || !output) return -1;
 
     const char *status_text = get_http_status_text(response->status_code);
 
@@ -1041,6 +1061,7 @@ void generate_http_response(const http_response_t *response, char *output, size_
         // Skip headers that are already emitted explicitly below
         if (strcasecmp(name, "Content-Type") == 0) continue;
         if (strcasecmp(name, "Content-Length") == 0) continue;
+        if (strcasecmp(name, "Transfer-Encoding") == 0) continue;
         if (strcasecmp(name, "Access-Control-Allow-Origin") == 0) continue;
         if (strcasecmp(name, "Access-Control-Allow-Headers") == 0) continue;
         if (strcasecmp(name, "Cache-Control") == 0) continue;
@@ -1054,557 +1075,155 @@ void generate_http_response(const http_response_t *response, char *output, size_
     const char *effective_content_type = response->content_type && response->content_type[0] ?
         response->content_type : "application/json";
 
-    snprintf(output, output_size,
+    char length_header[48];
+    if (response->event_stream) {
+        // Events follow until the connection closes
+        length_header[0] = '\0';
+    } else if (chunked) {
+        snprintf(length_header, sizeof(length_header), "Transfer-Encoding: chunked\r\n");
+    } else {
+        snprintf(length_header, sizeof(length_header), "Content-Length: %d\r\n", response->content_length);
+    }
+
+    int len = snprintf(output, output_size,
              "HTTP/1.1 %d %s\r\n"
              "Content-Type: %s\r\n"
-             "Content-Length: %d\r\n"
+             "%s"
              "Access-Control-Allow-Origin: *\r\n"
             //  "Access-Control-Allow-Methods: GET, POST, PUT, PATCH, DELETE\r\n"
              "Access-Control-Allow-Headers: Content-Type, Authorization\r\n"
              "Cache-Control: no-store\r\n"
              "OData-Version: 4.0\r\n"
              "%s"
-             "\r\n"
-             "%s",
+             "\r\n",
              response->status_code, status_text,
              effective_content_type,
-             response->content_length,
-             dynamic_headers,
-             response->body);
-}
-
-redfish_resource_type_t parse_redfish_path(const char *path, char **resource_id) {
-    if (!path) return REDFISH_RESOURCE_UNKNOWN;
+             length_header,
+             dynamic_headers);
 
-    printf("Path: %s **************\n", path);
+    if (len < 0 || (size_t)len >= output_size) {
+        return -1;
+    }
+    return len;
+}
 
-    // Remove leading and trailing slashes
-    while (*path == '/') path++;
+void generate_http_response(const http_response_t *response, char *output, size_t output_size) {
+    if (!response || !output || output_size == 0) return;
 
-    if (strcmp(path, "redfish") == 0 || strcmp(path, "redfish/") == 0) {
-        return REDFISH_RESOURCE_VERSION;
+    int head_len = generate_http_response_head(response, 0, output, output_size);
+    if (head_len < 0) {
+        output[0] = '\0';
+        return;
     }
 
-    if (strcmp(path, "redfish/v1") == 0 || strcmp(path, "redfish/v1/") == 0) {
-        return REDFISH_RESOURCE_SERVICE_ROOT;
-    }
+    // Truncated if it does not fit; the servers send the body separately
+    snprintf(output + head_len, output_size - (size_t)head_len, "%.*s",
+             response->content_length, redfish_response_body(response));
+}
 
-    if (strcmp(path, "redfish/v1/odata") == 0) {
-        return REDFISH_RESOURCE_ODATA_SERVICE;
-    }
+const char *redfish_response_body(const http_response_t *response) {
+    return response->body_ext ? response->body_ext : response->body;
+}
 
-    if (strcmp(path, "redfish/v1/$metadata") == 0) {
-        return REDFISH_RESOURCE_ODATA_METADATA;
-    }
+void redfish_response_clear_body(http_response_t *response) {
+    if (!response) return;
 
-    if (strcmp(path, "redfish/v1/CertificateService") == 0) {
-        return REDFISH_RESOURCE_CERTIFICATESERVICE;
-    }
-    if (strcmp(path, "redfish/v1/UpdateService") == 0) {
-        return REDFISH_RESOURCE_UPDATESERVICE;
-    }
-    
-    if (strcmp(path, "UpdateFirmwareMultipart") == 0) {
-        return REDFISH_RESOURCE_UPDATESERVICE_MULTIPART;
-    }
+    free(response->body_ext);
+    response->body_ext = NULL;
+    response->body_ext_size = 0;
+    response->body[0] = '\0';
+    response->content_length = 0;
+}
 
-    if (strcmp(path, "redfish/v1/CertificateService/Actions/CertificateService.GenerateCSR") == 0) {
-        return REDFISH_RESOURCE_CERTIFICATESERVICE_GENERATE_CSR;
-    }
-    if (strcmp(path, "redfish/v1/CertificateService/Actions/CertificateService.ReplaceCertificate") == 0) {
-        return REDFISH_RESOURCE_CERTIFICATESERVICE_REPLACE_CERTIFICATE;
-    }
+int redfish_response_set_body(http_response_t *response, const char *data, size_t len) {
+    if (!response || !data) return ERROR_INVALID_PARAM;
 
-    if (strncmp(path, "redfish/v1/Chassis", 18) == 0) {
-        if (strlen(path) == 18) {
-            return REDFISH_RESOURCE_CHASSIS_COLLECTION;
-        }
-        if (path[18] == '/') {
-            *resource_id = (char*)(path + 19);
-            return REDFISH_RESOURCE_CHASSIS;
+    char *dst = response->body;
+    if (len >= sizeof(response->body)) {
+        if (len >= REDFISH_RESPONSE_BODY_MAX) {
+            redfish_response_clear_body(response);
+            return ERROR_MEMORY;
         }
-    }
-
-    if (strncmp(path, "redfish/v1/Systems", 18) == 0) {
-        if (strlen(path) == 18) {
-            return REDFISH_RESOURCE_SYSTEMS_COLLECTION;
+        if (response->body_ext_size <= len) {
+            free(response->body_ext);
+            response->body_ext = malloc(len + 1);
+            response->body_ext_size = response->body_ext ? len + 1 : 0;
         }
-        if (path[18] == '/') {
-            *resource_id = (char*)(path + 19);
-            return REDFISH_RESOURCE_SYSTEM;
+        dst = response->body_ext;
+        if (!dst) {
+            redfish_response_clear_body(response);
+            return ERROR_MEMORY;
         }
+    } else {
+        free(response->body_ext);
+        response->body_ext = NULL;
+        response->body_ext_size = 0;
     }
 
-    if (strncmp(path, "redfish/v1/Managers", 19) == 0) {
-        if (strlen(path) == 19) {
-            *resource_id = (char*)(path + 11);
-            return REDFISH_RESOURCE_MANAGERS_COLLECTION;
-        }
-        if (strlen(path) == 26 && (strncmp(&path[20], MANAGER_ID_KENMEC, 6) == 0)) {
-            *resource_id = (char*)(path + 20);
-            return REDFISH_RESOURCE_MANAGERS_KENMEC;
-        }
+    memmove(dst, data, len);
+    dst[len] = '\0';
+    response->content_length = (int)len;
 
-        // SecurityPolicy and related endpoints: /redfish/v1/Managers/{id}/SecurityPolicy*
-        {
-            const char *prefix = "redfish/v1/Managers/";
-            if (strncmp(path, prefix, strlen(prefix)) == 0) {
-                const char *p = path + strlen(prefix); // points at {id}...
-                const char *slash = strchr(p, '/');
-                if (slash) {
-                    // Extract manager ID
-                    static char manager_id[64];
-                    size_t n = (size_t)(slash - p);
-                    if (n >= sizeof(manager_id)) n = sizeof(manager_id) - 1;
-                    strncpy(manager_id, p, n);
-                    manager_id[n] = '\0';
-                    *resource_id = manager_id;
-                    
-                    const char *remaining = slash + 1;
-                    
-                    // NetworkProtocol: /redfish/v1/Managers/{id}/NetworkProtocol
-                    if (strcmp(remaining, "NetworkProtocol") == 0) {
-                        return REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL;
-                    }
-                    // NetworkProtocol HTTPS Certificates collection: /redfish/v1/Managers/{id}/NetworkProtocol/HTTPS/Certificates
-                    if (strcmp(remaining, "NetworkProtocol/HTTPS/Certificates") == 0) {
-                        return REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATES;
-                    }
-                    printf("remaining: %s\n", remaining);
-                    // NetworkProtocol HTTPS Certificate member: /redfish/v1/Managers/{id}/NetworkProtocol/HTTPS/Certificates/{id}
-                    {
-                        const char *cert_prefix = "NetworkProtocol/HTTPS/Certificates/";
-                        size_t cert_prefix_len = strlen(cert_prefix);
-                        if (strncmp(remaining, cert_prefix, cert_prefix_len) == 0 && remaining[cert_prefix_len] != '\0') {
-                            static char certificate_id[64];
-                            const char *cid = remaining + cert_prefix_len;
-                            // Copy until end or next slash
-                            size_t n = strcspn(cid, "/");
-                            if (n >= sizeof(certificate_id)) n = sizeof(certificate_id) - 1;
-                            strncpy(certificate_id, cid, n);
-                            certificate_id[n] = '\0';
-                            *resource_id = certificate_id;
-                            return REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATE;
-                        }
-                    }
+    return SUCCESS;
+}
 
-                    // SecurityPolicy: /redfish/v1/Managers/{id}/SecurityPolicy
-                    if (strcmp(remaining, "SecurityPolicy") == 0) {
-                        return REDFISH_RESOURCE_MANAGER_SECURITY_POLICY;
-                    }
-                    
-                    // TrustedCertificates Collection: /redfish/v1/Managers/{id}/SecurityPolicy/TLS/Server/TrustedCertificates
-                    if (strcmp(remaining, "SecurityPolicy/TLS/Server/TrustedCertificates") == 0) {
-                        return REDFISH_RESOURCE_MANAGER_SECURITY_POLICY_TRUSTED_CERTIFICATES;
-                    }
-                    
-                    // TrustedCertificate Individual: /redfish/v1/Managers/{id}/SecurityPolicy/TLS/Server/TrustedCertificates/{id}
-                    if (strncmp(remaining, "SecurityPolicy/TLS/Server/TrustedCertificates/", 46) == 0) {
-                        *resource_id = (char*)(remaining + 46);
-                        return REDFISH_RESOURCE_MANAGER_SECURITY_POLICY_TRUSTED_CERTIFICATE;
-                    }
-                }
-            }
-        }
+// Lower bound of the compact text length: every string and key as is,
+// numbers as one digit. Cheap next to printing, which formats each number.
+static size_t response_json_min_length(const cJSON *item) {
+    size_t len = item->string ? strlen(item->string) + 3 : 0;
 
-        // Manager.Reset Action: /redfish/v1/Managers/{id}/Actions/Manager.Reset
-        {
-            const char *prefix = "redfish/v1/Managers/";
-            if (strncmp(path, prefix, strlen(prefix)) == 0) {
-                const char *p = path + strlen(prefix); // points at {id}...
-                const char *slash = strchr(p, '/');
-                if (slash && strncmp(slash + 1, "Actions/Manager.Reset", 21) == 0 && (slash[22] == '\0')) {
-                    static char manager_id[64];
-                    size_t n = (size_t)(slash - p);
-                    if (n >= sizeof(manager_id)) n = sizeof(manager_id) - 1;
-                    strncpy(manager_id, p, n);
-                    manager_id[n] = '\0';
-                    *resource_id = manager_id;
-                    return REDFISH_RESOURCE_MANAGER_RESET_ACTION;
-                }
-            }
+    if (cJSON_IsArray(item) || cJSON_IsObject(item)) {
+        len += 2;
+        for (const cJSON *child = item->child; child; child = child->next) {
+            len += response_json_min_length(child) + (child->next ? 1 : 0);
         }
+    } else if (cJSON_IsString(item) || cJSON_IsRaw(item)) {
+        len += item->valuestring ? strlen(item->valuestring) + 2 : 4;
+    } else if (cJSON_IsNumber(item)) {
+        len += 1;
+    } else {
+        len += 4;
+    }
 
-        if (strlen(path) == 45 && (strncmp(&path[27], "EthernetInterfaces", 18) == 0)) {
-            *resource_id = (char*)(path + 27);
-            return REDFISH_RESOURCE_MANAGERS_ETHERNET_INTERFACE;
-        }
+    return len;
+}
 
-        if ((strlen(path) == 50) && (strncmp(&path[46], "eth0", 4) == 0)) {
-            *resource_id = (char*)(path + 46);
-            return REDFISH_RESOURCE_MANAGERS_ETHERNET_INTERFACE_ETH0;
-        }
+// Serialize compact JSON straight into the response instead of letting
+// cJSON_Print() allocate the text and copying it: most documents fit in
+// body[]; one that cannot is printed into a heap buffer sized from the
+// estimate, which cJSON grows if needed and the response adopts.
+int redfish_response_set_json(http_response_t *response, cJSON *json) {
+    if (!response || !json) return ERROR_INVALID_PARAM;
+
+    free(response->body_ext);
+    response->body_ext = NULL;
+    response->body_ext_size = 0;
+
+    size_t min_length = response_json_min_length(json);
+    if (min_length >= REDFISH_RESPONSE_BODY_MAX) {
+        redfish_response_clear_body(response);
+        return ERROR_MEMORY;
     }
 
-    if (strncmp(path, "redfish/v1/AccountService", 25) == 0) {
-        if (strlen(path) == 25) {
-            return REDFISH_RESOURCE_ACCOUNTSERVICE;
-        }
-        if (path[25] == '/' && strncmp(&path[26], "Accounts", 8) == 0) {
-            if (strlen(path) == 34) {
-                // Collection: /redfish/v1/AccountService/Accounts
-                return REDFISH_RESOURCE_ACCOUNTSERVICE_ACCOUNTS;
-            }
-            if (path[34] == '/') {
-                // Individual account: /redfish/v1/AccountService/Accounts/{id}
-                *resource_id = (char*)(path + 35);
-                return REDFISH_RESOURCE_ACCOUNTSERVICE_ACCOUNT;
-            }
-        }
-        if (path[25] == '/' && strncmp(&path[26], "Roles", 5) == 0) {
-            if (strlen(path) == 31) {
-                return REDFISH_RESOURCE_ACCOUNTSERVICE_ROLES_COLLECTION;
-            }
-            if (path[31] == '/') {
-                *resource_id = (char*)(path + 32);
-                return REDFISH_RESOURCE_ACCOUNTSERVICE_ROLE;
-            }
-        }
+    if (min_length < sizeof(response->body) &&
+        cJSON_PrintPreallocated(json, response->body, (int)sizeof(response->body), false)) {
+        response->content_length = (int)strlen(response->body);
+        return SUCCESS;
     }
 
-    if (strncmp(path, "redfish/v1/SessionService", 25) == 0) {
-        if (strlen(path) == 25) {
-            return REDFISH_RESOURCE_SESSIONSERVICE;
-        }
-        // Check Members alias before general Sessions check
-        if (path[25] == '/' && strncmp(&path[26], "Sessions/Members", 16) == 0) {
-            return REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS_MEMBERS;
-        }
-        if (path[25] == '/' && strncmp(&path[26], "Sessions", 8) == 0) {
-            *resource_id = (char*)(path + 26);
-            return REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS;
-        }
+    char *text = cJSON_PrintBuffered(json, (int)(min_length + min_length / 2 + 64), false);
+    size_t len = text ? strlen(text) : 0;
+    if (!text || len >= REDFISH_RESPONSE_BODY_MAX) {
+        free(text);
+        redfish_response_clear_body(response);
+        return ERROR_MEMORY;
     }
 
-    if (strncmp(path, "redfish/v1/ThermalEquipment", 27) == 0) {
-        if (strlen(path) == 27) {
-            return REDFISH_RESOURCE_THERMALEQUIPMENT_COLLECTION;
-        }
-        if (path[27] == '/') {
-            // Check IOBoard Read action path EARLY to avoid member fallback:
-            // /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/IOBoards/{member}/Actions/Oem/KenmecIOBoard.Read
-            {
-                const char *base = path; // full path
-                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
-                if (strncmp(base, prefix, strlen(prefix)) == 0) {
-                    const char *p = base + strlen(prefix); // points at {cdu}/...
-                    const char *slash = strchr(p, '/');
-                    if (slash) {
-                        size_t id_len = (size_t)(slash - p);
-                        if (id_len > 0 && id_len < 32) {
-                            static char cdu_id[32];
-                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
-                            const char *rest = slash; // starts with "/Oem..."
-                            const char *mid = "/Oem/Kenmec/IOBoards/";
-                            const char *tail = "/Actions/Oem/KenmecIOBoard.Read";
-                            const char *m = strstr(rest, mid);
-                            const char *t = strstr(rest, tail);
-                            if (m == rest && t && t[strlen(tail)] == '\0' && m < t) {
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_READ;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Check IOBoard Write action path EARLY: /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/IOBoards/{member}/Actions/Oem/KenmecIOBoard.Write
-            {
-                const char *base = path;
-                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
-                if (strncmp(base, prefix, strlen(prefix)) == 0) {
-                    const char *p = base + strlen(prefix);
-                    const char *slash = strchr(p, '/');
-                    if (slash) {
-                        size_t id_len = (size_t)(slash - p);
-                        if (id_len > 0 && id_len < 32) {
-                            static char cdu_id[32];
-                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
-                            const char *rest = slash;
-                            const char *mid = "/Oem/Kenmec/IOBoards/";
-                            const char *tail = "/Actions/Oem/KenmecIOBoard.Write";
-                            const char *m = strstr(rest, mid);
-                            const char *t = strstr(rest, tail);
-                            if (m == rest && t && t[strlen(tail)] == '\0' && m < t) {
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_WRITE;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Check exact IOBoards collection path first: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/IOBoards
-            {
-                const char *suffix = "/Oem/Kenmec/IOBoards";
-                char *p = strstr((char*)path + 28, suffix);
-                if (p && p[strlen(suffix)] == '\0') {
-                    char *cdu_path = (char*)(path + 28);
-                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
-                        static char cdu_id[32];
-                        char *slash_pos = strchr(cdu_path + 5, '/');
-                        if (slash_pos) {
-                            size_t len = slash_pos - (cdu_path + 5);
-                            if (len < sizeof(cdu_id)) {
-                                strncpy(cdu_id, cdu_path + 5, len);
-                                cdu_id[len] = '\0';
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_IOBOARDS;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/ControlLogics/{member}/Actions/Oem/ControlLogic.Read
-            {
-                const char *base = path; // full path
-                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
-                // debug(tag, "base: %s, prefix: %s", base, prefix);
-                if (strncmp(base, prefix, strlen(prefix)) == 0) {
-                    // debug(tag, "base: %s, prefix: %s", base, prefix);
-                    const char *p = base + strlen(prefix); // points at {cdu}/...
-                    const char *slash = strchr(p, '/');
-                    if (slash) {
-                        // debug(tag, "slash: %s", slash);
-                        size_t id_len = (size_t)(slash - p);
-                        if (id_len > 0 && id_len < 32) {
-                            static char cdu_id[32];
-                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
-                            const char *rest = slash; // starts with "/Oem..."
-                            const char *mid = "/Oem/Kenmec/ControlLogics/";
-                            const char *tail = "/Actions/Oem/ControlLogic.Read";
-                            const char *m = strstr(rest, mid);
-                            const char *t = strstr(rest, tail);
-                            // debug(tag, "m: %s, t: %s", m, t);
-                            if (m == rest && t && t[strlen(tail)] == '\0' && m < t) {
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_READ;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/ControlLogics/{member}/Actions/Oem/ControlLogic.Write
-            {
-                const char *base = path; // full path
-                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
-                if (strncmp(base, prefix, strlen(prefix)) == 0) {
-                    const char *p = base + strlen(prefix); // points at {cdu}/...
-                    const char *slash = strchr(p, '/');
-                    if (slash) {
-                        size_t id_len = (size_t)(slash - p);
-                        if (id_len > 0 && id_len < 32) {
-                            static char cdu_id[32];
-                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
-                            const char *rest = slash; // starts with "/Oem..."
-                            const char *mid = "/Oem/Kenmec/ControlLogics/";
-                            const char *tail = "/Actions/Oem/ControlLogic.Write";
-                            const char *m = strstr(rest, mid);
-                            const char *t = strstr(rest, tail);
-                            if (m == rest && t && t[strlen(tail)] == '\0' && m < t) {
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_WRITE;
-                            }
-                        }
-                    }
-                }
-            }            
-     
-            // Check ControlLogic member path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/ControlLogics
-            {
-                const char *suffix = "/Oem/Kenmec/ControlLogics";
-                char *p = strstr((char*)path + 28, suffix);
-                if (p && p[strlen(suffix)] == '\0') {
-                    char *cdu_path = (char*)(path + 28);
-                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
-                        static char cdu_id[32];
-                        char *slash_pos = strchr(cdu_path + 5, '/');
-                        if (slash_pos) {
-                            size_t len = slash_pos - (cdu_path + 5);
-                            if (len < sizeof(cdu_id)) {
-                                strncpy(cdu_id, cdu_path + 5, len);
-                                cdu_id[len] = '\0';
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Check ControlLogic member path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/ControlLogics/{member}
-            {
-                const char *anchor = "/Oem/Kenmec/ControlLogics/";
-                char *p = strstr((char*)path + 28, anchor);
-                if (p && p[strlen(anchor)] != '\0') {
-                    // Extract CDU ID
-                    char *cdu_path = (char*)(path + 28);
-                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
-                        static char cdu_id[32];
-                        char *slash_pos = strchr(cdu_path + 5, '/');
-                        if (slash_pos) {
-                            size_t len = slash_pos - (cdu_path + 5);
-                            if (len < sizeof(cdu_id)) {
-                                strncpy(cdu_id, cdu_path + 5, len);
-                                cdu_id[len] = '\0';
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_MEMBER;
-                            }
-                        }
-                    }
-                }
-            }
-     
-            // Check IOBoard member path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/IOBoards/{member}
-            {
-                const char *anchor = "/Oem/Kenmec/IOBoards/";
-                char *p = strstr((char*)path + 28, anchor);
-                if (p && p[strlen(anchor)] != '\0') {
-                    // Extract CDU ID
-                    char *cdu_path = (char*)(path + 28);
-                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
-                        static char cdu_id[32];
-                        char *slash_pos = strchr(cdu_path + 5, '/');
-                        if (slash_pos) {
-                            size_t len = slash_pos - (cdu_path + 5);
-                            if (len < sizeof(cdu_id)) {
-                                strncpy(cdu_id, cdu_path + 5, len);
-                                cdu_id[len] = '\0';
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_IOBOARD_MEMBER;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Check path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/Config.Read
-            {
-                const char *anchor = "/Oem/Kenmec/Config.Read";
-                char *p = strstr((char*)path + 28, anchor);
-                if (p && p[strlen(anchor)] == '\0') {
-                    // Extract CDU ID
-                    char *cdu_path = (char*)(path + 28);
-                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
-                        static char cdu_id[32];
-                        char *slash_pos = strchr(cdu_path + 5, '/');
-                        if (slash_pos) {
-                            size_t len = slash_pos - (cdu_path + 5);
-                            if (len < sizeof(cdu_id)) {
-                                strncpy(cdu_id, cdu_path + 5, len);
-                                cdu_id[len] = '\0';
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_READ;
-                            }
-                        }
-                    }
-                }
-            }
+    response->body_ext = text;
+    response->body_ext_size = len + 1;
+    response->content_length = (int)len;
 
-            // Check path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/Config.Write
-            {
-                const char *anchor = "/Oem/Kenmec/Config.Write";
-                char *p = strstr((char*)path + 28, anchor);
-                if (p && p[strlen(anchor)] == '\0') {
-                    // Extract CDU ID
-                    char *cdu_path = (char*)(path + 28);
-                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
-                        static char cdu_id[32];
-                        char *slash_pos = strchr(cdu_path + 5, '/');
-                        if (slash_pos) {
-                            size_t len = slash_pos - (cdu_path + 5);
-                            if (len < sizeof(cdu_id)) {
-                                strncpy(cdu_id, cdu_path + 5, len);
-                                cdu_id[len] = '\0';
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_WRITE;
-                            }
-                        }
-                    }
-                }
-            }            
-
-            // Check exact Kenmec OEM container path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec
-            {
-                const char *suffix = "/Oem/Kenmec";
-                char *p = strstr((char*)path + 28, suffix);
-                if (p && p[strlen(suffix)] == '\0') {
-                    char *cdu_path = (char*)(path + 28);
-                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
-                        static char cdu_id[32];
-                        char *slash_pos = strchr(cdu_path + 5, '/');
-                        if (slash_pos) {
-                            size_t len = slash_pos - (cdu_path + 5);
-                            if (len < sizeof(cdu_id)) {
-                                strncpy(cdu_id, cdu_path + 5, len);
-                                cdu_id[len] = '\0';
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM_KENMEC;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Check IOBoard Read action path: /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/IOBoards/{member}/Actions/Oem/KenmecIOBoard.Read
-            {
-                const char *base = path; // full path
-                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
-                if (strncmp(base, prefix, strlen(prefix)) == 0) {
-                    const char *p = base + strlen(prefix); // points at {cdu}/...
-                    const char *slash = strchr(p, '/');
-                    if (slash) {
-                        size_t id_len = (size_t)(slash - p);
-                        if (id_len > 0 && id_len < 32) {
-                            static char cdu_id[32];
-                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
-                            const char *rest = slash;
-                            const char *expected_tail = "/Oem/Kenmec/IOBoards/";
-                            const char *t = strstr(rest, expected_tail);
-                            if (t == rest && strstr(rest, "/Actions/Oem/KenmecIOBoard.Read") != NULL) {
-                                const char *action_tail = "/Actions/Oem/KenmecIOBoard.Read";
-                                const char *end = strstr(rest, action_tail);
-                                if (end && end[strlen(action_tail)] == '\0') {
-                                    *resource_id = cdu_id;
-                                    return REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_READ;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Check exact OEM container path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem
-            {
-                const char *suffix = "/Oem";
-                char *p = strstr((char*)path + 28, suffix);
-                if (p && p[strlen(suffix)] == '\0') {
-                    char *cdu_path = (char*)(path + 28); // "CDUs/1/Oem"
-                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
-                        static char cdu_id[32];
-                        char *slash_pos = strchr(cdu_path + 5, '/');
-                        if (slash_pos) {
-                            size_t len = slash_pos - (cdu_path + 5);
-                            if (len < sizeof(cdu_id)) {
-                                strncpy(cdu_id, cdu_path + 5, len);
-                                cdu_id[len] = '\0';
-                                *resource_id = cdu_id;
-                                return REDFISH_RESOURCE_CDU_OEM;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Fallback: treat the remainder after /redfish/v1/ThermalEquipment/ as thermal equipment identifier
-            *resource_id = (char*)(path + 28);
-            return REDFISH_RESOURCE_THERMALEQUIPMENT;
-        }
-    }
-
-    return REDFISH_RESOURCE_UNKNOWN;
+    return SUCCESS;
 }
 
 const char* get_http_status_text(int status_code) {
@@ -1613,6 +1232,7 @@ const char* get_http_status_text(int status_code) {
         case HTTP_ACCEPTED: return "Accepted";
         case HTTP_CREATED: return "Created";
         case HTTP_NO_CONTENT: return "No Content";
+        case HTTP_NOT_MODIFIED: return "Not Modified";
         case HTTP_TEMPORARY_REDIRECT: return "Temporary Redirect";
         case HTTP_BAD_REQUEST: return "Bad Request";
         case HTTP_UNAUTHORIZED: return "Unauthorized";
@@ -1622,6 +1242,7 @@ const char* get_http_status_text(int status_code) {
         case HTTP_PRECONDITION_FAILED: return "Precondition Failed";
         case HTTP_INTERNAL_SERVER_ERROR: return "Internal Server Error";
         case HTTP_NOT_IMPLEMENTED: return "Not Implemented";
+        case HTTP_SERVICE_UNAVAILABLE: return "Service Unavailable";
         default: return "Unknown";
     }
 }
@@ -1734,6 +1355,21 @@ void http_server_cleanup(void) {
     }
 }
 
+static int http_send_all(int client_fd, const char *data, size_t len) {
+    size_t total_sent = 0;
+
+    while (total_sent < len) {
+        int bytes_to_send = (len - total_sent > 4096) ? 4096 : (int)(len - total_sent);
+        int bytes_sent = send(client_fd, data + total_sent, bytes_to_send, 0);
+        if (bytes_sent < 0) {
+            return ERROR_NETWORK;
+        }
+        total_sent += bytes_sent;
+    }
+
+    return SUCCESS;
+}
+
 int handle_http_client_connection(int client_fd) {
     char request_buffer[BUFFER_SIZE];
     char response_buffer[BUFFER_SIZE];
@@ -1868,34 +1504,18 @@ int handle_http_client_connection(int client_fd) {
         return ret;
     }
 
-    // Generate HTTP response
-    generate_http_response(&response, response_buffer, sizeof(response_buffer));
-
-    debug(tag, "Sending HTTP response:\n%s\n", response_buffer);
-
-    // Send response to client
-    // Send response to client with proper size handling
-    size_t response_len = strlen(response_buffer);
-    size_t total_sent = 0;
-    
-    while (total_sent < response_len) {
-        int bytes_to_send = (response_len - total_sent > 4096) ? 4096 : (int)(response_len - total_sent);
-        int bytes_sent = send(client_fd, response_buffer + total_sent, bytes_to_send, 0);
-        
-        if (bytes_sent < 0) {
-            error(tag, "Failed to send HTTP response to client");
-            close(client_fd);
-            return ERROR_NETWORK;
-        }
-        
-        total_sent += bytes_sent;
+    // Send the head, then the body straight from the response
+    int head_len = generate_http_response_head(&response, 0, response_buffer, sizeof(response_buffer));
+    if (head_len < 0 ||
+        http_send_all(client_fd, response_buffer, (size_t)head_len) != SUCCESS ||
+        http_send_all(client_fd, redfish_response_body(&response), (size_t)response.content_length) != SUCCESS) {
+        error(tag, "Failed to send HTTP response to client");
+        redfish_response_clear_body(&response);
+        close(client_fd);
+        return ERROR_NETWORK;
     }
-    // int bytes_written = send(client_fd, response_buffer, strlen(response_buffer), 0);
-    // if (bytes_written < 0) {
-    //     printf("Failed to write HTTP response to client\n");
-    //     close(client_fd);
-    //     return ERROR_NETWORK;
-    // } 
+    size_t total_sent = (size_t)head_len + (size_t)response.content_length;
+    redfish_response_clear_body(&response);
 
     debug(tag, "Successfully sent %zu bytes to client", total_sent);
 
@@ -4,6 +4,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "config.h"
 #include "redfish_client_info_handle.h"
@@ -15,8 +16,79 @@ int handle_client_connection(int client_fd);
 // Global TLS server context
 static tls_server_context_t g_tls_ctx;
 
+// Preferred cipher suites, strongest/fastest first. The server certificate
+// is EC P-384, so only ECDSA-authenticated suites can be negotiated.
+// Forward-secret AEAD suites avoid the CBC+HMAC record cost; the CBC suite
+// stays at the end for older Redfish clients. Suites not compiled into
+// mbedTLS are skipped during the handshake. No DHE suites: they need DH
+// parameters, and a finite-field exchange costs far more than ECDHE on this
+// CPU.
+static const int _tls_ciphersuites[] = {
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_CBC_SHA,
+    0
+};
+
+// HTTPS connections are served by several worker threads. The DRBG, the
+// session cache and the ticket keys are shared through the SSL config and
+// are not thread safe unless mbedTLS was built with MBEDTLS_THREADING_C, so
+// serialize them here.
+static pthread_mutex_t _tls_rng_mutex = PTHREAD_MUTEX_INITIALIZER;
+#if defined(MBEDTLS_SSL_CACHE_C)
+static pthread_mutex_t _tls_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+static pthread_mutex_t _tls_ticket_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static int _tls_rng(void *p_rng, unsigned char *output, size_t output_len) {
+    pthread_mutex_lock(&_tls_rng_mutex);
+    int ret = mbedtls_ctr_drbg_random(p_rng, output, output_len);
+    pthread_mutex_unlock(&_tls_rng_mutex);
+    return ret;
+}
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+static int _tls_cache_get(void *data, mbedtls_ssl_session *session) {
+    pthread_mutex_lock(&_tls_cache_mutex);
+    int ret = mbedtls_ssl_cache_get(data, session);
+    pthread_mutex_unlock(&_tls_cache_mutex);
+    return ret;
+}
+
+static int _tls_cache_set(void *data, const mbedtls_ssl_session *session) {
+    pthread_mutex_lock(&_tls_cache_mutex);
+    int ret = mbedtls_ssl_cache_set(data, session);
+    pthread_mutex_unlock(&_tls_cache_mutex);
+    return ret;
+}
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+// Writing a ticket may rotate the ticket keys, parsing reads them
+static int _tls_ticket_write(void *p_ticket, const mbedtls_ssl_session *session,
+                             unsigned char *start, const unsigned char *end,
+                             size_t *tlen, uint32_t *lifetime) {
+    pthread_mutex_lock(&_tls_ticket_mutex);
+    int ret = mbedtls_ssl_ticket_write(p_ticket, session, start, end, tlen, lifetime);
+    pthread_mutex_unlock(&_tls_ticket_mutex);
+    return ret;
+}
+
+static int _tls_ticket_parse(void *p_ticket, mbedtls_ssl_session *session,
+                             unsigned char *buf, size_t len) {
+    pthread_mutex_lock(&_tls_ticket_mutex);
+    int ret = mbedtls_ssl_ticket_parse(p_ticket, session, buf, len);
+    pthread_mutex_unlock(&_tls_ticket_mutex);
+    return ret;
+}
+#endif
+
 const char* tls_error_string(int error_code) {
-    static char error_buffer[256];
+    // Per-thread buffer: HTTPS connections are served by several workers
+    static __thread char error_buffer[256];
     mbedtls_strerror(error_code, error_buffer, sizeof(error_buffer));
     return error_buffer;
 }
@@ -36,6 +108,12 @@ int tls_server_init(tls_server_context_t *ctx, const char *cert_file, const char
     mbedtls_pk_init(&ctx->pkey);
     mbedtls_entropy_init(&ctx->entropy);
     mbedtls_ctr_drbg_init(&ctx->ctr_drbg);
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_init(&ctx->cache);
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_init(&ctx->ticket);
+#endif
 
     // Seed the random number generator
     ret = mbedtls_ctr_drbg_seed(&ctx->ctr_drbg, mbedtls_entropy_func, &ctx->entropy,
@@ -165,10 +243,29 @@ int tls_server_init(tls_server_context_t *ctx, const char *cert_file, const char
     }
 
     // Set random number generator
-    mbedtls_ssl_conf_rng(&ctx->conf, mbedtls_ctr_drbg_random, &ctx->ctr_drbg);
+    mbedtls_ssl_conf_rng(&ctx->conf, _tls_rng, &ctx->ctr_drbg);
 
     // Set cipher suites
-    mbedtls_ssl_conf_ciphersuites(&ctx->conf, mbedtls_ssl_list_ciphersuites());
+    mbedtls_ssl_conf_ciphersuites(&ctx->conf, _tls_ciphersuites);
+
+    // Session resumption: returning clients skip the key exchange and
+    // certificate verification. Session-ID cache for clients without ticket
+    // support, stateless tickets for the rest.
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_set_timeout(&ctx->cache, TLS_SESSION_CACHE_TIMEOUT_S);
+    mbedtls_ssl_cache_set_max_entries(&ctx->cache, TLS_SESSION_CACHE_MAX_ENTRIES);
+    mbedtls_ssl_conf_session_cache(&ctx->conf, &ctx->cache, _tls_cache_get, _tls_cache_set);
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+    ret = mbedtls_ssl_ticket_setup(&ctx->ticket, _tls_rng, &ctx->ctr_drbg,
+                                   MBEDTLS_CIPHER_AES_256_GCM, TLS_SESSION_TICKET_LIFETIME_S);
+    if (ret != 0) {
+        printf("Failed to setup session tickets: %s\n", tls_error_string(ret));
+    } else {
+        mbedtls_ssl_conf_session_tickets_cb(&ctx->conf, _tls_ticket_write,
+                                            _tls_ticket_parse, &ctx->ticket);
+    }
+#endif
 
     // Set minimum TLS version
     mbedtls_ssl_conf_min_version(&ctx->conf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_2);
@@ -231,6 +328,12 @@ void tls_server_cleanup(tls_server_context_t *ctx) {
     mbedtls_pk_free(&ctx->pkey);
     mbedtls_entropy_free(&ctx->entropy);
     mbedtls_ctr_drbg_free(&ctx->ctr_drbg);
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_free(&ctx->cache);
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_free(&ctx->ticket);
+#endif
 
     ctx->initialized = false;
 }
@@ -273,8 +376,7 @@ int tls_server_accept_client(tls_server_context_t *ctx, int *client_fd) {
 }
 
 
-int tls_server_establish_ssl(tls_server_context_t *ctx, int client_fd, mbedtls_ssl_context *ssl, mbedtls_net_context *client_net_ctx) {
-    (void)client_fd;
+int tls_server_setup_ssl(tls_server_context_t *ctx, mbedtls_ssl_context *ssl, mbedtls_net_context *client_net_ctx) {
     int ret;
 
     // Initialize SSL context for this connection
@@ -287,9 +389,22 @@ int tls_server_establish_ssl(tls_server_context_t *ctx, int client_fd, mbedtls_s
         return ERROR_TLS;
     }
 
-    // Set the underlying socket using proper mbedTLS BIO functions
+    // Set the underlying socket using proper mbedTLS BIO functions.
+    // mbedtls_net_recv/send report WANT_READ/WANT_WRITE on non-blocking sockets.
     mbedtls_ssl_set_bio(ssl, client_net_ctx, mbedtls_net_send, mbedtls_net_recv, NULL);
 
+    return SUCCESS;
+}
+
+int tls_server_establish_ssl(tls_server_context_t *ctx, int client_fd, mbedtls_ssl_context *ssl, mbedtls_net_context *client_net_ctx) {
+    (void)client_fd;
+    int ret;
+
+    ret = tls_server_setup_ssl(ctx, ssl, client_net_ctx);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+
     // Perform SSL handshake
     ret = mbedtls_ssl_handshake(ssl);
     if (ret != 0) {
@@ -297,7 +412,8 @@ int tls_server_establish_ssl(tls_server_context_t *ctx, int client_fd, mbedtls_s
         return ERROR_TLS;
     }
 
-    printf("SSL handshake completed successfully\n");
+    printf("SSL handshake completed successfully (%s, %s)\n",
+           mbedtls_ssl_get_version(ssl), mbedtls_ssl_get_ciphersuite(ssl));
     return SUCCESS;
 }
 
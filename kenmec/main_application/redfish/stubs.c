@@ -63,8 +63,9 @@ int net_mac_get(const char* iface, unsigned char* mac) {
     return 0;
 }
 
-int net_config_is_dhcp(void) {
-    return 1; // Assume DHCP
+int net_config_is_dhcp(unsigned char* is_dhcp) {
+    *is_dhcp = 1; // Assume DHCP
+    return 0;
 }
 
 int net_ethernet_config_restart(void) {
@@ -72,7 +73,7 @@ int net_ethernet_config_restart(void) {
 }
 
 // Time utilities
-void time_get_current_date_string_r(char* buffer, size_t size) {
+char* time_get_current_date_string_r(char* buffer, size_t size) {
     time_t rawtime;
     struct tm* timeinfo;
     
@@ -80,6 +81,7 @@ void time_get_current_date_string_r(char* buffer, size_t size) {
     timeinfo = localtime(&rawtime);
     
     strftime(buffer, size, "%Y-%m-%d %H:%M:%S", timeinfo);
+    return buffer;
 }
 
 // mDNS service stubs
@@ -0,0 +1,225 @@
+// Host replacements for the control-logic entry points the Redfish handlers
+// call. The tests link this file instead of src/dummy/dummy_control_logic.c.
+// Every configuration table is empty, every query (sensor history included)
+// finds nothing and latency samples are dropped.
+// The Modbus table is a plain array with per-register generations, written
+// by the tests through fake_modbus_table_set().
+
+#include <string.h>
+
+#include "dexatek/main_application/include/application_common.h"
+#include "kenmec/main_application/control_logic/control_logic_manager.h"
+#include "kenmec/main_application/control_logic/control_hardware.h"
+#include "kenmec/main_application/control_logic/control_logic_update.h"
+#include "kenmec/main_application/control_logic/control_logic_history.h"
+#include "kenmec/main_application/control_logic/control_logic_latency.h"
+
+#include "fake_control_logic.h"
+
+/*
+ * control_logic_config
+ */
+void control_logic_config_read_lock(void)
+{
+}
+
+void control_logic_config_read_unlock(void)
+{
+}
+
+system_config_t* control_logic_system_configs_get(void)
+{
+    static system_config_t config;
+
+    return &config;
+}
+
+int control_logic_system_configs_set(const char *json_string)
+{
+    return SUCCESS;
+}
+
+temperature_config_t* control_logic_temperature_configs_get(int *config_count)
+{
+    *config_count = 0;
+    return NULL;
+}
+
+int control_logic_temperature_configs_set(const char *json_string)
+{
+    return SUCCESS;
+}
+
+modbus_device_config_t* control_logic_modbus_device_configs_get(int *config_count)
+{
+    *config_count = 0;
+    return NULL;
+}
+
+int control_logic_modbus_device_configs_set(const char *json_string)
+{
+    return SUCCESS;
+}
+
+analog_config_t* control_logic_analog_input_current_configs_get(int *config_count)
+{
+    *config_count = 0;
+    return NULL;
+}
+
+int control_logic_analog_input_current_configs_set(const char *json_string)
+{
+    return SUCCESS;
+}
+
+analog_config_t* control_logic_analog_input_voltage_configs_get(int *config_count)
+{
+    *config_count = 0;
+    return NULL;
+}
+
+int control_logic_analog_input_voltage_configs_set(const char *json_string)
+{
+    return SUCCESS;
+}
+
+analog_config_t* control_logic_analog_output_current_configs_get(int *config_count)
+{
+    *config_count = 0;
+    return NULL;
+}
+
+int control_logic_analog_output_current_configs_set(const char *json_string)
+{
+    return SUCCESS;
+}
+
+analog_config_t* control_logic_analog_output_voltage_configs_get(int *config_count)
+{
+    *config_count = 0;
+    return NULL;
+}
+
+int control_logic_analog_output_voltage_configs_set(const char *json_string)
+{
+    return SUCCESS;
+}
+
+/*
+ * control_logic_common
+ */
+int control_logic_api_data_append_to_json(uint8_t logic_id, cJSON *json_root)
+{
+    return SUCCESS;
+}
+
+int control_logic_api_write_by_json(uint8_t logic_id, const char *jsonPayload, uint16_t timeout_ms)
+{
+    return SUCCESS;
+}
+
+/*
+ * control_logic_manager
+ */
+int control_logic_manager_number_of_control_logics(void)
+{
+    return 0;
+}
+
+/*
+ * control_hardware
+ */
+int control_hardware_temperature_all_get_from_ram(uint8_t hid_port, int32_t temperature[8])
+{
+    memset(temperature, 0, sizeof(int32_t) * 8);
+    return SUCCESS;
+}
+
+/*
+ * control_logic_update
+ */
+#define FAKE_MODBUS_TABLE_SIZE 20000
+
+static uint16_t _fake_table[FAKE_MODBUS_TABLE_SIZE];
+static uint32_t _fake_table_gen[FAKE_MODBUS_TABLE_SIZE];
+static uint32_t _fake_generation;
+
+void fake_modbus_table_set(uint16_t address, uint16_t value)
+{
+    if (address >= FAKE_MODBUS_TABLE_SIZE || _fake_table[address] == value) {
+        return;
+    }
+    _fake_table[address] = value;
+    _fake_table_gen[address] = ++_fake_generation;
+}
+
+uint32_t control_logic_modbus_table_generation(void)
+{
+    return _fake_generation;
+}
+
+int control_logic_modbus_table_changes(uint32_t since, uint32_t *generation, uint16_t *addresses, uint16_t *words, int max)
+{
+    int count = 0;
+    // like the real table: a fresh or restarted subscriber gets every register
+    bool full = (since == 0 || since > _fake_generation);
+
+    for (int i = 0; i < FAKE_MODBUS_TABLE_SIZE && count < max; i++) {
+        if (full || _fake_table_gen[i] > since) {
+            addresses[count] = (uint16_t)i;
+            words[count] = _fake_table[i];
+            count++;
+        }
+    }
+    *generation = _fake_generation;
+
+    return count;
+}
+
+/*
+ * control_logic_history
+ */
+int control_logic_history_channels_get(uint16_t *addresses, int max)
+{
+    (void)addresses;
+    (void)max;
+    return 0;
+}
+
+int control_logic_history_query(uint16_t address, uint64_t from_ms, uint32_t step_ms,
+                                control_logic_history_point_t *points, int point_num)
+{
+    (void)address;
+    (void)from_ms;
+    (void)step_ms;
+    (void)points;
+    (void)point_num;
+    return FAIL;
+}
+
+/*
+ * control_logic_latency
+ */
+uint64_t control_logic_latency_start(void)
+{
+    return 0;
+}
+
+void control_logic_latency_record(control_logic_latency_metric_t metric, uint64_t start_ns)
+{
+    (void)metric;
+    (void)start_ns;
+}
+
+int control_logic_latency_summary_get(control_logic_latency_metric_t metric, control_logic_latency_summary_t *summary)
+{
+    (void)metric;
+    memset(summary, 0, sizeof(*summary));
+    return SUCCESS;
+}
+
+const char *control_logic_latency_name(control_logic_latency_metric_t metric)
+{
+    (void)metric;
+    return "fake";
+}
@@ -0,0 +1,12 @@
+// Test hooks of the control-logic fake (fake_control_logic.c)
+
+#ifndef FAKE_CONTROL_LOGIC_H
+#define FAKE_CONTROL_LOGIC_H
+
+#include <stdint.h>
+
+// Store a register of the fake Modbus table; a changed value bumps the
+// table generation like control_logic_update_to_modbus_table() does.
+void fake_modbus_table_set(uint16_t address, uint16_t value);
+
+#endif /* FAKE_CONTROL_LOGIC_H */
@@ -0,0 +1,24 @@
+// Host replacements for the platform functions ../stubs.c does not provide
+
+#include <time.h>
+
+#include "fake_platform.h"
+
+int test_failures = 0;
+
+/*
+ * os_utilities
+ */
+uint64_t time_get_current_ms(void)
+{
+    return fake_now_ns() / 1000000ULL;
+}
+
+uint64_t fake_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,31 @@
+// Host replacements for the platform functions ../stubs.c does not provide
+
+#ifndef FAKE_PLATFORM_H
+#define FAKE_PLATFORM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Monotonic clock for measurements
+uint64_t fake_now_ns(void);
+
+// Minimal assertion helpers shared by the tests
+extern int test_failures;
+
+#define TEST_CHECK(cond, ...)                                   \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);                       \
+            fprintf(stderr, "\n");                              \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+// Results go to stderr so they stay readable next to the server log on stdout
+#define TEST_REPORT(...) fprintf(stderr, __VA_ARGS__)
+
+#define TEST_RESULT()                                                                   \
+    (test_failures == 0 ? (TEST_REPORT("PASS\n"), 0) : (TEST_REPORT("FAIL (%d)\n", test_failures), 1))
+
+#endif /* FAKE_PLATFORM_H */
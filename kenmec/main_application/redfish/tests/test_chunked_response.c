@@ -0,0 +1,165 @@
+// Chunked responses: documents of sizes around the chunk and write-batch
+// boundaries are sent by _http_send_response() over a socket pair, read back
+// with the loadgen's response parser and compared byte for byte with the
+// document. A Content-Length response and malformed chunk framing go
+// through the same parser. Throughput of the chunked path is reported.
+
+#include "../src/redfish_http_server.c"
+
+#define main loadgen_main
+#include "../loadgen.c"
+#undef main
+
+#include "fake_platform.h"
+
+#define DOCUMENT_MAX (HTTP_CHUNK_SIZE * HTTP_CHUNKS_PER_WRITE * 3 + 123)
+#define READ_BUFFER_SIZE 65536
+#define BENCH_ROUNDS 200
+
+typedef struct {
+    int fd;
+    loadgen_body_t body;
+    int keep_alive;
+} reader_t;
+
+static http_worker_t _worker;
+static char _document[DOCUMENT_MAX];
+static char _received[DOCUMENT_MAX];
+
+static void *_reader_thread(void *arg)
+{
+    reader_t *reader = (reader_t *)arg;
+    char *buffer = malloc(READ_BUFFER_SIZE);
+
+    reader->keep_alive = _response_read(reader->fd, buffer, READ_BUFFER_SIZE, &reader->body);
+    free(buffer);
+
+    return NULL;
+}
+
+// Send document[0, len) as the server does and read it back with the loadgen
+static int _round_trip(size_t len, bool allow_chunked, size_t *received_len)
+{
+    int fds[2];
+    pthread_t reader_handle;
+    reader_t reader = { .body = { .data = _received, .size = sizeof(_received) } };
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        return -1;
+    }
+    _socket_set_nonblocking(fds[0]);
+    http_conn_t *conn = _http_conn_create(fds[0], 0);
+
+    reader.fd = fds[1];
+    pthread_create(&reader_handle, NULL, _reader_thread, &reader);
+
+    http_response_t *response = &_worker.response;
+    memset(response, 0, sizeof(*response));
+    response->status_code = HTTP_OK;
+    response->body_ext = _document;
+    response->content_length = (int)len;
+    int ret = _http_send_response(conn, &_worker, response, allow_chunked);
+
+    pthread_join(reader_handle, NULL);
+    _http_conn_destroy(conn);
+    close(fds[1]);
+
+    *received_len = reader.body.len;
+
+    return (ret == SUCCESS) ? reader.keep_alive : -1;
+}
+
+static void _test_round_trip(void)
+{
+    size_t sizes[] = {
+        HTTP_CHUNKED_THRESHOLD + 1,
+        HTTP_CHUNK_SIZE * 2 - 1,
+        HTTP_CHUNK_SIZE * 2,
+        HTTP_CHUNK_SIZE * 2 + 1,
+        HTTP_CHUNK_SIZE * HTTP_CHUNKS_PER_WRITE,
+        HTTP_CHUNK_SIZE * HTTP_CHUNKS_PER_WRITE + 1,
+        DOCUMENT_MAX,
+    };
+
+    // JSON-like text with no repeating period that lines up with a chunk
+    for (size_t i = 0; i < DOCUMENT_MAX; i++) {
+        _document[i] = (char)(' ' + (i * 7 + i / 251) % 95);
+    }
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t received = 0;
+        int keep_alive = _round_trip(sizes[i], true, &received);
+
+        TEST_CHECK(keep_alive == 1, "%zu bytes chunked: read returned %d", sizes[i], keep_alive);
+        TEST_CHECK(received == sizes[i] && memcmp(_received, _document, sizes[i]) == 0,
+                   "%zu bytes chunked: %zu bytes reassembled, differs", sizes[i], received);
+    }
+
+    // the same document with Content-Length
+    size_t received = 0;
+    int keep_alive = _round_trip(DOCUMENT_MAX, false, &received);
+    TEST_CHECK(keep_alive == 1 && received == DOCUMENT_MAX && memcmp(_received, _document, DOCUMENT_MAX) == 0,
+               "Content-Length: %d, %zu bytes", keep_alive, received);
+}
+
+// Parse a canned response written to a socket pair
+static int _parse(const char *wire, size_t *received_len)
+{
+    int fds[2];
+    char buffer[1024];
+    loadgen_body_t body = { .data = _received, .size = sizeof(_received) };
+
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    send(fds[0], wire, strlen(wire), 0);
+    close(fds[0]);
+    int ret = _response_read(fds[1], buffer, sizeof(buffer), &body);
+    close(fds[1]);
+    *received_len = body.len;
+
+    return ret;
+}
+
+static void _test_framing(void)
+{
+    size_t received = 0;
+
+    // extensions and trailer fields are skipped, Connection: close is reported
+    int ret = _parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n"
+                     "5;ext=1\r\nhello\r\n1\r\n \r\n5\r\nworld\r\n0\r\nX-Trailer: 1\r\n\r\n",
+                     &received);
+    TEST_CHECK(ret == 0 && received == 11 && memcmp(_received, "hello world", 11) == 0, "extensions: %d, %.*s", ret,
+               (int)received, _received);
+
+    // malformed framing is an error, not a short body
+    TEST_CHECK(_parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\nhello\r\n0\r\n\r\n", &received) < 0,
+               "bad chunk size accepted");
+    TEST_CHECK(_parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhelloX\r\n0\r\n\r\n", &received) < 0,
+               "missing CRLF after chunk data accepted");
+    TEST_CHECK(_parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n", &received) < 0,
+               "missing last chunk accepted");
+}
+
+static void _bench(void)
+{
+    size_t received = 0;
+    int failed = 0;
+    uint64_t start = fake_now_ns();
+
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        failed += (_round_trip(DOCUMENT_MAX, true, &received) != 1 || received != DOCUMENT_MAX);
+    }
+    double seconds = (double)(fake_now_ns() - start) / 1e9;
+    TEST_CHECK(failed == 0, "%d of %d bench round trips failed", failed, BENCH_ROUNDS);
+
+    TEST_REPORT("bench: %d byte document chunked over a socket pair: %.0f MB/s\n", DOCUMENT_MAX,
+                (double)DOCUMENT_MAX * BENCH_ROUNDS / seconds / 1e6);
+}
+
+int main(void)
+{
+    _test_round_trip();
+    _test_framing();
+    _bench();
+
+    return TEST_RESULT();
+}
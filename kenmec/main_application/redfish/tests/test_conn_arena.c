@@ -0,0 +1,215 @@
+// Connection arena: the arena starts with a 4 KB block, doubles per block up
+// to its limit and forgets everything in O(1) between keep-alive requests.
+// Then the server is run on a loopback port and 64 keep-alive clients, the
+// most the loadgen runs by default, GET /redfish as fast as they can;
+// requests per second, the process RSS and the receive buffer per connection
+// are reported next to the fixed BUFFER_SIZE array every connection carried
+// before. Stopping the server returns only after its workers are joined.
+
+#include "../src/redfish_http_server.c"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "fake_platform.h"
+#include "redfish_router.h"
+
+#define CLIENT_NUM 64
+#define REQUESTS_PER_CLIENT HTTP_KEEPALIVE_MAX_REQUESTS   // the server closes after that many
+#define RESET_NUM 1000000
+
+static int _port;
+static volatile int _client_errors;
+
+static void _test_arena(void)
+{
+    redfish_arena_t arena;
+    redfish_arena_init(&arena, HTTP_CONN_ARENA_INITIAL_SIZE, 64 * 1024);
+
+    char *a = redfish_arena_alloc(&arena, 100);
+    TEST_CHECK(a != NULL && arena.total == HTTP_CONN_ARENA_INITIAL_SIZE, "first block %zu bytes", arena.total);
+    TEST_CHECK(((uintptr_t)a % REDFISH_ARENA_ALIGN) == 0, "allocation not aligned");
+
+    // the most recent allocation grows in place while its block has room
+    memset(a, 'x', 100);
+    char *b = redfish_arena_grow(&arena, a, 100, 2048);
+    TEST_CHECK(b == a && arena.total == HTTP_CONN_ARENA_INITIAL_SIZE, "grow within the block moved");
+
+    // past the block it moves to a block twice the size, data kept
+    char *c = redfish_arena_grow(&arena, b, 2048, 6000);
+    TEST_CHECK(c != NULL && c != b && c[0] == 'x' && c[99] == 'x', "grow across blocks lost data");
+    TEST_CHECK(arena.total == 3 * HTTP_CONN_ARENA_INITIAL_SIZE, "second block: %zu bytes total", arena.total);
+
+    // a block is doubled until the allocation fits: 8 KB -> 32 KB
+    TEST_CHECK(redfish_arena_alloc(&arena, 20000) != NULL && arena.total == 11 * HTTP_CONN_ARENA_INITIAL_SIZE,
+               "third block: %zu bytes total", arena.total);
+    TEST_CHECK(redfish_arena_alloc(&arena, 64 * 1024) == NULL, "allocation over the limit succeeded");
+
+    // reset keeps the blocks: the same sizes are served again without malloc
+    size_t total = arena.total;
+    redfish_arena_reset(&arena);
+    char *d = redfish_arena_alloc(&arena, 100);
+    TEST_CHECK(d == a, "reset did not start over at the first block");
+    TEST_CHECK(redfish_arena_alloc(&arena, 6000) != NULL && redfish_arena_alloc(&arena, 20000) != NULL &&
+               arena.total == total, "blocks not reused after reset");
+
+    uint64_t start = fake_now_ns();
+    for (int i = 0; i < RESET_NUM; i++) {
+        redfish_arena_alloc(&arena, 20000);
+        redfish_arena_reset(&arena);
+    }
+    double reset_ns = (double)(fake_now_ns() - start) / RESET_NUM;
+    TEST_REPORT("arena: alloc + reset %.1f ns, %zu bytes in blocks\n", reset_ns, arena.total);
+
+    redfish_arena_release(&arena);
+    TEST_CHECK(arena.first == NULL && arena.total == 0, "release kept blocks");
+}
+
+static long _rss_kb(void)
+{
+    char line[256];
+    long rss = -1;
+    FILE *fp = fopen("/proc/self/status", "r");
+
+    if (!fp) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "VmRSS:", 6) == 0) {
+            rss = strtol(line + 6, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+
+    return rss;
+}
+
+static void *_server_thread(void *arg)
+{
+    int fd = *(int *)arg;
+
+    redfish_http_server_run(fd, -1, NULL, HTTP_WORKER_NUM);
+
+    return NULL;
+}
+
+// Read one response: head up to the blank line, then Content-Length bytes.
+static int _read_response(int fd, char *buf, size_t size)
+{
+    size_t len = 0;
+    char *head_end = NULL;
+
+    while (!head_end) {
+        ssize_t n = recv(fd, buf + len, size - 1 - len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        len += (size_t)n;
+        buf[len] = '\0';
+        head_end = strstr(buf, "\r\n\r\n");
+    }
+
+    const char *cl = strstr(buf, "Content-Length:");
+    size_t body_len = cl ? (size_t)strtol(cl + 15, NULL, 10) : 0;
+    size_t total = (size_t)(head_end + 4 - buf) + body_len;
+    while (len < total) {
+        ssize_t n = recv(fd, buf + len, size - 1 - len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        len += (size_t)n;
+    }
+
+    return strncmp(buf, "HTTP/1.1 200", 12) == 0 ? 0 : -1;
+}
+
+static void *_client_thread(void *arg)
+{
+    static const char request[] = "GET /redfish HTTP/1.1\r\nHost: 127.0.0.1\r\nAccept: application/json\r\n"
+                                  "User-Agent: test_conn_arena\r\nConnection: keep-alive\r\n\r\n";
+    char response[16384];
+    struct sockaddr_in addr;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        __sync_fetch_and_add(&_client_errors, 1);
+        return NULL;
+    }
+
+    for (int i = 0; i < REQUESTS_PER_CLIENT; i++) {
+        if (send(fd, request, sizeof(request) - 1, MSG_NOSIGNAL) != (ssize_t)(sizeof(request) - 1) ||
+            _read_response(fd, response, sizeof(response)) != 0) {
+            __sync_fetch_and_add(&_client_errors, 1);
+            break;
+        }
+    }
+    close(fd);
+
+    return NULL;
+}
+
+static void _test_keepalive_load(void)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int one = 1;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, CLIENT_NUM) != 0) {
+        TEST_CHECK(0, "cannot listen on loopback");
+        return;
+    }
+    getsockname(fd, (struct sockaddr *)&addr, &addr_len);
+    _port = ntohs(addr.sin_port);
+
+    pthread_t server;
+    pthread_create(&server, NULL, _server_thread, &fd);
+
+    long rss_before = _rss_kb();
+    pthread_t clients[CLIENT_NUM];
+    uint64_t start = fake_now_ns();
+    for (int i = 0; i < CLIENT_NUM; i++) {
+        pthread_create(&clients[i], NULL, _client_thread, NULL);
+    }
+    for (int i = 0; i < CLIENT_NUM; i++) {
+        pthread_join(clients[i], NULL);
+    }
+    double seconds = (double)(fake_now_ns() - start) / 1e9;
+    long rss_after = _rss_kb();
+
+    // stop returns only once the workers are joined and the connections closed
+    redfish_http_server_stop();
+    pthread_mutex_lock(&_server_mutex);
+    TEST_CHECK(_workers == NULL && _worker_num == 0, "stop returned with %d workers", _worker_num);
+    TEST_CHECK(_conn_list == NULL && _epoll_fd < 0, "stop returned with connections open");
+    pthread_mutex_unlock(&_server_mutex);
+    pthread_join(server, NULL);
+
+    TEST_CHECK(_client_errors == 0, "%d clients failed", _client_errors);
+    TEST_REPORT("%d keep-alive clients: %.0f req/s, RSS %ld -> %ld KB\n", CLIENT_NUM,
+                CLIENT_NUM * REQUESTS_PER_CLIENT / seconds, rss_before, rss_after);
+    TEST_REPORT("per connection: %zu bytes + %d byte arena block, was %zu bytes with the %d byte buffer inline\n",
+                sizeof(http_conn_t), HTTP_CONN_ARENA_INITIAL_SIZE,
+                sizeof(http_conn_t) - sizeof(redfish_arena_t) - sizeof(char *) - sizeof(size_t) -
+                    sizeof(http_header_slice_t *) - sizeof(int) + BUFFER_SIZE,
+                BUFFER_SIZE);
+}
+
+int main(void)
+{
+    TEST_CHECK(redfish_router_init() == SUCCESS, "route table rejected");
+
+    _test_arena();
+    _test_keepalive_load();
+
+    return TEST_RESULT();
+}
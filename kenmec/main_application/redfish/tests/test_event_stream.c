@@ -0,0 +1,288 @@
+// Event stream: a subscriber first gets every register that changed (or the
+// changes after its Last-Event-ID), then one event per tick with what changed
+// since. One subscriber replays its events into a shadow table that must end
+// up equal to the fake Modbus table. A subscriber that stops reading is
+// dropped once its backlog passes REDFISH_SSE_BACKLOG_MAX, a closed one on
+// its next write; the others keep receiving.
+// Then 50 subscribers follow TICK_NUM ticks with CHANGES_PER_TICK changed
+// registers each, and the CPU time and bytes sent are reported next to 50
+// clients polling the CDU document once per tick.
+
+#include "../src/redfish_event_stream.c"
+
+#include "fake_platform.h"
+#include "fake_control_logic.h"
+#include "redfish_server.h"
+
+#define SUBSCRIBER_NUM 50
+#define TICK_NUM 600                    // 10 minutes at 1 Hz
+#define CHANGES_PER_TICK 20
+#define REGISTER_BASE 1000
+#define REGISTER_SPAN 400
+#define SHADOW_SIZE 20000
+
+typedef enum {
+    SINK_READING = 0,
+    SINK_STALLED,                       // takes nothing, like a full socket
+    SINK_GONE,                          // peer closed
+} sink_mode_t;
+
+typedef struct {
+    sink_mode_t mode;
+    size_t bytes;
+    int closed;
+    // Received text, kept for the subscriber that is checked in full
+    char *text;
+    size_t text_len;
+    size_t text_size;
+} sink_t;
+
+static const char _head[] = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\n";
+
+static sink_t _sinks[SUBSCRIBER_NUM + 2];
+static uint16_t _shadow[SHADOW_SIZE];
+
+static int _sink_write(void *ctx, const void *data, size_t len)
+{
+    sink_t *sink = ctx;
+
+    if (sink->mode == SINK_STALLED) {
+        return 0;
+    }
+    if (sink->mode == SINK_GONE) {
+        return -1;
+    }
+
+    sink->bytes += len;
+    if (sink->text) {
+        if (sink->text_len + len + 1 > sink->text_size) {
+            sink->text_size = (sink->text_len + len + 1) * 2;
+            sink->text = realloc(sink->text, sink->text_size);
+        }
+        memcpy(sink->text + sink->text_len, data, len);
+        sink->text_len += len;
+        sink->text[sink->text_len] = '\0';
+    }
+
+    return (int)len;
+}
+
+static void _sink_close(void *ctx)
+{
+    ((sink_t *)ctx)->closed++;
+}
+
+static const redfish_event_stream_ops_t _sink_ops = { _sink_write, _sink_close };
+
+static void _sink_keep_text(sink_t *sink)
+{
+    sink->text_size = 4096;
+    sink->text = malloc(sink->text_size);
+    sink->text[0] = '\0';
+}
+
+// Apply every "[address,value]" pair of the received events; returns the
+// last event id.
+static uint32_t _sink_replay(sink_t *sink, uint16_t *table)
+{
+    uint32_t last_id = 0;
+    const char *p = sink->text;
+
+    while ((p = strstr(p, "id: ")) != NULL) {
+        last_id = (uint32_t)strtoul(p + 4, NULL, 10);
+        const char *registers = strstr(p, "\"Registers\":[");
+        const char *end = strstr(p, "\n\n");
+        if (!registers || !end) {
+            break;
+        }
+        for (const char *r = registers + 13; r < end && *r == '['; ) {
+            unsigned address = 0;
+            unsigned value = 0;
+            int n = 0;
+            if (sscanf(r, "[%u,%u]%n", &address, &value, &n) != 2) {
+                break;
+            }
+            if (address < SHADOW_SIZE) {
+                table[address] = (uint16_t)value;
+            }
+            r += n;
+            if (*r == ',') {
+                r++;
+            }
+        }
+        p = end;
+    }
+
+    return last_id;
+}
+
+static int _event_count(const sink_t *sink)
+{
+    int count = 0;
+
+    for (const char *p = sink->text; (p = strstr(p, "event: RegisterUpdate")) != NULL; p++) {
+        count++;
+    }
+
+    return count;
+}
+
+static unsigned _seed = 1;
+
+static void _change_registers(int count)
+{
+    for (int i = 0; i < count; i++) {
+        _seed = _seed * 1103515245u + 12345u;
+        uint16_t address = (uint16_t)(REGISTER_BASE + (_seed >> 8) % REGISTER_SPAN);
+        _seed = _seed * 1103515245u + 12345u;
+        fake_modbus_table_set(address, (uint16_t)(_seed >> 16));
+    }
+}
+
+static uint64_t _cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void _test_snapshot_and_resume(void)
+{
+    sink_t *first = &_sinks[0];
+    sink_t *resumed = &_sinks[1];
+
+    for (int i = 0; i < 10; i++) {
+        fake_modbus_table_set((uint16_t)(100 + i), (uint16_t)(500 + i));
+    }
+    uint32_t generation = control_logic_modbus_table_generation();
+
+    _sink_keep_text(first);
+    TEST_CHECK(redfish_event_stream_subscribe(&_sink_ops, first, 0, _head, sizeof(_head) - 1) == SUCCESS,
+               "subscribe failed");
+    TEST_CHECK(strcmp(first->text, _head) == 0, "head not sent on subscribe");
+
+    _event_stream_tick();
+    TEST_CHECK(_event_count(first) == 1, "%d snapshot events", _event_count(first));
+    memset(_shadow, 0, sizeof(_shadow));
+    TEST_CHECK(_sink_replay(first, _shadow) == generation, "snapshot id is not the table generation");
+    TEST_CHECK(_shadow[100] == 500 && _shadow[109] == 509, "snapshot registers missing");
+
+    // Reconnect with Last-Event-ID: only the three registers changed after it
+    _sink_keep_text(resumed);
+    redfish_event_stream_subscribe(&_sink_ops, resumed, generation - 3, NULL, 0);
+    _event_stream_tick();
+    TEST_CHECK(strstr(resumed->text, "[[107,507],[108,508],[109,509]]") != NULL, "resume event: %s", resumed->text);
+    TEST_CHECK(_event_count(first) == 1, "up-to-date subscriber got an event for a quiet tick");
+
+    // A change goes to both in the same tick
+    fake_modbus_table_set(100, 42);
+    _event_stream_tick();
+    TEST_CHECK(_event_count(first) == 2 && _event_count(resumed) == 2, "change not published to both");
+    TEST_CHECK(strstr(resumed->text, "\"Registers\":[[100,42]]") != NULL, "change event: %s", resumed->text);
+
+    // Rewriting the same value is not a change
+    generation = control_logic_modbus_table_generation();
+    fake_modbus_table_set(100, 42);
+    TEST_CHECK(control_logic_modbus_table_generation() == generation, "unchanged value bumped the generation");
+
+    // first stays subscribed for the load test; its text is checked there
+    resumed->mode = SINK_GONE;
+    fake_modbus_table_set(101, 43);
+    _event_stream_tick();
+    TEST_CHECK(resumed->closed == 1, "closed subscriber not dropped");
+    TEST_CHECK(redfish_event_stream_subscriber_count() == 1, "%d subscribers", redfish_event_stream_subscriber_count());
+}
+
+static void _test_load(void)
+{
+    sink_t *stalled = &_sinks[SUBSCRIBER_NUM];
+
+    for (int i = 1; i < SUBSCRIBER_NUM; i++) {
+        free(_sinks[i].text);
+        memset(&_sinks[i], 0, sizeof(sink_t));
+        redfish_event_stream_subscribe(&_sink_ops, &_sinks[i], _published, _head, sizeof(_head) - 1);
+    }
+    redfish_event_stream_subscribe(&_sink_ops, stalled, _published, _head, sizeof(_head) - 1);
+    stalled->mode = SINK_STALLED;
+
+    size_t bytes_before = 0;
+    for (int i = 0; i < SUBSCRIBER_NUM; i++) {
+        bytes_before += _sinks[i].bytes;
+    }
+
+    int dropped_at = -1;
+    uint64_t start = _cpu_ns();
+    for (int tick = 0; tick < TICK_NUM; tick++) {
+        _change_registers(CHANGES_PER_TICK);
+        _event_stream_tick();
+        if (dropped_at < 0 && stalled->closed) {
+            dropped_at = tick;
+        }
+    }
+    double stream_ms = (double)(_cpu_ns() - start) / 1e6;
+
+    size_t stream_bytes = 0;
+    for (int i = 0; i < SUBSCRIBER_NUM; i++) {
+        stream_bytes += _sinks[i].bytes;
+        TEST_CHECK(_sinks[i].closed == 0, "subscriber %d dropped", i);
+    }
+    stream_bytes -= bytes_before;
+
+    TEST_CHECK(dropped_at >= 0, "stalled subscriber never dropped");
+    TEST_CHECK(redfish_event_stream_subscriber_count() == SUBSCRIBER_NUM, "%d subscribers",
+               redfish_event_stream_subscriber_count());
+
+    // The fully recorded subscriber has seen every change
+    memset(_shadow, 0, sizeof(_shadow));
+    uint32_t last_id = _sink_replay(&_sinks[0], _shadow);
+    uint16_t addresses[SHADOW_SIZE];
+    uint16_t words[SHADOW_SIZE];
+    uint32_t generation = 0;
+    int count = control_logic_modbus_table_changes(0, &generation, addresses, words, SHADOW_SIZE);
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        mismatches += (_shadow[addresses[i]] != words[i]);
+    }
+    TEST_CHECK(last_id == generation, "last event id %u, table generation %u", last_id, generation);
+    TEST_CHECK(mismatches == 0, "%d registers differ from the table", mismatches);
+
+    // The same clients polling a document once per tick instead
+    static http_response_t response;
+    char head[4096];
+    size_t poll_bytes = 0;
+    start = _cpu_ns();
+    for (int tick = 0; tick < TICK_NUM; tick++) {
+        for (int i = 0; i < SUBSCRIBER_NUM; i++) {
+            memset(&response, 0, sizeof(response));
+            handle_thermalequipment("CDUs/1", &response);
+            int head_len = generate_http_response_head(&response, 0, head, sizeof(head));
+            poll_bytes += (size_t)(head_len > 0 ? head_len : 0) + (size_t)response.content_length;
+            redfish_response_clear_body(&response);
+        }
+    }
+    double poll_ms = (double)(_cpu_ns() - start) / 1e6;
+
+    TEST_REPORT("stalled subscriber dropped after %d ticks (%d byte backlog limit)\n", dropped_at,
+                REDFISH_SSE_BACKLOG_MAX);
+    TEST_REPORT("%d subscribers, %d ticks x %d changes: event stream %.1f ms CPU, %zu bytes\n", SUBSCRIBER_NUM,
+                TICK_NUM, CHANGES_PER_TICK, stream_ms, stream_bytes);
+    TEST_REPORT("%d clients polling CDUs/1 per tick:          %.1f ms CPU, %zu bytes (request side not counted)\n",
+                SUBSCRIBER_NUM, poll_ms, poll_bytes);
+    TEST_CHECK(stream_bytes < poll_bytes, "event stream sent more than polling");
+}
+
+int main(void)
+{
+    _test_snapshot_and_resume();
+    _test_load();
+
+    // Stopping the publisher closes every subscriber
+    TEST_CHECK(redfish_event_stream_start(REDFISH_SSE_MIN_INTERVAL_MS) == SUCCESS, "publisher did not start");
+    redfish_event_stream_stop();
+    TEST_CHECK(redfish_event_stream_subscriber_count() == 0 && _sinks[1].closed == 1 && _sinks[SUBSCRIBER_NUM - 1].closed == 1,
+               "subscribers left after stop");
+
+    return TEST_RESULT();
+}
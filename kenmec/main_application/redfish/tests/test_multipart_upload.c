@@ -0,0 +1,240 @@
+// Streaming multipart parser: 64 MB firmware images are fed in random chunk
+// sizes, from a few bytes up to 1 MB, the way recv() hands them over. The
+// image is generated on the fly and seeded with near-miss delimiters; the
+// file written by the parser and the SHA-256 it reports must match the
+// image, and peak RSS must not grow with the image size.
+
+#include <fcntl.h>
+#include <sys/resource.h>
+
+#include "../src/redfish_multipart.c"
+
+#include "fake_platform.h"
+
+#define IMAGE_SIZE (64u << 20)
+#define NEAR_MISS_STRIDE 777777
+#define OUTPUT_PATH "build/multipart_upload.bin"
+#define CONTENT_TYPE "multipart/form-data; boundary=\"----WebKitFormBoundary7MA4YWxkTrZu0gW\""
+#define RSS_LIMIT_KB (8 * 1024)
+
+typedef struct {
+    const char *name;
+    size_t chunk_min;
+    size_t chunk_max;
+    const char *newline;        // some clients send bare LF between headers
+} upload_case_t;
+
+static const upload_case_t _cases[] = {
+    { "1 B - 4 KB chunks",   1,       4096,      "\r\n" },
+    { "1 B - 64 KB chunks",  1,       65536,     "\r\n" },
+    { "4 KB - 1 MB chunks",  4096,    1u << 20,  "\r\n" },
+    { "1 B - 64 KB, LF",     1,       65536,     "\n" },
+};
+
+static char _boundary[MULTIPART_BOUNDARY_MAX_LEN + 1];
+
+// Image byte generator: xorshift, with "\r\n--<boundary minus its last byte>"
+// planted every NEAR_MISS_STRIDE bytes
+typedef struct {
+    uint32_t state;
+    size_t offset;
+} image_source_t;
+
+static void _image_fill(image_source_t *source, unsigned char *buffer, size_t len)
+{
+    size_t boundary_len = strlen(_boundary);
+
+    for (size_t i = 0; i < len; i++, source->offset++) {
+        size_t in_stride = source->offset % NEAR_MISS_STRIDE;
+        if (source->offset >= NEAR_MISS_STRIDE && in_stride < 4 + boundary_len - 1) {
+            buffer[i] = (in_stride < 4) ? (unsigned char)"\r\n--"[in_stride] : (unsigned char)_boundary[in_stride - 4];
+            continue;
+        }
+        source->state ^= source->state << 13;
+        source->state ^= source->state >> 17;
+        source->state ^= source->state << 5;
+        buffer[i] = (unsigned char)source->state;
+    }
+}
+
+static size_t _chunk_size(const upload_case_t *upload, size_t remaining)
+{
+    size_t n = upload->chunk_min + (size_t)rand() % (upload->chunk_max - upload->chunk_min + 1);
+
+    return (n < remaining) ? n : remaining;
+}
+
+// Feed a fixed string in random chunk sizes
+static int _feed_text(multipart_parser_t *parser, const upload_case_t *upload, const char *text)
+{
+    size_t len = strlen(text);
+
+    for (size_t off = 0; off < len;) {
+        size_t n = _chunk_size(upload, len - off);
+        if (multipart_parser_feed(parser, text + off, n) != SUCCESS) {
+            return ERROR_GENERAL;
+        }
+        off += n;
+    }
+
+    return SUCCESS;
+}
+
+static void _sha256_hex(mbedtls_sha256_context *sha, char *hex)
+{
+    unsigned char digest[32];
+
+    mbedtls_sha256_finish_ret(sha, digest);
+    for (int i = 0; i < 32; i++) {
+        sprintf(hex + 2 * i, "%02x", digest[i]);
+    }
+}
+
+static void _file_sha256_hex(const char *path, char *hex, long *size)
+{
+    mbedtls_sha256_context sha;
+    unsigned char buffer[65536];
+    ssize_t n;
+    int fd = open(path, O_RDONLY);
+
+    *size = 0;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+    while (fd >= 0 && (n = read(fd, buffer, sizeof(buffer))) > 0) {
+        mbedtls_sha256_update_ret(&sha, buffer, (size_t)n);
+        *size += n;
+    }
+    _sha256_hex(&sha, hex);
+    mbedtls_sha256_free(&sha);
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+static long _peak_rss_kb(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_maxrss;
+}
+
+static void _test_upload(const upload_case_t *upload)
+{
+    const char *nl = upload->newline;
+    char head[1024];
+    char tail[256];
+    unsigned char *chunk = malloc(upload->chunk_max);
+    image_source_t source = { 0x12345678u, 0 };
+    mbedtls_sha256_context expect_sha;
+    char expect_hex[MULTIPART_SHA256_HEX_LEN];
+    char parser_hex[MULTIPART_SHA256_HEX_LEN] = {0};
+    char file_hex[MULTIPART_SHA256_HEX_LEN];
+    long bytes = 0;
+    long file_size = 0;
+    multipart_parser_t parser;
+    int failed = 0;
+
+    snprintf(head, sizeof(head),
+             "preamble%s--%s%sContent-Disposition: form-data; name=\"UpdateParameters\"%s"
+             "Content-Type: application/json%s%s{\"Targets\":[]}%s--%s%s"
+             "Content-Disposition: form-data; name=\"UpdateFile\"; filename=\"fw.bin\"%s"
+             "Content-Type: application/octet-stream%s%s",
+             nl, _boundary, nl, nl, nl, nl, nl, _boundary, nl, nl, nl, nl);
+    snprintf(tail, sizeof(tail), "%s--%s--\r\nepilogue", nl, _boundary);
+
+    int fd = open(OUTPUT_PATH, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    TEST_CHECK(fd >= 0 && chunk != NULL, "%s: setup failed", upload->name);
+    if (fd < 0 || chunk == NULL) {
+        free(chunk);
+        return;
+    }
+
+    mbedtls_sha256_init(&expect_sha);
+    mbedtls_sha256_starts_ret(&expect_sha, 0);
+    multipart_parser_init(&parser, _boundary, fd);
+
+    uint64_t start = fake_now_ns();
+    failed |= _feed_text(&parser, upload, head);
+    for (size_t off = 0; !failed && off < IMAGE_SIZE;) {
+        size_t n = _chunk_size(upload, IMAGE_SIZE - off);
+        _image_fill(&source, chunk, n);
+        mbedtls_sha256_update_ret(&expect_sha, chunk, n);
+        failed |= multipart_parser_feed(&parser, chunk, n);
+        off += n;
+    }
+    failed |= _feed_text(&parser, upload, tail);
+    int finished = multipart_parser_finish(&parser, &bytes, parser_hex);
+    double seconds = (double)(fake_now_ns() - start) / 1e9;
+    multipart_parser_free(&parser);
+    close(fd);
+    free(chunk);
+
+    _sha256_hex(&expect_sha, expect_hex);
+    mbedtls_sha256_free(&expect_sha);
+    _file_sha256_hex(OUTPUT_PATH, file_hex, &file_size);
+
+    TEST_CHECK(!failed, "%s: feed failed", upload->name);
+    TEST_CHECK(finished == SUCCESS, "%s: no file part", upload->name);
+    TEST_CHECK(bytes == IMAGE_SIZE, "%s: %ld bytes reported", upload->name, bytes);
+    TEST_CHECK(strcmp(parser_hex, expect_hex) == 0, "%s: SHA-256 %s, image %s", upload->name, parser_hex, expect_hex);
+    TEST_CHECK(file_size == IMAGE_SIZE && strcmp(file_hex, expect_hex) == 0, "%s: file on disk differs (%ld bytes)",
+               upload->name, file_size);
+
+    TEST_REPORT("%-20s %6.1f MB/s, peak RSS %5ld KB\n", upload->name, IMAGE_SIZE / seconds / (1024.0 * 1024.0),
+                _peak_rss_kb());
+}
+
+static int _parse_text(const char *boundary, const char *body, long *bytes)
+{
+    multipart_parser_t parser;
+    char hex[MULTIPART_SHA256_HEX_LEN];
+    int fd = open("/dev/null", O_WRONLY);
+    int ret;
+
+    multipart_parser_init(&parser, boundary, fd);
+    ret = multipart_parser_feed(&parser, body, strlen(body));
+    if (ret == SUCCESS) {
+        ret = multipart_parser_finish(&parser, bytes, hex);
+    }
+    multipart_parser_free(&parser);
+    close(fd);
+
+    return ret;
+}
+
+static void _test_malformed(void)
+{
+    long bytes = -1;
+
+    TEST_CHECK(_parse_text("abc", "garbage", &bytes) != SUCCESS, "body without parts accepted");
+    TEST_CHECK(_parse_text("abc", "--abc\r\nContent-Disposition: form-data; name=\"file\"\r\n\r\nX\r\n--abcZ",
+                           &bytes) != SUCCESS, "bad delimiter tail accepted");
+    TEST_CHECK(_parse_text("abc", "--abc\r\nContent-Disposition: form-data; name=\"file\"\r\n\r\nX", &bytes) != SUCCESS,
+               "truncated body accepted");
+    TEST_CHECK(_parse_text("abc", "--abc\r\nContent-Disposition: form-data; name=\"file\"\r\n\r\nhello\r\r\n--abc--",
+                           &bytes) == SUCCESS && bytes == 6, "CR before the delimiter: %ld bytes", bytes);
+}
+
+int main(void)
+{
+    TEST_CHECK(multipart_boundary_from_content_type(CONTENT_TYPE, _boundary, sizeof(_boundary)) == SUCCESS &&
+               strcmp(_boundary, "----WebKitFormBoundary7MA4YWxkTrZu0gW") == 0, "boundary \"%s\"", _boundary);
+
+    srand(1);
+    long rss_before = _peak_rss_kb();
+    for (size_t i = 0; i < sizeof(_cases) / sizeof(_cases[0]); i++) {
+        _test_upload(&_cases[i]);
+    }
+    long rss_growth = _peak_rss_kb() - rss_before;
+
+    // a buffering parser would hold the whole image
+    TEST_CHECK(rss_growth < RSS_LIMIT_KB, "peak RSS grew by %ld KB for a %u MB image", rss_growth, IMAGE_SIZE >> 20);
+    TEST_REPORT("%u MB image: peak RSS grew by %ld KB\n", IMAGE_SIZE >> 20, rss_growth);
+
+    _test_malformed();
+    unlink(OUTPUT_PATH);
+
+    return TEST_RESULT();
+}
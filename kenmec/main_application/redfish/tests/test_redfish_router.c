@@ -0,0 +1,734 @@
+// Redfish routing: every route in a table of request paths resolves to the
+// same resource type as the strcmp/strncmp parser it replaced, with the
+// expected resource and member IDs, and one million mixed paths are routed
+// through both to compare their cost.
+
+#include "../src/redfish_router.c"
+
+#include "fake_platform.h"
+
+#define ROUTE_NUM 1000000
+
+// parse_redfish_path() before the routing table, without its printf() calls
+static redfish_resource_type_t _legacy_parse_redfish_path(const char *path, char **resource_id) {
+    if (!path) return REDFISH_RESOURCE_UNKNOWN;
+
+    // Remove leading and trailing slashes
+    while (*path == '/') path++;
+
+    if (strcmp(path, "redfish") == 0 || strcmp(path, "redfish/") == 0) {
+        return REDFISH_RESOURCE_VERSION;
+    }
+
+    if (strcmp(path, "redfish/v1") == 0 || strcmp(path, "redfish/v1/") == 0) {
+        return REDFISH_RESOURCE_SERVICE_ROOT;
+    }
+
+    if (strcmp(path, "redfish/v1/odata") == 0) {
+        return REDFISH_RESOURCE_ODATA_SERVICE;
+    }
+
+    if (strcmp(path, "redfish/v1/$metadata") == 0) {
+        return REDFISH_RESOURCE_ODATA_METADATA;
+    }
+
+    if (strcmp(path, "redfish/v1/CertificateService") == 0) {
+        return REDFISH_RESOURCE_CERTIFICATESERVICE;
+    }
+    if (strcmp(path, "redfish/v1/UpdateService") == 0) {
+        return REDFISH_RESOURCE_UPDATESERVICE;
+    }
+    
+    if (strcmp(path, "UpdateFirmwareMultipart") == 0) {
+        return REDFISH_RESOURCE_UPDATESERVICE_MULTIPART;
+    }
+
+    if (strcmp(path, "redfish/v1/CertificateService/Actions/CertificateService.GenerateCSR") == 0) {
+        return REDFISH_RESOURCE_CERTIFICATESERVICE_GENERATE_CSR;
+    }
+    if (strcmp(path, "redfish/v1/CertificateService/Actions/CertificateService.ReplaceCertificate") == 0) {
+        return REDFISH_RESOURCE_CERTIFICATESERVICE_REPLACE_CERTIFICATE;
+    }
+
+    if (strncmp(path, "redfish/v1/Chassis", 18) == 0) {
+        if (strlen(path) == 18) {
+            return REDFISH_RESOURCE_CHASSIS_COLLECTION;
+        }
+        if (path[18] == '/') {
+            *resource_id = (char*)(path + 19);
+            return REDFISH_RESOURCE_CHASSIS;
+        }
+    }
+
+    if (strncmp(path, "redfish/v1/Systems", 18) == 0) {
+        if (strlen(path) == 18) {
+            return REDFISH_RESOURCE_SYSTEMS_COLLECTION;
+        }
+        if (path[18] == '/') {
+            *resource_id = (char*)(path + 19);
+            return REDFISH_RESOURCE_SYSTEM;
+        }
+    }
+
+    if (strncmp(path, "redfish/v1/Managers", 19) == 0) {
+        if (strlen(path) == 19) {
+            *resource_id = (char*)(path + 11);
+            return REDFISH_RESOURCE_MANAGERS_COLLECTION;
+        }
+        if (strlen(path) == 26 && (strncmp(&path[20], MANAGER_ID_KENMEC, 6) == 0)) {
+            *resource_id = (char*)(path + 20);
+            return REDFISH_RESOURCE_MANAGERS_KENMEC;
+        }
+
+        // SecurityPolicy and related endpoints: /redfish/v1/Managers/{id}/SecurityPolicy*
+        {
+            const char *prefix = "redfish/v1/Managers/";
+            if (strncmp(path, prefix, strlen(prefix)) == 0) {
+                const char *p = path + strlen(prefix); // points at {id}...
+                const char *slash = strchr(p, '/');
+                if (slash) {
+                    // Extract manager ID
+                    static char manager_id[64];
+                    size_t n = (size_t)(slash - p);
+                    if (n >= sizeof(manager_id)) n = sizeof(manager_id) - 1;
+                    strncpy(manager_id, p, n);
+                    manager_id[n] = '\0';
+                    *resource_id = manager_id;
+                    
+                    const char *remaining = slash + 1;
+                    
+                    // NetworkProtocol: /redfish/v1/Managers/{id}/NetworkProtocol
+                    if (strcmp(remaining, "NetworkProtocol") == 0) {
+                        return REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL;
+                    }
+                    // NetworkProtocol HTTPS Certificates collection: /redfish/v1/Managers/{id}/NetworkProtocol/HTTPS/Certificates
+                    if (strcmp(remaining, "NetworkProtocol/HTTPS/Certificates") == 0) {
+                        return REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATES;
+                    }
+                    // NetworkProtocol HTTPS Certificate member: /redfish/v1/Managers/{id}/NetworkProtocol/HTTPS/Certificates/{id}
+                    {
+                        const char *cert_prefix = "NetworkProtocol/HTTPS/Certificates/";
+                        size_t cert_prefix_len = strlen(cert_prefix);
+                        if (strncmp(remaining, cert_prefix, cert_prefix_len) == 0 && remaining[cert_prefix_len] != '\0') {
+                            static char certificate_id[64];
+                            const char *cid = remaining + cert_prefix_len;
+                            // Copy until end or next slash
+                            size_t n = strcspn(cid, "/");
+                            if (n >= sizeof(certificate_id)) n = sizeof(certificate_id) - 1;
+                            strncpy(certificate_id, cid, n);
+                            certificate_id[n] = '\0';
+                            *resource_id = certificate_id;
+                            return REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATE;
+                        }
+                    }
+
+                    // SecurityPolicy: /redfish/v1/Managers/{id}/SecurityPolicy
+                    if (strcmp(remaining, "SecurityPolicy") == 0) {
+                        return REDFISH_RESOURCE_MANAGER_SECURITY_POLICY;
+                    }
+                    
+                    // TrustedCertificates Collection: /redfish/v1/Managers/{id}/SecurityPolicy/TLS/Server/TrustedCertificates
+                    if (strcmp(remaining, "SecurityPolicy/TLS/Server/TrustedCertificates") == 0) {
+                        return REDFISH_RESOURCE_MANAGER_SECURITY_POLICY_TRUSTED_CERTIFICATES;
+                    }
+                    
+                    // TrustedCertificate Individual: /redfish/v1/Managers/{id}/SecurityPolicy/TLS/Server/TrustedCertificates/{id}
+                    if (strncmp(remaining, "SecurityPolicy/TLS/Server/TrustedCertificates/", 46) == 0) {
+                        *resource_id = (char*)(remaining + 46);
+                        return REDFISH_RESOURCE_MANAGER_SECURITY_POLICY_TRUSTED_CERTIFICATE;
+                    }
+                }
+            }
+        }
+
+        // Manager.Reset Action: /redfish/v1/Managers/{id}/Actions/Manager.Reset
+        {
+            const char *prefix = "redfish/v1/Managers/";
+            if (strncmp(path, prefix, strlen(prefix)) == 0) {
+                const char *p = path + strlen(prefix); // points at {id}...
+                const char *slash = strchr(p, '/');
+                if (slash && strncmp(slash + 1, "Actions/Manager.Reset", 21) == 0 && (slash[22] == '\0')) {
+                    static char manager_id[64];
+                    size_t n = (size_t)(slash - p);
+                    if (n >= sizeof(manager_id)) n = sizeof(manager_id) - 1;
+                    strncpy(manager_id, p, n);
+                    manager_id[n] = '\0';
+                    *resource_id = manager_id;
+                    return REDFISH_RESOURCE_MANAGER_RESET_ACTION;
+                }
+            }
+        }
+
+        if (strlen(path) == 45 && (strncmp(&path[27], "EthernetInterfaces", 18) == 0)) {
+            *resource_id = (char*)(path + 27);
+            return REDFISH_RESOURCE_MANAGERS_ETHERNET_INTERFACE;
+        }
+
+        if ((strlen(path) == 50) && (strncmp(&path[46], "eth0", 4) == 0)) {
+            *resource_id = (char*)(path + 46);
+            return REDFISH_RESOURCE_MANAGERS_ETHERNET_INTERFACE_ETH0;
+        }
+    }
+
+    if (strncmp(path, "redfish/v1/AccountService", 25) == 0) {
+        if (strlen(path) == 25) {
+            return REDFISH_RESOURCE_ACCOUNTSERVICE;
+        }
+        if (path[25] == '/' && strncmp(&path[26], "Accounts", 8) == 0) {
+            if (strlen(path) == 34) {
+                // Collection: /redfish/v1/AccountService/Accounts
+                return REDFISH_RESOURCE_ACCOUNTSERVICE_ACCOUNTS;
+            }
+            if (path[34] == '/') {
+                // Individual account: /redfish/v1/AccountService/Accounts/{id}
+                *resource_id = (char*)(path + 35);
+                return REDFISH_RESOURCE_ACCOUNTSERVICE_ACCOUNT;
+            }
+        }
+        if (path[25] == '/' && strncmp(&path[26], "Roles", 5) == 0) {
+            if (strlen(path) == 31) {
+                return REDFISH_RESOURCE_ACCOUNTSERVICE_ROLES_COLLECTION;
+            }
+            if (path[31] == '/') {
+                *resource_id = (char*)(path + 32);
+                return REDFISH_RESOURCE_ACCOUNTSERVICE_ROLE;
+            }
+        }
+    }
+
+    if (strncmp(path, "redfish/v1/SessionService", 25) == 0) {
+        if (strlen(path) == 25) {
+            return REDFISH_RESOURCE_SESSIONSERVICE;
+        }
+        // Check Members alias before general Sessions check
+        if (path[25] == '/' && strncmp(&path[26], "Sessions/Members", 16) == 0) {
+            return REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS_MEMBERS;
+        }
+        if (path[25] == '/' && strncmp(&path[26], "Sessions", 8) == 0) {
+            *resource_id = (char*)(path + 26);
+            return REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS;
+        }
+    }
+
+    if (strncmp(path, "redfish/v1/ThermalEquipment", 27) == 0) {
+        if (strlen(path) == 27) {
+            return REDFISH_RESOURCE_THERMALEQUIPMENT_COLLECTION;
+        }
+        if (path[27] == '/') {
+            // Check IOBoard Read action path EARLY to avoid member fallback:
+            // /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/IOBoards/{member}/Actions/Oem/KenmecIOBoard.Read
+            {
+                const char *base = path; // full path
+                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
+                if (strncmp(base, prefix, strlen(prefix)) == 0) {
+                    const char *p = base + strlen(prefix); // points at {cdu}/...
+                    const char *slash = strchr(p, '/');
+                    if (slash) {
+                        size_t id_len = (size_t)(slash - p);
+                        if (id_len > 0 && id_len < 32) {
+                            static char cdu_id[32];
+                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
+                            const char *rest = slash; // starts with "/Oem..."
+                            const char *mid = "/Oem/Kenmec/IOBoards/";
+                            const char *tail = "/Actions/Oem/KenmecIOBoard.Read";
+                            const char *m = strstr(rest, mid);
+                            const char *t = strstr(rest, tail);
+                            if (m == rest && t && t[strlen(tail)] == '\0' && m < t) {
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_READ;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Check IOBoard Write action path EARLY: /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/IOBoards/{member}/Actions/Oem/KenmecIOBoard.Write
+            {
+                const char *base = path;
+                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
+                if (strncmp(base, prefix, strlen(prefix)) == 0) {
+                    const char *p = base + strlen(prefix);
+                    const char *slash = strchr(p, '/');
+                    if (slash) {
+                        size_t id_len = (size_t)(slash - p);
+                        if (id_len > 0 && id_len < 32) {
+                            static char cdu_id[32];
+                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
+                            const char *rest = slash;
+                            const char *mid = "/Oem/Kenmec/IOBoards/";
+                            const char *tail = "/Actions/Oem/KenmecIOBoard.Write";
+                            const char *m = strstr(rest, mid);
+                            const char *t = strstr(rest, tail);
+                            if (m == rest && t && t[strlen(tail)] == '\0' && m < t) {
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_WRITE;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Check exact IOBoards collection path first: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/IOBoards
+            {
+                const char *suffix = "/Oem/Kenmec/IOBoards";
+                char *p = strstr((char*)path + 28, suffix);
+                if (p && p[strlen(suffix)] == '\0') {
+                    char *cdu_path = (char*)(path + 28);
+                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
+                        static char cdu_id[32];
+                        char *slash_pos = strchr(cdu_path + 5, '/');
+                        if (slash_pos) {
+                            size_t len = slash_pos - (cdu_path + 5);
+                            if (len < sizeof(cdu_id)) {
+                                strncpy(cdu_id, cdu_path + 5, len);
+                                cdu_id[len] = '\0';
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_IOBOARDS;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/ControlLogics/{member}/Actions/Oem/ControlLogic.Read
+            {
+                const char *base = path; // full path
+                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
+                // debug(tag, "base: %s, prefix: %s", base, prefix);
+                if (strncmp(base, prefix, strlen(prefix)) == 0) {
+                    // debug(tag, "base: %s, prefix: %s", base, prefix);
+                    const char *p = base + strlen(prefix); // points at {cdu}/...
+                    const char *slash = strchr(p, '/');
+                    if (slash) {
+                        // debug(tag, "slash: %s", slash);
+                        size_t id_len = (size_t)(slash - p);
+                        if (id_len > 0 && id_len < 32) {
+                            static char cdu_id[32];
+                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
+                            const char *rest = slash; // starts with "/Oem..."
+                            const char *mid = "/Oem/Kenmec/ControlLogics/";
+                            const char *tail = "/Actions/Oem/ControlLogic.Read";
+                            const char *m = strstr(rest, mid);
+                            const char *t = strstr(rest, tail);
+                            // debug(tag, "m: %s, t: %s", m, t);
+                            if (m == rest && t && t[strlen(tail)] == '\0' && m < t) {
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_READ;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/ControlLogics/{member}/Actions/Oem/ControlLogic.Write
+            {
+                const char *base = path; // full path
+                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
+                if (strncmp(base, prefix, strlen(prefix)) == 0) {
+                    const char *p = base + strlen(prefix); // points at {cdu}/...
+                    const char *slash = strchr(p, '/');
+                    if (slash) {
+                        size_t id_len = (size_t)(slash - p);
+                        if (id_len > 0 && id_len < 32) {
+                            static char cdu_id[32];
+                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
+                            const char *rest = slash; // starts with "/Oem..."
+                            const char *mid = "/Oem/Kenmec/ControlLogics/";
+                            const char *tail = "/Actions/Oem/ControlLogic.Write";
+                            const char *m = strstr(rest, mid);
+                            const char *t = strstr(rest, tail);
+                            if (m == rest && t && t[strlen(tail)] == '\0' && m < t) {
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_WRITE;
+                            }
+                        }
+                    }
+                }
+            }            
+     
+            // Check ControlLogic member path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/ControlLogics
+            {
+                const char *suffix = "/Oem/Kenmec/ControlLogics";
+                char *p = strstr((char*)path + 28, suffix);
+                if (p && p[strlen(suffix)] == '\0') {
+                    char *cdu_path = (char*)(path + 28);
+                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
+                        static char cdu_id[32];
+                        char *slash_pos = strchr(cdu_path + 5, '/');
+                        if (slash_pos) {
+                            size_t len = slash_pos - (cdu_path + 5);
+                            if (len < sizeof(cdu_id)) {
+                                strncpy(cdu_id, cdu_path + 5, len);
+                                cdu_id[len] = '\0';
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Check ControlLogic member path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/ControlLogics/{member}
+            {
+                const char *anchor = "/Oem/Kenmec/ControlLogics/";
+                char *p = strstr((char*)path + 28, anchor);
+                if (p && p[strlen(anchor)] != '\0') {
+                    // Extract CDU ID
+                    char *cdu_path = (char*)(path + 28);
+                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
+                        static char cdu_id[32];
+                        char *slash_pos = strchr(cdu_path + 5, '/');
+                        if (slash_pos) {
+                            size_t len = slash_pos - (cdu_path + 5);
+                            if (len < sizeof(cdu_id)) {
+                                strncpy(cdu_id, cdu_path + 5, len);
+                                cdu_id[len] = '\0';
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_MEMBER;
+                            }
+                        }
+                    }
+                }
+            }
+     
+            // Check IOBoard member path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/IOBoards/{member}
+            {
+                const char *anchor = "/Oem/Kenmec/IOBoards/";
+                char *p = strstr((char*)path + 28, anchor);
+                if (p && p[strlen(anchor)] != '\0') {
+                    // Extract CDU ID
+                    char *cdu_path = (char*)(path + 28);
+                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
+                        static char cdu_id[32];
+                        char *slash_pos = strchr(cdu_path + 5, '/');
+                        if (slash_pos) {
+                            size_t len = slash_pos - (cdu_path + 5);
+                            if (len < sizeof(cdu_id)) {
+                                strncpy(cdu_id, cdu_path + 5, len);
+                                cdu_id[len] = '\0';
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_IOBOARD_MEMBER;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Check path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/Config.Read
+            {
+                const char *anchor = "/Oem/Kenmec/Config.Read";
+                char *p = strstr((char*)path + 28, anchor);
+                if (p && p[strlen(anchor)] == '\0') {
+                    // Extract CDU ID
+                    char *cdu_path = (char*)(path + 28);
+                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
+                        static char cdu_id[32];
+                        char *slash_pos = strchr(cdu_path + 5, '/');
+                        if (slash_pos) {
+                            size_t len = slash_pos - (cdu_path + 5);
+                            if (len < sizeof(cdu_id)) {
+                                strncpy(cdu_id, cdu_path + 5, len);
+                                cdu_id[len] = '\0';
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_READ;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Check path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec/Config.Write
+            {
+                const char *anchor = "/Oem/Kenmec/Config.Write";
+                char *p = strstr((char*)path + 28, anchor);
+                if (p && p[strlen(anchor)] == '\0') {
+                    // Extract CDU ID
+                    char *cdu_path = (char*)(path + 28);
+                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
+                        static char cdu_id[32];
+                        char *slash_pos = strchr(cdu_path + 5, '/');
+                        if (slash_pos) {
+                            size_t len = slash_pos - (cdu_path + 5);
+                            if (len < sizeof(cdu_id)) {
+                                strncpy(cdu_id, cdu_path + 5, len);
+                                cdu_id[len] = '\0';
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_WRITE;
+                            }
+                        }
+                    }
+                }
+            }            
+
+            // Check exact Kenmec OEM container path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem/Kenmec
+            {
+                const char *suffix = "/Oem/Kenmec";
+                char *p = strstr((char*)path + 28, suffix);
+                if (p && p[strlen(suffix)] == '\0') {
+                    char *cdu_path = (char*)(path + 28);
+                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
+                        static char cdu_id[32];
+                        char *slash_pos = strchr(cdu_path + 5, '/');
+                        if (slash_pos) {
+                            size_t len = slash_pos - (cdu_path + 5);
+                            if (len < sizeof(cdu_id)) {
+                                strncpy(cdu_id, cdu_path + 5, len);
+                                cdu_id[len] = '\0';
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM_KENMEC;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Check IOBoard Read action path: /redfish/v1/ThermalEquipment/CDUs/{cdu}/Oem/Kenmec/IOBoards/{member}/Actions/Oem/KenmecIOBoard.Read
+            {
+                const char *base = path; // full path
+                const char *prefix = "redfish/v1/ThermalEquipment/CDUs/";
+                if (strncmp(base, prefix, strlen(prefix)) == 0) {
+                    const char *p = base + strlen(prefix); // points at {cdu}/...
+                    const char *slash = strchr(p, '/');
+                    if (slash) {
+                        size_t id_len = (size_t)(slash - p);
+                        if (id_len > 0 && id_len < 32) {
+                            static char cdu_id[32];
+                            strncpy(cdu_id, p, id_len); cdu_id[id_len] = '\0';
+                            const char *rest = slash;
+                            const char *expected_tail = "/Oem/Kenmec/IOBoards/";
+                            const char *t = strstr(rest, expected_tail);
+                            if (t == rest && strstr(rest, "/Actions/Oem/KenmecIOBoard.Read") != NULL) {
+                                const char *action_tail = "/Actions/Oem/KenmecIOBoard.Read";
+                                const char *end = strstr(rest, action_tail);
+                                if (end && end[strlen(action_tail)] == '\0') {
+                                    *resource_id = cdu_id;
+                                    return REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_READ;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Check exact OEM container path: /redfish/v1/ThermalEquipment/CDUs/{id}/Oem
+            {
+                const char *suffix = "/Oem";
+                char *p = strstr((char*)path + 28, suffix);
+                if (p && p[strlen(suffix)] == '\0') {
+                    char *cdu_path = (char*)(path + 28); // "CDUs/1/Oem"
+                    if (strncmp(cdu_path, "CDUs/", 5) == 0) {
+                        static char cdu_id[32];
+                        char *slash_pos = strchr(cdu_path + 5, '/');
+                        if (slash_pos) {
+                            size_t len = slash_pos - (cdu_path + 5);
+                            if (len < sizeof(cdu_id)) {
+                                strncpy(cdu_id, cdu_path + 5, len);
+                                cdu_id[len] = '\0';
+                                *resource_id = cdu_id;
+                                return REDFISH_RESOURCE_CDU_OEM;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Fallback: treat the remainder after /redfish/v1/ThermalEquipment/ as thermal equipment identifier
+            *resource_id = (char*)(path + 28);
+            return REDFISH_RESOURCE_THERMALEQUIPMENT;
+        }
+    }
+
+    return REDFISH_RESOURCE_UNKNOWN;
+}
+
+typedef struct {
+    const char *path;
+    redfish_resource_type_t type;
+    const char *id;             // Expected resource ID, NULL for none
+    const char *member;         // Expected second capture (member, certificate), NULL for none
+} route_case_t;
+
+#define CDU "/redfish/v1/ThermalEquipment/CDUs/1"
+
+static const route_case_t _cases[] = {
+    { "/redfish",                                                   REDFISH_RESOURCE_VERSION, NULL, NULL },
+    { "/redfish/",                                                  REDFISH_RESOURCE_VERSION, NULL, NULL },
+    { "/redfish/v1",                                                REDFISH_RESOURCE_SERVICE_ROOT, NULL, NULL },
+    { "/redfish/v1/",                                               REDFISH_RESOURCE_SERVICE_ROOT, NULL, NULL },
+    { "/redfish/v1/odata",                                          REDFISH_RESOURCE_ODATA_SERVICE, NULL, NULL },
+    { "/redfish/v1/$metadata",                                      REDFISH_RESOURCE_ODATA_METADATA, NULL, NULL },
+    { "/redfish/v1/CertificateService",                             REDFISH_RESOURCE_CERTIFICATESERVICE, NULL, NULL },
+    { "/redfish/v1/CertificateService/Actions/CertificateService.GenerateCSR",
+                                                                    REDFISH_RESOURCE_CERTIFICATESERVICE_GENERATE_CSR, NULL, NULL },
+    { "/redfish/v1/CertificateService/Actions/CertificateService.ReplaceCertificate",
+                                                                    REDFISH_RESOURCE_CERTIFICATESERVICE_REPLACE_CERTIFICATE, NULL, NULL },
+    { "/redfish/v1/UpdateService",                                  REDFISH_RESOURCE_UPDATESERVICE, NULL, NULL },
+    { "/UpdateFirmwareMultipart",                                   REDFISH_RESOURCE_UPDATESERVICE_MULTIPART, NULL, NULL },
+    { "/redfish/v1/Chassis",                                        REDFISH_RESOURCE_CHASSIS_COLLECTION, NULL, NULL },
+    { "/redfish/v1/Chassis/1",                                      REDFISH_RESOURCE_CHASSIS, "1", NULL },
+    { "/redfish/v1/Systems",                                        REDFISH_RESOURCE_SYSTEMS_COLLECTION, NULL, NULL },
+    { "/redfish/v1/Systems/sys-1",                                  REDFISH_RESOURCE_SYSTEM, "sys-1", NULL },
+    { "/redfish/v1/Managers",                                       REDFISH_RESOURCE_MANAGERS_COLLECTION, "Managers", NULL },
+    { "/redfish/v1/Managers/Kenmec",                                REDFISH_RESOURCE_MANAGERS_KENMEC, "Kenmec", NULL },
+    { "/redfish/v1/Managers/Kenmec/EthernetInterfaces",             REDFISH_RESOURCE_MANAGERS_ETHERNET_INTERFACE, "EthernetInterfaces", NULL },
+    { "/redfish/v1/Managers/Kenmec/EthernetInterfaces/eth0",        REDFISH_RESOURCE_MANAGERS_ETHERNET_INTERFACE_ETH0, "eth0", NULL },
+    { "/redfish/v1/Managers/Kenmec/NetworkProtocol",                REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL, "Kenmec", NULL },
+    { "/redfish/v1/Managers/Kenmec/NetworkProtocol/HTTPS/Certificates",
+                                                                    REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATES, "Kenmec", NULL },
+    { "/redfish/v1/Managers/Kenmec/NetworkProtocol/HTTPS/Certificates/1",
+                                                                    REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL_HTTPS_CERTIFICATE, "1", "1" },
+    { "/redfish/v1/Managers/Kenmec/SecurityPolicy",                 REDFISH_RESOURCE_MANAGER_SECURITY_POLICY, "Kenmec", NULL },
+    { "/redfish/v1/Managers/Kenmec/SecurityPolicy/TLS/Server/TrustedCertificates",
+                                                                    REDFISH_RESOURCE_MANAGER_SECURITY_POLICY_TRUSTED_CERTIFICATES, "Kenmec", NULL },
+    { "/redfish/v1/Managers/Kenmec/SecurityPolicy/TLS/Server/TrustedCertificates/2",
+                                                                    REDFISH_RESOURCE_MANAGER_SECURITY_POLICY_TRUSTED_CERTIFICATE, "2", NULL },
+    { "/redfish/v1/Managers/Kenmec/Actions/Manager.Reset",          REDFISH_RESOURCE_MANAGER_RESET_ACTION, "Kenmec", NULL },
+    { "/redfish/v1/Managers/BMC/NetworkProtocol",                   REDFISH_RESOURCE_MANAGER_NETWORK_PROTOCOL, "BMC", NULL },
+    { "/redfish/v1/Managers/BMC/Actions/Manager.Reset",             REDFISH_RESOURCE_MANAGER_RESET_ACTION, "BMC", NULL },
+    { "/redfish/v1/AccountService",                                 REDFISH_RESOURCE_ACCOUNTSERVICE, NULL, NULL },
+    { "/redfish/v1/AccountService/Accounts",                        REDFISH_RESOURCE_ACCOUNTSERVICE_ACCOUNTS, NULL, NULL },
+    { "/redfish/v1/AccountService/Accounts/3",                      REDFISH_RESOURCE_ACCOUNTSERVICE_ACCOUNT, "3", NULL },
+    { "/redfish/v1/AccountService/Roles",                           REDFISH_RESOURCE_ACCOUNTSERVICE_ROLES_COLLECTION, NULL, NULL },
+    { "/redfish/v1/AccountService/Roles/Administrator",             REDFISH_RESOURCE_ACCOUNTSERVICE_ROLE, "Administrator", NULL },
+    { "/redfish/v1/SessionService",                                 REDFISH_RESOURCE_SESSIONSERVICE, NULL, NULL },
+    { "/redfish/v1/SessionService/Sessions",                        REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS, NULL, NULL },
+    { "/redfish/v1/SessionService/Sessions/Members",                REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS_MEMBERS, NULL, NULL },
+    { "/redfish/v1/SessionService/Sessions/4",                      REDFISH_RESOURCE_SESSIONSERVICE_SESSIONS, "4", NULL },
+    { "/redfish/v1/ThermalEquipment",                               REDFISH_RESOURCE_THERMALEQUIPMENT_COLLECTION, NULL, NULL },
+    { "/redfish/v1/ThermalEquipment/CDUs",                          REDFISH_RESOURCE_THERMALEQUIPMENT, "CDUs", NULL },
+    { CDU,                                                          REDFISH_RESOURCE_THERMALEQUIPMENT, "CDUs/1", NULL },
+    { CDU "/Oem",                                                   REDFISH_RESOURCE_CDU_OEM, "1", NULL },
+    { CDU "/Oem/Kenmec",                                            REDFISH_RESOURCE_CDU_OEM_KENMEC, "1", NULL },
+    { CDU "/Oem/Kenmec/Config.Read",                                REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_READ, "1", NULL },
+    { CDU "/Oem/Kenmec/Config.Write",                               REDFISH_RESOURCE_CDU_OEM_KENMEC_CONFIG_WRITE, "1", NULL },
+    { CDU "/Oem/Kenmec/IOBoards",                                   REDFISH_RESOURCE_CDU_OEM_IOBOARDS, "1", NULL },
+    { CDU "/Oem/Kenmec/IOBoards/5",                                 REDFISH_RESOURCE_CDU_OEM_IOBOARD_MEMBER, "1", "5" },
+    { CDU "/Oem/Kenmec/IOBoards/5/Actions/Oem/KenmecIOBoard.Read",  REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_READ, "1", "5" },
+    { CDU "/Oem/Kenmec/IOBoards/5/Actions/Oem/KenmecIOBoard.Write", REDFISH_RESOURCE_CDU_OEM_IOBOARD_ACTION_WRITE, "1", "5" },
+    { CDU "/Oem/Kenmec/ControlLogics",                              REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS, "1", NULL },
+    { CDU "/Oem/Kenmec/ControlLogics/6",                            REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_MEMBER, "1", "6" },
+    { CDU "/Oem/Kenmec/ControlLogics/6/Actions/Oem/ControlLogic.Read",
+                                                                    REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_READ, "1", "6" },
+    { CDU "/Oem/Kenmec/ControlLogics/6/Actions/Oem/ControlLogic.Write",
+                                                                    REDFISH_RESOURCE_CDU_OEM_CONTROL_LOGICS_ACTION_WRITE, "1", "6" },
+    // Branches that do not lead to a route fall back like the old parser did
+    { CDU "/Oem/Kenmec/IOBoards/5/Settings",                        REDFISH_RESOURCE_CDU_OEM_IOBOARD_MEMBER, "1", "5/Settings" },
+    { CDU "/Oem/Other",                                             REDFISH_RESOURCE_THERMALEQUIPMENT, "CDUs/1/Oem/Other", NULL },
+    { "/redfish/v2",                                                REDFISH_RESOURCE_UNKNOWN, NULL, NULL },
+    { "/redfish/v1/Managers/Kenmec/Unknown",                        REDFISH_RESOURCE_UNKNOWN, NULL, NULL },
+    { "/redfish/v1/Fabrics",                                        REDFISH_RESOURCE_UNKNOWN, NULL, NULL },
+};
+
+#define CASE_NUM (sizeof(_cases) / sizeof(_cases[0]))
+
+static bool _param_equals(const redfish_route_param_t *param, const char *expect)
+{
+    if (expect == NULL) {
+        return param->len == 0;
+    }
+    return param->len == strlen(expect) && memcmp(param->ptr, expect, param->len) == 0;
+}
+
+static void _test_routes(void)
+{
+    redfish_route_match_t match;
+    char buf[MAX_PATH_LENGTH];
+
+    for (size_t i = 0; i < CASE_NUM; i++) {
+        const route_case_t *c = &_cases[i];
+        char *legacy_id = NULL;
+        redfish_resource_type_t legacy_type = _legacy_parse_redfish_path(c->path, &legacy_id);
+
+        TEST_CHECK(legacy_type == c->type, "%s: legacy parser resolves to %d, table expects %d", c->path,
+                   legacy_type, c->type);
+        TEST_CHECK(parse_redfish_path(c->path, &match) == c->type && match.type == c->type,
+                   "%s: routed to %d, expected %d", c->path, match.type, c->type);
+        TEST_CHECK(_param_equals(&match.id, c->id), "%s: id '%.*s', expected '%s'", c->path,
+                   (int)match.id.len, match.id.ptr ? match.id.ptr : "", c->id ? c->id : "");
+        if (c->member) {
+            TEST_CHECK(match.param_count >= 2 && _param_equals(&match.params[1], c->member),
+                       "%s: member '%.*s', expected '%s'", c->path, (int)match.params[1].len,
+                       match.params[1].ptr ? match.params[1].ptr : "", c->member);
+        }
+
+        // IDs are slices of the request path
+        if (match.id.len > 0) {
+            TEST_CHECK(match.id.ptr >= c->path && match.id.ptr + match.id.len <= c->path + strlen(c->path),
+                       "%s: id is not a slice of the path", c->path);
+        }
+    }
+
+    // Query strings, trailing slashes and repeated leading slashes are ignored
+    TEST_CHECK(parse_redfish_path("/redfish/v1/Systems/sys-1/?$expand=.", &match) == REDFISH_RESOURCE_SYSTEM &&
+               _param_equals(&match.id, "sys-1"), "query string not ignored");
+    const char *id = redfish_route_param_str(&match.id, buf, sizeof(buf));
+    TEST_CHECK(id == buf && strcmp(buf, "sys-1") == 0, "id not terminated in the buffer");
+    TEST_CHECK(parse_redfish_path("//redfish/v1/Managers/", &match) == REDFISH_RESOURCE_MANAGERS_COLLECTION,
+               "slashes not ignored");
+    TEST_CHECK(parse_redfish_path("/redfish//v1", &match) == REDFISH_RESOURCE_UNKNOWN, "empty segment routed");
+    TEST_CHECK(parse_redfish_path(NULL, &match) == REDFISH_RESOURCE_UNKNOWN, "NULL path routed");
+
+    // A capture that ends the path is returned in place, one in the middle is terminated in buf
+    parse_redfish_path(CDU "/Oem/Kenmec/IOBoards/5", &match);
+    TEST_CHECK(redfish_route_param_str(&match.params[1], buf, sizeof(buf)) == match.params[1].ptr,
+               "tail capture copied");
+    TEST_CHECK(redfish_route_param_str(&match.id, buf, sizeof(buf)) == buf && strcmp(buf, "1") == 0,
+               "middle capture not terminated in buf");
+
+    TEST_REPORT("%d paths resolve as before\n", (int)CASE_NUM);
+}
+
+// Routes paths[(i * 7) % count] ROUTE_NUM times through one of the parsers, returns ns/route
+static double _route_time(const char **paths, size_t count, bool legacy)
+{
+    redfish_route_match_t match;
+    volatile int sink = 0;
+
+    uint64_t start = fake_now_ns();
+    for (uint32_t i = 0; i < ROUTE_NUM; i++) {
+        const char *path = paths[(i * 7u) % count];
+        if (legacy) {
+            char *resource_id = NULL;
+            sink += _legacy_parse_redfish_path(path, &resource_id);
+        } else {
+            sink += parse_redfish_path(path, &match);
+        }
+    }
+    (void)sink;
+
+    return (double)(fake_now_ns() - start) / ROUTE_NUM;
+}
+
+static void _test_benchmark(void)
+{
+    const char *all[CASE_NUM];
+    const char *cdu[CASE_NUM];
+    size_t cdu_count = 0;
+
+    for (size_t i = 0; i < CASE_NUM; i++) {
+        all[i] = _cases[i].path;
+        if (strncmp(_cases[i].path, CDU "/", strlen(CDU "/")) == 0) {
+            cdu[cdu_count++] = _cases[i].path;
+        }
+    }
+
+    double trie_ns = _route_time(all, CASE_NUM, false);
+    double legacy_ns = _route_time(all, CASE_NUM, true);
+    TEST_REPORT("%d mixed paths: %.0f ns/route trie, %.0f ns/route strcmp chain (%.1fx)\n", ROUTE_NUM, trie_ns,
+                legacy_ns, legacy_ns / trie_ns);
+
+    trie_ns = _route_time(cdu, cdu_count, false);
+    legacy_ns = _route_time(cdu, cdu_count, true);
+    TEST_REPORT("%d CDU OEM paths: %.0f ns/route trie, %.0f ns/route strcmp chain (%.1fx)\n", ROUTE_NUM, trie_ns,
+                legacy_ns, legacy_ns / trie_ns);
+}
+
+int main(void)
+{
+    TEST_CHECK(redfish_router_init() == SUCCESS, "route table rejected");
+
+    _test_routes();
+    _test_benchmark();
+
+    return TEST_RESULT();
+}
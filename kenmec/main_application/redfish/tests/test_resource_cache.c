@@ -0,0 +1,209 @@
+// Resource cache: 10,000 manager GETs are served from the in-memory copy of
+// the generated document, and the bytes written to redfish_resource_json/
+// are counted next to the old path that rewrote the file, read it back and
+// parsed it on every request. The ETag stays the same while the document
+// does, and a file changed behind the cache's back is put right on the next
+// GET.
+
+#include <stdio.h>
+
+static size_t _disk_bytes;
+
+// every file write in redfish_resources.c goes through fwrite()
+static size_t _counted_fwrite(const void *data, size_t size, size_t count, FILE *fp)
+{
+    size_t written = fwrite(data, size, count, fp);
+
+    _disk_bytes += written * size;
+
+    return written;
+}
+#define fwrite _counted_fwrite
+
+#include "../src/redfish_resources.c"
+
+#include "fake_platform.h"
+
+#define REQUEST_NUM 10000
+
+// open_json_file() the way it was before the cache
+static char *_uncached_open_json_file(const char *file_name, json_resource_type_t type)
+{
+    char info[RESOURCE_JSON_MAX_LEN];
+    char path[512];
+
+    if (!get_json(info, type) || !resource_json_dir_ensure()) {
+        return NULL;
+    }
+    snprintf(path, sizeof(path), "%s/%s.json", RESOURCE_JSON_DIR, file_name);
+
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        return NULL;
+    }
+    fwrite(info, 1, strlen(info), fp);
+    fclose(fp);
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    rewind(fp);
+    char *buffer = malloc((size_t)size + 1);
+    if (buffer) {
+        buffer[fread(buffer, 1, (size_t)size, fp)] = '\0';
+    }
+    fclose(fp);
+
+    cJSON *root = buffer ? cJSON_Parse(buffer) : NULL;
+    if (!root) {
+        free(buffer);
+        return NULL;
+    }
+    cJSON_Delete(root);
+
+    return buffer;
+}
+
+static const char *_response_etag(const http_response_t *response)
+{
+    for (int i = 0; i < response->header_count; i++) {
+        if (strcmp(response->headers[i][0], "ETag") == 0) {
+            return response->headers[i][1];
+        }
+    }
+    return NULL;
+}
+
+static void _test_throughput(const char *name, json_resource_type_t type)
+{
+    char etag[RESOURCE_ETAG_LEN];
+    int failures = 0;
+
+    _disk_bytes = 0;
+    uint64_t start = fake_now_ns();
+    for (int i = 0; i < REQUEST_NUM; i++) {
+        char *json = open_json_file_with_etag(name, type, etag, sizeof(etag));
+        if (!json) {
+            failures++;
+        }
+        free(json);
+    }
+    double cached_rps = REQUEST_NUM * 1e9 / (double)(fake_now_ns() - start);
+    size_t cached_bytes = _disk_bytes;
+
+    _disk_bytes = 0;
+    start = fake_now_ns();
+    for (int i = 0; i < REQUEST_NUM; i++) {
+        char *json = _uncached_open_json_file(name, type);
+        if (!json) {
+            failures++;
+        }
+        free(json);
+    }
+    double uncached_rps = REQUEST_NUM * 1e9 / (double)(fake_now_ns() - start);
+    size_t uncached_bytes = _disk_bytes;
+
+    TEST_CHECK(failures == 0, "%s: %d GETs failed", name, failures);
+    TEST_CHECK(cached_rps > uncached_rps, "%s: cache slower than rewriting the file", name);
+    TEST_CHECK(cached_bytes < uncached_bytes / 100, "%s: %zu bytes written with the cache", name, cached_bytes);
+
+    TEST_REPORT("%-22s %9.0f GET/s cached, %7.0f GET/s rewriting (%4.0fx); per %d GETs %6zu bytes written, "
+                "%9zu before\n", name, cached_rps, uncached_rps, cached_rps / uncached_rps, REQUEST_NUM, cached_bytes,
+                uncached_bytes);
+}
+
+static void _test_etag(void)
+{
+    http_response_t response;
+    char first[RESOURCE_ETAG_LEN] = {0};
+    int changed = 0;
+
+    for (int i = 0; i < 100; i++) {
+        memset(&response, 0, sizeof(response));
+        TEST_CHECK(get_managers_collection("Managers", &response) == SUCCESS, "collection GET failed");
+        const char *etag = _response_etag(&response);
+        TEST_CHECK(etag != NULL && etag[0] == '"', "no ETag header");
+        if (etag == NULL) {
+            return;
+        }
+        if (i == 0) {
+            snprintf(first, sizeof(first), "%s", etag);
+
+            // the tag is the hash of the bytes sent
+            char expect[RESOURCE_ETAG_LEN];
+            const char *body = response.body;
+            resource_etag_compute(body, strlen(body), expect, sizeof(expect));
+            TEST_CHECK(strcmp(expect, etag) == 0, "ETag %s for a body hashing to %s", etag, expect);
+        } else if (strcmp(first, etag) != 0) {
+            changed++;
+        }
+    }
+
+    TEST_CHECK(changed == 0, "ETag changed %d times for an unchanged document", changed);
+}
+
+// Someone edits the file on disk: the next GET writes the document back once
+static void _test_external_change(void)
+{
+    const char *path = RESOURCE_JSON_DIR "/Managers.json";
+    char *json;
+
+    FILE *fp = fopen(path, "w");
+    TEST_CHECK(fp != NULL, "cannot open %s", path);
+    if (fp == NULL) {
+        return;
+    }
+    fputs("{}", fp);
+    fclose(fp);
+
+    _disk_bytes = 0;
+    for (int i = 0; i < 10; i++) {
+        json = open_json_file("Managers", MANAGER_COLLECTION);
+        free(json);
+    }
+
+    json = open_json_file("Managers", MANAGER_COLLECTION);
+    TEST_CHECK(json != NULL && resource_file_matches(path, json, strlen(json)), "file not restored");
+    TEST_CHECK(json != NULL && _disk_bytes == strlen(json), "%zu bytes written to restore a %zu byte file", _disk_bytes,
+               json ? strlen(json) : 0);
+    free(json);
+}
+
+// save_json_file() drops the cached copy
+static void _test_save_invalidates(void)
+{
+    char etag[RESOURCE_ETAG_LEN];
+
+    free(open_json_file_with_etag("eth0", MANAGER_ETHERNET_INTERFACE_ETH0, etag, sizeof(etag)));
+    TEST_CHECK(save_json_file("eth0", "{\"Id\":\"eth0\"}"), "save_json_file failed");
+
+    bool cached = false;
+    pthread_mutex_lock(&resource_cache_mutex);
+    for (int i = 0; i < RESOURCE_CACHE_MAX_ENTRIES; i++) {
+        if (resource_cache[i].used && strcmp(resource_cache[i].name, "eth0") == 0) {
+            cached = true;
+        }
+    }
+    pthread_mutex_unlock(&resource_cache_mutex);
+    TEST_CHECK(!cached, "eth0 still cached after save_json_file");
+}
+
+int main(void)
+{
+    // start without the files so the first GET has to write each one
+    unlink(RESOURCE_JSON_DIR "/Managers.json");
+    unlink(RESOURCE_JSON_DIR "/EthernetInterfaces.json");
+    unlink(RESOURCE_JSON_DIR "/eth0.json");
+
+    _test_throughput("Managers", MANAGER_COLLECTION);
+    _test_throughput("EthernetInterfaces", MANAGER_ETHERNET_INTERFACE);
+    _test_throughput("eth0", MANAGER_ETHERNET_INTERFACE_ETH0);
+    _test_etag();
+    _test_external_change();
+    _test_save_invalidates();
+
+    return TEST_RESULT();
+}
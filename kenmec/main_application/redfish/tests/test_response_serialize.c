@@ -0,0 +1,216 @@
+// Response serialization: Chassis and ThermalEquipment GETs are written
+// straight into the response body and only the head is formatted for the
+// wire, next to the old path that generated the document in a heap buffer,
+// copied it into the body and copied it again into a 44 KB output buffer.
+// A ThermalEquipment document larger than body[] is serialized compactly and
+// in full where cJSON_Print() + strncpy() cut it off, and its head announces
+// a chunked body. Time and allocations are reported for each.
+
+#include <stdlib.h>
+
+static size_t _allocations;
+
+// every allocation made by the handlers, the response helpers and cJSON
+static void *_counted_malloc(size_t size)
+{
+    _allocations++;
+
+    return malloc(size);
+}
+#define malloc _counted_malloc
+
+#include "../src/redfish_resources.c"
+#include "../src/redfish_server.c"
+
+#undef malloc
+
+#include "fake_platform.h"
+
+#define REQUEST_NUM 100000
+#define LARGE_REQUEST_NUM 200
+#define LARGE_SENSOR_NUM 800
+#define OUTPUT_BUFFER_SIZE (MAX_JSON_SIZE + 4096)
+
+static http_response_t _response;
+static char _output[OUTPUT_BUFFER_SIZE];
+
+typedef struct {
+    double ns;
+    double allocations;
+} _cost_t;
+
+// handle_chassis() and handle_thermalequipment() before they wrote in place
+static int _legacy_handle(const char *id, int thermal, http_response_t *response)
+{
+    char *json = thermal ? generate_thermalequipment_json(id) : generate_chassis_json(id);
+    if (!json) {
+        return ERROR_MEMORY;
+    }
+
+    response->status_code = HTTP_OK;
+    strcpy(response->body, json);
+    response->content_length = strlen(response->body);
+    free(json);
+
+    return SUCCESS;
+}
+
+static _cost_t _measure_legacy(const char *id, int thermal)
+{
+    size_t allocations = _allocations;
+    uint64_t start = fake_now_ns();
+
+    for (int i = 0; i < REQUEST_NUM; i++) {
+        _legacy_handle(id, thermal, &_response);
+        generate_http_response(&_response, _output, sizeof(_output));
+    }
+
+    _cost_t cost = {
+        (double)(fake_now_ns() - start) / REQUEST_NUM,
+        (double)(_allocations - allocations) / REQUEST_NUM,
+    };
+    return cost;
+}
+
+static _cost_t _measure(const char *id, int thermal)
+{
+    size_t allocations = _allocations;
+    uint64_t start = fake_now_ns();
+
+    for (int i = 0; i < REQUEST_NUM; i++) {
+        if (thermal) {
+            handle_thermalequipment(id, &_response);
+        } else {
+            handle_chassis(id, &_response);
+        }
+        generate_http_response_head(&_response, 0, _output, sizeof(_output));
+    }
+
+    _cost_t cost = {
+        (double)(fake_now_ns() - start) / REQUEST_NUM,
+        (double)(_allocations - allocations) / REQUEST_NUM,
+    };
+    return cost;
+}
+
+static void _test_resource(const char *name, const char *id, int thermal)
+{
+    char *expected = thermal ? generate_thermalequipment_json(id) : generate_chassis_json(id);
+    TEST_CHECK(expected != NULL, "%s: no document", name);
+    if (!expected) {
+        return;
+    }
+
+    memset(&_response, 0, sizeof(_response));
+    int ret = thermal ? handle_thermalequipment(id, &_response) : handle_chassis(id, &_response);
+    TEST_CHECK(ret == SUCCESS && _response.status_code == HTTP_OK, "%s: handler failed", name);
+    TEST_CHECK(_response.content_length == (int)strlen(expected) &&
+               strcmp(redfish_response_body(&_response), expected) == 0, "%s: body differs", name);
+
+    // head and body sent back to back are what generate_http_response() builds
+    char wire[4096];
+    int head_len = generate_http_response_head(&_response, 0, wire, sizeof(wire));
+    generate_http_response(&_response, _output, sizeof(_output));
+    TEST_CHECK(head_len > 0 && strncmp(_output, wire, (size_t)head_len) == 0 &&
+               strcmp(_output + head_len, expected) == 0, "%s: head + body differ from the full response", name);
+    free(expected);
+
+    _cost_t legacy = _measure_legacy(id, thermal);
+    _cost_t cost = _measure(id, thermal);
+
+    TEST_CHECK(cost.allocations < legacy.allocations, "%s: %.1f allocations per GET, legacy %.1f", name,
+               cost.allocations, legacy.allocations);
+    TEST_REPORT("%-24s %6.0f ns %4.1f allocs per GET, legacy %6.0f ns %4.1f allocs\n", name, cost.ns,
+                cost.allocations, legacy.ns, legacy.allocations);
+}
+
+// A CDU document with a sensor list that outgrows MAX_JSON_SIZE
+static cJSON *_large_thermalequipment(void)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "@odata.type", "#CoolingUnit.v1_3_0.CoolingUnit");
+    cJSON_AddStringToObject(root, "@odata.id", "/redfish/v1/ThermalEquipment/CDUs/1");
+    cJSON_AddStringToObject(root, "Id", "1");
+
+    cJSON *sensors = cJSON_AddArrayToObject(root, "Sensors");
+    for (int i = 0; i < LARGE_SENSOR_NUM; i++) {
+        char odata_id[96];
+        snprintf(odata_id, sizeof(odata_id), "/redfish/v1/ThermalEquipment/CDUs/1/Sensors/T%03d", i);
+
+        cJSON *sensor = cJSON_CreateObject();
+        cJSON_AddStringToObject(sensor, "@odata.id", odata_id);
+        cJSON_AddNumberToObject(sensor, "Reading", 20.0 + i * 0.125);
+        cJSON_AddStringToObject(sensor, "ReadingUnits", "Cel");
+        cJSON_AddItemToArray(sensors, sensor);
+    }
+
+    return root;
+}
+
+static void _test_large_document(void)
+{
+    cJSON *root = _large_thermalequipment();
+    char *expected = cJSON_PrintUnformatted(root);
+
+    memset(&_response, 0, sizeof(_response));
+    TEST_CHECK(redfish_response_set_json(&_response, root) == SUCCESS, "large document not serialized");
+    TEST_CHECK(_response.body_ext != NULL, "large document did not move to a heap body");
+    TEST_CHECK(_response.content_length == (int)strlen(expected) &&
+               strcmp(redfish_response_body(&_response), expected) == 0,
+               "large document differs from cJSON_PrintUnformatted()");
+    TEST_CHECK(_response.content_length > MAX_JSON_SIZE, "large document only %d bytes", _response.content_length);
+
+    char head[4096];
+    TEST_CHECK(generate_http_response_head(&_response, 1, head, sizeof(head)) > 0 &&
+               strstr(head, "Transfer-Encoding: chunked\r\n") != NULL && strstr(head, "Content-Length") == NULL,
+               "chunked head: %s", head);
+
+    // the old path: pretty-printed, then cut off at body[]
+    char *legacy = cJSON_Print(root);
+    strncpy(_response.body, legacy, sizeof(_response.body) - 1);
+    TEST_CHECK(strlen(legacy) > sizeof(_response.body) - 1, "legacy document fits in body[]");
+    size_t legacy_len = strlen(legacy);
+    free(legacy);
+
+    size_t allocations = _allocations;
+    uint64_t start = fake_now_ns();
+    for (int i = 0; i < LARGE_REQUEST_NUM; i++) {
+        char *json = cJSON_Print(root);
+        strncpy(_response.body, json, sizeof(_response.body) - 1);
+        free(json);
+    }
+    double legacy_us = (double)(fake_now_ns() - start) / 1e3 / LARGE_REQUEST_NUM;
+    double legacy_allocations = (double)(_allocations - allocations) / LARGE_REQUEST_NUM;
+
+    redfish_response_clear_body(&_response);
+    TEST_CHECK(_response.body_ext == NULL && _response.content_length == 0, "body not cleared");
+
+    allocations = _allocations;
+    start = fake_now_ns();
+    for (int i = 0; i < LARGE_REQUEST_NUM; i++) {
+        redfish_response_set_json(&_response, root);
+        redfish_response_clear_body(&_response);
+    }
+    double us = (double)(fake_now_ns() - start) / 1e3 / LARGE_REQUEST_NUM;
+    double cost_allocations = (double)(_allocations - allocations) / LARGE_REQUEST_NUM;
+
+    TEST_REPORT("%-24s %6.1f us %4.1f allocs, %zu bytes; legacy %6.1f us %4.1f allocs, %zu bytes cut to %zu\n",
+                "ThermalEquipment large", us, cost_allocations, strlen(expected), legacy_us, legacy_allocations,
+                legacy_len, sizeof(_response.body) - 1);
+
+    free(expected);
+    cJSON_Delete(root);
+}
+
+int main(void)
+{
+    cJSON_Hooks hooks = { _counted_malloc, free };
+    cJSON_InitHooks(&hooks);
+
+    _test_resource("Chassis", CHASSIS_ID, 0);
+    _test_resource("ThermalEquipment CDU", "CDUs/1", 1);
+    _test_resource("ThermalEquipment CDUs", "CDUs", 1);
+    _test_large_document();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,215 @@
+// Session cache: with 1,000 live sessions an authenticated request is served
+// from the in-memory token table instead of opening the account database
+// (the old per-call sqlite3_open/prepare/step/close path is timed next to
+// it), creates and deletes are written through to sqlite, and expired
+// sessions leave from the top of the heap.
+
+#include "../src/redfish_client_info_handle.c"
+
+#include "fake_platform.h"
+
+#define SESSION_NUM 1000
+#define REQUEST_NUM 20000
+#define UNCACHED_REQUEST_NUM 2000
+
+static char _tokens[SESSION_NUM][MAX_TOKEN_LENGTH];
+static int _ids[SESSION_NUM];
+
+static void _request_make(http_request_t *request, const char *token)
+{
+    memset(request, 0, sizeof(*request));
+    strcpy(request->method, HTTP_METHOD_GET);
+    strcpy(request->path, "/redfish/v1/Systems");
+    strcpy(request->headers[0][0], "X-Auth-Token");
+    snprintf(request->headers[0][1], sizeof(request->headers[0][1]), "%s", token);
+    request->header_count = 1;
+}
+
+static int _db_session_rows(const char *token)
+{
+    sqlite3 *ldb = NULL;
+    sqlite3_stmt *stmt = NULL;
+    int count = -1;
+
+    if (sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &ldb) != SQLITE_OK) {
+        sqlite3_close(ldb);
+        return -1;
+    }
+    if (token != NULL) {
+        sqlite3_prepare_v2(ldb, "SELECT COUNT(*) FROM sessions WHERE token = ?;", -1, &stmt, NULL);
+        sqlite3_bind_text(stmt, 1, token, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_prepare_v2(ldb, "SELECT COUNT(*) FROM sessions;", -1, &stmt, NULL);
+    }
+    if (stmt != NULL && sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(ldb);
+
+    return count;
+}
+
+// One query the way is_token_valid()/get_session_by_token() ran it before the cache
+static bool _uncached_query(const char *sql, const char *token, char *out, size_t out_size)
+{
+    sqlite3 *ldb = NULL;
+    sqlite3_stmt *stmt = NULL;
+    bool found = false;
+
+    if (sqlite3_open(CONFIG_REDFISH_ACCOUNT_DB_PATH, &ldb) != SQLITE_OK) {
+        sqlite3_close(ldb);
+        return false;
+    }
+    if (sqlite3_prepare_v2(ldb, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, token, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const unsigned char *value = sqlite3_column_text(stmt, 0);
+            snprintf(out, out_size, "%s", value ? (const char *)value : "");
+            found = true;
+        }
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(ldb);
+
+    return found;
+}
+
+static bool _uncached_request(const char *token)
+{
+    char expiry[32];
+    char username[MAX_USERNAME_LENGTH];
+
+    return _uncached_query("SELECT expiry FROM sessions WHERE token = ?;", token, expiry, sizeof(expiry)) &&
+           _uncached_query("SELECT username, role FROM sessions WHERE token = ?;", token, username, sizeof(username));
+}
+
+static void _test_sessions_create(void)
+{
+    int failures = 0;
+
+    for (int i = 0; i < SESSION_NUM; i++) {
+        if (session_add("admin", _tokens[i], &_ids[i]) != SUCCESS) {
+            failures++;
+        }
+    }
+
+    TEST_CHECK(failures == 0, "%d session_add calls failed", failures);
+    TEST_CHECK(session_count_get() == SESSION_NUM, "session count %d", session_count_get());
+    TEST_CHECK(_db_session_rows(NULL) == SESSION_NUM, "%d session rows in sqlite", _db_session_rows(NULL));
+}
+
+static void _test_throughput(void)
+{
+    http_request_t request;
+    char username[MAX_USERNAME_LENGTH];
+    char role[MAX_ROLE_LENGTH];
+    int rejected = 0;
+
+    srand(1);
+    uint64_t start = fake_now_ns();
+    for (int i = 0; i < REQUEST_NUM; i++) {
+        int k = rand() % SESSION_NUM;
+        _request_make(&request, _tokens[k]);
+        if (check_client_token(&request) != SUCCESS ||
+            get_authenticated_identity(&request, username, sizeof(username), role, sizeof(role)) != SUCCESS) {
+            rejected++;
+        }
+    }
+    double cached_rps = REQUEST_NUM * 1e9 / (double)(fake_now_ns() - start);
+
+    int uncached_rejected = 0;
+    start = fake_now_ns();
+    for (int i = 0; i < UNCACHED_REQUEST_NUM; i++) {
+        if (!_uncached_request(_tokens[rand() % SESSION_NUM])) {
+            uncached_rejected++;
+        }
+    }
+    double uncached_rps = UNCACHED_REQUEST_NUM * 1e9 / (double)(fake_now_ns() - start);
+
+    TEST_CHECK(rejected == 0, "%d of %d cached requests rejected", rejected, REQUEST_NUM);
+    TEST_CHECK(uncached_rejected == 0, "%d uncached lookups failed", uncached_rejected);
+    TEST_CHECK(strcmp(username, "admin") == 0, "identity %s", username);
+    TEST_CHECK(cached_rps > uncached_rps, "cache slower than sqlite per request");
+
+    TEST_REPORT("%d sessions: %.0f authenticated req/s cached, %.0f req/s opening sqlite per lookup (%.0fx)\n",
+                SESSION_NUM, cached_rps, uncached_rps, cached_rps / uncached_rps);
+}
+
+static void _test_write_through(void)
+{
+    http_request_t request;
+    char token[MAX_TOKEN_LENGTH];
+    int id = 0;
+
+    // delete by token and by id: gone from the cache and from sqlite
+    TEST_CHECK(session_delete(_tokens[10]) == SUCCESS, "session_delete failed");
+    _request_make(&request, _tokens[10]);
+    TEST_CHECK(check_client_token(&request) != SUCCESS, "deleted token still accepted");
+    TEST_CHECK(_db_session_rows(_tokens[10]) == 0, "deleted session still in sqlite");
+
+    TEST_CHECK(session_delete_by_id(_ids[20]) == SUCCESS, "session_delete_by_id failed");
+    _request_make(&request, _tokens[20]);
+    TEST_CHECK(check_client_token(&request) != SUCCESS, "session deleted by id still accepted");
+    TEST_CHECK(_db_session_rows(_tokens[20]) == 0, "session deleted by id still in sqlite");
+
+    // the lowest free id is reused
+    TEST_CHECK(session_add("admin", token, &id) == SUCCESS && id == _ids[10], "new session got id %d, expected %d",
+               id, _ids[10]);
+    TEST_CHECK(_db_session_rows(token) == 1, "new session not in sqlite");
+    snprintf(_tokens[10], sizeof(_tokens[10]), "%s", token);
+}
+
+static void _test_expiry(void)
+{
+    http_request_t request;
+    const char *token = _tokens[30];
+
+    // age one session past its expiry; the next lookup pops it off the heap
+    pthread_mutex_lock(&auth_mutex);
+    session_entry_t *entry = session_cache_find(token);
+    TEST_CHECK(entry != NULL, "session not cached");
+    if (entry != NULL) {
+        entry->expiry = time(NULL) - 1;
+        session_heap_sift_up(entry->heap_index);
+    }
+    pthread_mutex_unlock(&auth_mutex);
+
+    _request_make(&request, token);
+    TEST_CHECK(check_client_token(&request) != SUCCESS, "expired session accepted");
+    TEST_CHECK(_db_session_rows(token) == 0, "expired session still in sqlite");
+    TEST_CHECK(session_count_get() == SESSION_NUM - 2, "session count %d after expiry", session_count_get());
+}
+
+// A restart: the cache is filled again from the sessions table
+static void _test_reload(void)
+{
+    http_request_t request;
+
+    pthread_mutex_lock(&auth_mutex);
+    while (session_heap_size > 0) {
+        session_cache_remove(session_heap[0]);
+    }
+    session_cache_loaded = false;
+    pthread_mutex_unlock(&auth_mutex);
+
+    _request_make(&request, _tokens[500]);
+    TEST_CHECK(check_client_token(&request) == SUCCESS, "session lost across reload");
+    TEST_CHECK(session_heap_size == (size_t)(SESSION_NUM - 2), "%zu sessions reloaded", session_heap_size);
+}
+
+int main(void)
+{
+    unlink(CONFIG_REDFISH_ACCOUNT_DB_PATH);
+    TEST_CHECK(db_init() == SUCCESS, "db_init failed");
+
+    _test_sessions_create();
+    _test_throughput();
+    _test_write_through();
+    _test_expiry();
+    _test_reload();
+
+    unlink(CONFIG_REDFISH_ACCOUNT_DB_PATH);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,350 @@
+// TLS handshake and throughput benchmark over loopback
+//
+// Brings up the server side with tls_server_init() and the certificates in
+// redfish_certification/, exactly as the Redfish server configures it, and
+// drives it from an mbedTLS client in the same process. For every cipher
+// suite the server offers it reports full handshakes per second, resumed
+// handshakes per second (session ticket, falling back to the session-ID
+// cache) and bulk application-data throughput. Every resumed handshake is
+// checked against the session it offered; the run fails when the server
+// answered one with a full handshake instead.
+//
+//   ./redfish_tls_bench [port] [handshakes] [megabytes]
+//
+// Run from the redfish directory so the certificate paths resolve.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "config.h"
+#include "redfish_client_info_handle.h"
+#include "tls_server.h"
+
+#define TLS_BENCH_DEFAULT_PORT 18443
+#define TLS_BENCH_DEFAULT_HANDSHAKES 50
+#define TLS_BENCH_DEFAULT_MEGABYTES 16
+#define TLS_BENCH_CHUNK_SIZE 16384
+
+// Suites the server offers, in its preference order (see tls_server.c)
+static const int _bench_suites[] = {
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_CBC_SHA,
+};
+
+typedef struct {
+    mbedtls_ssl_config conf;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    int suite[2];
+} bench_client_t;
+
+static tls_server_context_t _server;
+static int _port = TLS_BENCH_DEFAULT_PORT;
+static volatile int _server_running = 1;
+
+// The certificate store and security policy live in the Redfish database;
+// report them missing so tls_server_init() loads the files and verifies
+// client certificates optionally.
+int system_certificate_load_pem(char *pem_out, size_t pem_out_size) {
+    (void)pem_out; (void)pem_out_size;
+    return -1;
+}
+
+int system_private_key_load_pem(char *pem_out, size_t pem_out_size) {
+    (void)pem_out; (void)pem_out_size;
+    return -1;
+}
+
+int system_root_certificate_load_pem(char *pem_out, size_t pem_out_size) {
+    (void)pem_out; (void)pem_out_size;
+    return -1;
+}
+
+int security_policy_get(const char *manager_id, security_policy_t *out_policy) {
+    (void)manager_id; (void)out_policy;
+    return -1;
+}
+
+int handle_client_connection(int client_fd) {
+    close(client_fd);
+    return SUCCESS;
+}
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Server side of one connection: handshake, then drain application data
+// until the client closes.
+static void *_server_thread(void *arg) {
+    (void)arg;
+    unsigned char *buffer = malloc(TLS_BENCH_CHUNK_SIZE);
+
+    while (_server_running) {
+        int fd = accept(_server.server_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+
+        mbedtls_ssl_context ssl;
+        mbedtls_net_context net;
+        net.fd = fd;
+
+        if (tls_server_setup_ssl(&_server, &ssl, &net) == SUCCESS &&
+            mbedtls_ssl_handshake(&ssl) == 0) {
+            while (mbedtls_ssl_read(&ssl, buffer, TLS_BENCH_CHUNK_SIZE) > 0) {
+            }
+        }
+
+        mbedtls_ssl_close_notify(&ssl);
+        mbedtls_ssl_free(&ssl);
+        close(fd);
+    }
+
+    free(buffer);
+    return NULL;
+}
+
+static int _client_init(bench_client_t *client, int suite) {
+    mbedtls_ssl_config_init(&client->conf);
+    mbedtls_entropy_init(&client->entropy);
+    mbedtls_ctr_drbg_init(&client->ctr_drbg);
+
+    if (mbedtls_ctr_drbg_seed(&client->ctr_drbg, mbedtls_entropy_func, &client->entropy,
+                              (const unsigned char *)"RedfishBench", 12) != 0 ||
+        mbedtls_ssl_config_defaults(&client->conf, MBEDTLS_SSL_IS_CLIENT,
+                                    MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+        return ERROR_TLS;
+    }
+
+    client->suite[0] = suite;
+    client->suite[1] = 0;
+    mbedtls_ssl_conf_ciphersuites(&client->conf, client->suite);
+    mbedtls_ssl_conf_authmode(&client->conf, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_rng(&client->conf, mbedtls_ctr_drbg_random, &client->ctr_drbg);
+
+    return SUCCESS;
+}
+
+static void _client_free(bench_client_t *client) {
+    mbedtls_ssl_config_free(&client->conf);
+    mbedtls_ctr_drbg_free(&client->ctr_drbg);
+    mbedtls_entropy_free(&client->entropy);
+}
+
+static int _client_connect(bench_client_t *client, mbedtls_ssl_context *ssl, mbedtls_net_context *net,
+                           const mbedtls_ssl_session *session) {
+    struct sockaddr_in addr;
+    int one = 1;
+
+    mbedtls_net_init(net);
+    mbedtls_ssl_init(ssl);
+
+    net->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (net->fd < 0) {
+        return ERROR_NETWORK;
+    }
+    setsockopt(net->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(net->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        return ERROR_NETWORK;
+    }
+
+    if (mbedtls_ssl_setup(ssl, &client->conf) != 0) {
+        return ERROR_TLS;
+    }
+    mbedtls_ssl_set_bio(ssl, net, mbedtls_net_send, mbedtls_net_recv, NULL);
+    if (session != NULL && mbedtls_ssl_set_session(ssl, session) != 0) {
+        return ERROR_TLS;
+    }
+
+    int ret = mbedtls_ssl_handshake(ssl);
+    if (ret != 0) {
+        return ERROR_TLS;
+    }
+
+    return SUCCESS;
+}
+
+static void _client_close(mbedtls_ssl_context *ssl, mbedtls_net_context *net) {
+    unsigned char byte;
+
+    mbedtls_ssl_close_notify(ssl);
+    // wait for the server to finish reading before the next measurement
+    while (net->fd >= 0 && recv(net->fd, &byte, 1, 0) > 0) {
+    }
+    mbedtls_ssl_free(ssl);
+    mbedtls_net_free(net);
+}
+
+// Whether the handshake on ssl resumed the offered session. A resumption
+// keeps the master secret of the session, a full handshake derives a new
+// one. For the session-ID cache the server also echoes the ID; with a ticket
+// the client sends a fresh random ID, so the ticket stands in for it.
+static int _session_resumed(const mbedtls_ssl_context *ssl, const mbedtls_ssl_session *offered) {
+    const mbedtls_ssl_session *session = ssl->session;
+
+    if (session == NULL || memcmp(session->master, offered->master, sizeof(offered->master)) != 0) {
+        return 0;
+    }
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    if (offered->ticket != NULL && offered->ticket_len != 0) {
+        return 1;
+    }
+#endif
+    return session->id_len == offered->id_len && memcmp(session->id, offered->id, offered->id_len) == 0;
+}
+
+// Handshakes per second; with session != NULL every connection offers it
+// and the ones answered with a full handshake are counted in full_count
+static double _bench_handshakes(bench_client_t *client, int count, mbedtls_ssl_session *session, int *full_count) {
+    mbedtls_ssl_context ssl;
+    mbedtls_net_context net;
+    uint64_t start = _now_ns();
+
+    for (int i = 0; i < count; i++) {
+        if (_client_connect(client, &ssl, &net, session) != SUCCESS) {
+            _client_close(&ssl, &net);
+            return -1.0;
+        }
+        if (session != NULL) {
+            if (!_session_resumed(&ssl, session)) {
+                (*full_count)++;
+            }
+            // keep the newest ticket, as a browser would
+            mbedtls_ssl_session_free(session);
+            mbedtls_ssl_session_init(session);
+            mbedtls_ssl_get_session(&ssl, session);
+        }
+        _client_close(&ssl, &net);
+    }
+
+    return (double)count * 1e9 / (double)(_now_ns() - start);
+}
+
+// Application-data throughput in MB/s over one connection
+static double _bench_bulk(bench_client_t *client, int megabytes) {
+    mbedtls_ssl_context ssl;
+    mbedtls_net_context net;
+    unsigned char *chunk = calloc(1, TLS_BENCH_CHUNK_SIZE);
+    size_t total = (size_t)megabytes * 1024 * 1024;
+    double result = -1.0;
+
+    if (chunk == NULL) {
+        return -1.0;
+    }
+
+    if (_client_connect(client, &ssl, &net, NULL) == SUCCESS) {
+        uint64_t start = _now_ns();
+        size_t sent = 0;
+
+        while (sent < total) {
+            int ret = mbedtls_ssl_write(&ssl, chunk, TLS_BENCH_CHUNK_SIZE);
+            if (ret <= 0) {
+                break;
+            }
+            sent += (size_t)ret;
+        }
+        _client_close(&ssl, &net);
+
+        if (sent >= total) {
+            result = (double)total / (1024.0 * 1024.0) * 1e9 / (double)(_now_ns() - start);
+        }
+    } else {
+        _client_close(&ssl, &net);
+    }
+
+    free(chunk);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    int handshakes = (argc > 2) ? atoi(argv[2]) : TLS_BENCH_DEFAULT_HANDSHAKES;
+    int megabytes = (argc > 3) ? atoi(argv[3]) : TLS_BENCH_DEFAULT_MEGABYTES;
+    pthread_t server_thread;
+    int ret = 0;
+
+    if (argc > 1) {
+        _port = atoi(argv[1]);
+    }
+    if (handshakes <= 0) {
+        handshakes = TLS_BENCH_DEFAULT_HANDSHAKES;
+    }
+    if (megabytes <= 0) {
+        megabytes = TLS_BENCH_DEFAULT_MEGABYTES;
+    }
+
+    if (tls_server_init(&_server, DEFAULT_CERT_FILE, DEFAULT_KEY_FILE, CLIENT_CA_FILE, _port) != SUCCESS) {
+        fprintf(stderr, "tls_server_init failed, run from the redfish directory\n");
+        return 1;
+    }
+    pthread_create(&server_thread, NULL, _server_thread, NULL);
+
+    printf("\n%-48s %12s %12s %10s\n", "cipher suite", "full hs/s", "resumed hs/s", "MB/s");
+
+    for (size_t i = 0; i < sizeof(_bench_suites) / sizeof(_bench_suites[0]); i++) {
+        const char *name = mbedtls_ssl_get_ciphersuite_name(_bench_suites[i]);
+        bench_client_t client;
+        mbedtls_ssl_session session;
+        mbedtls_ssl_context ssl;
+        mbedtls_net_context net;
+
+        if (_client_init(&client, _bench_suites[i]) != SUCCESS) {
+            _client_free(&client);
+            continue;
+        }
+
+        // one full handshake to learn whether the server key allows the suite
+        mbedtls_ssl_session_init(&session);
+        if (_client_connect(&client, &ssl, &net, NULL) != SUCCESS) {
+            _client_close(&ssl, &net);
+            printf("%-48s %12s\n", name, "not negotiated");
+            _client_free(&client);
+            continue;
+        }
+        mbedtls_ssl_get_session(&ssl, &session);
+        _client_close(&ssl, &net);
+
+        int fallbacks = 0;
+        double full = _bench_handshakes(&client, handshakes, NULL, NULL);
+        double resumed = _bench_handshakes(&client, handshakes, &session, &fallbacks);
+        double bulk = _bench_bulk(&client, megabytes);
+
+        printf("%-48s %12.1f %12.1f %10.1f\n", name, full, resumed, bulk);
+        if (fallbacks > 0) {
+            // the resumed column then measured full handshakes
+            printf("  %d of %d resumptions fell back to a full handshake\n", fallbacks, handshakes);
+            ret = 1;
+        }
+
+        mbedtls_ssl_session_free(&session);
+        _client_free(&client);
+    }
+
+    _server_running = 0;
+    // wakes the server thread out of accept()
+    shutdown(_server.server_fd, SHUT_RDWR);
+    pthread_join(server_thread, NULL);
+    tls_server_cleanup(&_server);
+
+    return ret;
+}
@@ -0,0 +1,457 @@
+// Fake HID transport for the host tests
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "dexatek/main_application/managers/hid_manager/hid_manager.h"
+#include "dexatek/main_application/managers/hid_manager/dk_modbus.h"
+#include "dexatek/main_application/managers/hid_manager/dk_modbus_gpio.h"
+#include "dexatek/main_application/managers/hid_manager/dk_modbus_cap_pwm.h"
+#include "dexatek/main_application/managers/hid_manager/dk_modbus_ad7124.h"
+#include "dexatek/main_application/managers/hid_manager/dk_modbus_setting.h"
+#include "dexatek/main_application/managers/hid_manager/dk_modbus_pwm.h"
+#include "dexatek/main_application/managers/hid_manager/dk_modbus_ad74416h.h"
+
+#include "fake_hid.h"
+
+// Request layout used between CModbus*Packet and hid_manager_write/read:
+// [0] slave id, [1] function code, [2..3] address, [4..5] count or value.
+// Responses: [0] slave id, [1] function code, [2] byte count, [3..] data.
+#define FAKE_PACKET_CONTENT 3
+#define FAKE_FC_WRITE_SINGLE 0x06
+
+fake_hid_board_t fake_hid_boards[HID_DEVICES_MAX];
+
+static fake_hid_counters_t _counters[HID_DEVICES_MAX];
+
+// Last response per port, the caller reads it back with hid_manager_read
+static uint8_t _response[HID_DEVICES_MAX][64];
+static int _response_ret[HID_DEVICES_MAX];
+
+static fake_hid_board_t *_board(uint16_t port)
+{
+    return port < HID_DEVICES_MAX ? &fake_hid_boards[port] : NULL;
+}
+
+static void _count(uint32_t *counter)
+{
+    __atomic_add_fetch(counter, 1, __ATOMIC_RELAXED);
+}
+
+// One USB round trip: count it, wait for the board, report whether it answered
+static int _transaction(uint16_t port)
+{
+    fake_hid_board_t *board = _board(port);
+
+    if (board == NULL) {
+        return FAIL;
+    }
+
+    _count(&_counters[port].transactions);
+
+    uint32_t latency_us = __atomic_load_n(&board->latency_us, __ATOMIC_RELAXED);
+    if (latency_us > 0) {
+        usleep(latency_us);
+    }
+
+    return (board->pid == 0 || __atomic_load_n(&board->fail, __ATOMIC_RELAXED)) ? FAIL : SUCCESS;
+}
+
+// A board helper's write/read pair: its read takes whatever reply is pending
+// on the port, so an RS485 reply not yet read back by its caller is lost
+static int _exchange(uint16_t port)
+{
+    int ret = _transaction(port);
+
+    if (port < HID_DEVICES_MAX) {
+        __atomic_store_n(&_response_ret[port], FAIL, __ATOMIC_RELAXED);
+    }
+
+    return ret;
+}
+
+void fake_hid_reset(void)
+{
+    memset(fake_hid_boards, 0, sizeof(fake_hid_boards));
+    memset(_counters, 0, sizeof(_counters));
+}
+
+void fake_hid_counters_get(uint16_t port, fake_hid_counters_t *counters)
+{
+    if (port >= HID_DEVICES_MAX) {
+        memset(counters, 0, sizeof(*counters));
+        return;
+    }
+
+    counters->transactions = __atomic_load_n(&_counters[port].transactions, __ATOMIC_RELAXED);
+    counters->baudrate_sets = __atomic_load_n(&_counters[port].baudrate_sets, __ATOMIC_RELAXED);
+    counters->rs485_reads = __atomic_load_n(&_counters[port].rs485_reads, __ATOMIC_RELAXED);
+    counters->rs485_registers = __atomic_load_n(&_counters[port].rs485_registers, __ATOMIC_RELAXED);
+    counters->mode_sets = __atomic_load_n(&_counters[port].mode_sets, __ATOMIC_RELAXED);
+    counters->mode_reads = __atomic_load_n(&_counters[port].mode_reads, __ATOMIC_RELAXED);
+}
+
+uint16_t fake_rs485_register(uint8_t slave_id, uint16_t address)
+{
+    return (uint16_t)(slave_id * 1000 + address);
+}
+
+/*
+ * hid_manager
+ */
+int hid_manager_init(void)
+{
+    return SUCCESS;
+}
+
+int hid_manager_deinit(void)
+{
+    return SUCCESS;
+}
+
+int hid_manager_port_pid_get(uint16_t port, uint16_t *pid)
+{
+    fake_hid_board_t *board = _board(port);
+
+    *pid = board ? __atomic_load_n(&board->pid, __ATOMIC_RELAXED) : 0;
+
+    return (*pid != 0) ? SUCCESS : FAIL;
+}
+
+int hid_manager_device_vid_get(uint16_t hid_pid, uint16_t hid_port, uint16_t *vid)
+{
+    (void)hid_pid;
+    *vid = 0x0483;
+    return _transaction(hid_port);
+}
+
+int hid_manager_device_pid_get(uint16_t hid_pid, uint16_t hid_port, uint16_t *pid)
+{
+    *pid = hid_pid;
+    return _transaction(hid_port);
+}
+
+int hid_manager_reset_usb_hub(void)
+{
+    return SUCCESS;
+}
+
+int hid_manager_write(uint16_t hid_pid, uint16_t hid_port, uint8_t *data, size_t length, int timeout_ms)
+{
+    (void)hid_pid;
+    (void)timeout_ms;
+
+    fake_hid_board_t *board = _board(hid_port);
+    if (board == NULL) {
+        return FAIL;
+    }
+
+    memcpy(board->request, data, length < sizeof(board->request) ? length : sizeof(board->request));
+
+    // the slave answers during the write, hid_manager_read only hands the reply back
+    uint8_t *req = board->request;
+    uint8_t *rsp = _response[hid_port];
+    uint8_t slave_id = req[0];
+    uint8_t function_code = req[1];
+    uint16_t address = (uint16_t)((req[2] << 8) | req[3]);
+    uint16_t count = (uint16_t)((req[4] << 8) | req[5]);
+
+    int ret = _transaction(hid_port);
+
+    memset(rsp, 0, 64);
+    if (ret == SUCCESS && slave_id < FAKE_RS485_SLAVES_MAX && (board->slave_mask & (1u << slave_id)) &&
+        (board->slave_baudrate[slave_id] == 0 || board->slave_baudrate[slave_id] == board->baudrate)) {
+        rsp[0] = slave_id;
+        rsp[1] = function_code;
+        if (function_code == FAKE_FC_WRITE_SINGLE) {
+            rsp[2] = 0;
+        } else {
+            if (count > (64 - FAKE_PACKET_CONTENT) / 2) {
+                count = (64 - FAKE_PACKET_CONTENT) / 2;
+            }
+            rsp[2] = (uint8_t)(count * 2);
+            for (uint16_t i = 0; i < count; i++) {
+                uint16_t value = fake_rs485_register(slave_id, (uint16_t)(address + i));
+                rsp[FAKE_PACKET_CONTENT + i * 2] = (uint8_t)(value >> 8);
+                rsp[FAKE_PACKET_CONTENT + i * 2 + 1] = (uint8_t)(value & 0xFF);
+            }
+            _count(&_counters[hid_port].rs485_reads);
+            __atomic_add_fetch(&_counters[hid_port].rs485_registers, count, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&_response_ret[hid_port], 64, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(&_response_ret[hid_port], FAIL, __ATOMIC_RELAXED);
+    }
+
+    return ret;
+}
+
+int hid_manager_read(uint16_t hid_pid, uint16_t hid_port, uint8_t *data, size_t length, int timeout_ms)
+{
+    (void)hid_pid;
+    (void)timeout_ms;
+
+    if (hid_port >= HID_DEVICES_MAX) {
+        return FAIL;
+    }
+
+    uint32_t reply_latency_us = __atomic_load_n(&fake_hid_boards[hid_port].reply_latency_us, __ATOMIC_RELAXED);
+    if (reply_latency_us > 0) {
+        usleep(reply_latency_us);
+    }
+
+    memcpy(data, _response[hid_port], length < 64 ? length : 64);
+
+    return __atomic_load_n(&_response_ret[hid_port], __ATOMIC_RELAXED);
+}
+
+/*
+ * dk_modbus packets
+ */
+int CModbusReadPacketEx(uint8_t *packet, uint8_t id, uint8_t function_code, uint16_t address, uint16_t count)
+{
+    memset(packet, 0, 64);
+    packet[0] = id;
+    packet[1] = function_code;
+    packet[2] = (uint8_t)(address >> 8);
+    packet[3] = (uint8_t)(address & 0xFF);
+    packet[4] = (uint8_t)(count >> 8);
+    packet[5] = (uint8_t)(count & 0xFF);
+    return 8;
+}
+
+int CModbusReadPacket(uint8_t *packet, uint8_t id, uint16_t address, uint16_t count)
+{
+    return CModbusReadPacketEx(packet, id, 0x03, address, count);
+}
+
+int CModbusWritePacket(uint8_t *packet, uint8_t id, uint16_t address, uint16_t value)
+{
+    return CModbusReadPacketEx(packet, id, FAKE_FC_WRITE_SINGLE, address, value);
+}
+
+uint8_t *CModbusReadContent(uint8_t *packet)
+{
+    return packet + FAKE_PACKET_CONTENT;
+}
+
+uint8_t CModbusReadLength(uint8_t *packet)
+{
+    return packet[2];
+}
+
+/*
+ * Board helpers, one HID round trip each
+ */
+int CModbusUartBaudrate(uint16_t hid_pid, uint16_t hid_port, int baudrate)
+{
+    (void)hid_pid;
+
+    int ret = _exchange(hid_port);
+    if (hid_port < HID_DEVICES_MAX) {
+        _count(&_counters[hid_port].baudrate_sets);
+        if (ret == SUCCESS) {
+            fake_hid_boards[hid_port].baudrate = (uint32_t)baudrate;
+        }
+    }
+    return ret;
+}
+
+int CModbusGPIOStatus(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t count, uint16_t *status)
+{
+    (void)hid_pid;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        fake_hid_board_t *board = _board(hid_port);
+        const uint16_t *src = (hid_address >= DK_MODBUS_GPIO_INPUT_0) ? board->di : board->do_;
+        uint16_t first = (uint16_t)(hid_address & 0x7);
+        for (uint16_t i = 0; i < count && first + i < 8; i++) {
+            status[i] = __atomic_load_n(&src[first + i], __ATOMIC_RELAXED);
+        }
+    }
+    return ret;
+}
+
+int CModbusGPIOOutput(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t value, uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)timeout_ms;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        fake_hid_boards[hid_port].do_[hid_address & 0x7] = value;
+    }
+    return ret;
+}
+
+int CModbusGPIOOutputAll(uint16_t hid_pid, uint16_t hid_port, uint16_t s0, uint16_t s1, uint16_t s2, uint16_t s3,
+                         uint16_t s4, uint16_t s5, uint16_t s6, uint16_t s7)
+{
+    (void)hid_pid;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        uint16_t s[8] = { s0, s1, s2, s3, s4, s5, s6, s7 };
+        memcpy(fake_hid_boards[hid_port].do_, s, sizeof(s));
+    }
+    return ret;
+}
+
+int CModbusAD74416hGetInput(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t count,
+                            int32_t *inputValue, uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)hid_address;
+    (void)timeout_ms;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        for (uint16_t i = 0; i < count && i < 4; i++) {
+            inputValue[i] = __atomic_load_n(&fake_hid_boards[hid_port].ai[i], __ATOMIC_RELAXED);
+        }
+    }
+    return ret;
+}
+
+int CModbusAD74416hSetMode(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t value,
+                           uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)timeout_ms;
+
+    int ret = _exchange(hid_port);
+    if (hid_port < HID_DEVICES_MAX) {
+        _count(&_counters[hid_port].mode_sets);
+        if (ret == SUCCESS) {
+            fake_hid_boards[hid_port].ai_mode[(hid_address - DK_MODBUS_AD74416H_SET_MODE_CH_A) & 0x3] = value;
+        }
+    }
+    return ret;
+}
+
+int CModbusAD74416hGetMode(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t count,
+                           uint16_t *mode, uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)hid_address;
+    (void)timeout_ms;
+
+    int ret = _exchange(hid_port);
+    if (hid_port < HID_DEVICES_MAX) {
+        _count(&_counters[hid_port].mode_reads);
+        if (ret == SUCCESS) {
+            for (uint16_t i = 0; i < count && i < 4; i++) {
+                mode[i] = fake_hid_boards[hid_port].ai_mode[i];
+            }
+        }
+    }
+    return ret;
+}
+
+int CModbusAD74416hVoltageOutput(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, int32_t voltage,
+                                 uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)hid_address;
+    (void)voltage;
+    (void)timeout_ms;
+
+    return _exchange(hid_port);
+}
+
+int CModbusAD74416hCurrentOutput(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, int32_t current,
+                                 uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)hid_address;
+    (void)current;
+    (void)timeout_ms;
+
+    return _exchange(hid_port);
+}
+
+int CModbusAD7124GetResistance(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t count,
+                               uint32_t *resistance, uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)hid_address;
+    (void)timeout_ms;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        for (uint16_t i = 0; i < count && i < 8; i++) {
+            resistance[i] = __atomic_load_n(&fake_hid_boards[hid_port].rtd[i], __ATOMIC_RELAXED);
+        }
+    }
+    return ret;
+}
+
+int CModbusCapPWMFrequency(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t count,
+                           uint32_t *frequency, uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)hid_address;
+    (void)timeout_ms;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        for (uint16_t i = 0; i < count && i < 8; i++) {
+            frequency[i] = __atomic_load_n(&fake_hid_boards[hid_port].pwm_freq[i], __ATOMIC_RELAXED);
+        }
+    }
+    return ret;
+}
+
+int CModbusCapPWMPulseWidth(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t count,
+                            uint32_t *pulseWidth)
+{
+    (void)hid_pid;
+    (void)hid_address;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        for (uint16_t i = 0; i < count && i < 8; i++) {
+            pulseWidth[i] = 0;
+        }
+    }
+    return ret;
+}
+
+int CModbusPWMOutputSetFrequency(uint16_t hid_pid, uint16_t hid_port, uint32_t frequency)
+{
+    (void)hid_pid;
+    (void)frequency;
+
+    return _exchange(hid_port);
+}
+
+int CModbusPWMOutputSetDuty(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t duty)
+{
+    (void)hid_pid;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        fake_hid_boards[hid_port].pwm_duty[hid_address & 0x7] = duty;
+    }
+    return ret;
+}
+
+int CModbusPWMOutputGetDuty(uint16_t hid_pid, uint16_t hid_port, uint16_t hid_address, uint16_t count,
+                            uint16_t *duty, uint16_t timeout_ms)
+{
+    (void)hid_pid;
+    (void)hid_address;
+    (void)timeout_ms;
+
+    int ret = _exchange(hid_port);
+    if (ret == SUCCESS) {
+        for (uint16_t i = 0; i < count && i < 8; i++) {
+            duty[i] = fake_hid_boards[hid_port].pwm_duty[i];
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,55 @@
+// Fake HID transport for the host tests
+//
+// Replaces hid_manager_* and the CModbus* board helpers with an in-memory
+// model of the IO (0xA2) and RTD (0xA3) boards plus the RS485 slaves behind
+// each RTD board. Every call that would be a USB round trip on the target
+// counts as one transaction and sleeps for the port's configured latency.
+
+#ifndef FAKE_HID_H
+#define FAKE_HID_H
+
+#include <stdint.h>
+
+#include "dexatek/main_application/managers/hid_manager/hid_manager.h"
+
+#define FAKE_RS485_SLAVES_MAX 32
+
+typedef struct {
+    uint16_t pid;                   // 0 = nothing plugged in
+    uint32_t latency_us;            // added to every transaction
+    uint32_t reply_latency_us;      // hid_manager_read waits this long for the RS485 reply
+    int fail;                       // every transaction times out after latency_us
+    uint16_t di[8];
+    uint16_t do_[8];
+    int32_t ai[4];                  // uA or mV depending on mode
+    uint16_t ai_mode[4];
+    uint32_t rtd[8];                // 0.01 ohm
+    uint32_t pwm_freq[8];
+    uint16_t pwm_duty[8];
+    uint32_t baudrate;              // last baud rate applied to the RS485 bridge
+    uint32_t slave_mask;            // RS485 slave ids that answer (bit = id)
+    uint32_t slave_baudrate[FAKE_RS485_SLAVES_MAX]; // 0 = any, otherwise the slave only answers at this rate
+    uint8_t request[64];            // last packet written with hid_manager_write
+} fake_hid_board_t;
+
+typedef struct {
+    uint32_t transactions;          // every HID round trip
+    uint32_t baudrate_sets;         // CModbusUartBaudrate
+    uint32_t rs485_reads;           // RS485 read requests
+    uint32_t rs485_registers;       // registers returned by RS485 reads
+    uint32_t mode_sets;             // CModbusAD74416hSetMode
+    uint32_t mode_reads;            // CModbusAD74416hGetMode
+} fake_hid_counters_t;
+
+extern fake_hid_board_t fake_hid_boards[HID_DEVICES_MAX];
+
+// Clear boards and counters
+void fake_hid_reset(void);
+
+// Snapshot the counters of one port
+void fake_hid_counters_get(uint16_t port, fake_hid_counters_t *counters);
+
+// Value an RS485 slave returns for a register
+uint16_t fake_rs485_register(uint8_t slave_id, uint16_t address);
+
+#endif /* FAKE_HID_H */
@@ -0,0 +1,102 @@
+// Host replacements for the libdexatek platform and modbus_manager functions
+
+#include <modbus.h>
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "dexatek/main_application/managers/modbus_manager/modbus_manager.h"
+
+#include "fake_platform.h"
+
+int test_failures = 0;
+
+static uint16_t _tab_registers[MODBUS_RO_REGISTERS];
+
+static modbus_mapping_t _mapping = {
+    .nb_registers = MODBUS_RO_REGISTERS,
+    .start_registers = 0,
+    .tab_registers = _tab_registers,
+};
+
+static modbus_update_callback_t _update_callback = NULL;
+
+static uint32_t _mapping_save_count = 0;
+
+/*
+ * os_utilities
+ */
+int time_delay_ms(const uint32_t xMSToDelay)
+{
+    return usleep(xMSToDelay * 1000);
+}
+
+uint64_t time_get_current_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+uint32_t time32_get_current_ms(void)
+{
+    return (uint32_t)time_get_current_ms();
+}
+
+char *time_get_current_date_string_r(char *buf, size_t sz)
+{
+    snprintf(buf, sz, "%llu", (unsigned long long)time_get_current_ms());
+    return buf;
+}
+
+/*
+ * platform_malloc
+ */
+void *platform_slow_calloc(int num, int size)
+{
+    return calloc((size_t)num, (size_t)size);
+}
+
+void platform_slow_free(void *mem)
+{
+    free(mem);
+}
+
+/*
+ * modbus_manager
+ */
+modbus_mapping_t *modbus_manager_data_mapping_get(void)
+{
+    return &_mapping;
+}
+
+void modbus_manager_update_callback_setup(modbus_update_callback_t callback)
+{
+    _update_callback = callback;
+}
+
+int modbus_manager_data_mapping_save(void)
+{
+    __atomic_add_fetch(&_mapping_save_count, 1, __ATOMIC_RELAXED);
+    return SUCCESS;
+}
+
+modbus_update_callback_t fake_modbus_manager_callback_get(void)
+{
+    return _update_callback;
+}
+
+uint32_t fake_modbus_manager_save_count_get(void)
+{
+    return __atomic_load_n(&_mapping_save_count, __ATOMIC_RELAXED);
+}
+
+uint64_t fake_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,39 @@
+// Host replacements for the libdexatek platform and modbus_manager functions
+
+#ifndef FAKE_PLATFORM_H
+#define FAKE_PLATFORM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "dexatek/main_application/managers/modbus_manager/modbus_manager.h"
+
+// Callback registered with modbus_manager_update_callback_setup()
+modbus_update_callback_t fake_modbus_manager_callback_get(void);
+
+// Calls to modbus_manager_data_mapping_save()
+uint32_t fake_modbus_manager_save_count_get(void);
+
+// Monotonic clock for measurements
+uint64_t fake_now_ns(void);
+
+// Minimal assertion helpers shared by the tests
+extern int test_failures;
+
+#define TEST_CHECK(cond, ...)                                   \
+    do {                                                        \
+        if (!(cond)) {                                          \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);                       \
+            fprintf(stderr, "\n");                              \
+            test_failures++;                                    \
+        }                                                       \
+    } while (0)
+
+// Results go to stderr so they stay readable next to the application log on stdout
+#define TEST_REPORT(...) fprintf(stderr, __VA_ARGS__)
+
+#define TEST_RESULT()                                                                   \
+    (test_failures == 0 ? (TEST_REPORT("PASS\n"), 0) : (TEST_REPORT("FAIL (%d)\n", test_failures), 1))
+
+#endif /* FAKE_PLATFORM_H */
@@ -0,0 +1,172 @@
+// AD74416H mode cache: an IO board refresh no longer reads the channel modes
+// every cycle, analog output writes no longer re-send an unchanged mode, and
+// the cache is still re-read when the board is unplugged and replugged, when
+// a write fails, or when the audit interval has passed (catching a mode that
+// changed behind the cache).
+
+#include "../control_logic/control_logic_update.c"
+
+#include "kenmec/main_application/control_logic/control_logic_common.h"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define IO_PORT 0
+#define CYCLES 20
+#define WRITES 20
+#define AUDIT_MS 50
+#define AUDIT_WINDOW_MS 300
+
+typedef struct {
+    uint32_t read;
+    uint32_t hit;
+    uint32_t set;
+    uint32_t skip;
+} mode_stats_t;
+
+static void _stats_get(mode_stats_t *stats)
+{
+    control_hardware_analog_mode_stats_get(&stats->read, &stats->hit, &stats->set, &stats->skip);
+}
+
+static void _board_plug(void)
+{
+    fake_hid_reset();
+    fake_hid_boards[IO_PORT].pid = HID_IO_BOARD_PID;
+    control_hardware_analog_mode_invalidate(IO_PORT);
+}
+
+static void _test_refresh_cycle(void)
+{
+    fake_hid_counters_t first;
+    fake_hid_counters_t last;
+    mode_stats_t before;
+    mode_stats_t after;
+
+    _board_plug();
+    _stats_get(&before);
+
+    // first cycle fills the cache: DI, DO, mode, AI voltage, AI current
+    TEST_CHECK(_port_io_board_update(IO_PORT) == SUCCESS, "first cycle failed");
+    fake_hid_counters_get(IO_PORT, &first);
+
+    for (int i = 0; i < CYCLES; i++) {
+        _port_io_board_update(IO_PORT);
+    }
+    fake_hid_counters_get(IO_PORT, &last);
+    _stats_get(&after);
+
+    double per_cycle = (double)(last.transactions - first.transactions) / CYCLES;
+    TEST_REPORT("IO board refresh: %u HID transactions on the first cycle, %.1f per cycle after\n",
+                first.transactions, per_cycle);
+    TEST_CHECK(first.transactions == 5, "first cycle: %u transactions", first.transactions);
+    TEST_CHECK(last.transactions - first.transactions == 4 * CYCLES, "%u transactions in %d cycles",
+               last.transactions - first.transactions, CYCLES);
+    TEST_CHECK(last.mode_reads == 1, "mode read %u times", last.mode_reads);
+    TEST_CHECK(after.read - before.read == 1 && after.hit - before.hit == CYCLES, "stats: %u reads, %u hits",
+               after.read - before.read, after.hit - before.hit);
+}
+
+static void _test_output_writes(void)
+{
+    uint32_t current = 400000 + HID_BASE_ADDRESS + (IO_PORT * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_AD74416H_CH_A_CURRENT_OUTPUT;
+    uint32_t voltage = 400000 + HID_BASE_ADDRESS + (IO_PORT * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_AD74416H_CH_A_VOLTAGE_OUTPUT_V;
+    fake_hid_counters_t counters;
+    mode_stats_t before;
+    mode_stats_t after;
+
+    _board_plug();
+    _stats_get(&before);
+
+    for (int i = 0; i < WRITES; i++) {
+        TEST_CHECK(control_logic_write_register(current, (uint16_t)(1000 + i), 100) == SUCCESS, "write %d failed", i);
+    }
+    fake_hid_counters_get(IO_PORT, &counters);
+    _stats_get(&after);
+
+    TEST_REPORT("%d current output writes: %u HID transactions, %u mode sets\n", WRITES, counters.transactions,
+                counters.mode_sets);
+    TEST_CHECK(counters.mode_sets == 1, "mode set %u times", counters.mode_sets);
+    TEST_CHECK(counters.transactions == WRITES + 1, "%u transactions", counters.transactions);
+    TEST_CHECK(after.skip - before.skip == WRITES - 1, "%u sets skipped", after.skip - before.skip);
+    TEST_CHECK(fake_hid_boards[IO_PORT].ai_mode[0] == AI_AO_MODE_CURRENT_OUT, "board mode %u",
+               fake_hid_boards[IO_PORT].ai_mode[0]);
+
+    // switching the channel to voltage output is sent once, then skipped again
+    control_logic_write_register(voltage, 500, 100);
+    control_logic_write_register(voltage, 600, 100);
+    fake_hid_counters_get(IO_PORT, &counters);
+    TEST_CHECK(counters.mode_sets == 2 && fake_hid_boards[IO_PORT].ai_mode[0] == AI_AO_MODE_VOLTAGE_OUT,
+               "mode change: %u sets, board mode %u", counters.mode_sets, fake_hid_boards[IO_PORT].ai_mode[0]);
+
+    // a failed write may mean the board reset: the next write re-sends the mode
+    fake_hid_boards[IO_PORT].fail = 1;
+    control_logic_write_register(voltage, 700, 100);
+    fake_hid_boards[IO_PORT].fail = 0;
+    fake_hid_counters_get(IO_PORT, &counters);
+    uint32_t sets = counters.mode_sets;
+    control_logic_write_register(voltage, 700, 100);
+    fake_hid_counters_get(IO_PORT, &counters);
+    TEST_CHECK(counters.mode_sets == sets + 1, "mode not re-sent after a failed write");
+}
+
+static void _test_reconnect(void)
+{
+    port_poller_t poller = { .port = IO_PORT };
+    fake_hid_counters_t counters;
+
+    _board_plug();
+    _port_io_board_update(IO_PORT);
+    _port_io_board_update(IO_PORT);
+
+    // the poller sees the port empty, then the board comes back
+    fake_hid_boards[IO_PORT].pid = 0;
+    _port_poller_cycle(&poller);
+    fake_hid_boards[IO_PORT].pid = HID_IO_BOARD_PID;
+    fake_hid_boards[IO_PORT].ai_mode[2] = AI_AO_MODE_VOLTAGE_IN;
+    _port_io_board_update(IO_PORT);
+
+    uint16_t mode = 0;
+    uint16_t address = HID_BASE_ADDRESS + (IO_PORT * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_AD74416H_CH_A_SET_MODE + 2;
+    control_logic_load_from_modbus_table(address, MODBUS_TYPE_UINT16, &mode);
+    fake_hid_counters_get(IO_PORT, &counters);
+    TEST_CHECK(counters.mode_reads == 2, "reconnect: mode read %u times", counters.mode_reads);
+    TEST_CHECK(mode == AI_AO_MODE_VOLTAGE_IN, "reconnect: table has mode %u", mode);
+}
+
+static void _test_audit(void)
+{
+    fake_hid_counters_t counters;
+    uint16_t mode[4];
+    int calls = 0;
+
+    _board_plug();
+
+    uint64_t start = time_get_current_ms();
+    while (time_get_current_ms() - start < AUDIT_WINDOW_MS) {
+        TEST_CHECK(control_hardware_analog_mode_all_get_cached(IO_PORT, mode, AUDIT_MS, 100) == SUCCESS, "get failed");
+        calls++;
+        if (calls == 10) {
+            // changed behind the cache, e.g. by a board reset: only the audit notices
+            fake_hid_boards[IO_PORT].ai_mode[1] = AI_AO_MODE_CURRENT_IN_LOOP;
+        }
+        time_delay_ms(5);
+    }
+    fake_hid_counters_get(IO_PORT, &counters);
+
+    TEST_REPORT("audit every %d ms: %u mode reads for %d lookups in %d ms\n", AUDIT_MS, counters.mode_reads, calls,
+                AUDIT_WINDOW_MS);
+    TEST_CHECK(counters.mode_reads >= AUDIT_WINDOW_MS / AUDIT_MS - 1 && counters.mode_reads <= AUDIT_WINDOW_MS / AUDIT_MS + 1,
+               "%u audit reads", counters.mode_reads);
+    TEST_CHECK(mode[1] == AI_AO_MODE_CURRENT_IN_LOOP, "audit missed the change: mode %u", mode[1]);
+}
+
+int main(void)
+{
+    _test_refresh_cycle();
+    _test_output_writes();
+    _test_reconnect();
+    _test_audit();
+
+    return TEST_RESULT();
+}
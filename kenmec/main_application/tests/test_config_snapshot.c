@@ -0,0 +1,190 @@
+// Config snapshots: the Modbus device configs are replaced 1000 times per
+// second while 9 reader threads iterate over them the way the update loop
+// and the Redfish config endpoint do. Every read section must see one whole
+// snapshot, retired snapshots must be freed once the readers have moved on,
+// and the test must stay clean under ThreadSanitizer (make tsan).
+
+#include "../control_logic/control_logic_config.c"
+
+#include "fake_platform.h"
+
+#define READER_NUM 9
+#define SWAP_HZ 1000
+#define RUN_MS 2000
+#define GENERATION_NUM 64
+
+typedef struct {
+    pthread_t thread;
+    uint64_t sections;
+    uint64_t items;
+    uint32_t torn;          // sections that saw entries from two snapshots
+    uint32_t versions;      // distinct snapshot versions seen
+} reader_t;
+
+static char *_json[GENERATION_NUM];
+static bool _running;
+
+// Generation g has 32 + g configs, all named "g<g>" with slave id g
+static char *_configs_json(int generation)
+{
+    cJSON *root = cJSON_CreateArray();
+    char name[16];
+
+    snprintf(name, sizeof(name), "g%d", generation);
+    for (int i = 0; i < 32 + generation; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "board", 0);
+        cJSON_AddNumberToObject(item, "baudrate", 9600);
+        cJSON_AddNumberToObject(item, "slave_id", generation);
+        cJSON_AddNumberToObject(item, "code", MODBUS_FUNC_WRITE_SINGLE_REGISTER);
+        cJSON_AddNumberToObject(item, "address", i);
+        cJSON_AddNumberToObject(item, "data_type", 0);
+        cJSON_AddNumberToObject(item, "update_address", 1000 + i);
+        cJSON_AddStringToObject(item, "name", name);
+        cJSON_AddItemToArray(root, item);
+    }
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+
+    return json;
+}
+
+static void *_reader_thread(void *arg)
+{
+    reader_t *reader = (reader_t *)arg;
+    uint32_t last_version = 0;
+
+    while (__atomic_load_n(&_running, __ATOMIC_ACQUIRE)) {
+        int count = 0;
+
+        control_logic_config_read_lock();
+
+        modbus_device_config_t *configs = control_logic_modbus_device_configs_get(&count);
+        if (configs != NULL && count > 0) {
+            int generation = configs[0].slave_id;
+            char name[16];
+            bool torn = (count != 32 + generation);
+
+            snprintf(name, sizeof(name), "g%d", generation);
+            for (int i = 0; i < count; i++) {
+                if (configs[i].slave_id != generation || strcmp(configs[i].name, name) != 0) {
+                    torn = true;
+                }
+            }
+            // nested lookup through the write index; it may already see a newer snapshot
+            modbus_device_config_t found;
+            char found_name[16];
+            if (control_logic_modbus_device_write_config_find(1000 + count - 1, &found) == SUCCESS) {
+                snprintf(found_name, sizeof(found_name), "g%d", found.slave_id);
+                if (found.update_address != 1000 + count - 1 || strcmp(found.name, found_name) != 0) {
+                    torn = true;
+                }
+            }
+
+            reader->torn += torn;
+            reader->items += (uint64_t)count;
+        }
+
+        control_logic_config_read_unlock();
+
+        uint32_t version = control_logic_config_version_get();
+        if (version != last_version) {
+            reader->versions++;
+            last_version = version;
+        }
+        reader->sections++;
+
+        // readers poll like the update loop does instead of spinning, so a
+        // single-core host still has room for the writer
+        usleep(100);
+    }
+
+    return NULL;
+}
+
+static int _retired_count(void)
+{
+    int count = 0;
+
+    pthread_mutex_lock(&_config_writer_mutex);
+    for (config_snapshot_t *snapshot = _config_retired; snapshot != NULL; snapshot = snapshot->next_retired) {
+        count++;
+    }
+    pthread_mutex_unlock(&_config_writer_mutex);
+
+    return count;
+}
+
+int main(void)
+{
+    reader_t readers[READER_NUM];
+    struct timespec next;
+    int swaps = 0;
+    int swap_failures = 0;
+    int retired_max = 0;
+
+    for (int g = 0; g < GENERATION_NUM; g++) {
+        _json[g] = _configs_json(g + 1);
+    }
+    TEST_CHECK(_modbus_device_configs_load_from_string(_json[0]) == SUCCESS, "initial load failed");
+
+    memset(readers, 0, sizeof(readers));
+    __atomic_store_n(&_running, true, __ATOMIC_RELEASE);
+    for (int i = 0; i < READER_NUM; i++) {
+        pthread_create(&readers[i].thread, NULL, _reader_thread, &readers[i]);
+    }
+
+    // swap on an absolute 1 ms grid
+    uint64_t start = fake_now_ns();
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (swaps < SWAP_HZ * RUN_MS / 1000) {
+        if (_modbus_device_configs_load_from_string(_json[++swaps % GENERATION_NUM]) != SUCCESS) {
+            swap_failures++;
+        }
+        int retired = _retired_count();
+        if (retired > retired_max) {
+            retired_max = retired;
+        }
+
+        next.tv_nsec += 1000000000L / SWAP_HZ;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    double seconds = (double)(fake_now_ns() - start) / 1e9;
+
+    __atomic_store_n(&_running, false, __ATOMIC_RELEASE);
+
+    uint64_t sections = 0;
+    uint64_t items = 0;
+    uint32_t torn = 0;
+    for (int i = 0; i < READER_NUM; i++) {
+        pthread_join(readers[i].thread, NULL);
+        sections += readers[i].sections;
+        items += readers[i].items;
+        torn += readers[i].torn;
+        TEST_CHECK(readers[i].versions > 1, "reader %d saw %u snapshot versions", i, readers[i].versions);
+    }
+
+    // no reader left: the next publish frees every retired snapshot
+    TEST_CHECK(_modbus_device_configs_load_from_string(_json[0]) == SUCCESS, "final load failed");
+    int retired_after = _retired_count();
+
+    TEST_CHECK(swap_failures == 0, "%d swaps failed", swap_failures);
+    TEST_CHECK(torn == 0, "%u read sections saw a mixed or freed snapshot", torn);
+    TEST_CHECK(retired_after == 0, "%d snapshots still retired with no readers", retired_after);
+    TEST_CHECK(retired_max < 64, "up to %d retired snapshots waiting for readers", retired_max);
+
+    TEST_REPORT("%d swaps in %.2f s (%.0f/s), %d readers: %llu read sections, %llu configs read, %u torn\n", swaps,
+                seconds, swaps / seconds, READER_NUM, (unsigned long long)sections, (unsigned long long)items, torn);
+    TEST_REPORT("retired snapshots waiting: max %d, %d after the readers stopped\n", retired_max, retired_after);
+
+    for (int g = 0; g < GENERATION_NUM; g++) {
+        free(_json[g]);
+    }
+
+    return TEST_RESULT();
+}
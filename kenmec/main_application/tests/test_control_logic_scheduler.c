@@ -0,0 +1,384 @@
+// Control logic scheduler: two logics stuck in a 2000 ms HID write timeout
+// must not hold up the others, which keep running every period with small
+// jitter while the stalled ones are counted as overruns.
+//
+// New sensor data runs a logic that is close to its due time early, once, and
+// switching the logic functions between stop and start (what
+// control_logic_manager_reinit() does on a machine type change) never calls
+// the old function after stop returns. Start and stop called from several
+// threads at once (Redfish PATCH against the manager) never join a worker
+// twice or close the epoll fd under a running scheduler.
+//
+// Cost: threads, CPU time and context switches of the scheduler against the
+// loop it replaced, one thread per logic polling its own timestamp.
+
+#include <sys/resource.h>
+
+#include "../control_logic/control_logic_manager.c"
+
+#include "fake_platform.h"
+
+#define PERIOD_MS 100
+#define STALL_MS 2000
+#define RUN_MS 1000
+#define STALLED_NUM 2
+
+// CPU time the scheduler may use over the thread-per-logic loop, beyond twice its cost
+#define CPU_SLACK_US 1000
+
+// early wake: a long period so "close to due" is well inside the window
+#define EARLY_PERIOD_MS 1000
+#define EARLY_NOTIFY_MS (EARLY_PERIOD_MS - CONTROL_LOGIC_EARLY_WAKE_MS / 2)
+
+static int _runs[CONTROL_LOGIC_NUM];
+static int _switched_runs[CONTROL_LOGIC_NUM];
+static volatile int _switched_out = 0;
+static int _calls_after_switch = 0;
+
+typedef struct {
+    int threads;
+    uint64_t cpu_us;
+    uint64_t context_switches;
+    int runs;
+} cost_t;
+
+static int _logic_index(ControlLogic *logic)
+{
+    return (int)(logic - CONTROL_LOGIC_ARRAY);
+}
+
+// a write to a board that does not answer blocks until the HID timeout
+static int _stalled_logic(ControlLogic *logic)
+{
+    __atomic_add_fetch(&_runs[_logic_index(logic)], 1, __ATOMIC_RELAXED);
+    usleep(STALL_MS * 1000);
+
+    return SUCCESS;
+}
+
+static int _quick_logic(ControlLogic *logic)
+{
+    __atomic_add_fetch(&_runs[_logic_index(logic)], 1, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&_switched_out, __ATOMIC_RELAXED)) {
+        __atomic_add_fetch(&_calls_after_switch, 1, __ATOMIC_RELAXED);
+    }
+    usleep(1000);
+
+    return SUCCESS;
+}
+
+static int _switched_logic(ControlLogic *logic)
+{
+    __atomic_add_fetch(&_switched_runs[_logic_index(logic)], 1, __ATOMIC_RELAXED);
+
+    return SUCCESS;
+}
+
+static void _logics_setup(int (*func)(ControlLogic *), uint32_t period_ms)
+{
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        CONTROL_LOGIC_ARRAY[i].func = func;
+        CONTROL_LOGIC_ARRAY[i].init = NULL;
+        CONTROL_LOGIC_ARRAY[i].period_ms = period_ms;
+        CONTROL_LOGIC_ARRAY[i].deadline_ms = period_ms;
+        memset(&CONTROL_LOGIC_ARRAY[i].stats, 0, sizeof(CONTROL_LOGIC_ARRAY[i].stats));
+    }
+    memset(_runs, 0, sizeof(_runs));
+}
+
+static int _runs_total(void)
+{
+    int total = 0;
+
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        total += __atomic_load_n(&_runs[i], __ATOMIC_RELAXED);
+    }
+
+    return total;
+}
+
+static int _thread_count(void)
+{
+    FILE *f = fopen("/proc/self/status", "r");
+    char line[128];
+    int threads = 0;
+
+    if (f == NULL) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (sscanf(line, "Threads: %d", &threads) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+
+    return threads;
+}
+
+static void _usage_get(uint64_t *cpu_us, uint64_t *context_switches)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    *cpu_us = (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL + usage.ru_utime.tv_usec +
+              usage.ru_stime.tv_usec;
+    *context_switches = (uint64_t)(usage.ru_nvcsw + usage.ru_nivcsw);
+}
+
+static void _test_stalled(void)
+{
+    _logics_setup(_quick_logic, PERIOD_MS);
+    for (size_t i = 0; i < STALLED_NUM; i++) {
+        CONTROL_LOGIC_ARRAY[i].func = _stalled_logic;
+    }
+
+    TEST_CHECK(control_logic_manager_start() == 0, "start failed");
+    TEST_CHECK(control_logic_manager_is_running(), "not running after start");
+    usleep(RUN_MS * 1000);
+    uint64_t stop_start = fake_now_ns();
+    TEST_CHECK(control_logic_manager_stop() == 0, "stop failed");
+    uint64_t stop_ms = (fake_now_ns() - stop_start) / 1000000;
+    TEST_CHECK(!control_logic_manager_is_running(), "running after stop");
+
+    int expect = RUN_MS / PERIOD_MS;
+
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        control_logic_stats_t stats;
+
+        TEST_CHECK(control_logic_manager_stats_get((int)i, &stats) == SUCCESS, "stats %zu", i);
+        if (i < STALLED_NUM) {
+            TEST_CHECK(_runs[i] == 1, "stalled logic %zu ran %d times", i, _runs[i]);
+            TEST_CHECK(stats.overrun_count >= (uint32_t)(expect - 2), "stalled logic %zu: %u overruns", i,
+                       stats.overrun_count);
+        } else {
+            TEST_CHECK(_runs[i] >= expect - 1, "logic %zu ran %d of %d periods behind the stalled ones", i, _runs[i],
+                       expect);
+            TEST_CHECK(stats.jitter_max_us < PERIOD_MS * 1000 / 2, "logic %zu: jitter max %u us", i,
+                       stats.jitter_max_us);
+            TEST_CHECK(stats.overrun_count == 0, "logic %zu: %u overruns", i, stats.overrun_count);
+        }
+
+        TEST_REPORT("logic %zu (%s): %2d runs, %2u overruns, jitter avg %4llu us max %5u us\n", i,
+                    (i < STALLED_NUM) ? "stalled" : "quick  ", _runs[i], stats.overrun_count,
+                    (unsigned long long)(stats.run_count ? stats.jitter_sum_us / stats.run_count : 0),
+                    stats.jitter_max_us);
+    }
+
+    // stop waits for the stalled writes to time out
+    TEST_REPORT("%d workers, stop took %llu ms\n", CONTROL_LOGIC_WORKER_NUM, (unsigned long long)stop_ms);
+}
+
+static void _test_early_wake(void)
+{
+    _logics_setup(_quick_logic, EARLY_PERIOD_MS);
+
+    TEST_CHECK(control_logic_manager_start() == 0, "start failed");
+    uint64_t start_ns = fake_now_ns();
+
+    // far from due: new data does not run anything
+    usleep(EARLY_PERIOD_MS / 4 * 1000);
+    control_logic_manager_sensor_data_notify();
+    usleep(50 * 1000);
+    TEST_CHECK(_runs_total() == 0, "%d runs long before the due time", _runs_total());
+
+    // inside the early wake window: every logic runs once, before its due time
+    usleep((EARLY_NOTIFY_MS - EARLY_PERIOD_MS / 4 - 50) * 1000);
+    control_logic_manager_sensor_data_notify();
+    usleep(20 * 1000);
+    uint64_t early_ms = (fake_now_ns() - start_ns) / 1000000;
+    int early_runs = _runs_total();
+
+    // the regular due time then passes without a second run
+    usleep((EARLY_PERIOD_MS - EARLY_NOTIFY_MS + 100) * 1000);
+    int later_runs = _runs_total();
+    control_logic_manager_stop();
+
+    TEST_CHECK(early_ms < EARLY_PERIOD_MS, "checked at %llu ms, after the due time", (unsigned long long)early_ms);
+    TEST_CHECK(early_runs == (int)CONTROL_LOGIC_NUM, "%d of %zu logics ran early", early_runs, CONTROL_LOGIC_NUM);
+    TEST_CHECK(later_runs == early_runs, "%d runs after the early ones, expected none", later_runs - early_runs);
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        control_logic_stats_t stats;
+
+        control_logic_manager_stats_get((int)i, &stats);
+        TEST_CHECK(stats.early_wake_count == 1, "logic %zu: %u early wakes", i, stats.early_wake_count);
+    }
+    TEST_REPORT("early wake: %d logics ran at %llu ms of a %d ms period\n", early_runs,
+                (unsigned long long)early_ms, EARLY_PERIOD_MS);
+}
+
+static void _test_switch(void)
+{
+    _logics_setup(_quick_logic, PERIOD_MS / 10);
+    memset(_switched_runs, 0, sizeof(_switched_runs));
+    __atomic_store_n(&_switched_out, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&_calls_after_switch, 0, __ATOMIC_RELAXED);
+
+    TEST_CHECK(control_logic_manager_start() == 0, "start failed");
+    usleep(RUN_MS / 4 * 1000);
+
+    // the stop/switch/start sequence of control_logic_manager_reinit()
+    control_logic_manager_stop();
+    __atomic_store_n(&_switched_out, 1, __ATOMIC_RELAXED);
+    int old_runs = _runs_total();
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        CONTROL_LOGIC_ARRAY[i].func = _switched_logic;
+    }
+    TEST_CHECK(control_logic_manager_start() == 0, "restart failed");
+    usleep(RUN_MS / 4 * 1000);
+    control_logic_manager_stop();
+
+    int new_runs = 0;
+    for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+        TEST_CHECK(_switched_runs[i] > 0, "logic %zu never ran its new function", i);
+        new_runs += _switched_runs[i];
+    }
+    TEST_CHECK(_calls_after_switch == 0, "old function called %d times after stop", _calls_after_switch);
+    TEST_CHECK(_runs_total() == old_runs, "old function ran %d more times", _runs_total() - old_runs);
+    TEST_REPORT("switch: %d runs of the old functions, %d of the new ones\n", old_runs, new_runs);
+}
+
+#define LIFECYCLE_THREADS 4
+#define LIFECYCLE_ROUNDS 20
+
+static void *_lifecycle_thread(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+
+    for (int round = 0; round < LIFECYCLE_ROUNDS; round++) {
+        if ((round + id) & 1) {
+            control_logic_manager_start();
+        } else {
+            control_logic_manager_stop();
+        }
+    }
+
+    return NULL;
+}
+
+static void _test_concurrent_lifecycle(void)
+{
+    _logics_setup(_quick_logic, PERIOD_MS / 10);
+    __atomic_store_n(&_switched_out, 0, __ATOMIC_RELAXED);
+
+    pthread_t threads[LIFECYCLE_THREADS];
+    for (int i = 0; i < LIFECYCLE_THREADS; i++) {
+        pthread_create(&threads[i], NULL, _lifecycle_thread, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < LIFECYCLE_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // whatever state the race left, one more start/stop pair still works
+    TEST_CHECK(control_logic_manager_start() == 0, "start after the race failed");
+    TEST_CHECK(control_logic_manager_is_running(), "not running after start");
+    int runs = _runs_total();
+    usleep(RUN_MS / 4 * 1000);
+    TEST_CHECK(_runs_total() > runs, "logics stopped running after the race");
+    TEST_CHECK(control_logic_manager_stop() == 0, "stop after the race failed");
+    TEST_CHECK(!control_logic_manager_is_running(), "still running after stop");
+    TEST_CHECK(_epoll_fd < 0 && _timer_fd < 0 && _event_fd < 0, "scheduler fds left open after stop");
+    TEST_REPORT("lifecycle: %d threads x %d start/stop calls\n", LIFECYCLE_THREADS, LIFECYCLE_ROUNDS);
+}
+
+// the loop the scheduler replaced: one thread per logic polling its own timestamp
+static volatile int _baseline_running = 0;
+
+static void *_baseline_thread_func(void *arg)
+{
+    ControlLogic *logic = (ControlLogic *)arg;
+
+    logic->latest_timestamp_ms = 0;
+    while (__atomic_load_n(&_baseline_running, __ATOMIC_RELAXED)) {
+        uint32_t current_timestamp_ms = time32_get_current_ms();
+
+        if (logic->latest_timestamp_ms == 0) {
+            logic->latest_timestamp_ms = current_timestamp_ms;
+            continue;
+        }
+
+        if (current_timestamp_ms - logic->latest_timestamp_ms >= logic->period_ms) {
+            logic->func(logic);
+            logic->latest_timestamp_ms = current_timestamp_ms;
+        } else {
+            time_delay_ms(logic->period_ms - (current_timestamp_ms - logic->latest_timestamp_ms));
+        }
+    }
+
+    return NULL;
+}
+
+static void _cost_measure(bool scheduler, cost_t *cost)
+{
+    pthread_t threads[CONTROL_LOGIC_NUM];
+    uint64_t cpu_start, switches_start, cpu_end, switches_end;
+    int idle_threads = _thread_count();
+
+    _logics_setup(_quick_logic, PERIOD_MS);
+    _usage_get(&cpu_start, &switches_start);
+
+    if (scheduler) {
+        control_logic_manager_start();
+    } else {
+        __atomic_store_n(&_baseline_running, 1, __ATOMIC_RELAXED);
+        for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+            pthread_create(&threads[i], NULL, _baseline_thread_func, &CONTROL_LOGIC_ARRAY[i]);
+        }
+    }
+
+    usleep(RUN_MS * 1000);
+    cost->threads = _thread_count() - idle_threads;
+    cost->runs = _runs_total();
+
+    if (scheduler) {
+        control_logic_manager_stop();
+    } else {
+        __atomic_store_n(&_baseline_running, 0, __ATOMIC_RELAXED);
+        for (size_t i = 0; i < CONTROL_LOGIC_NUM; i++) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    _usage_get(&cpu_end, &switches_end);
+    cost->cpu_us = cpu_end - cpu_start;
+    cost->context_switches = switches_end - switches_start;
+}
+
+static void _test_cost(void)
+{
+    cost_t baseline;
+    cost_t scheduler;
+
+    _cost_measure(false, &baseline);
+    _cost_measure(true, &scheduler);
+
+    TEST_REPORT("cost over %d ms, %zu logics every %d ms:\n", RUN_MS, CONTROL_LOGIC_NUM, PERIOD_MS);
+    TEST_REPORT("  thread per logic: %d threads, %3d runs, %5llu us CPU, %4llu context switches\n", baseline.threads,
+                baseline.runs, (unsigned long long)baseline.cpu_us, (unsigned long long)baseline.context_switches);
+    TEST_REPORT("  scheduler:        %d threads, %3d runs, %5llu us CPU, %4llu context switches\n", scheduler.threads,
+                scheduler.runs, (unsigned long long)scheduler.cpu_us, (unsigned long long)scheduler.context_switches);
+
+    // one worker per logic so a blocked HID write holds only its own; an idle worker schedules
+    TEST_CHECK(baseline.threads == (int)CONTROL_LOGIC_NUM, "baseline ran %d threads", baseline.threads);
+    TEST_CHECK(scheduler.threads <= baseline.threads, "scheduler ran %d threads, baseline %d", scheduler.threads,
+               baseline.threads);
+    // waking through timerfd/epoll and handing jobs over costs a few syscalls per run, not a polling loop
+    TEST_CHECK(scheduler.cpu_us <= baseline.cpu_us * 2 + CPU_SLACK_US, "scheduler %llu us CPU, baseline %llu us",
+               (unsigned long long)scheduler.cpu_us, (unsigned long long)baseline.cpu_us);
+    TEST_CHECK(scheduler.runs >= baseline.runs - (int)CONTROL_LOGIC_NUM, "scheduler ran %d logics, baseline %d",
+               scheduler.runs, baseline.runs);
+}
+
+int main(void)
+{
+    // control_logic_manager_init() would bring up the hardware
+    _control_logic_manager_initialized = true;
+
+    _test_stalled();
+    _test_early_wake();
+    _test_switch();
+    _test_concurrent_lifecycle();
+    _test_cost();
+
+    return TEST_RESULT();
+}
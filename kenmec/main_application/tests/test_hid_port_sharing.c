@@ -0,0 +1,93 @@
+// HID port sharing: the RS485 update uses the RTD board's port while that
+// port's poller reads the RTD channels. A board request from one thread must
+// not land between the other thread's HID write and its read, or the RS485
+// reply is taken by the wrong reader.
+
+#include <pthread.h>
+#include <string.h>
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "dexatek/main_application/managers/modbus_manager/modbus_manager.h"
+
+#include "kenmec/main_application/control_logic/control_hardware.h"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define RTD_PORT 1
+#define SLAVE_ID 1
+#define RS485_READS 100
+#define REGISTERS 4
+
+static int _rs485_running = 1;
+
+typedef struct {
+    int failures;
+    int wrong_values;
+} rs485_reader_t;
+
+static void *_rs485_thread(void *arg)
+{
+    rs485_reader_t *reader = (rs485_reader_t *)arg;
+    uint16_t values[REGISTERS];
+
+    for (int i = 0; i < RS485_READS; i++) {
+        memset(values, 0, sizeof(values));
+        if (control_hardware_rs485_multiple_read(RTD_PORT, 9600, SLAVE_ID, MODBUS_FUNC_READ_HOLDING_REGISTERS, 0,
+                                                 REGISTERS, values, 100) != SUCCESS) {
+            reader->failures++;
+            continue;
+        }
+        for (uint16_t r = 0; r < REGISTERS; r++) {
+            if (values[r] != fake_rs485_register(SLAVE_ID, r)) {
+                reader->wrong_values++;
+                break;
+            }
+        }
+    }
+
+    __atomic_store_n(&_rs485_running, 0, __ATOMIC_RELAXED);
+
+    return NULL;
+}
+
+static void *_rtd_thread(void *arg)
+{
+    uint32_t *reads = (uint32_t *)arg;
+    uint32_t resistor[8];
+
+    while (__atomic_load_n(&_rs485_running, __ATOMIC_RELAXED)) {
+        if (control_hardware_resistor_all_get(RTD_PORT, 100, resistor) == SUCCESS) {
+            (*reads)++;
+        }
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+    fake_hid_reset();
+    fake_hid_boards[RTD_PORT].pid = HID_RTD_BOARD_PID;
+    fake_hid_boards[RTD_PORT].latency_us = 200;
+    fake_hid_boards[RTD_PORT].reply_latency_us = 1000;
+    fake_hid_boards[RTD_PORT].slave_mask = 1u << SLAVE_ID;
+
+    rs485_reader_t reader = { 0 };
+    uint32_t rtd_reads = 0;
+    pthread_t rs485_thread;
+    pthread_t rtd_thread;
+
+    pthread_create(&rtd_thread, NULL, _rtd_thread, &rtd_reads);
+    pthread_create(&rs485_thread, NULL, _rs485_thread, &reader);
+    pthread_join(rs485_thread, NULL);
+    pthread_join(rtd_thread, NULL);
+
+    TEST_CHECK(reader.failures == 0, "%d of %d RS485 replies lost to the RTD poller", reader.failures, RS485_READS);
+    TEST_CHECK(reader.wrong_values == 0, "%d RS485 reads returned another request's data", reader.wrong_values);
+    TEST_CHECK(rtd_reads > 0, "RTD poller never got the port");
+    TEST_REPORT("port sharing: %d RS485 reads, %u RTD reads on one port\n", RS485_READS, rtd_reads);
+
+    return TEST_RESULT();
+}
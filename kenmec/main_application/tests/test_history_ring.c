@@ -0,0 +1,323 @@
+// Sensor history ring buffer: downsampled min/max/avg over random windows
+// must match a brute-force pass over the samples still in the ring, older
+// samples drop out once the ring wraps, and channels beyond the limit are
+// refused.
+//
+// A writer then records as fast as it can while readers query a small ring
+// that wraps many times per second. Sample values equal their timestamp, so
+// any sample read torn or from the wrong lap lands outside its interval.
+//
+// Benchmarks: ingest of 100 channels at 10 Hz (one simulated hour), and
+// query latency over a 24 h window at 10 Hz, block summaries against a plain
+// scan of the raw samples.
+
+#include <math.h>
+#include <pthread.h>
+
+#include "../control_logic/control_logic_history.c"
+
+#include "fake_platform.h"
+
+#define SMALL_DEPTH 1000                // rounded up to 1024
+#define SMALL_SAMPLES 3000
+#define SAMPLE_PERIOD_MS 100            // 10 Hz
+
+#define RACE_DEPTH 256
+#define RACE_MS 1000
+#define RACE_READERS 3
+
+#define INGEST_CHANNELS 100
+#define INGEST_DEPTH (60 * 60 * 10)     // 1 h at 10 Hz
+#define DAY_SAMPLES (24 * 60 * 60 * 10) // 24 h at 10 Hz
+#define QUERY_RUNS 20
+
+static float _sample_value(uint32_t n)
+{
+    // saw tooth with some noise, never constant within a block
+    return (float)(n % 97) + (float)((n * 7919u) % 13) * 0.25f;
+}
+
+// Reference: every sample with n in [oldest, total), timestamps n * period
+static void _reference(uint32_t oldest, uint32_t total, uint64_t from_ms, uint32_t step_ms,
+                       control_logic_history_point_t *points, int point_num)
+{
+    for (int k = 0; k < point_num; k++) {
+        double sum = 0.0;
+        memset(&points[k], 0, sizeof(points[k]));
+        points[k].ts_ms = from_ms + (uint64_t)step_ms * k;
+        for (uint32_t n = oldest; n < total; n++) {
+            uint64_t ts = (uint64_t)n * SAMPLE_PERIOD_MS;
+            if (ts < points[k].ts_ms || ts >= points[k].ts_ms + step_ms) {
+                continue;
+            }
+            float v = _sample_value(n);
+            if (points[k].count == 0 || v < points[k].min) points[k].min = v;
+            if (points[k].count == 0 || v > points[k].max) points[k].max = v;
+            sum += v;
+            points[k].count++;
+        }
+        if (points[k].count) {
+            points[k].avg = (float)(sum / points[k].count);
+        }
+    }
+}
+
+static int _points_differ(const control_logic_history_point_t *a, const control_logic_history_point_t *b, int point_num)
+{
+    for (int k = 0; k < point_num; k++) {
+        if (a[k].ts_ms != b[k].ts_ms || a[k].count != b[k].count) {
+            return 1;
+        }
+        if (a[k].count && (a[k].min != b[k].min || a[k].max != b[k].max || fabsf(a[k].avg - b[k].avg) > 1e-3f)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void _test_queries(void)
+{
+    static control_logic_history_point_t got[512];
+    static control_logic_history_point_t want[512];
+
+    TEST_CHECK(control_logic_history_init(SMALL_DEPTH, 2) == SUCCESS, "init failed");
+    TEST_CHECK(_history_depth == 1024, "depth %u not rounded to whole blocks", _history_depth);
+    TEST_CHECK(control_logic_history_query(100, 0, 1000, got, 1) == FAIL, "query of an unknown channel succeeded");
+
+    for (uint32_t n = 0; n < SMALL_SAMPLES; n++) {
+        control_logic_history_record(100, (uint64_t)n * SAMPLE_PERIOD_MS, _sample_value(n));
+    }
+    uint32_t oldest = SMALL_SAMPLES - _history_depth;
+
+    unsigned seed = 7;
+    int mismatches = 0;
+    for (int run = 0; run < 2000; run++) {
+        seed = seed * 1103515245u + 12345u;
+        uint64_t from_ms = (seed >> 4) % ((uint64_t)SMALL_SAMPLES * SAMPLE_PERIOD_MS);
+        seed = seed * 1103515245u + 12345u;
+        uint32_t step_ms = 1 + (seed >> 4) % 20000;
+        seed = seed * 1103515245u + 12345u;
+        int point_num = 1 + (int)((seed >> 4) % 64);
+
+        control_logic_history_query(100, from_ms, step_ms, got, point_num);
+        _reference(oldest, SMALL_SAMPLES, from_ms, step_ms, want, point_num);
+        mismatches += _points_differ(got, want, point_num);
+    }
+    TEST_CHECK(mismatches == 0, "%d of 2000 random queries differ from the reference", mismatches);
+
+    // the whole ring in one interval: only samples still in the ring count
+    control_logic_history_query(100, 0, SMALL_SAMPLES * SAMPLE_PERIOD_MS, got, 1);
+    TEST_CHECK(got[0].count == _history_depth, "%u samples in a full window", got[0].count);
+
+    // a timestamp going back is clamped to the previous one
+    control_logic_history_record(100, 0, 1000.0f);
+    control_logic_history_query(100, (uint64_t)(SMALL_SAMPLES - 1) * SAMPLE_PERIOD_MS, 1, got, 1);
+    TEST_CHECK(got[0].count == 2 && got[0].max == 1000.0f, "late sample not clamped");
+
+    // channels are created on first write, up to the limit
+    TEST_CHECK(control_logic_history_record(200, 0, 1.0f) == SUCCESS, "second channel refused");
+    TEST_CHECK(control_logic_history_record(300, 0, 1.0f) == FAIL, "channel over the limit accepted");
+    uint16_t addresses[4];
+    TEST_CHECK(control_logic_history_channels_get(addresses, 4) == 2 && addresses[0] == 100 && addresses[1] == 200,
+               "channel list");
+
+    control_logic_history_deinit();
+    TEST_CHECK(control_logic_history_record(100, 0, 1.0f) == FAIL, "record after deinit");
+}
+
+static volatile int _race_running;
+static uint32_t _race_recorded;
+
+static void *_race_writer(void *arg)
+{
+    (void)arg;
+    uint32_t n = 1;
+
+    // values stay exact in a float up to 2^24
+    while (__atomic_load_n(&_race_running, __ATOMIC_RELAXED) && n < (1u << 24)) {
+        // value = timestamp, so a reader can tell which interval a sample belongs to
+        control_logic_history_record(500, n, (float)n);
+        n++;
+    }
+    _race_recorded = n;
+
+    return NULL;
+}
+
+typedef struct {
+    uint64_t queries;
+    uint64_t bad;
+    uint64_t failed;
+} race_reader_t;
+
+static void *_race_reader(void *arg)
+{
+    race_reader_t *reader = arg;
+    control_logic_history_point_t points[16];
+
+    while (__atomic_load_n(&_race_running, __ATOMIC_RELAXED)) {
+        uint32_t head = __atomic_load_n(&_history_channels[0].head, __ATOMIC_ACQUIRE);
+        uint64_t from_ms = head > RACE_DEPTH ? head - RACE_DEPTH : 0;
+        if (control_logic_history_query(500, from_ms, 32, points, 16) != SUCCESS) {
+            reader->failed++;
+            continue;
+        }
+        for (int k = 0; k < 16; k++) {
+            const control_logic_history_point_t *p = &points[k];
+            if (p->count == 0) {
+                continue;
+            }
+            // every sample of the interval has min <= ts < max + 1 and one sample per ms
+            if (p->min < (float)p->ts_ms || p->max >= (float)(p->ts_ms + 32) || p->count > 32 ||
+                p->avg < p->min || p->avg > p->max || p->max - p->min + 1.0f != (float)p->count) {
+                reader->bad++;
+            }
+        }
+        reader->queries++;
+    }
+
+    return NULL;
+}
+
+static void _test_race(void)
+{
+    pthread_t writer;
+    pthread_t readers[RACE_READERS];
+    race_reader_t results[RACE_READERS];
+
+    control_logic_history_init(RACE_DEPTH, 1);
+    control_logic_history_record(500, 0, 0.0f);
+
+    memset(results, 0, sizeof(results));
+    __atomic_store_n(&_race_running, 1, __ATOMIC_RELAXED);
+    pthread_create(&writer, NULL, _race_writer, NULL);
+    for (int i = 0; i < RACE_READERS; i++) {
+        pthread_create(&readers[i], NULL, _race_reader, &results[i]);
+    }
+    usleep(RACE_MS * 1000);
+    __atomic_store_n(&_race_running, 0, __ATOMIC_RELAXED);
+    pthread_join(writer, NULL);
+
+    uint64_t queries = 0, bad = 0, failed = 0;
+    for (int i = 0; i < RACE_READERS; i++) {
+        pthread_join(readers[i], NULL);
+        queries += results[i].queries;
+        bad += results[i].bad;
+        failed += results[i].failed;
+    }
+
+    TEST_CHECK(bad == 0, "%llu intervals with samples from another lap", (unsigned long long)bad);
+    TEST_CHECK(queries > 0, "no query completed");
+    TEST_REPORT("race: %u samples written into a %d sample ring, %llu queries, %llu gave up racing the writer\n",
+                _race_recorded, RACE_DEPTH, (unsigned long long)queries, (unsigned long long)failed);
+
+    control_logic_history_deinit();
+}
+
+static void _bench_ingest(void)
+{
+    control_logic_history_init(INGEST_DEPTH, INGEST_CHANNELS);
+
+    uint32_t ticks = INGEST_DEPTH;
+    uint64_t start = fake_now_ns();
+    for (uint32_t t = 0; t < ticks; t++) {
+        for (int c = 0; c < INGEST_CHANNELS; c++) {
+            control_logic_history_record((uint16_t)(1000 + c), (uint64_t)t * SAMPLE_PERIOD_MS, _sample_value(t + c));
+        }
+    }
+    double ns = (double)(fake_now_ns() - start) / ((double)ticks * INGEST_CHANNELS);
+
+    TEST_CHECK(control_logic_history_channels_get(NULL, 0) == INGEST_CHANNELS, "not every channel created");
+    TEST_REPORT("ingest: %d channels x %u samples, %.1f ns per sample, %.4f%% of a core at %d channels x 10 Hz\n",
+                INGEST_CHANNELS, ticks, ns, ns * INGEST_CHANNELS * 10 / 1e9 * 100, INGEST_CHANNELS);
+    TEST_REPORT("memory: %zu bytes per channel\n",
+                (size_t)_history_depth * (sizeof(uint64_t) + sizeof(float)) + _history_block_num * sizeof(history_block_t));
+
+    control_logic_history_deinit();
+}
+
+// What a ring without block summaries would do: visit every raw sample
+static void _plain_scan(const history_channel_t *ch, uint64_t from_ms, uint32_t step_ms,
+                        control_logic_history_point_t *points, int point_num)
+{
+    double sum = 0.0;
+    int current = -1;
+
+    for (int k = 0; k < point_num; k++) {
+        memset(&points[k], 0, sizeof(points[k]));
+        points[k].ts_ms = from_ms + (uint64_t)step_ms * k;
+    }
+    for (uint32_t n = 0; n < ch->head; n++) {
+        uint64_t ts = ch->ts[n % _history_depth];
+        if (ts < from_ms) {
+            continue;
+        }
+        int k = (int)((ts - from_ms) / step_ms);
+        if (k >= point_num) {
+            break;
+        }
+        if (k != current) {
+            if (current >= 0) points[current].avg = (float)(sum / points[current].count);
+            current = k;
+            sum = 0.0;
+        }
+        _history_point_merge(&points[k], ch->value[n % _history_depth], ch->value[n % _history_depth], 1);
+        sum += ch->value[n % _history_depth];
+    }
+    if (current >= 0) points[current].avg = (float)(sum / points[current].count);
+}
+
+static void _bench_query(void)
+{
+    static control_logic_history_point_t got[86400];
+    static control_logic_history_point_t want[86400];
+    static const struct {
+        const char *name;
+        uint32_t step_ms;
+    } steps[] = {
+        { "1 h", 60 * 60 * 1000 },
+        { "1 min", 60 * 1000 },
+        { "10 s", 10 * 1000 },
+        { "1 s", 1000 },
+    };
+
+    control_logic_history_init(DAY_SAMPLES, 1);
+    for (uint32_t n = 0; n < DAY_SAMPLES; n++) {
+        control_logic_history_record(700, (uint64_t)n * SAMPLE_PERIOD_MS, _sample_value(n));
+    }
+    const history_channel_t *ch = _history_channel_find(700);
+
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        uint32_t step_ms = steps[s].step_ms;
+        int point_num = (int)((uint64_t)DAY_SAMPLES * SAMPLE_PERIOD_MS / step_ms);
+
+        uint64_t start = fake_now_ns();
+        for (int r = 0; r < QUERY_RUNS; r++) {
+            control_logic_history_query(700, 0, step_ms, got, point_num);
+        }
+        double query_us = (double)(fake_now_ns() - start) / QUERY_RUNS / 1000.0;
+
+        start = fake_now_ns();
+        for (int r = 0; r < QUERY_RUNS; r++) {
+            _plain_scan(ch, 0, step_ms, want, point_num);
+        }
+        double scan_us = (double)(fake_now_ns() - start) / QUERY_RUNS / 1000.0;
+
+        TEST_CHECK(!_points_differ(got, want, point_num), "24 h query at %s steps differs from the plain scan",
+                   steps[s].name);
+        TEST_REPORT("24 h at 10 Hz, %5d points of %-5s: %8.1f us, plain scan %8.1f us (%.1fx)\n", point_num,
+                    steps[s].name, query_us, scan_us, scan_us / query_us);
+    }
+
+    control_logic_history_deinit();
+}
+
+int main(void)
+{
+    _test_queries();
+    _test_race();
+    _bench_ingest();
+    _bench_query();
+
+    return TEST_RESULT();
+}
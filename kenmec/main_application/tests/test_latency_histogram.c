@@ -0,0 +1,218 @@
+// Latency histograms: percentiles of a known distribution stay within the
+// bucket resolution (1/16) while count, sum and max are exact, concurrent
+// writers lose no samples, the shards of exited threads are taken over by
+// new ones, and the hardware layer records into the histogram of the call
+// class it belongs to.
+//
+// Benchmark: cost of one sample, bookkeeping alone and with the two clock
+// reads of start/record; a timed call must stay below 50 ns.
+
+#include <pthread.h>
+
+#include "../control_logic/control_logic_latency.c"
+
+#include "kenmec/main_application/control_logic/control_hardware.h"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define RACE_THREADS 8
+#define RACE_SAMPLES 1000000
+#define BENCH_SAMPLES 10000000
+#define IO_PORT 1
+
+static uint64_t _now_ns(void)
+{
+    return control_logic_latency_start();
+}
+
+static int _within(uint64_t got, uint64_t want)
+{
+    // bucket upper bound: never below the true value, at most 1/16 above
+    return got >= want && got <= want + want / 16;
+}
+
+static void _test_percentiles(void)
+{
+    control_logic_latency_summary_t summary;
+    uint64_t sum = 0;
+
+    control_logic_latency_reset();
+
+    // 1..10000 us, uniform: the k-th percentile is k * 100 us
+    for (uint64_t us = 1; us <= 10000; us++) {
+        control_logic_latency_add(CONTROL_LOGIC_LATENCY_HW_RTD_GET, us * 1000);
+        sum += us * 1000;
+    }
+
+    TEST_CHECK(control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_HW_RTD_GET, &summary) == SUCCESS,
+               "summary failed");
+    TEST_CHECK(summary.count == 10000, "count %llu", (unsigned long long)summary.count);
+    TEST_CHECK(summary.sum_ns == sum, "sum %llu, want %llu", (unsigned long long)summary.sum_ns,
+               (unsigned long long)sum);
+    TEST_CHECK(summary.max_ns == 10000000, "max %llu", (unsigned long long)summary.max_ns);
+    TEST_CHECK(_within(summary.p50_ns, 5000000), "p50 %llu", (unsigned long long)summary.p50_ns);
+    TEST_CHECK(_within(summary.p90_ns, 9000000), "p90 %llu", (unsigned long long)summary.p90_ns);
+    TEST_CHECK(_within(summary.p99_ns, 9900000), "p99 %llu", (unsigned long long)summary.p99_ns);
+
+    // small values are exact, one bucket each
+    control_logic_latency_reset();
+    for (int i = 0; i < 10; i++) {
+        control_logic_latency_add(CONTROL_LOGIC_LATENCY_HW_AI_GET, (uint64_t)i);
+    }
+    control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_HW_AI_GET, &summary);
+    TEST_CHECK(summary.p50_ns == 4 && summary.p90_ns == 8 && summary.p99_ns == 9 && summary.max_ns == 9,
+               "small values: p50 %llu p90 %llu p99 %llu max %llu", (unsigned long long)summary.p50_ns,
+               (unsigned long long)summary.p90_ns, (unsigned long long)summary.p99_ns,
+               (unsigned long long)summary.max_ns);
+
+    // one outlier beyond the last bucket is still reported as max
+    control_logic_latency_add(CONTROL_LOGIC_LATENCY_HW_AI_GET, 1ULL << 45);
+    control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_HW_AI_GET, &summary);
+    TEST_CHECK(summary.max_ns == (1ULL << 45), "outlier max %llu", (unsigned long long)summary.max_ns);
+    TEST_CHECK(summary.p50_ns == 5, "outlier moved p50 to %llu", (unsigned long long)summary.p50_ns);
+
+    // the other metrics saw nothing, invalid ones are refused
+    control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_REDFISH_REQUEST, &summary);
+    TEST_CHECK(summary.count == 0 && summary.p99_ns == 0, "untouched metric has %llu samples",
+               (unsigned long long)summary.count);
+    TEST_CHECK(control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_METRIC_NUM, &summary) == FAIL,
+               "invalid metric accepted");
+    TEST_CHECK(control_logic_latency_name(CONTROL_LOGIC_LATENCY_METRIC_NUM) == NULL, "invalid metric named");
+    for (int m = 0; m < CONTROL_LOGIC_LATENCY_METRIC_NUM; m++) {
+        TEST_CHECK(control_logic_latency_name((control_logic_latency_metric_t)m) != NULL, "metric %d unnamed", m);
+    }
+}
+
+static pthread_barrier_t _race_barrier;
+
+static void *_race_thread(void *arg)
+{
+    uint64_t base = (uint64_t)(uintptr_t)arg;
+
+    // all threads of a round hold a shard at the same time
+    _latency_shard_get();
+    pthread_barrier_wait(&_race_barrier);
+
+    for (uint32_t i = 0; i < RACE_SAMPLES; i++) {
+        control_logic_latency_add(CONTROL_LOGIC_LATENCY_REDFISH_REQUEST, base + (i & 1023));
+    }
+
+    return NULL;
+}
+
+static void _race(uint64_t *sum)
+{
+    pthread_t threads[RACE_THREADS];
+
+    pthread_barrier_init(&_race_barrier, NULL, RACE_THREADS);
+    for (int t = 0; t < RACE_THREADS; t++) {
+        uint64_t base = 1000 * (uint64_t)(t + 1);
+        pthread_create(&threads[t], NULL, _race_thread, (void *)(uintptr_t)base);
+        for (uint32_t i = 0; i < RACE_SAMPLES; i++) {
+            *sum += base + (i & 1023);
+        }
+    }
+    for (int t = 0; t < RACE_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_barrier_destroy(&_race_barrier);
+}
+
+static void _test_concurrent(void)
+{
+    control_logic_latency_summary_t summary;
+    uint64_t sum = 0;
+
+    control_logic_latency_reset();
+
+    _race(&sum);
+    int shards = _latency_shard_count;
+
+    control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_REDFISH_REQUEST, &summary);
+    TEST_CHECK(summary.count == (uint64_t)RACE_THREADS * RACE_SAMPLES, "race: %llu samples",
+               (unsigned long long)summary.count);
+    TEST_CHECK(summary.sum_ns == sum, "race: sum %llu, want %llu", (unsigned long long)summary.sum_ns,
+               (unsigned long long)sum);
+    TEST_CHECK(summary.max_ns == 1000 * RACE_THREADS + 1023, "race: max %llu", (unsigned long long)summary.max_ns);
+
+    // a second round of threads takes over the shards, and their counts
+    _race(&sum);
+    control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_REDFISH_REQUEST, &summary);
+    TEST_CHECK(_latency_shard_count == shards, "second round grew %d shards to %d", shards, _latency_shard_count);
+    TEST_CHECK(summary.count == 2ULL * RACE_THREADS * RACE_SAMPLES && summary.sum_ns == sum,
+               "second round: %llu samples", (unsigned long long)summary.count);
+}
+
+static void _test_hardware(void)
+{
+    control_logic_latency_summary_t before;
+    control_logic_latency_summary_t after;
+    uint16_t value[8];
+
+    fake_hid_reset();
+    fake_hid_boards[IO_PORT].pid = HID_IO_BOARD_PID;
+    fake_hid_boards[IO_PORT].latency_us = 200;
+    control_logic_latency_reset();
+
+    control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_HW_DIO_GET, &before);
+    for (int i = 0; i < 10; i++) {
+        TEST_CHECK(control_hardware_digital_input_all_get(IO_PORT, value) == SUCCESS, "DI read %d failed", i);
+    }
+    control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_HW_DIO_GET, &after);
+
+    TEST_CHECK(after.count - before.count == 10, "DI reads recorded %llu samples",
+               (unsigned long long)(after.count - before.count));
+    TEST_CHECK(after.p50_ns >= 200000, "DI p50 %llu ns below the 200 us board latency",
+               (unsigned long long)after.p50_ns);
+
+    // failed calls are timed as well
+    fake_hid_boards[IO_PORT].pid = 0;
+    control_hardware_digital_input_all_get(IO_PORT, value);
+    control_logic_latency_summary_get(CONTROL_LOGIC_LATENCY_HW_DIO_GET, &after);
+    TEST_CHECK(after.count - before.count == 11, "unplugged read not recorded");
+}
+
+static void _bench(void)
+{
+    uint64_t start;
+    double add_ns;
+    double record_ns;
+    double clock_ns;
+    volatile uint64_t sink = 0;
+
+    control_logic_latency_reset();
+
+    start = _now_ns();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        control_logic_latency_add(CONTROL_LOGIC_LATENCY_HW_RTD_GET, 1000 + (i & 0xFFFF));
+    }
+    add_ns = (double)(_now_ns() - start) / BENCH_SAMPLES;
+
+    start = _now_ns();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        control_logic_latency_record(CONTROL_LOGIC_LATENCY_HW_PWM_GET, control_logic_latency_start());
+    }
+    record_ns = (double)(_now_ns() - start) / BENCH_SAMPLES;
+
+    start = _now_ns();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        sink += control_logic_latency_start() - control_logic_latency_start();
+    }
+    clock_ns = (double)(_now_ns() - start) / BENCH_SAMPLES;
+    (void)sink;
+
+    TEST_REPORT("bench: add %.1f ns/sample, start+record %.1f ns/sample (two clock reads alone %.1f ns)\n",
+                add_ns, record_ns, clock_ns);
+    TEST_CHECK(record_ns < 50.0, "start+record costs %.1f ns per sample", record_ns);
+}
+
+int main(void)
+{
+    _test_percentiles();
+    _test_concurrent();
+    _test_hardware();
+    _bench();
+
+    return TEST_RESULT();
+}
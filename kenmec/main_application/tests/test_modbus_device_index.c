@@ -0,0 +1,149 @@
+// Modbus device write index: with 10, 100 and 1000 device configs every
+// address in the 20000-register space resolves to the same config the old
+// linear scan picked, lookups per second are timed against that scan, and a
+// reader looking up addresses while the configs are replaced never gets a
+// config for a different address.
+
+#include "../control_logic/control_logic_config.c"
+
+#include "fake_platform.h"
+
+#define ADDRESS_SPACE 20000
+#define LOOKUP_NUM 2000000
+#define SCAN_LOOKUP_NUM 200000
+#define RELOAD_NUM 200
+
+static const int _config_nums[] = { 10, 100, 1000 };
+
+// Every third config is a read; update addresses repeat so the first one must win
+static char *_configs_json(int count, int salt)
+{
+    cJSON *root = cJSON_CreateArray();
+
+    for (int i = 0; i < count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "board", i % 2);
+        cJSON_AddNumberToObject(item, "baudrate", 9600);
+        cJSON_AddNumberToObject(item, "slave_id", 1 + i % 247);
+        cJSON_AddNumberToObject(item, "code",
+                                (i % 3 == 0) ? MODBUS_FUNC_READ_HOLDING_REGISTERS : MODBUS_FUNC_WRITE_SINGLE_REGISTER);
+        cJSON_AddNumberToObject(item, "address", i);
+        cJSON_AddNumberToObject(item, "data_type", 0);
+        cJSON_AddNumberToObject(item, "update_address", ((i % (count * 9 / 10)) * 17 + salt) % ADDRESS_SPACE);
+        cJSON_AddItemToArray(root, item);
+    }
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+
+    return json;
+}
+
+// control_logic_write_register() before the index
+static int _linear_find(const modbus_device_config_t *configs, int count, uint32_t address,
+                        modbus_device_config_t *config)
+{
+    for (int i = 0; i < count; i++) {
+        if (configs[i].function_code == MODBUS_FUNC_WRITE_SINGLE_REGISTER &&
+            configs[i].update_address == (int32_t)address) {
+            *config = configs[i];
+            return SUCCESS;
+        }
+    }
+
+    return FAIL;
+}
+
+static void _test_lookup(int count)
+{
+    char *json = _configs_json(count, 0);
+    modbus_device_config_t expect;
+    modbus_device_config_t found;
+    int configs_count = 0;
+    int mismatches = 0;
+    int hits = 0;
+
+    TEST_CHECK(_modbus_device_configs_load_from_string(json) == SUCCESS, "%d configs: load failed", count);
+    free(json);
+    const modbus_device_config_t *configs = control_logic_modbus_device_configs_get(&configs_count);
+    TEST_CHECK(configs_count == count, "%d configs loaded of %d", configs_count, count);
+
+    for (uint32_t address = 0; address < ADDRESS_SPACE; address++) {
+        int want = _linear_find(configs, configs_count, address, &expect);
+        int got = control_logic_modbus_device_write_config_find(address, &found);
+        if (want != got || (want == SUCCESS && found.reg_address != expect.reg_address)) {
+            mismatches++;
+        }
+        hits += (want == SUCCESS);
+    }
+    TEST_CHECK(mismatches == 0, "%d configs: %d addresses resolve differently from the linear scan", count,
+               mismatches);
+
+    volatile int sink = 0;
+    uint64_t start = fake_now_ns();
+    for (uint32_t i = 0; i < LOOKUP_NUM; i++) {
+        sink += control_logic_modbus_device_write_config_find((i * 7919u) % ADDRESS_SPACE, &found) == SUCCESS;
+    }
+    double index_rate = LOOKUP_NUM * 1e9 / (double)(fake_now_ns() - start);
+
+    start = fake_now_ns();
+    for (uint32_t i = 0; i < SCAN_LOOKUP_NUM; i++) {
+        sink += _linear_find(configs, configs_count, (i * 7919u) % ADDRESS_SPACE, &found) == SUCCESS;
+    }
+    double scan_rate = SCAN_LOOKUP_NUM * 1e9 / (double)(fake_now_ns() - start);
+    (void)sink;
+
+    TEST_REPORT("%4d configs (%4d write addresses): %6.1f M lookups/s indexed, %6.1f M/s linear scan (%.1fx)\n",
+                count, hits, index_rate / 1e6, scan_rate / 1e6, index_rate / scan_rate);
+}
+
+static volatile bool _reload_running;
+
+// Looks up addresses while the main thread swaps configs underneath
+static void *_reader_thread(void *arg)
+{
+    int *bad = (int *)arg;
+    modbus_device_config_t found;
+    uint32_t i = 0;
+
+    while (__atomic_load_n(&_reload_running, __ATOMIC_ACQUIRE)) {
+        uint32_t address = (i++ * 7919u) % ADDRESS_SPACE;
+        if (control_logic_modbus_device_write_config_find(address, &found) == SUCCESS &&
+            (found.update_address != (int32_t)address || found.function_code != MODBUS_FUNC_WRITE_SINGLE_REGISTER)) {
+            (*bad)++;
+        }
+    }
+
+    return NULL;
+}
+
+static void _test_reload(void)
+{
+    char *json[2] = { _configs_json(1000, 0), _configs_json(1000, 11) };
+    pthread_t reader;
+    int bad = 0;
+
+    __atomic_store_n(&_reload_running, true, __ATOMIC_RELEASE);
+    pthread_create(&reader, NULL, _reader_thread, &bad);
+    for (int i = 0; i < RELOAD_NUM; i++) {
+        TEST_CHECK(_modbus_device_configs_load_from_string(json[i % 2]) == SUCCESS, "reload %d failed", i);
+    }
+    __atomic_store_n(&_reload_running, false, __ATOMIC_RELEASE);
+    pthread_join(reader, NULL);
+
+    TEST_CHECK(bad == 0, "%d lookups returned a config for another address during reloads", bad);
+    TEST_REPORT("%d reloads under a concurrent reader: %d bad lookups\n", RELOAD_NUM, bad);
+
+    free(json[0]);
+    free(json[1]);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(_config_nums) / sizeof(_config_nums[0]); i++) {
+        _test_lookup(_config_nums[i]);
+    }
+    _test_reload();
+
+    return TEST_RESULT();
+}
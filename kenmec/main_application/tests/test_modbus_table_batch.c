@@ -0,0 +1,283 @@
+// Batched Modbus table publication: an IO board's 8 DI, 4 AI voltage and
+// 4 AI current values are published as one batch while readers copy the
+// board's whole 100-register block (three seqlock pages) with
+// control_logic_load_from_modbus_table_range(). Every value of a round is the
+// round number, so a reader seeing two different numbers caught a board half
+// way through an update. The same load with one call per channel (the refresh
+// before batching) shows what the batch prevents.
+//
+// A batch bumps the table generation once however many values it changes,
+// not at all when nothing changed, and is rejected as a whole when one entry
+// is invalid. A fresh subscriber (since 0) and one holding a generation from
+// before a restart (since ahead of the table) get the whole table, including
+// registers that never changed.
+//
+// Benchmark: cost of publishing a board with one call per channel against
+// one batch, with changing and with unchanged values.
+
+#include <pthread.h>
+
+#include "../control_logic/control_logic_update.c"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define PORT 0
+#define READER_NUM 4
+#define RUN_MS 500
+#define BENCH_ROUNDS 200000
+
+#define BOARD_BASE (HID_BASE_ADDRESS + (PORT * HID_IO_BOARD_BASE_ADDRESS))
+#define BOARD_REGISTERS HID_IO_BOARD_BASE_ADDRESS
+#define BOARD_VALUES 16
+
+typedef struct {
+    uint64_t snapshots;
+    uint64_t torn;
+} reader_t;
+
+static volatile int _running = 0;
+
+// 8 DI, then 4 AI voltage and 4 AI current as 32-bit values, all set to round
+static uint16_t _board_fill(control_logic_modbus_write_t writes[BOARD_VALUES], uint32_t round)
+{
+    for (int i = 0; i < 8; i++) {
+        writes[i] = (control_logic_modbus_write_t){ .address = BOARD_BASE + MODBUS_ADDRESS_GPIO_INPUT_0 + i,
+                                                    .type = MODBUS_TYPE_UINT16, .value.u16 = (uint16_t)round };
+    }
+    for (int i = 0; i < 4; i++) {
+        writes[8 + i] = (control_logic_modbus_write_t){ .address = BOARD_BASE + MODBUS_ADDRESS_AD74416H_CH_A_VOLTAGE + i * 2,
+                                                        .type = MODBUS_TYPE_UINT32, .value.u32 = round };
+        writes[12 + i] = (control_logic_modbus_write_t){ .address = BOARD_BASE + MODBUS_ADDRESS_AD74416H_CH_A_CURRENT + i * 2,
+                                                         .type = MODBUS_TYPE_UINT32, .value.u32 = round };
+    }
+
+    return BOARD_VALUES;
+}
+
+static void _board_publish_single(control_logic_modbus_write_t writes[BOARD_VALUES])
+{
+    for (int i = 0; i < BOARD_VALUES; i++) {
+        control_logic_update_to_modbus_table(writes[i].address, writes[i].type, &writes[i].value);
+    }
+}
+
+static void *_writer(void *arg)
+{
+    int batched = *(int *)arg;
+    control_logic_modbus_write_t writes[BOARD_VALUES];
+
+    for (uint32_t round = 1; __atomic_load_n(&_running, __ATOMIC_RELAXED); round++) {
+        // 16-bit DI values must stay equal to the low word of the 32-bit ones
+        uint16_t count = _board_fill(writes, round & 0xFFFF);
+        if (batched) {
+            control_logic_update_to_modbus_table_batch(writes, count);
+        } else {
+            _board_publish_single(writes);
+        }
+    }
+
+    return NULL;
+}
+
+static void *_reader(void *arg)
+{
+    reader_t *reader = (reader_t *)arg;
+    uint16_t words[BOARD_REGISTERS];
+
+    while (__atomic_load_n(&_running, __ATOMIC_RELAXED)) {
+        control_logic_load_from_modbus_table_range(BOARD_BASE, BOARD_REGISTERS, words);
+
+        uint16_t expect = words[MODBUS_ADDRESS_GPIO_INPUT_0];
+        bool torn = false;
+        for (int i = 0; i < 8; i++) {
+            torn |= (words[MODBUS_ADDRESS_GPIO_INPUT_0 + i] != expect);
+        }
+        for (int i = 0; i < 4; i++) {
+            torn |= (words[MODBUS_ADDRESS_AD74416H_CH_A_VOLTAGE + i * 2] != expect);
+            torn |= (words[MODBUS_ADDRESS_AD74416H_CH_A_CURRENT + i * 2] != expect);
+        }
+        reader->snapshots++;
+        reader->torn += torn;
+    }
+
+    return NULL;
+}
+
+static void _run(int batched, uint64_t *snapshots, uint64_t *torn)
+{
+    pthread_t writer_thread;
+    pthread_t reader_threads[READER_NUM];
+    reader_t readers[READER_NUM];
+
+    memset(readers, 0, sizeof(readers));
+    __atomic_store_n(&_running, 1, __ATOMIC_RELAXED);
+    pthread_create(&writer_thread, NULL, _writer, &batched);
+    for (int i = 0; i < READER_NUM; i++) {
+        pthread_create(&reader_threads[i], NULL, _reader, &readers[i]);
+    }
+
+    time_delay_ms(RUN_MS);
+    __atomic_store_n(&_running, 0, __ATOMIC_RELAXED);
+
+    pthread_join(writer_thread, NULL);
+    *snapshots = 0;
+    *torn = 0;
+    for (int i = 0; i < READER_NUM; i++) {
+        pthread_join(reader_threads[i], NULL);
+        *snapshots += readers[i].snapshots;
+        *torn += readers[i].torn;
+    }
+}
+
+static void _test_consistency(void)
+{
+    uint64_t snapshots;
+    uint64_t torn;
+
+    _run(1, &snapshots, &torn);
+    TEST_REPORT("batch: %llu board snapshots, %llu half-updated\n", (unsigned long long)snapshots,
+                (unsigned long long)torn);
+    TEST_CHECK(snapshots > 0, "readers made no progress");
+    TEST_CHECK(torn == 0, "%llu half-updated boards", (unsigned long long)torn);
+
+    _run(0, &snapshots, &torn);
+    TEST_REPORT("one call per channel: %llu board snapshots, %llu half-updated\n", (unsigned long long)snapshots,
+                (unsigned long long)torn);
+}
+
+static void _test_generation(void)
+{
+    control_logic_modbus_write_t writes[BOARD_VALUES];
+    uint16_t count = _board_fill(writes, 40000);
+    uint16_t addresses[64];
+    uint16_t words[64];
+    uint32_t since;
+
+    control_logic_update_to_modbus_table_batch(writes, count);
+    since = control_logic_modbus_table_generation();
+
+    // a whole new board: one generation, every value listed as changed
+    count = _board_fill(writes, 40001);
+    TEST_CHECK(control_logic_update_to_modbus_table_batch(writes, count) == SUCCESS, "batch failed");
+    TEST_CHECK(control_logic_modbus_table_generation() == since + 1, "generation moved by %u",
+               control_logic_modbus_table_generation() - since);
+    uint32_t generation = 0;
+    int changes = control_logic_modbus_table_changes(since, &generation, addresses, words, 64);
+    TEST_CHECK(changes == 8 + 8 * 2 && generation == since + 1, "%d changed registers up to generation %u", changes,
+               generation);
+
+    // unchanged: no generation
+    TEST_CHECK(control_logic_update_to_modbus_table_batch(writes, count) == SUCCESS, "unchanged batch failed");
+    TEST_CHECK(control_logic_modbus_table_generation() == since + 1, "unchanged batch bumped the generation");
+
+    // one channel changed: one generation, only that channel listed
+    writes[3].value.u16 = 7;
+    control_logic_update_to_modbus_table_batch(writes, count);
+    changes = control_logic_modbus_table_changes(since + 1, &generation, addresses, words, 64);
+    TEST_CHECK(changes == 1 && addresses[0] == writes[3].address && words[0] == 7, "%d changes, first at %u = %u",
+               changes, addresses[0], words[0]);
+
+    // 64-bit values: low word first, read back whole
+    uint64_t u64 = 0x0123456789ABCDEFULL;
+    uint64_t u64_back = 0;
+    uint16_t u64_words[4];
+    control_logic_update_to_modbus_table(BOARD_BASE + BOARD_REGISTERS - 4, MODBUS_TYPE_UINT64, &u64);
+    control_logic_load_from_modbus_table_range(BOARD_BASE + BOARD_REGISTERS - 4, 4, u64_words);
+    control_logic_load_from_modbus_table(BOARD_BASE + BOARD_REGISTERS - 4, MODBUS_TYPE_UINT64, &u64_back);
+    TEST_CHECK(u64_words[0] == 0xCDEF && u64_words[1] == 0x89AB && u64_words[2] == 0x4567 && u64_words[3] == 0x0123,
+               "UINT64 words %04X %04X %04X %04X", u64_words[0], u64_words[1], u64_words[2], u64_words[3]);
+    TEST_CHECK(u64_back == u64, "UINT64 read back as 0x%016llX", (unsigned long long)u64_back);
+
+    // an invalid entry rejects the whole batch
+    writes[0].value.u16 = 9;
+    writes[5].type = 0xFF;
+    TEST_CHECK(control_logic_update_to_modbus_table_batch(writes, count) == FAIL, "invalid type accepted");
+    writes[5].type = MODBUS_TYPE_UINT16;
+    writes[5].address = MODBUS_RO_REGISTERS;
+    TEST_CHECK(control_logic_update_to_modbus_table_batch(writes, count) == FAIL, "address out of range accepted");
+    uint16_t value = 0;
+    control_logic_load_from_modbus_table(writes[0].address, MODBUS_TYPE_UINT16, &value);
+    TEST_CHECK(value == 40001, "rejected batch was partly written: %u", value);
+    TEST_CHECK(control_logic_update_to_modbus_table_batch(writes, 0) == FAIL, "empty batch accepted");
+    TEST_CHECK(control_logic_update_to_modbus_table_batch(writes, CONTROL_LOGIC_MODBUS_BATCH_MAX + 1) == FAIL,
+               "oversized batch accepted");
+}
+
+static void _test_full_table(void)
+{
+    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
+    uint32_t end = (uint32_t)mapping->start_registers + (uint32_t)mapping->nb_registers;
+    int size = (int)((end < MODBUS_RO_REGISTERS ? end : MODBUS_RO_REGISTERS) - mapping->start_registers);
+    uint16_t *addresses = calloc((size_t)size, sizeof(uint16_t));
+    uint16_t *words = calloc((size_t)size, sizeof(uint16_t));
+    uint32_t now = control_logic_modbus_table_generation();
+    uint32_t generation = 0;
+
+    uint32_t stale[] = { 0, now + 1, UINT32_MAX };
+    for (size_t i = 0; i < sizeof(stale) / sizeof(stale[0]); i++) {
+        int changes = control_logic_modbus_table_changes(stale[i], &generation, addresses, words, size);
+        bool same = (changes == size);
+        for (int r = 0; same && r < size; r++) {
+            same = (addresses[r] == mapping->start_registers + r && words[r] == mapping->tab_registers[addresses[r]]);
+        }
+        TEST_CHECK(same && generation == now, "since %u: %d of %d registers listed up to generation %u", stale[i],
+                   changes, size, generation);
+    }
+
+    // the listing stops at max, up to date lists nothing
+    TEST_CHECK(control_logic_modbus_table_changes(0, &generation, addresses, words, 10) == 10, "max not honoured");
+    TEST_CHECK(control_logic_modbus_table_changes(now, &generation, addresses, words, size) == 0,
+               "up to date subscriber got changes");
+
+    free(addresses);
+    free(words);
+}
+
+static void _bench(void)
+{
+    control_logic_modbus_write_t writes[BOARD_VALUES];
+    uint64_t start;
+
+    start = fake_now_ns();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        _board_fill(writes, round);
+        _board_publish_single(writes);
+    }
+    double single_ns = (double)(fake_now_ns() - start) / BENCH_ROUNDS;
+
+    start = fake_now_ns();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        _board_fill(writes, round);
+        control_logic_update_to_modbus_table_batch(writes, BOARD_VALUES);
+    }
+    double batch_ns = (double)(fake_now_ns() - start) / BENCH_ROUNDS;
+
+    // a stable board: nothing changes, nothing is locked
+    _board_fill(writes, 1);
+    start = fake_now_ns();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        _board_publish_single(writes);
+    }
+    double single_same_ns = (double)(fake_now_ns() - start) / BENCH_ROUNDS;
+
+    start = fake_now_ns();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        control_logic_update_to_modbus_table_batch(writes, BOARD_VALUES);
+    }
+    double batch_same_ns = (double)(fake_now_ns() - start) / BENCH_ROUNDS;
+
+    TEST_REPORT("bench: publish a board of %d values: changing %.0f ns per call each, %.0f ns batched (%.1fx); "
+                "unchanged %.0f ns / %.0f ns\n",
+                BOARD_VALUES, single_ns, batch_ns, single_ns / batch_ns, single_same_ns, batch_same_ns);
+}
+
+int main(void)
+{
+    _test_consistency();
+    _test_generation();
+    _test_full_table();
+    _bench();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,360 @@
+// Modbus table seqlock stress test: 8 writers and 8 readers hammer INT32
+// slots (some straddling a seqlock page boundary) through the control logic
+// API and through modbus_reply(), the path the Modbus TCP server and the HMI
+// use. Every value written has equal high and low words, so a reader seeing
+// two different words caught a torn update.
+//
+// The same load is then run with plain word-by-word access, as before the
+// seqlock: the server without modbus_set_registers_access() and the API
+// readers copying tab_registers directly. It shows what the seqlock prevents;
+// how often a plain read tears depends on the machine (rarely on one core).
+//
+// Finally a follower applies control_logic_modbus_table_changes() to a copy
+// of the slots while API writers run; once they stop, the copy must match
+// the table, and rewriting a value unchanged must not bump the generation.
+
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "../control_logic/control_logic_update.c"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define WRITER_NUM 8
+#define READER_NUM 8
+#define SLOT_NUM 16
+#define RUN_MS 1000
+
+// slots run across the page boundary at 2048
+#define SLOT_BASE (2048 - SLOT_NUM)
+#define SLOT_ADDRESS(k) (SLOT_BASE + (k) * 2)
+
+typedef struct {
+    int id;
+    modbus_t *ctx;
+    int peer;
+    uint64_t ops;
+    uint64_t torn;
+} worker_t;
+
+static volatile int _running = 0;
+// API readers copy tab_registers word by word instead of using the seqlock
+static volatile int _api_plain = 0;
+
+static int _server_open(worker_t *worker)
+{
+    int sv[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        return FAIL;
+    }
+
+    worker->ctx = modbus_new_tcp("127.0.0.1", 502);
+    modbus_set_socket(worker->ctx, sv[0]);
+    worker->peer = sv[1];
+
+    return SUCCESS;
+}
+
+static void _server_close(worker_t *worker)
+{
+    close(modbus_get_socket(worker->ctx));
+    close(worker->peer);
+    modbus_free(worker->ctx);
+}
+
+// Hand a request to modbus_reply() like the TCP server does and collect the response
+static int _server_request(worker_t *worker, uint8_t *req, int req_length, uint8_t *rsp, int rsp_length)
+{
+    modbus_mapping_t *mapping = modbus_manager_data_mapping_get();
+
+    req[4] = 0;
+    req[5] = (uint8_t)(req_length - 6);
+
+    if (modbus_reply(worker->ctx, req, req_length, mapping) != rsp_length) {
+        return FAIL;
+    }
+
+    int received = 0;
+    while (received < rsp_length) {
+        ssize_t n = recv(worker->peer, rsp + received, (size_t)(rsp_length - received), 0);
+        if (n <= 0) {
+            return FAIL;
+        }
+        received += (int)n;
+    }
+
+    return SUCCESS;
+}
+
+static void *_api_writer(void *arg)
+{
+    worker_t *worker = (worker_t *)arg;
+    uint16_t c = (uint16_t)(worker->id * 7919);
+
+    while (__atomic_load_n(&_running, __ATOMIC_RELAXED)) {
+        uint32_t value = ((uint32_t)c << 16) | c;
+        control_logic_update_to_modbus_table(SLOT_ADDRESS(c % SLOT_NUM), MODBUS_TYPE_UINT32, &value);
+        worker->ops++;
+        c++;
+    }
+
+    return NULL;
+}
+
+static void *_server_writer(void *arg)
+{
+    worker_t *worker = (worker_t *)arg;
+    uint16_t c = (uint16_t)(worker->id * 7919);
+    uint8_t req[32];
+    uint8_t rsp[32];
+
+    while (__atomic_load_n(&_running, __ATOMIC_RELAXED)) {
+        uint16_t address = SLOT_ADDRESS(c % SLOT_NUM);
+
+        // write multiple registers: both words of one slot
+        uint8_t frame[] = { 0, 1, 0, 0, 0, 0, 1, MODBUS_FC_WRITE_MULTIPLE_REGISTERS, address >> 8, address & 0xFF,
+                            0, 2, 4, c >> 8, c & 0xFF, c >> 8, c & 0xFF };
+        memcpy(req, frame, sizeof(frame));
+        TEST_CHECK(_server_request(worker, req, sizeof(frame), rsp, 12) == SUCCESS, "server write failed");
+        worker->ops++;
+        c++;
+    }
+
+    return NULL;
+}
+
+static void *_api_reader(void *arg)
+{
+    worker_t *worker = (worker_t *)arg;
+    int k = worker->id;
+
+    while (__atomic_load_n(&_running, __ATOMIC_RELAXED)) {
+        uint32_t value = 0;
+        if (_api_plain) {
+            const volatile uint16_t *tab = modbus_manager_data_mapping_get()->tab_registers;
+            value = tab[SLOT_ADDRESS(k % SLOT_NUM)];
+            value |= (uint32_t)tab[SLOT_ADDRESS(k % SLOT_NUM) + 1] << 16;
+        } else {
+            control_logic_load_from_modbus_table(SLOT_ADDRESS(k % SLOT_NUM), MODBUS_TYPE_UINT32, &value);
+        }
+        if ((value >> 16) != (value & 0xFFFF)) {
+            worker->torn++;
+        }
+        worker->ops++;
+        k++;
+    }
+
+    return NULL;
+}
+
+static void *_server_reader(void *arg)
+{
+    worker_t *worker = (worker_t *)arg;
+    uint8_t rsp[8 + 1 + SLOT_NUM * 4];
+
+    while (__atomic_load_n(&_running, __ATOMIC_RELAXED)) {
+        // read holding registers: every slot in one request
+        uint8_t req[] = { 0, 2, 0, 0, 0, 0, 1, MODBUS_FC_READ_HOLDING_REGISTERS, SLOT_BASE >> 8, SLOT_BASE & 0xFF,
+                          0, SLOT_NUM * 2 };
+        if (_server_request(worker, req, sizeof(req), rsp, 9 + SLOT_NUM * 4) != SUCCESS) {
+            TEST_CHECK(0, "server read failed");
+            break;
+        }
+        for (int k = 0; k < SLOT_NUM; k++) {
+            const uint8_t *words = &rsp[9 + k * 4];
+            if (words[0] != words[2] || words[1] != words[3]) {
+                worker->torn++;
+            }
+        }
+        worker->ops++;
+    }
+
+    return NULL;
+}
+
+// Run writers and readers for RUN_MS and return the torn reads seen by each kind of reader
+static void _stress(const char *name, uint64_t *api_torn, uint64_t *server_torn)
+{
+    worker_t writers[WRITER_NUM] = {{0}};
+    worker_t readers[READER_NUM] = {{0}};
+    pthread_t writer_threads[WRITER_NUM];
+    pthread_t reader_threads[READER_NUM];
+    uint64_t writes = 0;
+    uint64_t reads = 0;
+
+    *api_torn = 0;
+    *server_torn = 0;
+
+    __atomic_store_n(&_running, 1, __ATOMIC_RELAXED);
+
+    for (int i = 0; i < WRITER_NUM; i++) {
+        writers[i].id = i;
+        if (i & 1) {
+            _server_open(&writers[i]);
+            pthread_create(&writer_threads[i], NULL, _server_writer, &writers[i]);
+        } else {
+            pthread_create(&writer_threads[i], NULL, _api_writer, &writers[i]);
+        }
+    }
+    for (int i = 0; i < READER_NUM; i++) {
+        readers[i].id = i;
+        if (i & 1) {
+            _server_open(&readers[i]);
+            pthread_create(&reader_threads[i], NULL, _server_reader, &readers[i]);
+        } else {
+            pthread_create(&reader_threads[i], NULL, _api_reader, &readers[i]);
+        }
+    }
+
+    usleep(RUN_MS * 1000);
+    __atomic_store_n(&_running, 0, __ATOMIC_RELAXED);
+
+    for (int i = 0; i < WRITER_NUM; i++) {
+        pthread_join(writer_threads[i], NULL);
+        writes += writers[i].ops;
+        if (i & 1) {
+            _server_close(&writers[i]);
+        }
+    }
+    for (int i = 0; i < READER_NUM; i++) {
+        pthread_join(reader_threads[i], NULL);
+        reads += readers[i].ops;
+        if (i & 1) {
+            *server_torn += readers[i].torn;
+            _server_close(&readers[i]);
+        } else {
+            *api_torn += readers[i].torn;
+        }
+    }
+
+    TEST_REPORT("%-10s %llu writes, %llu reads, torn: api %llu, server %llu\n", name, (unsigned long long)writes,
+                (unsigned long long)reads, (unsigned long long)*api_torn, (unsigned long long)*server_torn);
+}
+
+typedef struct {
+    uint16_t shadow[SLOT_NUM * 2];
+    uint32_t since;
+} follower_t;
+
+// Apply the changes since the last pass to the copy of the slots
+static void _follow_changes(follower_t *follower)
+{
+    uint16_t addresses[SLOT_NUM * 2];
+    uint16_t words[SLOT_NUM * 2];
+
+    int count = control_logic_modbus_table_changes(follower->since, &follower->since, addresses, words, SLOT_NUM * 2);
+    for (int i = 0; i < count; i++) {
+        if (addresses[i] >= SLOT_BASE && addresses[i] < SLOT_BASE + SLOT_NUM * 2) {
+            follower->shadow[addresses[i] - SLOT_BASE] = words[i];
+        }
+    }
+}
+
+static void *_change_follower(void *arg)
+{
+    follower_t *follower = (follower_t *)arg;
+
+    while (__atomic_load_n(&_running, __ATOMIC_RELAXED)) {
+        _follow_changes(follower);
+    }
+
+    return NULL;
+}
+
+static void _test_changes(void)
+{
+    worker_t writers[WRITER_NUM / 2] = {{0}};
+    pthread_t writer_threads[WRITER_NUM / 2];
+    pthread_t follower_thread;
+    follower_t follower;
+    uint16_t table[SLOT_NUM * 2];
+    uint16_t addresses[SLOT_NUM * 2];
+    uint16_t words[SLOT_NUM * 2];
+    uint32_t since = 0;
+
+    memset(&follower, 0, sizeof(follower));
+    __atomic_store_n(&_running, 1, __ATOMIC_RELAXED);
+    pthread_create(&follower_thread, NULL, _change_follower, &follower);
+    for (int i = 0; i < WRITER_NUM / 2; i++) {
+        writers[i].id = i;
+        pthread_create(&writer_threads[i], NULL, _api_writer, &writers[i]);
+    }
+
+    usleep(RUN_MS * 1000 / 4);
+    __atomic_store_n(&_running, 0, __ATOMIC_RELAXED);
+    for (int i = 0; i < WRITER_NUM / 2; i++) {
+        pthread_join(writer_threads[i], NULL);
+    }
+    pthread_join(follower_thread, NULL);
+
+    // the writers' last stores may come after the follower's last pass
+    _follow_changes(&follower);
+    uint32_t generation = control_logic_modbus_table_generation();
+    TEST_CHECK(follower.since == generation, "follower stopped at generation %u of %u", follower.since, generation);
+
+    control_logic_load_from_modbus_table_range(SLOT_BASE, SLOT_NUM * 2, table);
+    int mismatch = 0;
+    for (int i = 0; i < SLOT_NUM * 2; i++) {
+        mismatch += (follower.shadow[i] != table[i]);
+    }
+    TEST_CHECK(mismatch == 0, "%d registers differ between the change list and the table", mismatch);
+
+    // an unchanged value is not a change
+    uint32_t value = 0;
+    control_logic_load_from_modbus_table(SLOT_ADDRESS(0), MODBUS_TYPE_UINT32, &value);
+    control_logic_update_to_modbus_table(SLOT_ADDRESS(0), MODBUS_TYPE_UINT32, &value);
+    TEST_CHECK(control_logic_modbus_table_generation() == generation, "rewriting a value bumped the generation");
+    value ^= 0x00010001;
+    control_logic_update_to_modbus_table(SLOT_ADDRESS(0), MODBUS_TYPE_UINT32, &value);
+    TEST_CHECK(control_logic_modbus_table_changes(generation, &since, addresses, words, SLOT_NUM * 2) == 2 &&
+               addresses[0] == SLOT_ADDRESS(0) && since == generation + 1,
+               "a changed INT32 is not reported as its two registers under one generation");
+
+    uint64_t writes = 0;
+    for (int i = 0; i < WRITER_NUM / 2; i++) {
+        writes += writers[i].ops;
+    }
+    TEST_REPORT("changes    %llu writes followed, generation %u, %d mismatches\n", (unsigned long long)writes,
+                generation, mismatch);
+}
+
+// Plain tab_registers access, as modbus_reply() did before the seqlock hooks
+static void _plain_read(const modbus_mapping_t *mb_mapping, int address, int nb, uint16_t *dest)
+{
+    for (int i = 0; i < nb; i++) {
+        dest[i] = ((volatile uint16_t *)mb_mapping->tab_registers)[address + i];
+    }
+}
+
+static void _plain_write(modbus_mapping_t *mb_mapping, int address, int nb, const uint16_t *src)
+{
+    for (int i = 0; i < nb; i++) {
+        ((volatile uint16_t *)mb_mapping->tab_registers)[address + i] = src[i];
+    }
+}
+
+int main(void)
+{
+    uint64_t api_torn = 0;
+    uint64_t server_torn = 0;
+
+    // what control_logic_update_init() registers
+    modbus_set_registers_access(_modbus_server_registers_read, _modbus_server_registers_write);
+    _stress("seqlock", &api_torn, &server_torn);
+    TEST_CHECK(api_torn == 0, "%llu torn reads through the control logic API", (unsigned long long)api_torn);
+    TEST_CHECK(server_torn == 0, "%llu torn reads through modbus_reply()", (unsigned long long)server_torn);
+
+    // without the seqlock on the read side; informational, tearing depends on the machine
+    modbus_set_registers_access(_plain_read, _plain_write);
+    _api_plain = 1;
+    _stress("unlocked", &api_torn, &server_torn);
+    _api_plain = 0;
+
+    modbus_set_registers_access(NULL, NULL);
+
+    _test_changes();
+
+    return TEST_RESULT();
+}
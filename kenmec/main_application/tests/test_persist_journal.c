@@ -0,0 +1,317 @@
+// Modbus table journal: a burst of HMI writes costs a few fdatasync calls
+// instead of one full table save each, and a journal cut at any byte by a
+// power loss (or with a corrupted record) replays up to the last good record
+// and is truncated there. Records of every Modbus data type replay to the
+// value the write callback stored.
+//
+// Benchmark: CONFIG_MODBUS_TABLE_JOURNAL_MAX_RATE writes per second for
+// RATE_RUN_MS must all go through the journal, none through the queue-full
+// fallback to a full snapshot.
+
+#define CONFIG_MODBUS_TABLE_JOURNAL_PATH "build/test_persist_journal.journal"
+#define CONFIG_MODBUS_TABLE_JOURNAL_DEBOUNCE_MS 20
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "../control_logic/control_logic_persist.c"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define BURST_RECORDS 200
+#define OVERFLOW_RECORDS 1000
+#define SYNC_WRITES 200
+#define CRASH_RECORDS 8
+#define TABLE_BASE 3000
+#define RATE_RUN_MS 1000
+
+static journal_record_t _record_make(uint16_t address, uint32_t value)
+{
+    journal_record_t record;
+
+    memset(&record, 0, sizeof(record));
+    record.magic = JOURNAL_RECORD_MAGIC;
+    record.address = address;
+    record.type = MODBUS_TYPE_UINT16;
+    record.value = value;
+    record.crc = _journal_record_crc(&record);
+
+    return record;
+}
+
+static off_t _file_size(int fd)
+{
+    struct stat st;
+
+    return (fstat(fd, &st) == 0) ? st.st_size : -1;
+}
+
+static void _table_clear(void)
+{
+    uint16_t zero = 0;
+
+    for (int i = 0; i < CRASH_RECORDS; i++) {
+        control_logic_update_to_modbus_table(TABLE_BASE + i, MODBUS_TYPE_UINT16, &zero);
+    }
+}
+
+// Cost of the old behaviour: one synchronous save per write, approximated by write + fdatasync
+static uint64_t _sync_write_us(void)
+{
+    const char *path = "build/test_persist_journal.sync";
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    journal_record_t record = _record_make(TABLE_BASE, 1);
+
+    uint64_t start = fake_now_ns();
+    for (int i = 0; i < SYNC_WRITES; i++) {
+        TEST_CHECK(write(fd, &record, sizeof(record)) == (ssize_t)sizeof(record), "sync write failed");
+        fdatasync(fd);
+    }
+    uint64_t elapsed = fake_now_ns() - start;
+
+    close(fd);
+    unlink(path);
+
+    return elapsed / SYNC_WRITES / 1000;
+}
+
+static void _test_burst(void)
+{
+    uint32_t fsync_before = 0;
+    uint32_t fsync_after = 0;
+    uint32_t compact_after = 0;
+
+    unlink(CONFIG_MODBUS_TABLE_JOURNAL_PATH);
+    TEST_CHECK(control_logic_persist_init() == SUCCESS, "persist init failed");
+    control_logic_persist_stats_get(&fsync_before, NULL, NULL);
+    uint32_t saves_before = fake_modbus_manager_save_count_get();
+
+    uint64_t start = fake_now_ns();
+    for (int i = 0; i < BURST_RECORDS; i++) {
+        control_logic_persist_record((uint16_t)(TABLE_BASE + i % CRASH_RECORDS), MODBUS_TYPE_UINT16, (uint32_t)i);
+    }
+    uint64_t record_ns = (fake_now_ns() - start) / BURST_RECORDS;
+
+    // let the debounced batches land
+    time_delay_ms(CONFIG_MODBUS_TABLE_JOURNAL_DEBOUNCE_MS * 10);
+
+    control_logic_persist_stats_get(&fsync_after, &compact_after, NULL);
+    uint32_t fsyncs = fsync_after - fsync_before;
+    uint32_t saves = fake_modbus_manager_save_count_get() - saves_before;
+
+    TEST_CHECK(fsyncs > 0 && fsyncs <= 10, "%u fdatasync calls for %d records", fsyncs, BURST_RECORDS);
+    TEST_CHECK(saves == 0, "%u full saves during the burst", saves);
+    TEST_CHECK(_file_size(_journal_fd) == (off_t)(BURST_RECORDS * sizeof(journal_record_t)), "journal size %lld",
+               (long long)_file_size(_journal_fd));
+
+    // more writes than the queue holds: one full snapshot instead of dropping records
+    for (int i = 0; i < OVERFLOW_RECORDS; i++) {
+        control_logic_persist_record((uint16_t)(TABLE_BASE + i % CRASH_RECORDS), MODBUS_TYPE_UINT16, (uint32_t)i);
+    }
+    time_delay_ms(CONFIG_MODBUS_TABLE_JOURNAL_DEBOUNCE_MS * 10);
+    uint32_t overflow_saves = fake_modbus_manager_save_count_get() - saves_before;
+    TEST_CHECK(overflow_saves >= 1 && overflow_saves <= 2, "%u full saves for an overflowing burst", overflow_saves);
+
+    TEST_CHECK(control_logic_persist_deinit() == SUCCESS, "persist deinit failed");
+    TEST_CHECK(fake_modbus_manager_save_count_get() - saves_before == overflow_saves + 1, "deinit did not compact");
+
+    struct stat st;
+    TEST_CHECK(stat(CONFIG_MODBUS_TABLE_JOURNAL_PATH, &st) == 0 && st.st_size == 0, "journal not empty after deinit");
+
+    TEST_REPORT("burst: %d writes -> %u fdatasync, %u full saves, %llu ns per write (sync write + fdatasync: %llu us)\n",
+                BURST_RECORDS, fsyncs, saves, (unsigned long long)record_ns, (unsigned long long)_sync_write_us());
+    TEST_REPORT("overflow: %d writes -> %u full saves\n", OVERFLOW_RECORDS, overflow_saves);
+}
+
+// Power loss while appending: the file ends anywhere inside the last records
+static void _test_torn_tail(void)
+{
+    journal_record_t records[CRASH_RECORDS];
+    size_t total = sizeof(records);
+    int failures_before = test_failures;
+
+    for (int i = 0; i < CRASH_RECORDS; i++) {
+        records[i] = _record_make((uint16_t)(TABLE_BASE + i), (uint32_t)(100 + i));
+    }
+
+    for (size_t cut = 0; cut <= total; cut++) {
+        int fd = open(CONFIG_MODBUS_TABLE_JOURNAL_PATH, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        TEST_CHECK(write(fd, records, cut) == (ssize_t)cut, "journal write failed");
+
+        _table_clear();
+        int count = _journal_replay(fd);
+        int expect = (int)(cut / sizeof(journal_record_t));
+
+        TEST_CHECK(count == expect, "cut %zu: replayed %d, expected %d", cut, count, expect);
+        TEST_CHECK(_file_size(fd) == (off_t)(expect * sizeof(journal_record_t)), "cut %zu: size %lld", cut,
+                   (long long)_file_size(fd));
+
+        for (int i = 0; i < CRASH_RECORDS; i++) {
+            uint16_t v = 0;
+            control_logic_load_from_modbus_table(TABLE_BASE + i, MODBUS_TYPE_UINT16, &v);
+            TEST_CHECK(v == ((i < expect) ? 100 + i : 0), "cut %zu: register %d = %u", cut, i, v);
+        }
+
+        // records appended after recovery follow the last good one
+        journal_record_t next = _record_make(TABLE_BASE, 999);
+        TEST_CHECK(write(fd, &next, sizeof(next)) == (ssize_t)sizeof(next), "append after replay failed");
+        _table_clear();
+        TEST_CHECK(_journal_replay(fd) == expect + 1, "cut %zu: record appended after recovery lost", cut);
+
+        close(fd);
+    }
+
+    TEST_REPORT("torn tail: %zu cut points recovered%s\n", total + 1, (test_failures == failures_before) ? "" : " (FAILED)");
+}
+
+// A record damaged in the middle: everything from it on is dropped
+static void _test_corrupt_record(void)
+{
+    journal_record_t records[CRASH_RECORDS];
+
+    for (int bad = 0; bad < CRASH_RECORDS; bad++) {
+        for (int i = 0; i < CRASH_RECORDS; i++) {
+            records[i] = _record_make((uint16_t)(TABLE_BASE + i), (uint32_t)(200 + i));
+        }
+        records[bad].value ^= 0x10;
+
+        int fd = open(CONFIG_MODBUS_TABLE_JOURNAL_PATH, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        TEST_CHECK(write(fd, records, sizeof(records)) == (ssize_t)sizeof(records), "journal write failed");
+
+        _table_clear();
+        TEST_CHECK(_journal_replay(fd) == bad, "bad record %d: replay did not stop there", bad);
+        TEST_CHECK(_file_size(fd) == (off_t)(bad * sizeof(journal_record_t)), "bad record %d: not truncated", bad);
+
+        uint16_t v = 0;
+        control_logic_load_from_modbus_table(TABLE_BASE + bad, MODBUS_TYPE_UINT16, &v);
+        TEST_CHECK(v == 0, "bad record %d applied", bad);
+
+        close(fd);
+    }
+}
+
+// Every data type the write callback accepts, replayed from the journal
+static void _test_replay_types(void)
+{
+    union {
+        float f;
+        uint32_t u32;
+    } pi = { .f = 3.14159f };
+    struct {
+        uint16_t address;
+        uint8_t type;
+        uint32_t value;
+    } writes[] = {
+        { TABLE_BASE + 0, MODBUS_TYPE_INT16, (uint32_t)(uint16_t)-1234 },
+        { TABLE_BASE + 1, MODBUS_TYPE_UINT16, 54321 },
+        { TABLE_BASE + 2, MODBUS_TYPE_INT32, (uint32_t)-123456 },
+        { TABLE_BASE + 4, MODBUS_TYPE_UINT32, 0xDEADBEEF },
+        { TABLE_BASE + 6, MODBUS_TYPE_FLOAT32, pi.u32 },
+        { TABLE_BASE + 8, MODBUS_TYPE_UINT64, 0x89ABCDEF },
+        { TABLE_BASE + 12, MODBUS_TYPE_UINT16_LOWBYTE, 0x5A },
+        { TABLE_BASE + 13, MODBUS_TYPE_UINT16_HIGHBYTE, 0xA5 },
+    };
+    int num = (int)(sizeof(writes) / sizeof(writes[0]));
+
+    // whatever the registers held before
+    uint16_t ones[14];
+    memset(ones, 0xFF, sizeof(ones));
+    for (int i = 0; i < 14; i++) {
+        control_logic_update_to_modbus_table(TABLE_BASE + i, MODBUS_TYPE_UINT16, &ones[i]);
+    }
+
+    int fd = open(CONFIG_MODBUS_TABLE_JOURNAL_PATH, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    for (int i = 0; i < num; i++) {
+        journal_record_t record = _record_make(writes[i].address, writes[i].value);
+        record.type = writes[i].type;
+        record.crc = _journal_record_crc(&record);
+        TEST_CHECK(write(fd, &record, sizeof(record)) == (ssize_t)sizeof(record), "journal write failed");
+    }
+    TEST_CHECK(_journal_replay(fd) == num, "not every record replayed");
+    close(fd);
+
+    int16_t i16 = 0;
+    uint16_t u16 = 0;
+    int32_t i32 = 0;
+    uint32_t u32 = 0;
+    float f32 = 0.0f;
+    uint64_t u64 = 0;
+    uint16_t low = 0;
+    uint16_t high = 0;
+    control_logic_load_from_modbus_table(writes[0].address, MODBUS_TYPE_INT16, &i16);
+    control_logic_load_from_modbus_table(writes[1].address, MODBUS_TYPE_UINT16, &u16);
+    control_logic_load_from_modbus_table(writes[2].address, MODBUS_TYPE_INT32, &i32);
+    control_logic_load_from_modbus_table(writes[3].address, MODBUS_TYPE_UINT32, &u32);
+    control_logic_load_from_modbus_table(writes[4].address, MODBUS_TYPE_FLOAT32, &f32);
+    control_logic_load_from_modbus_table(writes[5].address, MODBUS_TYPE_UINT64, &u64);
+    control_logic_load_from_modbus_table(writes[6].address, MODBUS_TYPE_UINT16, &low);
+    control_logic_load_from_modbus_table(writes[7].address, MODBUS_TYPE_UINT16, &high);
+
+    TEST_CHECK(i16 == -1234, "INT16 replayed as %d", i16);
+    TEST_CHECK(u16 == 54321, "UINT16 replayed as %u", u16);
+    TEST_CHECK(i32 == -123456, "INT32 replayed as %d", i32);
+    TEST_CHECK(u32 == 0xDEADBEEF, "UINT32 replayed as 0x%08X", u32);
+    TEST_CHECK(f32 == pi.f, "FLOAT32 replayed as %f", f32);
+    TEST_CHECK(u64 == 0x89ABCDEFULL, "UINT64 replayed as 0x%016llX", (unsigned long long)u64);
+    TEST_CHECK(low == 0x5A && high == 0xA5, "byte registers replayed as 0x%04X 0x%04X", low, high);
+}
+
+// The target write rate, spread evenly over RATE_RUN_MS
+static void _bench_rate(void)
+{
+    const uint64_t total = (uint64_t)CONFIG_MODBUS_TABLE_JOURNAL_MAX_RATE * RATE_RUN_MS / 1000;
+    uint32_t fsync_before = 0;
+    uint32_t compact_before = 0;
+    uint32_t overflow_before = 0;
+    uint32_t fsync_after = 0;
+    uint32_t compact_after = 0;
+    uint32_t overflow_after = 0;
+    uint64_t record_ns = 0;
+
+    unlink(CONFIG_MODBUS_TABLE_JOURNAL_PATH);
+    TEST_CHECK(control_logic_persist_init() == SUCCESS, "persist init failed");
+    control_logic_persist_stats_get(&fsync_before, &compact_before, &overflow_before);
+
+    uint64_t start = fake_now_ns();
+    uint64_t written = 0;
+    while (written < total) {
+        uint64_t due = (fake_now_ns() - start) * CONFIG_MODBUS_TABLE_JOURNAL_MAX_RATE / 1000000000ULL;
+        if (due > total) {
+            due = total;
+        }
+        uint64_t call_start = fake_now_ns();
+        for (; written < due; written++) {
+            control_logic_persist_record((uint16_t)(TABLE_BASE + written % CRASH_RECORDS), MODBUS_TYPE_UINT16,
+                                         (uint32_t)written);
+        }
+        record_ns += fake_now_ns() - call_start;
+        usleep(100);
+    }
+    double elapsed_s = (double)(fake_now_ns() - start) / 1e9;
+
+    time_delay_ms(CONFIG_MODBUS_TABLE_JOURNAL_DEBOUNCE_MS * 10);
+    control_logic_persist_stats_get(&fsync_after, &compact_after, &overflow_after);
+    TEST_CHECK(control_logic_persist_deinit() == SUCCESS, "persist deinit failed");
+
+    uint32_t overflows = overflow_after - overflow_before;
+    TEST_REPORT("rate: %llu writes in %.2f s (%.0f/s, queue %d) -> %u fdatasync, %u compactions, %u queue-full, "
+                "%llu ns per write\n",
+                (unsigned long long)total, elapsed_s, total / elapsed_s, PERSIST_QUEUE_SIZE, fsync_after - fsync_before,
+                compact_after - compact_before, overflows, (unsigned long long)(record_ns / total));
+    TEST_CHECK(overflows == 0, "%u writes hit a full queue at %d writes/s", overflows,
+               CONFIG_MODBUS_TABLE_JOURNAL_MAX_RATE);
+}
+
+int main(void)
+{
+    _test_burst();
+    _test_torn_tail();
+    _test_corrupt_record();
+    _test_replay_types();
+    _bench_rate();
+
+    unlink(CONFIG_MODBUS_TABLE_JOURNAL_PATH);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,184 @@
+// Shared PID controller against a first-order plant: the step response at
+// 10 Hz and 100 Hz must settle within the same time with bounded overshoot,
+// a long saturation must not wind up the integral, and the derivative filter
+// must keep measurement noise out of the output at short periods.
+
+#include <math.h>
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "kenmec/main_application/control_logic/pid_controller.h"
+
+#include "fake_platform.h"
+
+// plant: tau * dy/dt = gain * u - y
+#define PLANT_TAU_S 10.0f
+#define PLANT_GAIN 1.0f
+
+#define SETPOINT 50.0f
+#define SETTLE_BAND 0.02f
+#define RUN_S 120.0f
+
+typedef struct {
+    float overshoot;        // percent of the step
+    float settling_s;       // last time outside the band
+    float final;
+} step_result_t;
+
+static float _plant_step(float y, float u, float dt)
+{
+    // exact discretisation of the first-order lag for a constant input over dt
+    float a = expf(-dt / PLANT_TAU_S);
+
+    return a * y + (1.0f - a) * PLANT_GAIN * u;
+}
+
+static void _pid_setup(pid_controller_t *pid, float kd)
+{
+    pid_controller_init(pid, 2.0f, 0.3f, kd, 0.0f, 100.0f);
+}
+
+static step_result_t _step_response(float hz, float start_y, float setpoint, float run_s)
+{
+    pid_controller_t pid;
+    step_result_t result = { 0 };
+    float dt = 1.0f / hz;
+    float y = start_y;
+    float peak = start_y;
+    int steps = (int)(run_s * hz);
+
+    _pid_setup(&pid, 0.0f);
+
+    for (int i = 0; i < steps; i++) {
+        float u = pid_controller_update_dt(&pid, setpoint - y, (i == 0) ? 0.0f : dt);
+        y = _plant_step(y, u, dt);
+
+        if ((setpoint > start_y && y > peak) || (setpoint < start_y && y < peak)) {
+            peak = y;
+        }
+        if (fabsf(y - setpoint) > SETTLE_BAND * fabsf(setpoint - start_y)) {
+            result.settling_s = (i + 1) * dt;
+        }
+    }
+
+    result.overshoot = 100.0f * fabsf(peak - setpoint) / fabsf(setpoint - start_y);
+    if ((setpoint > start_y && peak < setpoint) || (setpoint < start_y && peak > setpoint)) {
+        result.overshoot = 0.0f;
+    }
+    result.final = y;
+
+    return result;
+}
+
+static void _test_step(void)
+{
+    step_result_t r10 = _step_response(10.0f, 0.0f, SETPOINT, RUN_S);
+    step_result_t r100 = _step_response(100.0f, 0.0f, SETPOINT, RUN_S);
+
+    TEST_CHECK(fabsf(r10.final - SETPOINT) < 0.1f, "10 Hz final %.3f", r10.final);
+    TEST_CHECK(fabsf(r100.final - SETPOINT) < 0.1f, "100 Hz final %.3f", r100.final);
+    TEST_CHECK(r10.settling_s < 40.0f && r100.settling_s < 40.0f, "settling %.1f / %.1f s", r10.settling_s,
+               r100.settling_s);
+    TEST_CHECK(r10.overshoot < 15.0f && r100.overshoot < 15.0f, "overshoot %.1f / %.1f %%", r10.overshoot,
+               r100.overshoot);
+
+    // the same tuning behaves the same at both rates
+    TEST_CHECK(fabsf(r10.settling_s - r100.settling_s) < 3.0f, "settling differs: %.1f vs %.1f s", r10.settling_s,
+               r100.settling_s);
+    TEST_CHECK(fabsf(r10.overshoot - r100.overshoot) < 2.0f, "overshoot differs: %.1f vs %.1f %%", r10.overshoot,
+               r100.overshoot);
+
+    TEST_REPORT("step  10 Hz: settling %5.1f s, overshoot %4.1f %%\n", r10.settling_s, r10.overshoot);
+    TEST_REPORT("step 100 Hz: settling %5.1f s, overshoot %4.1f %%\n", r100.settling_s, r100.overshoot);
+}
+
+// Unreachable setpoint for a minute, then a reachable one: without windup the
+// response from the saturated state matches a fresh controller's
+static void _test_windup(float hz)
+{
+    pid_controller_t pid;
+    float dt = 1.0f / hz;
+    float y = 0.0f;
+    float settling_s = 0.0f;
+
+    _pid_setup(&pid, 0.0f);
+
+    for (int i = 0; i < (int)(60.0f * hz); i++) {
+        float u = pid_controller_update_dt(&pid, 200.0f - y, dt);
+        y = _plant_step(y, u, dt);
+    }
+    TEST_CHECK(pid.output == pid.output_max, "%.0f Hz: not saturated", hz);
+    TEST_CHECK(pid.i_term < 1.0f, "%.0f Hz: integral wound up to %.1f while saturated", hz, pid.i_term);
+
+    float start_y = y;
+    for (int i = 0; i < (int)(RUN_S * hz); i++) {
+        float u = pid_controller_update_dt(&pid, SETPOINT - y, dt);
+        y = _plant_step(y, u, dt);
+        if (fabsf(y - SETPOINT) > SETTLE_BAND * fabsf(SETPOINT - start_y)) {
+            settling_s = (i + 1) * dt;
+        }
+    }
+
+    step_result_t fresh = _step_response(hz, start_y, SETPOINT, RUN_S);
+
+    TEST_CHECK(fabsf(y - SETPOINT) < 0.1f, "%.0f Hz: final %.3f after saturation", hz, y);
+    TEST_CHECK(settling_s <= fresh.settling_s + 2.0f, "%.0f Hz: settling %.1f s after saturation, %.1f s fresh", hz,
+               settling_s, fresh.settling_s);
+
+    TEST_REPORT("windup %3.0f Hz: settling %4.1f s after 60 s saturated, %4.1f s from a fresh controller\n", hz,
+                settling_s, fresh.settling_s);
+}
+
+// Measurement noise on a steady plant: the filtered derivative stays small at 100 Hz
+static void _test_derivative_noise(void)
+{
+    pid_controller_t filtered;
+    pid_controller_t raw;
+    float dt = 0.01f;
+    float max_filtered = 0.0f;
+    float max_raw = 0.0f;
+
+    _pid_setup(&filtered, 1.0f);
+    _pid_setup(&raw, 1.0f);
+    raw.derivative_tau = 0.0f;
+
+    srand(1);
+    for (int i = 0; i < 1000; i++) {
+        float noise = ((float)rand() / (float)RAND_MAX - 0.5f) * 0.2f;
+        pid_controller_update_dt(&filtered, noise, dt);
+        pid_controller_update_dt(&raw, noise, dt);
+        if (i > 100) {
+            max_filtered = fmaxf(max_filtered, fabsf(filtered.d_term));
+            max_raw = fmaxf(max_raw, fabsf(raw.d_term));
+        }
+    }
+
+    TEST_CHECK(max_filtered * 10.0f < max_raw, "derivative filter: %.2f vs unfiltered %.2f", max_filtered, max_raw);
+    TEST_REPORT("noise 100 Hz: |D| max %.2f filtered, %.2f unfiltered\n", max_filtered, max_raw);
+}
+
+// The wall-clock entry point: first call is proportional only, dt comes from the monotonic clock
+static void _test_monotonic_update(void)
+{
+    pid_controller_t pid;
+
+    pid_controller_init(&pid, 1.0f, 1.0f, 0.0f, -100.0f, 100.0f);
+
+    float first = pid_controller_update(&pid, 10.0f);
+    TEST_CHECK(first == 10.0f && pid.integral == 0.0f, "first call %.3f, integral %.3f", first, pid.integral);
+
+    usleep(100000);
+    pid_controller_update(&pid, 10.0f);
+    TEST_CHECK(pid.integral > 0.9f && pid.integral < 1.5f, "integral after 100 ms: %.3f", pid.integral);
+}
+
+int main(void)
+{
+    _test_step();
+    _test_windup(10.0f);
+    _test_windup(100.0f);
+    _test_derivative_noise();
+    _test_monotonic_update();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,321 @@
+// Adaptive poll planner: simulated boards on virtual time.
+//
+// Two IO boards, two RTD boards and an RS485 device set (3 block reads per
+// round) are polled for ten simulated minutes. An AI current loop ramps
+// 4 -> 20 mA twice, a second one oscillates for a minute, temperatures
+// drift slowly, and for 40 s every analog signal moves fast at once so the
+// planner has to stay inside the HID bus budget.
+//
+// Checks: fast signals reach the shortest period, stable ones the longest,
+// the bus stays within the budget over any 5 s window, and the ramps are
+// tracked better than with the old fixed 1000 ms refresh.
+//
+// Benchmark: bus utilization and staleness (age of the value in the Modbus
+// table) per signal class, planner against the fixed refresh.
+
+#include <math.h>
+
+#include "../control_logic/control_logic_poll_plan.c"
+
+#include "fake_platform.h"
+
+#define SIM_MS (600 * 1000)
+#define TICK_MS 10
+#define BUDGET 40
+#define RS485_COST 3.0f
+#define FIXED_PERIOD_MS 1000
+#define BUS_WINDOW_MS 5000
+
+#define IO_PORT_A 0
+#define IO_PORT_B 1
+#define RTD_PORT_A 2
+#define RTD_PORT_B 3
+
+#define BURST_FROM_S 400.0
+#define BURST_TO_S 440.0
+
+typedef struct {
+    uint64_t polls;
+    uint64_t transactions;
+    double staleness_sum;               // ms, one sample per task per tick
+    uint64_t staleness_max;
+    double error_sum;                   // class units, one sample per task per tick
+    uint64_t samples;
+} class_stats_t;
+
+typedef struct {
+    class_stats_t classes[CONTROL_LOGIC_POLL_CLASS_NUM];
+    uint64_t transactions;
+    double peak_window;                 // transactions per second over the busiest window
+    double ramp_error;                  // mean error of the ramping AI current while it ramps
+    uint32_t current_period_in_ramp;
+    uint32_t pt100_period_stable;
+} sim_result_t;
+
+typedef struct {
+    uint8_t enabled;
+    uint64_t last_ms;
+    float values[CONTROL_LOGIC_POLL_VALUES_MAX];
+} sim_task_t;
+
+static sim_task_t _tasks[CONTROL_LOGIC_POLL_SLOT_NUM][CONTROL_LOGIC_POLL_CLASS_NUM];
+
+static int _in_burst(double t)
+{
+    return t >= BURST_FROM_S && t < BURST_TO_S;
+}
+
+// 4 -> 20 mA over 20 s at 100 s, back down at 300 s
+static double _ramp_current(double t)
+{
+    if (t < 100.0) return 4000.0;
+    if (t < 120.0) return 4000.0 + (t - 100.0) * 800.0;
+    if (t < 300.0) return 20000.0;
+    if (t < 320.0) return 20000.0 - (t - 300.0) * 800.0;
+    return 4000.0;
+}
+
+static int _signal(int slot, control_logic_poll_class_t cls, double t, float *values)
+{
+    double burst = _in_burst(t) ? 1.0 : 0.0;
+
+    switch (cls) {
+        case CONTROL_LOGIC_POLL_DI:
+            for (int i = 0; i < 8; i++) values[i] = 0.0f;
+            values[0] = (slot == IO_PORT_A) ? (float)(((int)(t / 30.0)) & 1) : 0.0f;
+            return 8;
+        case CONTROL_LOGIC_POLL_DO:
+            for (int i = 0; i < 8; i++) values[i] = (float)(i & 1);
+            return 8;
+        case CONTROL_LOGIC_POLL_AI_VOLTAGE:
+            for (int i = 0; i < 4; i++) values[i] = (float)(5000.0 + 2000.0 * burst * sin(t * (1.0 + i)));
+            return 4;
+        case CONTROL_LOGIC_POLL_AI_CURRENT:
+            for (int i = 0; i < 4; i++) values[i] = (float)(12000.0 + 4000.0 * burst * sin(t * 0.7 * (1.0 + i)));
+            if (slot == IO_PORT_A) {
+                values[0] = (float)_ramp_current(t);
+            }
+            if (slot == IO_PORT_B && t >= 200.0 && t < 260.0) {
+                values[1] = (float)(12000.0 + 4000.0 * sin(t * 2.0 * M_PI / 10.0));
+            }
+            return 4;
+        case CONTROL_LOGIC_POLL_PT100:
+            for (int i = 0; i < 8; i++) {
+                values[i] = (float)(250.0 + i + 0.002 * t + burst * 20.0 * (t - BURST_FROM_S));
+            }
+            return 8;
+        case CONTROL_LOGIC_POLL_PWM_FREQ:
+            for (int i = 0; i < 8; i++) values[i] = (float)(1000.0 + burst * 20.0 * (t - BURST_FROM_S));
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+static void _tasks_enable(void)
+{
+    memset(_tasks, 0, sizeof(_tasks));
+    for (int c = CONTROL_LOGIC_POLL_DI; c <= CONTROL_LOGIC_POLL_AI_CURRENT; c++) {
+        _tasks[IO_PORT_A][c].enabled = 1;
+        _tasks[IO_PORT_B][c].enabled = 1;
+    }
+    _tasks[RTD_PORT_A][CONTROL_LOGIC_POLL_PT100].enabled = 1;
+    _tasks[RTD_PORT_A][CONTROL_LOGIC_POLL_PWM_FREQ].enabled = 1;
+    _tasks[RTD_PORT_B][CONTROL_LOGIC_POLL_PT100].enabled = 1;
+    _tasks[RTD_PORT_B][CONTROL_LOGIC_POLL_PWM_FREQ].enabled = 1;
+    _tasks[CONTROL_LOGIC_POLL_RS485_SLOT][CONTROL_LOGIC_POLL_RS485].enabled = 1;
+}
+
+static uint32_t _slot_mask(int slot)
+{
+    uint32_t mask = 0;
+
+    for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+        if (_tasks[slot][c].enabled) {
+            mask |= 1u << c;
+        }
+    }
+
+    return mask;
+}
+
+static void _poll(int slot, control_logic_poll_class_t cls, uint64_t now, sim_result_t *result, uint32_t *window)
+{
+    float cost = (cls == CONTROL_LOGIC_POLL_RS485) ? RS485_COST : 1.0f;
+    int count = _signal(slot, cls, now / 1000.0, _tasks[slot][cls].values);
+
+    _tasks[slot][cls].last_ms = now;
+    result->classes[cls].polls++;
+    result->classes[cls].transactions += (uint64_t)cost;
+    result->transactions += (uint64_t)cost;
+    window[(now / TICK_MS) % (BUS_WINDOW_MS / TICK_MS)] += (uint32_t)cost;
+
+    control_logic_poll_plan_done(slot, cls, now, count ? _tasks[slot][cls].values : NULL, count, cost);
+}
+
+static void _simulate(int adaptive, sim_result_t *result)
+{
+    static uint32_t window[BUS_WINDOW_MS / TICK_MS];
+    uint64_t window_sum = 0;
+    double ramp_error = 0.0;
+    uint64_t ramp_samples = 0;
+
+    memset(result, 0, sizeof(*result));
+    memset(window, 0, sizeof(window));
+    _tasks_enable();
+    control_logic_poll_plan_reset(BUDGET);
+    for (int slot = 0; slot < CONTROL_LOGIC_POLL_SLOT_NUM; slot++) {
+        control_logic_poll_plan_slot_set(slot, _slot_mask(slot), 0);
+    }
+
+    for (uint64_t now = 0; now < SIM_MS; now += TICK_MS) {
+        uint32_t *bucket = &window[(now / TICK_MS) % (BUS_WINDOW_MS / TICK_MS)];
+        window_sum -= *bucket;
+        *bucket = 0;
+
+        for (int slot = 0; slot < CONTROL_LOGIC_POLL_SLOT_NUM; slot++) {
+            if (adaptive) {
+                control_logic_poll_class_t cls;
+                while (control_logic_poll_plan_next(slot, now, &cls) == SUCCESS) {
+                    _poll(slot, cls, now, result, window);
+                }
+            } else if (now % FIXED_PERIOD_MS == 0) {
+                for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+                    if (_tasks[slot][c].enabled) {
+                        _poll(slot, (control_logic_poll_class_t)c, now, result, window);
+                    }
+                }
+            }
+        }
+        window_sum += *bucket;
+        if (now >= BUS_WINDOW_MS && window_sum * 1000.0 / BUS_WINDOW_MS > result->peak_window) {
+            result->peak_window = window_sum * 1000.0 / BUS_WINDOW_MS;
+        }
+
+        // staleness and error of what the Modbus table holds right now
+        double t = now / 1000.0;
+        for (int slot = 0; slot < CONTROL_LOGIC_POLL_SLOT_NUM; slot++) {
+            for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+                sim_task_t *task = &_tasks[slot][c];
+                if (!task->enabled) {
+                    continue;
+                }
+                class_stats_t *stats = &result->classes[c];
+                uint64_t age = now - task->last_ms;
+                float truth[CONTROL_LOGIC_POLL_VALUES_MAX];
+                int count = _signal(slot, (control_logic_poll_class_t)c, t, truth);
+                double error = 0.0;
+                for (int i = 0; i < count; i++) {
+                    double e = fabs(truth[i] - task->values[i]);
+                    if (e > error) error = e;
+                }
+                stats->staleness_sum += (double)age;
+                stats->staleness_max = (age > stats->staleness_max) ? age : stats->staleness_max;
+                stats->error_sum += error;
+                stats->samples++;
+                if (slot == IO_PORT_A && c == CONTROL_LOGIC_POLL_AI_CURRENT &&
+                    ((t >= 100.0 && t < 120.0) || (t >= 300.0 && t < 320.0))) {
+                    ramp_error += fabs(truth[0] - task->values[0]);
+                    ramp_samples++;
+                }
+            }
+        }
+
+        control_logic_poll_task_status_t status;
+        if (now == 110000) {
+            control_logic_poll_plan_status_get(IO_PORT_A, CONTROL_LOGIC_POLL_AI_CURRENT, &status);
+            result->current_period_in_ramp = status.effective_ms;
+        }
+        if (now == 90000) {
+            control_logic_poll_plan_status_get(RTD_PORT_A, CONTROL_LOGIC_POLL_PT100, &status);
+            result->pt100_period_stable = status.effective_ms;
+        }
+    }
+
+    result->ramp_error = ramp_samples ? ramp_error / ramp_samples : 0.0;
+}
+
+static void _report(const char *name, const sim_result_t *result)
+{
+    TEST_REPORT("%s: %.1f HID transactions/s on average, %.1f/s over the busiest %d s (budget %d)\n", name,
+                result->transactions * 1000.0 / SIM_MS, result->peak_window, BUS_WINDOW_MS / 1000, BUDGET);
+    TEST_REPORT("  %-11s %8s %10s %14s %12s %12s\n", "class", "polls/s", "bus share", "staleness avg", "max",
+                "mean error");
+    for (int c = 0; c < CONTROL_LOGIC_POLL_CLASS_NUM; c++) {
+        const class_stats_t *stats = &result->classes[c];
+        if (stats->samples == 0) {
+            continue;
+        }
+        TEST_REPORT("  %-11s %8.2f %9.1f%% %11.0f ms %9llu ms %12.1f\n", control_logic_poll_plan_class_name((control_logic_poll_class_t)c),
+                    stats->polls * 1000.0 / SIM_MS, result->transactions ? stats->transactions * 100.0 / result->transactions : 0.0,
+                    stats->staleness_sum / stats->samples, (unsigned long long)stats->staleness_max,
+                    stats->error_sum / stats->samples);
+    }
+}
+
+static void _test_api(void)
+{
+    control_logic_poll_class_t cls;
+    control_logic_poll_task_status_t status;
+
+    control_logic_poll_plan_reset(BUDGET);
+    TEST_CHECK(control_logic_poll_plan_reset(0) == FAIL, "zero budget accepted");
+    TEST_CHECK(control_logic_poll_plan_slot_set(CONTROL_LOGIC_POLL_SLOT_NUM, 1, 0) == FAIL, "bad slot accepted");
+    TEST_CHECK(control_logic_poll_plan_next(0, 0, &cls) == FAIL, "empty slot has work");
+    TEST_CHECK(control_logic_poll_plan_wakeup_ms(0) == UINT64_MAX, "empty slot has a wakeup");
+
+    // shortest period first; one transaction at BUDGET/s holds the bus for 1000 / BUDGET ms
+    control_logic_poll_plan_slot_set(0, (1u << CONTROL_LOGIC_POLL_DO) | (1u << CONTROL_LOGIC_POLL_DI), 1000);
+    TEST_CHECK(control_logic_poll_plan_next(0, 1000, &cls) == SUCCESS && cls == CONTROL_LOGIC_POLL_DI, "DI not first");
+    TEST_CHECK(control_logic_poll_plan_next(0, 1000, &cls) == FAIL, "dispatched over the bus budget");
+    TEST_CHECK(control_logic_poll_plan_wakeup_ms(0) == 1000 + 1000 / BUDGET, "budget wakeup %llu",
+               (unsigned long long)control_logic_poll_plan_wakeup_ms(0));
+    TEST_CHECK(control_logic_poll_plan_next(0, 1000 + 1000 / BUDGET, &cls) == SUCCESS && cls == CONTROL_LOGIC_POLL_DO,
+               "DO not second");
+    // a task handed out is not handed out again before done
+    TEST_CHECK(control_logic_poll_plan_next(0, 1000 + 3000 / BUDGET, &cls) == FAIL, "busy task handed out twice");
+    control_logic_poll_plan_done(0, CONTROL_LOGIC_POLL_DI, 1000, NULL, 0, 1.0f);
+    control_logic_poll_plan_done(0, CONTROL_LOGIC_POLL_DO, 1000, NULL, 0, 1.0f);
+    TEST_CHECK(control_logic_poll_plan_wakeup_ms(0) == 1000 + CONFIG_CONTROL_LOGIC_POLL_DI_MS, "wakeup %llu",
+               (unsigned long long)control_logic_poll_plan_wakeup_ms(0));
+
+    // disabling drops the task from the budget
+    control_logic_poll_plan_slot_set(0, 0, 2000);
+    control_logic_poll_plan_status_get(0, CONTROL_LOGIC_POLL_DI, &status);
+    TEST_CHECK(!status.enabled && control_logic_poll_plan_demand() == 0.0f, "disabled task still counted");
+
+    // a slot refused for the budget is served before one that asks later
+    control_logic_poll_plan_slot_set(1, 1u << CONTROL_LOGIC_POLL_DI, 5000);
+    control_logic_poll_plan_slot_set(3, 1u << CONTROL_LOGIC_POLL_DI, 5000);
+    TEST_CHECK(control_logic_poll_plan_next(1, 5000, &cls) == SUCCESS, "slot 1 refused");
+    TEST_CHECK(control_logic_poll_plan_next(3, 5000, &cls) == FAIL, "slot 3 dispatched over the budget");
+    control_logic_poll_plan_slot_set(2, 1u << CONTROL_LOGIC_POLL_DI, 5000);
+    TEST_CHECK(control_logic_poll_plan_next(2, 5000 + 1000 / BUDGET, &cls) == FAIL, "slot 2 went before slot 3");
+    TEST_CHECK(control_logic_poll_plan_next(3, 5000 + 1000 / BUDGET, &cls) == SUCCESS, "waiting slot 3 refused");
+}
+
+int main(void)
+{
+    sim_result_t fixed;
+    sim_result_t adaptive;
+
+    _test_api();
+
+    _simulate(0, &fixed);
+    _simulate(1, &adaptive);
+
+    _report("fixed 1000 ms", &fixed);
+    _report("planner", &adaptive);
+    TEST_REPORT("AI current ramp: mean error %.0f uA with the planner, %.0f uA fixed\n", adaptive.ramp_error,
+                fixed.ramp_error);
+
+    TEST_CHECK(adaptive.current_period_in_ramp == CONFIG_CONTROL_LOGIC_POLL_AI_CURRENT_MS / 4,
+               "ramping AI current polled every %u ms", adaptive.current_period_in_ramp);
+    TEST_CHECK(adaptive.pt100_period_stable == CONFIG_CONTROL_LOGIC_POLL_PT100_MS * 4,
+               "stable PT100 polled every %u ms", adaptive.pt100_period_stable);
+    TEST_CHECK(adaptive.peak_window <= BUDGET, "bus at %.1f transactions/s, budget %d", adaptive.peak_window, BUDGET);
+    TEST_CHECK(adaptive.ramp_error * 2.0 < fixed.ramp_error, "ramp error %.0f vs %.0f fixed", adaptive.ramp_error,
+               fixed.ramp_error);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,122 @@
+// Per-port polling: every HID port runs on its own poller thread, so a board
+// that answers slowly only delays its own port. The healthy ports must keep
+// their refresh rate while one IO board takes 100 ms per transaction, an
+// empty port never publishes, and a new value on a fast board is in the
+// Modbus table once its port generation has moved on.
+
+#include "../control_logic/control_logic_update.c"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define FAST_IO_PORT 0
+#define FAST_RTD_PORT 1
+#define SLOW_IO_PORT 2
+#define EMPTY_PORT 3
+
+#define POLL_PERIOD_MS 20
+#define SLOW_LATENCY_US 100000          // five transactions per IO cycle: about 500 ms
+#define WINDOW_MS 1000
+
+static uint32_t _generation(uint16_t port)
+{
+    control_logic_port_status_t status;
+
+    control_logic_update_port_status_get(port, &status);
+
+    return status.generation;
+}
+
+static void _generations_get(uint32_t generations[HID_DEVICES_MAX])
+{
+    for (uint16_t port = 0; port < HID_DEVICES_MAX; port++) {
+        generations[port] = _generation(port);
+    }
+}
+
+static void _wait_generations(uint16_t port, uint32_t count)
+{
+    uint32_t target = _generation(port) + count;
+
+    for (int i = 0; i < 1000 && (int32_t)(_generation(port) - target) < 0; i++) {
+        time_delay_ms(1);
+    }
+}
+
+static void _test_refresh_rate(void)
+{
+    uint32_t before[HID_DEVICES_MAX];
+    uint32_t after[HID_DEVICES_MAX];
+    uint32_t expect = WINDOW_MS / POLL_PERIOD_MS;
+
+    // let every poller finish its first cycle, the slow one included
+    time_delay_ms(100);
+
+    _generations_get(before);
+    time_delay_ms(WINDOW_MS);
+    _generations_get(after);
+
+    for (uint16_t port = 0; port < HID_DEVICES_MAX; port++) {
+        control_logic_port_status_t status;
+        control_logic_update_port_status_get(port, &status);
+        TEST_REPORT("port %u: pid 0x%02x, %3u refreshes in %u ms, last cycle %u ms\n", port, status.pid,
+                    after[port] - before[port], WINDOW_MS, status.cycle_ms);
+    }
+
+    // healthy ports: at least half the nominal rate (a shared walk would give them the slow port's two)
+    TEST_CHECK(after[FAST_IO_PORT] - before[FAST_IO_PORT] >= expect / 2, "fast IO port refreshed %u times",
+               after[FAST_IO_PORT] - before[FAST_IO_PORT]);
+    TEST_CHECK(after[FAST_RTD_PORT] - before[FAST_RTD_PORT] >= expect / 2, "fast RTD port refreshed %u times",
+               after[FAST_RTD_PORT] - before[FAST_RTD_PORT]);
+    TEST_CHECK(after[SLOW_IO_PORT] - before[SLOW_IO_PORT] <= 3, "slow port refreshed %u times",
+               after[SLOW_IO_PORT] - before[SLOW_IO_PORT]);
+    TEST_CHECK(after[EMPTY_PORT] == 0, "empty port published %u times", after[EMPTY_PORT]);
+}
+
+static void _test_publication(void)
+{
+    uint16_t address = HID_BASE_ADDRESS + (FAST_IO_PORT * HID_IO_BOARD_BASE_ADDRESS) + MODBUS_ADDRESS_GPIO_INPUT_0 + 3;
+    uint16_t value = 0;
+
+    __atomic_store_n(&fake_hid_boards[FAST_IO_PORT].di[3], 1, __ATOMIC_RELAXED);
+
+    // a cycle may have read the inputs before the store; the one after it has not
+    _wait_generations(FAST_IO_PORT, 2);
+    control_logic_load_from_modbus_table(address, MODBUS_TYPE_UINT16, &value);
+    TEST_CHECK(value == 1, "DI 3 of the fast IO board reads %u", value);
+
+    // the slow board is still served, just at its own pace
+    control_logic_port_status_t status;
+    control_logic_update_port_status_get(SLOW_IO_PORT, &status);
+    TEST_CHECK(status.pid == HID_IO_BOARD_PID && status.generation > 0 && status.failures == 0,
+               "slow port: pid 0x%x, generation %u, failures %u", status.pid, status.generation, status.failures);
+
+    // a board that stops answering is counted as failing and does not stop the others
+    uint32_t fast_before = _generation(FAST_RTD_PORT);
+    __atomic_store_n(&fake_hid_boards[FAST_IO_PORT].fail, 1, __ATOMIC_RELAXED);
+    _wait_generations(FAST_IO_PORT, 2);
+    control_logic_update_port_status_get(FAST_IO_PORT, &status);
+    TEST_CHECK(status.failures > 0, "failing board not counted");
+    TEST_CHECK(_generation(FAST_RTD_PORT) != fast_before, "RTD port stalled");
+    __atomic_store_n(&fake_hid_boards[FAST_IO_PORT].fail, 0, __ATOMIC_RELAXED);
+}
+
+int main(void)
+{
+    fake_hid_reset();
+    fake_hid_boards[FAST_IO_PORT].pid = HID_IO_BOARD_PID;
+    fake_hid_boards[FAST_RTD_PORT].pid = HID_RTD_BOARD_PID;
+    fake_hid_boards[SLOW_IO_PORT].pid = HID_IO_BOARD_PID;
+    fake_hid_boards[SLOW_IO_PORT].latency_us = SLOW_LATENCY_US;
+
+    for (uint16_t port = 0; port < HID_DEVICES_MAX; port++) {
+        TEST_CHECK(control_logic_update_port_period_set(port, POLL_PERIOD_MS) == SUCCESS, "period %u", port);
+    }
+    TEST_CHECK(control_logic_update_port_period_set(HID_DEVICES_MAX, POLL_PERIOD_MS) == FAIL, "bad port accepted");
+    TEST_CHECK(_port_pollers_start() == SUCCESS, "pollers not started");
+
+    _test_refresh_rate();
+    _test_publication();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,177 @@
+// Register map loading: a 5000-entry map in shuffled order resolves every
+// address exactly like the old cJSON_GetArrayItem + strcmp scan, the load time
+// is reported against that scan, validation reports unknown, duplicate and
+// malformed entries without touching the list, and the name index follows a
+// list whose names change.
+
+#include "../control_logic/control_logic_config.c"
+
+#include "fake_platform.h"
+
+#define REGISTER_NUM 5000
+#define LOAD_NUM 20
+#define LEGACY_LOAD_NUM 2
+
+static char _names[REGISTER_NUM][16];
+static uint32_t _addresses[REGISTER_NUM];
+static uint32_t _legacy_addresses[REGISTER_NUM];
+static control_logic_register_t _register_list[REGISTER_NUM];
+static control_logic_register_t _legacy_register_list[REGISTER_NUM];
+
+static void _register_lists_init(void)
+{
+    for (int i = 0; i < REGISTER_NUM; i++) {
+        snprintf(_names[i], sizeof(_names[i]), "REG_%04d", i);
+        _register_list[i].name = _names[i];
+        _register_list[i].address_ptr = &_addresses[i];
+        _register_list[i].default_address = 400000 + i;
+        _register_list[i].type = CONTROL_LOGIC_REGISTER_READ_WRITE;
+        _legacy_register_list[i] = _register_list[i];
+        _legacy_register_list[i].address_ptr = &_legacy_addresses[i];
+    }
+}
+
+// Entries in a shuffled order so neither loader finds names in list order
+static char *_register_map_json(int salt)
+{
+    cJSON *root = cJSON_CreateArray();
+
+    for (int i = 0; i < REGISTER_NUM; i++) {
+        int n = (int)(((uint32_t)i * 2909u + (uint32_t)salt) % REGISTER_NUM);
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", _names[n]);
+        cJSON_AddNumberToObject(item, "address", 410000 + n * 3 + salt);
+        cJSON_AddItemToArray(root, item);
+    }
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+
+    return json;
+}
+
+// control_logic_register_load_from_json() before the name index
+static int _legacy_load(const char *jsonPayload, control_logic_register_t *register_list, uint32_t list_size)
+{
+    cJSON *registers_array = cJSON_Parse(jsonPayload);
+    if (registers_array == NULL) {
+        return FAIL;
+    }
+
+    int registers_array_size = cJSON_GetArraySize(registers_array);
+    for (int i = 0; i < registers_array_size; i++) {
+        cJSON *jsonItem = cJSON_GetArrayItem(registers_array, i);
+        if (cJSON_IsObject(jsonItem)) {
+            cJSON *jsonName = cJSON_GetObjectItemCaseSensitive(jsonItem, "name");
+            if (cJSON_IsString(jsonName)) {
+                for (uint32_t j = 0; j < list_size; j++) {
+                    if (register_list[j].name != NULL && strcmp(jsonName->valuestring, register_list[j].name) == 0) {
+                        cJSON *jsonAddress = cJSON_GetObjectItemCaseSensitive(jsonItem, "address");
+                        if (cJSON_IsNumber(jsonAddress) && register_list[j].address_ptr != NULL) {
+                            *(register_list[j].address_ptr) = (int32_t)jsonAddress->valueint;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    cJSON_Delete(registers_array);
+
+    return SUCCESS;
+}
+
+static void _test_load(void)
+{
+    char *json = _register_map_json(1);
+
+    TEST_CHECK(control_logic_register_load_from_json(json, _register_list, REGISTER_NUM) == SUCCESS, "load failed");
+    TEST_CHECK(_legacy_load(json, _legacy_register_list, REGISTER_NUM) == SUCCESS, "legacy load failed");
+    TEST_CHECK(memcmp(_addresses, _legacy_addresses, sizeof(_addresses)) == 0,
+               "addresses differ from the legacy loader");
+    TEST_CHECK(_addresses[0] == 410001 && _addresses[REGISTER_NUM - 1] == 410000 + (REGISTER_NUM - 1) * 3 + 1,
+               "unexpected addresses %u, %u", _addresses[0], _addresses[REGISTER_NUM - 1]);
+
+    uint64_t start = fake_now_ns();
+    for (int i = 0; i < LOAD_NUM; i++) {
+        control_logic_register_load_from_json(json, _register_list, REGISTER_NUM);
+    }
+    double index_ms = (double)(fake_now_ns() - start) / 1e6 / LOAD_NUM;
+
+    start = fake_now_ns();
+    for (int i = 0; i < LEGACY_LOAD_NUM; i++) {
+        _legacy_load(json, _legacy_register_list, REGISTER_NUM);
+    }
+    double legacy_ms = (double)(fake_now_ns() - start) / 1e6 / LEGACY_LOAD_NUM;
+
+    start = fake_now_ns();
+    for (int i = 0; i < LOAD_NUM; i++) {
+        control_logic_register_validate_json(json, _register_list, REGISTER_NUM);
+    }
+    double validate_ms = (double)(fake_now_ns() - start) / 1e6 / LOAD_NUM;
+
+    TEST_CHECK(index_ms < legacy_ms, "indexed load (%.2f ms) not faster than the legacy scan (%.2f ms)", index_ms,
+               legacy_ms);
+    TEST_REPORT("%d-entry register map: %.2f ms indexed, %.2f ms legacy scan (%.0fx), %.2f ms validate\n",
+                REGISTER_NUM, index_ms, legacy_ms, legacy_ms / index_ms, validate_ms);
+
+    free(json);
+}
+
+static void _test_validate(void)
+{
+    char *json = _register_map_json(2);
+    uint32_t before[REGISTER_NUM];
+
+    TEST_CHECK(control_logic_register_validate_json(json, _register_list, REGISTER_NUM) == SUCCESS,
+               "valid map rejected");
+    free(json);
+
+    static const char *invalid[] = {
+        "[{\"name\":\"REG_0001\",\"address\":1},{\"name\":\"NO_SUCH_REG\",\"address\":2}]",
+        "[{\"name\":\"REG_0001\",\"address\":1},{\"name\":\"REG_0001\",\"address\":2}]",
+        "[{\"name\":\"REG_0001\",\"address\":-1}]",
+        "[{\"name\":\"REG_0001\",\"address\":1.5}]",
+        "[{\"name\":\"REG_0001\",\"address\":\"1\"}]",
+        "[{\"name\":\"REG_0001\",\"address\":1},7]",
+        "{\"name\":\"REG_0001\",\"address\":1}",
+        "[]",
+    };
+
+    memcpy(before, _addresses, sizeof(before));
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        TEST_CHECK(control_logic_register_validate_json(invalid[i], _register_list, REGISTER_NUM) == FAIL,
+                   "invalid map %zu accepted: %s", i, invalid[i]);
+    }
+    TEST_CHECK(memcmp(before, _addresses, sizeof(before)) == 0, "validation modified the register list");
+
+    // the loader keeps skipping entries it cannot resolve
+    TEST_CHECK(control_logic_register_load_from_json(invalid[0], _register_list, REGISTER_NUM) == SUCCESS,
+               "load with an unknown name failed");
+    TEST_CHECK(_addresses[1] == 1, "REG_0001 not loaded next to an unknown name");
+}
+
+static void _test_rename(void)
+{
+    // same list, new names: the cached index must not resolve the old ones
+    snprintf(_names[7], sizeof(_names[7]), "RENAMED");
+    _register_list[7].name = "RENAMED";
+
+    TEST_CHECK(control_logic_register_validate_json("[{\"name\":\"REG_0007\",\"address\":5}]", _register_list,
+                                                    REGISTER_NUM) == FAIL, "stale name still resolves");
+    TEST_CHECK(control_logic_register_load_from_json("[{\"name\":\"RENAMED\",\"address\":5}]", _register_list,
+                                                     REGISTER_NUM) == SUCCESS, "renamed register load failed");
+    TEST_CHECK(_addresses[7] == 5, "renamed register not resolved");
+}
+
+int main(void)
+{
+    _register_lists_init();
+
+    _test_load();
+    _test_validate();
+    _test_rename();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,193 @@
+// RS485 baud-rate coalescing: the bridge is only reconfigured when the baud
+// rate changes, the board is replugged or a transfer failed, and a slow port
+// setting its baud rate does not hold up the other ports. Two slaves at
+// different rates on one port never see a request at the other's rate.
+
+#include <pthread.h>
+#include <string.h>
+
+#include "dexatek/main_application/include/application_common.h"
+
+#include "dexatek/main_application/managers/modbus_manager/modbus_manager.h"
+
+#include "kenmec/main_application/control_logic/control_hardware.h"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define SLOW_PORT 1
+#define FAST_PORT 2
+#define SLAVE_ID 1
+
+static int _read(uint8_t port, uint32_t baudrate)
+{
+    uint16_t values[4];
+
+    return control_hardware_rs485_multiple_read(port, baudrate, SLAVE_ID, MODBUS_FUNC_READ_HOLDING_REGISTERS, 0, 4,
+                                                values, 100);
+}
+
+static void _board_plug(uint8_t port, uint32_t latency_us)
+{
+    fake_hid_boards[port].pid = HID_RTD_BOARD_PID;
+    fake_hid_boards[port].latency_us = latency_us;
+    fake_hid_boards[port].slave_mask = 1u << SLAVE_ID;
+}
+
+static void _test_coalescing(void)
+{
+    fake_hid_counters_t counters;
+    uint32_t set_before = 0;
+    uint32_t skip_before = 0;
+    uint32_t set_count = 0;
+    uint32_t skip_count = 0;
+
+    fake_hid_reset();
+    _board_plug(SLOW_PORT, 0);
+    control_hardware_rs485_baudrate_invalidate(SLOW_PORT);
+    control_hardware_rs485_baudrate_stats_get(&set_before, &skip_before);
+
+    // same baud rate: one set, the rest skipped
+    for (int i = 0; i < 100; i++) {
+        TEST_CHECK(_read(SLOW_PORT, 9600) == SUCCESS, "read %d failed", i);
+    }
+    fake_hid_counters_get(SLOW_PORT, &counters);
+    control_hardware_rs485_baudrate_stats_get(&set_count, &skip_count);
+    TEST_CHECK(counters.baudrate_sets == 1, "same rate: %u sets", counters.baudrate_sets);
+    TEST_CHECK(set_count - set_before == 1 && skip_count - skip_before == 99, "same rate: stats %u/%u",
+               set_count - set_before, skip_count - skip_before);
+    TEST_CHECK(fake_hid_boards[SLOW_PORT].baudrate == 9600, "bridge at %u", fake_hid_boards[SLOW_PORT].baudrate);
+
+    // alternating baud rates: every read has to reconfigure the bridge
+    for (int i = 0; i < 10; i++) {
+        _read(SLOW_PORT, (i & 1) ? 9600 : 19200);
+    }
+    fake_hid_counters_get(SLOW_PORT, &counters);
+    TEST_CHECK(counters.baudrate_sets == 11, "alternating: %u sets", counters.baudrate_sets);
+
+    // failed transfer: the bridge state is unknown, the next read sets it again
+    fake_hid_boards[SLOW_PORT].fail = 1;
+    TEST_CHECK(_read(SLOW_PORT, 9600) == FAIL, "read on failing board succeeded");
+    fake_hid_boards[SLOW_PORT].fail = 0;
+    fake_hid_counters_get(SLOW_PORT, &counters);
+    uint32_t sets = counters.baudrate_sets;
+    TEST_CHECK(_read(SLOW_PORT, 9600) == SUCCESS, "read after failure failed");
+    fake_hid_counters_get(SLOW_PORT, &counters);
+    TEST_CHECK(counters.baudrate_sets == sets + 1, "after failure: %u sets, expected %u", counters.baudrate_sets,
+               sets + 1);
+
+    // replug with another board: the new bridge starts at its default rate
+    fake_hid_boards[SLOW_PORT].pid = HID_IO_BOARD_PID;
+    _read(SLOW_PORT, 9600);
+    fake_hid_boards[SLOW_PORT].pid = HID_RTD_BOARD_PID;
+    sets = counters.baudrate_sets;
+    TEST_CHECK(_read(SLOW_PORT, 9600) == SUCCESS, "read after replug failed");
+    fake_hid_counters_get(SLOW_PORT, &counters);
+    TEST_CHECK(counters.baudrate_sets >= sets + 1, "replug did not reset the baud rate");
+
+    fake_hid_counters_get(SLOW_PORT, &counters);
+    TEST_REPORT("coalescing: %u transactions, %u baud-rate sets for %u reads\n", counters.transactions,
+                counters.baudrate_sets, counters.rs485_reads);
+}
+
+typedef struct {
+    uint8_t port;
+    uint64_t elapsed_us;
+} reader_t;
+
+static void *_reader_thread(void *arg)
+{
+    reader_t *reader = (reader_t *)arg;
+    uint64_t start = fake_now_ns();
+
+    _read(reader->port, 9600);
+    reader->elapsed_us = (fake_now_ns() - start) / 1000;
+
+    return NULL;
+}
+
+static void _test_per_port_lock(void)
+{
+    fake_hid_reset();
+    _board_plug(SLOW_PORT, 200000);
+    _board_plug(FAST_PORT, 0);
+    control_hardware_rs485_baudrate_invalidate(SLOW_PORT);
+    control_hardware_rs485_baudrate_invalidate(FAST_PORT);
+
+    // the slow port is in the middle of its baud-rate round trip while the fast port reads
+    reader_t slow = { .port = SLOW_PORT };
+    reader_t fast = { .port = FAST_PORT };
+    pthread_t slow_thread;
+    pthread_t fast_thread;
+
+    pthread_create(&slow_thread, NULL, _reader_thread, &slow);
+    usleep(20000);
+    pthread_create(&fast_thread, NULL, _reader_thread, &fast);
+    pthread_join(fast_thread, NULL);
+    pthread_join(slow_thread, NULL);
+
+    TEST_CHECK(fast.elapsed_us < 100000, "fast port waited %llu us behind the slow port",
+               (unsigned long long)fast.elapsed_us);
+    TEST_REPORT("per-port lock: slow port %llu us, fast port %llu us\n", (unsigned long long)slow.elapsed_us,
+                (unsigned long long)fast.elapsed_us);
+}
+
+#define MIXED_READS 50
+
+typedef struct {
+    uint8_t slave_id;
+    uint32_t baudrate;
+    int failures;
+} mixed_reader_t;
+
+static void *_mixed_reader_thread(void *arg)
+{
+    mixed_reader_t *reader = (mixed_reader_t *)arg;
+    uint16_t values[4];
+
+    for (int i = 0; i < MIXED_READS; i++) {
+        if (control_hardware_rs485_multiple_read(SLOW_PORT, reader->baudrate, reader->slave_id,
+                                                 MODBUS_FUNC_READ_HOLDING_REGISTERS, 0, 4, values, 100) != SUCCESS) {
+            reader->failures++;
+        }
+    }
+
+    return NULL;
+}
+
+static void _test_mixed_rates(void)
+{
+    fake_hid_reset();
+    _board_plug(SLOW_PORT, 1000);
+    fake_hid_boards[SLOW_PORT].slave_mask = (1u << 1) | (1u << 2);
+    fake_hid_boards[SLOW_PORT].slave_baudrate[1] = 9600;
+    fake_hid_boards[SLOW_PORT].slave_baudrate[2] = 19200;
+    control_hardware_rs485_baudrate_invalidate(SLOW_PORT);
+
+    // another thread must not change the bridge rate between the baud-rate set and the request
+    mixed_reader_t first = { .slave_id = 1, .baudrate = 9600 };
+    mixed_reader_t second = { .slave_id = 2, .baudrate = 19200 };
+    pthread_t first_thread;
+    pthread_t second_thread;
+
+    pthread_create(&first_thread, NULL, _mixed_reader_thread, &first);
+    pthread_create(&second_thread, NULL, _mixed_reader_thread, &second);
+    pthread_join(first_thread, NULL);
+    pthread_join(second_thread, NULL);
+
+    TEST_CHECK(first.failures == 0 && second.failures == 0, "mixed rates: %d/%d reads at the wrong rate",
+               first.failures, second.failures);
+
+    fake_hid_counters_t counters;
+    fake_hid_counters_get(SLOW_PORT, &counters);
+    TEST_REPORT("mixed rates: %u baud-rate sets for %u reads\n", counters.baudrate_sets, counters.rs485_reads);
+}
+
+int main(void)
+{
+    _test_coalescing();
+    _test_per_port_lock();
+    _test_mixed_rates();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,140 @@
+// RS485 block reads: 40 devices on 3 slaves must be served by a handful of
+// HID round trips, and every device must still get its own register value.
+
+#include "../control_logic/control_logic_update.c"
+
+#include "fake_hid.h"
+#include "fake_platform.h"
+
+#define RTD_PORT 1
+#define DEVICE_NUM 40
+#define UPDATE_ADDRESS_BASE 1000
+
+typedef struct {
+    uint8_t slave_id;
+    uint16_t reg_address;
+    uint8_t data_type;
+} device_t;
+
+static device_t _devices[DEVICE_NUM];
+
+static int _devices_build(char *json, size_t size)
+{
+    int n = 0;
+    int len = snprintf(json, size, "[");
+
+    // slave 1: 16 adjacent UINT16 -> one block
+    for (int i = 0; i < 16; i++, n++) {
+        _devices[n] = (device_t){ 1, (uint16_t)i, MODBUS_TYPE_UINT16 };
+    }
+    // slave 2: 12 adjacent FLOAT32 (24 registers) -> one block
+    for (int i = 0; i < 12; i++, n++) {
+        _devices[n] = (device_t){ 2, (uint16_t)(100 + i * 2), MODBUS_TYPE_FLOAT32 };
+    }
+    // slave 3: 12 INT16 with 2-register gaps (34 registers) -> two blocks
+    for (int i = 0; i < 12; i++, n++) {
+        _devices[n] = (device_t){ 3, (uint16_t)(i * 3), MODBUS_TYPE_INT16 };
+    }
+
+    for (int i = 0; i < n; i++) {
+        len += snprintf(json + len, size - len,
+                        "%s{\"board\":%d,\"baudrate\":9600,\"slave_id\":%u,\"code\":3,\"address\":%u,"
+                        "\"data_type\":%u,\"update_address\":%d,\"name\":\"D%d\"}",
+                        i ? "," : "", RTD_PORT, _devices[i].slave_id, _devices[i].reg_address,
+                        _devices[i].data_type, UPDATE_ADDRESS_BASE + i * 2, i);
+    }
+    snprintf(json + len, size - len, "]");
+
+    return n;
+}
+
+static void _test_block_read(uint32_t latency_us)
+{
+    char json[16384];
+
+    fake_hid_reset();
+    fake_hid_boards[RTD_PORT].pid = HID_RTD_BOARD_PID;
+    fake_hid_boards[RTD_PORT].latency_us = latency_us;
+    fake_hid_boards[RTD_PORT].slave_mask = (1u << 1) | (1u << 2) | (1u << 3);
+
+    int n = _devices_build(json, sizeof(json));
+
+    // the file save fails on the host, the snapshot is published regardless
+    control_logic_modbus_device_configs_set(json);
+
+    int count = 0;
+    control_logic_modbus_device_configs_get(&count);
+    TEST_CHECK(count == n, "configs %d != %d", count, n);
+
+    uint64_t start = fake_now_ns();
+    int ret = _control_logic_modbus_devices_update();
+    uint64_t elapsed_us = (fake_now_ns() - start) / 1000;
+
+    fake_hid_counters_t counters;
+    fake_hid_counters_get(RTD_PORT, &counters);
+
+    TEST_CHECK(ret == SUCCESS, "update failed");
+    TEST_CHECK(counters.rs485_reads == 4, "rs485 reads %u != 4", counters.rs485_reads);
+
+    for (int i = 0; i < n; i++) {
+        uint16_t address = (uint16_t)(UPDATE_ADDRESS_BASE + i * 2);
+        uint16_t expect = fake_rs485_register(_devices[i].slave_id, _devices[i].reg_address);
+
+        switch (_devices[i].data_type) {
+            case MODBUS_TYPE_UINT16: {
+                uint16_t v = 0;
+                control_logic_load_from_modbus_table(address, MODBUS_TYPE_UINT16, &v);
+                TEST_CHECK(v == expect, "dev %d: %u != %u", i, v, expect);
+                break;
+            }
+            case MODBUS_TYPE_INT16: {
+                int16_t v = 0;
+                control_logic_load_from_modbus_table(address, MODBUS_TYPE_INT16, &v);
+                TEST_CHECK(v == (int16_t)expect, "dev %d: %d != %d", i, v, (int16_t)expect);
+                break;
+            }
+            case MODBUS_TYPE_FLOAT32: {
+                uint16_t regs[2] = { expect, fake_rs485_register(_devices[i].slave_id, _devices[i].reg_address + 1) };
+                float expect_f = 0;
+                float v = 0;
+                memcpy(&expect_f, regs, sizeof(expect_f));
+                control_logic_load_from_modbus_table(address, MODBUS_TYPE_FLOAT32, &v);
+                TEST_CHECK(memcmp(&v, &expect_f, sizeof(v)) == 0, "dev %d: float mismatch", i);
+                break;
+            }
+        }
+    }
+
+    TEST_REPORT("latency %4u us: %d devices, %u block reads, %u HID transactions, %llu us\n", latency_us, n,
+           counters.rs485_reads, counters.transactions, (unsigned long long)elapsed_us);
+}
+
+static void _test_silent_slave(void)
+{
+    char json[16384];
+
+    fake_hid_reset();
+    fake_hid_boards[RTD_PORT].pid = HID_RTD_BOARD_PID;
+    fake_hid_boards[RTD_PORT].slave_mask = (1u << 1) | (1u << 2);
+
+    _devices_build(json, sizeof(json));
+    control_logic_modbus_device_configs_set(json);
+
+    // slave 3 does not answer: its blocks fail (gapped ones fall back to single reads), the others still update
+    int ret = _control_logic_modbus_devices_update();
+
+    uint16_t v = 0;
+    control_logic_load_from_modbus_table(UPDATE_ADDRESS_BASE, MODBUS_TYPE_UINT16, &v);
+
+    TEST_CHECK(ret == FAIL, "silent slave not reported");
+    TEST_CHECK(v == fake_rs485_register(1, 0), "slave 1 not updated");
+}
+
+int main(void)
+{
+    _test_block_read(0);
+    _test_block_read(2000);
+    _test_silent_slave();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,158 @@
+// RTD conversion table: every PT100 and PT1000 reading the AD7124 can report
+// over -200..850 C (0.01 ohm steps) is converted through the table and
+// compared with the closed-form Callendar-Van Dusen solution, which must agree
+// within 0.01 C, and the converted temperatures must never decrease as the
+// resistance rises. The batched board conversion must match the single one.
+//
+// Benchmark: conversions per second for the table (single and batched by
+// board) against solving the equation for every sample.
+
+#include <math.h>
+
+#include "../control_logic/control_logic_rtd.c"
+
+#include "fake_platform.h"
+
+#define ERROR_BOUND_C 0.01
+#define BENCH_ROUNDS 2000
+#define BENCH_BOARDS 128
+#define BOARD_CHANNELS 8
+
+typedef struct {
+    double max_error;
+    double max_error_temp;
+    uint32_t readings;
+    uint32_t decreases;
+} sweep_result_t;
+
+// every 0.01 ohm reading of a sensor with base resistance r0 inside the table range
+static void _sweep(uint16_t r0, sweep_result_t *result)
+{
+    uint32_t first = (uint32_t)ceil(_rtd_cvd_ratio(CONTROL_LOGIC_RTD_TEMP_MIN) * r0 * 100.0);
+    uint32_t last = (uint32_t)floor(_rtd_cvd_ratio(CONTROL_LOGIC_RTD_TEMP_MAX) * r0 * 100.0);
+    float previous = -INFINITY;
+
+    memset(result, 0, sizeof(*result));
+    for (uint32_t raw = first; raw <= last; raw++) {
+        float temp = control_logic_rtd_temperature(raw, r0);
+        double exact = control_logic_rtd_cvd_temperature(raw / (r0 * 100.0));
+        double error = fabs(temp - exact);
+
+        if (error > result->max_error) {
+            result->max_error = error;
+            result->max_error_temp = exact;
+        }
+        if (temp < previous) {
+            result->decreases++;
+        }
+        previous = temp;
+        result->readings++;
+    }
+}
+
+static void _test_accuracy(void)
+{
+    sweep_result_t pt100;
+    sweep_result_t pt1000;
+
+    _sweep(100, &pt100);
+    _sweep(1000, &pt1000);
+
+    TEST_REPORT("PT100: %u readings, max error %.5f C (at %.1f C)\n", pt100.readings, pt100.max_error,
+                pt100.max_error_temp);
+    TEST_REPORT("PT1000: %u readings, max error %.5f C (at %.1f C)\n", pt1000.readings, pt1000.max_error,
+                pt1000.max_error_temp);
+    TEST_CHECK(pt100.max_error < ERROR_BOUND_C, "PT100 max error %.5f C", pt100.max_error);
+    TEST_CHECK(pt1000.max_error < ERROR_BOUND_C, "PT1000 max error %.5f C", pt1000.max_error);
+    TEST_CHECK(pt100.decreases == 0 && pt1000.decreases == 0, "not monotonic: %u / %u decreases", pt100.decreases,
+               pt1000.decreases);
+
+    // the closed form itself: solving back the ratio of a known temperature
+    double worst = 0.0;
+    for (double t = CONTROL_LOGIC_RTD_TEMP_MIN; t <= CONTROL_LOGIC_RTD_TEMP_MAX; t += 0.25) {
+        double error = fabs(control_logic_rtd_cvd_temperature(_rtd_cvd_ratio(t)) - t);
+        worst = (error > worst) ? error : worst;
+    }
+    TEST_CHECK(worst < 1e-6, "closed form round trip off by %g C", worst);
+
+    // IEC 60751 reference points: 100.00 ohm at 0 C, 138.51 ohm at 100 C, 185.20 ohm (PT1000) at -200 C
+    TEST_CHECK(fabsf(control_logic_rtd_temperature(10000, 100)) < 0.005f, "0 C: %f",
+               control_logic_rtd_temperature(10000, 100));
+    TEST_CHECK(fabsf(control_logic_rtd_temperature(13851, 100) - 100.0f) < 0.02f, "100 C: %f",
+               control_logic_rtd_temperature(13851, 100));
+    TEST_CHECK(fabsf(control_logic_rtd_temperature(18520, 1000) + 200.0f) < 0.02f, "-200 C: %f",
+               control_logic_rtd_temperature(18520, 1000));
+    TEST_CHECK(control_logic_rtd_temperature(0, 100) == 0.0f, "open reading not 0");
+}
+
+static void _test_batch(void)
+{
+    uint32_t resistance[BOARD_CHANNELS] = { 0, 1852, 10000, 11940, 13851, 24709, 39048, 119400 };
+    uint8_t type[BOARD_CHANNELS] = { 0, 0, 0, 0, 0, 0, 0, CONTROL_LOGIC_RTD_PT1000 };
+    int32_t temperature[BOARD_CHANNELS];
+
+    control_logic_rtd_temperature_batch(resistance, type, BOARD_CHANNELS, temperature);
+    for (int i = 0; i < BOARD_CHANNELS; i++) {
+        uint16_t r0 = (type[i] == CONTROL_LOGIC_RTD_PT1000) ? 1000 : 100;
+        int32_t single = (int32_t)lroundf(control_logic_rtd_temperature(resistance[i], r0) * 10.0f);
+        TEST_CHECK(temperature[i] == single, "channel %d: batch %d, single %d", i, temperature[i], single);
+    }
+    TEST_CHECK(temperature[0] == 0 && temperature[3] == 500 && temperature[7] == 500, "batch %d %d %d",
+               temperature[0], temperature[3], temperature[7]);
+
+    // no type list: all PT100
+    int32_t untyped[BOARD_CHANNELS];
+    control_logic_rtd_temperature_batch(resistance, NULL, BOARD_CHANNELS, untyped);
+    TEST_CHECK(memcmp(untyped, temperature, 7 * sizeof(int32_t)) == 0, "untyped batch differs");
+}
+
+static void _bench(void)
+{
+    static uint32_t resistance[BENCH_BOARDS * BOARD_CHANNELS];
+    static int32_t temperature[BENCH_BOARDS * BOARD_CHANNELS];
+    int count = BENCH_BOARDS * BOARD_CHANNELS;
+    uint64_t start;
+
+    // readings spread over the whole range, converted to 0.1 C as the RTD board refresh does
+    for (int i = 0; i < count; i++) {
+        resistance[i] = 1852 + (uint32_t)((39048 - 1852) * (uint64_t)i / count);
+    }
+
+    start = fake_now_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int i = 0; i < count; i++) {
+            temperature[i] = (int32_t)lround(control_logic_rtd_cvd_temperature(resistance[i] / 10000.0) * 10.0);
+        }
+    }
+    double cvd_ns = (double)(fake_now_ns() - start) / ((double)BENCH_ROUNDS * count);
+    int32_t check = temperature[count / 2];
+
+    start = fake_now_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int i = 0; i < count; i++) {
+            temperature[i] = (int32_t)lroundf(control_logic_rtd_temperature(resistance[i], 100) * 10.0f);
+        }
+    }
+    double table_ns = (double)(fake_now_ns() - start) / ((double)BENCH_ROUNDS * count);
+
+    start = fake_now_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int i = 0; i < count; i += BOARD_CHANNELS) {
+            control_logic_rtd_temperature_batch(&resistance[i], NULL, BOARD_CHANNELS, &temperature[i]);
+        }
+    }
+    double batch_ns = (double)(fake_now_ns() - start) / ((double)BENCH_ROUNDS * count);
+
+    TEST_REPORT("bench: closed form %.1f M conversions/s, table %.1f M/s, table batched by board %.1f M/s (%.1fx)\n",
+                1e3 / cvd_ns, 1e3 / table_ns, 1e3 / batch_ns, cvd_ns / batch_ns);
+    TEST_CHECK(abs(temperature[count / 2] - check) <= 1, "bench results differ: %d vs %d", temperature[count / 2], check);
+}
+
+int main(void)
+{
+    _test_accuracy();
+    _test_batch();
+    _bench();
+
+    return TEST_RESULT();
+}
@@ -41,6 +41,10 @@ typedef enum {
     _STEP_DATA
 } _step_t;
 
+/* Optional access functions for the holding registers of the mapping */
+static modbus_registers_reader_t registers_reader = NULL;
+static modbus_registers_writer_t registers_writer = NULL;
+
 const char *modbus_strerror(int errnum) {
     switch (errnum) {
     case EMBXILFUN:
@@ -641,6 +645,35 @@ static int check_confirmation(modbus_t *ctx, uint8_t *req,
     return rc;
 }
 
+void modbus_set_registers_access(modbus_registers_reader_t reader,
+                                 modbus_registers_writer_t writer)
+{
+    registers_reader = reader;
+    registers_writer = writer;
+}
+
+/* Copy holding registers out of the mapping for a response */
+static void registers_read(const modbus_mapping_t *mb_mapping,
+                           int address, int nb, uint16_t *dest)
+{
+    if (registers_reader != NULL) {
+        registers_reader(mb_mapping, address, nb, dest);
+    } else {
+        memcpy(dest, mb_mapping->tab_registers + address, nb * sizeof(uint16_t));
+    }
+}
+
+/* Store holding registers received in a request */
+static void registers_write(modbus_mapping_t *mb_mapping,
+                            int address, int nb, const uint16_t *src)
+{
+    if (registers_writer != NULL) {
+        registers_writer(mb_mapping, address, nb, src);
+    } else {
+        memcpy(mb_mapping->tab_registers + address, src, nb * sizeof(uint16_t));
+    }
+}
+
 static int response_io_status(uint8_t *tab_io_status,
                               int address, int nb,
                               uint8_t *rsp, int offset)
@@ -786,12 +819,19 @@ int modbus_reply(modbus_t *ctx, const uint8_t *req,
                 mapping_address < 0 ? address : address + nb, name);
         } else {
             int i;
+            uint16_t values[MODBUS_MAX_READ_REGISTERS];
+
+            if (is_input) {
+                memcpy(values, tab_registers + mapping_address, nb * sizeof(uint16_t));
+            } else {
+                registers_read(mb_mapping, mapping_address, nb, values);
+            }
 
             rsp_length = ctx->backend->build_response_basis(&sft, rsp);
             rsp[rsp_length++] = nb << 1;
-            for (i = mapping_address; i < mapping_address + nb; i++) {
-                rsp[rsp_length++] = tab_registers[i] >> 8;
-                rsp[rsp_length++] = tab_registers[i] & 0xFF;
+            for (i = 0; i < nb; i++) {
+                rsp[rsp_length++] = values[i] >> 8;
+                rsp[rsp_length++] = values[i] & 0xFF;
             }
         }
     }
@@ -831,9 +871,9 @@ int modbus_reply(modbus_t *ctx, const uint8_t *req,
                 "Illegal data address 0x%0X in write_register\n",
                 address);
         } else {
-            int data = (req[offset + 3] << 8) + req[offset + 4];
+            uint16_t data = (req[offset + 3] << 8) + req[offset + 4];
 
-            mb_mapping->tab_registers[mapping_address] = data;
+            registers_write(mb_mapping, mapping_address, 1, &data);
             memcpy(rsp, req, req_length);
             rsp_length = req_length;
         }
@@ -889,11 +929,13 @@ int modbus_reply(modbus_t *ctx, const uint8_t *req,
                 mapping_address < 0 ? address : address + nb);
         } else {
             int i, j;
-            for (i = mapping_address, j = 6; i < mapping_address + nb; i++, j += 2) {
+            uint16_t values[MODBUS_MAX_WRITE_REGISTERS];
+
+            for (i = 0, j = 6; i < nb; i++, j += 2) {
                 /* 6 and 7 = first value */
-                mb_mapping->tab_registers[i] =
-                    (req[offset + j] << 8) + req[offset + j + 1];
+                values[i] = (req[offset + j] << 8) + req[offset + j + 1];
             }
+            registers_write(mb_mapping, mapping_address, nb, values);
 
             rsp_length = ctx->backend->build_response_basis(&sft, rsp);
             /* 4 to copy the address (2) and the no. of registers */
@@ -935,12 +977,13 @@ int modbus_reply(modbus_t *ctx, const uint8_t *req,
                 "Illegal data address 0x%0X in write_register\n",
                 address);
         } else {
-            uint16_t data = mb_mapping->tab_registers[mapping_address];
+            uint16_t data;
             uint16_t and = (req[offset + 3] << 8) + req[offset + 4];
             uint16_t or = (req[offset + 5] << 8) + req[offset + 6];
 
+            registers_read(mb_mapping, mapping_address, 1, &data);
             data = (data & and) | (or & (~and));
-            mb_mapping->tab_registers[mapping_address] = data;
+            registers_write(mb_mapping, mapping_address, 1, &data);
             memcpy(rsp, req, req_length);
             rsp_length = req_length;
         }
@@ -963,7 +1006,7 @@ int modbus_reply(modbus_t *ctx, const uint8_t *req,
                 nb_write, nb, MODBUS_MAX_WR_WRITE_REGISTERS, MODBUS_MAX_WR_READ_REGISTERS);
         } else if (mapping_address < 0 ||
                    (mapping_address + nb) > mb_mapping->nb_registers ||
-                   mapping_address < 0 ||
+                   mapping_address_write < 0 ||
                    (mapping_address_write + nb_write) > mb_mapping->nb_registers) {
             rsp_length = response_exception(
                 ctx, &sft, MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS, rsp, FALSE,
@@ -972,21 +1015,23 @@ int modbus_reply(modbus_t *ctx, const uint8_t *req,
                 mapping_address_write < 0 ? address_write : address_write + nb_write);
         } else {
             int i, j;
+            uint16_t values[MODBUS_MAX_WR_READ_REGISTERS];
+
             rsp_length = ctx->backend->build_response_basis(&sft, rsp);
             rsp[rsp_length++] = nb << 1;
 
             /* Write first.
                10 and 11 are the offset of the first values to write */
-            for (i = mapping_address_write, j = 10;
-                 i < mapping_address_write + nb_write; i++, j += 2) {
-                mb_mapping->tab_registers[i] =
-                    (req[offset + j] << 8) + req[offset + j + 1];
+            for (i = 0, j = 10; i < nb_write; i++, j += 2) {
+                values[i] = (req[offset + j] << 8) + req[offset + j + 1];
             }
+            registers_write(mb_mapping, mapping_address_write, nb_write, values);
 
             /* and read the data for the response */
-            for (i = mapping_address; i < mapping_address + nb; i++) {
-                rsp[rsp_length++] = mb_mapping->tab_registers[i] >> 8;
-                rsp[rsp_length++] = mb_mapping->tab_registers[i] & 0xFF;
+            registers_read(mb_mapping, mapping_address, nb, values);
+            for (i = 0; i < nb; i++) {
+                rsp[rsp_length++] = values[i] >> 8;
+                rsp[rsp_length++] = values[i] & 0xFF;
             }
         }
     }
@@ -238,6 +238,17 @@ MODBUS_API int modbus_reply(modbus_t *ctx, const uint8_t *req,
 MODBUS_API int modbus_reply_exception(modbus_t *ctx, const uint8_t *req,
                                       unsigned int exception_code);
 
+/* Holding register access used by modbus_reply(), for mappings shared with
+   other threads that need multi-register values to be read and written as a
+   whole. address is relative to start_registers. NULL restores direct access
+   to tab_registers. */
+typedef void (*modbus_registers_reader_t)(const modbus_mapping_t *mb_mapping,
+                                          int address, int nb, uint16_t *dest);
+typedef void (*modbus_registers_writer_t)(modbus_mapping_t *mb_mapping,
+                                          int address, int nb, const uint16_t *src);
+MODBUS_API void modbus_set_registers_access(modbus_registers_reader_t reader,
+                                            modbus_registers_writer_t writer);
+
 /**
  * UTILS FUNCTIONS
  **/